@@ -452,6 +452,76 @@ public:
    }
 };
 
+class AnnotationModifiedObserver
+{
+public:
+   AnnotationModifiedObserver() : mModifiedCount(0) {}
+
+   void modified(Subject& subject, const string& signal, const boost::any& value)
+   {
+      ++mModifiedCount;
+   }
+
+   unsigned int mModifiedCount;
+};
+
+class AnnotationReplicateObjectTestCase : public TestCase
+{
+public:
+   AnnotationReplicateObjectTestCase() : TestCase("ReplicateObject") {}
+   bool run()
+   {
+      bool success = true;
+      RasterElement* pRasterElement = TestUtilities::getStandardRasterElement();
+      issea( pRasterElement != NULL );
+
+      SpatialDataWindow* pWindow = dynamic_cast<SpatialDataWindow*>(
+         Service<DesktopServices>()->getWindow(pRasterElement->getName(), SPATIAL_DATA_WINDOW));
+      issea( pWindow != NULL );
+
+      SpatialDataView* pView = pWindow->getSpatialDataView();
+      issea( pView != NULL );
+
+      AnnotationLayer* pAnnotationLayer = dynamic_cast<AnnotationLayer*>(
+         pView->createLayer( ANNOTATION, NULL, "Replicate Annotation" ) );
+      issea( pAnnotationLayer != NULL );
+
+      GraphicObject* pSource = pAnnotationLayer->addObject( RECTANGLE_OBJECT );
+      issea( pSource != NULL );
+      pSource->setName( "Source Rectangle" );
+      pSource->setBoundingBox( LocationType( 10, 10 ), LocationType( 40, 30 ) );
+      pSource->setFillColor( ColorType( 0, 0, 255 ) );
+      pSource->setFillStyle( HATCH );
+      pSource->setHatchStyle( ASTERISK );
+      pSource->setLineWidth( 3 );
+
+      GraphicObject* pCopy = pAnnotationLayer->addObject( RECTANGLE_OBJECT );
+      issea( pCopy != NULL );
+
+      // Every property is set, but observers only receive a single Modified
+      AnnotationModifiedObserver observer;
+      issea( pCopy->attach( SIGNAL_NAME( Subject, Modified ),
+         Slot( &observer, &AnnotationModifiedObserver::modified ) ) );
+      GraphicObjectImp* pCopyImp = dynamic_cast<GraphicObjectImp*>( pCopy );
+      issea( pCopyImp != NULL );
+      issea( pCopyImp->replicateObject( pSource ) );
+      issea( observer.mModifiedCount == 1 );
+      issea( pCopy->detach( SIGNAL_NAME( Subject, Modified ),
+         Slot( &observer, &AnnotationModifiedObserver::modified ) ) );
+
+      issea( pCopy->getName() == pSource->getName() );
+      issea( pCopy->getLlCorner() == pSource->getLlCorner() );
+      issea( pCopy->getUrCorner() == pSource->getUrCorner() );
+      issea( pCopy->getFillColor() == pSource->getFillColor() );
+      issea( pCopy->getFillStyle() == pSource->getFillStyle() );
+      issea( pCopy->getHatchStyle() == pSource->getHatchStyle() );
+      issea( pCopy->getLineWidth() == pSource->getLineWidth() );
+
+      issea( pView->deleteLayer( pAnnotationLayer ) );
+      return success;
+   }
+};
+
 class AnnotationSerializeDeserializeObjectTest : public TestCase
 {
 public:
@@ -1252,6 +1322,7 @@ public:
       addTestCase( new AnnotationBoxSelectTestCase );
       addTestCase( new AnnotationBigPolylineTestCase );
       addTestCase( new AnnotationArcTestCase );
+      addTestCase( new AnnotationReplicateObjectTestCase );
       addTestCase( new AnnotationSerializeDeserializeObjectTest );
       addTestCase( new AnnotationSerializeDeserializeLayerTest );
       addTestCase( new AnnotationRenameLayerTest );
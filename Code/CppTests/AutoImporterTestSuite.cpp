@@ -0,0 +1,311 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "assert.h"
+#include "ConfigurationSettings.h"
+#include "Filename.h"
+#include "Importer.h"
+#include "PlugInResource.h"
+#include "Slot.h"
+#include "TestSuiteNewSession.h"
+#include "TestUtilities.h"
+
+#include <QtCore/QFileInfo>
+
+#include <fstream>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   const string DETECTION_CACHE_SIZE_KEY = "AutoImporter/DetectionCacheSize";
+
+   const char* const sTestFiles[] =
+   {
+      "fs_test_image.tif",
+      "GeoReference/landsat6band.tif",
+      "daytonchip.sio",
+      "i_3130b.ntf",
+      "Ice/Version1_0/cube-no-saved-stats.ice.h5"
+   };
+
+   // Detects the file with a new instance of the auto importer, so only the persistent cache is shared
+   unsigned char detect(const string& filename)
+   {
+      PlugInResource pAutoImporter("Auto Importer");
+      Importer* pImporter = dynamic_cast<Importer*>(pAutoImporter.get());
+      if (pImporter == NULL)
+      {
+         return Importer::CAN_NOT_LOAD;
+      }
+
+      return pImporter->getFileAffinity(filename);
+   }
+
+   string getCacheFilePath()
+   {
+      return Service<ConfigurationSettings>()->getUserStorageFilePath("AutoImporterDetectionCache", "txt");
+   }
+
+   vector<string> getCacheEntries()
+   {
+      vector<string> entries;
+
+      ifstream cacheFile(getCacheFilePath().c_str());
+      string entry;
+      while (getline(cacheFile, entry))
+      {
+         if (entry.empty() == false)
+         {
+            entries.push_back(entry);
+         }
+      }
+
+      return entries;
+   }
+
+   // Gets the importer stored in the cache for the file, which is the last field of the entry
+   string getCachedImporter(const string& filename, unsigned int& entryCount)
+   {
+      string path = QFileInfo(QString::fromStdString(filename)).absoluteFilePath().toStdString() + "\t";
+      string importerName;
+      entryCount = 0;
+
+      const vector<string> entries = getCacheEntries();
+      for (vector<string>::const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
+      {
+         if (iter->compare(0, path.size(), path) == 0)
+         {
+            ++entryCount;
+            importerName = iter->substr(iter->rfind('\t') + 1);
+         }
+      }
+
+      return importerName;
+   }
+
+   bool copyFile(const string& source, const string& destination)
+   {
+      ifstream input(source.c_str(), ios::in | ios::binary);
+      ofstream output(destination.c_str(), ios::out | ios::binary | ios::trunc);
+      if (input.good() == false || output.good() == false)
+      {
+         return false;
+      }
+
+      output << input.rdbuf();
+      return output.good();
+   }
+
+   void setCacheEntries(const vector<string>& entries)
+   {
+      ofstream cacheFile(getCacheFilePath().c_str(), ios::out | ios::trunc);
+      for (vector<string>::const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
+      {
+         cacheFile << *iter << "\n";
+      }
+   }
+
+   class SettingsObserver
+   {
+   public:
+      SettingsObserver() :
+         mModified(false)
+      {}
+
+      virtual ~SettingsObserver()
+      {}
+
+      void modified(Subject& subject, const string& signal, const boost::any& value)
+      {
+         mModified = true;
+      }
+
+      bool mModified;
+   };
+
+   // Restores the detection cache and its size when a test case finishes
+   class DetectionCacheResource
+   {
+   public:
+      DetectionCacheResource() :
+         mEntries(getCacheEntries())
+      {
+         setCacheEntries(vector<string>());
+      }
+
+      ~DetectionCacheResource()
+      {
+         Service<ConfigurationSettings> pSettings;
+         pSettings->deleteTemporarySetting(DETECTION_CACHE_SIZE_KEY);
+         setCacheEntries(mEntries);
+      }
+
+      void setCacheSize(unsigned int cacheSize)
+      {
+         Service<ConfigurationSettings> pSettings;
+         pSettings->setTemporarySetting(DETECTION_CACHE_SIZE_KEY, cacheSize);
+      }
+
+   private:
+      vector<string> mEntries;
+   };
+}
+
+class AutoImporterSameImporterTestCase : public TestCase
+{
+public:
+   AutoImporterSameImporterTestCase() : TestCase("SameImporter") {}
+
+   bool run()
+   {
+      bool success = true;
+      DetectionCacheResource cache;
+
+      for (unsigned int i = 0; i < sizeof(sTestFiles) / sizeof(sTestFiles[0]); ++i)
+      {
+         string filename = TestUtilities::getTestDataPath() + sTestFiles[i];
+
+         cache.setCacheSize(0);
+         unsigned char affinity = detect(filename);
+         issearf(affinity > Importer::CAN_NOT_LOAD);
+
+         unsigned int entryCount = 0;
+         issearf(getCachedImporter(filename, entryCount).empty());
+
+         // The importer found for an empty cache is stored and is the importer with the highest affinity
+         cache.setCacheSize(100);
+         issearf(detect(filename) == affinity);
+         string importerName = getCachedImporter(filename, entryCount);
+         issearf(entryCount == 1);
+         issearf(importerName.empty() == false);
+
+         PlugInResource pCachedPlugIn(importerName);
+         Importer* pCachedImporter = dynamic_cast<Importer*>(pCachedPlugIn.get());
+         issearf(pCachedImporter != NULL);
+         issearf(pCachedImporter->getFileAffinity(filename) == affinity);
+
+         // Detecting the file again uses the stored importer
+         vector<string> entries = getCacheEntries();
+         issearf(detect(filename) == affinity);
+         issearf(getCacheEntries() == entries);
+      }
+
+      return success;
+   }
+};
+
+class AutoImporterChangedFileTestCase : public TestCase
+{
+public:
+   AutoImporterChangedFileTestCase() : TestCase("ChangedFile") {}
+
+   bool run()
+   {
+      bool success = true;
+      DetectionCacheResource cache;
+
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      issearf(pTempPath != NULL);
+      string filename = pTempPath->getFullPathAndName() + SLASH + "autoImporterDetection.tif";
+      issearf(copyFile(TestUtilities::getTestDataPath() + "fs_test_image.tif", filename));
+
+      unsigned int entryCount = 0;
+      unsigned char affinity = detect(filename);
+      issea(affinity > Importer::CAN_NOT_LOAD);
+      issea(getCachedImporter(filename, entryCount).empty() == false);
+
+      // Replacing the contents of the file must not use the importer stored for the previous contents
+      issea(copyFile(TestUtilities::getTestDataPath() + "daytonchip.sio", filename));
+      unsigned char changedAffinity = detect(filename);
+      string changedImporter = getCachedImporter(filename, entryCount);
+      issea(entryCount <= 1);
+
+      cache.setCacheSize(0);
+      issea(detect(filename) == changedAffinity);
+      if (changedImporter.empty() == false)
+      {
+         PlugInResource pCachedPlugIn(changedImporter);
+         Importer* pCachedImporter = dynamic_cast<Importer*>(pCachedPlugIn.get());
+         issea(pCachedImporter != NULL && pCachedImporter->getFileAffinity(filename) == changedAffinity);
+      }
+
+      remove(filename.c_str());
+      return success;
+   }
+};
+
+class AutoImporterCompanionFileTestCase : public TestCase
+{
+public:
+   AutoImporterCompanionFileTestCase() : TestCase("CompanionFile") {}
+
+   bool run()
+   {
+      bool success = true;
+      DetectionCacheResource cache;
+
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      issearf(pTempPath != NULL);
+      string basePath = pTempPath->getFullPathAndName() + SLASH + "autoImporterCompanion";
+      string filename = basePath + ".sli";
+      string headerFilename = basePath + ".hdr";
+      remove(headerFilename.c_str());
+      issearf(copyFile(TestUtilities::getTestDataPath() + "Signatures/manmade1.sli", filename));
+
+      // Detect the library without its header so that the result for the data file alone is stored
+      detect(filename);
+
+      // Adding the header must not use the importer stored for the data file alone
+      issea(copyFile(TestUtilities::getTestDataPath() + "Signatures/manmade1.hdr", headerFilename));
+      unsigned char affinity = detect(filename);
+      issea(affinity > Importer::CAN_NOT_LOAD);
+
+      unsigned int entryCount = 0;
+      string importerName = getCachedImporter(filename, entryCount);
+      issea(entryCount == 1);
+
+      cache.setCacheSize(0);
+      issea(detect(filename) == affinity);
+
+      PlugInResource pCachedPlugIn(importerName);
+      Importer* pCachedImporter = dynamic_cast<Importer*>(pCachedPlugIn.get());
+      issea(pCachedImporter != NULL && pCachedImporter->getFileAffinity(filename) == affinity);
+
+      // Storing a detection does not modify any settings
+      cache.setCacheSize(100);
+      remove(headerFilename.c_str());
+      Service<ConfigurationSettings> pSettings;
+      SettingsObserver observer;
+      issea(pSettings->attach(SIGNAL_NAME(Subject, Modified), Slot(&observer, &SettingsObserver::modified)));
+      detect(filename);
+      issea(pSettings->detach(SIGNAL_NAME(Subject, Modified), Slot(&observer, &SettingsObserver::modified)));
+      issea(observer.mModified == false);
+
+      remove(filename.c_str());
+      return success;
+   }
+};
+
+class AutoImporterTestSuite : public TestSuiteNewSession
+{
+public:
+   AutoImporterTestSuite() : TestSuiteNewSession("AutoImporter")
+   {
+      addTestCase(new AutoImporterSameImporterTestCase);
+      addTestCase(new AutoImporterChangedFileTestCase);
+      addTestCase(new AutoImporterCompanionFileTestCase);
+   }
+};
+
+REGISTER_SUITE( AutoImporterTestSuite )
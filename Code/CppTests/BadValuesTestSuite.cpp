@@ -13,7 +13,125 @@
 #include "StringUtilities.h"
 #include "TestSuiteNewSession.h"
 
+#include <limits>
 #include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+   // Checks each criterion of the bad values in turn, independently of the tables built by BadValues
+   class ReferenceBadValues
+   {
+   public:
+      ReferenceBadValues(const BadValues* pBadValues) :
+         mLowerThreshold(-std::numeric_limits<double>::infinity()),
+         mUpperThreshold(std::numeric_limits<double>::infinity())
+      {
+         double tolerance = StringUtilities::fromDisplayString<double>(pBadValues->getBadValueTolerance());
+         if (pBadValues->getLowerBadValueThreshold().empty() == false)
+         {
+            mLowerThreshold =
+               StringUtilities::fromDisplayString<double>(pBadValues->getLowerBadValueThreshold()) + tolerance;
+         }
+         if (pBadValues->getUpperBadValueThreshold().empty() == false)
+         {
+            mUpperThreshold =
+               StringUtilities::fromDisplayString<double>(pBadValues->getUpperBadValueThreshold()) - tolerance;
+         }
+
+         const std::vector<std::pair<std::string, std::string> > ranges = pBadValues->getBadValueRanges();
+         for (std::vector<std::pair<std::string, std::string> >::const_iterator iter = ranges.begin();
+            iter != ranges.end(); ++iter)
+         {
+            mRanges.push_back(std::make_pair(StringUtilities::fromDisplayString<double>(iter->first) - tolerance,
+               StringUtilities::fromDisplayString<double>(iter->second) + tolerance));
+         }
+
+         const std::vector<std::string> values = pBadValues->getIndividualBadValues();
+         for (std::vector<std::string>::const_iterator iter = values.begin(); iter != values.end(); ++iter)
+         {
+            double value = StringUtilities::fromDisplayString<double>(*iter);
+            mRanges.push_back(std::make_pair(value - tolerance, value + tolerance));
+         }
+      }
+
+      bool isBadValue(double value) const
+      {
+         if (value < mLowerThreshold || value > mUpperThreshold)
+         {
+            return true;
+         }
+
+         for (std::vector<std::pair<double, double> >::const_iterator iter = mRanges.begin();
+            iter != mRanges.end(); ++iter)
+         {
+            if (value > iter->first && value < iter->second)
+            {
+               return true;
+            }
+         }
+
+         return false;
+      }
+
+   private:
+      double mLowerThreshold;
+      double mUpperThreshold;
+      std::vector<std::pair<double, double> > mRanges;
+   };
+
+   // Checks that the validity mask and isBadValue() agree with the reference scan for each value
+   template<typename T>
+   bool checkValidityMask(const BadValues* pBadValues, const std::vector<T>& values, EncodingType type)
+   {
+      std::vector<unsigned char> mask(values.size(), 2);
+      if (pBadValues->getValidityMask(&values.front(), type, values.size(), &mask.front()) == false)
+      {
+         return false;
+      }
+
+      ReferenceBadValues reference(pBadValues);
+      for (typename std::vector<T>::size_type i = 0; i < values.size(); ++i)
+      {
+         double value = static_cast<double>(values[i]);
+         bool bad = reference.isBadValue(value);
+         if (mask[i] != (bad ? 0 : 1) || pBadValues->isBadValue(value) != bad)
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   template<typename T>
+   std::vector<T> getIntegerValues(int first, int last)
+   {
+      std::vector<T> values;
+      for (int value = first; value <= last; ++value)
+      {
+         values.push_back(static_cast<T>(value));
+      }
+
+      return values;
+   }
+
+   template<typename T>
+   std::vector<T> getRealValues(double first, double last, double step)
+   {
+      std::vector<T> values;
+      for (double value = first; value <= last; value += step)
+      {
+         values.push_back(static_cast<T>(value));
+      }
+
+      values.push_back(std::numeric_limits<T>::quiet_NaN());
+      values.push_back(std::numeric_limits<T>::infinity());
+      values.push_back(-std::numeric_limits<T>::infinity());
+      return values;
+   }
+}
 
 class BadValuesTestCase : public TestCase
 {
@@ -145,12 +263,60 @@ public:
    }
 };
 
+class BadValuesValidityMaskTestCase : public TestCase
+{
+public:
+   BadValuesValidityMaskTestCase() : TestCase("ValidityMask") {}
+   bool run()
+   {
+      bool success(true);
+      FactoryResource<BadValues> pBadValues;
+      issearf(pBadValues.get() != NULL);
+
+      std::vector<std::string> badValuesStrs;
+      badValuesStrs.push_back("");                                           // no bad values
+      badValuesStrs.push_back("0");                                          // a single range
+      badValuesStrs.push_back("<-10, 3<>8, 6<>12, 12, >1000");               // overlapping ranges and thresholds
+      badValuesStrs.push_back("-7, 0, 5, 7, 9, 11, 13, 15, 100<>200, 40000"); // enough ranges for a binary search
+      badValuesStrs.push_back("<-100.5, 0.25<>0.75, >99.5");
+
+      for (std::vector<std::string>::const_iterator iter = badValuesStrs.begin(); iter != badValuesStrs.end(); ++iter)
+      {
+         issearf(pBadValues->setBadValues(*iter, "0.5"));
+         issea(checkValidityMask(pBadValues.get(), getIntegerValues<signed char>(-128, 127), INT1SBYTE));
+         issea(checkValidityMask(pBadValues.get(), getIntegerValues<unsigned char>(0, 255), INT1UBYTE));
+         issea(checkValidityMask(pBadValues.get(), getIntegerValues<short>(-32768, 32767), INT2SBYTES));
+         issea(checkValidityMask(pBadValues.get(), getIntegerValues<unsigned short>(0, 65535), INT2UBYTES));
+         issea(checkValidityMask(pBadValues.get(), getIntegerValues<int>(-2000, 50000), INT4SBYTES));
+         issea(checkValidityMask(pBadValues.get(), getIntegerValues<unsigned int>(0, 50000), INT4UBYTES));
+         issea(checkValidityMask(pBadValues.get(), getRealValues<float>(-200.0, 1200.0, 0.125), FLT4BYTES));
+         issea(checkValidityMask(pBadValues.get(), getRealValues<double>(-200.0, 1200.0, 0.0625), FLT8BYTES));
+      }
+
+      // Changing the bad values updates the lookup tables
+      issearf(pBadValues->setBadValues("10", "0.5"));
+      std::vector<unsigned char> values = getIntegerValues<unsigned char>(0, 255);
+      std::vector<unsigned char> mask(values.size());
+      issea(pBadValues->getValidityMask(&values.front(), INT1UBYTE, values.size(), &mask.front()));
+      issea(mask[10] == 0 && mask[20] == 1);
+      issearf(pBadValues->setBadValues("20", "0.5"));
+      issea(pBadValues->getValidityMask(&values.front(), INT1UBYTE, values.size(), &mask.front()));
+      issea(mask[10] == 1 && mask[20] == 0);
+
+      // Complex data is not supported
+      issea(pBadValues->getValidityMask(&values.front(), FLT8COMPLEX, 1, &mask.front()) == false);
+
+      return success;
+   }
+};
+
 class BadValuesTestSuite : public TestSuiteNewSession
 {
 public:
    BadValuesTestSuite() : TestSuiteNewSession("BadValues")
    {
       addTestCase(new BadValuesTestCase);
+      addTestCase(new BadValuesValidityMaskTestCase);
    }
 };
 
@@ -0,0 +1,965 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "assert.h"
+#include "ConfigurationSettings.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "DimensionDescriptor.h"
+#include "Executable.h"
+#include "Filename.h"
+#include "HighResolutionTimer.h"
+#include "ModelServices.h"
+#include "ObjectResource.h"
+#include "PlugInArgList.h"
+#include "PlugInResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterFileDescriptor.h"
+#include "RasterUtilities.h"
+#include "SessionManagerImp.h"
+#include "Statistics.h"
+#include "StringUtilities.h"
+#include "TestCase.h"
+#include "TestSuiteNewSession.h"
+#include "TypesFile.h"
+
+#if defined(WIN_API)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * The benchmarks run on synthetic rasters and are configured with the following environment variables:
+ *
+ *    OPTICKS_BENCHMARK_ROWS        The number of rows in the raster (default 1024)
+ *    OPTICKS_BENCHMARK_COLUMNS     The number of columns in the raster (default 1024)
+ *    OPTICKS_BENCHMARK_BANDS       The number of bands in the raster (default 8)
+ *    OPTICKS_BENCHMARK_DATA_TYPE   The data type as an EncodingType XML string, such as FLT4BYTES (default INT2UBYTES)
+ *    OPTICKS_BENCHMARK_INTERLEAVE  BIP, BIL or BSQ (default BIP)
+ *    OPTICKS_BENCHMARK_ITERATIONS  The number of timed iterations of each benchmark (default 5)
+ *    OPTICKS_BENCHMARK_WARMUP      The number of untimed iterations run first (default 1)
+ *    OPTICKS_BENCHMARK_OUTPUT      The directory for benchmark.json and benchmark.csv (default the temp path)
+ *    OPTICKS_BENCHMARK_BASELINE    A benchmark.csv from a previous run to compare against (default none)
+ *    OPTICKS_BENCHMARK_TOLERANCE   The percent increase in median time reported as a regression (default 10)
+ */
+namespace
+{
+   struct BenchmarkConfiguration
+   {
+      unsigned int mRows;
+      unsigned int mColumns;
+      unsigned int mBands;
+      EncodingType mDataType;
+      InterleaveFormatType mInterleave;
+      unsigned int mIterations;
+      unsigned int mWarmUp;
+      string mOutputPath;
+      string mBaselineFile;
+      double mTolerance;
+      bool mValid;
+   };
+
+   struct BenchmarkResult
+   {
+      string mName;
+      vector<double> mTimes;
+      double mBytes;
+      double mPeakResidentBytes;
+   };
+
+   string getEnvironment(const char* pName, const string& defaultValue)
+   {
+      const char* pValue = getenv(pName);
+      if (pValue == NULL || *pValue == '\0')
+      {
+         return defaultValue;
+      }
+
+      return pValue;
+   }
+
+   unsigned int getEnvironment(const char* pName, unsigned int defaultValue)
+   {
+      unsigned int value = defaultValue;
+      string text = getEnvironment(pName, string());
+      if (text.empty() == false)
+      {
+         stringstream stream(text);
+         stream >> value;
+      }
+
+      return value;
+   }
+
+   string getTempPath()
+   {
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      if (pTempPath == NULL)
+      {
+         return string();
+      }
+
+      return pTempPath->getFullPathAndName();
+   }
+
+   const BenchmarkConfiguration& getConfiguration()
+   {
+      static BenchmarkConfiguration config;
+      static bool initialized = false;
+      if (initialized == false)
+      {
+         initialized = true;
+         config.mRows = getEnvironment("OPTICKS_BENCHMARK_ROWS", 1024U);
+         config.mColumns = getEnvironment("OPTICKS_BENCHMARK_COLUMNS", 1024U);
+         config.mBands = getEnvironment("OPTICKS_BENCHMARK_BANDS", 8U);
+         config.mIterations = getEnvironment("OPTICKS_BENCHMARK_ITERATIONS", 5U);
+         config.mWarmUp = getEnvironment("OPTICKS_BENCHMARK_WARMUP", 1U);
+         config.mOutputPath = getEnvironment("OPTICKS_BENCHMARK_OUTPUT", getTempPath());
+         config.mBaselineFile = getEnvironment("OPTICKS_BENCHMARK_BASELINE", string());
+         config.mTolerance = getEnvironment("OPTICKS_BENCHMARK_TOLERANCE", 10U) / 100.0;
+
+         bool dataTypeError = false;
+         bool interleaveError = false;
+         config.mDataType = StringUtilities::fromXmlString<EncodingType>(
+            getEnvironment("OPTICKS_BENCHMARK_DATA_TYPE", string("INT2UBYTES")), &dataTypeError);
+         config.mInterleave = StringUtilities::fromXmlString<InterleaveFormatType>(
+            getEnvironment("OPTICKS_BENCHMARK_INTERLEAVE", string("BIP")), &interleaveError);
+
+         // The synthetic data and the algorithms being measured require real valued data
+         config.mValid = !dataTypeError && !interleaveError && config.mDataType.isValid() &&
+            config.mDataType != INT4SCOMPLEX && config.mDataType != FLT8COMPLEX && config.mInterleave.isValid() &&
+            config.mRows > 0 && config.mColumns > 0 && config.mBands > 0 && config.mIterations > 0;
+         if (config.mValid == false)
+         {
+            printf("The benchmark configuration is not valid.\n");
+         }
+      }
+
+      return config;
+   }
+
+   vector<BenchmarkResult>& getResults()
+   {
+      static vector<BenchmarkResult> results;
+      return results;
+   }
+
+   double getPeakResidentBytes()
+   {
+#if defined(WIN_API)
+      PROCESS_MEMORY_COUNTERS counters;
+      if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) == FALSE)
+      {
+         return 0.0;
+      }
+
+      return static_cast<double>(counters.PeakWorkingSetSize);
+#else
+      struct rusage usage;
+      if (getrusage(RUSAGE_SELF, &usage) != 0)
+      {
+         return 0.0;
+      }
+
+#if defined(SOLARIS)
+      return static_cast<double>(usage.ru_maxrss) * sysconf(_SC_PAGESIZE);
+#else
+      return static_cast<double>(usage.ru_maxrss) * 1024.0;
+#endif
+#endif
+   }
+
+   /**
+    * Returns the value below which the given fraction of the sorted times fall, interpolating between samples.
+    */
+   double getPercentile(const vector<double>& sortedTimes, double fraction)
+   {
+      if (sortedTimes.empty())
+      {
+         return 0.0;
+      }
+
+      double position = fraction * (sortedTimes.size() - 1);
+      size_t lower = static_cast<size_t>(position);
+      size_t upper = min(lower + 1, sortedTimes.size() - 1);
+      return sortedTimes[lower] + (sortedTimes[upper] - sortedTimes[lower]) * (position - lower);
+   }
+
+   double getMedian(const BenchmarkResult& result)
+   {
+      vector<double> sortedTimes(result.mTimes);
+      sort(sortedTimes.begin(), sortedTimes.end());
+      return getPercentile(sortedTimes, 0.5);
+   }
+
+   template<typename T>
+   void fillRow(T* pRow, size_t count, size_t seed)
+   {
+      for (size_t i = 0; i < count; ++i)
+      {
+         pRow[i] = static_cast<T>((seed + i * 31) % 251);
+      }
+   }
+
+   void fillRow(EncodingType dataType, void* pRow, size_t count, size_t seed)
+   {
+      switch (dataType)
+      {
+      case INT1UBYTE:
+         fillRow(reinterpret_cast<unsigned char*>(pRow), count, seed);
+         break;
+      case INT1SBYTE:
+         fillRow(reinterpret_cast<signed char*>(pRow), count, seed);
+         break;
+      case INT2UBYTES:
+         fillRow(reinterpret_cast<unsigned short*>(pRow), count, seed);
+         break;
+      case INT2SBYTES:
+         fillRow(reinterpret_cast<short*>(pRow), count, seed);
+         break;
+      case INT4UBYTES:
+         fillRow(reinterpret_cast<unsigned int*>(pRow), count, seed);
+         break;
+      case INT4SBYTES:
+         fillRow(reinterpret_cast<int*>(pRow), count, seed);
+         break;
+      case FLT4BYTES:
+         fillRow(reinterpret_cast<float*>(pRow), count, seed);
+         break;
+      case FLT8BYTES:
+         fillRow(reinterpret_cast<double*>(pRow), count, seed);
+         break;
+      default:
+         break;
+      }
+   }
+
+   /**
+    * Creates a raster with the configured size, data type and interleave and fills it with synthetic data.
+    */
+   RasterElement* createBenchmarkRaster(const string& name, bool inMemory)
+   {
+      const BenchmarkConfiguration& config = getConfiguration();
+      ModelResource<RasterElement> pElement(RasterUtilities::createRasterElement(name, config.mRows,
+         config.mColumns, config.mBands, config.mDataType, config.mInterleave, inMemory));
+      if (pElement.get() == NULL)
+      {
+         return NULL;
+      }
+
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      if (pDescriptor == NULL)
+      {
+         return NULL;
+      }
+
+      // BSQ data is written one band at a time
+      const bool bsq = config.mInterleave == BSQ;
+      const unsigned int passes = bsq ? config.mBands : 1;
+      const size_t rowElements = static_cast<size_t>(config.mColumns) * (bsq ? 1 : config.mBands);
+      for (unsigned int pass = 0; pass < passes; ++pass)
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setWritable(true);
+         if (bsq)
+         {
+            pRequest->setBands(pDescriptor->getActiveBand(pass), pDescriptor->getActiveBand(pass), 1);
+         }
+
+         DataAccessor accessor = pElement->getDataAccessor(pRequest.release());
+         for (unsigned int row = 0; row < config.mRows; ++row)
+         {
+            if (accessor.isValid() == false)
+            {
+               return NULL;
+            }
+
+            fillRow(config.mDataType, accessor->getRow(), rowElements,
+               (static_cast<size_t>(pass) * config.mRows + row) * 7);
+            accessor->nextRow();
+         }
+      }
+
+      pElement->updateData();
+      return pElement.release();
+   }
+
+   double getCubeBytes()
+   {
+      const BenchmarkConfiguration& config = getConfiguration();
+      return static_cast<double>(config.mRows) * config.mColumns * config.mBands *
+         RasterUtilities::bytesInEncoding(config.mDataType);
+   }
+
+   void destroyElement(DataElement* pElement)
+   {
+      if (pElement != NULL)
+      {
+         Service<ModelServices>()->destroyElement(pElement);
+      }
+   }
+}
+
+/**
+ * Times a benchmark and records the result for BenchmarkReportTestCase.
+ *
+ * run() calls setUp(), runs iterate() the configured number of warm-up times
+ * and then the configured number of timed times, and finally calls tearDown().
+ */
+class BenchmarkTestCase : public TestCase
+{
+public:
+   BenchmarkTestCase(const string& name) : TestCase(name) {}
+
+   bool run()
+   {
+      bool success = true;
+      const BenchmarkConfiguration& config = getConfiguration();
+      issearf(config.mValid);
+
+      bool ok = setUp();
+      for (unsigned int i = 0; ok && i < config.mWarmUp; ++i)
+      {
+         ok = iterate();
+      }
+
+      BenchmarkResult result;
+      result.mName = getName();
+      result.mBytes = getBytesPerIteration();
+      for (unsigned int i = 0; ok && i < config.mIterations; ++i)
+      {
+         double milliseconds = 0.0;
+         {
+            HrTimer::Resource timer(&milliseconds);
+            ok = iterate();
+         }
+         result.mTimes.push_back(milliseconds);
+      }
+
+      result.mPeakResidentBytes = getPeakResidentBytes();
+      tearDown();
+      issearf(ok);
+
+      getResults().push_back(result);
+      printf("%s: median %f ms over %u iterations\n", result.mName.c_str(), getMedian(result),
+         static_cast<unsigned int>(result.mTimes.size()));
+
+      return success;
+   }
+
+protected:
+   virtual bool setUp()
+   {
+      return true;
+   }
+
+   virtual bool iterate() = 0;
+
+   virtual void tearDown()
+   {}
+
+   virtual double getBytesPerIteration() const
+   {
+      return getCubeBytes();
+   }
+};
+
+class PagingBenchmarkTestCase : public BenchmarkTestCase
+{
+public:
+   PagingBenchmarkTestCase(bool inMemory) :
+      BenchmarkTestCase(inMemory ? "PagingInMemory" : "PagingOnDisk"),
+      mInMemory(inMemory),
+      mpElement(NULL),
+      mChecksum(0)
+   {}
+
+protected:
+   bool setUp()
+   {
+      mpElement = createBenchmarkRaster("BenchmarkPaging", mInMemory);
+      return mpElement != NULL;
+   }
+
+   bool iterate()
+   {
+      const BenchmarkConfiguration& config = getConfiguration();
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(mpElement->getDataDescriptor());
+      const bool bsq = config.mInterleave == BSQ;
+      const unsigned int passes = bsq ? config.mBands : 1;
+      for (unsigned int pass = 0; pass < passes; ++pass)
+      {
+         FactoryResource<DataRequest> pRequest;
+         if (bsq)
+         {
+            pRequest->setBands(pDescriptor->getActiveBand(pass), pDescriptor->getActiveBand(pass), 1);
+         }
+
+         DataAccessor accessor = mpElement->getDataAccessor(pRequest.release());
+         for (unsigned int row = 0; row < config.mRows; ++row)
+         {
+            if (accessor.isValid() == false)
+            {
+               return false;
+            }
+
+            // Touch the row so that the pager has to deliver it
+            mChecksum += *reinterpret_cast<const unsigned char*>(accessor->getRow());
+            accessor->nextRow();
+         }
+      }
+
+      return true;
+   }
+
+   void tearDown()
+   {
+      destroyElement(mpElement);
+      mpElement = NULL;
+   }
+
+private:
+   bool mInMemory;
+   RasterElement* mpElement;
+   size_t mChecksum;
+};
+
+class StatisticsBenchmarkTestCase : public BenchmarkTestCase
+{
+public:
+   StatisticsBenchmarkTestCase() :
+      BenchmarkTestCase("Statistics"),
+      mpElement(NULL)
+   {}
+
+protected:
+   bool setUp()
+   {
+      mpElement = createBenchmarkRaster("BenchmarkStatistics", true);
+      return mpElement != NULL;
+   }
+
+   bool iterate()
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(mpElement->getDataDescriptor());
+      Statistics* pStatistics = mpElement->getStatistics(pDescriptor->getActiveBand(0));
+      if (pStatistics == NULL)
+      {
+         return false;
+      }
+
+      // Changing the resolution discards the previously calculated values
+      pStatistics->setStatisticsResolution(2);
+      pStatistics->setStatisticsResolution(1);
+      return pStatistics->getPercentiles() != NULL;
+   }
+
+   void tearDown()
+   {
+      destroyElement(mpElement);
+      mpElement = NULL;
+   }
+
+   double getBytesPerIteration() const
+   {
+      return getCubeBytes() / getConfiguration().mBands;
+   }
+
+private:
+   RasterElement* mpElement;
+};
+
+class BandMathBenchmarkTestCase : public BenchmarkTestCase
+{
+public:
+   BandMathBenchmarkTestCase() :
+      BenchmarkTestCase("BandMath"),
+      mpElement(NULL)
+   {}
+
+protected:
+   bool setUp()
+   {
+      mpElement = createBenchmarkRaster("BenchmarkBandMath", true);
+      return mpElement != NULL;
+   }
+
+   bool iterate()
+   {
+      bool useDegrees = false;
+      bool displayResults = false;
+      string expression = getConfiguration().mBands > 1 ? "b1*2+b2/3" : "b1*2+1";
+
+      ExecutableResource pBandMath("Band Math", string(), NULL, true);
+      if (pBandMath.get() == NULL ||
+         pBandMath->getInArgList().setPlugInArgValue(Executable::DataElementArg(), mpElement) == false ||
+         pBandMath->getInArgList().setPlugInArgValue("Degrees", &useDegrees) == false ||
+         pBandMath->getInArgList().setPlugInArgValue("Display Results", &displayResults) == false ||
+         pBandMath->getInArgList().setPlugInArgValue("Input Expression", &expression) == false ||
+         pBandMath->execute() == false)
+      {
+         return false;
+      }
+
+      RasterElement* pResult = pBandMath->getOutArgList().getPlugInArgValue<RasterElement>("Band Math Result");
+      destroyElement(pResult);
+      return pResult != NULL;
+   }
+
+   void tearDown()
+   {
+      destroyElement(mpElement);
+      mpElement = NULL;
+   }
+
+private:
+   RasterElement* mpElement;
+};
+
+/**
+ * The second moment matrix is stored with the raster on the first iteration, so
+ * the timed iterations measure the transform of the data.
+ */
+class PrincipalComponentAnalysisBenchmarkTestCase : public BenchmarkTestCase
+{
+public:
+   PrincipalComponentAnalysisBenchmarkTestCase() :
+      BenchmarkTestCase("PrincipalComponentAnalysis"),
+      mpElement(NULL)
+   {}
+
+protected:
+   bool setUp()
+   {
+      mpElement = createBenchmarkRaster("BenchmarkPca", true);
+      return mpElement != NULL;
+   }
+
+   bool iterate()
+   {
+      ExecutableResource pPlugIn("Principal Component Analysis");
+      if (pPlugIn.get() == NULL)
+      {
+         return false;
+      }
+
+      PlugInArgList& argsIn = pPlugIn->getInArgList();
+      string transformType = "Second Moment";
+      int components = static_cast<int>(getConfiguration().mBands);
+      EncodingType outputEncodingType = FLT4BYTES;
+      int maxScaleValue = static_cast<int>(numeric_limits<unsigned char>::max());
+      if (argsIn.setPlugInArgValue(Executable::DataElementArg(), mpElement) == false ||
+         argsIn.setPlugInArgValue<string>("Transform Type", &transformType) == false ||
+         argsIn.setPlugInArgValue<int>("Components", &components) == false ||
+         argsIn.setPlugInArgValue<EncodingType>("Output Encoding Type", &outputEncodingType) == false ||
+         argsIn.setPlugInArgValue<int>("Max Scale Value", &maxScaleValue) == false ||
+         pPlugIn->execute() == false)
+      {
+         return false;
+      }
+
+      RasterElement* pResult = pPlugIn->getOutArgList().getPlugInArgValue<RasterElement>("Corrected Data Cube");
+      destroyElement(pResult);
+      return pResult != NULL;
+   }
+
+   void tearDown()
+   {
+      destroyElement(mpElement);
+      mpElement = NULL;
+   }
+
+private:
+   RasterElement* mpElement;
+};
+
+class ConvolutionBenchmarkTestCase : public BenchmarkTestCase
+{
+public:
+   ConvolutionBenchmarkTestCase() :
+      BenchmarkTestCase("Convolution"),
+      mpElement(NULL)
+   {}
+
+protected:
+   bool setUp()
+   {
+      mpElement = createBenchmarkRaster("BenchmarkConvolution", true);
+      return mpElement != NULL;
+   }
+
+   bool iterate()
+   {
+      EigenRowMajorXf kernel(5, 5);
+      kernel.setConstant(1.0f / 25.0f);
+
+      vector<unsigned int> bandNumbers;
+      for (unsigned int band = 0; band < getConfiguration().mBands; ++band)
+      {
+         bandNumbers.push_back(band);
+      }
+
+      string resultName = "BenchmarkConvolutionResult";
+      ExecutableResource pPlugIn("Generic Convolution", string(), NULL, true);
+      if (pPlugIn.get() == NULL)
+      {
+         return false;
+      }
+
+      PlugInArgList& argsIn = pPlugIn->getInArgList();
+      if (argsIn.setPlugInArgValue(Executable::DataElementArg(), mpElement) == false ||
+         argsIn.setPlugInArgValue("Band Numbers", &bandNumbers) == false ||
+         argsIn.setPlugInArgValue("Result Name", &resultName) == false ||
+         argsIn.setPlugInArgValue("Kernel", &kernel) == false ||
+         pPlugIn->execute() == false)
+      {
+         return false;
+      }
+
+      RasterElement* pResult = pPlugIn->getOutArgList().getPlugInArgValue<RasterElement>("Data Element");
+      destroyElement(pResult);
+      return pResult != NULL;
+   }
+
+   void tearDown()
+   {
+      destroyElement(mpElement);
+      mpElement = NULL;
+   }
+
+private:
+   RasterElement* mpElement;
+};
+
+class IceExportBenchmarkTestCase : public BenchmarkTestCase
+{
+public:
+   IceExportBenchmarkTestCase() :
+      BenchmarkTestCase("IceExport"),
+      mpElement(NULL)
+   {}
+
+protected:
+   bool setUp()
+   {
+      mpElement = createBenchmarkRaster("BenchmarkIceExport", true);
+      return mpElement != NULL;
+   }
+
+   bool iterate()
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(mpElement->getDataDescriptor());
+      FactoryResource<RasterFileDescriptor> pExportDescriptor(dynamic_cast<RasterFileDescriptor*>(
+         RasterUtilities::generateFileDescriptorForExport(pDescriptor, getTempPath() + SLASH +
+         "benchmarkExport.ice.h5")));
+      if (pExportDescriptor.get() == NULL)
+      {
+         return false;
+      }
+
+      ExporterResource exporter("Ice Exporter", mpElement, pExportDescriptor.get(), NULL);
+      return exporter->execute();
+   }
+
+   void tearDown()
+   {
+      destroyElement(mpElement);
+      mpElement = NULL;
+   }
+
+private:
+   RasterElement* mpElement;
+};
+
+class IceImportBenchmarkTestCase : public BenchmarkTestCase
+{
+public:
+   IceImportBenchmarkTestCase() :
+      BenchmarkTestCase("IceImport")
+   {}
+
+protected:
+   bool setUp()
+   {
+      ModelResource<RasterElement> pElement(createBenchmarkRaster("BenchmarkIceImport", true));
+      if (pElement.get() == NULL)
+      {
+         return false;
+      }
+
+      mFilename = getTempPath() + SLASH + "benchmarkImport.ice.h5";
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      FactoryResource<RasterFileDescriptor> pExportDescriptor(dynamic_cast<RasterFileDescriptor*>(
+         RasterUtilities::generateFileDescriptorForExport(pDescriptor, mFilename)));
+      if (pExportDescriptor.get() == NULL)
+      {
+         return false;
+      }
+
+      ExporterResource exporter("Ice Exporter", pElement.get(), pExportDescriptor.get(), NULL);
+      return exporter->execute();
+   }
+
+   bool iterate()
+   {
+      ImporterResource importer("Ice Importer", mFilename, NULL, true);
+      if (importer->execute() == false)
+      {
+         return false;
+      }
+
+      vector<DataElement*> elements = importer->getImportedElements();
+      for (vector<DataElement*>::iterator iter = elements.begin(); iter != elements.end(); ++iter)
+      {
+         destroyElement(*iter);
+      }
+
+      return elements.size() == 1;
+   }
+
+private:
+   string mFilename;
+};
+
+class SessionSaveBenchmarkTestCase : public BenchmarkTestCase
+{
+public:
+   SessionSaveBenchmarkTestCase() :
+      BenchmarkTestCase("SessionSave"),
+      mpElement(NULL)
+   {}
+
+protected:
+   bool setUp()
+   {
+      mpElement = createBenchmarkRaster("BenchmarkSessionSave", true);
+      return mpElement != NULL;
+   }
+
+   bool iterate()
+   {
+      return SessionManagerImp::instance()->serialize(getTempPath() + SLASH + "benchmarkSave.session",
+         NULL).first == SessionManager::SUCCESS;
+   }
+
+   void tearDown()
+   {
+      destroyElement(mpElement);
+      mpElement = NULL;
+   }
+
+private:
+   RasterElement* mpElement;
+};
+
+class SessionLoadBenchmarkTestCase : public BenchmarkTestCase
+{
+public:
+   SessionLoadBenchmarkTestCase() :
+      BenchmarkTestCase("SessionLoad")
+   {}
+
+protected:
+   bool setUp()
+   {
+      ModelResource<RasterElement> pElement(createBenchmarkRaster("BenchmarkSessionLoad", true));
+      mFilename = getTempPath() + SLASH + "benchmarkLoad.session";
+      return pElement.get() != NULL &&
+         SessionManagerImp::instance()->serialize(mFilename, NULL).first == SessionManager::SUCCESS;
+   }
+
+   bool iterate()
+   {
+      return SessionManagerImp::instance()->open(mFilename, NULL);
+   }
+
+   void tearDown()
+   {
+      SessionManagerImp::instance()->newSession();
+   }
+
+private:
+   string mFilename;
+};
+
+/**
+ * Writes the recorded results to benchmark.json and benchmark.csv and fails if
+ * any median time exceeds the baseline by more than the configured tolerance.
+ */
+class BenchmarkReportTestCase : public TestCase
+{
+public:
+   BenchmarkReportTestCase() : TestCase("Report") {}
+
+   bool run()
+   {
+      bool success = true;
+      const BenchmarkConfiguration& config = getConfiguration();
+      issearf(config.mValid);
+
+      const vector<BenchmarkResult>& results = getResults();
+      issearf(results.empty() == false);
+
+      ofstream json((config.mOutputPath + SLASH + "benchmark.json").c_str());
+      ofstream csv((config.mOutputPath + SLASH + "benchmark.csv").c_str());
+      issearf(json.good() && csv.good());
+
+      json << "{\n"
+         << "  \"configuration\": {\n"
+         << "    \"rows\": " << config.mRows << ",\n"
+         << "    \"columns\": " << config.mColumns << ",\n"
+         << "    \"bands\": " << config.mBands << ",\n"
+         << "    \"data_type\": \"" << StringUtilities::toXmlString(config.mDataType) << "\",\n"
+         << "    \"interleave\": \"" << StringUtilities::toXmlString(config.mInterleave) << "\",\n"
+         << "    \"iterations\": " << config.mIterations << ",\n"
+         << "    \"warm_up\": " << config.mWarmUp << "\n"
+         << "  },\n"
+         << "  \"benchmarks\": [\n";
+      csv << "name,iterations,min_ms,median_ms,p90_ms,p95_ms,max_ms,throughput_mb_s,peak_rss_mb\n";
+
+      for (vector<BenchmarkResult>::const_iterator iter = results.begin(); iter != results.end(); ++iter)
+      {
+         vector<double> sortedTimes(iter->mTimes);
+         sort(sortedTimes.begin(), sortedTimes.end());
+
+         const double megabyte = 1024.0 * 1024.0;
+         const double median = getPercentile(sortedTimes, 0.5);
+         const double throughput = median > 0.0 ? (iter->mBytes / megabyte) / (median / 1000.0) : 0.0;
+         const double peakResident = iter->mPeakResidentBytes / megabyte;
+
+         json << "    {\n"
+            << "      \"name\": \"" << iter->mName << "\",\n"
+            << "      \"iterations\": " << sortedTimes.size() << ",\n"
+            << "      \"min_ms\": " << sortedTimes.front() << ",\n"
+            << "      \"median_ms\": " << median << ",\n"
+            << "      \"p90_ms\": " << getPercentile(sortedTimes, 0.9) << ",\n"
+            << "      \"p95_ms\": " << getPercentile(sortedTimes, 0.95) << ",\n"
+            << "      \"max_ms\": " << sortedTimes.back() << ",\n"
+            << "      \"throughput_mb_s\": " << throughput << ",\n"
+            << "      \"peak_rss_mb\": " << peakResident << "\n"
+            << "    }" << (iter + 1 == results.end() ? "\n" : ",\n");
+
+         csv << iter->mName << "," << sortedTimes.size() << "," << sortedTimes.front() << "," << median << "," <<
+            getPercentile(sortedTimes, 0.9) << "," << getPercentile(sortedTimes, 0.95) << "," <<
+            sortedTimes.back() << "," << throughput << "," << peakResident << "\n";
+      }
+
+      json << "  ]\n"
+         << "}\n";
+
+      if (config.mBaselineFile.empty() == false)
+      {
+         issea(compareToBaseline(config.mBaselineFile, config.mTolerance));
+      }
+
+      return success;
+   }
+
+private:
+   bool compareToBaseline(const string& filename, double tolerance)
+   {
+      ifstream baseline(filename.c_str());
+      if (baseline.good() == false)
+      {
+         printf("Unable to read the benchmark baseline %s.\n", filename.c_str());
+         return false;
+      }
+
+      string line;
+      getline(baseline, line);
+      vector<string> header = StringUtilities::split(line, ',');
+      vector<string>::const_iterator nameColumn = find(header.begin(), header.end(), "name");
+      vector<string>::const_iterator medianColumn = find(header.begin(), header.end(), "median_ms");
+      if (nameColumn == header.end() || medianColumn == header.end())
+      {
+         printf("The benchmark baseline %s does not have name and median_ms columns.\n", filename.c_str());
+         return false;
+      }
+
+      const size_t nameIndex = nameColumn - header.begin();
+      const size_t medianIndex = medianColumn - header.begin();
+
+      bool passed = true;
+      while (getline(baseline, line))
+      {
+         vector<string> fields = StringUtilities::split(line, ',');
+         if (fields.size() <= max(nameIndex, medianIndex))
+         {
+            continue;
+         }
+
+         bool error = false;
+         double baselineMedian = StringUtilities::fromXmlString<double>(fields[medianIndex], &error);
+         if (error)
+         {
+            continue;
+         }
+
+         const vector<BenchmarkResult>& results = getResults();
+         for (vector<BenchmarkResult>::const_iterator iter = results.begin(); iter != results.end(); ++iter)
+         {
+            if (iter->mName == fields[nameIndex])
+            {
+               double median = getMedian(*iter);
+               if (median > baselineMedian * (1.0 + tolerance))
+               {
+                  printf("REGRESSION: %s median %f ms exceeds the baseline of %f ms by more than %.0f%%.\n",
+                     iter->mName.c_str(), median, baselineMedian, tolerance * 100.0);
+                  passed = false;
+               }
+            }
+         }
+      }
+
+      return passed;
+   }
+};
+
+class BenchmarkTestSuite : public TestSuiteNewSession
+{
+public:
+   BenchmarkTestSuite() : TestSuiteNewSession("Benchmark")
+   {
+      addTestCase(new PagingBenchmarkTestCase(true));
+      addTestCase(new PagingBenchmarkTestCase(false));
+      addTestCase(new StatisticsBenchmarkTestCase);
+      addTestCase(new BandMathBenchmarkTestCase);
+      addTestCase(new PrincipalComponentAnalysisBenchmarkTestCase);
+      addTestCase(new ConvolutionBenchmarkTestCase);
+      addTestCase(new IceExportBenchmarkTestCase);
+      addTestCase(new IceImportBenchmarkTestCase);
+      addTestCase(new SessionSaveBenchmarkTestCase);
+      addTestCase(new SessionLoadBenchmarkTestCase);
+      addTestCase(new BenchmarkReportTestCase);
+   }
+};
+
+REGISTER_SUITE(BenchmarkTestSuite)
@@ -0,0 +1,284 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "assert.h"
+#include "BlockCompression.h"
+#include "CompressedPager.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "ModelServices.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterUtilities.h"
+#include "TestBedTestUtilities.h"
+#include "TestSuiteNewSession.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   const unsigned int NUM_ROWS = 600;
+   const unsigned int NUM_COLUMNS = 300;
+   const unsigned int NUM_BANDS = 3;
+
+   class WorkingSetSizeResource
+   {
+   public:
+      WorkingSetSizeResource(unsigned int workingSetSize) :
+         mOriginalWorkingSetSize(CompressedPager::getSettingWorkingSetSize())
+      {
+         CompressedPager::setSettingWorkingSetSize(workingSetSize);
+      }
+
+      ~WorkingSetSizeResource()
+      {
+         CompressedPager::setSettingWorkingSetSize(mOriginalWorkingSetSize);
+      }
+
+   private:
+      unsigned int mOriginalWorkingSetSize;
+   };
+}
+
+class BlockCompressionRoundTripTestCase : public TestCase
+{
+public:
+   BlockCompressionRoundTripTestCase() : TestCase("BlockCompressionRoundTrip") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      vector<unsigned short> source(10000);
+      for (size_t i = 0; i < source.size(); ++i)
+      {
+         source[i] = static_cast<unsigned short>((i / 16) % 300);
+      }
+      const size_t sourceBytes = source.size() * sizeof(unsigned short);
+
+      vector<char> shuffled(sourceBytes);
+      BlockCompression::shuffle(&source[0], &shuffled[0], source.size(), sizeof(unsigned short));
+
+      vector<char> compressed(BlockCompression::getMaxCompressedSize(sourceBytes));
+      size_t compressedSize = BlockCompression::compress(&shuffled[0], sourceBytes, &compressed[0],
+         compressed.size());
+      issearf(compressedSize > 0);
+      issea(compressedSize < sourceBytes);
+
+      vector<char> decompressed(sourceBytes);
+      issearf(BlockCompression::decompress(&compressed[0], compressedSize, &decompressed[0], sourceBytes));
+
+      vector<unsigned short> restored(source.size());
+      BlockCompression::unshuffle(&decompressed[0], &restored[0], source.size(), sizeof(unsigned short));
+      issea(restored == source);
+
+      // Incompressible data must still round trip within the advertised bound
+      vector<unsigned char> noise(5000);
+      unsigned int seed = 1;
+      for (size_t i = 0; i < noise.size(); ++i)
+      {
+         seed = seed * 1103515245U + 12345U;
+         noise[i] = static_cast<unsigned char>(seed >> 16);
+      }
+      compressed.resize(BlockCompression::getMaxCompressedSize(noise.size()));
+      compressedSize = BlockCompression::compress(&noise[0], noise.size(), &compressed[0], compressed.size());
+      issearf(compressedSize > 0);
+      vector<unsigned char> noiseOut(noise.size());
+      issea(BlockCompression::decompress(&compressed[0], compressedSize, &noiseOut[0], noiseOut.size()));
+      issea(noiseOut == noise);
+
+      // Truncated input must be rejected rather than overrunning the destination
+      issea(BlockCompression::decompress(&compressed[0], compressedSize / 2, &noiseOut[0], noiseOut.size()) == false);
+
+      return success;
+   }
+};
+
+class CompressedPagerRoundTripTestCase : public TestCase
+{
+public:
+   CompressedPagerRoundTripTestCase() : TestCase("RoundTrip") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      const InterleaveFormatType interleaves[] = { BIP, BIL, BSQ };
+      for (unsigned int i = 0; i < sizeof(interleaves) / sizeof(interleaves[0]); ++i)
+      {
+         ModelResource<RasterElement> pRaster(TestUtilities::createBlockPagedElement("CompressedRoundTrip",
+            IN_MEMORY_COMPRESSED, interleaves[i], NUM_ROWS, NUM_COLUMNS, NUM_BANDS));
+         issearf(pRaster.get() != NULL);
+
+         CompressedPager* pPager = dynamic_cast<CompressedPager*>(pRaster->getPager());
+         issearf(pPager != NULL);
+
+         issearf(TestUtilities::fillBlockPagedElement(pRaster.get()));
+         for (unsigned int band = 0; band < NUM_BANDS; ++band)
+         {
+            issearf(TestUtilities::verifyBlockPagedBand(pRaster.get(), band, 0, NUM_ROWS - 1));
+         }
+
+         // The generated data is highly redundant, so it must be stored smaller than the raw cube
+         uint64_t rawSize = static_cast<uint64_t>(NUM_ROWS) * NUM_COLUMNS * NUM_BANDS * sizeof(unsigned short);
+         issea(pPager->getCompressedSize() > 0);
+         issea(pPager->getCompressedSize() < rawSize);
+      }
+
+      return success;
+   }
+};
+
+class CompressedPagerRandomAccessTestCase : public TestCase
+{
+public:
+   CompressedPagerRandomAccessTestCase() : TestCase("RandomAccess") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      ModelResource<RasterElement> pRaster(TestUtilities::createBlockPagedElement("CompressedRandomAccess",
+         IN_MEMORY_COMPRESSED, BIP, NUM_ROWS, NUM_COLUMNS, NUM_BANDS));
+      issearf(pRaster.get() != NULL);
+      issearf(TestUtilities::fillBlockPagedElement(pRaster.get()));
+
+      CompressedPager* pPager = dynamic_cast<CompressedPager*>(pRaster->getPager());
+      issearf(pPager != NULL);
+      issea(pPager->getBlockCount() > 1);
+
+      srand(42);
+      for (int i = 0; i < 100; ++i)
+      {
+         unsigned int startRow = rand() % NUM_ROWS;
+         unsigned int stopRow = min(startRow + static_cast<unsigned int>(rand() % 20), NUM_ROWS - 1);
+         unsigned int band = rand() % NUM_BANDS;
+         issearf(TestUtilities::verifyBlockPagedBand(pRaster.get(), band, startRow, stopRow));
+      }
+
+      // Overwriting a single row must not disturb its neighbors in the same block
+      RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      issearf(pDescriptor != NULL);
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setRows(pDescriptor->getActiveRow(NUM_ROWS / 2), pDescriptor->getActiveRow(NUM_ROWS / 2));
+         pRequest->setWritable(true);
+         DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+         issearf(da.isValid());
+         memset(da->getRow(), 0, NUM_COLUMNS * NUM_BANDS * sizeof(unsigned short));
+      }
+
+      issea(TestUtilities::verifyBlockPagedBand(pRaster.get(), 0, 0, NUM_ROWS / 2 - 1));
+      issea(TestUtilities::verifyBlockPagedBand(pRaster.get(), 0, NUM_ROWS / 2 + 1, NUM_ROWS - 1));
+
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setRows(pDescriptor->getActiveRow(NUM_ROWS / 2), pDescriptor->getActiveRow(NUM_ROWS / 2));
+      DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+      issearf(da.isValid());
+      const unsigned short* pData = reinterpret_cast<const unsigned short*>(da->getRow());
+      for (unsigned int i = 0; i < NUM_COLUMNS * NUM_BANDS; ++i)
+      {
+         issearf(pData[i] == 0);
+      }
+
+      return success;
+   }
+};
+
+class CompressedPagerConcurrentReadTestCase : public TestCase
+{
+public:
+   CompressedPagerConcurrentReadTestCase() : TestCase("ConcurrentRead") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      ModelResource<RasterElement> pRaster(TestUtilities::createBlockPagedElement("CompressedConcurrentRead",
+         IN_MEMORY_COMPRESSED, BSQ, NUM_ROWS, NUM_COLUMNS, NUM_BANDS));
+      issearf(pRaster.get() != NULL);
+      issearf(TestUtilities::fillBlockPagedElement(pRaster.get()));
+
+      issea(TestUtilities::verifyBlockPagedElementConcurrently(pRaster.get(), 4));
+
+      return success;
+   }
+};
+
+class CompressedPagerWorkingSetSizeTestCase : public TestCase
+{
+public:
+   CompressedPagerWorkingSetSizeTestCase() : TestCase("WorkingSetSize") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      // The cube is larger than the working set, so the setting must limit the decompressed blocks
+      const unsigned int numRows = NUM_ROWS * 4;
+      const uint64_t rawSize = static_cast<uint64_t>(numRows) * NUM_COLUMNS * NUM_BANDS * sizeof(unsigned short);
+      const unsigned int workingSetSize = 1;
+      {
+         WorkingSetSizeResource setting(workingSetSize);
+         ModelResource<RasterElement> pRaster(TestUtilities::createBlockPagedElement("CompressedWorkingSetSize",
+            IN_MEMORY_COMPRESSED, BSQ, numRows, NUM_COLUMNS, NUM_BANDS));
+         issearf(pRaster.get() != NULL);
+
+         CompressedPager* pPager = dynamic_cast<CompressedPager*>(pRaster->getPager());
+         issearf(pPager != NULL);
+
+         issearf(TestUtilities::fillBlockPagedElement(pRaster.get()));
+         for (unsigned int band = 0; band < NUM_BANDS; ++band)
+         {
+            issearf(TestUtilities::verifyBlockPagedBand(pRaster.get(), band, 0, numRows - 1));
+         }
+
+         // Blocks in use when the working set is trimmed may briefly exceed it
+         issea(pPager->getWorkingSetSize() <= 2 * workingSetSize * 1024 * 1024);
+         issea(pPager->getWorkingSetSize() < rawSize);
+      }
+
+      {
+         WorkingSetSizeResource setting(static_cast<unsigned int>(rawSize / (1024 * 1024)) + 1);
+         ModelResource<RasterElement> pRaster(TestUtilities::createBlockPagedElement("CompressedWorkingSetSize",
+            IN_MEMORY_COMPRESSED, BSQ, numRows, NUM_COLUMNS, NUM_BANDS));
+         issearf(pRaster.get() != NULL);
+
+         CompressedPager* pPager = dynamic_cast<CompressedPager*>(pRaster->getPager());
+         issearf(pPager != NULL);
+
+         issearf(TestUtilities::fillBlockPagedElement(pRaster.get()));
+         issea(pPager->getWorkingSetSize() == rawSize);
+      }
+
+      return success;
+   }
+};
+
+class CompressedPagerTestSuite : public TestSuiteNewSession
+{
+public:
+   CompressedPagerTestSuite() : TestSuiteNewSession("CompressedPager")
+   {
+      addTestCase(new BlockCompressionRoundTripTestCase);
+      addTestCase(new CompressedPagerRoundTripTestCase);
+      addTestCase(new CompressedPagerRandomAccessTestCase);
+      addTestCase(new CompressedPagerConcurrentReadTestCase);
+      addTestCase(new CompressedPagerWorkingSetSizeTestCase);
+   }
+};
+
+REGISTER_SUITE( CompressedPagerTestSuite )
@@ -39,7 +39,11 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <math.h>
+#include <stdlib.h>
+#include <utility>
 #include <vector>
 using namespace std;
 
@@ -1107,6 +1111,221 @@ public:
    }
 };
 
+class RotateTestCase : public TestCase
+{
+public:
+   RotateTestCase() : TestCase("Rotate") {}
+   bool run()
+   {
+      bool success = true;
+
+      // Span several strips and tiles, and use a linear ramp which the interpolated methods reproduce exactly
+      const unsigned int numRows = 70;
+      const unsigned int numColumns = 150;
+      const unsigned int numBands = 2;
+      const double angle = 0.4;
+      vector<float> results[2][3];
+      const InterleaveFormatType interleaves[] = { BIP, BSQ };
+      const InterpolationType methods[] = { INTERP_NEAREST_NEIGHBOR, INTERP_BILINEAR, INTERP_BICUBIC };
+      for (int interleave = 0; interleave < 2; ++interleave)
+      {
+         ModelResource<RasterElement> pSrc(RasterUtilities::createRasterElement("rotate source",
+            numRows, numColumns, numBands, FLT4BYTES, interleaves[interleave]));
+         ModelResource<RasterElement> pDst(RasterUtilities::createRasterElement("rotate destination",
+            numRows, numColumns, numBands, FLT4BYTES, interleaves[interleave]));
+         issearf(pSrc.get() != NULL && pDst.get() != NULL);
+
+         float* pSrcData = reinterpret_cast<float*>(pSrc->getRawData());
+         for (unsigned int row = 0; row < numRows; ++row)
+         {
+            for (unsigned int column = 0; column < numColumns; ++column)
+            {
+               for (unsigned int band = 0; band < numBands; ++band)
+               {
+                  pSrcData[getIndex(interleaves[interleave], row, column, band, numRows, numColumns, numBands)] =
+                     getRampValue(column, row, band);
+               }
+            }
+         }
+
+         // No rotation leaves the data unchanged
+         issearf(RasterUtilities::rotate(pDst.get(), pSrc.get(), 0.0, 0, INTERP_BILINEAR, NULL, NULL));
+         issearf(memcmp(pDst->getRawData(), pSrcData, numRows * numColumns * numBands * sizeof(float)) == 0);
+
+         // Nearest neighbor must match the original per-pixel implementation exactly, for any angle
+         const double angles[] = { angle, -1.1, 2.5, 3.14159 };
+         for (unsigned int i = 0; i < sizeof(angles) / sizeof(angles[0]); ++i)
+         {
+            issearf(RasterUtilities::rotate(pDst.get(), pSrc.get(), angles[i], 0, INTERP_NEAREST_NEIGHBOR,
+               NULL, NULL));
+            const vector<float> expected = rotateNearestNeighbor(pSrcData, interleaves[interleave],
+               numRows, numColumns, numBands, angles[i]);
+            issearf(memcmp(pDst->getRawData(), &expected[0], expected.size() * sizeof(float)) == 0);
+         }
+
+         for (int method = 0; method < 3; ++method)
+         {
+            issearf(RasterUtilities::rotate(pDst.get(), pSrc.get(), angle, 0, methods[method], NULL, NULL));
+
+            // Store the results in BIP order to compare the interleaves
+            const float* pDstData = reinterpret_cast<const float*>(pDst->getRawData());
+            vector<float>& result = results[interleave][method];
+            for (unsigned int row = 0; row < numRows; ++row)
+            {
+               for (unsigned int column = 0; column < numColumns; ++column)
+               {
+                  for (unsigned int band = 0; band < numBands; ++band)
+                  {
+                     result.push_back(pDstData[getIndex(interleaves[interleave], row, column, band,
+                        numRows, numColumns, numBands)]);
+                  }
+               }
+            }
+         }
+      }
+
+      for (int method = 0; method < 3; ++method)
+      {
+         issearf(results[0][method] == results[1][method]);
+      }
+
+      // Compare against the ramp at the inverse rotation of each pixel away from the edges of the source
+      const int x0 = -(static_cast<int>(numColumns) - static_cast<int>(numColumns / 2) - 1);
+      const int y0 = -(static_cast<int>(numRows) - static_cast<int>(numRows / 2) - 1);
+      unsigned int interiorCount = 0;
+      for (unsigned int row = 0; row < numRows; ++row)
+      {
+         for (unsigned int column = 0; column < numColumns; ++column)
+         {
+            const double x = cos(angle) * (column + x0) - sin(angle) * (row + y0) - x0;
+            const double y = sin(angle) * (column + x0) + cos(angle) * (row + y0) - y0;
+            if (x < 3.0 || x > numColumns - 4.0 || y < 3.0 || y > numRows - 4.0)
+            {
+               continue;
+            }
+
+            ++interiorCount;
+            for (unsigned int band = 0; band < numBands; ++band)
+            {
+               const size_t index = (row * numColumns + column) * numBands + band;
+               const double expected = getRampValue(x, y, band);
+               issearf(fabs(results[0][1][index] - expected) < 0.01);
+               issearf(fabs(results[0][2][index] - expected) < 0.01);
+            }
+         }
+      }
+
+      issearf(interiorCount > numRows * numColumns / 4);
+      return success;
+   }
+
+private:
+   static size_t getIndex(InterleaveFormatType interleave, unsigned int row, unsigned int column,
+      unsigned int band, unsigned int numRows, unsigned int numColumns, unsigned int numBands)
+   {
+      if (interleave == BIP)
+      {
+         return (row * numColumns + column) * numBands + band;
+      }
+
+      return (band * numRows + row) * numColumns + column;
+   }
+
+   static float getRampValue(double x, double y, unsigned int band)
+   {
+      return static_cast<float>(x + 2.0 * y + 1000.0 * band + 1.0);
+   }
+
+   // Bresenham's line from the original rotate implementation, with points stored as (x, y)
+   static void calculateLine(pair<int, int> point0, pair<int, int> point1, vector<pair<int, int> >& points)
+   {
+      points.clear();
+      bool steep = abs(point1.second - point0.second) > abs(point1.first - point0.first);
+      if (steep)
+      {
+         swap(point0.first, point0.second);
+         swap(point1.first, point1.second);
+      }
+
+      bool swapped = (point0.first > point1.first);
+      if (swapped)
+      {
+         swap(point0, point1);
+      }
+
+      int deltax = point1.first - point0.first;
+      int deltay = abs(point1.second - point0.second);
+      int error = deltax / 2;
+      int ystep = (point0.second < point1.second) ? 1 : -1;
+      int y = point0.second;
+      for (int x = point0.first; x <= point1.first; ++x)
+      {
+         points.push_back(steep ? make_pair(y, x) : make_pair(x, y));
+         error -= deltay;
+         if (error < 0)
+         {
+            y += ystep;
+            error += deltax;
+         }
+      }
+
+      if (swapped)
+      {
+         reverse(points.begin(), points.end());
+      }
+   }
+
+   static pair<int, int> rotatePoint(int x, int y, double cosA, double sinA)
+   {
+      return make_pair(static_cast<int>(x * cosA - y * sinA + 0.5), static_cast<int>(x * sinA + y * cosA + 0.5));
+   }
+
+   // The original nearest neighbor rotation, which called toPixel on the source for every destination pixel
+   static vector<float> rotateNearestNeighbor(const float* pSrcData, InterleaveFormatType interleave,
+      unsigned int numRows, unsigned int numColumns, unsigned int numBands, double angle)
+   {
+      const int x1 = numColumns / 2;
+      const int y1 = numRows / 2;
+      const int x0 = -(static_cast<int>(numColumns) - x1 - 1);
+      const int y0 = -(static_cast<int>(numRows) - y1 - 1);
+      const double cosA = cos(angle);
+      const double sinA = sin(angle);
+
+      vector<pair<int, int> > rowStartPoints;
+      calculateLine(rotatePoint(x0, y0, cosA, sinA), rotatePoint(x0, y1, cosA, sinA), rowStartPoints);
+      vector<pair<int, int> > rowEndPoints;
+      calculateLine(rotatePoint(x1, y0, cosA, sinA), rotatePoint(x1, y1, cosA, sinA), rowEndPoints);
+      const double startMult = rowStartPoints.size() / static_cast<double>(numRows);
+      const double endMult = rowEndPoints.size() / static_cast<double>(numRows);
+
+      vector<float> result(numRows * numColumns * numBands, 0.0f);
+      vector<pair<int, int> > columnPoints;
+      for (unsigned int row = 0; row < numRows; ++row)
+      {
+         calculateLine(rowStartPoints[static_cast<int>(startMult * row + 0.5)],
+            rowEndPoints[static_cast<int>(endMult * row + 0.5)], columnPoints);
+         const double mult = columnPoints.size() / static_cast<double>(numColumns);
+         for (unsigned int column = 0; column < numColumns; ++column)
+         {
+            const pair<int, int>& point = columnPoints[static_cast<int>(mult * column + 0.5)];
+            const int sourceColumn = point.first - x0;
+            const int sourceRow = point.second - y0;
+            if (sourceColumn >= 0 && sourceColumn < static_cast<int>(numColumns) &&
+               sourceRow >= 0 && sourceRow < static_cast<int>(numRows))
+            {
+               for (unsigned int band = 0; band < numBands; ++band)
+               {
+                  result[getIndex(interleave, row, column, band, numRows, numColumns, numBands)] =
+                     pSrcData[getIndex(interleave, sourceRow, sourceColumn, band, numRows, numColumns, numBands)];
+               }
+            }
+         }
+      }
+
+      return result;
+   }
+};
+
 class DatasetTestSuite : public TestSuiteNewSession
 {
 public:
@@ -1120,6 +1339,7 @@ public:
       addTestCase( new DatasetAutoImportTest );
       addTestCase( new MovieExportTest );
       addTestCase( new MultiDataSetFileImportTest );
+      addTestCase( new RotateTestCase );
    }
 };
 
@@ -9,6 +9,7 @@
 
 #include "ApplicationServices.h"
 #include "assert.h"
+#include "ConfigurationSettings.h"
 #include "ConnectionManager.h"
 #include "DataVariant.h"
 #include "DimensionDescriptor.h"
@@ -21,7 +22,10 @@
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
 #include "RasterFileDescriptor.h"
+#include "Signature.h"
+#include "SignatureLibrary.h"
 #include "SignatureSet.h"
+#include "SpectralResampler.h"
 #include "Subject.h"
 #include "TestSuiteNewSession.h"
 #include "TestUtilities.h"
@@ -217,6 +221,85 @@ public:
    }
 };
 
+class EnviSignatureLibraryResampleTestCase : public TestCase
+{
+public:
+   EnviSignatureLibraryResampleTestCase() : TestCase("SignatureLibraryResample") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      ImporterResource pImporter("Auto Importer", TestUtilities::getTestDataPath() + "Signatures/manmade1.sli");
+      issearf(pImporter->execute());
+      vector<DataElement*> elements = pImporter->getImportedElements();
+      issearf(elements.size() == 1);
+
+      ModelResource<SignatureLibrary> pLibrary(dynamic_cast<SignatureLibrary*>(elements[0]));
+      issearf(pLibrary.get() != NULL);
+
+      // Keep the original values to compute the expected resampled values from
+      vector<Signature*> sigs = pLibrary->getSignatures();
+      issearf(sigs.empty() == false);
+      vector<vector<double> > reflectances(sigs.size());
+      for (unsigned int i = 0; i < sigs.size(); ++i)
+      {
+         issearf(sigs[i]->getData("Reflectance").getValue(reflectances[i]));
+      }
+
+      const vector<double> wavelengths = pLibrary->getOriginalAbscissa();
+      issearf(wavelengths.size() > 2);
+      vector<double> abscissa;
+      for (unsigned int i = 1; i < wavelengths.size(); i += 3)
+      {
+         abscissa.push_back((wavelengths[i - 1] + wavelengths[i]) / 2.0);
+      }
+
+      // Each method must be used for the resampled values, including when resampling to the same abscissa again
+      Service<ConfigurationSettings> pSettings;
+      const string key = SignatureLibrary::getSettingResamplingMethodKey();
+      const char* const methodNames[] = { "Linear", "Cubic Spline", "Gaussian" };
+      const SpectralResampler::MethodEnum methods[] = { SpectralResampler::LINEAR, SpectralResampler::CUBIC_SPLINE,
+         SpectralResampler::GAUSSIAN };
+      vector<double> linearValues;
+      bool methodsDiffer = false;
+      for (unsigned int method = 0; method < 3; ++method)
+      {
+         issea(pSettings->setTemporarySetting(key, string(methodNames[method])));
+         issea(pLibrary->resample(abscissa));
+
+         SpectralResampler resampler;
+         issea(resampler.initialize(methods[method], wavelengths, abscissa));
+         vector<double> expected(abscissa.size());
+         for (unsigned int i = 0; i < sigs.size(); ++i)
+         {
+            issea(resampler.resample(&reflectances[i][0], &expected[0]));
+
+            const double* pValues = pLibrary->getOrdinateData(i);
+            issea(pValues != NULL);
+            for (unsigned int band = 0; band < abscissa.size(); ++band)
+            {
+               issea(fabs(pValues[band] - expected[band]) < 1e-9);
+               if (method == 0)
+               {
+                  linearValues.push_back(pValues[band]);
+               }
+               else if (fabs(pValues[band] - linearValues[i * abscissa.size() + band]) > 1e-9)
+               {
+                  methodsDiffer = true;
+               }
+            }
+         }
+      }
+      issea(methodsDiffer);
+
+      pSettings->deleteTemporarySetting(key);
+      pLibrary->desample();
+
+      return success;
+   }
+};
+
 class EnviTestSuite : public TestSuiteNewSession
 {
 public:
@@ -225,6 +308,7 @@ public:
       addTestCase( new EnviFieldParsingTestCase );
       addTestCase( new EnviSignatureLibraryImportTestCase );
       addTestCase( new EnviSignatureLibraryMetadataTestCase );
+      addTestCase( new EnviSignatureLibraryResampleTestCase );
    }
 };
 
@@ -0,0 +1,289 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AoiElement.h"
+#include "assert.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "DesktopServices.h"
+#include "GraphicGroup.h"
+#include "GraphicObject.h"
+#include "Layer.h"
+#include "LayerList.h"
+#include "ObjectResource.h"
+#include "PlugInArgList.h"
+#include "PlugInResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterUtilities.h"
+#include "SpatialDataView.h"
+#include "SpatialDataWindow.h"
+#include "TestSuiteNewSession.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   const unsigned int NUM_BANDS = 2;
+
+   struct ChipLayout
+   {
+      const char* mpName;
+      unsigned int mRows;
+      unsigned int mColumns;
+      double mXOffset;
+      double mYOffset;
+      bool mDisplayed;
+   };
+
+   // The primary raster covers the AOI, and the other chips overlap it and each other.  The mosaic is larger
+   // than one tile, a chip has fractional offsets, and a hidden chip covering everything must be ignored.
+   const ChipLayout sChips[] =
+   {
+      { "Mosaic Primary", 280, 300, 0.0, 0.0, true },
+      { "Mosaic A", 120, 140, 200.0, 150.0, true },
+      { "Mosaic B", 100, 90, -20.5, 100.25, true },
+      { "Mosaic C", 60, 60, 180.0, 160.0, true },
+      { "Mosaic Hidden", 280, 300, 0.0, 0.0, false }
+   };
+
+   unsigned short getChipValue(unsigned int chip, unsigned int row, unsigned int column, unsigned int band)
+   {
+      return static_cast<unsigned short>(10000 * chip + 500 * band + 7 * row + 3 * column);
+   }
+
+   bool fillChip(RasterElement* pChip, unsigned int chip)
+   {
+      unsigned short* pData = reinterpret_cast<unsigned short*>(pChip->getRawData());
+      if (pData == NULL)
+      {
+         return false;
+      }
+
+      for (unsigned int row = 0; row < sChips[chip].mRows; ++row)
+      {
+         for (unsigned int column = 0; column < sChips[chip].mColumns; ++column)
+         {
+            for (unsigned int band = 0; band < NUM_BANDS; ++band)
+            {
+               *pData++ = getChipValue(chip, row, column, band);
+            }
+         }
+      }
+
+      return true;
+   }
+
+   struct ChipReference
+   {
+      unsigned int mChip;
+      double mStartX;
+      double mStartY;
+      double mEndX;
+      double mEndY;
+   };
+
+   inline bool orderedIsBetween(double x, double x1, double x2)
+   {
+      double e = 0.0001;
+      return (x1 - e <= x) && (x <= x2 + e);
+   }
+}
+
+class GeoMosaicOverlapTestCase : public TestCase
+{
+public:
+   GeoMosaicOverlapTestCase() : TestCase("Overlap") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      Service<DesktopServices> pDesktop;
+      SpatialDataWindow* pWindow = dynamic_cast<SpatialDataWindow*>(
+         pDesktop->createWindow("Mosaic Chip Test", SPATIAL_DATA_WINDOW));
+      issearf(pWindow != NULL);
+      SpatialDataView* pView = pWindow->getSpatialDataView();
+      issearf(pView != NULL);
+
+      ModelResource<RasterElement> pPrimary(RasterUtilities::createRasterElement(sChips[0].mpName,
+         sChips[0].mRows, sChips[0].mColumns, NUM_BANDS, INT2UBYTES, BIP, true, NULL));
+      issearf(pPrimary.get() != NULL);
+      issearf(pView->setPrimaryRasterElement(pPrimary.get()));
+      for (unsigned int chip = 0; chip < sizeof(sChips) / sizeof(sChips[0]); ++chip)
+      {
+         RasterElement* pChip = pPrimary.get();
+         if (chip > 0)
+         {
+            pChip = RasterUtilities::createRasterElement(sChips[chip].mpName, sChips[chip].mRows,
+               sChips[chip].mColumns, NUM_BANDS, INT2UBYTES, BIP, true, pPrimary.get());
+         }
+
+         issearf(pChip != NULL && fillChip(pChip, chip));
+         Layer* pLayer = pView->createLayer(RASTER, pChip);
+         issearf(pLayer != NULL);
+         pLayer->setXOffset(sChips[chip].mXOffset);
+         pLayer->setYOffset(sChips[chip].mYOffset);
+         if (sChips[chip].mDisplayed == false)
+         {
+            issearf(pView->hideLayer(pLayer));
+         }
+      }
+
+      ModelResource<AoiElement> pAoi("Mosaic AOI", pPrimary.get());
+      issearf(pAoi.get() != NULL);
+      GraphicObject* pRect = pAoi->getGroup()->addObject(RECTANGLE_OBJECT);
+      issearf(pRect != NULL);
+      pRect->setBoundingBox(LocationType(5.0, 3.0), LocationType(294.0, 276.0));
+      const int aoiStartX = 5;
+      const int aoiStartY = 3;
+      const unsigned int numColumns = 290;
+      const unsigned int numRows = 274;
+
+      // The chips in the order used by the plug-in
+      vector<ChipReference> chips;
+      vector<Layer*> layers;
+      pView->getLayerList()->getLayers(RASTER, layers);
+      reverse(layers.begin(), layers.end());
+      for (vector<Layer*>::iterator iter = layers.begin(); iter != layers.end(); ++iter)
+      {
+         if (pView->isLayerDisplayed(*iter) == false)
+         {
+            continue;
+         }
+
+         for (unsigned int chip = 0; chip < sizeof(sChips) / sizeof(sChips[0]); ++chip)
+         {
+            if ((*iter)->getDataElement()->getName() == sChips[chip].mpName)
+            {
+               ChipReference reference;
+               reference.mChip = chip;
+               reference.mStartX = (*iter)->getXOffset();
+               reference.mStartY = (*iter)->getYOffset();
+               reference.mEndX = sChips[chip].mColumns - 1 + reference.mStartX;
+               reference.mEndY = sChips[chip].mRows - 1 + reference.mStartY;
+               chips.push_back(reference);
+            }
+         }
+      }
+
+      issearf(chips.size() == 4);
+
+      const char* const blendings[] = { "First", "Last", "Mean", "Feather" };
+      for (unsigned int blending = 0; blending < sizeof(blendings) / sizeof(blendings[0]); ++blending)
+      {
+         string blendingName = blendings[blending];
+         ExecutableResource pMosaic("Mosaic Chip", string(), NULL, true);
+         issearf(pMosaic->getInArgList().setPlugInArgValue(Executable::ViewArg(), pView));
+         issearf(pMosaic->getInArgList().setPlugInArgValue("AOI", pAoi.get()));
+         issearf(pMosaic->getInArgList().setPlugInArgValue("Overlap Blending", &blendingName));
+         issearf(pMosaic->execute());
+
+         ModelResource<RasterElement> pResult(
+            pMosaic->getOutArgList().getPlugInArgValue<RasterElement>("Result"));
+         issearf(pResult.get() != NULL);
+         const RasterDataDescriptor* pDescriptor =
+            dynamic_cast<const RasterDataDescriptor*>(pResult->getDataDescriptor());
+         issearf(pDescriptor != NULL);
+         issearf(pDescriptor->getRowCount() == numRows && pDescriptor->getColumnCount() == numColumns);
+         const unsigned short* pData = reinterpret_cast<const unsigned short*>(pResult->getRawData());
+         issearf(pData != NULL);
+
+         for (unsigned int row = 0; row < numRows && success; ++row)
+         {
+            for (unsigned int column = 0; column < numColumns && success; ++column)
+            {
+               for (unsigned int band = 0; band < NUM_BANDS; ++band)
+               {
+                  const unsigned short expected = (blending == 0) ?
+                     getFirstValue(chips, aoiStartX + column, aoiStartY + row, band) :
+                     getBlendedValue(chips, blending, aoiStartX + column, aoiStartY + row, band);
+                  issea(pData[(row * numColumns + column) * NUM_BANDS + band] == expected);
+               }
+            }
+         }
+
+         Window* pResultWindow = pDesktop->getWindow(pView->getName() + " Chip", SPATIAL_DATA_WINDOW);
+         issearf(pResultWindow != NULL && pDesktop->deleteWindow(pResultWindow));
+      }
+
+      issearf(pDesktop->deleteWindow(pWindow));
+      return success;
+   }
+
+private:
+   // The original implementation, which tested every chip for every mosaic pixel until one contained it
+   static unsigned short getFirstValue(const vector<ChipReference>& chips, int x, int y, unsigned int band)
+   {
+      for (vector<ChipReference>::const_iterator iter = chips.begin(); iter != chips.end(); ++iter)
+      {
+         if (orderedIsBetween(x, iter->mStartX, iter->mEndX) && orderedIsBetween(y, iter->mStartY, iter->mEndY))
+         {
+            return getChipValue(iter->mChip, static_cast<int>(y - iter->mStartY),
+               static_cast<int>(x - iter->mStartX), band);
+         }
+      }
+
+      return 0;
+   }
+
+   // Last uses the last chip containing the pixel, Mean weights each chip equally,
+   // and Feather weights each chip by one more than the distance to its nearest edge
+   static unsigned short getBlendedValue(const vector<ChipReference>& chips, unsigned int blending, int x, int y,
+      unsigned int band)
+   {
+      unsigned short lastValue = 0;
+      double sum = 0.0;
+      double weights = 0.0;
+      for (vector<ChipReference>::const_iterator iter = chips.begin(); iter != chips.end(); ++iter)
+      {
+         if (orderedIsBetween(x, iter->mStartX, iter->mEndX) && orderedIsBetween(y, iter->mStartY, iter->mEndY))
+         {
+            const int chipRow = static_cast<int>(y - iter->mStartY);
+            const int chipColumn = static_cast<int>(x - iter->mStartX);
+            lastValue = getChipValue(iter->mChip, chipRow, chipColumn, band);
+
+            double weight = 1.0;
+            if (blending == 3)
+            {
+               const int chipRows = static_cast<int>(sChips[iter->mChip].mRows);
+               const int chipColumns = static_cast<int>(sChips[iter->mChip].mColumns);
+               weight = min(min(chipColumn, chipColumns - 1 - chipColumn), min(chipRow, chipRows - 1 - chipRow)) + 1.0;
+            }
+
+            sum += weight * lastValue;
+            weights += weight;
+         }
+      }
+
+      if (blending == 1 || weights == 0.0)
+      {
+         return lastValue;
+      }
+
+      return static_cast<unsigned short>(floor(sum / weights + 0.5));
+   }
+};
+
+class GeoMosaicTestSuite : public TestSuiteNewSession
+{
+public:
+   GeoMosaicTestSuite() : TestSuiteNewSession("GeoMosaic")
+   {
+      addTestCase(new GeoMosaicOverlapTestCase);
+   }
+};
+
+REGISTER_SUITE( GeoMosaicTestSuite )
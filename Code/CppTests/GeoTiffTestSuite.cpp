@@ -11,22 +11,31 @@
 #include "Testable.h"
 
 // to access a plug-in
+#include "AppConfig.h"
+#include "ConfigurationSettings.h"
 #include "ConnectionManager.h"
+#include "DataAccessorImpl.h"
 #include "DataDescriptor.h"
+#include "DataRequest.h"
 #include "DataVariant.h"
 #include "DynamicObject.h"
+#include "Filename.h"
 #include "PlugInManagerServices.h"
 #include "ApplicationServices.h"
 #include "ImportDescriptor.h"
 #include "ModelServicesImp.h"
+#include "ObjectResource.h"
 #include "PlugInResource.h"
 #include "RasterDataDescriptor.h"
+#include "RasterElement.h"
 #include "RasterFileDescriptor.h"
+#include "RasterUtilities.h"
 #include "TestSuiteNewSession.h"
 #include "TestUtilities.h"
 
 #include <string>
 #include <sstream>
+#include <string.h>
 
 using namespace std;
 
@@ -188,6 +197,146 @@ public:
    }
 };
 
+class GeoTiffExporterLayoutTestCase : public TestCase
+{
+public:
+   GeoTiffExporterLayoutTestCase() : TestCase("ExporterLayout") {}
+   bool run()
+   {
+      bool success = true;
+
+      string tempPath;
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      if (pTempPath != NULL)
+      {
+         tempPath = pTempPath->getFullPathAndName();
+      }
+
+      // The image spans several rows of tiles and does not end on a tile boundary
+      const unsigned int rows = 700;
+      const unsigned int columns = 530;
+      const unsigned int bands = 3;
+
+      struct Layout
+      {
+         EncodingType mDataType;
+         const char* mpCompression;
+         const char* mpPredictor;
+         unsigned int mTileSize;
+         bool mOverviews;
+         unsigned short mExpectedCompression;
+      };
+
+      const Layout layouts[] =
+      {
+         { INT2UBYTES, "None", "None", 0, false, 1 },
+         { INT2UBYTES, "Deflate", "Horizontal", 256, false, 8 },
+         { INT2UBYTES, "LZW", "Horizontal", 128, true, 5 },
+         { FLT4BYTES, "Deflate", "FloatingPoint", 256, true, 8 },
+         { FLT4BYTES, "Deflate", "FloatingPoint", 0, false, 8 }
+      };
+
+      for (unsigned int i = 0; i < sizeof(layouts) / sizeof(layouts[0]); ++i)
+      {
+         const Layout& layout = layouts[i];
+         ModelResource<RasterElement> pSource(RasterUtilities::createRasterElement("GeoTiffLayoutSource",
+            rows, columns, bands, layout.mDataType, BIP, true));
+         issearf(pSource.get() != NULL);
+
+         const size_t elementCount = static_cast<size_t>(rows) * columns * bands;
+         if (layout.mDataType == FLT4BYTES)
+         {
+            float* pSourceData = reinterpret_cast<float*>(pSource->getRawData());
+            issearf(pSourceData != NULL);
+            for (size_t element = 0; element < elementCount; ++element)
+            {
+               pSourceData[element] = static_cast<float>(element % 4096) * 0.125f - 100.0f;
+            }
+         }
+         else
+         {
+            unsigned short* pSourceData = reinterpret_cast<unsigned short*>(pSource->getRawData());
+            issearf(pSourceData != NULL);
+            for (size_t element = 0; element < elementCount; ++element)
+            {
+               pSourceData[element] = static_cast<unsigned short>((element / 7) % 3000 + element % 5);
+            }
+         }
+
+         RasterDataDescriptor* pSourceDesc = dynamic_cast<RasterDataDescriptor*>(pSource->getDataDescriptor());
+         issearf(pSourceDesc != NULL);
+
+         stringstream filename;
+         filename << tempPath << SLASH << "testGeoTiffLayout" << i << ".tif";
+         FactoryResource<RasterFileDescriptor> pExportDescriptor(dynamic_cast<RasterFileDescriptor*>(
+            RasterUtilities::generateFileDescriptorForExport(pSourceDesc, filename.str())));
+         issearf(pExportDescriptor.get() != NULL);
+
+         {
+            ExporterResource exporter("GeoTIFF Exporter", pSource.get(), pExportDescriptor.get(), NULL);
+            string compression = layout.mpCompression;
+            string predictor = layout.mpPredictor;
+            unsigned int tileSize = layout.mTileSize;
+            bool overviews = layout.mOverviews;
+            issearf(exporter->getInArgList().setPlugInArgValue("Compression", &compression));
+            issearf(exporter->getInArgList().setPlugInArgValue("Predictor", &predictor));
+            issearf(exporter->getInArgList().setPlugInArgValue("Tile Size", &tileSize));
+            issearf(exporter->getInArgList().setPlugInArgValue("Generate Overviews", &overviews));
+            issearf(exporter->execute());
+         }
+
+         ImporterResource importer("GeoTIFF Importer", filename.str(), NULL, true);
+         issearf(importer->execute());
+         vector<DataElement*> importedElements = importer->getImportedElements();
+         issearf(importedElements.size() == 1);
+         ModelResource<RasterElement> pImported(dynamic_cast<RasterElement*>(importedElements.front()));
+         issearf(pImported.get() != NULL);
+
+         RasterDataDescriptor* pImportedDesc = dynamic_cast<RasterDataDescriptor*>(pImported->getDataDescriptor());
+         issearf(pImportedDesc != NULL);
+         issearf(pImportedDesc->getRowCount() == rows);
+         issearf(pImportedDesc->getColumnCount() == columns);
+         issearf(pImportedDesc->getBandCount() == bands);
+         issearf(pImportedDesc->getDataType() == layout.mDataType);
+
+         try
+         {
+            const DynamicObject* pMetadata = pImportedDesc->getMetadata();
+            issearf(pMetadata != NULL);
+            issearf(dv_cast<unsigned short>(pMetadata->getAttributeByPath("TIFF/Compression")) ==
+               layout.mExpectedCompression);
+            if (layout.mTileSize > 0)
+            {
+               issearf(dv_cast<unsigned int>(pMetadata->getAttributeByPath("TIFF/TileWidth")) == layout.mTileSize);
+               issearf(dv_cast<unsigned int>(pMetadata->getAttributeByPath("TIFF/TileLength")) ==
+                  layout.mTileSize);
+            }
+         }
+         catch (const bad_cast&)
+         {
+            issearf(false);
+         }
+
+         FactoryResource<DataRequest> pSourceRequest;
+         DataAccessor sourceAccessor = pSource->getDataAccessor(pSourceRequest.release());
+         FactoryResource<DataRequest> pImportedRequest;
+         pImportedRequest->setInterleaveFormat(BIP);
+         DataAccessor importedAccessor = pImported->getDataAccessor(pImportedRequest.release());
+
+         const size_t rowBytes = columns * bands * RasterUtilities::bytesInEncoding(layout.mDataType);
+         for (unsigned int row = 0; row < rows; ++row)
+         {
+            issearf(sourceAccessor.isValid() && importedAccessor.isValid());
+            issearf(memcmp(sourceAccessor->getRow(), importedAccessor->getRow(), rowBytes) == 0);
+            sourceAccessor->nextRow();
+            importedAccessor->nextRow();
+         }
+      }
+
+      return success;
+   }
+};
+
 class GeoTiffTestSuite : public TestSuiteNewSession
 {
 public:
@@ -196,6 +345,7 @@ public:
       addTestCase(new GeoTiffImporterTestCase);
       addTestCase(new GeoTiffImporterChipTestCase);
       addTestCase(new GeoTiffImporterMetadataTestCase);
+      addTestCase(new GeoTiffExporterLayoutTestCase);
    }
 };
 
@@ -0,0 +1,258 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "assert.h"
+#include "GraphicObjectIndex.h"
+#include "LocationType.h"
+#include "TestCase.h"
+#include "TestSuiteNewSession.h"
+
+#include <list>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   const unsigned int NUM_OBJECTS = 500;
+
+   // The index never dereferences the objects, so any distinct addresses can be used
+   char sObjects[NUM_OBJECTS];
+
+   GraphicObject* getObject(unsigned int index)
+   {
+      return reinterpret_cast<GraphicObject*>(&sObjects[index]);
+   }
+
+   class Bounds
+   {
+   public:
+      LocationType mLlCorner;
+      LocationType mUrCorner;
+   };
+
+   unsigned int nextRandom(unsigned int& seed)
+   {
+      seed = seed * 1103515245 + 12345;
+      return (seed >> 16) & 0x7fff;
+   }
+
+   Bounds getRandomBounds(unsigned int& seed)
+   {
+      Bounds bounds;
+      bounds.mLlCorner = LocationType(nextRandom(seed) % 1000, nextRandom(seed) % 1000);
+      bounds.mUrCorner = LocationType(bounds.mLlCorner.mX + nextRandom(seed) % 50,
+         bounds.mLlCorner.mY + nextRandom(seed) % 50);
+      return bounds;
+   }
+
+   // Checks a query against every object, where stacking order is the order of the objects in the list
+   bool checkQuery(const GraphicObjectIndex& index, const list<unsigned int>& objects,
+      const vector<Bounds>& bounds, const LocationType& llCorner, const LocationType& urCorner)
+   {
+      vector<GraphicObject*> expected;
+      for (list<unsigned int>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter)
+      {
+         const Bounds& objectBounds = bounds[*iter];
+         if (objectBounds.mLlCorner.mX <= urCorner.mX && llCorner.mX <= objectBounds.mUrCorner.mX &&
+            objectBounds.mLlCorner.mY <= urCorner.mY && llCorner.mY <= objectBounds.mUrCorner.mY)
+         {
+            expected.push_back(getObject(*iter));
+         }
+      }
+
+      vector<GraphicObject*> found;
+      index.query(llCorner, urCorner, found);
+      return found == expected && index.getNumObjects() == objects.size();
+   }
+}
+
+class GraphicObjectIndexQueryTestCase : public TestCase
+{
+public:
+   GraphicObjectIndexQueryTestCase() : TestCase("Query") {}
+   bool run()
+   {
+      bool success = true;
+      unsigned int seed = 1;
+
+      GraphicObjectIndex index;
+      list<unsigned int> objects;
+      vector<Bounds> bounds;
+      for (unsigned int i = 0; i < NUM_OBJECTS; ++i)
+      {
+         bounds.push_back(getRandomBounds(seed));
+         index.insert(getObject(i), bounds[i].mLlCorner, bounds[i].mUrCorner);
+         objects.push_back(i);
+      }
+
+      for (unsigned int i = 0; i < 100; ++i)
+      {
+         Bounds region = getRandomBounds(seed);
+         issearf(checkQuery(index, objects, bounds, region.mLlCorner, region.mUrCorner));
+      }
+
+      // Points on the edge of an object hit the object
+      issearf(checkQuery(index, objects, bounds, bounds[10].mLlCorner, bounds[10].mLlCorner));
+      issearf(checkQuery(index, objects, bounds, bounds[20].mUrCorner, bounds[20].mUrCorner));
+
+      // The corners of a region may be given in any order
+      vector<GraphicObject*> found;
+      index.query(LocationType(1000, 1000), LocationType(0, 0), found);
+      issearf(found.size() == NUM_OBJECTS);
+      index.query(LocationType(-10, -10), LocationType(-1, -1), found);
+      issearf(found.empty());
+
+      index.clear();
+      issearf(index.getNumObjects() == 0);
+      issearf(index.contains(getObject(0)) == false);
+      index.query(LocationType(1000, 1000), LocationType(0, 0), found);
+      issearf(found.empty());
+
+      return success;
+   }
+};
+
+class GraphicObjectIndexStackingTestCase : public TestCase
+{
+public:
+   GraphicObjectIndexStackingTestCase() : TestCase("Stacking") {}
+   bool run()
+   {
+      bool success = true;
+
+      // Overlapping objects
+      GraphicObjectIndex index;
+      list<unsigned int> objects;
+      vector<Bounds> bounds(50);
+      for (unsigned int i = 0; i < bounds.size(); ++i)
+      {
+         bounds[i].mLlCorner = LocationType(i, i);
+         bounds[i].mUrCorner = LocationType(i + 100, i + 100);
+         index.insert(getObject(i), bounds[i].mLlCorner, bounds[i].mUrCorner);
+         objects.push_back(i);
+      }
+
+      LocationType point(75, 75);
+      issearf(checkQuery(index, objects, bounds, point, point));
+
+      issearf(index.moveToFront(getObject(3)));
+      objects.remove(3);
+      objects.push_back(3);
+      issearf(checkQuery(index, objects, bounds, point, point));
+
+      issearf(index.moveToBack(getObject(40)));
+      objects.remove(40);
+      objects.push_front(40);
+      issearf(checkQuery(index, objects, bounds, point, point));
+
+      // Moving an object does not change its stacking order
+      bounds[20].mLlCorner = LocationType(500, 500);
+      bounds[20].mUrCorner = LocationType(600, 600);
+      issearf(index.update(getObject(20), bounds[20].mLlCorner, bounds[20].mUrCorner));
+      bounds[20].mLlCorner = LocationType(0, 0);
+      bounds[20].mUrCorner = LocationType(80, 80);
+      issearf(index.update(getObject(20), bounds[20].mLlCorner, bounds[20].mUrCorner));
+      issearf(checkQuery(index, objects, bounds, point, point));
+
+      objects.reverse();
+      list<GraphicObject*> order;
+      for (list<unsigned int>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter)
+      {
+         order.push_back(getObject(*iter));
+      }
+
+      index.setStackingOrder(order);
+      issearf(checkQuery(index, objects, bounds, point, point));
+
+      // Objects which are not in the index are ignored
+      issearf(index.moveToFront(getObject(NUM_OBJECTS - 1)) == false);
+      issearf(index.update(getObject(NUM_OBJECTS - 1), point, point) == false);
+      issearf(index.remove(getObject(NUM_OBJECTS - 1)) == false);
+
+      return success;
+   }
+};
+
+class GraphicObjectIndexUpdateTestCase : public TestCase
+{
+public:
+   GraphicObjectIndexUpdateTestCase() : TestCase("Update") {}
+   bool run()
+   {
+      bool success = true;
+      unsigned int seed = 7;
+
+      GraphicObjectIndex index;
+      list<unsigned int> objects;
+      vector<Bounds> bounds(NUM_OBJECTS);
+      for (unsigned int step = 0; step < 5000; ++step)
+      {
+         unsigned int object = nextRandom(seed) % NUM_OBJECTS;
+         unsigned int operation = nextRandom(seed) % 4;
+         if (index.contains(getObject(object)) == false)
+         {
+            bounds[object] = getRandomBounds(seed);
+            index.insert(getObject(object), bounds[object].mLlCorner, bounds[object].mUrCorner);
+            objects.push_back(object);
+         }
+         else if (operation == 0)
+         {
+            issearf(index.remove(getObject(object)));
+            objects.remove(object);
+         }
+         else if (operation == 1)
+         {
+            // A small move which usually stays within the object's node
+            bounds[object].mLlCorner.mX += 1.0;
+            bounds[object].mUrCorner.mX += 1.0;
+            issearf(index.update(getObject(object), bounds[object].mLlCorner, bounds[object].mUrCorner));
+         }
+         else
+         {
+            bounds[object] = getRandomBounds(seed);
+            issearf(index.update(getObject(object), bounds[object].mLlCorner, bounds[object].mUrCorner));
+         }
+
+         if (step % 50 == 0)
+         {
+            Bounds region = getRandomBounds(seed);
+            issearf(checkQuery(index, objects, bounds, region.mLlCorner, region.mUrCorner));
+            issearf(checkQuery(index, objects, bounds, LocationType(0, 0), LocationType(1100, 1100)));
+         }
+      }
+
+      // Removing every object leaves an empty index which can be used again
+      while (objects.empty() == false)
+      {
+         issearf(index.remove(getObject(objects.front())));
+         objects.pop_front();
+      }
+
+      issearf(checkQuery(index, objects, bounds, LocationType(0, 0), LocationType(1100, 1100)));
+      index.insert(getObject(0), bounds[0].mLlCorner, bounds[0].mUrCorner);
+      objects.push_back(0);
+      issearf(checkQuery(index, objects, bounds, bounds[0].mLlCorner, bounds[0].mUrCorner));
+
+      return success;
+   }
+};
+
+class GraphicObjectIndexTestSuite : public TestSuiteNewSession
+{
+public:
+   GraphicObjectIndexTestSuite() : TestSuiteNewSession("GraphicObjectIndex")
+   {
+      addTestCase(new GraphicObjectIndexQueryTestCase);
+      addTestCase(new GraphicObjectIndexStackingTestCase);
+      addTestCase(new GraphicObjectIndexUpdateTestCase);
+   }
+};
+
+REGISTER_SUITE(GraphicObjectIndexTestSuite)
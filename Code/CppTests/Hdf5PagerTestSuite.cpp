@@ -0,0 +1,279 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include <hdf5.h> // #include this first so Hdf5Pager class is included properly
+
+#include "AppConfig.h"
+#include "assert.h"
+#include "CachedPage.h"
+#include "ConfigurationSettings.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "Filename.h"
+#include "Hdf5Pager.h"
+#include "Hdf5Resource.h"
+#include "ImportDescriptor.h"
+#include "ObjectResource.h"
+#include "PlugInArg.h"
+#include "PlugInArgList.h"
+#include "PlugInManagerServices.h"
+#include "PlugInResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "TestSuiteNewSession.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   // The chunks do not divide the dataset evenly, so the last row and column of chunks are partial
+   const unsigned int NUM_ROWS = 300;
+   const unsigned int NUM_COLUMNS = 1000;
+   const unsigned int CHUNK_ROWS = 48;
+   const unsigned int CHUNK_COLUMNS = 128;
+   const string DATASET_NAME = "/Cube";
+   const string CACHE_SIZE_KEY = "Hdf5Pager/CacheSize";
+
+   unsigned short expectedValue(unsigned int row, unsigned int column)
+   {
+      return static_cast<unsigned short>((row * 31 + column * 7) % 65521);
+   }
+
+   // Writes a compressed, chunked two dimensional dataset
+   bool writeChunkedFile(const string& filename)
+   {
+      vector<unsigned short> values(NUM_ROWS * NUM_COLUMNS);
+      for (unsigned int row = 0; row < NUM_ROWS; ++row)
+      {
+         for (unsigned int column = 0; column < NUM_COLUMNS; ++column)
+         {
+            values[row * NUM_COLUMNS + column] = expectedValue(row, column);
+         }
+      }
+
+      Hdf5FileResource file(H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT));
+      if (*file < 0)
+      {
+         return false;
+      }
+
+      hsize_t dims[2] = {NUM_ROWS, NUM_COLUMNS};
+      hsize_t chunkDims[2] = {CHUNK_ROWS, CHUNK_COLUMNS};
+      Hdf5DataSpaceResource dataSpace(H5Screate_simple(2, dims, NULL));
+      Hdf5PropertyListResource creationProperties(H5Pcreate(H5P_DATASET_CREATE));
+      if (*dataSpace < 0 || *creationProperties < 0 || H5Pset_chunk(*creationProperties, 2, chunkDims) < 0 ||
+         H5Pset_deflate(*creationProperties, 1) < 0)
+      {
+         return false;
+      }
+
+      Hdf5DataSetResource dataset(H5Dcreate2(*file, DATASET_NAME.c_str(), H5T_NATIVE_USHORT, *dataSpace,
+         H5P_DEFAULT, *creationProperties, H5P_DEFAULT));
+      if (*dataset < 0)
+      {
+         return false;
+      }
+
+      return H5Dwrite(*dataset, H5T_NATIVE_USHORT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &values.front()) >= 0;
+   }
+
+   // Reads the whole dataset directly, bypassing the pager
+   bool readDataset(const string& filename, vector<unsigned short>& values)
+   {
+      Hdf5FileResource file(filename);
+      if (*file < 0)
+      {
+         return false;
+      }
+
+      Hdf5DataSetResource dataset(*file, DATASET_NAME);
+      if (*dataset < 0)
+      {
+         return false;
+      }
+
+      values.resize(NUM_ROWS * NUM_COLUMNS);
+      return H5Dread(*dataset, H5T_NATIVE_USHORT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &values.front()) >= 0;
+   }
+
+   // Restores the raw data chunk cache size when a test case finishes
+   class CacheSizeResource
+   {
+   public:
+      CacheSizeResource(unsigned int cacheSize)
+      {
+         Service<ConfigurationSettings> pSettings;
+         pSettings->setTemporarySetting(CACHE_SIZE_KEY, cacheSize);
+      }
+
+      ~CacheSizeResource()
+      {
+         Service<ConfigurationSettings> pSettings;
+         pSettings->deleteTemporarySetting(CACHE_SIZE_KEY);
+      }
+   };
+}
+
+class Hdf5PagerChunkTestCase : public TestCase
+{
+public:
+   Hdf5PagerChunkTestCase() : TestCase("Chunks") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      // The per-dataset chunk cache is only larger than the file cache when the file cache is small
+      CacheSizeResource cacheSize(4096);
+
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      issearf(pTempPath != NULL);
+      string filename = pTempPath->getFullPathAndName() + SLASH + "hdf5PagerChunks.h5";
+      issearf(writeChunkedFile(filename));
+
+      vector<unsigned short> values;
+      issearf(readDataset(filename, values));
+
+      {
+         ImporterResource pImporter("Generic HDF5 Importer", filename);
+         vector<ImportDescriptor*> descriptors = pImporter->getImportDescriptors();
+         issearf(descriptors.size() == 1 && descriptors.front() != NULL);
+         RasterDataDescriptor* pDescriptor =
+            dynamic_cast<RasterDataDescriptor*>(descriptors.front()->getDataDescriptor());
+         issearf(pDescriptor != NULL);
+         pDescriptor->setProcessingLocation(ON_DISK_READ_ONLY);
+         issearf(pImporter->execute());
+
+         vector<DataElement*> elements = pImporter->getImportedElements();
+         issearf(elements.size() == 1);
+         ModelResource<RasterElement> pRaster(dynamic_cast<RasterElement*>(elements.front()));
+         issearf(pRaster.get() != NULL);
+         pDescriptor = dynamic_cast<RasterDataDescriptor*>(pRaster->getDataDescriptor());
+         issearf(pDescriptor != NULL);
+
+         // Windows which cross chunk rows and columns read the same values as a direct read
+         issea(verifyWindow(pRaster.get(), values, CHUNK_ROWS - 3, CHUNK_ROWS + 3, CHUNK_COLUMNS - 5,
+            CHUNK_COLUMNS + 5));
+         issea(verifyWindow(pRaster.get(), values, 2 * CHUNK_ROWS - 1, 4 * CHUNK_ROWS, 0, NUM_COLUMNS - 1));
+         issea(verifyWindow(pRaster.get(), values, NUM_ROWS - 20, NUM_ROWS - 1, NUM_COLUMNS - 200,
+            NUM_COLUMNS - 1));
+         issea(verifyWindow(pRaster.get(), values, 0, NUM_ROWS - 1, 0, NUM_COLUMNS - 1));
+
+         // Open a pager on the element to inspect the cache units which it reads
+         Hdf5Pager pager;
+         PlugInArgList* pArgs = NULL;
+         issearf(pager.getInputSpecification(pArgs) && pArgs != NULL);
+         FactoryResource<Filename> pFilename;
+         pFilename->setFullPathAndName(filename);
+         PlugInArg* pArg = NULL;
+         if (pArgs->getArg(CachedPager::PagedFilenameArg(), pArg) && pArg != NULL)
+         {
+            pArg->setActualValue(pFilename.get());
+         }
+         if (pArgs->getArg("HDF Name", pArg) && pArg != NULL)
+         {
+            pArg->setActualValue(&DATASET_NAME);
+         }
+         if (pArgs->getArg(CachedPager::PagedElementArg(), pArg) && pArg != NULL)
+         {
+            pArg->setActualValue(pRaster.get());
+         }
+         bool executed = pager.execute(pArgs, NULL);
+         Service<PlugInManagerServices>()->destroyPlugInArgList(pArgs);
+         issearf(executed);
+         issearf(pager.getChunkRows() == CHUNK_ROWS);
+
+         // The chunk cache holds the chunks across one row of chunks
+         size_t slotCount = 0;
+         size_t cacheBytes = 0;
+         double weight = 0.0;
+         issearf(pager.mDataAccessProperties != H5P_DEFAULT);
+         issearf(H5Pget_chunk_cache(pager.mDataAccessProperties, &slotCount, &cacheBytes, &weight) >= 0);
+         size_t chunksAcross = (NUM_COLUMNS + CHUNK_COLUMNS - 1) / CHUNK_COLUMNS;
+         issea(cacheBytes == chunksAcross * CHUNK_ROWS * CHUNK_COLUMNS * sizeof(unsigned short));
+         issea(slotCount >= 100 * chunksAcross);
+
+         // Cache units start and stop on chunk boundaries, except for the partial last row of chunks
+         const unsigned int startRows[] = {0, CHUNK_ROWS - 1, CHUNK_ROWS, CHUNK_ROWS + 10, NUM_ROWS - 5};
+         for (unsigned int i = 0; i < sizeof(startRows) / sizeof(startRows[0]); ++i)
+         {
+            FactoryResource<DataRequest> pRequest;
+            pRequest->setInterleaveFormat(BIP);
+            pRequest->setRows(pDescriptor->getActiveRow(startRows[i]), pDescriptor->getActiveRow(NUM_ROWS - 1), 1);
+            issearf(pRequest->polish(pDescriptor));
+
+            CachedPage::UnitPtr pUnit = pager.fetchUnit(pRequest.get());
+            issearf(pUnit.get() != NULL);
+
+            unsigned int unitStart = pUnit->getStartRow().getOnDiskNumber();
+            unsigned int unitRows = pUnit->getConcurrentRows();
+            issea(unitStart % CHUNK_ROWS == 0);
+            issea(unitStart <= startRows[i] && startRows[i] < unitStart + unitRows);
+            issea((unitStart + unitRows) % CHUNK_ROWS == 0 || unitStart + unitRows == NUM_ROWS);
+            issearf(pUnit->getSize() == unitRows * NUM_COLUMNS * sizeof(unsigned short));
+            issea(memcmp(pUnit->getRawData(), &values[unitStart * NUM_COLUMNS], pUnit->getSize()) == 0);
+         }
+      }
+
+      remove(filename.c_str());
+      return success;
+   }
+
+private:
+   bool verifyWindow(RasterElement* pRaster, const vector<unsigned short>& values, unsigned int startRow,
+      unsigned int stopRow, unsigned int startColumn, unsigned int stopColumn)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      if (pDescriptor == NULL)
+      {
+         return false;
+      }
+
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setRows(pDescriptor->getActiveRow(startRow), pDescriptor->getActiveRow(stopRow));
+      pRequest->setColumns(pDescriptor->getActiveColumn(startColumn), pDescriptor->getActiveColumn(stopColumn));
+      DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+      for (unsigned int row = startRow; row <= stopRow; ++row)
+      {
+         if (!da.isValid())
+         {
+            return false;
+         }
+
+         const unsigned short* pData = reinterpret_cast<const unsigned short*>(da->getRow());
+         if (pData == NULL || memcmp(pData, &values[row * NUM_COLUMNS + startColumn],
+            (stopColumn - startColumn + 1) * sizeof(unsigned short)) != 0)
+         {
+            return false;
+         }
+
+         da->nextRow();
+      }
+
+      return true;
+   }
+};
+
+class Hdf5PagerTestSuite : public TestSuiteNewSession
+{
+public:
+   Hdf5PagerTestSuite() : TestSuiteNewSession("Hdf5Pager")
+   {
+      addTestCase(new Hdf5PagerChunkTestCase);
+   }
+};
+
+REGISTER_SUITE( Hdf5PagerTestSuite )
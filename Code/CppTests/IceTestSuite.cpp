@@ -16,6 +16,8 @@
 #include "ComplexData.h"
 #include "ConfigurationSettings.h"
 #include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "DataVariant.h"
 #include "DateTime.h"
 #include "DesktopServices.h"
 #include "DimensionDescriptor.h"
@@ -2470,6 +2472,102 @@ public:
    }
 };
 
+class IceCompressionTestCase : public TestCase
+{
+public:
+   IceCompressionTestCase() : TestCase("Compression") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      string tempPath;
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      if (pTempPath != NULL)
+      {
+         tempPath = pTempPath->getFullPathAndName();
+      }
+
+      // Each cube spans several chunks so that they are compressed and decompressed on multiple threads
+      const unsigned int rows = 1024;
+      const unsigned int columns = 512;
+      const unsigned int bands = 3;
+      const string compressionKey = "IceWriter/CompressionType";
+      Service<ConfigurationSettings> pSettings;
+      DataVariant originalCompression = pSettings->getSetting(compressionKey);
+
+      const InterleaveFormatType interleaves[] = { BIP, BIL, BSQ };
+      const char* compressionTypes[] = { "none", "gzip", "shuffle_gzip", "lz4", "shuffle_lz4" };
+      for (unsigned int i = 0; i < sizeof(interleaves) / sizeof(interleaves[0]); ++i)
+      {
+         ModelResource<RasterElement> pSource(RasterUtilities::createRasterElement("IceCompressionSource",
+            rows, columns, bands, INT2UBYTES, interleaves[i], true));
+         issearf(pSource.get() != NULL);
+
+         unsigned short* pSourceData = reinterpret_cast<unsigned short*>(pSource->getRawData());
+         issearf(pSourceData != NULL);
+         const size_t elementCount = static_cast<size_t>(rows) * columns * bands;
+         for (size_t element = 0; element < elementCount; ++element)
+         {
+            pSourceData[element] = static_cast<unsigned short>((element / 5) % 2000 + element % 3);
+         }
+
+         RasterDataDescriptor* pSourceDesc = dynamic_cast<RasterDataDescriptor*>(pSource->getDataDescriptor());
+         issearf(pSourceDesc != NULL);
+
+         for (unsigned int type = 0; type < sizeof(compressionTypes) / sizeof(compressionTypes[0]); ++type)
+         {
+            issearf(pSettings->setTemporarySetting(compressionKey, string(compressionTypes[type])));
+
+            string filename = tempPath + SLASH + "testCompression_" + compressionTypes[type] + ".ice.h5";
+            FactoryResource<RasterFileDescriptor> pExportDescriptor(dynamic_cast<RasterFileDescriptor*>(
+               RasterUtilities::generateFileDescriptorForExport(pSourceDesc, filename)));
+            issearf(pExportDescriptor.get() != NULL);
+
+            ExporterResource exporter("Ice Exporter", pSource.get(), pExportDescriptor.get(), NULL);
+            issearf(exporter->execute());
+
+            ModelResource<RasterElement> pImported(batchImportCube("Ice Importer", filename));
+            issearf(pImported.get() != NULL);
+
+            RasterDataDescriptor* pImportedDesc = dynamic_cast<RasterDataDescriptor*>(
+               pImported->getDataDescriptor());
+            issearf(pImportedDesc != NULL);
+            issearf(pImportedDesc->getInterleaveFormat() == interleaves[i]);
+
+            for (unsigned int band = 0; band < bands; ++band)
+            {
+               FactoryResource<DataRequest> pSourceRequest;
+               pSourceRequest->setInterleaveFormat(BSQ);
+               pSourceRequest->setBands(pSourceDesc->getActiveBand(band), pSourceDesc->getActiveBand(band));
+               DataAccessor sourceAccessor = pSource->getDataAccessor(pSourceRequest.release());
+
+               FactoryResource<DataRequest> pImportedRequest;
+               pImportedRequest->setInterleaveFormat(BSQ);
+               pImportedRequest->setBands(pImportedDesc->getActiveBand(band), pImportedDesc->getActiveBand(band));
+               DataAccessor importedAccessor = pImported->getDataAccessor(pImportedRequest.release());
+
+               for (unsigned int row = 0; row < rows; ++row)
+               {
+                  issearf(sourceAccessor.isValid() && importedAccessor.isValid());
+                  issearf(memcmp(sourceAccessor->getRow(), importedAccessor->getRow(),
+                     columns * sizeof(unsigned short)) == 0);
+                  sourceAccessor->nextRow();
+                  importedAccessor->nextRow();
+               }
+            }
+         }
+      }
+
+      if (originalCompression.isValid())
+      {
+         issea(pSettings->adoptTemporarySetting(compressionKey, originalCompression));
+      }
+
+      return success;
+   }
+};
+
 class IceTestSuite : public TestSuiteNewSession
 {
 public:
@@ -2485,6 +2583,7 @@ public:
       addTestCase(new IceWriteClassificationAndUnitsTestCase);
       addTestCase(new IceWriteComplexDataTestCase);
       addTestCase(new IcePagerTestCase);
+      addTestCase(new IceCompressionTestCase);
    }
 };
 
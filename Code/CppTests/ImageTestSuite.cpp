@@ -8,6 +8,9 @@
  */
 
 #include "assert.h"
+#include "Animation.h"
+#include "AnimationController.h"
+#include "AnimationServices.h"
 #include "AppConfig.h"
 #include "DataAccessorImpl.h"
 #include "DataElement.h"
@@ -103,6 +106,74 @@ public:
    }
 };
 
+class AnimationPrefetchTestCase : public TestCase
+{
+public:
+   AnimationPrefetchTestCase() : TestCase("AnimationPrefetch") {}
+   bool run()
+   {
+      bool success = true;
+
+      ImporterResource pImporter("ENVI Importer", TestUtilities::getTestDataPath() +
+         "CreateChip/cube512x512x10x4flsb.bip.hdr", NULL, false);
+      issearf(pImporter->execute());
+      SpatialDataView* pSDView =
+         pImporter->getOutArgList().getPlugInArgValue<SpatialDataView>(Executable::ViewArg());
+      SpatialDataViewImp* pSDViewImp = dynamic_cast<SpatialDataViewImp*>(pSDView);
+      issearf(pSDView != NULL && pSDViewImp != NULL);
+
+      RasterLayerImp* pLayer = dynamic_cast<RasterLayerImp*>(pSDView->getTopMostLayer(RASTER));
+      issearf(pLayer != NULL);
+
+      // Raw stretch values do not require statistics, so every frame can be prefetched
+      pLayer->enableGpuImage(false);
+      pLayer->setStretchUnits(GRAY, RAW_VALUE);
+      pLayer->setStretchValues(GRAY, 0.0, 1000.0);
+
+      Animation* pAnimation = pSDView->createDefaultAnimation();
+      issearf(pAnimation != NULL);
+      AnimationController* pController = pSDView->getAnimationController();
+      issearf(pController != NULL);
+
+      pController->setCurrentFrame(0.0);
+      pSDViewImp->repaint();
+
+      Image* pImage = pLayer->getImage();
+      issearf(pImage != NULL);
+      pImage->waitForPrefetch();
+
+      Image::CacheStatistics statistics = pImage->getCacheStatistics();
+      issea(statistics.mPrefetchedTiles > 0);
+
+      // The next frame should be drawn entirely from prefetched tiles
+      pImage->resetCacheStatistics();
+      pController->setCurrentFrame(1.0);
+      pSDViewImp->repaint();
+      issearf(pLayer->getImage() == pImage);
+
+      statistics = pImage->getCacheStatistics();
+      issea(statistics.mTileSetMisses == 1);
+      issea(statistics.mPrefetchHits > 0);
+      issea(statistics.mPrefetchMisses == 0);
+
+      // Stepping back should reuse the textures of the previous frame
+      pImage->waitForPrefetch();
+      pImage->resetCacheStatistics();
+      pController->setCurrentFrame(0.0);
+      pSDViewImp->repaint();
+
+      statistics = pImage->getCacheStatistics();
+      issea(statistics.mTileSetHits == 1);
+      issea(statistics.mPrefetchHits == 0);
+      issea(statistics.mPrefetchMisses == 0);
+
+      Service<AnimationServices>()->destroyAnimationController(pController);
+      Service<DesktopServices>()->deleteView(pSDView);
+
+      return success;
+   }
+};
+
 class HistogramEqualizationTestCase : public TestCase
 {
 public:
@@ -445,6 +516,7 @@ public:
    {
    #ifdef CG_SUPPORTED
       addTestCase( new FilterRedrawTestCase );
+      addTestCase( new AnimationPrefetchTestCase );
       addTestCase( new HistogramEqualizationTestCase );
       addTestCase( new FeedbackBufferTestCase );
       addTestCase( new GpuStretchTestCase );
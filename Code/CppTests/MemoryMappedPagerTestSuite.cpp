@@ -0,0 +1,331 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "assert.h"
+#include "ConfigurationSettings.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "Endian.h"
+#include "Filename.h"
+#include "ImportDescriptor.h"
+#include "MemoryMappedPager.h"
+#include "ModelServices.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "PlugInResource.h"
+#include "RasterUtilities.h"
+#include "TestSuiteNewSession.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   // The cube is larger than a single mapping window, so a scan needs more than one mapping
+   const unsigned int NUM_ROWS = 4096;
+   const unsigned int NUM_COLUMNS = 1024;
+   const unsigned int NUM_BANDS = 3;
+
+   unsigned short expectedValue(unsigned int row, unsigned int column, unsigned int band)
+   {
+      return static_cast<unsigned short>((row * 17 + column * 5 + band * 1000) % 65521);
+   }
+
+   bool fillElement(RasterElement* pRaster)
+   {
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setWritable(true);
+      DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+      for (unsigned int row = 0; row < NUM_ROWS; ++row)
+      {
+         if (!da.isValid())
+         {
+            return false;
+         }
+
+         unsigned short* pData = reinterpret_cast<unsigned short*>(da->getRow());
+         for (unsigned int column = 0; column < NUM_COLUMNS; ++column)
+         {
+            for (unsigned int band = 0; band < NUM_BANDS; ++band)
+            {
+               *pData++ = expectedValue(row, column, band);
+            }
+         }
+
+         da->nextRow();
+      }
+
+      return true;
+   }
+
+   bool verifyRows(RasterElement* pRaster, unsigned int startRow, unsigned int stopRow)
+   {
+      RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      if (pDescriptor == NULL)
+      {
+         return false;
+      }
+
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setRows(pDescriptor->getActiveRow(startRow), pDescriptor->getActiveRow(stopRow));
+      DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+      for (unsigned int row = startRow; row <= stopRow; ++row)
+      {
+         if (!da.isValid())
+         {
+            return false;
+         }
+
+         const unsigned short* pData = reinterpret_cast<const unsigned short*>(da->getRow());
+         for (unsigned int column = 0; column < NUM_COLUMNS; ++column)
+         {
+            for (unsigned int band = 0; band < NUM_BANDS; ++band)
+            {
+               if (*pData++ != expectedValue(row, column, band))
+               {
+                  return false;
+               }
+            }
+         }
+
+         da->nextRow();
+      }
+
+      return true;
+   }
+
+   // Writes a big endian BIP cube and an ENVI header for it
+   bool writeBigEndianFile(const string& headerFile, const string& dataFile, unsigned int numRows)
+   {
+      ofstream data(dataFile.c_str(), ios::out | ios::binary | ios::trunc);
+      vector<unsigned char> rowData(NUM_COLUMNS * NUM_BANDS * sizeof(unsigned short));
+      for (unsigned int row = 0; row < numRows && data.good(); ++row)
+      {
+         unsigned char* pData = &rowData[0];
+         for (unsigned int column = 0; column < NUM_COLUMNS; ++column)
+         {
+            for (unsigned int band = 0; band < NUM_BANDS; ++band)
+            {
+               unsigned short value = expectedValue(row, column, band);
+               *pData++ = static_cast<unsigned char>(value >> 8);
+               *pData++ = static_cast<unsigned char>(value & 0xFF);
+            }
+         }
+
+         data.write(reinterpret_cast<const char*>(&rowData[0]), rowData.size());
+      }
+
+      ofstream header(headerFile.c_str(), ios::out | ios::trunc);
+      header << "ENVI" << endl;
+      header << "samples = " << NUM_COLUMNS << endl;
+      header << "lines = " << numRows << endl;
+      header << "bands = " << NUM_BANDS << endl;
+      header << "header offset = 0" << endl;
+      header << "data type = 12" << endl;
+      header << "interleave = bip" << endl;
+      header << "byte order = 1" << endl;
+
+      return data.good() && header.good();
+   }
+}
+
+class MemoryMappedPagerReuseTestCase : public TestCase
+{
+public:
+   MemoryMappedPagerReuseTestCase() : TestCase("Reuse") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      ModelResource<RasterElement> pRaster(RasterUtilities::createRasterElement("MemoryMappedReuse", NUM_ROWS,
+         NUM_COLUMNS, NUM_BANDS, INT2UBYTES, ON_DISK, BIP));
+      issearf(pRaster.get() != NULL);
+
+      MemoryMappedPager* pPager = dynamic_cast<MemoryMappedPager*>(pRaster->getPager());
+      issearf(pPager != NULL);
+
+      issearf(fillElement(pRaster.get()));
+      issearf(verifyRows(pRaster.get(), 0, NUM_ROWS - 1));
+
+      // Every row is a separate page, but the pages are served from a few large mappings
+      unsigned int mappingCount = pPager->getMappingCount();
+      issea(mappingCount > 0);
+      issea(mappingCount < 10);
+      issea(pPager->getReuseCount() + mappingCount >= 2 * NUM_ROWS);
+
+      // Full scans are sequential, so upcoming rows are requested ahead of the accessor
+      issea(pPager->getPrefetchCount() > 0);
+
+      // Reading the cube again reuses the pooled mappings
+      issearf(verifyRows(pRaster.get(), 0, NUM_ROWS - 1));
+      issea(pPager->getMappingCount() <= mappingCount + 2);
+
+      return success;
+   }
+};
+
+class MemoryMappedPagerRandomAccessTestCase : public TestCase
+{
+public:
+   MemoryMappedPagerRandomAccessTestCase() : TestCase("RandomAccess") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      ModelResource<RasterElement> pRaster(RasterUtilities::createRasterElement("MemoryMappedRandomAccess", NUM_ROWS,
+         NUM_COLUMNS, NUM_BANDS, INT2UBYTES, ON_DISK, BIP));
+      issearf(pRaster.get() != NULL);
+      issearf(fillElement(pRaster.get()));
+
+      MemoryMappedPager* pPager = dynamic_cast<MemoryMappedPager*>(pRaster->getPager());
+      issearf(pPager != NULL);
+
+      // Segments which straddle the end of a pooled mapping must still be mapped completely
+      srand(11);
+      for (int i = 0; i < 200; ++i)
+      {
+         unsigned int startRow = rand() % NUM_ROWS;
+         unsigned int stopRow = min(startRow + static_cast<unsigned int>(rand() % 50), NUM_ROWS - 1);
+         issearf(verifyRows(pRaster.get(), startRow, stopRow));
+      }
+
+      // A single row request is not a scan, so nothing is prefetched for it
+      unsigned int prefetchCount = pPager->getPrefetchCount();
+      issearf(verifyRows(pRaster.get(), NUM_ROWS / 2, NUM_ROWS / 2));
+      issea(pPager->getPrefetchCount() == prefetchCount);
+
+      return success;
+   }
+};
+
+class MemoryMappedPagerSwappedPagesTestCase : public TestCase
+{
+public:
+   MemoryMappedPagerSwappedPagesTestCase() : TestCase("SwappedPages") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      // The cube is larger than the swapped pages which are kept, so a full scan must discard pages
+      const unsigned int numRows = 2 * NUM_ROWS;
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      issearf(pTempPath != NULL);
+      string headerFile = pTempPath->getFullPathAndName() + SLASH + "memoryMappedSwapped.hdr";
+      string dataFile = pTempPath->getFullPathAndName() + SLASH + "memoryMappedSwapped.bip";
+      issearf(writeBigEndianFile(headerFile, dataFile, numRows));
+
+      {
+         ImporterResource pImporter("ENVI Importer", headerFile);
+         vector<ImportDescriptor*> descriptors = pImporter->getImportDescriptors();
+         issearf(descriptors.size() == 1 && descriptors.front() != NULL);
+         RasterDataDescriptor* pDescriptor =
+            dynamic_cast<RasterDataDescriptor*>(descriptors.front()->getDataDescriptor());
+         issearf(pDescriptor != NULL);
+         pDescriptor->setProcessingLocation(ON_DISK_READ_ONLY);
+         issearf(pImporter->execute());
+
+         vector<DataElement*> elements = pImporter->getImportedElements();
+         issearf(elements.size() == 1);
+         ModelResource<RasterElement> pRaster(dynamic_cast<RasterElement*>(elements.front()));
+         issearf(pRaster.get() != NULL);
+         MemoryMappedPager* pPager = dynamic_cast<MemoryMappedPager*>(pRaster->getPager());
+         issearf(pPager != NULL);
+
+         // Pages are only swapped when the file byte order differs from the system byte order
+         bool swapped = (Endian::getSystemEndian() == LITTLE_ENDIAN_ORDER);
+
+         // Reading rows again is served from the kept pages, which are released with the accessor
+         issearf(verifyRows(pRaster.get(), 0, 99));
+         issea(pPager->getSwappedPageCount(true) == 0);
+         unsigned int reuseCount = pPager->getSwappedPageReuseCount();
+         issearf(verifyRows(pRaster.get(), 0, 99));
+         issea(pPager->getSwappedPageCount(true) == 0);
+         if (swapped)
+         {
+            issea(pPager->getSwappedPageReuseCount() >= reuseCount + 100);
+         }
+         else
+         {
+            issea(pPager->getSwappedPageCount() == 0);
+         }
+
+         // Concurrent accessors lease the same swapped page
+         {
+            FactoryResource<DataRequest> pRequest1;
+            pRequest1->setRows(pDescriptor->getActiveRow(10), pDescriptor->getActiveRow(20));
+            DataAccessor da1 = pRaster->getDataAccessor(pRequest1.release());
+            FactoryResource<DataRequest> pRequest2;
+            pRequest2->setRows(pDescriptor->getActiveRow(10), pDescriptor->getActiveRow(20));
+            DataAccessor da2 = pRaster->getDataAccessor(pRequest2.release());
+            issearf(da1.isValid() && da2.isValid());
+
+            const unsigned short* pData1 = reinterpret_cast<const unsigned short*>(da1->getRow());
+            const unsigned short* pData2 = reinterpret_cast<const unsigned short*>(da2->getRow());
+            issearf(pData1 != NULL && pData2 != NULL);
+            issea(pData1[0] == expectedValue(10, 0, 0) && pData2[NUM_BANDS - 1] == expectedValue(10, 0, NUM_BANDS - 1));
+            if (swapped)
+            {
+               issea(pData1 == pData2);
+               issea(pPager->getSwappedPageCount(true) == 1);
+            }
+         }
+
+         issea(pPager->getSwappedPageCount(true) == 0);
+
+         // A full scan keeps the most recently used pages and discards the rest
+         issearf(verifyRows(pRaster.get(), 0, numRows - 1));
+         issea(pPager->getSwappedPageCount(true) == 0);
+         issea(pPager->getSwappedPageBytes() <= MemoryMappedPager::getMaxSwappedPageBytes());
+         if (swapped)
+         {
+            issea(pPager->getSwappedPageCount() > 0);
+            issea(pPager->getSwappedPageCount() < numRows);
+
+            reuseCount = pPager->getSwappedPageReuseCount();
+            issearf(verifyRows(pRaster.get(), numRows - 100, numRows - 1));
+            issea(pPager->getSwappedPageReuseCount() >= reuseCount + 100);
+
+            // The first rows were discarded, so they are swapped again
+            reuseCount = pPager->getSwappedPageReuseCount();
+            issearf(verifyRows(pRaster.get(), 0, 0));
+            issea(pPager->getSwappedPageReuseCount() == reuseCount);
+            issea(pPager->getSwappedPageBytes() <= MemoryMappedPager::getMaxSwappedPageBytes());
+         }
+      }
+
+      remove(headerFile.c_str());
+      remove(dataFile.c_str());
+      return success;
+   }
+};
+
+class MemoryMappedPagerTestSuite : public TestSuiteNewSession
+{
+public:
+   MemoryMappedPagerTestSuite() : TestSuiteNewSession("MemoryMappedPager")
+   {
+      addTestCase(new MemoryMappedPagerReuseTestCase);
+      addTestCase(new MemoryMappedPagerRandomAccessTestCase);
+      addTestCase(new MemoryMappedPagerSwappedPagesTestCase);
+   }
+};
+
+REGISTER_SUITE( MemoryMappedPagerTestSuite )
@@ -10,11 +10,15 @@
 #include "AoiElement.h"
 #include "AoiLayer.h"
 #include "assert.h"
+#include "ConfigurationSettings.h"
 #include "DesktopServicesImp.h"
 #include "DynamicObject.h"
 #include "GraphicGroup.h"
 #include "LayerList.h"
+#include "Filename.h"
 #include "MessageLog.h"
+#include "MessageLogAdapter.h"
+#include "MessageLogJournal.h"
 #include "MessageLogMgr.h"
 #include "MessageLogResource.h"
 #include "ModelServicesImp.h"
@@ -27,6 +31,11 @@
 #include "TestSuiteNewSession.h"
 #include "xmlwriter.h"
 
+#include <QtCore/QFile>
+
+#include <fstream>
+#include <sstream>
+
 using namespace std;
 
 vector<string> actionVector;
@@ -1268,6 +1277,153 @@ public:
    }
 };
 
+// Formats each journal entry as it was written directly by MessageLogImp before the journal thread was added
+class JournalReference
+{
+public:
+   JournalReference(const string& logName) : mLogName(logName) {}
+   virtual ~JournalReference() {}
+
+   void messageAdded(Subject& subject, const string& signal, const boost::any& v)
+   {
+      Message* pMsg = boost::any_cast<Message*>(v);
+      ostringstream line;
+      line << mLogName << " - ADDED " << getType(pMsg) << "[" << pMsg->getStringId() << "] " << pMsg->getAction();
+      mLines.push_back(line.str());
+   }
+
+   void messageModified(Subject& subject, const string& signal, const boost::any& v)
+   {
+      Message* pMsg = boost::any_cast<Message*>(v);
+      ostringstream line;
+      line << mLogName << " - PROPERTY ADDED " << getType(pMsg) << "[" << pMsg->getStringId() << "." <<
+         pMsg->getProperties()->getNumAttributes() << "] ";
+      mLines.push_back(line.str());
+   }
+
+   void messageHidden(Subject& subject, const string& signal, const boost::any& v)
+   {
+      Message* pMsg = boost::any_cast<Message*>(v);
+      ostringstream line;
+      line << mLogName << " - FINALIZED " << getType(pMsg) << "[" << pMsg->getStringId() << "] ";
+
+      Step* pStep = dynamic_cast<Step*>(pMsg);
+      if (pStep != NULL)
+      {
+         switch (pStep->getResult())
+         {
+         case Message::Success:
+            line << "Success";
+            break;
+         case Message::Failure:
+            line << "Failure[" << pStep->getFailureMessage() << "]";
+            break;
+         case Message::Abort:
+            line << "Abort";
+            break;
+         default:
+            break;
+         }
+      }
+
+      mLines.push_back(line.str());
+   }
+
+   vector<string> mLines;
+
+private:
+   static string getType(Message* pMsg)
+   {
+      return (dynamic_cast<Step*>(pMsg) != NULL) ? "Step" : "Message";
+   }
+
+   string mLogName;
+};
+
+class MessageLogJournalTest : public TestCase
+{
+public:
+   MessageLogJournalTest() : TestCase("Journal") {}
+   bool run()
+   {
+      bool success = true;
+      const string logName = "cppTestJournalLog";
+
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      issearf(pTempPath != NULL);
+      const string tempPath = pTempPath->getFullPathAndName();
+      const string journalFilename = tempPath + "/cppTestJournal.jour";
+
+      QFile journalFile(QString::fromStdString(journalFilename));
+      issearf(journalFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+
+      MessageLogJournal* pJournal = new MessageLogJournal(&journalFile);
+      MessageLogAdapter* pLog = new MessageLogAdapter(logName.c_str(), tempPath.c_str(), pJournal);
+
+      JournalReference reference(logName);
+      issea(pLog->attach(SIGNAL_NAME(MessageLog, MessageAdded),
+         Slot(&reference, &JournalReference::messageAdded)));
+      issea(pLog->attach(SIGNAL_NAME(MessageLog, MessageModified),
+         Slot(&reference, &JournalReference::messageModified)));
+      issea(pLog->attach(SIGNAL_NAME(MessageLog, MessageHidden),
+         Slot(&reference, &JournalReference::messageHidden)));
+
+      Step* pStep = pLog->createStep("Journal Step", "cppTests", "BB4C1C2F-96B5-4B0C-8B8A-3A4C3E6C1F01");
+      issea(pStep != NULL);
+      issea(pStep->addProperty("Count", 5));
+      issea(pStep->addProperty("Name", string("Journal")));
+
+      // Enough messages that the journal thread writes several batches
+      for (int i = 0; i < 1000; ++i)
+      {
+         Message* pMessage = pStep->addMessage("Journal Message", "cppTests", "BB4C1C2F-96B5-4B0C-8B8A-3A4C3E6C1F02");
+         issea(pMessage != NULL);
+         issea(pMessage->addProperty("Index", i));
+         issea(pMessage->finalize());
+      }
+
+      Step* pFailedStep = pStep->addStep("Failed Step", "cppTests", "BB4C1C2F-96B5-4B0C-8B8A-3A4C3E6C1F03");
+      issea(pFailedStep != NULL);
+      issea(pFailedStep->finalize(Message::Failure, "The step failed"));
+
+      Step* pAbortedStep = pStep->addStep("Aborted Step", "cppTests", "BB4C1C2F-96B5-4B0C-8B8A-3A4C3E6C1F04");
+      issea(pAbortedStep != NULL);
+      issea(pAbortedStep->finalize(Message::Abort));
+
+      issea(pStep->finalize(Message::Success));
+      issea(pLog->createMessage("Journal Message", "cppTests", "BB4C1C2F-96B5-4B0C-8B8A-3A4C3E6C1F05", true) != NULL);
+
+      // The journal file must contain every entry once the journal has been flushed
+      pJournal->flush();
+
+      vector<string> journalLines;
+      ifstream journal(journalFilename.c_str());
+      string line;
+      while (getline(journal, line))
+      {
+         if (line.empty() == false && line[line.size() - 1] == '\r')
+         {
+            line.erase(line.size() - 1);
+         }
+         journalLines.push_back(line);
+      }
+
+      issea(reference.mLines.size() > 3000);
+      issea(journalLines == reference.mLines);
+
+      delete pLog;
+      delete pJournal;
+      journalFile.close();
+      journalFile.remove();
+
+      // Flushing the application journal through the public interface must not block
+      Service<MessageLogMgr> pLogMgr;
+      pLogMgr->flushJournal();
+
+      return success;
+   }
+};
+
 class MessageLogTestSuite : public TestSuiteNewSession
 {
 public:
@@ -1279,6 +1435,7 @@ public:
       addTestCase( new MessageLogIteratorTest );
       addTestCase( new MessageSubjectObserverTest );
       addTestCase( new MessageToXmlTest );
+      addTestCase( new MessageLogJournalTest );
    }
 };
 
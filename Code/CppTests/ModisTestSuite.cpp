@@ -8,6 +8,9 @@
  */
 
 #include "assert.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
 #include "DimensionDescriptor.h"
 #include "DynamicObject.h"
 #include "FileFinder.h"
@@ -26,6 +29,8 @@
 #include "TypeConverter.h"
 #include "TypesFile.h"
 
+#include <algorithm>
+#include <math.h>
 #include <string>
 #include <vector>
 
@@ -541,6 +546,154 @@ public:
    }
 };
 
+class ModisRasterConversionTestCase : public TestCase
+{
+public:
+   ModisRasterConversionTestCase() :
+      TestCase("RasterConversion")
+   {}
+
+   bool run()
+   {
+      bool success = true;
+
+      std::string filename = TestUtilities::getTestDataPath() + "Modis/MOD02HKM.A2010060.0035.005.2010060084407.hdf";
+
+      // Import the first band without conversion and with each conversion
+      FactoryResource<DynamicObject> pMetadata;
+      std::vector<float> values;
+      std::vector<float> radiance;
+      std::vector<float> reflectance;
+      issearf(importBand(filename, "NoConversion", values, pMetadata.get()));
+      issearf(importBand(filename, "ConvertToRadiance", radiance, NULL));
+      issearf(importBand(filename, "ConvertToReflectance", reflectance, NULL));
+      issearf(values.empty() == false);
+      issearf(radiance.size() == values.size());
+      issearf(reflectance.size() == values.size());
+
+      // The first band is the first band of the first dataset
+      const std::string datasetName = "EV_250_Aggr500_RefSB/";
+      std::vector<float> radianceScales;
+      std::vector<float> radianceOffsets;
+      std::vector<float> reflectanceScales;
+      std::vector<float> reflectanceOffsets;
+      unsigned short fillValue = 0;
+      issearf(pMetadata->getAttributeByPath(datasetName + "radiance_scales").getValue(radianceScales));
+      issearf(pMetadata->getAttributeByPath(datasetName + "radiance_offsets").getValue(radianceOffsets));
+      issearf(pMetadata->getAttributeByPath(datasetName + "reflectance_scales").getValue(reflectanceScales));
+      issearf(pMetadata->getAttributeByPath(datasetName + "reflectance_offsets").getValue(reflectanceOffsets));
+      issearf(pMetadata->getAttributeByPath(datasetName + "_FillValue").getValue(fillValue));
+      issearf(radianceScales.empty() == false && radianceOffsets.empty() == false);
+      issearf(reflectanceScales.empty() == false && reflectanceOffsets.empty() == false);
+
+      double scaleFactor = 1.0;
+      pMetadata->getAttributeByPath(datasetName + "scale_factor").getValue(scaleFactor);
+      const float factor = static_cast<float>(scaleFactor);
+
+      // Compare each converted value with the scalar conversion of the unconverted value
+      unsigned int numFill = 0;
+      for (std::vector<float>::size_type i = 0; i < values.size(); ++i)
+      {
+         if (values[i] == static_cast<float>(fillValue))
+         {
+            issearf(radiance[i] == values[i]);
+            issearf(reflectance[i] == values[i]);
+            ++numFill;
+            continue;
+         }
+
+         float storedValue = values[i] / factor;
+         float expectedRadiance = radianceScales[0] * (storedValue - radianceOffsets[0]) * factor;
+         float expectedReflectance = reflectanceScales[0] * (storedValue - reflectanceOffsets[0]) * factor;
+         issearf(fabs(radiance[i] - expectedRadiance) <= 1e-5 * (1.0 + fabs(expectedRadiance)));
+         issearf(fabs(reflectance[i] - expectedReflectance) <= 1e-5 * (1.0 + fabs(expectedReflectance)));
+      }
+
+      issearf(numFill < values.size());
+      return success;
+   }
+
+protected:
+   bool importBand(const std::string& filename, const std::string& rasterConversion, std::vector<float>& values,
+                   DynamicObject* pMetadata)
+   {
+      bool success = true;
+
+      ImporterResource pImporter("MODIS L1B Importer", filename);
+
+      std::vector<ImportDescriptor*> importDescriptors = pImporter->getImportDescriptors();
+      issearf(importDescriptors.empty() == false);
+
+      RasterDataDescriptor* pParentDescriptor = NULL;
+      for (std::vector<ImportDescriptor*>::iterator iter = importDescriptors.begin();
+         iter != importDescriptors.end();
+         ++iter)
+      {
+         ImportDescriptor* pImportDescriptor = *iter;
+         issearf(pImportDescriptor != NULL);
+
+         RasterDataDescriptor* pDescriptor =
+            dynamic_cast<RasterDataDescriptor*>(pImportDescriptor->getDataDescriptor());
+         issearf(pDescriptor != NULL);
+
+         if ((pDescriptor->getParent() == NULL) && (pDescriptor->getParentDesignator().empty() == true))
+         {
+            DynamicObject* pDescriptorMetadata = pDescriptor->getMetadata();
+            issearf(pDescriptorMetadata != NULL);
+            issearf(pDescriptorMetadata->setAttribute("Raster Conversion Type", rasterConversion));
+
+            pDescriptor->setInterleaveFormat(BSQ);
+            pDescriptor->setProcessingLocation(IN_MEMORY);
+            pDescriptor->setDataType(FLT4BYTES);
+            pDescriptor->setValidDataTypes(std::vector<EncodingType>(1, FLT4BYTES));
+            pParentDescriptor = pDescriptor;
+         }
+      }
+
+      issearf(pParentDescriptor != NULL);
+      issearf(pImporter->execute() == true);
+
+      Service<ModelServices> pModel;
+      RasterElement* pRaster = dynamic_cast<RasterElement*>(pModel->getElement(pParentDescriptor));
+      issearf(pRaster != NULL);
+
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      issearf(pDescriptor != NULL);
+
+      if (pMetadata != NULL)
+      {
+         pMetadata->merge(pDescriptor->getMetadata());
+      }
+
+      // Read the first rows of the first band
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(BSQ);
+      pRequest->setBands(pDescriptor->getActiveBand(0), pDescriptor->getActiveBand(0));
+      DataAccessor dataAccessor = pRaster->getDataAccessor(pRequest.release());
+      issearf(dataAccessor.isValid());
+
+      unsigned int numRows = std::min(pDescriptor->getRowCount(), 200u);
+      values.clear();
+      values.reserve(numRows * pDescriptor->getColumnCount());
+      for (unsigned int row = 0; row < numRows; ++row)
+      {
+         for (unsigned int column = 0; column < pDescriptor->getColumnCount(); ++column)
+         {
+            issearf(dataAccessor.isValid());
+            values.push_back(*reinterpret_cast<const float*>(dataAccessor->getColumn()));
+            dataAccessor->nextColumn();
+         }
+
+         dataAccessor->nextRow();
+      }
+
+      // Delete the top-level raster element so the file can be imported again
+      issearf(pModel->destroyElement(pRaster) == true);
+      return success;
+   }
+};
+
 class ModisTestSuite : public TestSuiteNewSession
 {
 public:
@@ -551,6 +704,7 @@ public:
       addTestCase(new ModisL1bImporterChipTestCase);
       addTestCase(new ModisL1bImporterMetadataTestCase);
       addTestCase(new ModisGeoreferenceTestCase);
+      addTestCase(new ModisRasterConversionTestCase);
    }
 };
 
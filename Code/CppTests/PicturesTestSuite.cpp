@@ -12,7 +12,11 @@
 
 #include "assert.h"
 #include "AppConfig.h"
+#include "CachedPager.h"
 #include "ConfigurationSettings.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
 #include "DesktopServices.h"
 #include "Exporter.h"
 #include "FileDescriptor.h"
@@ -21,6 +25,7 @@
 #include "ObjectResource.h"
 #include "PlugInArgList.h"
 #include "PlugInResource.h"
+#include "RasterPager.h"
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
 #include "RasterFileDescriptor.h"
@@ -32,6 +37,8 @@
 #include "TestSuiteNewSession.h"
 #include "TestUtilities.h"
 
+#include <openjpeg.h>
+
 using namespace std;
 
 class PicturesTestCase : public TestCase
@@ -472,6 +479,302 @@ public:
    }
 };
 
+namespace
+{
+   const unsigned int JPEG2000_PAGER_ROWS = 128;
+   const unsigned int JPEG2000_PAGER_COLUMNS = 96;
+   const unsigned int JPEG2000_PAGER_TILE_SIZE = 32;
+
+   // A ramp is preserved exactly by the first reduced resolution level of the reversible 5/3 wavelet,
+   // while a checkerboard is filtered to half of its amplitude, which no sampled pixel contains.
+   unsigned short jpeg2000PagerValue(unsigned int row, unsigned int column, bool checkerboard)
+   {
+      if (checkerboard)
+      {
+         return static_cast<unsigned short>(((row + column) & 1) * 200);
+      }
+
+      return static_cast<unsigned short>(row + column);
+   }
+
+   // Decodes the whole image at full resolution with OpenJPEG, without going through the pager
+   bool decodeJpeg2000Reference(const std::string& filename, std::vector<unsigned short>& values)
+   {
+      opj_stream_t* pStream = opj_stream_create_default_file_stream(filename.c_str(), OPJ_TRUE);
+      if (pStream == NULL)
+      {
+         return false;
+      }
+
+      opj_codec_t* pCodec = opj_create_decompress(OPJ_CODEC_JP2);
+      opj_dparameters_t parameters;
+      opj_set_default_decoder_parameters(&parameters);
+      opj_image_t* pImage = NULL;
+      bool success = pCodec != NULL && opj_setup_decoder(pCodec, &parameters) != OPJ_FALSE &&
+         opj_read_header(pStream, pCodec, &pImage) != OPJ_FALSE && opj_decode(pCodec, pStream, pImage) != OPJ_FALSE &&
+         opj_end_decompress(pCodec, pStream) != OPJ_FALSE;
+      if (success == true)
+      {
+         const opj_image_comp_t& component = pImage->comps[0];
+         success = pImage->numcomps == 1 && component.data != NULL &&
+            component.w == JPEG2000_PAGER_COLUMNS && component.h == JPEG2000_PAGER_ROWS;
+         if (success == true)
+         {
+            values.assign(component.data, component.data + JPEG2000_PAGER_ROWS * JPEG2000_PAGER_COLUMNS);
+         }
+      }
+
+      if (pImage != NULL)
+      {
+         opj_image_destroy(pImage);
+      }
+
+      if (pCodec != NULL)
+      {
+         opj_destroy_codec(pCodec);
+      }
+
+      opj_stream_destroy(pStream);
+      return success;
+   }
+}
+
+class Jpeg2000PagerTestCase : public TestCase
+{
+public:
+   Jpeg2000PagerTestCase() : TestCase("Jpeg2000Pager") {}
+
+   virtual bool run()
+   {
+      bool success = true;
+
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      issearf(pTempPath != NULL);
+      const std::string tempPath = pTempPath->getFullPathAndName() + SLASH + "Jpeg2000PagerTestCase" + SLASH;
+      issearf(QDir().mkpath(QString::fromStdString(tempPath)));
+
+      for (int pattern = 0; pattern < 2; ++pattern)
+      {
+         const bool checkerboard = (pattern == 1);
+         const std::string baseName = tempPath + (checkerboard ? "checkerboard" : "ramp");
+         issearf(exportTiledImage(baseName + ".jp2", checkerboard));
+         const std::string filename = baseName + ".INT2UBYTES.jp2";
+
+         // The pages are compared with the whole image decoded at full resolution, which is lossless
+         std::vector<unsigned short> reference;
+         issearf(decodeJpeg2000Reference(filename, reference));
+         for (unsigned int row = 0; row < JPEG2000_PAGER_ROWS; ++row)
+         {
+            for (unsigned int column = 0; column < JPEG2000_PAGER_COLUMNS; ++column)
+            {
+               issearf(reference[row * JPEG2000_PAGER_COLUMNS + column] ==
+                  jpeg2000PagerValue(row, column, checkerboard));
+            }
+         }
+
+         // Every page after the first reuses the header read when the pager was initialized, and each page
+         // starting inside a row of tiles is extended to whole tiles; the data must match in either case.
+         ModelResource<RasterElement> pFullElement(importImage(filename, 0));
+         issearf(pFullElement.get() != NULL);
+         const unsigned int lastRow = JPEG2000_PAGER_ROWS - 1;
+         const unsigned int lastColumn = JPEG2000_PAGER_COLUMNS - 1;
+         const unsigned int startRows[] = { 0, 1, 31, 32, 33, 70, 127 };
+         for (unsigned int i = 0; i < sizeof(startRows) / sizeof(startRows[0]); ++i)
+         {
+            issearf(setPager(pFullElement.get(), filename, false));
+            issearf(verifyWindow(pFullElement.get(), reference, startRows[i], lastRow, 0, lastColumn));
+            issearf(verifyWindow(pFullElement.get(), reference, 0, startRows[i], 0, lastColumn));
+            issearf(verifyWindow(pFullElement.get(), reference, 0, lastRow, 0, lastColumn));
+         }
+
+         // Windows which cross tile rows and columns, starting with an empty cache and then with cached tiles
+         const unsigned int tile = JPEG2000_PAGER_TILE_SIZE;
+         issearf(setPager(pFullElement.get(), filename, false));
+         issearf(verifyWindow(pFullElement.get(), reference, tile - 3, tile + 3, tile - 5, 2 * tile + 5));
+         issearf(verifyWindow(pFullElement.get(), reference, 2 * tile - 1, 3 * tile, 1, lastColumn - 1));
+         issearf(verifyWindow(pFullElement.get(), reference, tile / 2, lastRow, tile + 1, tile + 1));
+         issearf(verifyWindow(pFullElement.get(), reference, tile - 3, tile + 3, tile - 5, 2 * tile + 5));
+
+         // By default, importing every other row and column samples the full resolution
+         ModelResource<RasterElement> pSubsetElement(importImage(filename, 1));
+         issearf(pSubsetElement.get() != NULL);
+         const unsigned int lastSubsetRow = JPEG2000_PAGER_ROWS / 2 - 1;
+         const unsigned int lastSubsetColumn = JPEG2000_PAGER_COLUMNS / 2 - 1;
+         issearf(verifyWindow(pSubsetElement.get(), reference, 0, lastSubsetRow, 0, lastSubsetColumn));
+         issearf(setPager(pSubsetElement.get(), filename, false));
+         issearf(verifyWindow(pSubsetElement.get(), reference, tile / 2 - 2, tile / 2 + 2, tile / 2 - 3,
+            tile + 3));
+         issearf(verifyWindow(pSubsetElement.get(), reference, tile + 1, lastSubsetRow, 0, lastSubsetColumn));
+
+         // Only a pager explicitly told to use the reduced levels maps the subset onto the first reduced level
+         issearf(setPager(pSubsetElement.get(), filename, true));
+         issearf(verifyWindow(pSubsetElement.get(), reference, tile / 2 + 1, lastSubsetRow, 0, lastSubsetColumn,
+            checkerboard));
+         issearf(verifyWindow(pSubsetElement.get(), reference, 0, lastSubsetRow, 0, lastSubsetColumn, checkerboard));
+      }
+
+      return success;
+   }
+
+private:
+   bool exportTiledImage(const std::string& filename, bool checkerboard)
+   {
+      ModelResource<RasterElement> pElement(RasterUtilities::createRasterElement("Jpeg2000PagerTestCase",
+         JPEG2000_PAGER_ROWS, JPEG2000_PAGER_COLUMNS, INT2UBYTES));
+      if (pElement.get() == NULL)
+      {
+         return false;
+      }
+
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setWritable(true);
+      DataAccessor da = pElement->getDataAccessor(pRequest.release());
+      for (unsigned int row = 0; row < JPEG2000_PAGER_ROWS; ++row)
+      {
+         if (!da.isValid())
+         {
+            return false;
+         }
+
+         unsigned short* pData = reinterpret_cast<unsigned short*>(da->getRow());
+         for (unsigned int column = 0; column < JPEG2000_PAGER_COLUMNS; ++column)
+         {
+            pData[column] = jpeg2000PagerValue(row, column, checkerboard);
+         }
+
+         da->nextRow();
+      }
+
+      FactoryResource<FileDescriptor> pFileDescriptor(
+         RasterUtilities::generateFileDescriptorForExport(pElement->getDataDescriptor(), filename));
+      ExporterResource pExporter("JPEG2000 Exporter", pElement.get(), pFileDescriptor.get(), NULL, false);
+      if (pExporter.get() == NULL)
+      {
+         return false;
+      }
+
+      unsigned int tileSize = JPEG2000_PAGER_TILE_SIZE;
+      unsigned int resolutionLevels = 3;
+      return pExporter->getInArgList().setPlugInArgValue("Tile Size", &tileSize) &&
+         pExporter->getInArgList().setPlugInArgValue("Resolution Levels", &resolutionLevels) &&
+         pExporter->execute();
+   }
+
+   RasterElement* importImage(const std::string& filename, unsigned int skipFactor)
+   {
+      ImporterResource pImporter("JPEG2000 Importer", filename, NULL, false);
+      std::vector<ImportDescriptor*> importDescriptors = pImporter->getImportDescriptors();
+      if (importDescriptors.size() != 1 || importDescriptors.front() == NULL)
+      {
+         return NULL;
+      }
+
+      RasterDataDescriptor* pDescriptor =
+         dynamic_cast<RasterDataDescriptor*>(importDescriptors.front()->getDataDescriptor());
+      if (pDescriptor == NULL)
+      {
+         return NULL;
+      }
+
+      pDescriptor->setProcessingLocation(ON_DISK_READ_ONLY);
+      const std::vector<DimensionDescriptor>& rows = pDescriptor->getRows();
+      const std::vector<DimensionDescriptor>& columns = pDescriptor->getColumns();
+      pDescriptor->setRows(RasterUtilities::subsetDimensionVector(rows, rows.front(), rows.back(), skipFactor));
+      pDescriptor->setColumns(RasterUtilities::subsetDimensionVector(columns, columns.front(), columns.back(),
+         skipFactor));
+      if (pImporter->execute() == false)
+      {
+         return NULL;
+      }
+
+      std::vector<DataElement*> importedElements = pImporter->getImportedElements();
+      if (importedElements.size() != 1)
+      {
+         return NULL;
+      }
+
+      return dynamic_cast<RasterElement*>(importedElements.front());
+   }
+
+   // Replaces the pager so that no pages are cached and the header is read again
+   bool setPager(RasterElement* pElement, const std::string& filename, bool reducedResolution)
+   {
+      FactoryResource<Filename> pFilename;
+      pFilename->setFullPathAndName(filename);
+
+      ExecutableResource pPagerPlugIn("JPEG2000 Pager", std::string(), NULL);
+      if (pPagerPlugIn->getPlugIn() == NULL ||
+         pPagerPlugIn->getInArgList().setPlugInArgValue(CachedPager::PagedElementArg(), pElement) == false ||
+         pPagerPlugIn->getInArgList().setPlugInArgValue(CachedPager::PagedFilenameArg(), pFilename.get()) == false ||
+         pPagerPlugIn->getInArgList().setPlugInArgValue("Use Reduced Resolutions", &reducedResolution) == false ||
+         pPagerPlugIn->execute() == false)
+      {
+         return false;
+      }
+
+      RasterPager* pPager = dynamic_cast<RasterPager*>(pPagerPlugIn->getPlugIn());
+      if (pPager == NULL || pElement->setPager(pPager) == false)
+      {
+         return false;
+      }
+
+      pPagerPlugIn->releasePlugIn();
+      return true;
+   }
+
+   // Compares a window of active rows and columns with the full resolution reference, or with the filtered
+   // checkerboard value when the window is read from the first reduced level of a checkerboard
+   bool verifyWindow(RasterElement* pElement, const std::vector<unsigned short>& reference, unsigned int startRow,
+      unsigned int stopRow, unsigned int startColumn, unsigned int stopColumn, bool filteredCheckerboard = false)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      if (pDescriptor == NULL)
+      {
+         return false;
+      }
+
+      const std::vector<DimensionDescriptor>& rows = pDescriptor->getRows();
+      const std::vector<DimensionDescriptor>& columns = pDescriptor->getColumns();
+      FactoryResource<DataRequest> pRequest;
+      if (stopRow >= rows.size() || stopColumn >= columns.size())
+      {
+         return false;
+      }
+
+      pRequest->setRows(rows[startRow], rows[stopRow], 1);
+      pRequest->setColumns(columns[startColumn], columns[stopColumn]);
+      DataAccessor da = pElement->getDataAccessor(pRequest.release());
+      for (unsigned int row = startRow; row <= stopRow; ++row)
+      {
+         if (!da.isValid())
+         {
+            return false;
+         }
+
+         const unsigned short* pData = reinterpret_cast<const unsigned short*>(da->getRow());
+         const unsigned short* pReference = &reference[rows[row].getOnDiskNumber() * JPEG2000_PAGER_COLUMNS];
+         for (unsigned int column = startColumn; column <= stopColumn; ++column)
+         {
+            unsigned short expected = pReference[columns[column].getOnDiskNumber()];
+            if (filteredCheckerboard)
+            {
+               expected = 100;
+            }
+
+            if (pData[column - startColumn] != expected)
+            {
+               return false;
+            }
+         }
+
+         da->nextRow();
+      }
+
+      return true;
+   }
+};
+
 class PicturesTestSuite : public TestSuiteNewSession
 {
 public:
@@ -482,6 +785,7 @@ public:
       addTestCase(new PngExporterTestCase);
       addTestCase(new Jpeg2000ExportTestCase);
       addTestCase(new Jpeg2000ImportTestCase);
+      addTestCase(new Jpeg2000PagerTestCase);
       addTestCase(new Jpeg2000TestCase);
    }
 };
@@ -0,0 +1,204 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "assert.h"
+#include "PointCloudOctree.h"
+#include "TestCase.h"
+#include "TestSuiteNewSession.h"
+
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   const uint32_t NODE_POINTS = 100;
+
+   // A root cube of size 100 with eight leaf children.  Child i is in the upper half of x if bit 0
+   // is set, of y if bit 1 is set and of z if bit 2 is set.
+   vector<PointCloudOctree::Node> createNodes()
+   {
+      vector<PointCloudOctree::Node> nodes(9);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+         nodes[0].mMin[axis] = 0.0f;
+         nodes[0].mMax[axis] = 100.0f;
+      }
+
+      nodes[0].mSpacing = 10.0f;
+      nodes[0].mPointCount = NODE_POINTS;
+      for (int child = 0; child < 8; ++child)
+      {
+         PointCloudOctree::Node& node = nodes[child + 1];
+         for (int axis = 0; axis < 3; ++axis)
+         {
+            node.mMin[axis] = ((child >> axis) & 1) ? 50.0f : 0.0f;
+            node.mMax[axis] = node.mMin[axis] + 50.0f;
+         }
+
+         node.mSpacing = 5.0f;
+         node.mPointCount = NODE_POINTS;
+         nodes[0].mChildren[child] = child + 1;
+      }
+
+      return nodes;
+   }
+
+   // An orthographic view of x in [0, 40] and y in [0, 100], where one unit of y is one pixel
+   PointCloudOctree::ViewParameters createOrthographicView()
+   {
+      PointCloudOctree::ViewParameters view;
+      view.mProjectionMatrix[0] = 2.0 / 40.0;
+      view.mProjectionMatrix[5] = 2.0 / 100.0;
+      view.mProjectionMatrix[10] = -2.0 / 400.0;
+      view.mProjectionMatrix[12] = -1.0;
+      view.mProjectionMatrix[13] = -1.0;
+      view.mViewport[2] = 100;
+      view.mViewport[3] = 100;
+      return view;
+   }
+
+   // A 90 degree perspective view looking down the z axis at the center of the root from 50 units above it
+   PointCloudOctree::ViewParameters createPerspectiveView()
+   {
+      const double nearPlane = 1.0;
+      const double farPlane = 1000.0;
+      PointCloudOctree::ViewParameters view;
+      view.mModelMatrix[12] = -50.0;
+      view.mModelMatrix[13] = -50.0;
+      view.mModelMatrix[14] = -150.0;
+      view.mProjectionMatrix[10] = (farPlane + nearPlane) / (nearPlane - farPlane);
+      view.mProjectionMatrix[11] = -1.0;
+      view.mProjectionMatrix[14] = 2.0 * farPlane * nearPlane / (nearPlane - farPlane);
+      view.mProjectionMatrix[15] = 0.0;
+      view.mViewport[2] = 100;
+      view.mViewport[3] = 100;
+      return view;
+   }
+}
+
+class PointCloudOctreeCullingTestCase : public TestCase
+{
+public:
+   PointCloudOctreeCullingTestCase() : TestCase("Culling") {}
+   bool run()
+   {
+      bool success = true;
+      vector<PointCloudOctree::Node> nodes = createNodes();
+      vector<unsigned int> selected;
+
+      // Only the children in the lower half of x are in view
+      PointCloudOctree::selectNodes(nodes, createOrthographicView(), 1000000, 1.0, selected);
+      issearf(selected.size() == 5);
+      issearf(selected[0] == 0);
+      for (unsigned int i = 1; i < selected.size(); ++i)
+      {
+         issearf(((selected[i] - 1) & 1) == 0);
+      }
+
+      // Nothing is selected when the root is out of view
+      PointCloudOctree::ViewParameters view = createOrthographicView();
+      view.mModelMatrix[12] = 500.0;
+      PointCloudOctree::selectNodes(nodes, view, 1000000, 1.0, selected);
+      issearf(selected.empty());
+
+      // Exaggerating z moves the children in the upper half of z out of view
+      view = createOrthographicView();
+      view.mScale[2] = 5.0;
+      PointCloudOctree::selectNodes(nodes, view, 1000000, 1.0, selected);
+      issearf(selected.size() == 3);
+      for (unsigned int i = 1; i < selected.size(); ++i)
+      {
+         issearf(((selected[i] - 1) & 5) == 0);
+      }
+
+      return success;
+   }
+};
+
+class PointCloudOctreeBudgetTestCase : public TestCase
+{
+public:
+   PointCloudOctreeBudgetTestCase() : TestCase("Budget") {}
+   bool run()
+   {
+      bool success = true;
+      vector<PointCloudOctree::Node> nodes = createNodes();
+      vector<unsigned int> selected;
+
+      PointCloudOctree::selectNodes(nodes, createOrthographicView(), NODE_POINTS * 5 / 2, 1.0, selected);
+      issearf(selected.size() == 2);
+      issearf(selected[0] == 0);
+
+      // The root alone exceeds the budget
+      PointCloudOctree::selectNodes(nodes, createOrthographicView(), NODE_POINTS - 1, 1.0, selected);
+      issearf(selected.empty());
+
+      // The nearest children are refined first
+      PointCloudOctree::selectNodes(nodes, createPerspectiveView(), NODE_POINTS * 5, 1.0, selected);
+      issearf(selected.size() == 5);
+      issearf(selected[0] == 0);
+      for (unsigned int i = 1; i < selected.size(); ++i)
+      {
+         issearf(((selected[i] - 1) & 4) != 0);
+      }
+
+      return success;
+   }
+};
+
+class PointCloudOctreeRefinementTestCase : public TestCase
+{
+public:
+   PointCloudOctreeRefinementTestCase() : TestCase("Refinement") {}
+   bool run()
+   {
+      bool success = true;
+      vector<PointCloudOctree::Node> nodes = createNodes();
+      vector<unsigned int> selected;
+
+      // The root's points are 10 pixels apart, so it is not refined for points which are 20 pixels wide
+      PointCloudOctree::selectNodes(nodes, createOrthographicView(), 1000000, 20.0, selected);
+      issearf(selected.size() == 1);
+      issearf(selected[0] == 0);
+
+      // Zooming in by a factor of 4 spreads the root's points 40 pixels apart and leaves
+      // only the children in the lower half of x and y in view
+      PointCloudOctree::ViewParameters view = createOrthographicView();
+      view.mModelMatrix[0] = 4.0;
+      view.mModelMatrix[5] = 4.0;
+      PointCloudOctree::selectNodes(nodes, view, 1000000, 20.0, selected);
+      issearf(selected.size() == 3);
+      for (unsigned int i = 1; i < selected.size(); ++i)
+      {
+         issearf(((selected[i] - 1) & 3) == 0);
+      }
+
+      // In a perspective view, the spacing depends on the distance to the nearest point of the root
+      PointCloudOctree::selectNodes(nodes, createPerspectiveView(), 1000000, 30.0, selected);
+      issearf(selected.size() == 9);
+      PointCloudOctree::selectNodes(nodes, createPerspectiveView(), 1000000, 40.0, selected);
+      issearf(selected.size() == 1);
+
+      return success;
+   }
+};
+
+class PointCloudOctreeTestSuite : public TestSuiteNewSession
+{
+public:
+   PointCloudOctreeTestSuite() : TestSuiteNewSession("PointCloudOctree")
+   {
+      addTestCase(new PointCloudOctreeCullingTestCase);
+      addTestCase(new PointCloudOctreeBudgetTestCase);
+      addTestCase(new PointCloudOctreeRefinementTestCase);
+   }
+};
+
+REGISTER_SUITE(PointCloudOctreeTestSuite)
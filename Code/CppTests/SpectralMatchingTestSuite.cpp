@@ -0,0 +1,301 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "assert.h"
+#include "BitMask.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterUtilities.h"
+#include "SpectralMatcher.h"
+#include "Statistics.h"
+#include "TestCase.h"
+#include "TestSuiteNewSession.h"
+
+#include <math.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   const unsigned int NUM_ROWS = 40;
+   const unsigned int NUM_COLUMNS = 300;
+   const unsigned int NUM_BANDS = 12;
+   const unsigned int NUM_SIGNATURES = 3;
+   const double BAD_VALUE = -1.0;
+
+   double signatureValue(unsigned int signature, unsigned int band)
+   {
+      switch (signature)
+      {
+      case 0:
+         return 1.0 + band;                         // increasing
+      case 1:
+         return 1.0 + (NUM_BANDS - band);           // decreasing
+      default:
+         return 2.0 + ((band % 2 == 0) ? 3.0 : 0.0); // alternating
+      }
+   }
+
+   unsigned int expectedClass(unsigned int row, unsigned int column)
+   {
+      return (row + column) % NUM_SIGNATURES;
+   }
+
+   // A scaled copy of one signature with a little deterministic noise, so the background covariance is invertible
+   double pixelValue(unsigned int row, unsigned int column, unsigned int band)
+   {
+      double scale = 1.0 + 0.05 * (row % 7);
+      double noise = 0.01 * static_cast<double>((row * 31 + column * 17 + band * 7) % 11) - 0.05;
+      return scale * signatureValue(expectedClass(row, column), band) + noise;
+   }
+
+   vector<double> getSignatures()
+   {
+      vector<double> signatures;
+      for (unsigned int signature = 0; signature < NUM_SIGNATURES; ++signature)
+      {
+         for (unsigned int band = 0; band < NUM_BANDS; ++band)
+         {
+            signatures.push_back(signatureValue(signature, band));
+         }
+      }
+
+      return signatures;
+   }
+
+   // The data is stored BSQ so matching exercises the interleave conversion to BIP
+   RasterElement* createTestElement(const string& name)
+   {
+      RasterElement* pRaster = RasterUtilities::createRasterElement(name, NUM_ROWS, NUM_COLUMNS, NUM_BANDS,
+         FLT4BYTES, BSQ, true, NULL);
+      if (pRaster == NULL)
+      {
+         return NULL;
+      }
+
+      RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      for (unsigned int band = 0; band < NUM_BANDS; ++band)
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(BSQ);
+         pRequest->setBands(pDescriptor->getActiveBand(band), pDescriptor->getActiveBand(band));
+         pRequest->setWritable(true);
+         DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+         for (unsigned int row = 0; row < NUM_ROWS; ++row)
+         {
+            if (!da.isValid())
+            {
+               return pRaster;
+            }
+
+            float* pData = reinterpret_cast<float*>(da->getRow());
+            for (unsigned int column = 0; column < NUM_COLUMNS; ++column)
+            {
+               pData[column] = static_cast<float>(pixelValue(row, column, band));
+            }
+            da->nextRow();
+         }
+      }
+
+      return pRaster;
+   }
+
+   RasterElement* createScoreElement(const string& name)
+   {
+      return RasterUtilities::createRasterElement(name, NUM_ROWS, NUM_COLUMNS, NUM_SIGNATURES, FLT4BYTES, BIP,
+         true, NULL);
+   }
+
+   RasterElement* createClassElement(const string& name)
+   {
+      return RasterUtilities::createRasterElement(name, NUM_ROWS, NUM_COLUMNS, 1, INT2UBYTES, BIP, true, NULL);
+   }
+
+   bool getClass(RasterElement* pClasses, unsigned int row, unsigned int column, unsigned short& value)
+   {
+      DataAccessor da = pClasses->getDataAccessor();
+      da->toPixel(row, column);
+      if (!da.isValid())
+      {
+         return false;
+      }
+
+      value = *reinterpret_cast<unsigned short*>(da->getColumn());
+      return true;
+   }
+
+   bool getScore(RasterElement* pScores, unsigned int row, unsigned int column, unsigned int signature,
+      float& value)
+   {
+      DataAccessor da = pScores->getDataAccessor();
+      da->toPixel(row, column);
+      if (!da.isValid())
+      {
+         return false;
+      }
+
+      value = reinterpret_cast<float*>(da->getColumn())[signature];
+      return true;
+   }
+}
+
+class SpectralMatchingClassTestCase : public TestCase
+{
+public:
+   SpectralMatchingClassTestCase() : TestCase("Classes") {}
+   bool run()
+   {
+      bool success = true;
+      ModelResource<RasterElement> pRaster(createTestElement("SpectralMatchingClassTest"));
+      issearf(pRaster.get() != NULL);
+
+      // SAM and correlation are insensitive to the scale of the pixels, so every pixel matches its signature
+      issearf(testClasses(pRaster.get(), SpectralMatcher::SAM));
+      issearf(testClasses(pRaster.get(), SpectralMatcher::CORRELATION));
+
+      // The detectors need background statistics; check that they run and produce a score for every pixel
+      issearf(testScores(pRaster.get(), SpectralMatcher::CEM));
+      issearf(testScores(pRaster.get(), SpectralMatcher::MATCHED_FILTER));
+      issearf(testScores(pRaster.get(), SpectralMatcher::ACE));
+      return success;
+   }
+
+private:
+   bool testClasses(RasterElement* pRaster, SpectralMatcher::Method method)
+   {
+      bool success = true;
+      ModelResource<RasterElement> pScores(createScoreElement("SpectralMatchingClassTestScores"));
+      ModelResource<RasterElement> pClasses(createClassElement("SpectralMatchingClassTestClasses"));
+      issearf(pScores.get() != NULL && pClasses.get() != NULL);
+
+      SpectralMatcher matcher(method, getSignatures(), NUM_SIGNATURES);
+      issearf(matcher.match(pRaster, pScores.get(), pClasses.get()));
+      issearf(matcher.getErrorMessage().empty());
+
+      for (unsigned int row = 0; row < NUM_ROWS; ++row)
+      {
+         for (unsigned int column = 0; column < NUM_COLUMNS; ++column)
+         {
+            unsigned short value = 0;
+            issearf(getClass(pClasses.get(), row, column, value));
+            issearf(value == expectedClass(row, column) + 1);
+         }
+      }
+
+      // A pixel which matches its signature has an angle near 0 or a correlation near 1
+      float score = 0.0f;
+      issearf(getScore(pScores.get(), 5, 7, expectedClass(5, 7), score));
+      issearf(method == SpectralMatcher::SAM ? score < 0.05f : score > 0.95f);
+      return success;
+   }
+
+   bool testScores(RasterElement* pRaster, SpectralMatcher::Method method)
+   {
+      bool success = true;
+      ModelResource<RasterElement> pScores(createScoreElement("SpectralMatchingScoreTestScores"));
+      issearf(pScores.get() != NULL);
+
+      SpectralMatcher matcher(method, getSignatures(), NUM_SIGNATURES);
+      issearf(matcher.match(pRaster, pScores.get(), NULL));
+
+      for (unsigned int row = 0; row < NUM_ROWS; row += 3)
+      {
+         for (unsigned int column = 0; column < NUM_COLUMNS; column += 7)
+         {
+            for (unsigned int signature = 0; signature < NUM_SIGNATURES; ++signature)
+            {
+               float score = 0.0f;
+               issearf(getScore(pScores.get(), row, column, signature, score));
+               issearf(score != SpectralMatcher::NO_DATA_SCORE);
+               if (method == SpectralMatcher::ACE)
+               {
+                  issearf(score >= 0.0f && score <= 1.0001f);
+               }
+            }
+         }
+      }
+
+      return success;
+   }
+};
+
+class SpectralMatchingExclusionTestCase : public TestCase
+{
+public:
+   SpectralMatchingExclusionTestCase() : TestCase("Exclusions") {}
+   bool run()
+   {
+      bool success = true;
+      ModelResource<RasterElement> pRaster(createTestElement("SpectralMatchingExclusionTest"));
+      issearf(pRaster.get() != NULL);
+      RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      issearf(pDescriptor != NULL);
+
+      // Mark one pixel bad in the last band
+      const unsigned int badRow = 3;
+      const unsigned int badColumn = 200;
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setWritable(true);
+         DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+         da->toPixel(badRow, badColumn);
+         issearf(da.isValid());
+         float* pPixel = reinterpret_cast<float*>(da->getColumn());
+         pPixel[0] = static_cast<float>(BAD_VALUE);
+      }
+      Statistics* pStatistics = pRaster->getStatistics(pDescriptor->getActiveBand(NUM_BANDS - 1));
+      issearf(pStatistics != NULL);
+      issearf(pStatistics->setBadValues(vector<int>(1, static_cast<int>(BAD_VALUE))));
+
+      // Only match the first half of the columns and the bad pixel
+      FactoryResource<BitMask> pAoi;
+      pAoi->setRegion(0, 0, NUM_COLUMNS / 2 - 1, NUM_ROWS - 1, DRAW);
+      pAoi->setPixel(badColumn, badRow, true);
+
+      ModelResource<RasterElement> pScores(createScoreElement("SpectralMatchingExclusionTestScores"));
+      ModelResource<RasterElement> pClasses(createClassElement("SpectralMatchingExclusionTestClasses"));
+      issearf(pScores.get() != NULL && pClasses.get() != NULL);
+
+      SpectralMatcher matcher(SpectralMatcher::SAM, getSignatures(), NUM_SIGNATURES);
+      matcher.setAoi(pAoi.get());
+      issearf(matcher.match(pRaster.get(), pScores.get(), pClasses.get()));
+
+      unsigned short value = 0;
+      float score = 0.0f;
+      issearf(getClass(pClasses.get(), 10, 10, value) && value == expectedClass(10, 10) + 1);
+      issearf(getClass(pClasses.get(), 10, NUM_COLUMNS - 1, value) && value == 0);
+      issearf(getScore(pScores.get(), 10, NUM_COLUMNS - 1, 0, score) && score == SpectralMatcher::NO_DATA_SCORE);
+      issearf(getClass(pClasses.get(), badRow, badColumn, value) && value == 0);
+      issearf(getScore(pScores.get(), badRow, badColumn, 0, score) && score == SpectralMatcher::NO_DATA_SCORE);
+
+      // A threshold no pixel can reach leaves every pixel unclassified
+      matcher.setClassThreshold(-1.0);
+      issearf(matcher.match(pRaster.get(), NULL, pClasses.get()));
+      issearf(getClass(pClasses.get(), 10, 10, value) && value == 0);
+      return success;
+   }
+};
+
+class SpectralMatchingTestSuite : public TestSuiteNewSession
+{
+public:
+   SpectralMatchingTestSuite() : TestSuiteNewSession("SpectralMatching")
+   {
+      addTestCase(new SpectralMatchingClassTestCase);
+      addTestCase(new SpectralMatchingExclusionTestCase);
+   }
+};
+
+REGISTER_SUITE(SpectralMatchingTestSuite)
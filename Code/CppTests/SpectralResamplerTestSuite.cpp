@@ -0,0 +1,215 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "assert.h"
+#include "SpectralResampler.h"
+#include "TestCase.h"
+#include "TestSuiteNewSession.h"
+
+#include <math.h>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+   // Source wavelengths which are unevenly spaced and not sorted
+   vector<double> getSourceWavelengths()
+   {
+      vector<double> wavelengths;
+      for (int i = 49; i >= 0; --i)
+      {
+         wavelengths.push_back(0.4 + 0.01 * i + 0.002 * (i % 3));
+      }
+
+      return wavelengths;
+   }
+
+   vector<double> getTargetWavelengths()
+   {
+      vector<double> wavelengths;
+      for (int i = 0; i < 20; ++i)
+      {
+         wavelengths.push_back(0.45 + 0.017 * i);
+      }
+
+      return wavelengths;
+   }
+
+   double spectrumValue(unsigned int spectrum, double wavelength)
+   {
+      return sin(wavelength * (3 + spectrum % 5)) + spectrum;
+   }
+
+   // Resamples enough spectra to use multiple threads and returns the largest error
+   double getResampleError(SpectralResampler::Method method)
+   {
+      const unsigned int count = 3000;
+      vector<double> from = getSourceWavelengths();
+      vector<double> to = getTargetWavelengths();
+
+      SpectralResampler resampler;
+      if (resampler.initialize(method, from, to) == false || resampler.getFromCount() != from.size() ||
+         resampler.getToCount() != to.size())
+      {
+         return -1.0;
+      }
+
+      vector<double> fromData;
+      for (unsigned int spectrum = 0; spectrum < count; ++spectrum)
+      {
+         for (unsigned int i = 0; i < from.size(); ++i)
+         {
+            fromData.push_back(spectrumValue(spectrum, from[i]));
+         }
+      }
+
+      vector<double> toData(count * to.size());
+      if (resampler.resample(&fromData[0], &toData[0], count) == false)
+      {
+         return -1.0;
+      }
+
+      double maxError = 0.0;
+      for (unsigned int spectrum = 0; spectrum < count; ++spectrum)
+      {
+         for (unsigned int i = 0; i < to.size(); ++i)
+         {
+            maxError = max(maxError, fabs(toData[spectrum * to.size() + i] - spectrumValue(spectrum, to[i])));
+         }
+      }
+
+      return maxError;
+   }
+}
+
+class SpectralResamplerMethodTestCase : public TestCase
+{
+public:
+   SpectralResamplerMethodTestCase() : TestCase("Methods") {}
+   bool run()
+   {
+      bool success = true;
+
+      double error = getResampleError(SpectralResampler::LINEAR);
+      issea(error >= 0.0 && error < 1e-3);
+
+      // A spline fits a smooth spectrum much more closely than linear interpolation
+      error = getResampleError(SpectralResampler::CUBIC_SPLINE);
+      issea(error >= 0.0 && error < 1e-5);
+
+      // The band response smooths the spectrum, so it is only close to the spectrum at the band center
+      error = getResampleError(SpectralResampler::GAUSSIAN);
+      issea(error >= 0.0 && error < 1e-2);
+
+      return success;
+   }
+};
+
+class SpectralResamplerExactTestCase : public TestCase
+{
+public:
+   SpectralResamplerExactTestCase() : TestCase("Exact") {}
+   bool run()
+   {
+      bool success = true;
+
+      vector<double> from;
+      from.push_back(1.0);
+      from.push_back(2.0);
+      from.push_back(4.0);
+      from.push_back(5.0);
+      vector<double> fromData;
+      fromData.push_back(10.0);
+      fromData.push_back(20.0);
+      fromData.push_back(40.0);
+      fromData.push_back(50.0);
+
+      // Source wavelengths are reproduced exactly and a line is interpolated exactly
+      vector<double> to;
+      to.push_back(5.0);
+      to.push_back(1.0);
+      to.push_back(3.0);
+      to.push_back(1.5);
+      for (int method = SpectralResampler::LINEAR; method <= SpectralResampler::CUBIC_SPLINE; ++method)
+      {
+         SpectralResampler resampler;
+         issea(resampler.initialize(static_cast<SpectralResampler::MethodEnum>(method), from, to));
+         vector<double> toData(to.size());
+         issea(resampler.resample(&fromData[0], &toData[0]));
+         for (unsigned int i = 0; i < to.size(); ++i)
+         {
+            issea(fabs(toData[i] - 10.0 * to[i]) < 1e-9);
+         }
+      }
+
+      // The band response weights sum to one
+      vector<double> fwhm(to.size(), 2.0);
+      SpectralResampler gaussian;
+      issea(gaussian.initialize(SpectralResampler::GAUSSIAN, from, to, fwhm));
+      vector<double> constant(from.size(), 7.0);
+      vector<double> toData(to.size());
+      issea(gaussian.resample(&constant[0], &toData[0]));
+      for (unsigned int i = 0; i < to.size(); ++i)
+      {
+         issea(fabs(toData[i] - 7.0) < 1e-9);
+      }
+
+      return success;
+   }
+};
+
+class SpectralResamplerErrorTestCase : public TestCase
+{
+public:
+   SpectralResamplerErrorTestCase() : TestCase("Errors") {}
+   bool run()
+   {
+      bool success = true;
+      vector<double> from = getSourceWavelengths();
+      vector<double> to = getTargetWavelengths();
+      double value = 0.0;
+
+      SpectralResampler resampler;
+      issea(resampler.isValid() == false);
+      issea(resampler.resample(&value, &value) == false);
+
+      // Extrapolation is not allowed
+      to.push_back(from.front() + 0.1);
+      issea(resampler.initialize(SpectralResampler::LINEAR, from, to) == false);
+      issea(resampler.isValid() == false);
+      issea(resampler.getErrorMessage().empty() == false);
+
+      // The FWHM must match the wavelengths
+      to.pop_back();
+      issea(resampler.initialize(SpectralResampler::GAUSSIAN, from, to, vector<double>(1, 0.01)) == false);
+
+      // A single source wavelength cannot be interpolated
+      issea(resampler.initialize(SpectralResampler::LINEAR, vector<double>(2, 0.5), vector<double>(1, 0.5)) == false);
+
+      issea(resampler.initialize(SpectralResampler::LINEAR, from, to));
+      issea(resampler.isValid());
+      issea(resampler.getErrorMessage().empty());
+
+      return success;
+   }
+};
+
+class SpectralResamplerTestSuite : public TestSuiteNewSession
+{
+public:
+   SpectralResamplerTestSuite() : TestSuiteNewSession("SpectralResampler")
+   {
+      addTestCase(new SpectralResamplerMethodTestCase);
+      addTestCase(new SpectralResamplerExactTestCase);
+      addTestCase(new SpectralResamplerErrorTestCase);
+   }
+};
+
+REGISTER_SUITE(SpectralResamplerTestSuite)
@@ -0,0 +1,223 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "assert.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "ModelServices.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterUtilities.h"
+#include "SpillingPager.h"
+#include "TestBedTestUtilities.h"
+#include "TestSuiteNewSession.h"
+
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+using namespace std;
+
+namespace
+{
+   // Each band of the BSQ cube is a single 1 MB block, so a 1 MB budget holds one band at a time
+   const unsigned int NUM_ROWS = 1024;
+   const unsigned int NUM_COLUMNS = 512;
+   const unsigned int NUM_BANDS = 3;
+   const unsigned int MEMORY_BUDGET = 1;
+
+   // Restores the memory budget when a test case finishes
+   class MemoryBudgetResource
+   {
+   public:
+      MemoryBudgetResource(unsigned int budget) :
+         mOriginalBudget(SpillingPager::getSettingMemoryBudget())
+      {
+         SpillingPager::setSettingMemoryBudget(budget);
+      }
+
+      ~MemoryBudgetResource()
+      {
+         SpillingPager::setSettingMemoryBudget(mOriginalBudget);
+      }
+
+   private:
+      unsigned int mOriginalBudget;
+   };
+}
+
+class SpillingPagerRoundTripTestCase : public TestCase
+{
+public:
+   SpillingPagerRoundTripTestCase() : TestCase("RoundTrip") {}
+
+   bool run()
+   {
+      bool success = true;
+      MemoryBudgetResource budget(MEMORY_BUDGET);
+      Service<ModelServices> pModel;
+
+      const InterleaveFormatType interleaves[] = { BIP, BIL, BSQ };
+      for (unsigned int i = 0; i < sizeof(interleaves) / sizeof(interleaves[0]); ++i)
+      {
+         ModelResource<RasterElement> pRaster(TestUtilities::createBlockPagedElement("SpillingRoundTrip",
+            IN_MEMORY_SPILLABLE, interleaves[i], NUM_ROWS, NUM_COLUMNS, NUM_BANDS));
+         issearf(pRaster.get() != NULL);
+
+         SpillingPager* pPager = dynamic_cast<SpillingPager*>(pRaster->getPager());
+         issearf(pPager != NULL);
+
+         issearf(TestUtilities::fillBlockPagedElement(pRaster.get()));
+         for (unsigned int band = 0; band < NUM_BANDS; ++band)
+         {
+            issearf(TestUtilities::verifyBlockPagedBand(pRaster.get(), band, 0, NUM_ROWS - 1));
+         }
+
+         // The cube is three times the budget, so most of it must have been written to disk
+         uint64_t rawSize = static_cast<uint64_t>(NUM_ROWS) * NUM_COLUMNS * NUM_BANDS * sizeof(unsigned short);
+         issea(pPager->getSpilledSize() > 0);
+         issea(pPager->getSpilledSize() <= rawSize);
+         issea(pPager->getResidentSize() <= pModel->getSpillableMemoryBudget());
+         issea(pModel->getSpillableResidentSize() <= pModel->getSpillableMemoryBudget());
+      }
+
+      issea(pModel->getSpillableResidentSize() == 0);
+      return success;
+   }
+};
+
+class SpillingPagerWithinBudgetTestCase : public TestCase
+{
+public:
+   SpillingPagerWithinBudgetTestCase() : TestCase("WithinBudget") {}
+
+   bool run()
+   {
+      bool success = true;
+      MemoryBudgetResource budget(NUM_BANDS * 2);
+
+      ModelResource<RasterElement> pRaster(TestUtilities::createBlockPagedElement("SpillingWithinBudget",
+         IN_MEMORY_SPILLABLE, BSQ, NUM_ROWS, NUM_COLUMNS, NUM_BANDS));
+      issearf(pRaster.get() != NULL);
+
+      SpillingPager* pPager = dynamic_cast<SpillingPager*>(pRaster->getPager());
+      issearf(pPager != NULL);
+
+      // Blocks which have never been written read as zero
+      RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pRaster->getDataDescriptor());
+      issearf(pDescriptor != NULL);
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(BSQ);
+         pRequest->setRows(pDescriptor->getActiveRow(NUM_ROWS - 1), pDescriptor->getActiveRow(NUM_ROWS - 1));
+         pRequest->setBands(pDescriptor->getActiveBand(0), pDescriptor->getActiveBand(0));
+         DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+         issearf(da.isValid());
+         const unsigned short* pData = reinterpret_cast<const unsigned short*>(da->getRow());
+         for (unsigned int i = 0; i < NUM_COLUMNS; ++i)
+         {
+            issearf(pData[i] == 0);
+         }
+      }
+
+      // A cube which fits in the budget never touches the disk
+      issearf(TestUtilities::fillBlockPagedElement(pRaster.get()));
+      issea(TestUtilities::verifyBlockPagedBand(pRaster.get(), NUM_BANDS - 1, 0, NUM_ROWS - 1));
+      issea(pPager->getSpilledSize() == 0);
+      issea(pPager->getResidentSize() ==
+         static_cast<uint64_t>(NUM_ROWS) * NUM_COLUMNS * NUM_BANDS * sizeof(unsigned short));
+
+      return success;
+   }
+};
+
+class SpillingPagerSharedBudgetTestCase : public TestCase
+{
+public:
+   SpillingPagerSharedBudgetTestCase() : TestCase("SharedBudget") {}
+
+   bool run()
+   {
+      bool success = true;
+      MemoryBudgetResource budget(MEMORY_BUDGET * 2);
+      Service<ModelServices> pModel;
+
+      ModelResource<RasterElement> pFirst(TestUtilities::createBlockPagedElement("SpillingSharedBudget1",
+         IN_MEMORY_SPILLABLE, BSQ, NUM_ROWS, NUM_COLUMNS, NUM_BANDS));
+      ModelResource<RasterElement> pSecond(TestUtilities::createBlockPagedElement("SpillingSharedBudget2",
+         IN_MEMORY_SPILLABLE, BSQ, NUM_ROWS, NUM_COLUMNS, NUM_BANDS));
+      issearf(pFirst.get() != NULL && pSecond.get() != NULL);
+      issearf(TestUtilities::fillBlockPagedElement(pFirst.get()));
+      issearf(TestUtilities::fillBlockPagedElement(pSecond.get()));
+
+      // Filling the second cube must spill the first one, since the budget is shared
+      SpillingPager* pFirstPager = dynamic_cast<SpillingPager*>(pFirst->getPager());
+      SpillingPager* pSecondPager = dynamic_cast<SpillingPager*>(pSecond->getPager());
+      issearf(pFirstPager != NULL && pSecondPager != NULL);
+      issea(pFirstPager->getResidentSize() == 0);
+      issea(pFirstPager->getResidentSize() + pSecondPager->getResidentSize() == pModel->getSpillableResidentSize());
+      issea(pModel->getSpillableResidentSize() <= pModel->getSpillableMemoryBudget());
+
+      srand(7);
+      for (int i = 0; i < 50; ++i)
+      {
+         RasterElement* pRaster = (rand() % 2 == 0) ? pFirst.get() : pSecond.get();
+         unsigned int startRow = rand() % NUM_ROWS;
+         unsigned int stopRow = min(startRow + static_cast<unsigned int>(rand() % 100), NUM_ROWS - 1);
+         issearf(TestUtilities::verifyBlockPagedBand(pRaster, rand() % NUM_BANDS, startRow, stopRow));
+      }
+
+      return success;
+   }
+};
+
+class SpillingPagerConcurrentReadTestCase : public TestCase
+{
+public:
+   SpillingPagerConcurrentReadTestCase() : TestCase("ConcurrentRead") {}
+
+   bool run()
+   {
+      bool success = true;
+      MemoryBudgetResource budget(MEMORY_BUDGET);
+      Service<ModelServices> pModel;
+
+      ModelResource<RasterElement> pRaster(TestUtilities::createBlockPagedElement("SpillingConcurrentRead",
+         IN_MEMORY_SPILLABLE, BSQ, NUM_ROWS, NUM_COLUMNS, NUM_BANDS));
+      issearf(pRaster.get() != NULL);
+      issearf(TestUtilities::fillBlockPagedElement(pRaster.get()));
+
+      // The budget holds a single band, so the readers continually spill and reload each other's blocks
+      issea(TestUtilities::verifyBlockPagedElementConcurrently(pRaster.get(), 4));
+
+      SpillingPager* pPager = dynamic_cast<SpillingPager*>(pRaster->getPager());
+      issearf(pPager != NULL);
+      issea(pPager->getSpilledSize() > 0);
+      issea(pModel->getSpillableResidentSize() <= pModel->getSpillableMemoryBudget());
+
+      return success;
+   }
+};
+
+class SpillingPagerTestSuite : public TestSuiteNewSession
+{
+public:
+   SpillingPagerTestSuite() : TestSuiteNewSession("SpillingPager")
+   {
+      addTestCase(new SpillingPagerRoundTripTestCase);
+      addTestCase(new SpillingPagerWithinBudgetTestCase);
+      addTestCase(new SpillingPagerSharedBudgetTestCase);
+      addTestCase(new SpillingPagerConcurrentReadTestCase);
+   }
+};
+
+REGISTER_SUITE( SpillingPagerTestSuite )
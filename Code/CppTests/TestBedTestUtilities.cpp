@@ -7,13 +7,17 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include "bthread.h"
 #include "ConfigurationSettings.h"
+#include "DataAccessor.h"
 #include "DataAccessorImpl.h"
+#include "DataRequest.h"
 #include "DesktopServices.h"
 #include "Executable.h"
 #include "GcpList.h"
 #include "Georeference.h"
 #include "ModelServices.h"
+#include "ObjectResource.h"
 #include "PlugInArgList.h"
 #include "PlugInResource.h"
 #include "RasterDataDescriptor.h"
@@ -29,10 +33,42 @@
 #include <QtCore/QFile>
 #include <QtCore/QString>
 
+#include <algorithm>
 #include <limits>
 
 using namespace std;
 
+namespace
+{
+   struct BlockPagedReader
+   {
+      RasterElement* mpRaster;
+      unsigned int mNumRows;
+      unsigned int mNumBands;
+      unsigned int mSeed;
+      bool mSuccess;
+   };
+
+   void* blockPagedReaderThread(void* pData)
+   {
+      BlockPagedReader* pReader = reinterpret_cast<BlockPagedReader*>(pData);
+      pReader->mSuccess = true;
+
+      unsigned int seed = pReader->mSeed;
+      for (int i = 0; i < 50 && pReader->mSuccess; ++i)
+      {
+         // Simple linear congruential generator, since rand() is not required to be thread safe
+         seed = seed * 1103515245U + 12345U;
+         unsigned int startRow = (seed >> 8) % pReader->mNumRows;
+         unsigned int stopRow = min(startRow + 40, pReader->mNumRows - 1);
+         unsigned int band = (seed >> 4) % pReader->mNumBands;
+         pReader->mSuccess = TestUtilities::verifyBlockPagedBand(pReader->mpRaster, band, startRow, stopRow);
+      }
+
+      return NULL;
+   }
+}
+
 bool TestUtilities::runGeoRef(RasterElement* pRasterElement, const std::string& pluginName)
 {
    ExecutableResource pExecutable(pluginName);
@@ -377,6 +413,162 @@ bool TestUtilities::destroyWorkspaceWindow(WorkspaceWindow* pWindow)
    return true;
 }
 
+RasterElement* TestUtilities::createBlockPagedElement(const string& name, ProcessingLocation location,
+   InterleaveFormatType interleave, unsigned int numRows, unsigned int numColumns, unsigned int numBands)
+{
+   return RasterUtilities::createRasterElement(name, numRows, numColumns, numBands, INT2UBYTES, location,
+      interleave);
+}
+
+unsigned short TestUtilities::getBlockPagedValue(unsigned int row, unsigned int column, unsigned int band)
+{
+   // Produces a value which compresses reasonably well but is unique enough to detect misplaced data
+   return static_cast<unsigned short>(((row / 4) * 7 + (column / 8) * 3 + band * 1000) % 4096);
+}
+
+bool TestUtilities::fillBlockPagedElement(RasterElement* pRaster)
+{
+   if (pRaster == NULL)
+   {
+      return false;
+   }
+
+   RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   if (pDescriptor == NULL)
+   {
+      return false;
+   }
+
+   // Write in the native interleave, since writable accessors are not converted between interleaves
+   InterleaveFormatType interleave = pDescriptor->getInterleaveFormat();
+   unsigned int numRows = pDescriptor->getRowCount();
+   unsigned int numColumns = pDescriptor->getColumnCount();
+   unsigned int numBands = pDescriptor->getBandCount();
+   unsigned int numPasses = (interleave == BSQ ? numBands : 1);
+   for (unsigned int pass = 0; pass < numPasses; ++pass)
+   {
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(interleave);
+      if (interleave == BSQ)
+      {
+         pRequest->setBands(pDescriptor->getActiveBand(pass), pDescriptor->getActiveBand(pass));
+      }
+      pRequest->setWritable(true);
+      DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+
+      unsigned int startBand = (interleave == BSQ ? pass : 0);
+      unsigned int stopBand = (interleave == BSQ ? pass + 1 : numBands);
+      for (unsigned int row = 0; row < numRows; ++row)
+      {
+         if (!da.isValid())
+         {
+            return false;
+         }
+
+         unsigned short* pData = reinterpret_cast<unsigned short*>(da->getRow());
+         for (unsigned int band = startBand; band < stopBand; ++band)
+         {
+            for (unsigned int column = 0; column < numColumns; ++column)
+            {
+               size_t index = column;
+               if (interleave == BIP)
+               {
+                  index = static_cast<size_t>(column) * numBands + band;
+               }
+               else if (interleave == BIL)
+               {
+                  index = static_cast<size_t>(band) * numColumns + column;
+               }
+
+               pData[index] = getBlockPagedValue(row, column, band);
+            }
+         }
+
+         da->nextRow();
+      }
+   }
+
+   return true;
+}
+
+bool TestUtilities::verifyBlockPagedBand(RasterElement* pRaster, unsigned int band, unsigned int startRow,
+                                         unsigned int stopRow)
+{
+   if (pRaster == NULL)
+   {
+      return false;
+   }
+
+   RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   if (pDescriptor == NULL)
+   {
+      return false;
+   }
+
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setInterleaveFormat(BSQ);
+   pRequest->setRows(pDescriptor->getActiveRow(startRow), pDescriptor->getActiveRow(stopRow));
+   pRequest->setBands(pDescriptor->getActiveBand(band), pDescriptor->getActiveBand(band));
+   DataAccessor da = pRaster->getDataAccessor(pRequest.release());
+   for (unsigned int row = startRow; row <= stopRow; ++row)
+   {
+      if (!da.isValid())
+      {
+         return false;
+      }
+
+      const unsigned short* pData = reinterpret_cast<const unsigned short*>(da->getRow());
+      for (unsigned int column = 0; column < pDescriptor->getColumnCount(); ++column)
+      {
+         if (pData[column] != getBlockPagedValue(row, column, band))
+         {
+            return false;
+         }
+      }
+
+      da->nextRow();
+   }
+
+   return true;
+}
+
+bool TestUtilities::verifyBlockPagedElementConcurrently(RasterElement* pRaster, unsigned int numThreads)
+{
+   if (pRaster == NULL)
+   {
+      return false;
+   }
+
+   RasterDataDescriptor* pDescriptor = dynamic_cast<RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   if (pDescriptor == NULL)
+   {
+      return false;
+   }
+
+   vector<BlockPagedReader> readers(numThreads);
+   vector<BThread*> threads(numThreads);
+   for (unsigned int i = 0; i < numThreads; ++i)
+   {
+      readers[i].mpRaster = pRaster;
+      readers[i].mNumRows = pDescriptor->getRowCount();
+      readers[i].mNumBands = pDescriptor->getBandCount();
+      readers[i].mSeed = i + 1;
+      readers[i].mSuccess = false;
+      threads[i] = new BThread(&readers[i], reinterpret_cast<void*>(blockPagedReaderThread));
+      threads[i]->ThreadLaunch();
+   }
+
+   bool success = true;
+   for (unsigned int i = 0; i < numThreads; ++i)
+   {
+      threads[i]->ThreadWait();
+      delete threads[i];
+      success = success && readers[i].mSuccess;
+   }
+
+   return success;
+}
+
 std::vector<TestSuiteFactory*>& TestUtilities::getFactoryVector()
 {
    static std::vector<TestSuiteFactory*> sFactories;
@@ -10,6 +10,8 @@
 #ifndef TESTBEDTESTUTILITIES_H
 #define TESTBEDTESTUTILITIES_H
 
+#include "TypesFile.h"
+
 #include <string>
 #include <vector>
 
@@ -30,6 +32,14 @@ namespace TestUtilities
       const unsigned int& minNumCubes);
    RasterElement* getStandardRasterElement(bool cleanLoad = false, bool loadFromTempDir = false);
    bool destroyWorkspaceWindow(WorkspaceWindow* pWindow);
+
+   // Unsigned short cubes for the pagers which hold the cube as blocks of rows
+   RasterElement* createBlockPagedElement(const std::string& name, ProcessingLocation location,
+      InterleaveFormatType interleave, unsigned int numRows, unsigned int numColumns, unsigned int numBands);
+   unsigned short getBlockPagedValue(unsigned int row, unsigned int column, unsigned int band);
+   bool fillBlockPagedElement(RasterElement* pRaster);
+   bool verifyBlockPagedBand(RasterElement* pRaster, unsigned int band, unsigned int startRow, unsigned int stopRow);
+   bool verifyBlockPagedElementConcurrently(RasterElement* pRaster, unsigned int numThreads);
    std::vector<TestSuiteFactory*>& getFactoryVector();
 }
 
@@ -18,11 +18,14 @@
 #include "DesktopServices.h"
 #include "Endian.h"
 #include "GcpList.h"
+#include "GraphicLayer.h"
 #include "ModelServicesImp.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ObjectResource.h"
 #include "Observer.h"
 #include "PlugInDescriptor.h"
 #include "PlugInManagerServicesImp.h"
+#include "ProcessQueue.h"
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
 #include "RasterFileDescriptor.h"
@@ -33,6 +36,7 @@
 #include "SignatureFileDescriptor.h"
 #include "SpatialDataView.h"
 #include "SpatialDataWindow.h"
+#include "SignalBatcher.h"
 #include "SignalBlocker.h"
 #include "StringUtilities.h"
 #include "SubjectAdapter.h"
@@ -47,6 +51,10 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
+#include <string.h>
+#include <time.h>
+#include <vector>
 using namespace std;
 
 vector<string> descriptorUpdates;
@@ -79,6 +87,53 @@ public:
    }
 };
 
+class ConfigurationSettingsCacheTest : public TestCase
+{
+public:
+   ConfigurationSettingsCacheTest() : TestCase( "Cache" ) {}
+   bool run()
+   {
+      bool success = true;
+
+      Service<ConfigurationSettings> pSettings;
+      const string key = ConfigurationSettings::getSettingUndoBufferSizeKey();
+      const unsigned int originalValue = ConfigurationSettings::getSettingUndoBufferSize();
+      issea( originalValue == ConfigurationSettings::getSettingUndoBufferSizeUncached() );
+
+      // Changes made through the string API must be seen by the cached getter
+      issea( pSettings->setTemporarySetting( key, originalValue + 5 ) );
+      issea( ConfigurationSettings::getSettingUndoBufferSize() == originalValue + 5 );
+      issea( ConfigurationSettings::getSettingUndoBufferSize() == originalValue + 5 );
+
+      issea( pSettings->setTemporarySetting( key, originalValue + 7 ) );
+      issea( ConfigurationSettings::getSettingUndoBufferSize() == originalValue + 7 );
+
+      // Modifying a different setting must not corrupt the cached value
+      const bool autoZoom = ConfigurationSettings::getSettingAlternateMouseWheelZoom();
+      issea( pSettings->setTemporarySetting( ConfigurationSettings::getSettingAlternateMouseWheelZoomKey(), !autoZoom ) );
+      issea( ConfigurationSettings::getSettingAlternateMouseWheelZoom() == !autoZoom );
+      issea( ConfigurationSettings::getSettingUndoBufferSize() == originalValue + 7 );
+      pSettings->deleteTemporarySetting( ConfigurationSettings::getSettingAlternateMouseWheelZoomKey() );
+      issea( ConfigurationSettings::getSettingAlternateMouseWheelZoom() == autoZoom );
+
+      // Deleting the temporary setting must restore the previous value
+      pSettings->deleteTemporarySetting( key );
+      issea( ConfigurationSettings::getSettingUndoBufferSize() == originalValue );
+      issea( ConfigurationSettings::getSettingUndoBufferSize() ==
+         ConfigurationSettings::getSettingUndoBufferSizeUncached() );
+
+      // Floating point settings use the same lock-free cache as the other scalar settings
+      const double alpha = GraphicLayer::getSettingAlpha();
+      issea( pSettings->setTemporarySetting( GraphicLayer::getSettingAlphaKey(), alpha / 2.0 + 0.25 ) );
+      issea( GraphicLayer::getSettingAlpha() == alpha / 2.0 + 0.25 );
+      issea( GraphicLayer::getSettingAlpha() == GraphicLayer::getSettingAlphaUncached() );
+      pSettings->deleteTemporarySetting( GraphicLayer::getSettingAlphaKey() );
+      issea( GraphicLayer::getSettingAlpha() == alpha );
+
+      return success;
+   }
+};
+
 class PluginCheckTest : public TestCase
 {
 public:
@@ -975,6 +1030,281 @@ private:
    int mNotifiedCount;
 };
 
+class BatchObserver
+{
+public:
+   virtual ~BatchObserver()
+   {}
+
+   void update(Subject& subject, const string& signal, const boost::any& v)
+   {
+      mSignals.push_back(signal);
+      mValues.push_back(v.empty() ? -1 : boost::any_cast<int>(v));
+   }
+
+   vector<string> mSignals;
+   vector<int> mValues;
+};
+
+class SignalBatcherTest : public TestCase
+{
+public:
+   SignalBatcherTest() : TestCase("SignalBatcher") {}
+   bool run()
+   {
+      bool success = true;
+      const string signalA = "CustomSubject::A";
+      const string signalB = "CustomSubject::B";
+
+      //TEST1 - Repeated signals are delivered once per signal in first notification order, then Modified
+      CustomSubject* pSubj = new CustomSubject();
+      BatchObserver observer;
+      issea(pSubj->attach(signalA, Slot(&observer, &BatchObserver::update)));
+      issea(pSubj->attach(signalB, Slot(&observer, &BatchObserver::update)));
+      issea(pSubj->attach(Subject::signalModified(), Slot(&observer, &BatchObserver::update)));
+      issea(pSubj->attach(Subject::signalDeleted(), Slot(&observer, &BatchObserver::update)));
+      {
+         SignalBatcher batcher(*pSubj);
+         {
+            SignalBatcher nestedBatcher(*pSubj);
+            for (int i = 0; i < 1000; ++i)
+            {
+               pSubj->notify(signalB, boost::any(i));
+               pSubj->notify(signalA, boost::any(-i));
+            }
+         }
+         issea(observer.mSignals.empty()); // the outer batch is still active
+      }
+      issea_ext1(observer.mSignals.size(), ==, 3);
+      if (success)
+      {
+         issea(observer.mSignals[0] == signalB && observer.mValues[0] == 999);
+         issea(observer.mSignals[1] == signalA && observer.mValues[1] == -999);
+         issea(observer.mSignals[2] == Subject::signalModified() && observer.mValues[2] == -999);
+      }
+
+      //TEST2 - Modified notified directly is coalesced with the Modified implied by other signals
+      observer.mSignals.clear();
+      observer.mValues.clear();
+      {
+         SignalBatcher batcher(*pSubj);
+         pSubj->notify(Subject::signalModified(), boost::any(1));
+         pSubj->notify(signalA, boost::any(2));
+         pSubj->notify(Subject::signalModified(), boost::any(3));
+      }
+      issea_ext1(observer.mSignals.size(), ==, 2);
+      if (success)
+      {
+         issea(observer.mSignals[0] == signalA && observer.mValues[0] == 2);
+         issea(observer.mSignals[1] == Subject::signalModified() && observer.mValues[1] == 3);
+      }
+
+      //TEST3 - Signals are delivered normally outside of a batch
+      observer.mSignals.clear();
+      observer.mValues.clear();
+      pSubj->notify(signalA, boost::any(4));
+      pSubj->notify(signalA, boost::any(5));
+      issea_ext1(observer.mSignals.size(), ==, 4);
+
+      //TEST4 - Held signals are delivered before Deleted and the SignalBatcher can outlive the Subject
+      observer.mSignals.clear();
+      observer.mValues.clear();
+      SignalBatcher* pBatcher = new SignalBatcher(*pSubj);
+      pSubj->notify(signalB, boost::any(6));
+      issea(observer.mSignals.empty());
+      delete pSubj;
+      delete pBatcher;
+      issea_ext1(observer.mSignals.size(), ==, 3);
+      if (success)
+      {
+         issea(observer.mSignals[0] == signalB && observer.mValues[0] == 6);
+         issea(observer.mSignals[1] == Subject::signalModified());
+         issea(observer.mSignals[2] == Subject::signalDeleted());
+      }
+
+      //TEST5 - Names built at run time dispatch to the same slots as the names returned by SIGNAL_NAME
+      observer.mSignals.clear();
+      observer.mValues.clear();
+      pSubj = new CustomSubject();
+      const string modifiedSignal = string("Subject::") + "Modified";
+      issea(pSubj->attach(modifiedSignal, Slot(&observer, &BatchObserver::update)));
+      issea(pSubj->attach(Subject::signalModified(), Slot(&observer, &BatchObserver::update)) == false);
+      {
+         SignalBatcher batcher(*pSubj);
+         pSubj->notify(string("CustomSubject::") + "C", boost::any(7));
+         pSubj->notify(string("CustomSubject::") + "C", boost::any(8));
+      }
+      pSubj->notify(modifiedSignal, boost::any(9));
+      issea_ext1(observer.mSignals.size(), ==, 2);
+      if (success)
+      {
+         issea(observer.mSignals[0] == Subject::signalModified() && observer.mValues[0] == 8);
+         issea(observer.mSignals[1] == Subject::signalModified() && observer.mValues[1] == 9);
+      }
+      issea(pSubj->detach(Subject::signalModified(), Slot(&observer, &BatchObserver::update)));
+      issea(pSubj->getSlots(modifiedSignal).empty());
+      delete pSubj;
+
+      return success;
+   }
+};
+
+class SchedulingInput
+{
+public:
+   SchedulingInput(int itemCount, int failingItem) :
+      mItemCount(itemCount),
+      mFailingItem(failingItem)
+   {}
+
+   int mItemCount;
+   int mFailingItem;
+};
+
+class SchedulingThread;
+class SchedulingOutput
+{
+public:
+   SchedulingOutput(int itemCount) :
+      mProcessed(itemCount, 0)
+   {}
+
+   bool compileOverallResults(const vector<SchedulingThread*>& threads);
+
+   vector<int> mProcessed;
+};
+
+class SchedulingThread : public mta::AlgorithmThread
+{
+public:
+   SchedulingThread(const SchedulingInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+      AlgorithmThread(threadIndex, reporter),
+      mInput(input),
+      mThreadCount(threadCount)
+   {}
+
+   void run()
+   {
+      while (getNextRange(mThreadCount, mInput.mItemCount, mRange))
+      {
+         int oldPercentDone = -1;
+         for (int item = mRange.mFirst; item <= mRange.mLast; ++item)
+         {
+            if (item == mInput.mFailingItem)
+            {
+               getReporter().reportError("Item failed");
+               return;
+            }
+
+            // the first items are far more expensive than the rest
+            double value = 0.0;
+            int iterations = (item < mInput.mItemCount / 8) ? 200000 : 1000;
+            for (int i = 0; i < iterations; ++i)
+            {
+               value += sqrt(static_cast<double>(i + item));
+            }
+
+            mItems.push_back(item);
+            mValues.push_back(value);
+
+            int percentDone = mRange.computePercent(item);
+            if (percentDone >= oldPercentDone + 25)
+            {
+               oldPercentDone = percentDone;
+               getReporter().reportProgress(getThreadIndex(), percentDone);
+            }
+         }
+      }
+   }
+
+   vector<int> mItems;
+   vector<double> mValues;
+
+private:
+   SchedulingThread& operator=(const SchedulingThread& rhs);
+
+   const SchedulingInput& mInput;
+   int mThreadCount;
+   Range mRange;
+};
+
+bool SchedulingOutput::compileOverallResults(const vector<SchedulingThread*>& threads)
+{
+   for (vector<SchedulingThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+   {
+      for (vector<int>::const_iterator item = (*iter)->mItems.begin(); item != (*iter)->mItems.end(); ++item)
+      {
+         ++mProcessed[*item];
+      }
+   }
+   return true;
+}
+
+class SchedulingProgressReporter : public mta::ProgressReporter
+{
+public:
+   SchedulingProgressReporter() :
+      mLastPercent(0),
+      mDecreased(false),
+      mErrorCount(0)
+   {}
+
+   void reportProgress(int percent)
+   {
+      mDecreased = mDecreased || percent < mLastPercent;
+      mLastPercent = percent;
+   }
+
+   void reportError(const string& text)
+   {
+      ++mErrorCount;
+   }
+
+   int mLastPercent;
+   bool mDecreased;
+   int mErrorCount;
+};
+
+class MultiThreadedAlgorithmSchedulingTest : public TestCase
+{
+public:
+   MultiThreadedAlgorithmSchedulingTest() : TestCase("MultiThreadedAlgorithmScheduling") {}
+   bool run()
+   {
+      bool success = true;
+      const int itemCount = 997;
+      const int threadCount = 4;
+
+      //TEST1 - Both modes process every item exactly once and report progress up to 100
+      for (int pass = 0; pass < 4; ++pass)
+      {
+         mta::Scheduling scheduling = (pass % 2 == 0) ? mta::STATIC_SCHEDULING : mta::DYNAMIC_SCHEDULING;
+         SchedulingInput input(itemCount, -1);
+         SchedulingOutput output(itemCount);
+         SchedulingProgressReporter reporter;
+         mta::MultiThreadedAlgorithm<SchedulingInput, SchedulingOutput, SchedulingThread>
+            algorithm(threadCount, input, output, &reporter, scheduling);
+         issea(algorithm.run() == mta::SUCCESS);
+         issea(count(output.mProcessed.begin(), output.mProcessed.end(), 1) == itemCount);
+         issea(reporter.mLastPercent == 100);
+         issea(reporter.mDecreased == false);
+         issea(reporter.mErrorCount == 0);
+      }
+
+      //TEST2 - An error stops the dynamically scheduled threads from claiming more items
+      SchedulingInput input(itemCount, itemCount / 2);
+      SchedulingOutput output(itemCount);
+      SchedulingProgressReporter reporter;
+      mta::MultiThreadedAlgorithm<SchedulingInput, SchedulingOutput, SchedulingThread>
+         algorithm(threadCount, input, output, &reporter, mta::DYNAMIC_SCHEDULING);
+      issea(algorithm.run() == mta::FAILURE);
+      issea(algorithm.getErrorText() == "Item failed");
+      issea(reporter.mErrorCount == 1);
+
+      return success;
+   }
+};
+
 class DescriptorObserver
 {
 public:
@@ -2555,20 +2885,259 @@ public:
    }
 };
 
+class EndianSwapTest : public TestCase
+{
+public:
+   EndianSwapTest() : TestCase("EndianSwap") {}
+
+   bool run()
+   {
+      bool success = true;
+
+      // The counts leave partial 16, 32 and 64 byte blocks for the vector kernels, and the odd offsets
+      // make the buffers unaligned.  A 3 byte element is only ever swapped by the scalar loop.
+      const size_t dataSizes[] = { 2, 4, 8, 3 };
+      const size_t counts[] = { 0, 1, 3, 7, 8, 9, 15, 16, 17, 31, 33, 63, 64, 65, 127, 1001 };
+      const size_t guardBytes = 16;
+      const unsigned char guard = 0xCD;
+      Endian swapper;
+      Endian native(Endian::getSystemEndian());
+      for (size_t i = 0; i < sizeof(dataSizes) / sizeof(dataSizes[0]); ++i)
+      {
+         const size_t dataSize = dataSizes[i];
+         for (size_t j = 0; j < sizeof(counts) / sizeof(counts[0]); ++j)
+         {
+            const size_t numElements = counts[j];
+            const size_t byteCount = dataSize * numElements;
+            for (size_t offset = 0; offset < 2; ++offset)
+            {
+               vector<unsigned char> source(offset + byteCount + guardBytes);
+               for (size_t k = 0; k < source.size(); ++k)
+               {
+                  source[k] = static_cast<unsigned char>(k * 37 + 11);
+               }
+
+               vector<unsigned char> expected(source.begin() + offset, source.begin() + offset + byteCount);
+               for (size_t k = 0; k < numElements; ++k)
+               {
+                  reverse(expected.begin() + k * dataSize, expected.begin() + (k + 1) * dataSize);
+               }
+
+               // Copying must swap every element and leave the bytes after the buffer alone
+               vector<unsigned char> destination(source.size(), guard);
+               issearf(swapper.copySwapBuffer(&destination[offset], &source[offset], dataSize, numElements));
+               issearf(equal(expected.begin(), expected.end(), destination.begin() + offset));
+               issearf(count(destination.begin() + offset + byteCount, destination.end(), guard) ==
+                  static_cast<ptrdiff_t>(guardBytes));
+
+               // Swapping in place must give the same result through either method
+               vector<unsigned char> inPlace(source);
+               issearf(swapper.swapBuffer(&inPlace[offset], dataSize, numElements));
+               issearf(equal(expected.begin(), expected.end(), inPlace.begin() + offset));
+               issearf(equal(source.begin() + offset + byteCount, source.end(), inPlace.begin() + offset + byteCount));
+               inPlace = source;
+               issearf(swapper.copySwapBuffer(&inPlace[offset], &inPlace[offset], dataSize, numElements));
+               issearf(equal(expected.begin(), expected.end(), inPlace.begin() + offset));
+
+               // The native byte order only copies the data
+               destination.assign(source.size(), guard);
+               issearf(native.copySwapBuffer(&destination[offset], &source[offset], dataSize, numElements) == false);
+               issearf(equal(source.begin() + offset, source.begin() + offset + byteCount,
+                  destination.begin() + offset));
+            }
+         }
+      }
+
+      // Complex values are swapped one component at a time
+      vector<IntegerComplex> integerValues;
+      vector<FloatComplex> floatValues;
+      for (int i = 0; i < 37; ++i)
+      {
+         integerValues.push_back(IntegerComplex(static_cast<short>(i * 1031 - 7), static_cast<short>(i * 517 + 3)));
+         floatValues.push_back(FloatComplex(i * 1.25f - 3.0f, i * -0.75f + 2.0f));
+      }
+
+      vector<IntegerComplex> swappedIntegers(integerValues);
+      issearf(swapper.swapBuffer(&swappedIntegers[0], swappedIntegers.size()));
+      vector<FloatComplex> swappedFloats(floatValues.size());
+      issearf(swapper.copySwapBuffer(&swappedFloats[0], &floatValues[0], sizeof(float), 2 * floatValues.size()));
+      vector<FloatComplex> inPlaceFloats(floatValues);
+      issearf(swapper.swapBuffer(&inPlaceFloats[0], inPlaceFloats.size()));
+      for (size_t i = 0; i < integerValues.size(); ++i)
+      {
+         issearf(swappedIntegers[i].mReal == reverseBytes(integerValues[i].mReal));
+         issearf(swappedIntegers[i].mImaginary == reverseBytes(integerValues[i].mImaginary));
+         issearf(memcmp(&swappedFloats[i].mReal, &inPlaceFloats[i].mReal, sizeof(float)) == 0);
+         issearf(memcmp(&swappedFloats[i].mImaginary, &inPlaceFloats[i].mImaginary, sizeof(float)) == 0);
+
+         float real = floatValues[i].mReal;
+         unsigned char* pBytes = reinterpret_cast<unsigned char*>(&real);
+         reverse(pBytes, pBytes + sizeof(float));
+         issearf(memcmp(&swappedFloats[i].mReal, &real, sizeof(float)) == 0);
+      }
+
+      // Swapping twice restores the data
+      issearf(swapper.swapBuffer(&swappedIntegers[0], swappedIntegers.size()));
+      for (size_t i = 0; i < integerValues.size(); ++i)
+      {
+         issearf(swappedIntegers[i].mReal == integerValues[i].mReal);
+         issearf(swappedIntegers[i].mImaginary == integerValues[i].mImaginary);
+      }
+
+      unsigned short value = 0x1234;
+      issearf(swapper.copySwapBuffer(NULL, &value, sizeof(value), 1) == false);
+      issearf(swapper.copySwapBuffer(&value, NULL, sizeof(value), 1) == false);
+      issearf(swapper.swapValue(value) && value == 0x3412);
+
+      return success;
+   }
+
+private:
+   static short reverseBytes(short value)
+   {
+      unsigned short bits = static_cast<unsigned short>(value);
+      return static_cast<short>((bits >> 8) | (bits << 8));
+   }
+};
+
+class RecordingProcessQueue : public ProcessQueue
+{
+public:
+   RecordingProcessQueue(unsigned int maxRunning, size_t abortAfter = static_cast<size_t>(-1)) :
+      ProcessQueue(maxRunning, numeric_limits<uint64_t>::max()),
+      mAbortAfter(abortAfter)
+   {}
+
+   // Runs a shell command which waits, prints its position in the queue and exits with the given code
+   void addCommand(size_t index, unsigned int seconds, int exitCode)
+   {
+      string number = StringUtilities::toDisplayString(static_cast<unsigned int>(index));
+      string code = StringUtilities::toDisplayString(exitCode);
+      vector<string> arguments;
+#if defined(WIN_API)
+      arguments.push_back("/c");
+      arguments.push_back("ping -n " + StringUtilities::toDisplayString(seconds + 1) + " 127.0.0.1 >NUL && echo run " +
+         number + " && exit " + code);
+      addRun("cmd.exe", arguments);
+#else
+      arguments.push_back("-c");
+      arguments.push_back("sleep " + StringUtilities::toDisplayString(seconds) + " && echo run " + number +
+         " && exit " + code);
+      addRun("/bin/sh", arguments);
+#endif
+   }
+
+   vector<size_t> mReported;
+
+protected:
+   void runFinished(size_t index, const Run& run)
+   {
+      mReported.push_back(index);
+   }
+
+   bool isAborted()
+   {
+      return mReported.size() >= mAbortAfter;
+   }
+
+private:
+   size_t mAbortAfter;
+};
+
+class ProcessQueueTest : public TestCase
+{
+public:
+   ProcessQueueTest() : TestCase("ProcessQueue") {}
+   bool run()
+   {
+      bool success = true;
+
+      //TEST1 - Results are reported in queue order even when later processes finish first
+      {
+         RecordingProcessQueue queue(4);
+         queue.addCommand(0, 3, 0);
+         queue.addCommand(1, 2, 0);
+         queue.addCommand(2, 1, 0);
+         queue.addCommand(3, 0, 0);
+         issea(queue.execute());
+         issea_ext1(queue.mReported.size(), ==, 4);
+         for (size_t i = 0; i < queue.mReported.size(); ++i)
+         {
+            issea(queue.mReported[i] == i);
+
+            const ProcessQueue::Run& run = queue.getRun(i);
+            issea(run.mFinished && run.mSuccess && run.mExitCode == 0);
+            issea(run.mOutput.find("run " + StringUtilities::toDisplayString(static_cast<unsigned int>(i))) !=
+               string::npos);
+         }
+      }
+
+      //TEST2 - No processes are started after a failure, and the failure is reported in order
+      {
+         RecordingProcessQueue queue(1);
+         queue.addCommand(0, 0, 0);
+         queue.addCommand(1, 0, 3);
+         queue.addCommand(2, 0, 0);
+         queue.addCommand(3, 0, 0);
+         issea(queue.execute() == false);
+         issea_ext1(queue.mReported.size(), ==, 2);
+         if (success)
+         {
+            issea(queue.mReported[0] == 0 && queue.mReported[1] == 1);
+            issea(queue.getRun(0).mSuccess);
+            issea(queue.getRun(1).mSuccess == false && queue.getRun(1).mExitCode == 3);
+            issea(queue.getRun(1).mMessage.empty() == false);
+            issea(queue.getRun(2).mFinished == false && queue.getRun(3).mFinished == false);
+         }
+      }
+
+      //TEST3 - Processes which are running when the queue is aborted are killed and not reported
+      {
+         RecordingProcessQueue queue(3, 1);
+         queue.addCommand(0, 0, 0);
+         queue.addCommand(1, 60, 0);
+         queue.addCommand(2, 60, 0);
+         time_t startTime = time(NULL);
+         issea(queue.execute() == false);
+         issea(time(NULL) - startTime < 30);
+         issea_ext1(queue.mReported.size(), ==, 1);
+         issea(queue.getRun(1).mFinished == false && queue.getRun(2).mFinished == false);
+      }
+
+      //TEST4 - A program which cannot be started is a failure
+      {
+         RecordingProcessQueue queue(2);
+         queue.addRun("/this/program/does/not/exist", vector<string>());
+         queue.addCommand(1, 0, 0);
+         issea(queue.execute() == false);
+         issea_ext1(queue.mReported.size(), ==, 1);
+         issea(queue.getRun(0).mSuccess == false && queue.getRun(0).mMessage.empty() == false);
+         issea(queue.getRun(1).mFinished == false);
+      }
+
+      return success;
+   }
+};
+
 class UtilityTestSuite : public TestSuiteNewSession
 {
 public:
    UtilityTestSuite() : TestSuiteNewSession( "Utility" )
    {
       addTestCase( new ConfigurationSettingsLookupTest );
+      addTestCase( new ConfigurationSettingsCacheTest );
       addTestCase( new PluginCheckTest );
       addTestCase( new TimeUtilitiesTestCase );
       addTestCase( new DateTimeTestCase );
       addTestCase( new SubjectObserverTest );
+      addTestCase( new SignalBatcherTest );
+      addTestCase( new MultiThreadedAlgorithmSchedulingTest );
       addTestCase( new SubjectNotifyTest );
       addTestCase( new EnumWrapperTest );
       addTestCase( new StringUtilitiesTest );
       addTestCase( new SafeSlotTest );
+      addTestCase( new EndianSwapTest );
+      addTestCase( new ProcessQueueTest );
    }
 };
 
@@ -75,6 +75,7 @@ AnimationControllerImp::AnimationControllerImp(FrameType frameType, const string
    mCycle(AnimationController::getSettingAnimationCycleSelection()),
    mStartTime(0.0),
    mBumpersEnabled(false),
+   mDroppedFrameCount(0),
    mpPlayAction(NULL),
    mpPauseAction(NULL),
    mpStopAction(NULL),
@@ -530,6 +531,7 @@ void AnimationControllerImp::play()
       ftime(&timeStruct);
       mStartTime = timeStruct.time*1000.0 + timeStruct.millitm;
       mEffectiveCurrentTime = mStartTime;
+      mDroppedFrameCount = 0;
 
       // System clock resolution limits the total frame rate to 60 frames per second.
       // This is ameliorated by allowing the animation to continue to update in
@@ -1046,6 +1048,7 @@ void AnimationControllerImp::advance()
                {
                   double oldFrame = nextFrame;
                   nextFrame = lockToGranularity(nextFrame);
+                  mDroppedFrameCount += getSkippedFrameCount(mCurrentFrame, nextFrame);
                }
             }
             else
@@ -1067,6 +1070,7 @@ void AnimationControllerImp::advance()
          {
             double oldFrame = nextFrame;
             nextFrame = lockToGranularity(nextFrame);
+            mDroppedFrameCount += getSkippedFrameCount(mCurrentFrame, nextFrame);
          }
       }
    }
@@ -1092,6 +1096,7 @@ void AnimationControllerImp::advance()
                {
                   double oldFrame = nextFrame;
                   nextFrame = lockToGranularity(nextFrame);
+                  mDroppedFrameCount += getSkippedFrameCount(mCurrentFrame, nextFrame);
                }
             }
             else
@@ -1113,13 +1118,13 @@ void AnimationControllerImp::advance()
          {
             double oldFrame = nextFrame;
             nextFrame = lockToGranularity(nextFrame);
+            mDroppedFrameCount += getSkippedFrameCount(mCurrentFrame, nextFrame);
          }
       }
    }
 
    // Set the next value as the current value
-   double modNextFrame = getNextValue(nextFrame);
-   setCurrentFrame(modNextFrame);
+   setCurrentFrame(getNextValue(nextFrame));
 }
 
 void AnimationControllerImp::destroyAnimation()
@@ -1154,11 +1159,60 @@ void AnimationControllerImp::setCanDropFrames(bool drop)
    }
 }
 
+unsigned int AnimationControllerImp::getDroppedFrameCount() const
+{
+   return mDroppedFrameCount;
+}
+
 void AnimationControllerImp::canDropFramesToggled(bool drop)
 {
    notify(SIGNAL_NAME(AnimationController, CanDropFramesChanged), boost::any(drop));
 }
 
+unsigned int AnimationControllerImp::getSkippedFrameCount(double fromValue, double toValue) const
+{
+   // The frame displayed for a value is the last frame at or before the value, so the frames which are
+   // skipped are the distinct frames after the lower value up to the higher value, except the one displayed
+   double lowValue = min(fromValue, toValue);
+   double highValue = max(fromValue, toValue);
+
+   unsigned int skippedCount = 0;
+   for (vector<Animation*>::const_iterator iter = mAnimations.begin(); iter != mAnimations.end(); ++iter)
+   {
+      AnimationImp* pAnimation = dynamic_cast<AnimationImp*>(*iter);
+      if (pAnimation == NULL)
+      {
+         continue;
+      }
+
+      unsigned int frameCount = 0;
+      double prevValue = -1.0;
+      const vector<AnimationFrame>& frames = pAnimation->getFrames();
+      for (vector<AnimationFrame>::const_iterator frame = frames.begin(); frame != frames.end(); ++frame)
+      {
+         double value = pAnimation->getFrameValue(&*frame);
+         if (value > highValue)
+         {
+            break;
+         }
+
+         if (value > lowValue && value != prevValue)
+         {
+            ++frameCount;
+         }
+
+         prevValue = value;
+      }
+
+      if (frameCount > 1)
+      {
+         skippedCount = max(skippedCount, frameCount - 1);
+      }
+   }
+
+   return skippedCount;
+}
+
 bool AnimationControllerImp::getCanDropFrames() const
 {
    return mpCanDropFramesAction->isChecked();
@@ -83,6 +83,9 @@ public:
    void setCanDropFrames(bool drop);
    bool getCanDropFrames() const;
 
+   // The number of frames skipped since playback started to keep up with the frame rate
+   unsigned int getDroppedFrameCount() const;
+
    double getNextValue(double value) const;
    virtual bool event(QEvent* pEvent);
 
@@ -137,6 +140,7 @@ private:
    AnimationControllerImp& operator=(const AnimationControllerImp& rhs);
 
    void removeFromRunningControllers();
+   unsigned int getSkippedFrameCount(double fromValue, double toValue) const;
 
    Service<DesktopServices> mpDesktop;
 
@@ -161,6 +165,7 @@ private:
 
    double mStartTime;
    bool mBumpersEnabled;
+   unsigned int mDroppedFrameCount;
 
    QAction* mpPlayAction;
    QAction* mpPauseAction;
@@ -70,6 +70,13 @@ using namespace std;
 
 XERCES_CPP_NAMESPACE_USE
 
+namespace
+{
+   // The minimum margin in screen pixels around the view in which objects are drawn,
+   // so that labels and symbols which extend past an object's bounds are not cut off
+   const double DRAW_MARGIN = 64.0;
+}
+
 GraphicLayerImp::GraphicLayerImp(const string& id, const string& layerName, DataElement* pElement) :
    LayerImp(id, layerName, pElement),
    mpExplorer(Service<SessionExplorer>().get(), SIGNAL_NAME(SessionExplorer, AboutToShowSessionItemContextMenu),
@@ -183,10 +190,76 @@ void GraphicLayerImp::drawGroup()
    GraphicGroupImp* pGroup = dynamic_cast<GraphicGroupImp*>(getGroup());
    if (pGroup != NULL)
    {
-      pGroup->draw(zoomPercent/100);
+      LocationType llCorner;
+      LocationType urCorner;
+      if (getVisibleExtents(llCorner, urCorner) == true)
+      {
+         pGroup->drawRegion(zoomPercent/100, llCorner, urCorner);
+      }
+      else
+      {
+         pGroup->draw(zoomPercent/100);
+      }
    }
 }
 
+bool GraphicLayerImp::getVisibleExtents(LocationType& llCorner, LocationType& urCorner) const
+{
+   GLint viewPort[4];
+   GLdouble modelMatrix[16];
+   GLdouble projectionMatrix[16];
+   glGetIntegerv(GL_VIEWPORT, viewPort);
+   glGetDoublev(GL_MODELVIEW_MATRIX, modelMatrix);
+   glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
+
+   double marginX = max(DRAW_MARGIN, viewPort[2] / 4.0);
+   double marginY = max(DRAW_MARGIN, viewPort[3] / 4.0);
+
+   llCorner = LocationType(1e30, 1e30);
+   urCorner = LocationType(-1e30, -1e30);
+   for (int i = 0; i < 4; ++i)
+   {
+      double screenX = ((i & 1) ? viewPort[0] + viewPort[2] + marginX : viewPort[0] - marginX);
+      double screenY = ((i & 2) ? viewPort[1] + viewPort[3] + marginY : viewPort[1] - marginY);
+
+      // Intersect the ray through the screen corner with the plane of the layer
+      GLdouble nearX = 0.0;
+      GLdouble nearY = 0.0;
+      GLdouble nearZ = 0.0;
+      GLdouble farX = 0.0;
+      GLdouble farY = 0.0;
+      GLdouble farZ = 0.0;
+      if (gluUnProject(screenX, screenY, 0.0, modelMatrix, projectionMatrix, viewPort, &nearX, &nearY, &nearZ) ==
+            GL_FALSE ||
+         gluUnProject(screenX, screenY, 1.0, modelMatrix, projectionMatrix, viewPort, &farX, &farY, &farZ) ==
+            GL_FALSE)
+      {
+         return false;
+      }
+
+      double deltaZ = farZ - nearZ;
+      if (fabs(deltaZ) < 1e-12)
+      {
+         return false;
+      }
+
+      double t = -nearZ / deltaZ;
+      if (t < 0.0 || t > 1.0)
+      {
+         return false;
+      }
+
+      double dataX = nearX + t * (farX - nearX);
+      double dataY = nearY + t * (farY - nearY);
+      llCorner.mX = min(llCorner.mX, dataX);
+      llCorner.mY = min(llCorner.mY, dataY);
+      urCorner.mX = max(urCorner.mX, dataX);
+      urCorner.mY = max(urCorner.mY, dataY);
+   }
+
+   return true;
+}
+
 void GraphicLayerImp::draw()
 {
    vector<LocationType> selectionNodes;
@@ -871,7 +944,14 @@ int GraphicLayerImp::selectObjects(const LocationType& corner1, const LocationTy
       deselectAllObjects();
    }
 
-   list<GraphicObject*> objects = getObjects();
+   // Only objects whose bounds intersect the selection rectangle can be inside it
+   list<GraphicObject*> objects;
+   GraphicGroupImp* pGroup = dynamic_cast<GraphicGroupImp*>(getGroup());
+   if (pGroup != NULL)
+   {
+      objects = pGroup->getObjects(LocationType(minx, miny), LocationType(maxx, maxy));
+   }
+
    for (list<GraphicObject*>::iterator it = objects.begin(); it != objects.end(); ++it)
    {
       GraphicObjectImp* pObject = dynamic_cast<GraphicObjectImp*>(*it);
@@ -269,6 +269,13 @@ private:
 
    void drawSelectionRectangle(LocationType ll, LocationType ur) const;
 
+   /**
+    *  Determines the region of the layer covered by the current OpenGL viewport, plus a margin.
+    *
+    *  @return False if the region cannot be bounded, such as when the horizon is in view.
+    */
+   bool getVisibleExtents(LocationType& llCorner, LocationType& urCorner) const;
+
    /**
     *  Determines if the object type is a physical object that is seen on the layer
     */
@@ -78,6 +78,9 @@ RasterLayerImp::RasterLayerImp(const string& id, const string& layerName, DataEl
    mOriginalGreenStretchValues(2),
    mOriginalBlueStretchValues(2),
    mpAnimation(NULL),
+   mPreviousFrameIndex(0),
+   mPrefetchReverse(false),
+   mPrefetchPending(false),
    mpSeparatorAction(NULL),
    mpDisplayModeMenu(NULL),
    mpGrayscaleAction(NULL),
@@ -237,24 +240,28 @@ bool RasterLayerImp::isKindOf(const string& className) const
 
 void RasterLayerImp::elementModifiedGray(Subject& subject, const string& signal, const boost::any& v)
 {
+   cancelPrefetch();
    setImageChanged(true);
    elementModified(subject, signal, v);
 }
 
 void RasterLayerImp::elementModifiedRed(Subject& subject, const string& signal, const boost::any& v)
 {
+   cancelPrefetch();
    setImageChanged(true);
    elementModified(subject, signal, v);
 }
 
 void RasterLayerImp::elementModifiedGreen(Subject& subject, const string& signal, const boost::any& v)
 {
+   cancelPrefetch();
    setImageChanged(true);
    elementModified(subject, signal, v);
 }
 
 void RasterLayerImp::elementModifiedBlue(Subject& subject, const string& signal, const boost::any& v)
 {
+   cancelPrefetch();
    setImageChanged(true);
    elementModified(subject, signal, v);
 }
@@ -436,6 +443,12 @@ void RasterLayerImp::draw()
       {
          applyFastContrastStretch();
       }
+
+      if (mPrefetchPending)
+      {
+         mPrefetchPending = false;
+         prefetchAnimationFrames();
+      }
    }
 
    // Draw the pixel values
@@ -1774,9 +1787,18 @@ double RasterLayerImp::convertStretchValue(const RasterChannelType& eColor, cons
       return dStretchValue;
    }
 
-   double dNewValue = 0.0;
+   return convertStretchValue(getStatistics(eColor), eUnits, dStretchValue, eNewUnits);
+}
 
-   Statistics* pStatistics = getStatistics(eColor);
+double RasterLayerImp::convertStretchValue(Statistics* pStatistics, const RegionUnits& eUnits, double dStretchValue,
+                                           const RegionUnits& eNewUnits) const
+{
+   if (eUnits == eNewUnits)
+   {
+      return dStretchValue;
+   }
+
+   double dNewValue = 0.0;
    if (pStatistics == NULL)
    {
       return dNewValue;
@@ -4094,7 +4116,9 @@ void RasterLayerImp::setAnimation(Animation* pAnimation)
       mpAnimation->detach(SIGNAL_NAME(Subject, Deleted), Slot(this, &RasterLayerImp::movieDeleted));
    }
 
+   cancelPrefetch();
    mpAnimation = pAnimation;
+   mPrefetchPending = false;
 
    if (mpAnimation != NULL)
    {
@@ -4131,6 +4155,26 @@ void RasterLayerImp::updateFromMovie()
    UndoLock lock(getView());
 
    unsigned int frameNumber = pFrame->mFrameNumber;
+
+   // Prefetch in the direction the animation is moving once the new frame has been drawn
+   const vector<AnimationFrame>& frames = mpAnimation->getFrames();
+   for (unsigned int i = 0; i < frames.size(); ++i)
+   {
+      if (frames[i].mFrameNumber == frameNumber)
+      {
+         if (i != mPreviousFrameIndex)
+         {
+            unsigned int numFrames = static_cast<unsigned int>(frames.size());
+            unsigned int forwardDistance = (i + numFrames - mPreviousFrameIndex) % numFrames;
+            mPrefetchReverse = mPreviousFrameIndex < numFrames && forwardDistance > numFrames / 2;
+            mPreviousFrameIndex = i;
+         }
+
+         mPrefetchPending = true;
+         break;
+      }
+   }
+
    if (getDisplayMode() == RGB_MODE)
    {
       const RasterDataDescriptor* pRedRasterDesc = mpRedRasterElement.get() == NULL ? NULL :
@@ -4184,6 +4228,161 @@ void RasterLayerImp::movieDeleted(Subject& subject, const string& signal, const
    }
 }
 
+void RasterLayerImp::prefetchAnimationFrames()
+{
+   unsigned int numPrefetchFrames = RasterLayer::getSettingAnimationPrefetchFrames();
+   if (mpImage == NULL || mpAnimation == NULL || numPrefetchFrames == 0)
+   {
+      return;
+   }
+
+   const vector<AnimationFrame>& frames = mpAnimation->getFrames();
+   unsigned int numFrames = static_cast<unsigned int>(frames.size());
+   if (numFrames < 2 || mPreviousFrameIndex >= numFrames)
+   {
+      return;
+   }
+
+   numPrefetchFrames = min(numPrefetchFrames, numFrames - 1);
+
+   // Each frame only changes the displayed bands, so start from the key of the current image
+   const ImageKey& currentKey = mpImage->getImageData().mKey;
+   vector<Image::PrefetchFrame> prefetchFrames;
+   for (unsigned int i = 1; i <= numPrefetchFrames; ++i)
+   {
+      unsigned int frameIndex = mPrefetchReverse ? (mPreviousFrameIndex + numFrames - i) % numFrames :
+         (mPreviousFrameIndex + i) % numFrames;
+      unsigned int frameNumber = frames[frameIndex].mFrameNumber;
+
+      Image::PrefetchFrame frame(currentKey, GL_LUMINANCE);
+      if (getDisplayMode() == GRAYSCALE_MODE)
+      {
+         RasterElement* pElement = dynamic_cast<RasterElement*>(getDataElement());
+         const BadValues* pBadValues = NULL;
+         if (getFrameChannel(GRAY, pElement, frameNumber, frame.mKey.mBand1, frame.mKey.mStretchPoints1,
+            pBadValues) == false)
+         {
+            continue;
+         }
+
+         frame.mKey.mpRasterElement[0] = pElement;
+         frame.mKey.mpRasterElement[1] = pElement;
+         frame.mKey.mpRasterElement[2] = pElement;
+         frame.mKey.mpBadValues1 = pBadValues;
+
+         bool hasBadValues = (pBadValues != NULL && pBadValues->empty() == false);
+         if (getColorMap().isDefault())
+         {
+            frame.mFormat = (hasBadValues ? GL_LUMINANCE_ALPHA : GL_LUMINANCE);
+         }
+         else
+         {
+            frame.mFormat = ((hasBadValues == false && mColorMap.isFullyOpaque()) ? GL_RGB : GL_RGBA);
+         }
+      }
+      else
+      {
+         const BadValues* pRedBadValues = NULL;
+         const BadValues* pGreenBadValues = NULL;
+         const BadValues* pBlueBadValues = NULL;
+         if (getFrameChannel(RED, mpRedRasterElement.get(), frameNumber, frame.mKey.mBand1,
+               frame.mKey.mStretchPoints1, pRedBadValues) == false ||
+            getFrameChannel(GREEN, mpGreenRasterElement.get(), frameNumber, frame.mKey.mBand2,
+               frame.mKey.mStretchPoints2, pGreenBadValues) == false ||
+            getFrameChannel(BLUE, mpBlueRasterElement.get(), frameNumber, frame.mKey.mBand3,
+               frame.mKey.mStretchPoints3, pBlueBadValues) == false)
+         {
+            continue;
+         }
+
+         frame.mKey.mpRasterElement[0] = mpRedRasterElement.get();
+         frame.mKey.mpRasterElement[1] = mpGreenRasterElement.get();
+         frame.mKey.mpRasterElement[2] = mpBlueRasterElement.get();
+         frame.mKey.mpBadValues1 = pRedBadValues;
+         frame.mKey.mpBadValues2 = pGreenBadValues;
+         frame.mKey.mpBadValues3 = pBlueBadValues;
+
+         bool hasBadValues = ((pRedBadValues != NULL && pRedBadValues->empty() == false) ||
+            (pGreenBadValues != NULL && pGreenBadValues->empty() == false) ||
+            (pBlueBadValues != NULL && pBlueBadValues->empty() == false));
+         frame.mFormat = (hasBadValues ? GL_RGBA : GL_RGB);
+      }
+
+      prefetchFrames.push_back(frame);
+   }
+
+   size_t cacheSize = static_cast<size_t>(RasterLayer::getSettingAnimationPrefetchCacheSize()) * 1024 * 1024;
+   mpImage->prefetch(prefetchFrames, cacheSize);
+}
+
+bool RasterLayerImp::getFrameChannel(RasterChannelType eColor, RasterElement* pElement, unsigned int frameNumber,
+                                     DimensionDescriptor& band, vector<double>& stretchValues,
+                                     const BadValues*& pBadValues) const
+{
+   if (pElement == NULL)
+   {
+      return false;
+   }
+
+   const RasterDataDescriptor* pDescriptor =
+      dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+   if (pDescriptor == NULL || frameNumber >= pDescriptor->getBandCount())
+   {
+      return false;
+   }
+
+   band = pDescriptor->getActiveBand(frameNumber);
+   if (band.isValid() == false)
+   {
+      return false;
+   }
+
+   Statistics* pStatistics = pElement->getStatistics(band);
+   if (pStatistics == NULL)
+   {
+      return false;
+   }
+
+   // Statistics are not calculated on the prefetch thread, so frames which need them are
+   // prefetched only if they have already been calculated
+   RegionUnits eUnits = getStretchUnits(eColor);
+   bool fastContrastStretch = canApplyFastContrastStretch();
+   StretchType eType = getStretchType(getDisplayMode());
+   if ((eUnits != RAW_VALUE || fastContrastStretch || eType == EQUALIZATION) &&
+      pStatistics->areStatisticsCalculated(mComplexComponent) == false)
+   {
+      return false;
+   }
+
+   double dLower = 0.0;
+   double dUpper = 0.0;
+   getStretchValues(eColor, dLower, dUpper);
+   if (fastContrastStretch)
+   {
+      dLower = pStatistics->getMin(mComplexComponent);
+      dUpper = pStatistics->getMax(mComplexComponent);
+   }
+   else if (eUnits != RAW_VALUE)
+   {
+      dLower = convertStretchValue(pStatistics, eUnits, dLower, RAW_VALUE);
+      dUpper = convertStretchValue(pStatistics, eUnits, dUpper, RAW_VALUE);
+   }
+
+   stretchValues.clear();
+   stretchValues.push_back(dLower);
+   stretchValues.push_back(dUpper);
+   pBadValues = pStatistics->getBadValues();
+   return true;
+}
+
+void RasterLayerImp::cancelPrefetch()
+{
+   if (mpImage != NULL)
+   {
+      mpImage->cancelPrefetch();
+   }
+}
+
 Animation* RasterLayerImp::getAnimation() const
 {
    return mpAnimation;
@@ -35,6 +35,7 @@ class RasterLayerImp : public LayerImp
 
 #ifdef CPPTESTS // allow testing of image rendering
    friend class FilterRedrawTestCase;
+   friend class AnimationPrefetchTestCase;
 #endif
 
 public:
@@ -201,7 +202,14 @@ protected:
    virtual void applyFastContrastStretch();
    void applyFastContrastStretch(RasterChannelType element);
    virtual Statistics* getStatistics(RasterChannelType eColor) const;
+   double convertStretchValue(Statistics* pStatistics, const RegionUnits& eUnits, double dStretchValue,
+      const RegionUnits& eNewUnits) const;
    double percentileToRaw(double value, const double* pdPercentiles) const;
+
+   void prefetchAnimationFrames();
+   bool getFrameChannel(RasterChannelType eColor, RasterElement* pElement, unsigned int frameNumber,
+      DimensionDescriptor& band, std::vector<double>& stretchValues, const BadValues*& pBadValues) const;
+   void cancelPrefetch();
    double rawToPercentile(double value, const double* pdPercentiles) const;
 
    bool needToDrawPixelValues() const;
@@ -274,6 +282,9 @@ private:
 
    std::vector<ImageFilterDescriptor*> mEnabledFilters;
    Animation* mpAnimation;
+   unsigned int mPreviousFrameIndex;
+   bool mPrefetchReverse;
+   bool mPrefetchPending;
 
    // Context menu items
    QAction* mpSeparatorAction;
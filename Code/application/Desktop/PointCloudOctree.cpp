@@ -0,0 +1,1038 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "ConfigurationSettings.h"
+#include "Filename.h"
+#include "PointCloudAccessor.h"
+#include "PointCloudAccessorImpl.h"
+#include "PointCloudDataDescriptor.h"
+#include "PointCloudElement.h"
+#include "PointCloudFileDescriptor.h"
+#include "PointCloudOctree.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <queue>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+namespace
+{
+   const unsigned int NODE_CAPACITY = 8192;
+
+   // The depth of the finest cells, which limits the point count histogram to 8^7 cells
+   const unsigned int MAX_DEPTH = 7;
+
+   // The number of points held in memory before they are written to the octree file
+   const uint64_t MAX_BUFFERED_POINTS = 4 * 1024 * 1024;
+
+   const char OCTREE_MAGIC[8] = { 'O', 'P', 'T', 'C', 'L', 'O', 'C', 'T' };
+   const uint32_t OCTREE_VERSION = 1;
+   const int64_t POINT_BYTES = PointCloudOctree::FLOATS_PER_POINT * sizeof(float);
+
+   bool isAborted(const volatile bool* pAbort)
+   {
+      return pAbort != NULL && *pAbort;
+   }
+
+   PointCloudAccessor getFirstValidPoint(const PointCloudElement* pElement)
+   {
+      PointCloudAccessor accessor = pElement->getPointCloudAccessor();
+      if (accessor.isValid() && !accessor->isPointValid())
+      {
+         accessor->nextValidPoint();
+      }
+
+      return accessor;
+   }
+
+   // Returns a value in [0, 1) which depends only on the point index, so each node keeps an even sample
+   double getSampleValue(uint32_t index)
+   {
+      uint32_t value = index;
+      value ^= value >> 16;
+      value *= 0x7feb352dU;
+      value ^= value >> 15;
+      value *= 0x846ca68bU;
+      value ^= value >> 16;
+      return value / 4294967296.0;
+   }
+
+   class ViewTransform
+   {
+   public:
+      ViewTransform(double minX, double maxY, double minZ, double maxZ, double cellSize) :
+         mMinX(minX),
+         mMaxY(maxY),
+         mMinZ(minZ),
+         mMaxZ(maxZ),
+         mCellSize(cellSize)
+      {
+      }
+
+      // Matches the coordinates computed by PointCloudViewImp::updateVertexBufferIfNeeded()
+      void toView(PointCloudAccessor& accessor, float* pPoint) const
+      {
+         pPoint[0] = static_cast<float>(accessor->getXAsDouble() - mMinX);
+         pPoint[1] = static_cast<float>(mMaxY - accessor->getYAsDouble());
+         if (mMinZ < 0.0)
+         {
+            pPoint[2] = static_cast<float>(accessor->getZAsDouble() - mMinZ);
+         }
+         else
+         {
+            pPoint[2] = static_cast<float>(mMaxZ - accessor->getZAsDouble());
+         }
+      }
+
+      // Returns the finest cell containing a point, with the coordinate bits interleaved so the
+      // cell of the same point at a coarser depth is found by shifting the code right
+      uint32_t getCellCode(const float* pPoint) const
+      {
+         const uint32_t maxCell = (1U << MAX_DEPTH) - 1;
+         uint32_t cells[3];
+         for (int axis = 0; axis < 3; ++axis)
+         {
+            double cell = max(0.0, floor(pPoint[axis] / mCellSize));
+            cells[axis] = min(maxCell, static_cast<uint32_t>(cell));
+         }
+
+         uint32_t code = 0;
+         for (unsigned int bit = 0; bit < MAX_DEPTH; ++bit)
+         {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+               code |= ((cells[axis] >> bit) & 1) << (3 * bit + axis);
+            }
+         }
+
+         return code;
+      }
+
+   private:
+      double mMinX;
+      double mMaxY;
+      double mMinZ;
+      double mMaxZ;
+      double mCellSize;
+   };
+
+   void setCellBounds(PointCloudOctree::Node& node, unsigned int depth, uint32_t code, double rootSize)
+   {
+      uint32_t cells[3] = { 0, 0, 0 };
+      for (unsigned int bit = 0; bit < depth; ++bit)
+      {
+         for (int axis = 0; axis < 3; ++axis)
+         {
+            cells[axis] |= ((code >> (3 * bit + axis)) & 1) << bit;
+         }
+      }
+
+      double size = rootSize / (1 << depth);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+         node.mMin[axis] = static_cast<float>(cells[axis] * size);
+         node.mMax[axis] = static_cast<float>((cells[axis] + 1) * size);
+      }
+
+      // Point clouds are mostly surfaces, so a node's points are spread over an area rather than a volume
+      node.mSpacing = static_cast<float>(size / sqrt(static_cast<double>(NODE_CAPACITY)));
+   }
+
+   bool flushPoints(LargeFileResource& file, const vector<PointCloudOctree::Node>& nodes,
+      vector<vector<float> >& buffers, vector<uint32_t>& written)
+   {
+      for (unsigned int node = 0; node < nodes.size(); ++node)
+      {
+         vector<float>& buffer = buffers[node];
+         if (buffer.empty())
+         {
+            continue;
+         }
+
+         const int64_t offset = nodes[node].mOffset + written[node] * POINT_BYTES;
+         const int64_t bytes = static_cast<int64_t>(buffer.size() * sizeof(float));
+         if (file.seek(offset, SEEK_SET) != offset || file.write(&buffer[0], bytes) != bytes)
+         {
+            return false;
+         }
+
+         written[node] += static_cast<uint32_t>(buffer.size() / PointCloudOctree::FLOATS_PER_POINT);
+         vector<float>().swap(buffer);
+      }
+
+      return true;
+   }
+
+   string getTemporaryFilename()
+   {
+      const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+      string tempPath;
+      if (pTempPath != NULL)
+      {
+         tempPath = pTempPath->getFullPathAndName();
+      }
+
+      char* pTempFilename = tempnam(tempPath.c_str(), "PCO");
+      if (pTempFilename == NULL)
+      {
+         return string();
+      }
+
+      string filename = pTempFilename;
+      free(pTempFilename);
+      return filename;
+   }
+
+   // Transforms a point by a column-major OpenGL matrix
+   void transformPoint(const double* pMatrix, const double* pPoint, double* pResult)
+   {
+      for (int row = 0; row < 4; ++row)
+      {
+         pResult[row] = pMatrix[row] * pPoint[0] + pMatrix[4 + row] * pPoint[1] + pMatrix[8 + row] * pPoint[2] +
+            pMatrix[12 + row];
+      }
+   }
+}
+
+PointCloudOctree::Node::Node() :
+   mSpacing(0.0f),
+   mPointCount(0),
+   mOffset(0)
+{
+   for (int axis = 0; axis < 3; ++axis)
+   {
+      mMin[axis] = 0.0f;
+      mMax[axis] = 0.0f;
+   }
+
+   for (int child = 0; child < 8; ++child)
+   {
+      mChildren[child] = -1;
+   }
+}
+
+PointCloudOctree::ViewParameters::ViewParameters()
+{
+   for (int i = 0; i < 16; ++i)
+   {
+      mModelMatrix[i] = (i % 5 == 0) ? 1.0 : 0.0;
+      mProjectionMatrix[i] = (i % 5 == 0) ? 1.0 : 0.0;
+   }
+
+   for (int i = 0; i < 4; ++i)
+   {
+      mViewport[i] = 0;
+   }
+
+   for (int axis = 0; axis < 3; ++axis)
+   {
+      mScale[axis] = 1.0;
+   }
+}
+
+PointCloudOctree::Header::Header() :
+   mVersion(OCTREE_VERSION),
+   mPointCount(0),
+   mSourcePointCount(0),
+   mNodeCount(0),
+   mSourceSize(-1),
+   mSourceModified(-1),
+   mMinX(0.0),
+   mMaxY(0.0),
+   mMinZ(0.0),
+   mMaxZ(0.0)
+{
+   memcpy(mMagic, OCTREE_MAGIC, sizeof(mMagic));
+   mIntensityRange[0] = mIntensityRange[1] = 0.0f;
+   mClassificationRange[0] = mClassificationRange[1] = 0.0f;
+}
+
+PointCloudOctree::PointCloudOctree() :
+   mFile(true)
+{
+}
+
+PointCloudOctree::~PointCloudOctree()
+{
+}
+
+bool PointCloudOctree::build(const PointCloudElement* pElement, const string& filename, const volatile bool* pAbort)
+{
+   close();
+   VERIFY(pElement != NULL && filename.empty() == false);
+   const PointCloudDataDescriptor* pDescriptor =
+      dynamic_cast<const PointCloudDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+   const bool hasIntensity = pDescriptor->hasIntensityData();
+   const bool hasClassification = pDescriptor->hasClassificationData();
+
+   Header header;
+   header.mSourcePointCount = pDescriptor->getPointCount();
+   getSourceInfo(pElement, header.mSourceSize, header.mSourceModified);
+
+   // Find the bounds of the data, which define the view coordinates
+   double minimum[3];
+   double maximum[3];
+   for (int axis = 0; axis < 3; ++axis)
+   {
+      minimum[axis] = numeric_limits<double>::max();
+      maximum[axis] = -numeric_limits<double>::max();
+   }
+
+   float intensityRange[2] = { numeric_limits<float>::max(), -numeric_limits<float>::max() };
+   float classificationRange[2] = { numeric_limits<float>::max(), -numeric_limits<float>::max() };
+   uint32_t pointCount = 0;
+   for (PointCloudAccessor accessor = getFirstValidPoint(pElement); accessor.isValid(); accessor->nextValidPoint())
+   {
+      if ((pointCount & 0xffff) == 0 && isAborted(pAbort))
+      {
+         return false;
+      }
+
+      const double values[3] = { accessor->getXAsDouble(), accessor->getYAsDouble(), accessor->getZAsDouble() };
+      for (int axis = 0; axis < 3; ++axis)
+      {
+         minimum[axis] = min(minimum[axis], values[axis]);
+         maximum[axis] = max(maximum[axis], values[axis]);
+      }
+
+      if (hasIntensity)
+      {
+         const float intensity = static_cast<float>(accessor->getIntensityAsDouble());
+         intensityRange[0] = min(intensityRange[0], intensity);
+         intensityRange[1] = max(intensityRange[1], intensity);
+      }
+
+      if (hasClassification)
+      {
+         const float classification = static_cast<float>(accessor->getClassificationAsDouble());
+         classificationRange[0] = min(classificationRange[0], classification);
+         classificationRange[1] = max(classificationRange[1], classification);
+      }
+
+      ++pointCount;
+   }
+
+   if (pointCount == 0)
+   {
+      return false;
+   }
+
+   header.mPointCount = pointCount;
+   header.mMinX = minimum[0];
+   header.mMaxY = maximum[1];
+   header.mMinZ = minimum[2];
+   header.mMaxZ = maximum[2];
+   for (int i = 0; i < 2; ++i)
+   {
+      header.mIntensityRange[i] = hasIntensity ? intensityRange[i] : 0.0f;
+      header.mClassificationRange[i] = hasClassification ? classificationRange[i] : 0.0f;
+   }
+
+   double rootSize = 0.0;
+   for (int axis = 0; axis < 3; ++axis)
+   {
+      rootSize = max(rootSize, maximum[axis] - minimum[axis]);
+   }
+
+   if (rootSize <= 0.0)
+   {
+      rootSize = 1.0;
+   }
+
+   const ViewTransform transform(header.mMinX, header.mMaxY, header.mMinZ, header.mMaxZ,
+      rootSize / (1 << MAX_DEPTH));
+
+   // Count the points in every cell at every depth to decide where the octree needs to be refined
+   vector<vector<uint32_t> > cellCounts(MAX_DEPTH + 1);
+   cellCounts[MAX_DEPTH].resize(1 << (3 * MAX_DEPTH), 0);
+   uint32_t index = 0;
+   for (PointCloudAccessor accessor = getFirstValidPoint(pElement); accessor.isValid(); accessor->nextValidPoint())
+   {
+      if ((index++ & 0xffff) == 0 && isAborted(pAbort))
+      {
+         return false;
+      }
+
+      float point[3];
+      transform.toView(accessor, point);
+      ++cellCounts[MAX_DEPTH][transform.getCellCode(point)];
+   }
+
+   for (unsigned int depth = MAX_DEPTH; depth > 0; --depth)
+   {
+      const vector<uint32_t>& fineCounts = cellCounts[depth];
+      vector<uint32_t>& coarseCounts = cellCounts[depth - 1];
+      coarseCounts.resize(fineCounts.size() / 8, 0);
+      for (size_t cell = 0; cell < fineCounts.size(); ++cell)
+      {
+         coarseCounts[cell / 8] += fineCounts[cell];
+      }
+   }
+
+   // Create the nodes coarsest first.  A point is stored in the first node on its path whose
+   // threshold is greater than the point's sample value.  Each node's threshold is chosen so
+   // that about NODE_CAPACITY of the points below it are stored in it, and a node with no more
+   // than NODE_CAPACITY points, or at the finest depth, keeps all of its remaining points.
+   vector<Node> nodes(1);
+   vector<unsigned int> depths(1, 0);
+   vector<uint32_t> codes(1, 0);
+   vector<double> thresholds(1, min(1.0, static_cast<double>(NODE_CAPACITY) / cellCounts[0][0]));
+   setCellBounds(nodes[0], 0, 0, rootSize);
+   for (size_t node = 0; node < nodes.size(); ++node)
+   {
+      if (thresholds[node] >= 1.0)
+      {
+         continue;
+      }
+
+      const unsigned int childDepth = depths[node] + 1;
+      for (uint32_t child = 0; child < 8; ++child)
+      {
+         const uint32_t childCode = codes[node] * 8 + child;
+         const uint32_t childCount = cellCounts[childDepth][childCode];
+         if (childCount == 0)
+         {
+            continue;
+         }
+
+         double threshold = 1.0;
+         if (childDepth < MAX_DEPTH)
+         {
+            threshold = min(1.0, thresholds[node] + static_cast<double>(NODE_CAPACITY) / childCount);
+         }
+
+         nodes[node].mChildren[child] = static_cast<int>(nodes.size());
+         nodes.push_back(Node());
+         setCellBounds(nodes.back(), childDepth, childCode, rootSize);
+         depths.push_back(childDepth);
+         codes.push_back(childCode);
+         thresholds.push_back(threshold);
+      }
+   }
+
+   vector<vector<uint32_t> >().swap(cellCounts);
+   header.mNodeCount = static_cast<uint32_t>(nodes.size());
+
+   // Count the points stored in each node and find their bounds
+   vector<float> pointBounds(nodes.size() * 6);
+   for (size_t node = 0; node < nodes.size(); ++node)
+   {
+      for (int axis = 0; axis < 3; ++axis)
+      {
+         pointBounds[node * 6 + axis] = numeric_limits<float>::max();
+         pointBounds[node * 6 + 3 + axis] = -numeric_limits<float>::max();
+      }
+   }
+
+   index = 0;
+   for (PointCloudAccessor accessor = getFirstValidPoint(pElement); accessor.isValid(); accessor->nextValidPoint())
+   {
+      if ((index & 0xffff) == 0 && isAborted(pAbort))
+      {
+         return false;
+      }
+
+      float point[3];
+      transform.toView(accessor, point);
+      const uint32_t code = transform.getCellCode(point);
+      const double sample = getSampleValue(index++);
+      unsigned int node = 0;
+      while (sample >= thresholds[node])
+      {
+         const int child = nodes[node].mChildren[(code >> (3 * (MAX_DEPTH - depths[node] - 1))) & 7];
+         if (child < 0)
+         {
+            break;
+         }
+
+         node = static_cast<unsigned int>(child);
+      }
+
+      ++nodes[node].mPointCount;
+      for (int axis = 0; axis < 3; ++axis)
+      {
+         pointBounds[node * 6 + axis] = min(pointBounds[node * 6 + axis], point[axis]);
+         pointBounds[node * 6 + 3 + axis] = max(pointBounds[node * 6 + 3 + axis], point[axis]);
+      }
+   }
+
+   // Shrink each node to the bounds of its points and its children, which culls more nodes
+   for (size_t node = nodes.size(); node-- > 0;)
+   {
+      float* pBounds = &pointBounds[node * 6];
+      for (int child = 0; child < 8; ++child)
+      {
+         const int childIndex = nodes[node].mChildren[child];
+         if (childIndex >= 0)
+         {
+            const Node& childNode = nodes[childIndex];
+            for (int axis = 0; axis < 3; ++axis)
+            {
+               pBounds[axis] = min(pBounds[axis], childNode.mMin[axis]);
+               pBounds[3 + axis] = max(pBounds[3 + axis], childNode.mMax[axis]);
+            }
+         }
+      }
+
+      if (pBounds[0] <= pBounds[3])
+      {
+         for (int axis = 0; axis < 3; ++axis)
+         {
+            nodes[node].mMin[axis] = pBounds[axis];
+            nodes[node].mMax[axis] = pBounds[3 + axis];
+         }
+      }
+   }
+
+   vector<float>().swap(pointBounds);
+
+   int64_t offset = static_cast<int64_t>(sizeof(Header) + nodes.size() * sizeof(Node));
+   for (size_t node = 0; node < nodes.size(); ++node)
+   {
+      nodes[node].mOffset = offset;
+      offset += nodes[node].mPointCount * POINT_BYTES;
+   }
+
+   // Write the points of each node.  The header is written last so an incomplete file is not loaded.
+   LargeFileResource file(true);
+   if (!file.open(filename, O_RDWR | O_CREAT | O_TRUNC | O_BINARY, S_IREAD | S_IWRITE))
+   {
+      return false;
+   }
+
+   const int64_t headerBytes = static_cast<int64_t>(sizeof(Header));
+   const int64_t nodeBytes = static_cast<int64_t>(nodes.size() * sizeof(Node));
+   bool success = file.seek(headerBytes, SEEK_SET) == headerBytes && file.write(&nodes[0], nodeBytes) == nodeBytes;
+
+   vector<vector<float> > buffers(nodes.size());
+   vector<uint32_t> written(nodes.size(), 0);
+   uint64_t bufferedPoints = 0;
+   index = 0;
+   for (PointCloudAccessor accessor = getFirstValidPoint(pElement); success && accessor.isValid();
+      accessor->nextValidPoint())
+   {
+      if ((index & 0xffff) == 0 && isAborted(pAbort))
+      {
+         success = false;
+         break;
+      }
+
+      float point[FLOATS_PER_POINT];
+      transform.toView(accessor, point);
+      point[3] = hasIntensity ? static_cast<float>(accessor->getIntensityAsDouble()) : 0.0f;
+      point[4] = hasClassification ? static_cast<float>(accessor->getClassificationAsDouble()) : 0.0f;
+      const uint32_t code = transform.getCellCode(point);
+      const double sample = getSampleValue(index++);
+      unsigned int node = 0;
+      while (sample >= thresholds[node])
+      {
+         const int child = nodes[node].mChildren[(code >> (3 * (MAX_DEPTH - depths[node] - 1))) & 7];
+         if (child < 0)
+         {
+            break;
+         }
+
+         node = static_cast<unsigned int>(child);
+      }
+
+      buffers[node].insert(buffers[node].end(), point, point + FLOATS_PER_POINT);
+      if (++bufferedPoints >= MAX_BUFFERED_POINTS)
+      {
+         success = flushPoints(file, nodes, buffers, written);
+         bufferedPoints = 0;
+      }
+   }
+
+   success = success && flushPoints(file, nodes, buffers, written);
+   for (size_t node = 0; success && node < nodes.size(); ++node)
+   {
+      success = written[node] == nodes[node].mPointCount;
+   }
+
+   success = success && file.seek(0, SEEK_SET) == 0 && file.write(&header, headerBytes) == headerBytes;
+   if (!success)
+   {
+      file.close();
+      remove(filename.c_str());
+      return false;
+   }
+
+   mHeader = header;
+   mNodes.swap(nodes);
+   mFile = file;
+   return true;
+}
+
+bool PointCloudOctree::load(const PointCloudElement* pElement, const string& filename)
+{
+   close();
+   VERIFY(pElement != NULL);
+   const PointCloudDataDescriptor* pDescriptor =
+      dynamic_cast<const PointCloudDataDescriptor*>(pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   LargeFileResource file(true);
+   if (filename.empty() || !file.open(filename, O_RDONLY | O_BINARY, S_IREAD))
+   {
+      return false;
+   }
+
+   Header header;
+   const int64_t headerBytes = static_cast<int64_t>(sizeof(Header));
+   if (file.read(&header, headerBytes) != headerBytes || memcmp(header.mMagic, OCTREE_MAGIC, sizeof(OCTREE_MAGIC)) != 0 ||
+      header.mVersion != OCTREE_VERSION || header.mNodeCount == 0)
+   {
+      return false;
+   }
+
+   // The octree cannot be reused if the data has changed since it was built
+   int64_t sourceSize = -1;
+   int64_t sourceModified = -1;
+   getSourceInfo(pElement, sourceSize, sourceModified);
+   if (header.mSourcePointCount != pDescriptor->getPointCount() || header.mSourceSize != sourceSize ||
+      header.mSourceModified != sourceModified || sourceSize < 0)
+   {
+      return false;
+   }
+
+   vector<Node> nodes(header.mNodeCount);
+   const int64_t nodeBytes = static_cast<int64_t>(nodes.size() * sizeof(Node));
+   if (file.read(&nodes[0], nodeBytes) != nodeBytes)
+   {
+      return false;
+   }
+
+   const Node& lastNode = nodes.back();
+   if (lastNode.mOffset + lastNode.mPointCount * POINT_BYTES > file.fileLength())
+   {
+      return false;
+   }
+
+   mHeader = header;
+   mNodes.swap(nodes);
+   mFile = file;
+   return true;
+}
+
+void PointCloudOctree::close()
+{
+   mta::MutexLock lock(mFileMutex);
+   mFile.close();
+   mNodes.clear();
+   mHeader = Header();
+}
+
+bool PointCloudOctree::isValid() const
+{
+   return mNodes.empty() == false;
+}
+
+const vector<PointCloudOctree::Node>& PointCloudOctree::getNodes() const
+{
+   return mNodes;
+}
+
+uint32_t PointCloudOctree::getPointCount() const
+{
+   return mHeader.mPointCount;
+}
+
+double PointCloudOctree::getMinX() const
+{
+   return mHeader.mMinX;
+}
+
+double PointCloudOctree::getMaxY() const
+{
+   return mHeader.mMaxY;
+}
+
+double PointCloudOctree::getMinZ() const
+{
+   return mHeader.mMinZ;
+}
+
+double PointCloudOctree::getMaxZ() const
+{
+   return mHeader.mMaxZ;
+}
+
+void PointCloudOctree::getIntensityRange(float& minimum, float& maximum) const
+{
+   minimum = mHeader.mIntensityRange[0];
+   maximum = mHeader.mIntensityRange[1];
+}
+
+void PointCloudOctree::getClassificationRange(float& minimum, float& maximum) const
+{
+   minimum = mHeader.mClassificationRange[0];
+   maximum = mHeader.mClassificationRange[1];
+}
+
+bool PointCloudOctree::readPoints(unsigned int node, vector<float>& points) const
+{
+   points.clear();
+   if (node >= mNodes.size())
+   {
+      return false;
+   }
+
+   const Node& nodeInfo = mNodes[node];
+   if (nodeInfo.mPointCount == 0)
+   {
+      return true;
+   }
+
+   points.resize(nodeInfo.mPointCount * FLOATS_PER_POINT);
+   const int64_t bytes = nodeInfo.mPointCount * POINT_BYTES;
+
+   mta::MutexLock lock(mFileMutex);
+   if (mFile.seek(nodeInfo.mOffset, SEEK_SET) != nodeInfo.mOffset || mFile.read(&points[0], bytes) != bytes)
+   {
+      points.clear();
+      return false;
+   }
+
+   return true;
+}
+
+void PointCloudOctree::selectNodes(const vector<Node>& nodes, const ViewParameters& view, uint64_t pointBudget,
+   double maxPixelSpacing, vector<unsigned int>& selected)
+{
+   selected.clear();
+   if (nodes.empty())
+   {
+      return;
+   }
+
+   // Apply the view scale to the model matrix so the nodes can be tested in view coordinates
+   double model[16];
+   for (int i = 0; i < 16; ++i)
+   {
+      model[i] = view.mModelMatrix[i] * (i < 12 ? view.mScale[i / 4] : 1.0);
+   }
+
+   double clip[16];
+   for (int column = 0; column < 4; ++column)
+   {
+      for (int row = 0; row < 4; ++row)
+      {
+         clip[column * 4 + row] = 0.0;
+         for (int k = 0; k < 4; ++k)
+         {
+            clip[column * 4 + row] += view.mProjectionMatrix[k * 4 + row] * model[column * 4 + k];
+         }
+      }
+   }
+
+   // The frustum planes, with their normals pointing inside
+   double planes[6][4];
+   for (int plane = 0; plane < 6; ++plane)
+   {
+      const int row = plane / 2;
+      const double sign = (plane % 2 == 0) ? 1.0 : -1.0;
+      for (int column = 0; column < 4; ++column)
+      {
+         planes[plane][column] = clip[column * 4 + 3] + sign * clip[column * 4 + row];
+      }
+   }
+
+   // The size of one unit along each axis of view coordinates in eye coordinates, and of one unit
+   // at unit depth in pixels
+   double axisScale[3];
+   for (int axis = 0; axis < 3; ++axis)
+   {
+      axisScale[axis] = sqrt(model[axis * 4] * model[axis * 4] + model[axis * 4 + 1] * model[axis * 4 + 1] +
+         model[axis * 4 + 2] * model[axis * 4 + 2]);
+   }
+
+   const double eyeScale = max(axisScale[0], axisScale[1]);
+
+   const double pixelScale = fabs(view.mProjectionMatrix[5]) * view.mViewport[3] / 2.0;
+   const bool perspective = view.mProjectionMatrix[11] != 0.0;
+
+   priority_queue<pair<double, unsigned int> > candidates;
+   vector<unsigned int> children(1, 0);
+   uint64_t pointCount = 0;
+   for (;;)
+   {
+      for (vector<unsigned int>::const_iterator iter = children.begin(); iter != children.end(); ++iter)
+      {
+         const Node& node = nodes[*iter];
+         bool visible = true;
+         for (int plane = 0; plane < 6 && visible; ++plane)
+         {
+            // The corner furthest along the plane normal must be inside
+            double distance = planes[plane][3];
+            for (int axis = 0; axis < 3; ++axis)
+            {
+               distance += planes[plane][axis] * (planes[plane][axis] >= 0.0 ? node.mMax[axis] : node.mMin[axis]);
+            }
+
+            visible = distance >= 0.0;
+         }
+
+         if (!visible)
+         {
+            continue;
+         }
+
+         double spacing = node.mSpacing * eyeScale * pixelScale;
+         if (perspective)
+         {
+            double center[3];
+            double radius = 0.0;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+               center[axis] = (node.mMin[axis] + node.mMax[axis]) / 2.0;
+               const double halfSize = (node.mMax[axis] - node.mMin[axis]) * axisScale[axis] / 2.0;
+               radius += halfSize * halfSize;
+            }
+
+            // Use the nearest depth of the node's bounding sphere
+            double eye[4];
+            transformPoint(model, center, eye);
+            const double depth = -eye[2] - sqrt(radius);
+            spacing = (depth > 1e-9) ? spacing / depth : numeric_limits<double>::max();
+         }
+
+         candidates.push(make_pair(spacing, *iter));
+      }
+
+      children.clear();
+      if (candidates.empty())
+      {
+         break;
+      }
+
+      const unsigned int index = candidates.top().second;
+      const double spacing = candidates.top().first;
+      candidates.pop();
+      const Node& node = nodes[index];
+      if (pointCount + node.mPointCount > pointBudget)
+      {
+         continue;
+      }
+
+      pointCount += node.mPointCount;
+      selected.push_back(index);
+      if (spacing > maxPixelSpacing)
+      {
+         for (int child = 0; child < 8; ++child)
+         {
+            if (node.mChildren[child] >= 0)
+            {
+               children.push_back(static_cast<unsigned int>(node.mChildren[child]));
+            }
+         }
+      }
+   }
+}
+
+string PointCloudOctree::getOctreeFilename(const PointCloudElement* pElement, bool& persistent)
+{
+   persistent = false;
+   if (pElement == NULL)
+   {
+      return string();
+   }
+
+   const DataDescriptor* pDescriptor = pElement->getDataDescriptor();
+   const FileDescriptor* pFileDescriptor = (pDescriptor == NULL) ? NULL : pDescriptor->getFileDescriptor();
+   if (pFileDescriptor != NULL)
+   {
+      const string dataFilename = pFileDescriptor->getFilename().getFullPathAndName();
+      QFileInfo dataInfo(QString::fromStdString(dataFilename));
+      if (dataInfo.exists())
+      {
+         persistent = true;
+         const string octreeFilename = dataFilename + ".octree";
+         QFileInfo octreeInfo(QString::fromStdString(octreeFilename));
+         if (octreeInfo.exists() ? octreeInfo.isWritable() : QFileInfo(dataInfo.absolutePath()).isWritable())
+         {
+            return octreeFilename;
+         }
+
+         // Keep the octree of data in a read-only directory in the temporary directory
+         const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+         if (pTempPath != NULL)
+         {
+            const QString key = QString::number(qHash(dataInfo.absoluteFilePath()), 16);
+            return QDir(QString::fromStdString(pTempPath->getFullPathAndName())).filePath(
+               dataInfo.fileName() + "." + key + ".octree").toStdString();
+         }
+      }
+   }
+
+   persistent = false;
+   return getTemporaryFilename();
+}
+
+unsigned int PointCloudOctree::getNodeCapacity()
+{
+   return NODE_CAPACITY;
+}
+
+void PointCloudOctree::getSourceInfo(const PointCloudElement* pElement, int64_t& size, int64_t& modified)
+{
+   size = -1;
+   modified = -1;
+   const DataDescriptor* pDescriptor = (pElement == NULL) ? NULL : pElement->getDataDescriptor();
+   const FileDescriptor* pFileDescriptor = (pDescriptor == NULL) ? NULL : pDescriptor->getFileDescriptor();
+   if (pFileDescriptor == NULL)
+   {
+      return;
+   }
+
+   QFileInfo info(QString::fromStdString(pFileDescriptor->getFilename().getFullPathAndName()));
+   if (info.exists())
+   {
+      size = info.size();
+      modified = info.lastModified().toTime_t();
+   }
+}
+
+PointCloudOctreeStreamer::PointCloudOctreeStreamer(const PointCloudElement* pElement, bool reuse) :
+   mpElement(pElement),
+   mPersistent(false),
+   mThreadHandle(static_cast<void*>(this), reinterpret_cast<void*>(PointCloudOctreeStreamer::threadFunction)),
+   mState(BUILDING),
+   mStop(false),
+   mReading(false)
+{
+   if (reuse)
+   {
+      mFilename = PointCloudOctree::getOctreeFilename(pElement, mPersistent);
+   }
+   else
+   {
+      mFilename = getTemporaryFilename();
+   }
+
+   mThreadHandle.ThreadLaunch();
+}
+
+PointCloudOctreeStreamer::~PointCloudOctreeStreamer()
+{
+   {
+      mta::MutexLock lock(mMutex);
+      mRequests.clear();
+      mStop = true;
+      mRequestsQueued.ThreadSignalActivate();
+   }
+
+   mThreadHandle.ThreadWait();
+   mOctree.close();
+   if (!mPersistent && !mFilename.empty())
+   {
+      remove(mFilename.c_str());
+   }
+}
+
+PointCloudOctreeStreamer::StateEnum PointCloudOctreeStreamer::getState() const
+{
+   mta::MutexLock lock(mMutex);
+   return mState;
+}
+
+const PointCloudOctree& PointCloudOctreeStreamer::getOctree() const
+{
+   return mOctree;
+}
+
+void PointCloudOctreeStreamer::request(const vector<unsigned int>& nodes)
+{
+   mta::MutexLock lock(mMutex);
+   mRequests.assign(nodes.begin(), nodes.end());
+   mRequestsQueued.ThreadSignalActivate();
+}
+
+bool PointCloudOctreeStreamer::isBusy() const
+{
+   mta::MutexLock lock(mMutex);
+   return mState == BUILDING || mReading || !mRequests.empty() || !mLoaded.empty();
+}
+
+void PointCloudOctreeStreamer::takeLoadedNodes(map<unsigned int, vector<float> >& nodes)
+{
+   nodes.clear();
+   mta::MutexLock lock(mMutex);
+   nodes.swap(mLoaded);
+}
+
+void PointCloudOctreeStreamer::threadFunction(PointCloudOctreeStreamer* pStreamer)
+{
+   if (pStreamer != NULL)
+   {
+      pStreamer->run();
+   }
+}
+
+void PointCloudOctreeStreamer::run()
+{
+   bool success = false;
+   if (mPersistent)
+   {
+      success = mOctree.load(mpElement, mFilename);
+   }
+
+   if (!success && !mFilename.empty())
+   {
+      success = mOctree.build(mpElement, mFilename, &mStop);
+   }
+
+   mMutex.MutexLock();
+   mState = success ? READY : FAILED;
+   for (;;)
+   {
+      while (mRequests.empty() && mStop == false)
+      {
+         mRequestsQueued.ThreadSignalWait(&mMutex);
+      }
+
+      if (mStop)
+      {
+         break;
+      }
+
+      const unsigned int node = mRequests.front();
+      mRequests.pop_front();
+      if (mState != READY || mLoaded.find(node) != mLoaded.end())
+      {
+         continue;
+      }
+
+      mReading = true;
+      mMutex.MutexUnlock();
+
+      vector<float> points;
+      success = mOctree.readPoints(node, points);
+
+      mMutex.MutexLock();
+      mReading = false;
+      if (success)
+      {
+         mLoaded[node].swap(points);
+      }
+   }
+
+   mMutex.MutexUnlock();
+}
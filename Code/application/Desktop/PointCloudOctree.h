@@ -0,0 +1,302 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef POINTCLOUDOCTREE_H
+#define POINTCLOUDOCTREE_H
+
+#include "bthread.h"
+#include "DMutex.h"
+#include "FileResource.h"
+
+#include <deque>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class PointCloudElement;
+
+/**
+ * A level of detail hierarchy over the valid points of a point cloud element.
+ *
+ * Every point is stored in exactly one node.  Each interior node holds an
+ * evenly distributed sample of about getNodeCapacity() of the points within
+ * its bounds, and the remaining points are passed to its children, so drawing
+ * a node and all of its ancestors shows every point in the node's bounds at
+ * the node's spacing.  Which points are kept depends only on the point index,
+ * so the sample is not biased by the order the points were acquired in.
+ *
+ * The nodes and their points are written to a file.  Only the node table is
+ * kept in memory, and the points of a node are read with readPoints() when the
+ * node is displayed.
+ *
+ * Points are stored in the coordinates used by PointCloudView: x is relative
+ * to the minimum x, y is flipped about the maximum y, and z is relative to the
+ * minimum z if it is negative or flipped about the maximum z otherwise.
+ */
+class PointCloudOctree
+{
+public:
+   /**
+    * The number of floats stored for each point: x, y, z, intensity and classification.
+    */
+   static const unsigned int FLOATS_PER_POINT = 5;
+
+   /**
+    * A cell of the octree.
+    */
+   class Node
+   {
+   public:
+      Node();
+
+      float mMin[3];          // the bounds of the node, in view coordinates
+      float mMax[3];
+      float mSpacing;         // the approximate distance between the points of the node and its ancestors
+      int mChildren[8];       // the index of each child, or -1
+      uint32_t mPointCount;   // the number of points stored in this node
+      int64_t mOffset;        // the file offset of the node's points
+   };
+
+   /**
+    * The transform from view coordinates to the screen, as returned by OpenGL.
+    */
+   class ViewParameters
+   {
+   public:
+      ViewParameters();
+
+      double mModelMatrix[16];
+      double mProjectionMatrix[16];
+      int mViewport[4];
+      double mScale[3];       // applied to the view coordinates before the model matrix
+   };
+
+   PointCloudOctree();
+   ~PointCloudOctree();
+
+   /**
+    * Builds the octree for a point cloud element and writes it to a file.
+    *
+    * @param pElement
+    *        The point cloud to read.
+    * @param filename
+    *        The file to write.  An existing file is overwritten.
+    * @param pAbort
+    *        Building stops if this becomes true, or \c NULL.
+    *
+    * @return True if the octree was built, false otherwise.
+    */
+   bool build(const PointCloudElement* pElement, const std::string& filename, const volatile bool* pAbort = NULL);
+
+   /**
+    * Opens an octree which was written by build().
+    *
+    * @param pElement
+    *        The point cloud the octree must have been built from.
+    * @param filename
+    *        The file to read.
+    *
+    * @return True if the file contains an octree for the element's points
+    *         and the element's file has not been modified since it was written.
+    */
+   bool load(const PointCloudElement* pElement, const std::string& filename);
+
+   /**
+    * Closes the file and releases the node table.
+    */
+   void close();
+
+   bool isValid() const;
+   const std::vector<Node>& getNodes() const;
+   uint32_t getPointCount() const;
+
+   /**
+    * Returns the values of the data used to compute the view coordinates.
+    */
+   double getMinX() const;
+   double getMaxY() const;
+   double getMinZ() const;
+   double getMaxZ() const;
+   void getIntensityRange(float& minimum, float& maximum) const;
+   void getClassificationRange(float& minimum, float& maximum) const;
+
+   /**
+    * Reads the points of a node.
+    *
+    * This may be called from any thread.
+    *
+    * @param node
+    *        The index of the node.
+    * @param points
+    *        Receives FLOATS_PER_POINT values for each point.
+    *
+    * @return True if the points were read, false otherwise.
+    */
+   bool readPoints(unsigned int node, std::vector<float>& points) const;
+
+   /**
+    * Chooses the nodes to draw.
+    *
+    * Nodes outside the view frustum are skipped.  The remaining nodes are
+    * refined in order of their projected point spacing, largest first, until
+    * the spacing is below \em maxPixelSpacing or adding a node would exceed
+    * \em pointBudget.  A node is only selected if its parent is selected.
+    *
+    * @param nodes
+    *        The octree, with the root first.
+    * @param view
+    *        The transform to the screen.
+    * @param pointBudget
+    *        The maximum number of points in the selected nodes.
+    * @param maxPixelSpacing
+    *        Nodes whose projected spacing is smaller than this are not refined.
+    * @param selected
+    *        Receives the indices of the selected nodes.  Each node follows its parent.
+    */
+   static void selectNodes(const std::vector<Node>& nodes, const ViewParameters& view, uint64_t pointBudget,
+      double maxPixelSpacing, std::vector<unsigned int>& selected);
+
+   /**
+    * Returns the file the octree of an element is kept in.
+    *
+    * The octree is kept next to the element's file if that directory can be
+    * written, or in the temporary directory otherwise.
+    *
+    * @param pElement
+    *        The point cloud element.
+    * @param persistent
+    *        Set to false if the element has no file, so the octree cannot be
+    *        reused and should be deleted when it is no longer needed.
+    *
+    * @return The octree filename.
+    */
+   static std::string getOctreeFilename(const PointCloudElement* pElement, bool& persistent);
+
+   /**
+    * Returns the capacity of an interior node.
+    */
+   static unsigned int getNodeCapacity();
+
+private:
+   PointCloudOctree(const PointCloudOctree& rhs);
+   PointCloudOctree& operator=(const PointCloudOctree& rhs);
+
+   class Header
+   {
+   public:
+      Header();
+
+      char mMagic[8];
+      uint32_t mVersion;
+      uint32_t mPointCount;
+      uint32_t mSourcePointCount;
+      uint32_t mNodeCount;
+      int64_t mSourceSize;
+      int64_t mSourceModified;
+      double mMinX;
+      double mMaxY;
+      double mMinZ;
+      double mMaxZ;
+      float mIntensityRange[2];
+      float mClassificationRange[2];
+   };
+
+   static void getSourceInfo(const PointCloudElement* pElement, int64_t& size, int64_t& modified);
+
+   Header mHeader;
+   std::vector<Node> mNodes;
+   mutable LargeFileResource mFile;
+   mutable mta::DMutex mFileMutex;
+};
+
+/**
+ * Builds or loads the octree of a point cloud element on a background thread
+ * and reads the points of requested nodes.
+ */
+class PointCloudOctreeStreamer
+{
+public:
+   enum StateEnum
+   {
+      BUILDING,   /**< The octree is being loaded or built. */
+      READY,      /**< The octree may be used. */
+      FAILED      /**< The octree could not be built. */
+   };
+
+   /**
+    * Starts building or loading the octree.
+    *
+    * @param pElement
+    *        The point cloud element.  It must not be modified or destroyed
+    *        until the streamer is destroyed.
+    * @param reuse
+    *        If true, the octree is kept with the element's file, and one
+    *        which was previously built for the file is loaded instead of
+    *        being built again.  Set this to false if the element's points
+    *        have been changed, so the octree is built in a temporary file.
+    */
+   PointCloudOctreeStreamer(const PointCloudElement* pElement, bool reuse = true);
+
+   /**
+    * Stops the background thread.  A temporary octree file is deleted.
+    */
+   ~PointCloudOctreeStreamer();
+
+   StateEnum getState() const;
+
+   /**
+    * Returns the octree, which may only be used once getState() returns READY.
+    */
+   const PointCloudOctree& getOctree() const;
+
+   /**
+    * Replaces the nodes waiting to be read.
+    *
+    * @param nodes
+    *        The nodes to read, in the order they should be read.
+    */
+   void request(const std::vector<unsigned int>& nodes);
+
+   /**
+    * Queries whether nodes are waiting to be read or taken.
+    */
+   bool isBusy() const;
+
+   /**
+    * Returns the points of the nodes which have been read since the last call.
+    *
+    * @param nodes
+    *        Receives the points of each node which was read.
+    */
+   void takeLoadedNodes(std::map<unsigned int, std::vector<float> >& nodes);
+
+private:
+   PointCloudOctreeStreamer(const PointCloudOctreeStreamer& rhs);
+   PointCloudOctreeStreamer& operator=(const PointCloudOctreeStreamer& rhs);
+
+   static void threadFunction(PointCloudOctreeStreamer* pStreamer);
+   void run();
+
+   const PointCloudElement* mpElement;
+   PointCloudOctree mOctree;
+   std::string mFilename;
+   bool mPersistent;
+
+   BThread mThreadHandle;
+   mutable mta::DMutex mMutex;
+   mta::DThreadSignal mRequestsQueued;
+   StateEnum mState;
+   volatile bool mStop;
+   bool mReading;
+   std::deque<unsigned int> mRequests;
+   std::map<unsigned int, std::vector<float> > mLoaded;
+};
+
+#endif
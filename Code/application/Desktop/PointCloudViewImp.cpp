@@ -21,6 +21,7 @@
 #include "PointCloudAccessorImpl.h"
 #include "PointCloudDataDescriptor.h"
 #include "PointCloudElement.h"
+#include "PointCloudOctree.h"
 #include "PointCloudViewAdapter.h"
 #include "PointCloudViewImp.h"
 #include "PropertiesPointCloudView.h"
@@ -28,6 +29,7 @@
 #include "Undo.h"
 
 #include <QtCore/QFile>
+#include <QtCore/QTimer>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QActionGroup>
 #include <QtWidgets/QMenu>
@@ -69,6 +71,10 @@ PointCloudViewImp::PointCloudViewImp(const std::string& id, const std::string& v
       mScaleFactor(0.01),
       mZExaggerationFactor(1.0),
       mPointSize(1.0),
+      mpOctreeStreamer(NULL),
+      mOctreeBufferPoints(0),
+      mOctreeFrame(0),
+      mpOctreeTimer(NULL),
       mMouseActive(false)
 {
    // check the OpenGL version
@@ -177,6 +183,11 @@ PointCloudViewImp::PointCloudViewImp(const std::string& id, const std::string& v
    VERIFYNR(connect(pColorizationGroup, SIGNAL(triggered(QAction*)),
       this, SLOT(setPointColorizationType(QAction*))));
 
+   // Redraw while the octree is being built and its nodes are being read
+   mpOctreeTimer = new QTimer(this);
+   mpOctreeTimer->setInterval(100);
+   VERIFYNR(connect(mpOctreeTimer, SIGNAL(timeout()), this, SLOT(updateOctree())));
+
    setStretchType(LINEAR);
    setPointColorizationType(POINT_HEIGHT);
 }
@@ -191,6 +202,7 @@ PointCloudViewImp::~PointCloudViewImp()
    {
       glDeleteTextures(1, &mColorMapTexture);
    }
+   releaseOctree(); // the octree streamer reads the element, so stop it before the element is destroyed
    if (mpPrimaryPointCloud.get() != NULL)
    {
       PointCloudElement* pElement = mpPrimaryPointCloud.get();
@@ -253,7 +265,19 @@ void PointCloudViewImp::elementModified(Subject &subject, const std::string &sig
          mColorizationBufferUpToDate = false;
          break;
       }
-      if (!mVertexBufferUpToDate || !mColorizationBufferUpToDate)
+
+      // The points no longer match the element's file, so the octree is rebuilt in a temporary file
+      bool octreeModified = false;
+      if (fields & (PointCloudElement::UPDATE_LOCATION | PointCloudElement::UPDATE_INTENSITY |
+         PointCloudElement::UPDATE_CLASSIFICATION))
+      {
+         releaseOctree();
+         mpOctreeStreamer = new PointCloudOctreeStreamer(mpPrimaryPointCloud.get(), false);
+         mpOctreeTimer->start();
+         octreeModified = true;
+      }
+
+      if (!mVertexBufferUpToDate || !mColorizationBufferUpToDate || octreeModified)
       {
          refresh();
       }
@@ -406,6 +430,8 @@ bool PointCloudViewImp::setPrimaryPointCloud(PointCloudElement* pPointCloud)
    mpPrimaryPointCloud.reset(pPointCloud);
    mVertexBufferUpToDate = false;
    updateVertexBufferIfNeeded();
+   mpOctreeStreamer = new PointCloudOctreeStreamer(pPointCloud);
+   mpOctreeTimer->start();
    notify(SIGNAL_NAME(Subject, Modified));
    return true;
 }
@@ -1061,7 +1087,9 @@ void PointCloudViewImp::drawContents()
    updateVertexBufferIfNeeded();
    updateColorMapTextureIfNeeded();
    updateColorizationBufferIfNeeded();
-   if (mTotalPoints == 0)
+   const bool useOctree = mpOctreeStreamer != NULL &&
+      mpOctreeStreamer->getState() == PointCloudOctreeStreamer::READY;
+   if (mTotalPoints == 0 && !useOctree)
    {
       return;
    }
@@ -1168,7 +1196,14 @@ void PointCloudViewImp::drawContents()
    mpShaderProg->setUniformValue("stretchType", stretchTypeUni); 
    if (success)
    {
-      glDrawArrays(GL_POINTS, 0, mTotalPoints);
+      if (useOctree)
+      {
+         drawOctree();
+      }
+      else
+      {
+         glDrawArrays(GL_POINTS, 0, mTotalPoints);
+      }
    }
    if (mCurrentColorization == POINT_INTENSITY)
    {
@@ -1178,6 +1213,141 @@ void PointCloudViewImp::drawContents()
    mpShaderProg->release();
 }
 
+void PointCloudViewImp::drawOctree()
+{
+   VERIFYNRV(mpOctreeStreamer != NULL && mpShaderProg != NULL);
+   const PointCloudOctree& octree = mpOctreeStreamer->getOctree();
+   const vector<PointCloudOctree::Node>& nodes = octree.getNodes();
+
+   // Upload the nodes which have been read since the last frame
+   map<unsigned int, vector<float> > loadedNodes;
+   mpOctreeStreamer->takeLoadedNodes(loadedNodes);
+   ++mOctreeFrame;
+   for (map<unsigned int, vector<float> >::const_iterator iter = loadedNodes.begin(); iter != loadedNodes.end(); ++iter)
+   {
+      if (iter->second.empty() || mOctreeBuffers.find(iter->first) != mOctreeBuffers.end())
+      {
+         continue;
+      }
+
+      QGLBuffer* pBuffer = new QGLBuffer(QGLBuffer::VertexBuffer);
+      pBuffer->setUsagePattern(QGLBuffer::StaticDraw);
+      if (!pBuffer->create() || !pBuffer->bind())
+      {
+         delete pBuffer;
+         continue;
+      }
+
+      pBuffer->allocate(&iter->second[0], static_cast<int>(iter->second.size() * sizeof(GLfloat)));
+      pBuffer->release();
+      mOctreeBuffers[iter->first] = make_pair(pBuffer, mOctreeFrame);
+      mOctreeBufferPoints += nodes[iter->first].mPointCount;
+   }
+
+   PointCloudOctree::ViewParameters view;
+   glGetDoublev(GL_MODELVIEW_MATRIX, view.mModelMatrix);
+   glGetDoublev(GL_PROJECTION_MATRIX, view.mProjectionMatrix);
+   glGetIntegerv(GL_VIEWPORT, view.mViewport);
+   view.mScale[0] = mScaleFactor;
+   view.mScale[1] = mScaleFactor;
+   view.mScale[2] = mScaleFactor * mZExaggerationFactor;
+
+   // Refine the visible nodes until the points are about one point size apart
+   const unsigned int pointBudget = PointCloudView::getSettingPointBudget();
+   vector<unsigned int> selectedNodes;
+   PointCloudOctree::selectNodes(nodes, view, pointBudget, mPointSize, selectedNodes);
+
+   const int stride = static_cast<int>(PointCloudOctree::FLOATS_PER_POINT * sizeof(GLfloat));
+   const int colorOffset = static_cast<int>((mCurrentColorization == POINT_CLASSIFICATION ? 4 : 3) * sizeof(GLfloat));
+   vector<unsigned int> missingNodes;
+   for (vector<unsigned int>::const_iterator iter = selectedNodes.begin(); iter != selectedNodes.end(); ++iter)
+   {
+      if (nodes[*iter].mPointCount == 0)
+      {
+         continue;
+      }
+
+      map<unsigned int, pair<QGLBuffer*, unsigned int> >::iterator buffer = mOctreeBuffers.find(*iter);
+      if (buffer == mOctreeBuffers.end())
+      {
+         missingNodes.push_back(*iter);
+         continue;
+      }
+
+      buffer->second.second = mOctreeFrame;
+      if (buffer->second.first->bind())
+      {
+         mpShaderProg->setAttributeBuffer(MVERTEX_ATTRIB_NUM, GL_FLOAT, 0, 3, stride);
+         if (mCurrentColorization != POINT_HEIGHT)
+         {
+            mpShaderProg->setAttributeBuffer(MCOLOR_ATTRIB_NUM, GL_FLOAT, colorOffset, 1, stride);
+         }
+
+         glDrawArrays(GL_POINTS, 0, nodes[*iter].mPointCount);
+         buffer->second.first->release();
+      }
+   }
+
+   // Nodes which have not been read are drawn once they are loaded, and the coarser
+   // nodes above them are drawn in the meantime
+   mpOctreeStreamer->request(missingNodes);
+   if (missingNodes.empty() == false)
+   {
+      mpOctreeTimer->start();
+   }
+
+   // Release the least recently drawn nodes once twice the budget is buffered
+   while (mOctreeBufferPoints > 2 * static_cast<uint64_t>(pointBudget))
+   {
+      map<unsigned int, pair<QGLBuffer*, unsigned int> >::iterator oldest = mOctreeBuffers.end();
+      for (map<unsigned int, pair<QGLBuffer*, unsigned int> >::iterator iter = mOctreeBuffers.begin();
+         iter != mOctreeBuffers.end(); ++iter)
+      {
+         if (iter->second.second != mOctreeFrame &&
+            (oldest == mOctreeBuffers.end() || iter->second.second < oldest->second.second))
+         {
+            oldest = iter;
+         }
+      }
+
+      if (oldest == mOctreeBuffers.end())
+      {
+         break;
+      }
+
+      mOctreeBufferPoints -= nodes[oldest->first].mPointCount;
+      delete oldest->second.first;
+      mOctreeBuffers.erase(oldest);
+   }
+}
+
+void PointCloudViewImp::updateOctree()
+{
+   if (mpOctreeStreamer == NULL || mpOctreeStreamer->isBusy() == false)
+   {
+      mpOctreeTimer->stop();
+   }
+
+   if (mpOctreeStreamer != NULL && mpOctreeStreamer->getState() != PointCloudOctreeStreamer::BUILDING)
+   {
+      refresh();
+   }
+}
+
+void PointCloudViewImp::releaseOctree()
+{
+   delete mpOctreeStreamer;
+   mpOctreeStreamer = NULL;
+   for (map<unsigned int, pair<QGLBuffer*, unsigned int> >::iterator iter = mOctreeBuffers.begin();
+      iter != mOctreeBuffers.end(); ++iter)
+   {
+      delete iter->second.first;
+   }
+
+   mOctreeBuffers.clear();
+   mOctreeBufferPoints = 0;
+}
+
 const std::string& PointCloudViewImp::getObjectType() const
 {
    static std::string sType("PointCloudViewImp");
@@ -21,6 +21,8 @@ class QGLBuffer;
 class QGLShader;
 class QGLShaderProgram;
 class QMenu;
+class QTimer;
+class PointCloudOctreeStreamer;
 
 class PointCloudViewImp : public PerspectiveViewImp, public Observer
 {
@@ -80,6 +82,7 @@ protected slots:
    void setStretchType(QAction* pAction);
    void setPointColorizationType(QAction* pAction);
    virtual void zoomExtents();
+   void updateOctree();
 
 protected:
    virtual void drawContents();
@@ -97,6 +100,8 @@ private:
    void updateColorMapTextureIfNeeded();
    void cleanupShaders();
    bool initShaders();
+   void releaseOctree();
+   void drawOctree();
 
    AttachmentPtr<PointCloudElement> mpPrimaryPointCloud;
 
@@ -143,6 +148,14 @@ private:
    double mZExaggerationFactor;
    GLfloat mPointSize;
 
+   // Once the octree is ready, it is drawn instead of the vertex buffer.  Each node's
+   // points are kept in a buffer of x, y, z, intensity and classification values.
+   PointCloudOctreeStreamer* mpOctreeStreamer;
+   std::map<unsigned int, std::pair<QGLBuffer*, unsigned int> > mOctreeBuffers;
+   uint64_t mOctreeBufferPoints;
+   unsigned int mOctreeFrame;
+   QTimer* mpOctreeTimer;
+
    int mMouseY;
    bool mMouseActive;
 };
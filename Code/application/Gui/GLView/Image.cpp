@@ -8,7 +8,9 @@
  */
 
 #include "AppVerify.h"
+#include "bthread.h"
 #include "DataAccessorImpl.h"
+#include "DMutex.h"
 #include "DrawUtil.h"
 #include "Image.h"
 #include "MathUtil.h"
@@ -21,6 +23,7 @@
 #include "Tile.h"
 #include "UtilityServicesImp.h"
 
+#include <deque>
 #include <limits>
 #include <math.h>
 
@@ -38,6 +41,7 @@ Image::Image() :
    mNumTilesY(0),
    mpTiles(NULL),
    mAlpha(255),
+   mpPrefetcher(NULL),
    mColorMapChanged(false)
 {}
 
@@ -344,6 +348,8 @@ void Image::initialize(int sizeX, int sizeY, DimensionDescriptor band1, Dimensio
 
 Image::~Image()
 {
+   delete mpPrefetcher;
+
    if (mInfo.mpExponentialMultipliers != NULL)
    {
       delete [] mInfo.mpExponentialMultipliers;
@@ -417,6 +423,13 @@ void Image::draw(GLfloat textureMode)
    vector<Tile*> tilesToDraw = getTilesToDraw();
    vector<Tile*> tilesToUpdate = getTilesToUpdate(tilesToDraw, tileZoomIndices);
 
+   mDrawnTileZoomIndices.clear();
+   for (vector<Tile*>::const_iterator iter = tilesToDraw.begin(); iter != tilesToDraw.end(); ++iter)
+   {
+      mDrawnTileZoomIndices.push_back((*iter)->getTextureIndex());
+   }
+
+   usePrefetchedTiles(tilesToUpdate, tileZoomIndices);
    if (tilesToUpdate.empty() == false)
    {
       updateTiles(tilesToUpdate, tileZoomIndices);
@@ -499,7 +512,7 @@ public:
       mTiles(input.mTiles),
       mTileZoomIndices(input.mTileZoomIndices),
       mInfo(input.mInfo),
-      mTileRange(getThreadRange(threadCount, mTiles.size()))
+      mThreadCount(threadCount)
    {
    }
    virtual ~TileThread() {};
@@ -509,10 +522,13 @@ private:
    vector<Tile*>& mTiles;
    vector<unsigned int>& mTileZoomIndices;
    Image::ImageData& mInfo;
+   int mThreadCount;
    Range mTileRange;
 
    TileThread& operator=(const TileThread& rhs);
 
+   void createTiles();
+
    // grayscale, channel specifies the band to display
    template <class T>
    void createGrayscale(T* pData, ComplexComponent component)
@@ -1085,6 +1101,14 @@ private:
 };
 
 void TileThread::run()
+{
+   while (getNextRange(mThreadCount, static_cast<int>(mTiles.size()), mTileRange))
+   {
+      createTiles();
+   }
+}
+
+void TileThread::createTiles()
 {
    if (mInfo.mKey.mStretchPoints2.size() == 0) // grayscale or colormap
    {
@@ -1103,6 +1127,486 @@ void TileThread::run()
    }
 }
 
+namespace
+{
+   unsigned int getTextureBytes(GLenum format, int texSizeX, int texSizeY, unsigned int zoomIndex)
+   {
+      unsigned int channels = 1;
+      if (format == GL_RGB || format == GL_BGR)
+      {
+         channels = 3;
+      }
+      else if (format == GL_RGBA || format == GL_BGRA)
+      {
+         channels = 4;
+      }
+      else if (format == GL_LUMINANCE_ALPHA)
+      {
+         channels = 2;
+      }
+
+      const int factor = Tile::computeReductionFactor(zoomIndex);
+      return static_cast<unsigned int>((texSizeX / factor) * (texSizeY / factor)) * channels;
+   }
+
+   /**
+    * A tile which keeps the generated texture data in memory instead of
+    * creating a texture, so it can be generated without a GL context.
+    */
+   class PrefetchTile : public Tile
+   {
+   public:
+      PrefetchTile(unsigned int tileIndex, const volatile bool& cancelled) :
+         mTileIndex(tileIndex),
+         mCancelled(cancelled)
+      {
+      }
+
+      unsigned int getTileIndex() const
+      {
+         return mTileIndex;
+      }
+
+      bool isTextureReady(unsigned int index) const
+      {
+         // Report the remaining tiles as ready once the prefetch is cancelled so they are skipped
+         return mCancelled || mData.find(index) != mData.end();
+      }
+
+      void setupTexture(unsigned int index, unsigned char* pTextureData)
+      {
+         if (pTextureData == NULL || mData.find(index) != mData.end())
+         {
+            return;
+         }
+
+         LocationType texSize = getTexSize();
+         unsigned int bytes = getTextureBytes(getTexFormat(), static_cast<int>(texSize.mX),
+            static_cast<int>(texSize.mY), index);
+         mData[index].assign(pTextureData, pTextureData + bytes);
+      }
+
+      map<unsigned int, vector<unsigned char> >& getData()
+      {
+         return mData;
+      }
+
+   private:
+      PrefetchTile& operator=(const PrefetchTile& rhs);
+
+      unsigned int mTileIndex;
+      const volatile bool& mCancelled;
+      map<unsigned int, vector<unsigned char> > mData;
+   };
+}
+
+/**
+ * Generates the tiles of upcoming frames on a background thread.
+ *
+ * Each frame is generated with the same TileThread code used by Image::updateTiles(),
+ * using tiles which keep the texture data in memory.  The data is kept until Image
+ * takes it to set up the texture of the real tile, which must be done on the thread
+ * that owns the GL context.
+ */
+class ImagePrefetcher
+{
+public:
+   class TileRequest
+   {
+   public:
+      unsigned int mTileIndex;
+      unsigned int mZoomIndex;
+      int mPosX;
+      int mPosY;
+      int mGeomSizeX;
+      int mGeomSizeY;
+   };
+
+   class Job
+   {
+   public:
+      Job() :
+         mInfo(0, DimensionDescriptor(), DimensionDescriptor(), DimensionDescriptor(), LINEAR, vector<double>(),
+            vector<double>(), vector<double>(), vector<ColorType>(), COMPLEX_MAGNITUDE, GL_LUMINANCE, NULL, NULL,
+            NULL, NULL, NULL, NULL)
+      {
+      }
+
+      Job(const Job& rhs) :
+         mInfo(rhs.mInfo.mKey.mChannels, rhs.mInfo.mKey.mBand1, rhs.mInfo.mKey.mBand2, rhs.mInfo.mKey.mBand3,
+            rhs.mInfo.mKey.mType, rhs.mInfo.mKey.mStretchPoints1, rhs.mInfo.mKey.mStretchPoints2,
+            rhs.mInfo.mKey.mStretchPoints3, rhs.mInfo.mKey.mColorMap, rhs.mInfo.mKey.mComponent,
+            rhs.mInfo.mKey.mFormat, rhs.mInfo.mKey.mpRasterElement[0], rhs.mInfo.mKey.mpRasterElement[1],
+            rhs.mInfo.mKey.mpRasterElement[2], rhs.mInfo.mKey.mpBadValues1, rhs.mInfo.mKey.mpBadValues2,
+            rhs.mInfo.mKey.mpBadValues3),
+         mTiles(rhs.mTiles)
+      {
+         copyLayout(rhs.mInfo);
+      }
+
+      Job& operator=(const Job& rhs)
+      {
+         if (this != &rhs)
+         {
+            mInfo = rhs.mInfo;
+            copyLayout(rhs.mInfo);
+            mTiles = rhs.mTiles;
+         }
+
+         return *this;
+      }
+
+      // Copies everything but the key and the scaling tables, which are created for each generated frame
+      void copyLayout(const Image::ImageData& info)
+      {
+         mInfo.mTileSizeX = info.mTileSizeX;
+         mInfo.mTileSizeY = info.mTileSizeY;
+         mInfo.mImageSizeX = info.mImageSizeX;
+         mInfo.mImageSizeY = info.mImageSizeY;
+         mInfo.mRawType[0] = info.mRawType[0];
+         mInfo.mRawType[1] = info.mRawType[1];
+         mInfo.mRawType[2] = info.mRawType[2];
+         mInfo.mFormat = info.mFormat;
+         mInfo.mpData = info.mpData;
+      }
+
+      Image::ImageData mInfo;
+      vector<TileRequest> mTiles;
+   };
+
+   ImagePrefetcher() :
+      mThreadHandle(static_cast<void*>(this), reinterpret_cast<void*>(ImagePrefetcher::threadFunction)),
+      mMaxBytes(0),
+      mCachedBytes(0),
+      mUseCount(0),
+      mPrefetchedTiles(0),
+      mEvictedTiles(0),
+      mBusy(false),
+      mCancelled(false),
+      mStop(false)
+   {
+      mThreadHandle.ThreadLaunch();
+   }
+
+   ~ImagePrefetcher()
+   {
+      {
+         mta::MutexLock lock(mMutex);
+         mJobs.clear();
+         mCancelled = true;
+         mStop = true;
+         mJobsQueued.ThreadSignalActivate();
+      }
+
+      mThreadHandle.ThreadWait();
+   }
+
+   void request(const vector<Job>& jobs, size_t maxBytes)
+   {
+      mta::MutexLock lock(mMutex);
+      mJobs.assign(jobs.begin(), jobs.end());
+      mMaxBytes = maxBytes;
+
+      mRequestedKeys.clear();
+      for (vector<Job>::const_iterator iter = jobs.begin(); iter != jobs.end(); ++iter)
+      {
+         mRequestedKeys.push_back(iter->mInfo.mKey);
+      }
+
+      mJobsQueued.ThreadSignalActivate();
+   }
+
+   void cancel()
+   {
+      mta::MutexLock lock(mMutex);
+      mJobs.clear();
+      mRequestedKeys.clear();
+
+      // The frame being generated may reference data which is about to be destroyed
+      mCancelled = true;
+      while (mBusy)
+      {
+         mJobsDone.ThreadSignalWait(&mMutex);
+      }
+      mCancelled = false;
+
+      for (map<ImageKey, Frame>::const_iterator iter = mFrames.begin(); iter != mFrames.end(); ++iter)
+      {
+         mEvictedTiles += static_cast<unsigned int>(iter->second.mTiles.size());
+      }
+      mFrames.clear();
+      mCachedBytes = 0;
+   }
+
+   void wait()
+   {
+      mta::MutexLock lock(mMutex);
+      while (mBusy || mJobs.empty() == false)
+      {
+         mJobsDone.ThreadSignalWait(&mMutex);
+      }
+   }
+
+   bool take(const ImageKey& key, unsigned int tileIndex, unsigned int zoomIndex, vector<unsigned char>& data)
+   {
+      mta::MutexLock lock(mMutex);
+      map<ImageKey, Frame>::iterator frame = mFrames.find(key);
+      if (frame == mFrames.end())
+      {
+         return false;
+      }
+
+      map<pair<unsigned int, unsigned int>, vector<unsigned char> >::iterator tile =
+         frame->second.mTiles.find(make_pair(tileIndex, zoomIndex));
+      if (tile == frame->second.mTiles.end())
+      {
+         return false;
+      }
+
+      data.swap(tile->second);
+      frame->second.mTiles.erase(tile);
+      frame->second.mBytes -= data.size();
+      mCachedBytes -= data.size();
+      if (frame->second.mTiles.empty())
+      {
+         mFrames.erase(frame);
+      }
+
+      return true;
+   }
+
+   void getCounts(unsigned int& prefetchedTiles, unsigned int& evictedTiles) const
+   {
+      mta::MutexLock lock(mMutex);
+      prefetchedTiles = mPrefetchedTiles;
+      evictedTiles = mEvictedTiles;
+   }
+
+   void resetCounts()
+   {
+      mta::MutexLock lock(mMutex);
+      mPrefetchedTiles = 0;
+      mEvictedTiles = 0;
+   }
+
+private:
+   class Frame
+   {
+   public:
+      Frame() :
+         mBytes(0),
+         mLastUse(0)
+      {
+      }
+
+      map<pair<unsigned int, unsigned int>, vector<unsigned char> > mTiles;
+      size_t mBytes;
+      unsigned int mLastUse;
+   };
+
+   ImagePrefetcher(const ImagePrefetcher& rhs);
+   ImagePrefetcher& operator=(const ImagePrefetcher& rhs);
+
+   static void threadFunction(ImagePrefetcher* pPrefetcher)
+   {
+      if (pPrefetcher != NULL)
+      {
+         pPrefetcher->generateFrames();
+      }
+   }
+
+   bool isRequested(const ImageKey& key) const
+   {
+      for (vector<ImageKey>::const_iterator iter = mRequestedKeys.begin(); iter != mRequestedKeys.end(); ++iter)
+      {
+         if (*iter == key)
+         {
+            return true;
+         }
+      }
+
+      return false;
+   }
+
+   // Must be called with the mutex locked
+   bool makeRoom(size_t bytes)
+   {
+      while (mCachedBytes + bytes > mMaxBytes)
+      {
+         // Discard the least recently generated frame which is no longer requested
+         map<ImageKey, Frame>::iterator oldest = mFrames.end();
+         for (map<ImageKey, Frame>::iterator iter = mFrames.begin(); iter != mFrames.end(); ++iter)
+         {
+            if (isRequested(iter->first) == false &&
+               (oldest == mFrames.end() || iter->second.mLastUse < oldest->second.mLastUse))
+            {
+               oldest = iter;
+            }
+         }
+
+         if (oldest == mFrames.end())
+         {
+            return false;
+         }
+
+         mEvictedTiles += static_cast<unsigned int>(oldest->second.mTiles.size());
+         mCachedBytes -= oldest->second.mBytes;
+         mFrames.erase(oldest);
+      }
+
+      return true;
+   }
+
+   void generateFrames()
+   {
+      mMutex.MutexLock();
+      for (;;)
+      {
+         while (mJobs.empty() && mStop == false)
+         {
+            mJobsQueued.ThreadSignalWait(&mMutex);
+         }
+
+         if (mStop)
+         {
+            break;
+         }
+
+         Job job = mJobs.front();
+         mJobs.pop_front();
+
+         // Skip the tiles which are already cached
+         map<ImageKey, Frame>::iterator cached = mFrames.find(job.mInfo.mKey);
+         vector<TileRequest> requests;
+         size_t bytes = 0;
+         for (vector<TileRequest>::const_iterator iter = job.mTiles.begin(); iter != job.mTiles.end(); ++iter)
+         {
+            if (cached == mFrames.end() ||
+               cached->second.mTiles.find(make_pair(iter->mTileIndex, iter->mZoomIndex)) ==
+               cached->second.mTiles.end())
+            {
+               requests.push_back(*iter);
+               bytes += getTextureBytes(job.mInfo.mFormat, job.mInfo.mTileSizeX, job.mInfo.mTileSizeY,
+                  iter->mZoomIndex);
+            }
+         }
+
+         if (cached != mFrames.end())
+         {
+            cached->second.mLastUse = ++mUseCount;
+         }
+
+         if (requests.empty())
+         {
+            mJobsDone.ThreadSignalBroadcast();
+            continue;
+         }
+
+         // Later frames are needed after this one, so stop once the cache is full
+         if (makeRoom(bytes) == false)
+         {
+            mJobs.clear();
+            mJobsDone.ThreadSignalBroadcast();
+            continue;
+         }
+
+         mBusy = true;
+         mMutex.MutexUnlock();
+
+         vector<PrefetchTile*> tiles;
+         vector<Tile*> tilesToUpdate;
+         vector<unsigned int> tileZoomIndices;
+         for (vector<TileRequest>::const_iterator iter = requests.begin(); iter != requests.end(); ++iter)
+         {
+            PrefetchTile* pTile = new PrefetchTile(iter->mTileIndex, mCancelled);
+            pTile->setTexFormat(job.mInfo.mFormat);
+            pTile->setTexSize(job.mInfo.mTileSizeX, job.mInfo.mTileSizeY);
+            pTile->setGeomSize(iter->mGeomSizeX, iter->mGeomSizeY);
+            pTile->setPos(iter->mPosX, iter->mPosY);
+            tiles.push_back(pTile);
+            tilesToUpdate.push_back(pTile);
+            tileZoomIndices.push_back(iter->mZoomIndex);
+         }
+
+         // Create the scaling tables before the tile threads start so they are not created by each thread
+         Image::ImageData& info = job.mInfo;
+         const int maxValue = info.mKey.mColorMap.empty() ? 255 : static_cast<int>(info.mKey.mColorMap.size()) - 1;
+         ScaleStruct scaleData;
+         Image::prepareScale(info, info.mKey.mStretchPoints1, scaleData, 0, maxValue);
+         if (info.mKey.mStretchPoints2.empty() == false)
+         {
+            Image::prepareScale(info, info.mKey.mStretchPoints2, scaleData, 1, maxValue);
+            Image::prepareScale(info, info.mKey.mStretchPoints3, scaleData, 2, maxValue);
+         }
+
+         // Commands run by the tiling threads are executed on this thread, which has no GL context,
+         // so the tiles only copy the texture data
+         TileInput tileInput(tilesToUpdate, tileZoomIndices, info);
+         TileOutput tileOutput;
+         mta::MultiThreadedAlgorithm<TileInput, TileOutput, TileThread> tilingAlgorithm(
+            getNumRequiredThreads(tilesToUpdate.size()), tileInput, tileOutput, NULL, mta::DYNAMIC_SCHEDULING);
+         tilingAlgorithm.run();
+
+         delete [] info.mpExponentialMultipliers;
+         delete [] info.mpLogarithmicMultipliers;
+         for (int i = 0; i < 3; ++i)
+         {
+            delete [] info.mpEqualizationValues[i];
+         }
+
+         mMutex.MutexLock();
+         if (mCancelled == false)
+         {
+            Frame& frame = mFrames[info.mKey];
+            frame.mLastUse = ++mUseCount;
+            for (vector<PrefetchTile*>::iterator iter = tiles.begin(); iter != tiles.end(); ++iter)
+            {
+               map<unsigned int, vector<unsigned char> >& data = (*iter)->getData();
+               for (map<unsigned int, vector<unsigned char> >::iterator dataIter = data.begin();
+                  dataIter != data.end(); ++dataIter)
+               {
+                  vector<unsigned char>& target = frame.mTiles[make_pair((*iter)->getTileIndex(), dataIter->first)];
+                  target.swap(dataIter->second);
+                  frame.mBytes += target.size();
+                  mCachedBytes += target.size();
+                  ++mPrefetchedTiles;
+               }
+            }
+
+            if (frame.mTiles.empty())
+            {
+               mFrames.erase(info.mKey);
+            }
+         }
+
+         for (vector<PrefetchTile*>::iterator iter = tiles.begin(); iter != tiles.end(); ++iter)
+         {
+            delete *iter;
+         }
+
+         mBusy = false;
+         mJobsDone.ThreadSignalBroadcast();
+      }
+      mMutex.MutexUnlock();
+   }
+
+   BThread mThreadHandle;
+   mutable mta::DMutex mMutex;
+   mta::DThreadSignal mJobsQueued;
+   mta::DThreadSignal mJobsDone;
+   deque<Job> mJobs;
+   vector<ImageKey> mRequestedKeys;
+   map<ImageKey, Frame> mFrames;
+   size_t mMaxBytes;
+   size_t mCachedBytes;
+   unsigned int mUseCount;
+   unsigned int mPrefetchedTiles;
+   unsigned int mEvictedTiles;
+   bool mBusy;
+   volatile bool mCancelled;
+   bool mStop;
+};
+
 void Image::updateTiles(vector<Tile*>& tilesToUpdate, vector<unsigned int>& tileZoomIndices)
 {
    TileInput tileInput(tilesToUpdate, tileZoomIndices, mInfo);
@@ -1116,8 +1620,10 @@ void Image::updateTiles(vector<Tile*>& tilesToUpdate, vector<unsigned int>& tile
       pReporter = &barReporter;
    }
 
+   // Tiles which are already textured or hit the pager cache cost far less than the others,
+   // so the tiles are scheduled dynamically
    mta::MultiThreadedAlgorithm<TileInput, TileOutput, TileThread> tilingAlgorithm
-      (getNumRequiredThreads(tilesToUpdate.size()), tileInput, tileOutput, pReporter);
+      (getNumRequiredThreads(tilesToUpdate.size()), tileInput, tileOutput, pReporter, mta::DYNAMIC_SCHEDULING);
    tilingAlgorithm.run();
 }
 
@@ -1292,6 +1798,7 @@ void Image::setActiveTileSet(const ImageKey &key)
          }
          mTileSets.erase(oldest);
       }
+      ++mCacheStatistics.mTileSetMisses;
       TileSet tileSet;
       mTileSets.insert(std::pair<const ImageKey, TileSet>(key, tileSet));
       it = mTileSets.find(key);
@@ -1300,6 +1807,11 @@ void Image::setActiveTileSet(const ImageKey &key)
    else
    {
       TileSet& tileSet = (*it).second;
+      if (mpTiles != &(tileSet.getTiles()))
+      {
+         ++mCacheStatistics.mTileSetHits;
+      }
+
       mpTiles = &(tileSet.getTiles());
       tileSet.updateId();
    }
@@ -1506,6 +2018,7 @@ vector<Tile*> Image::getTilesToDraw()
 
    vector<Tile*> tilesToDraw;
    tilesToDraw.reserve(numTiles);
+   mDrawnTileIndices.clear();
 
    for (int ii = 0; ii < numTiles; ++ii)
    {
@@ -1520,6 +2033,7 @@ vector<Tile*> Image::getTilesToDraw()
          if ((left <= visEndColumn) && (right >= visStartColumn) && (bottom <= visEndRow) && (top >= visStartRow))
          {
             tilesToDraw.push_back(pTile);
+            mDrawnTileIndices.push_back(ii);
          }
       }
    }
@@ -1559,3 +2073,151 @@ void Image::setColorMapChanged(bool changed)
 {
    mColorMapChanged = changed;
 }
+
+unsigned int Image::getTileIndex(const Tile* pTile) const
+{
+   LocationType pos = pTile->getPos();
+   return (static_cast<unsigned int>(pos.mY) / mInfo.mTileSizeY) * mNumTilesX +
+      static_cast<unsigned int>(pos.mX) / mInfo.mTileSizeX;
+}
+
+void Image::prefetch(const vector<PrefetchFrame>& frames, size_t maxCacheBytes)
+{
+   if (mDrawnTileIndices.empty() || mDrawnTileIndices.size() != mDrawnTileZoomIndices.size())
+   {
+      return;
+   }
+
+   if (mpPrefetcher == NULL)
+   {
+      mpPrefetcher = new ImagePrefetcher();
+   }
+
+   vector<ImagePrefetcher::Job> jobs;
+   for (vector<PrefetchFrame>::const_iterator frame = frames.begin(); frame != frames.end(); ++frame)
+   {
+      if (frame->mKey == mInfo.mKey)
+      {
+         continue;
+      }
+
+      ImagePrefetcher::Job job;
+      job.mInfo.mKey = frame->mKey;
+      job.copyLayout(mInfo);
+      job.mInfo.mFormat = frame->mFormat;
+
+      // Tiles which were generated the last time the frame was displayed do not need to be prefetched
+      const vector<Tile*>* pTiles = NULL;
+      map<ImageKey, TileSet>::const_iterator tileSet = mTileSets.find(frame->mKey);
+      if (tileSet != mTileSets.end())
+      {
+         pTiles = &(tileSet->second.getTiles());
+      }
+
+      for (unsigned int i = 0; i < mDrawnTileIndices.size(); ++i)
+      {
+         const unsigned int tileIndex = mDrawnTileIndices[i];
+         const unsigned int zoomIndex = mDrawnTileZoomIndices[i];
+         if (pTiles != NULL && tileIndex < pTiles->size() && pTiles->at(tileIndex) != NULL &&
+            pTiles->at(tileIndex)->isTextureReady(zoomIndex))
+         {
+            continue;
+         }
+
+         const int column = static_cast<int>(tileIndex) % mNumTilesX;
+         const int row = static_cast<int>(tileIndex) / mNumTilesX;
+
+         ImagePrefetcher::TileRequest request;
+         request.mTileIndex = tileIndex;
+         request.mZoomIndex = zoomIndex;
+         request.mPosX = column * mInfo.mTileSizeX;
+         request.mPosY = row * mInfo.mTileSizeY;
+         request.mGeomSizeX = mInfo.mTileSizeX;
+         request.mGeomSizeY = mInfo.mTileSizeY;
+         if (column == mNumTilesX - 1)
+         {
+            request.mGeomSizeX = mInfo.mImageSizeX - ((mNumTilesX - 1) * mInfo.mTileSizeX);
+         }
+
+         if (row == mNumTilesY - 1)
+         {
+            request.mGeomSizeY = mInfo.mImageSizeY - ((mNumTilesY - 1) * mInfo.mTileSizeY);
+         }
+
+         job.mTiles.push_back(request);
+      }
+
+      if (job.mTiles.empty() == false)
+      {
+         jobs.push_back(job);
+      }
+   }
+
+   mpPrefetcher->request(jobs, maxCacheBytes);
+}
+
+void Image::cancelPrefetch()
+{
+   if (mpPrefetcher != NULL)
+   {
+      mpPrefetcher->cancel();
+   }
+}
+
+void Image::waitForPrefetch()
+{
+   if (mpPrefetcher != NULL)
+   {
+      mpPrefetcher->wait();
+   }
+}
+
+void Image::usePrefetchedTiles(vector<Tile*>& tilesToUpdate, vector<unsigned int>& tileZoomIndices)
+{
+   if (mpPrefetcher == NULL)
+   {
+      return;
+   }
+
+   vector<Tile*> remainingTiles;
+   vector<unsigned int> remainingZoomIndices;
+   vector<unsigned char> data;
+   for (unsigned int i = 0; i < tilesToUpdate.size(); ++i)
+   {
+      Tile* pTile = tilesToUpdate[i];
+      if (mpPrefetcher->take(mInfo.mKey, getTileIndex(pTile), tileZoomIndices[i], data) && data.empty() == false)
+      {
+         pTile->setupTexture(tileZoomIndices[i], &data[0]);
+         ++mCacheStatistics.mPrefetchHits;
+      }
+      else
+      {
+         remainingTiles.push_back(pTile);
+         remainingZoomIndices.push_back(tileZoomIndices[i]);
+         ++mCacheStatistics.mPrefetchMisses;
+      }
+   }
+
+   tilesToUpdate.swap(remainingTiles);
+   tileZoomIndices.swap(remainingZoomIndices);
+}
+
+Image::CacheStatistics Image::getCacheStatistics() const
+{
+   CacheStatistics statistics = mCacheStatistics;
+   if (mpPrefetcher != NULL)
+   {
+      mpPrefetcher->getCounts(statistics.mPrefetchedTiles, statistics.mEvictedTiles);
+   }
+
+   return statistics;
+}
+
+void Image::resetCacheStatistics()
+{
+   mCacheStatistics = CacheStatistics();
+   if (mpPrefetcher != NULL)
+   {
+      mpPrefetcher->resetCounts();
+   }
+}
@@ -22,6 +22,7 @@
 #include <vector>
 #include <map>
 
+class ImagePrefetcher;
 class RasterElement;
 class Tile;
 
@@ -496,6 +497,7 @@ class Image
 {
 #ifdef CPPTESTS // allow testing of image rendering
    friend class FilterRedrawTestCase;
+   friend class AnimationPrefetchTestCase;
 #endif
 
 public:
@@ -579,6 +581,52 @@ public:
       }
    };
 
+   /**
+    * Identifies the tile set of an animation frame which should be generated
+    * before it is displayed.
+    */
+   class PrefetchFrame
+   {
+   public:
+      PrefetchFrame() :
+         mFormat(GL_LUMINANCE)
+      {
+      }
+
+      PrefetchFrame(const ImageKey& key, GLenum format) :
+         mKey(key),
+         mFormat(format)
+      {
+      }
+
+      ImageKey mKey;
+      GLenum mFormat;   // the texture format which initialize() would be given for the frame
+   };
+
+   /**
+    * Counts how often tile sets and prefetched tiles were reused.
+    */
+   class CacheStatistics
+   {
+   public:
+      CacheStatistics() :
+         mTileSetHits(0),
+         mTileSetMisses(0),
+         mPrefetchHits(0),
+         mPrefetchMisses(0),
+         mPrefetchedTiles(0),
+         mEvictedTiles(0)
+      {
+      }
+
+      unsigned int mTileSetHits;       // a displayed key already had a tile set
+      unsigned int mTileSetMisses;     // a tile set had to be created for a displayed key
+      unsigned int mPrefetchHits;      // a tile texture was set up from prefetched data
+      unsigned int mPrefetchMisses;    // a tile texture had to be generated when it was drawn
+      unsigned int mPrefetchedTiles;   // tiles generated in the background
+      unsigned int mEvictedTiles;      // prefetched tiles discarded before they were drawn
+   };
+
    Image();
 
    // Grayscale
@@ -682,6 +730,38 @@ public:
 
    void setColorMapChanged(bool changed);
 
+   /**
+    * Generates the visible tiles of upcoming animation frames on a background thread.
+    *
+    * The tiles which were drawn most recently are generated for each frame, in
+    * order, until the prefetch cache is full.  Frames which already have textures
+    * are skipped.  Any frames from a previous call which have not been generated
+    * yet are discarded.  The generated data is used when draw() is called for the
+    * frame's key.
+    *
+    * @param  frames
+    *         The frames to generate, nearest first.
+    * @param  maxCacheBytes
+    *         The maximum amount of prefetched tile data to keep.
+    */
+   virtual void prefetch(const std::vector<PrefetchFrame>& frames, size_t maxCacheBytes);
+
+   /**
+    * Stops generating prefetched tiles and discards any prefetched data.
+    *
+    * This must be called before any raster element, statistics or bad values
+    * referenced by a prefetched key are modified or destroyed.
+    */
+   void cancelPrefetch();
+
+   /**
+    * Waits until all requested frames have been prefetched.
+    */
+   void waitForPrefetch();
+
+   CacheStatistics getCacheStatistics() const;
+   void resetCacheStatistics();
+
 protected:
    virtual Tile* createTile() const;
    const std::vector<Tile*>* getActiveTiles() const;
@@ -693,6 +773,7 @@ protected:
    std::vector<Tile*> getTilesToDraw();
    virtual std::vector<Tile*> getTilesToUpdate(const std::vector<Tile*>& tilesToDraw,
       std::vector<unsigned int>& tileZoomIndices);
+   void usePrefetchedTiles(std::vector<Tile*>& tilesToUpdate, std::vector<unsigned int>& tileZoomIndices);
 
    ImageData mInfo;
    bool mColorMapChanged;
@@ -704,6 +785,12 @@ private:
    std::vector<Tile*>* mpTiles;
    unsigned int mAlpha;
    LocationType mDrawCenter;
+   std::vector<unsigned int> mDrawnTileIndices;
+   std::vector<unsigned int> mDrawnTileZoomIndices;
+   ImagePrefetcher* mpPrefetcher;
+   CacheStatistics mCacheStatistics;
+
+   unsigned int getTileIndex(const Tile* pTile) const;
 
    void createTiles();
    static std::vector<ColorType> sDefaultColorMap;
@@ -42,10 +42,17 @@ using namespace std;
 
 XERCES_CPP_NAMESPACE_USE
 
+namespace
+{
+   // The distance in screen pixels within which an object's hit() may return true outside of its bounds
+   const double HIT_TOLERANCE = 20.0;
+}
+
 GraphicGroupImp::GraphicGroupImp(const string& id, GraphicObjectType type, GraphicLayer* pLayer,
                                  LocationType pixelCoord) :
    GraphicObjectImp(id, type, pLayer, pixelCoord),
-   mbNeedsLayout(true)
+   mbNeedsLayout(true),
+   mIndexValid(false)
 {
 }
 
@@ -85,6 +92,25 @@ void GraphicGroupImp::draw(double zoomFactor) const
       const_cast<GraphicGroupImp*>(this)->updateLayout();
    }
 
+   drawObjects(vector<GraphicObject*>(mObjects.begin(), mObjects.end()), zoomFactor);
+}
+
+void GraphicGroupImp::drawRegion(double zoomFactor, const LocationType& llCorner, const LocationType& urCorner) const
+{
+   if (mbNeedsLayout == true)
+   {
+      const_cast<GraphicGroupImp*>(this)->updateLayout();
+   }
+
+   updateIndex();
+
+   vector<GraphicObject*> objects;
+   mIndex.query(llCorner, urCorner, objects);
+   drawObjects(objects, zoomFactor);
+}
+
+void GraphicGroupImp::drawObjects(const vector<GraphicObject*>& objects, double zoomFactor) const
+{
    ViewImp* pParentWidget = NULL;
 
    GraphicLayer* pLayer = getLayer();
@@ -95,12 +121,9 @@ void GraphicGroupImp::draw(double zoomFactor) const
 
    int iBadObjects = 0;
 
-   list<GraphicObject*>::const_iterator iter;
-   iter = mObjects.begin();
-   while (iter != mObjects.end())
+   for (vector<GraphicObject*>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter)
    {
       GraphicObject* pObject = *iter;
-      ++iter;
       GraphicObjectImp* pObjectImp = dynamic_cast<GraphicObjectImp*>(pObject);
       if (pObject != NULL && pObjectImp != NULL)
       {
@@ -200,49 +223,14 @@ void GraphicGroupImp::updateBoundingBox()
          continue;
       }
 
-      LocationType llCorner = pObject->getLlCorner();
-      LocationType urCorner = pObject->getUrCorner();
-      LocationType center((llCorner.mX + urCorner.mX) / 2.0, (llCorner.mY + urCorner.mY) / 2.0);
+      LocationType llCorner;
+      LocationType urCorner;
+      getRotatedBoundingBox(pObject, llCorner, urCorner);
 
-      double angle = pObject->getRotation();
-      double cosTheta = cos(PI / 180.0 * angle);
-      double sinTheta = sin(PI / 180.0 * angle);
-
-      vector<LocationType> corners;
-      corners.push_back(llCorner);
-      corners.push_back(LocationType(llCorner.mX, urCorner.mY));
-      corners.push_back(urCorner);
-      corners.push_back(LocationType(urCorner.mX, llCorner.mY));
-
-      vector<LocationType>::const_iterator pit;
-      for (pit = corners.begin(); pit != corners.end(); ++pit)
-      {
-         LocationType realPoint
-         (
-            center.mX + (pit->mX - center.mX) * cosTheta - (pit->mY - center.mY) * sinTheta,
-            center.mY + (pit->mX - center.mX) * sinTheta + (pit->mY - center.mY) * cosTheta
-         );
-
-         if (realPoint.mX > dMaxX)
-         {
-            dMaxX = realPoint.mX;
-         }
-
-         if (realPoint.mX < dMinX)
-         {
-            dMinX = realPoint.mX;
-         }
-
-         if (realPoint.mY > dMaxY)
-         {
-            dMaxY = realPoint.mY;
-         }
-
-         if (realPoint.mY < dMinY)
-         {
-            dMinY = realPoint.mY;
-         }
-      }
+      dMinX = min(dMinX, llCorner.mX);
+      dMinY = min(dMinY, llCorner.mY);
+      dMaxX = max(dMaxX, urCorner.mX);
+      dMaxY = max(dMaxY, urCorner.mY);
    }
 
    LocationType groupLlCorner;
@@ -359,6 +347,10 @@ void GraphicGroupImp::updateLayout()
 
    for_each(mObjects.begin(), mObjects.end(), ConnectObject(this));
 
+   // The objects were disconnected while they were resized, so rebuild the index
+   mIndexValid = false;
+   mModifiedObjects.clear();
+
    mbNeedsLayout = false;
    mLlCorner = llCorner;
    mUrCorner = urCorner;
@@ -391,8 +383,16 @@ bool GraphicGroupImp::hit(LocationType pixelCoord) const
 
 GraphicObject* GraphicGroupImp::hitObject(const LocationType& pixelCoord) const
 {
-   list<GraphicObject*>::const_reverse_iterator iter;
-   for (iter = mObjects.rbegin(); iter != mObjects.rend(); ++iter)
+   // Only objects whose bounds are near the coordinate can be hit, so test them from the top down
+   updateIndex();
+
+   LocationType tolerance = getHitTolerance(pixelCoord);
+   vector<GraphicObject*> objects;
+   mIndex.query(LocationType(pixelCoord.mX - tolerance.mX, pixelCoord.mY - tolerance.mY),
+      LocationType(pixelCoord.mX + tolerance.mX, pixelCoord.mY + tolerance.mY), objects);
+
+   vector<GraphicObject*>::const_reverse_iterator iter;
+   for (iter = objects.rbegin(); iter != objects.rend(); ++iter)
    {
       GraphicObject* pObject = *iter;
       GraphicObjectImp* pObjectImp = dynamic_cast<GraphicObjectImp*>(pObject);
@@ -612,6 +612,13 @@ void GraphicGroupImp::insertObject(GraphicObject* pObject)
       if (pObject->isVisible())
       {
          mObjects.push_back(pObject);
+         if (mIndexValid == true)
+         {
+            LocationType llCorner;
+            LocationType urCorner;
+            getRotatedBoundingBox(pObject, llCorner, urCorner);
+            mIndex.insert(pObject, llCorner, urCorner);
+         }
       }
       ConnectObject(this)(pObject);
       notify(SIGNAL_NAME(GraphicGroup, ObjectAdded), boost::any(pObject));
@@ -643,6 +650,13 @@ void GraphicGroupImp::insertObjects(const list<GraphicObject*>& objects, Progres
          if (pObject->isVisible())
          {
             mObjects.push_back(pObject);
+            if (mIndexValid == true)
+            {
+               LocationType llCorner;
+               LocationType urCorner;
+               getRotatedBoundingBox(pObject, llCorner, urCorner);
+               mIndex.insert(pObject, llCorner, urCorner);
+            }
          }
 
          ConnectObject(this)(pObject);
@@ -696,6 +710,15 @@ list<GraphicObject*> GraphicGroupImp::getObjects(GraphicObjectType objectType) c
    return objects;
 }
 
+list<GraphicObject*> GraphicGroupImp::getObjects(const LocationType& llCorner, const LocationType& urCorner) const
+{
+   updateIndex();
+
+   vector<GraphicObject*> objects;
+   mIndex.query(llCorner, urCorner, objects);
+   return list<GraphicObject*>(objects.begin(), objects.end());
+}
+
 unsigned int GraphicGroupImp::getNumObjects() const
 {
    return mObjects.size();
@@ -719,6 +742,7 @@ bool GraphicGroupImp::moveObjectToBack(GraphicObject* pObject)
    {
       mObjects.erase(iter);
       mObjects.push_front(pObject);
+      mIndex.moveToBack(pObject);
       return true;
    }
 
@@ -737,6 +761,7 @@ bool GraphicGroupImp::moveObjectToFront(GraphicObject* pObject)
    {
       mObjects.erase(iter);
       mObjects.push_back(pObject);
+      mIndex.moveToFront(pObject);
       return true;
    }
 
@@ -770,6 +795,7 @@ void GraphicGroupImp::setObjectStackingIndex(GraphicObject* pObject, int index)
          index--;
       }
       mObjects.insert(iter, pObject);
+      mIndex.setStackingOrder(mObjects);
    }
 }
 
@@ -791,6 +817,8 @@ bool GraphicGroupImp::removeObject(GraphicObject* pObject, bool bDelete)
    if (it != mObjects.end())
    {
       mObjects.erase(it);
+      mIndex.remove(pObject);
+      mModifiedObjects.erase(pObject);
       DisconnectObject(this)(pObject);
       notify(SIGNAL_NAME(GraphicGroup, ObjectRemoved), boost::any(pObject));
 
@@ -852,6 +880,8 @@ bool GraphicGroupImp::removeObjects(std::unordered_set<GraphicObject*>& objects,
 		{
 			it = mObjects.erase(it);
 			objects.erase(ipObject);
+			mIndex.remove(pObject);
+			mModifiedObjects.erase(pObject);
 			DisconnectObject(this)(pObject);
 			notify(SIGNAL_NAME(GraphicGroup, ObjectRemoved), boost::any(pObject));
 			
@@ -898,6 +928,9 @@ void GraphicGroupImp::removeAllObjects(bool bDelete)
    }
 
    for_each(mObjects.begin(), mObjects.end(), DisconnectObject(this));
+   mIndex.clear();
+   mIndexValid = false;
+   mModifiedObjects.clear();
 
    // Remove each object while iterating the loop to avoid stale pointers within mObjects.
    // The stale pointers can cause crashes if code attached to GraphicGroup, ObjectRemoved calls methods on this class.
@@ -1298,5 +1331,112 @@ void GraphicGroupImp::updateFromProperty(GraphicProperty* pProperty)
       updateBoundingBox();
    }
 
+   if (mIndexValid == true &&
+      (dynamic_cast<BoundingBoxProperty*>(pProperty) != NULL || dynamic_cast<RotationProperty*>(pProperty) != NULL))
+   {
+      GraphicObject* pObject = dynamic_cast<GraphicObject*>(sender());
+      if (pObject != NULL)
+      {
+         mModifiedObjects.insert(pObject);
+      }
+   }
+
    notify(SIGNAL_NAME(GraphicGroup, ObjectChanged), boost::any(pProperty));
 }
+
+void GraphicGroupImp::updateIndex() const
+{
+   if (mIndexValid == false)
+   {
+      mIndex.clear();
+      for (list<GraphicObject*>::const_iterator iter = mObjects.begin(); iter != mObjects.end(); ++iter)
+      {
+         if (*iter != NULL)
+         {
+            LocationType llCorner;
+            LocationType urCorner;
+            getRotatedBoundingBox(*iter, llCorner, urCorner);
+            mIndex.insert(*iter, llCorner, urCorner);
+         }
+      }
+
+      mIndexValid = true;
+   }
+   else
+   {
+      for (set<GraphicObject*>::const_iterator iter = mModifiedObjects.begin(); iter != mModifiedObjects.end(); ++iter)
+      {
+         LocationType llCorner;
+         LocationType urCorner;
+         getRotatedBoundingBox(*iter, llCorner, urCorner);
+         mIndex.update(*iter, llCorner, urCorner);
+      }
+   }
+
+   mModifiedObjects.clear();
+}
+
+LocationType GraphicGroupImp::getHitTolerance(const LocationType& pixelCoord) const
+{
+   LocationType tolerance(1.0, 1.0);
+
+   GraphicLayer* pLayer = getLayer();
+   if (pLayer == NULL || pLayer->getView() == NULL)
+   {
+      return tolerance;
+   }
+
+   // Convert the screen tolerance to the layer's coordinates, which may be scaled or rotated relative to the screen
+   double screenX = 0.0;
+   double screenY = 0.0;
+   pLayer->translateDataToScreen(pixelCoord.mX, pixelCoord.mY, screenX, screenY);
+
+   for (int i = 0; i < 4; ++i)
+   {
+      double dataX = 0.0;
+      double dataY = 0.0;
+      pLayer->translateScreenToData(screenX + ((i & 1) ? HIT_TOLERANCE : -HIT_TOLERANCE),
+         screenY + ((i & 2) ? HIT_TOLERANCE : -HIT_TOLERANCE), dataX, dataY);
+
+      tolerance.mX = max(tolerance.mX, fabs(dataX - pixelCoord.mX));
+      tolerance.mY = max(tolerance.mY, fabs(dataY - pixelCoord.mY));
+   }
+
+   return tolerance;
+}
+
+void GraphicGroupImp::getRotatedBoundingBox(const GraphicObject* pObject, LocationType& llCorner,
+                                            LocationType& urCorner)
+{
+   LocationType objectLlCorner = pObject->getLlCorner();
+   LocationType objectUrCorner = pObject->getUrCorner();
+   LocationType center((objectLlCorner.mX + objectUrCorner.mX) / 2.0, (objectLlCorner.mY + objectUrCorner.mY) / 2.0);
+
+   double angle = pObject->getRotation();
+   double cosTheta = cos(PI / 180.0 * angle);
+   double sinTheta = sin(PI / 180.0 * angle);
+
+   vector<LocationType> corners;
+   corners.push_back(objectLlCorner);
+   corners.push_back(LocationType(objectLlCorner.mX, objectUrCorner.mY));
+   corners.push_back(objectUrCorner);
+   corners.push_back(LocationType(objectUrCorner.mX, objectLlCorner.mY));
+
+   llCorner = LocationType(1e30, 1e30);
+   urCorner = LocationType(-1e30, -1e30);
+
+   vector<LocationType>::const_iterator pit;
+   for (pit = corners.begin(); pit != corners.end(); ++pit)
+   {
+      LocationType realPoint
+      (
+         center.mX + (pit->mX - center.mX) * cosTheta - (pit->mY - center.mY) * sinTheta,
+         center.mY + (pit->mX - center.mX) * sinTheta + (pit->mY - center.mY) * cosTheta
+      );
+
+      llCorner.mX = min(llCorner.mX, realPoint.mX);
+      llCorner.mY = min(llCorner.mY, realPoint.mY);
+      urCorner.mX = max(urCorner.mX, realPoint.mX);
+      urCorner.mY = max(urCorner.mY, realPoint.mY);
+   }
+}
@@ -11,6 +11,7 @@
 #define GRAPHICGROUPIMP_H
 
 #include "GraphicObjectImp.h"
+#include "GraphicObjectIndex.h"
 #include "GraphicProperty.h"
 #include "LocationType.h"
 #include "TypesFile.h"
@@ -18,7 +19,9 @@
 
 #include <string>
 #include <list>
+#include <set>
 #include <unordered_set>
+#include <vector>
 
 class GraphicLayer;
 class Progress;
@@ -34,6 +37,18 @@ public:
    GraphicGroupImp& operator= (const GraphicGroupImp& graphicGroup);
 
    void draw(double zoomFactor) const;
+
+   /**
+    * Draws only the objects whose bounds intersect a region.
+    *
+    * @param zoomFactor
+    *        The zoom factor passed to each object.
+    * @param llCorner
+    *        The minimum corner of the region, in the coordinates of the objects.
+    * @param urCorner
+    *        The maximum corner of the region, in the coordinates of the objects.
+    */
+   void drawRegion(double zoomFactor, const LocationType& llCorner, const LocationType& urCorner) const;
    bool setProperty(const GraphicProperty* pProperty);
    void updateBoundingBox();
    void updateLayout();
@@ -53,6 +68,11 @@ public:
    bool hasObject(GraphicObject* pObject) const;
    const std::list<GraphicObject*>& getObjects() const;
    std::list<GraphicObject*> getObjects(GraphicObjectType objectType) const;
+
+   /**
+    * Returns the objects whose rotated bounds intersect a region, in stacking order.
+    */
+   std::list<GraphicObject*> getObjects(const LocationType& llCorner, const LocationType& urCorner) const;
    unsigned int getNumObjects() const;
    unsigned int getNumObjects(GraphicObjectType objectType) const;
    bool moveObjectToBack(GraphicObject* pObject);
@@ -91,10 +111,22 @@ protected slots:
 
 private:
    GraphicGroupImp(const GraphicGroupImp& rhs);
+
+   void drawObjects(const std::vector<GraphicObject*>& objects, double zoomFactor) const;
+   void updateIndex() const;
+   LocationType getHitTolerance(const LocationType& pixelCoord) const;
+   static void getRotatedBoundingBox(const GraphicObject* pObject, LocationType& llCorner, LocationType& urCorner);
+
    bool mbNeedsLayout;
    LocationType mLlCorner;
    LocationType mUrCorner;
 
+   // The index is built when it is first queried, and objects whose bounds
+   // have changed since the last query are updated before the next one
+   mutable GraphicObjectIndex mIndex;
+   mutable bool mIndexValid;
+   mutable std::set<GraphicObject*> mModifiedObjects;
+
    template<typename T, typename U>
    bool propagateProperty(T method, U value);
 };
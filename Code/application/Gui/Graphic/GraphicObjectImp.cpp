@@ -27,6 +27,7 @@
 #include "ProductView.h"
 #include "PropertiesGraphicObject.h"
 #include "RasterElement.h"
+#include "SignalBatcher.h"
 #include "StringUtilities.h"
 #include "ViewImp.h"
 #include "ViewObjectImp.h"
@@ -87,6 +88,12 @@ bool GraphicObjectImp::replicateObject(const GraphicObject* pObject)
 
    if (this != pExistingObject)
    {
+      // Setting each property notifies Subject::Modified, so only notify once after all properties are set
+      Subject* pSubject = dynamic_cast<Subject*>(this);
+      VERIFY(pSubject != NULL);
+
+      SignalBatcher batcher(*pSubject);
+
       string objectName = pExistingObject->getName();
       setName(objectName);
 
@@ -1358,6 +1365,12 @@ bool GraphicObjectImp::fromXml(DOMNode* pDocument, unsigned int version)
       return false;
    }
 
+   // Setting each property notifies Subject::Modified, so only notify once after all properties are set
+   Subject* pSubject = dynamic_cast<Subject*>(this);
+   VERIFY(pSubject != NULL);
+
+   SignalBatcher batcher(*pSubject);
+
    DOMElement* pElement = static_cast<DOMElement*>(pDocument);
    if (pElement != NULL)
    {
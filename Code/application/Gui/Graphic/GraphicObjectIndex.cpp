@@ -0,0 +1,608 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "GraphicObjectIndex.h"
+
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <utility>
+
+using namespace std;
+
+namespace
+{
+   const unsigned int MAX_ITEMS = 16;
+   const unsigned int MIN_ITEMS = 6;
+}
+
+GraphicObjectIndex::Box::Box() :
+   mMinX(DBL_MAX),
+   mMinY(DBL_MAX),
+   mMaxX(-DBL_MAX),
+   mMaxY(-DBL_MAX)
+{
+}
+
+GraphicObjectIndex::Box::Box(const LocationType& llCorner, const LocationType& urCorner) :
+   mMinX(min(llCorner.mX, urCorner.mX)),
+   mMinY(min(llCorner.mY, urCorner.mY)),
+   mMaxX(max(llCorner.mX, urCorner.mX)),
+   mMaxY(max(llCorner.mY, urCorner.mY))
+{
+}
+
+double GraphicObjectIndex::Box::getArea() const
+{
+   if (mMaxX < mMinX || mMaxY < mMinY)
+   {
+      return 0.0;
+   }
+
+   return (mMaxX - mMinX) * (mMaxY - mMinY);
+}
+
+double GraphicObjectIndex::Box::getEnlargement(const Box& box) const
+{
+   Box merged = *this;
+   merged.merge(box);
+   return merged.getArea() - getArea();
+}
+
+bool GraphicObjectIndex::Box::intersects(const Box& box) const
+{
+   return mMinX <= box.mMaxX && box.mMinX <= mMaxX && mMinY <= box.mMaxY && box.mMinY <= mMaxY;
+}
+
+bool GraphicObjectIndex::Box::contains(const Box& box) const
+{
+   return mMinX <= box.mMinX && box.mMaxX <= mMaxX && mMinY <= box.mMinY && box.mMaxY <= mMaxY;
+}
+
+void GraphicObjectIndex::Box::merge(const Box& box)
+{
+   mMinX = min(mMinX, box.mMinX);
+   mMinY = min(mMinY, box.mMinY);
+   mMaxX = max(mMaxX, box.mMaxX);
+   mMaxY = max(mMaxY, box.mMaxY);
+}
+
+bool GraphicObjectIndex::Box::operator==(const Box& box) const
+{
+   return mMinX == box.mMinX && mMinY == box.mMinY && mMaxX == box.mMaxX && mMaxY == box.mMaxY;
+}
+
+GraphicObjectIndex::Item::Item() :
+   mpChild(NULL),
+   mpObject(NULL)
+{
+}
+
+GraphicObjectIndex::Node::Node(unsigned int level) :
+   mLevel(level),
+   mpParent(NULL)
+{
+}
+
+GraphicObjectIndex::Node::~Node()
+{
+   for (vector<Item>::iterator iter = mItems.begin(); iter != mItems.end(); ++iter)
+   {
+      delete iter->mpChild;
+   }
+}
+
+GraphicObjectIndex::Box GraphicObjectIndex::Node::getBounds() const
+{
+   Box bounds;
+   for (vector<Item>::const_iterator iter = mItems.begin(); iter != mItems.end(); ++iter)
+   {
+      bounds.merge(iter->mBox);
+   }
+
+   return bounds;
+}
+
+void GraphicObjectIndex::Node::addItem(const Item& item)
+{
+   mItems.push_back(item);
+   if (item.mpChild != NULL)
+   {
+      item.mpChild->mpParent = this;
+   }
+}
+
+GraphicObjectIndex::GraphicObjectIndex() :
+   mpRoot(new Node(0)),
+   mTopOrder(0),
+   mBottomOrder(0)
+{
+}
+
+GraphicObjectIndex::~GraphicObjectIndex()
+{
+   delete mpRoot;
+}
+
+void GraphicObjectIndex::insert(GraphicObject* pObject, const LocationType& llCorner, const LocationType& urCorner)
+{
+   if (pObject == NULL || update(pObject, llCorner, urCorner) == true)
+   {
+      return;
+   }
+
+   Record& record = mRecords[pObject];
+   record.mBox = Box(llCorner, urCorner);
+   record.mOrder = ++mTopOrder;
+
+   Item item;
+   item.mBox = record.mBox;
+   item.mpObject = pObject;
+   insertItem(item);
+}
+
+bool GraphicObjectIndex::update(GraphicObject* pObject, const LocationType& llCorner, const LocationType& urCorner)
+{
+   map<GraphicObject*, Record>::iterator record = mRecords.find(pObject);
+   if (record == mRecords.end())
+   {
+      return false;
+   }
+
+   Box box(llCorner, urCorner);
+   if (box == record->second.mBox)
+   {
+      return true;
+   }
+
+   Node* pLeaf = findLeaf(mpRoot, pObject, record->second.mBox);
+   VERIFY(pLeaf != NULL);
+   record->second.mBox = box;
+
+   // An object which stays within its leaf is updated in place so the tree does not have to be restructured
+   Node* pParent = pLeaf->mpParent;
+   if (pParent != NULL)
+   {
+      for (vector<Item>::iterator iter = pParent->mItems.begin(); iter != pParent->mItems.end(); ++iter)
+      {
+         if (iter->mpChild == pLeaf && iter->mBox.contains(box) == false)
+         {
+            pParent = NULL;
+            break;
+         }
+      }
+   }
+
+   if (pLeaf == mpRoot || pParent != NULL)
+   {
+      for (vector<Item>::iterator iter = pLeaf->mItems.begin(); iter != pLeaf->mItems.end(); ++iter)
+      {
+         if (iter->mpObject == pObject)
+         {
+            iter->mBox = box;
+            break;
+         }
+      }
+
+      for (Node* pNode = pLeaf; pNode != mpRoot; pNode = pNode->mpParent)
+      {
+         updateParentBox(pNode);
+      }
+
+      return true;
+   }
+
+   removeItem(pLeaf, pObject);
+
+   Item item;
+   item.mBox = box;
+   item.mpObject = pObject;
+   insertItem(item);
+   return true;
+}
+
+bool GraphicObjectIndex::remove(GraphicObject* pObject)
+{
+   map<GraphicObject*, Record>::iterator record = mRecords.find(pObject);
+   if (record == mRecords.end())
+   {
+      return false;
+   }
+
+   Node* pLeaf = findLeaf(mpRoot, pObject, record->second.mBox);
+   mRecords.erase(record);
+   VERIFY(pLeaf != NULL);
+
+   removeItem(pLeaf, pObject);
+   return true;
+}
+
+void GraphicObjectIndex::clear()
+{
+   delete mpRoot;
+   mpRoot = new Node(0);
+   mRecords.clear();
+   mTopOrder = 0;
+   mBottomOrder = 0;
+}
+
+bool GraphicObjectIndex::contains(GraphicObject* pObject) const
+{
+   return mRecords.find(pObject) != mRecords.end();
+}
+
+unsigned int GraphicObjectIndex::getNumObjects() const
+{
+   return mRecords.size();
+}
+
+bool GraphicObjectIndex::moveToFront(GraphicObject* pObject)
+{
+   map<GraphicObject*, Record>::iterator record = mRecords.find(pObject);
+   if (record == mRecords.end())
+   {
+      return false;
+   }
+
+   record->second.mOrder = ++mTopOrder;
+   return true;
+}
+
+bool GraphicObjectIndex::moveToBack(GraphicObject* pObject)
+{
+   map<GraphicObject*, Record>::iterator record = mRecords.find(pObject);
+   if (record == mRecords.end())
+   {
+      return false;
+   }
+
+   record->second.mOrder = --mBottomOrder;
+   return true;
+}
+
+void GraphicObjectIndex::setStackingOrder(const list<GraphicObject*>& objects)
+{
+   mTopOrder = 0;
+   mBottomOrder = 0;
+   for (list<GraphicObject*>::const_iterator iter = objects.begin(); iter != objects.end(); ++iter)
+   {
+      map<GraphicObject*, Record>::iterator record = mRecords.find(*iter);
+      if (record != mRecords.end())
+      {
+         record->second.mOrder = ++mTopOrder;
+      }
+   }
+}
+
+void GraphicObjectIndex::query(const LocationType& llCorner, const LocationType& urCorner,
+                               vector<GraphicObject*>& objects) const
+{
+   objects.clear();
+
+   Box region(llCorner, urCorner);
+   vector<pair<int64_t, GraphicObject*> > found;
+   vector<const Node*> nodes(1, mpRoot);
+   while (nodes.empty() == false)
+   {
+      const Node* pNode = nodes.back();
+      nodes.pop_back();
+
+      for (vector<Item>::const_iterator iter = pNode->mItems.begin(); iter != pNode->mItems.end(); ++iter)
+      {
+         if (iter->mBox.intersects(region) == true)
+         {
+            if (iter->mpChild != NULL)
+            {
+               nodes.push_back(iter->mpChild);
+            }
+            else
+            {
+               map<GraphicObject*, Record>::const_iterator record = mRecords.find(iter->mpObject);
+               VERIFYNRV(record != mRecords.end());
+               found.push_back(make_pair(record->second.mOrder, iter->mpObject));
+            }
+         }
+      }
+   }
+
+   sort(found.begin(), found.end());
+
+   objects.reserve(found.size());
+   for (vector<pair<int64_t, GraphicObject*> >::const_iterator iter = found.begin(); iter != found.end(); ++iter)
+   {
+      objects.push_back(iter->second);
+   }
+}
+
+void GraphicObjectIndex::insertItem(const Item& item)
+{
+   Node* pLeaf = chooseLeaf(item.mBox);
+   pLeaf->addItem(item);
+
+   Node* pSplit = NULL;
+   if (pLeaf->mItems.size() > MAX_ITEMS)
+   {
+      pSplit = splitNode(pLeaf);
+   }
+
+   adjustTree(pLeaf, pSplit);
+}
+
+GraphicObjectIndex::Node* GraphicObjectIndex::chooseLeaf(const Box& box) const
+{
+   Node* pNode = mpRoot;
+   while (pNode->mLevel > 0)
+   {
+      VERIFYRV(pNode->mItems.empty() == false, mpRoot);
+
+      // Use the child which needs the least enlargement, and then the smallest child
+      vector<Item>::const_iterator best = pNode->mItems.begin();
+      double bestEnlargement = best->mBox.getEnlargement(box);
+      for (vector<Item>::const_iterator iter = best + 1; iter != pNode->mItems.end(); ++iter)
+      {
+         double enlargement = iter->mBox.getEnlargement(box);
+         if (enlargement < bestEnlargement ||
+            (enlargement == bestEnlargement && iter->mBox.getArea() < best->mBox.getArea()))
+         {
+            best = iter;
+            bestEnlargement = enlargement;
+         }
+      }
+
+      pNode = best->mpChild;
+   }
+
+   return pNode;
+}
+
+GraphicObjectIndex::Node* GraphicObjectIndex::splitNode(Node* pNode)
+{
+   // Quadratic split: start with the two items which would waste the most area if grouped together
+   vector<Item> items;
+   items.swap(pNode->mItems);
+
+   unsigned int seed1 = 0;
+   unsigned int seed2 = 1;
+   double maxWaste = -DBL_MAX;
+   for (unsigned int i = 0; i < items.size(); ++i)
+   {
+      for (unsigned int j = i + 1; j < items.size(); ++j)
+      {
+         Box merged = items[i].mBox;
+         merged.merge(items[j].mBox);
+
+         double waste = merged.getArea() - items[i].mBox.getArea() - items[j].mBox.getArea();
+         if (waste > maxWaste)
+         {
+            maxWaste = waste;
+            seed1 = i;
+            seed2 = j;
+         }
+      }
+   }
+
+   Node* pSplit = new Node(pNode->mLevel);
+   pNode->addItem(items[seed1]);
+   pSplit->addItem(items[seed2]);
+   Box bounds1 = items[seed1].mBox;
+   Box bounds2 = items[seed2].mBox;
+
+   items.erase(items.begin() + seed2);
+   items.erase(items.begin() + seed1);
+
+   while (items.empty() == false)
+   {
+      // Give the remaining items to a node which would otherwise have too few
+      if (pNode->mItems.size() + items.size() <= MIN_ITEMS || pSplit->mItems.size() + items.size() <= MIN_ITEMS)
+      {
+         Node* pTarget = (pNode->mItems.size() < pSplit->mItems.size() ? pNode : pSplit);
+         for (vector<Item>::const_iterator iter = items.begin(); iter != items.end(); ++iter)
+         {
+            pTarget->addItem(*iter);
+         }
+
+         break;
+      }
+
+      // Assign the item with the strongest preference for one of the nodes
+      unsigned int next = 0;
+      double maxDifference = -1.0;
+      for (unsigned int i = 0; i < items.size(); ++i)
+      {
+         double difference = fabs(bounds1.getEnlargement(items[i].mBox) - bounds2.getEnlargement(items[i].mBox));
+         if (difference > maxDifference)
+         {
+            maxDifference = difference;
+            next = i;
+         }
+      }
+
+      const Item& item = items[next];
+      double enlargement1 = bounds1.getEnlargement(item.mBox);
+      double enlargement2 = bounds2.getEnlargement(item.mBox);
+
+      bool useFirst = enlargement1 < enlargement2;
+      if (enlargement1 == enlargement2)
+      {
+         double area1 = bounds1.getArea();
+         double area2 = bounds2.getArea();
+         useFirst = (area1 < area2 || (area1 == area2 && pNode->mItems.size() <= pSplit->mItems.size()));
+      }
+
+      if (useFirst == true)
+      {
+         pNode->addItem(item);
+         bounds1.merge(item.mBox);
+      }
+      else
+      {
+         pSplit->addItem(item);
+         bounds2.merge(item.mBox);
+      }
+
+      items.erase(items.begin() + next);
+   }
+
+   return pSplit;
+}
+
+void GraphicObjectIndex::adjustTree(Node* pNode, Node* pSplit)
+{
+   while (pNode != mpRoot)
+   {
+      Node* pParent = pNode->mpParent;
+      updateParentBox(pNode);
+
+      if (pSplit != NULL)
+      {
+         Item item;
+         item.mBox = pSplit->getBounds();
+         item.mpChild = pSplit;
+         pParent->addItem(item);
+
+         pSplit = NULL;
+         if (pParent->mItems.size() > MAX_ITEMS)
+         {
+            pSplit = splitNode(pParent);
+         }
+      }
+
+      pNode = pParent;
+   }
+
+   if (pSplit != NULL)
+   {
+      Node* pRoot = new Node(mpRoot->mLevel + 1);
+
+      Item item;
+      item.mBox = mpRoot->getBounds();
+      item.mpChild = mpRoot;
+      pRoot->addItem(item);
+
+      item.mBox = pSplit->getBounds();
+      item.mpChild = pSplit;
+      pRoot->addItem(item);
+
+      mpRoot = pRoot;
+   }
+}
+
+GraphicObjectIndex::Node* GraphicObjectIndex::findLeaf(Node* pNode, GraphicObject* pObject, const Box& box) const
+{
+   for (vector<Item>::const_iterator iter = pNode->mItems.begin(); iter != pNode->mItems.end(); ++iter)
+   {
+      if (pNode->mLevel == 0)
+      {
+         if (iter->mpObject == pObject)
+         {
+            return pNode;
+         }
+      }
+      else if (iter->mBox.contains(box) == true)
+      {
+         Node* pLeaf = findLeaf(iter->mpChild, pObject, box);
+         if (pLeaf != NULL)
+         {
+            return pLeaf;
+         }
+      }
+   }
+
+   return NULL;
+}
+
+void GraphicObjectIndex::removeItem(Node* pLeaf, GraphicObject* pObject)
+{
+   for (vector<Item>::iterator iter = pLeaf->mItems.begin(); iter != pLeaf->mItems.end(); ++iter)
+   {
+      if (iter->mpObject == pObject)
+      {
+         pLeaf->mItems.erase(iter);
+         break;
+      }
+   }
+
+   // Remove nodes which have too few items and keep their objects to insert again
+   vector<Item> orphans;
+   Node* pNode = pLeaf;
+   while (pNode != mpRoot)
+   {
+      Node* pParent = pNode->mpParent;
+      if (pNode->mItems.size() < MIN_ITEMS)
+      {
+         for (vector<Item>::iterator iter = pParent->mItems.begin(); iter != pParent->mItems.end(); ++iter)
+         {
+            if (iter->mpChild == pNode)
+            {
+               pParent->mItems.erase(iter);
+               break;
+            }
+         }
+
+         collectItems(pNode, orphans);
+         delete pNode;
+      }
+      else
+      {
+         updateParentBox(pNode);
+      }
+
+      pNode = pParent;
+   }
+
+   // Shorten the tree if the root has a single child
+   while (mpRoot->mLevel > 0 && mpRoot->mItems.size() <= 1)
+   {
+      Node* pRoot = (mpRoot->mItems.empty() ? new Node(0) : mpRoot->mItems.front().mpChild);
+      mpRoot->mItems.clear();
+      delete mpRoot;
+
+      mpRoot = pRoot;
+      mpRoot->mpParent = NULL;
+   }
+
+   for (vector<Item>::const_iterator iter = orphans.begin(); iter != orphans.end(); ++iter)
+   {
+      insertItem(*iter);
+   }
+}
+
+void GraphicObjectIndex::updateParentBox(Node* pNode)
+{
+   Node* pParent = pNode->mpParent;
+   if (pParent == NULL)
+   {
+      return;
+   }
+
+   for (vector<Item>::iterator iter = pParent->mItems.begin(); iter != pParent->mItems.end(); ++iter)
+   {
+      if (iter->mpChild == pNode)
+      {
+         iter->mBox = pNode->getBounds();
+         break;
+      }
+   }
+}
+
+void GraphicObjectIndex::collectItems(Node* pNode, vector<Item>& items)
+{
+   for (vector<Item>::iterator iter = pNode->mItems.begin(); iter != pNode->mItems.end(); ++iter)
+   {
+      if (iter->mpChild != NULL)
+      {
+         collectItems(iter->mpChild, items);
+      }
+      else
+      {
+         items.push_back(*iter);
+      }
+   }
+}
@@ -0,0 +1,154 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef GRAPHICOBJECTINDEX_H
+#define GRAPHICOBJECTINDEX_H
+
+#include "LocationType.h"
+
+#include <list>
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+class GraphicObject;
+
+/**
+ * An R-tree of graphic object bounding boxes which also tracks the stacking
+ * order of the objects.
+ *
+ * The index never dereferences the objects.  The owner is responsible for
+ * calling update() when the bounds of an object change.
+ */
+class GraphicObjectIndex
+{
+public:
+   GraphicObjectIndex();
+   ~GraphicObjectIndex();
+
+   /**
+    * Adds an object on top of all other objects.
+    *
+    * @param pObject
+    *        The object to add.  An object which is already in the index is updated.
+    * @param llCorner
+    *        The minimum corner of the object's bounds.
+    * @param urCorner
+    *        The maximum corner of the object's bounds.
+    */
+   void insert(GraphicObject* pObject, const LocationType& llCorner, const LocationType& urCorner);
+
+   /**
+    * Changes the bounds of an object without changing its stacking order.
+    *
+    * @return False if the object is not in the index.
+    */
+   bool update(GraphicObject* pObject, const LocationType& llCorner, const LocationType& urCorner);
+
+   bool remove(GraphicObject* pObject);
+   void clear();
+   bool contains(GraphicObject* pObject) const;
+   unsigned int getNumObjects() const;
+
+   bool moveToFront(GraphicObject* pObject);
+   bool moveToBack(GraphicObject* pObject);
+
+   /**
+    * Sets the stacking order of the objects.
+    *
+    * @param objects
+    *        The objects from bottom to top.  Objects which are not in the
+    *        index are ignored.
+    */
+   void setStackingOrder(const std::list<GraphicObject*>& objects);
+
+   /**
+    * Finds the objects whose bounds intersect a region.
+    *
+    * @param llCorner
+    *        The minimum corner of the region.
+    * @param urCorner
+    *        The maximum corner of the region.
+    * @param objects
+    *        Receives the objects from bottom to top.
+    */
+   void query(const LocationType& llCorner, const LocationType& urCorner, std::vector<GraphicObject*>& objects) const;
+
+private:
+   GraphicObjectIndex(const GraphicObjectIndex& rhs);
+   GraphicObjectIndex& operator=(const GraphicObjectIndex& rhs);
+
+   class Box
+   {
+   public:
+      Box();
+      Box(const LocationType& llCorner, const LocationType& urCorner);
+
+      double getArea() const;
+      double getEnlargement(const Box& box) const;
+      bool intersects(const Box& box) const;
+      bool contains(const Box& box) const;
+      void merge(const Box& box);
+      bool operator==(const Box& box) const;
+
+      double mMinX;
+      double mMinY;
+      double mMaxX;
+      double mMaxY;
+   };
+
+   class Node;
+
+   class Item
+   {
+   public:
+      Item();
+
+      Box mBox;
+      Node* mpChild;
+      GraphicObject* mpObject;
+   };
+
+   class Node
+   {
+   public:
+      Node(unsigned int level);
+      ~Node();
+
+      Box getBounds() const;
+      void addItem(const Item& item);
+
+      unsigned int mLevel;       // zero for a leaf
+      Node* mpParent;
+      std::vector<Item> mItems;
+   };
+
+   class Record
+   {
+   public:
+      Box mBox;
+      int64_t mOrder;
+   };
+
+   void insertItem(const Item& item);
+   Node* chooseLeaf(const Box& box) const;
+   Node* splitNode(Node* pNode);
+   void adjustTree(Node* pNode, Node* pSplit);
+   Node* findLeaf(Node* pNode, GraphicObject* pObject, const Box& box) const;
+   void removeItem(Node* pLeaf, GraphicObject* pObject);
+   static void updateParentBox(Node* pNode);
+   static void collectItems(Node* pNode, std::vector<Item>& items);
+
+   Node* mpRoot;
+   std::map<GraphicObject*, Record> mRecords;
+   int64_t mTopOrder;
+   int64_t mBottomOrder;
+};
+
+#endif
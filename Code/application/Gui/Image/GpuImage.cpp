@@ -1470,6 +1470,12 @@ unsigned int GpuImage::getMaxNumTileSets() const
    return 3;
 }
 
+void GpuImage::prefetch(const vector<PrefetchFrame>& frames, size_t maxCacheBytes)
+{
+   // The textures hold the raw data and are stretched on the GPU, so a band change
+   // reloads the data and there is nothing to generate ahead of time
+}
+
 vector<Tile*> GpuImage::getTilesToUpdate(const vector<Tile*>& tilesToDraw, vector<unsigned int>& tileZoomIndices)
 {
    const Image::ImageData imageInfo = Image::getImageData();
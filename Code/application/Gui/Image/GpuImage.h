@@ -81,6 +81,8 @@ public:
    static void setMaxTextureSize(GLint maxSize = 0);
    static GLint getMaxTextureSize();
 
+   void prefetch(const std::vector<PrefetchFrame>& frames, size_t maxCacheBytes);
+
 protected:
    void initializeGrayscale();
    void initializeColormap(const std::vector<ColorType>& colorMap);
@@ -756,6 +756,16 @@ void ImportOptionsDlg::setCurrentDataset(ImportDescriptor* pImportDescriptor)
          locations.push_back(IN_MEMORY);
       }
 
+      if (mpImporter->isProcessingLocationSupported(IN_MEMORY_COMPRESSED) == true)
+      {
+         locations.push_back(IN_MEMORY_COMPRESSED);
+      }
+
+      if (mpImporter->isProcessingLocationSupported(IN_MEMORY_SPILLABLE) == true)
+      {
+         locations.push_back(IN_MEMORY_SPILLABLE);
+      }
+
       if (mpImporter->isProcessingLocationSupported(ON_DISK) == true)
       {
          locations.push_back(ON_DISK);
@@ -0,0 +1,455 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "BlockCompression.h"
+#include "bthread.h"
+#include "ConfigurationSettings.h"
+#include "DMutex.h"
+#include "Hdf5ChunkCodec.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <string.h>
+
+using namespace std;
+
+namespace
+{
+   // The default block size used by the reference LZ4 filter when none is specified
+   const size_t LZ4_DEFAULT_BLOCK_SIZE = 1 << 30;
+   const size_t LZ4_HEADER_SIZE = 12;
+
+   void writeBigEndian(unsigned char* pDest, uint64_t value, unsigned int bytes)
+   {
+      for (unsigned int i = 0; i < bytes; ++i)
+      {
+         pDest[bytes - i - 1] = static_cast<unsigned char>(value & 0xff);
+         value >>= 8;
+      }
+   }
+
+   uint64_t readBigEndian(const unsigned char* pSource, unsigned int bytes)
+   {
+      uint64_t value = 0;
+      for (unsigned int i = 0; i < bytes; ++i)
+      {
+         value = (value << 8) | pSource[i];
+      }
+      return value;
+   }
+
+   // Matches the layout of the H5Z_FILTER_SHUFFLE filter, which leaves any trailing partial element untouched
+   void shuffleChunk(vector<char>& chunk, size_t elementSize, bool reverse)
+   {
+      size_t elementCount = (elementSize > 0 ? chunk.size() / elementSize : 0);
+      if (elementSize <= 1 || elementCount <= 1)
+      {
+         return;
+      }
+
+      vector<char> result(chunk.size());
+      if (reverse)
+      {
+         BlockCompression::unshuffle(&chunk[0], &result[0], elementCount, elementSize);
+      }
+      else
+      {
+         BlockCompression::shuffle(&chunk[0], &result[0], elementCount, elementSize);
+      }
+
+      size_t shuffledBytes = elementCount * elementSize;
+      if (shuffledBytes < chunk.size())
+      {
+         memcpy(&result[shuffledBytes], &chunk[shuffledBytes], chunk.size() - shuffledBytes);
+      }
+
+      chunk.swap(result);
+   }
+
+   bool deflateChunk(vector<char>& chunk, unsigned int level)
+   {
+      uLongf compressedSize = compressBound(static_cast<uLong>(chunk.size()));
+      vector<char> result(compressedSize);
+      if (compress2(reinterpret_cast<Bytef*>(&result[0]), &compressedSize,
+         reinterpret_cast<const Bytef*>(chunk.empty() ? NULL : &chunk[0]), static_cast<uLong>(chunk.size()),
+         static_cast<int>(level)) != Z_OK)
+      {
+         return false;
+      }
+
+      result.resize(compressedSize);
+      chunk.swap(result);
+      return true;
+   }
+
+   bool inflateChunk(vector<char>& chunk, size_t expectedBytes)
+   {
+      if (chunk.empty())
+      {
+         return false;
+      }
+
+      // The decoded size is only known for the last filter in the pipeline, so grow the buffer as needed
+      vector<char> result(max(expectedBytes, chunk.size()));
+      for (;;)
+      {
+         uLongf resultSize = static_cast<uLongf>(result.size());
+         int status = uncompress(reinterpret_cast<Bytef*>(&result[0]), &resultSize,
+            reinterpret_cast<const Bytef*>(&chunk[0]), static_cast<uLong>(chunk.size()));
+         if (status == Z_OK)
+         {
+            result.resize(resultSize);
+            break;
+         }
+         if (status != Z_BUF_ERROR)
+         {
+            return false;
+         }
+         result.resize(result.size() * 2);
+      }
+
+      chunk.swap(result);
+      return true;
+   }
+
+   // Produces the stream format of the reference HDF5 LZ4 filter: an 8 byte total size and a 4 byte block
+   // size, followed by each block prefixed with its 4 byte compressed size. Blocks which do not compress
+   // are stored raw and identified by a compressed size equal to the block size.
+   bool lz4EncodeChunk(const char* pSource, size_t sourceSize, size_t blockSize, vector<char>& result)
+   {
+      if (blockSize == 0 || blockSize > LZ4_DEFAULT_BLOCK_SIZE)
+      {
+         blockSize = LZ4_DEFAULT_BLOCK_SIZE;
+      }
+      blockSize = max<size_t>(min(blockSize, sourceSize), 1);
+
+      size_t blockCount = (sourceSize + blockSize - 1) / blockSize;
+      result.resize(LZ4_HEADER_SIZE + blockCount * (4 + BlockCompression::getMaxCompressedSize(blockSize)));
+
+      unsigned char* const pBase = reinterpret_cast<unsigned char*>(&result[0]);
+      writeBigEndian(pBase, sourceSize, 8);
+      writeBigEndian(pBase + 8, blockSize, 4);
+
+      unsigned char* pOut = pBase + LZ4_HEADER_SIZE;
+      for (size_t offset = 0; offset < sourceSize; offset += blockSize)
+      {
+         size_t currentBlockSize = min(blockSize, sourceSize - offset);
+         size_t compressedSize = BlockCompression::compress(pSource + offset, currentBlockSize, pOut + 4,
+            BlockCompression::getMaxCompressedSize(currentBlockSize));
+         if (compressedSize == 0 || compressedSize >= currentBlockSize)
+         {
+            memcpy(pOut + 4, pSource + offset, currentBlockSize);
+            compressedSize = currentBlockSize;
+         }
+
+         writeBigEndian(pOut, compressedSize, 4);
+         pOut += 4 + compressedSize;
+      }
+
+      result.resize(pOut - pBase);
+      return true;
+   }
+
+   bool lz4DecodeChunk(const char* pSource, size_t sourceSize, vector<char>& result)
+   {
+      if (sourceSize < LZ4_HEADER_SIZE)
+      {
+         return false;
+      }
+
+      const unsigned char* pIn = reinterpret_cast<const unsigned char*>(pSource);
+      const unsigned char* const pInEnd = pIn + sourceSize;
+      uint64_t totalSize = readBigEndian(pIn, 8);
+      size_t blockSize = static_cast<size_t>(readBigEndian(pIn + 8, 4));
+      pIn += LZ4_HEADER_SIZE;
+      if (blockSize == 0 && totalSize > 0)
+      {
+         return false;
+      }
+
+      result.resize(static_cast<size_t>(totalSize));
+      for (size_t offset = 0; offset < result.size(); offset += blockSize)
+      {
+         size_t currentBlockSize = min(blockSize, result.size() - offset);
+         if (pInEnd - pIn < 4)
+         {
+            return false;
+         }
+
+         size_t compressedSize = static_cast<size_t>(readBigEndian(pIn, 4));
+         pIn += 4;
+         if (compressedSize > static_cast<size_t>(pInEnd - pIn))
+         {
+            return false;
+         }
+
+         if (compressedSize == currentBlockSize)
+         {
+            memcpy(&result[offset], pIn, currentBlockSize);
+         }
+         else if (!BlockCompression::decompress(pIn, compressedSize, &result[offset], currentBlockSize))
+         {
+            return false;
+         }
+
+         pIn += compressedSize;
+      }
+
+      return true;
+   }
+
+   size_t lz4Filter(unsigned int flags, size_t cdNelmts, const unsigned int cdValues[], size_t nbytes,
+      size_t* pBufSize, void** ppBuf)
+   {
+      if (ppBuf == NULL || *ppBuf == NULL || pBufSize == NULL)
+      {
+         return 0;
+      }
+
+      const char* pSource = reinterpret_cast<const char*>(*ppBuf);
+      vector<char> result;
+      bool success = false;
+      if ((flags & H5Z_FLAG_REVERSE) != 0)
+      {
+         success = lz4DecodeChunk(pSource, nbytes, result);
+      }
+      else
+      {
+         size_t blockSize = (cdNelmts > 0 ? cdValues[0] : 0);
+         success = lz4EncodeChunk(pSource, nbytes, blockSize, result);
+      }
+
+      if (success == false || result.empty())
+      {
+         return 0;
+      }
+
+      void* pBuffer = H5allocate_memory(result.size(), false);
+      if (pBuffer == NULL)
+      {
+         return 0;
+      }
+
+      memcpy(pBuffer, &result[0], result.size());
+      H5free_memory(*ppBuf);
+      *ppBuf = pBuffer;
+      *pBufSize = result.size();
+      return result.size();
+   }
+
+   struct TaskQueue
+   {
+      const vector<Hdf5ChunkCodec::Task*>* mpTasks;
+      size_t mNextTask;
+      bool mSuccess;
+      mta::DMutex mMutex;
+   };
+
+   void* executeTaskQueue(void* pData)
+   {
+      TaskQueue* pQueue = reinterpret_cast<TaskQueue*>(pData);
+      for (;;)
+      {
+         Hdf5ChunkCodec::Task* pTask = NULL;
+         {
+            mta::MutexLock lock(pQueue->mMutex);
+            if (pQueue->mSuccess == false || pQueue->mNextTask >= pQueue->mpTasks->size())
+            {
+               break;
+            }
+            pTask = (*pQueue->mpTasks)[pQueue->mNextTask++];
+         }
+
+         if (pTask == NULL || pTask->execute() == false)
+         {
+            mta::MutexLock lock(pQueue->mMutex);
+            pQueue->mSuccess = false;
+         }
+      }
+
+      return NULL;
+   }
+}
+
+bool Hdf5ChunkCodec::registerLz4Filter()
+{
+   if (H5Zfilter_avail(LZ4_FILTER) > 0)
+   {
+      return true;
+   }
+
+   static const H5Z_class2_t lz4Class =
+   {
+      H5Z_CLASS_T_VERS,
+      LZ4_FILTER,
+      1,
+      1,
+      "lz4",
+      NULL,
+      NULL,
+      reinterpret_cast<H5Z_func_t>(lz4Filter)
+   };
+
+   return H5Zregister(&lz4Class) >= 0;
+}
+
+bool Hdf5ChunkCodec::executeTasks(const vector<Task*>& tasks)
+{
+   TaskQueue queue;
+   queue.mpTasks = &tasks;
+   queue.mNextTask = 0;
+   queue.mSuccess = true;
+
+   size_t threadCount = min<size_t>(max(ConfigurationSettings::getSettingThreadCount(), 1U), tasks.size());
+   if (threadCount <= 1)
+   {
+      executeTaskQueue(&queue);
+      return queue.mSuccess;
+   }
+
+   // The calling thread works through the queue as well
+   vector<BThread*> threads;
+   for (size_t i = 1; i < threadCount; ++i)
+   {
+      BThread* pThread = new BThread(&queue, reinterpret_cast<void*>(executeTaskQueue));
+      if (pThread->ThreadLaunch() == false)
+      {
+         delete pThread;
+         break;
+      }
+      threads.push_back(pThread);
+   }
+
+   executeTaskQueue(&queue);
+
+   for (vector<BThread*>::iterator iter = threads.begin(); iter != threads.end(); ++iter)
+   {
+      (*iter)->ThreadWait();
+      delete *iter;
+   }
+
+   return queue.mSuccess;
+}
+
+Hdf5ChunkCodec::Hdf5ChunkCodec()
+{
+}
+
+bool Hdf5ChunkCodec::setFilters(hid_t creationProperties)
+{
+   mFilters.clear();
+
+   int filterCount = H5Pget_nfilters(creationProperties);
+   if (filterCount < 0)
+   {
+      return false;
+   }
+
+   for (int i = 0; i < filterCount; ++i)
+   {
+      unsigned int flags = 0;
+      size_t parameterCount = 4;
+      unsigned int parameters[4] = {0};
+      unsigned int filterConfig = 0;
+      H5Z_filter_t id = H5Pget_filter2(creationProperties, static_cast<unsigned int>(i), &flags,
+         &parameterCount, parameters, 0, NULL, &filterConfig);
+
+      Filter filter;
+      filter.mId = id;
+      filter.mParameter = (parameterCount > 0 ? parameters[0] : 0);
+      if ((id != H5Z_FILTER_SHUFFLE && id != H5Z_FILTER_DEFLATE && id != LZ4_FILTER) ||
+         (id == H5Z_FILTER_SHUFFLE && parameterCount == 0))
+      {
+         mFilters.clear();
+         return false;
+      }
+
+      mFilters.push_back(filter);
+   }
+
+   return true;
+}
+
+bool Hdf5ChunkCodec::hasFilters() const
+{
+   return !mFilters.empty();
+}
+
+bool Hdf5ChunkCodec::encode(vector<char>& chunk) const
+{
+   for (vector<Filter>::const_iterator iter = mFilters.begin(); iter != mFilters.end(); ++iter)
+   {
+      switch (iter->mId)
+      {
+      case H5Z_FILTER_SHUFFLE:
+         shuffleChunk(chunk, iter->mParameter, false);
+         break;
+      case H5Z_FILTER_DEFLATE:
+         if (deflateChunk(chunk, iter->mParameter) == false)
+         {
+            return false;
+         }
+         break;
+      case LZ4_FILTER:
+      {
+         vector<char> result;
+         if (chunk.empty() || lz4EncodeChunk(&chunk[0], chunk.size(), iter->mParameter, result) == false)
+         {
+            return false;
+         }
+         chunk.swap(result);
+         break;
+      }
+      default:
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool Hdf5ChunkCodec::decode(vector<char>& chunk, size_t chunkBytes, unsigned int filterMask) const
+{
+   for (size_t i = mFilters.size(); i > 0; --i)
+   {
+      if ((filterMask & (1U << (i - 1))) != 0)
+      {
+         continue;
+      }
+
+      const Filter& filter = mFilters[i - 1];
+      switch (filter.mId)
+      {
+      case H5Z_FILTER_SHUFFLE:
+         shuffleChunk(chunk, filter.mParameter, true);
+         break;
+      case H5Z_FILTER_DEFLATE:
+         if (inflateChunk(chunk, chunkBytes) == false)
+         {
+            return false;
+         }
+         break;
+      case LZ4_FILTER:
+      {
+         vector<char> result;
+         if (chunk.empty() || lz4DecodeChunk(&chunk[0], chunk.size(), result) == false)
+         {
+            return false;
+         }
+         chunk.swap(result);
+         break;
+      }
+      default:
+         return false;
+      }
+   }
+
+   return chunk.size() == chunkBytes;
+}
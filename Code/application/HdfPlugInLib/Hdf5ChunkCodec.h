@@ -0,0 +1,124 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef HDF5CHUNKCODEC_H
+#define HDF5CHUNKCODEC_H
+
+#include <hdf5.h>
+
+#include <vector>
+
+/**
+ * Applies an HDF5 filter pipeline to raw chunk buffers outside of the HDF5 library.
+ *
+ * HDF5 runs its filters serially on the calling thread.  This class reproduces the
+ * shuffle, deflate and LZ4 filters so that chunks can be encoded and decoded on
+ * worker threads and then transferred with direct chunk I/O.  The encoded chunks are
+ * byte-for-byte compatible with the ones HDF5 produces, so files remain readable by
+ * any application with the corresponding filters available.
+ */
+class Hdf5ChunkCodec
+{
+public:
+   /**
+    * The filter identifier registered with The HDF Group for the LZ4 filter.
+    */
+   static const H5Z_filter_t LZ4_FILTER = 32004;
+
+   /**
+    * A unit of work which can be executed by executeTasks().
+    */
+   class Task
+   {
+   public:
+      virtual ~Task() {}
+
+      /**
+       * Performs the work.  This is called on a worker thread, so HDF5 must not be called.
+       *
+       * @return True if the work succeeded, false otherwise.
+       */
+      virtual bool execute() = 0;
+   };
+
+   /**
+    * Registers the LZ4 filter with the HDF5 library if it is not already available.
+    *
+    * @return True if the LZ4 filter is available, false otherwise.
+    */
+   static bool registerLz4Filter();
+
+   /**
+    * Executes the given tasks using up to ConfigurationSettings::getSettingThreadCount() threads.
+    *
+    * @param  tasks
+    *         The tasks to execute.  Tasks may be executed in any order.
+    *
+    * @return True if every task succeeded, false otherwise.
+    */
+   static bool executeTasks(const std::vector<Task*>& tasks);
+
+   /**
+    * Creates a codec with an empty filter pipeline.
+    */
+   Hdf5ChunkCodec();
+
+   /**
+    * Sets the filter pipeline from a dataset creation property list.
+    *
+    * @param  creationProperties
+    *         The property list returned from H5Dget_create_plist().
+    *
+    * @return True if every filter in the pipeline is supported by this class, false otherwise.
+    *         If false is returned, the pipeline is cleared.
+    */
+   bool setFilters(hid_t creationProperties);
+
+   /**
+    * Queries whether the pipeline contains any filters.
+    *
+    * @return True if the pipeline contains at least one filter, false otherwise.
+    */
+   bool hasFilters() const;
+
+   /**
+    * Encodes a chunk with every filter in the pipeline.
+    *
+    * @param  chunk
+    *         On input, the raw chunk data.  On output, the encoded chunk data.
+    *
+    * @return True if the chunk was encoded, false otherwise.
+    */
+   bool encode(std::vector<char>& chunk) const;
+
+   /**
+    * Decodes a chunk with the filters in the pipeline that were applied to it.
+    *
+    * @param  chunk
+    *         On input, the encoded chunk data.  On output, the raw chunk data.
+    * @param  chunkBytes
+    *         The size of the raw chunk in bytes.
+    * @param  filterMask
+    *         The filter mask stored with the chunk.  Filters with their bit set were skipped when encoding.
+    *
+    * @return True if the chunk was decoded to exactly \em chunkBytes, false otherwise.
+    */
+   bool decode(std::vector<char>& chunk, size_t chunkBytes, unsigned int filterMask) const;
+
+private:
+   struct Filter
+   {
+      H5Z_filter_t mId;
+      unsigned int mParameter;
+   };
+
+   std::vector<Filter> mFilters;
+};
+
+#endif
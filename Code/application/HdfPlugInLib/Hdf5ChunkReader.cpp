@@ -0,0 +1,189 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "ConfigurationSettings.h"
+#include "Hdf5ChunkReader.h"
+#include "Hdf5Resource.h"
+
+#include <algorithm>
+#include <string.h>
+
+using namespace std;
+
+Hdf5ChunkReader::Chunk::Chunk(const Hdf5ChunkReader& reader, const hsize_t offset[3], const hsize_t counts[3],
+                              char* pDest) :
+   mFilterMask(0),
+   mReader(reader),
+   mpOffset(offset),
+   mpCounts(counts),
+   mpDest(pDest)
+{
+   mChunkOffset[0] = mChunkOffset[1] = mChunkOffset[2] = 0;
+}
+
+bool Hdf5ChunkReader::Chunk::execute()
+{
+   if (mReader.mCodec.decode(mData, mReader.mChunkBytes, mFilterMask) == false)
+   {
+      return false;
+   }
+
+   // Copy the intersection of the chunk and the requested region one contiguous run at a time
+   hsize_t start[3];
+   hsize_t stop[3];
+   for (int i = 0; i < 3; ++i)
+   {
+      start[i] = max(mpOffset[i], mChunkOffset[i]);
+      stop[i] = min(mpOffset[i] + mpCounts[i], mChunkOffset[i] + mReader.mChunkDims[i]);
+   }
+
+   const size_t elementSize = mReader.mElementSize;
+   const size_t runBytes = static_cast<size_t>(stop[2] - start[2]) * elementSize;
+   for (hsize_t i0 = start[0]; i0 < stop[0]; ++i0)
+   {
+      for (hsize_t i1 = start[1]; i1 < stop[1]; ++i1)
+      {
+         size_t sourceIndex = static_cast<size_t>(((i0 - mChunkOffset[0]) * mReader.mChunkDims[1] +
+            (i1 - mChunkOffset[1])) * mReader.mChunkDims[2] + (start[2] - mChunkOffset[2]));
+         size_t destIndex = static_cast<size_t>(((i0 - mpOffset[0]) * mpCounts[1] + (i1 - mpOffset[1])) *
+            mpCounts[2] + (start[2] - mpOffset[2]));
+         memcpy(mpDest + destIndex * elementSize, &mData[sourceIndex * elementSize], runBytes);
+      }
+   }
+
+   // Release the decoded chunk now since the batch is not freed until every chunk is done
+   vector<char>().swap(mData);
+   return true;
+}
+
+Hdf5ChunkReader::Hdf5ChunkReader(hid_t dataset) :
+   mDataset(dataset),
+   mEnabled(false),
+   mElementSize(0),
+   mChunkBytes(0)
+{
+   mChunkDims[0] = mChunkDims[1] = mChunkDims[2] = 0;
+
+#if H5_VERSION_GE(1, 10, 3)
+   Hdf5PropertyListResource creationProperties(H5Dget_create_plist(mDataset));
+   if (*creationProperties < 0 || H5Pget_layout(*creationProperties) != H5D_CHUNKED ||
+      H5Pget_chunk(*creationProperties, 3, mChunkDims) != 3)
+   {
+      return;
+   }
+
+   Hdf5TypeResource dataType(H5Dget_type(mDataset));
+   if (*dataType < 0)
+   {
+      return;
+   }
+
+   mElementSize = H5Tget_size(*dataType);
+   mChunkBytes = mElementSize * static_cast<size_t>(mChunkDims[0] * mChunkDims[1] * mChunkDims[2]);
+   mEnabled = mChunkBytes > 0 && mCodec.setFilters(*creationProperties) && mCodec.hasFilters();
+#endif
+}
+
+bool Hdf5ChunkReader::isEnabled() const
+{
+   return mEnabled;
+}
+
+bool Hdf5ChunkReader::read(const hsize_t offset[3], const hsize_t counts[3], hid_t memoryType, void* pDest)
+{
+   if (mEnabled == false || pDest == NULL)
+   {
+      return false;
+   }
+
+#if H5_VERSION_GE(1, 10, 3)
+   Hdf5TypeResource dataType(H5Dget_type(mDataset));
+   if (*dataType < 0 || H5Tequal(*dataType, memoryType) <= 0)
+   {
+      return false;
+   }
+
+   hsize_t firstChunk[3];
+   hsize_t lastChunk[3];
+   for (int i = 0; i < 3; ++i)
+   {
+      if (counts[i] == 0)
+      {
+         return false;
+      }
+      firstChunk[i] = offset[i] / mChunkDims[i];
+      lastChunk[i] = (offset[i] + counts[i] - 1) / mChunkDims[i];
+   }
+
+   // A single chunk gains nothing from the worker threads
+   hsize_t chunkCount = (lastChunk[0] - firstChunk[0] + 1) * (lastChunk[1] - firstChunk[1] + 1) *
+      (lastChunk[2] - firstChunk[2] + 1);
+   if (chunkCount < 2)
+   {
+      return false;
+   }
+
+   vector<Chunk*> chunks;
+   for (hsize_t c0 = firstChunk[0]; c0 <= lastChunk[0]; ++c0)
+   {
+      for (hsize_t c1 = firstChunk[1]; c1 <= lastChunk[1]; ++c1)
+      {
+         for (hsize_t c2 = firstChunk[2]; c2 <= lastChunk[2]; ++c2)
+         {
+            Chunk* pChunk = new Chunk(*this, offset, counts, reinterpret_cast<char*>(pDest));
+            pChunk->mChunkOffset[0] = c0 * mChunkDims[0];
+            pChunk->mChunkOffset[1] = c1 * mChunkDims[1];
+            pChunk->mChunkOffset[2] = c2 * mChunkDims[2];
+            chunks.push_back(pChunk);
+         }
+      }
+   }
+
+   // Read and decode in batches to bound the memory used by the compressed chunks
+   const size_t batchSize = 2 * max(ConfigurationSettings::getSettingThreadCount(), 1U);
+   bool success = true;
+   for (size_t batchStart = 0; success && batchStart < chunks.size(); batchStart += batchSize)
+   {
+      size_t batchEnd = min(batchStart + batchSize, chunks.size());
+      for (size_t i = batchStart; success && i < batchEnd; ++i)
+      {
+         Chunk* pChunk = chunks[i];
+
+         // Chunks which were never written hold the fill value, which H5Dread handles
+         hsize_t storageSize = 0;
+         if (H5Dget_chunk_storage_size(mDataset, pChunk->mChunkOffset, &storageSize) < 0 || storageSize == 0)
+         {
+            success = false;
+            break;
+         }
+
+         pChunk->mData.resize(static_cast<size_t>(storageSize));
+         uint32_t filterMask = 0;
+         success = H5Dread_chunk(mDataset, H5P_DEFAULT, pChunk->mChunkOffset, &filterMask,
+            &pChunk->mData[0]) >= 0;
+         pChunk->mFilterMask = filterMask;
+      }
+
+      if (success)
+      {
+         vector<Hdf5ChunkCodec::Task*> tasks(chunks.begin() + batchStart, chunks.begin() + batchEnd);
+         success = Hdf5ChunkCodec::executeTasks(tasks);
+      }
+   }
+
+   for (vector<Chunk*>::iterator iter = chunks.begin(); iter != chunks.end(); ++iter)
+   {
+      delete *iter;
+   }
+
+   return success;
+#else
+   return false;
+#endif
+}
@@ -0,0 +1,98 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef HDF5CHUNKREADER_H
+#define HDF5CHUNKREADER_H
+
+#include "Hdf5ChunkCodec.h"
+
+#include <hdf5.h>
+
+#include <vector>
+
+/**
+ * Reads a region of a filtered three dimensional HDF5 dataset, decompressing chunks on worker threads.
+ *
+ * The raw chunks intersecting the region are read with HDF5 direct chunk reads on the
+ * calling thread.  Each chunk is then decoded and copied into the destination buffer on
+ * a worker thread using Hdf5ChunkCodec::executeTasks().
+ *
+ * The reader is only enabled for chunked datasets whose filter pipeline is supported by
+ * Hdf5ChunkCodec and when the HDF5 library provides direct chunk reads.  Because the
+ * chunks bypass the HDF5 type conversion, read() also requires the memory type to match
+ * the type stored in the file.
+ */
+class Hdf5ChunkReader
+{
+public:
+   /**
+    * Creates a chunk reader for a dataset.
+    *
+    * @param  dataset
+    *         The dataset to read.  The handle must remain open for the lifetime of this object.
+    */
+   Hdf5ChunkReader(hid_t dataset);
+
+   /**
+    * Queries whether the dataset can be read with this object.
+    *
+    * @return True if read() can be used, false otherwise.
+    */
+   bool isEnabled() const;
+
+   /**
+    * Reads a contiguous region of the dataset.
+    *
+    * @param  offset
+    *         The start of the region in each of the three dimensions.
+    * @param  counts
+    *         The size of the region in each of the three dimensions.
+    * @param  memoryType
+    *         The type of the destination buffer.
+    * @param  pDest
+    *         The destination buffer, which holds \em counts elements laid out contiguously.
+    *
+    * @return True if the entire region was read.  False is returned if the region cannot be read
+    *         with direct chunk reads, in which case the contents of \em pDest are undefined and
+    *         H5Dread() should be used instead.
+    */
+   bool read(const hsize_t offset[3], const hsize_t counts[3], hid_t memoryType, void* pDest);
+
+private:
+   Hdf5ChunkReader(const Hdf5ChunkReader& rhs);
+   Hdf5ChunkReader& operator=(const Hdf5ChunkReader& rhs);
+
+   class Chunk : public Hdf5ChunkCodec::Task
+   {
+   public:
+      Chunk(const Hdf5ChunkReader& reader, const hsize_t offset[3], const hsize_t counts[3], char* pDest);
+      bool execute();
+
+      hsize_t mChunkOffset[3];
+      std::vector<char> mData;
+      unsigned int mFilterMask;
+
+   private:
+      Chunk& operator=(const Chunk& rhs);
+
+      const Hdf5ChunkReader& mReader;
+      const hsize_t* mpOffset;
+      const hsize_t* mpCounts;
+      char* mpDest;
+   };
+
+   hid_t mDataset;
+   bool mEnabled;
+   hsize_t mChunkDims[3];
+   size_t mElementSize;
+   size_t mChunkBytes;
+   Hdf5ChunkCodec mCodec;
+};
+
+#endif
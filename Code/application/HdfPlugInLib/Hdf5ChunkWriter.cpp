@@ -0,0 +1,133 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "ConfigurationSettings.h"
+#include "Hdf5ChunkWriter.h"
+#include "Hdf5Resource.h"
+
+#include <algorithm>
+#include <string.h>
+
+using namespace std;
+
+Hdf5ChunkWriter::Chunk::Chunk(const Hdf5ChunkCodec& codec) :
+   mCodec(codec)
+{
+}
+
+bool Hdf5ChunkWriter::Chunk::execute()
+{
+   return mCodec.encode(mData);
+}
+
+Hdf5ChunkWriter::Hdf5ChunkWriter(hid_t dataset) :
+   mDataset(dataset),
+   mEnabled(false),
+   mRank(0),
+   mChunkBytes(0),
+   mBatchSize(0)
+{
+#if H5_VERSION_GE(1, 10, 3)
+   Hdf5PropertyListResource creationProperties(H5Dget_create_plist(mDataset));
+   if (*creationProperties < 0 || H5Pget_layout(*creationProperties) != H5D_CHUNKED)
+   {
+      return;
+   }
+
+   mRank = H5Pget_chunk(*creationProperties, 0, NULL);
+   if (mRank <= 0)
+   {
+      return;
+   }
+
+   vector<hsize_t> chunkDims(mRank);
+   H5Pget_chunk(*creationProperties, mRank, &chunkDims[0]);
+
+   Hdf5TypeResource dataType(H5Dget_type(mDataset));
+   if (*dataType < 0)
+   {
+      return;
+   }
+
+   mChunkBytes = H5Tget_size(*dataType);
+   for (int i = 0; i < mRank; ++i)
+   {
+      mChunkBytes *= static_cast<size_t>(chunkDims[i]);
+   }
+
+   // Keep every worker busy while the previous batch is being written
+   mBatchSize = 2 * max(ConfigurationSettings::getSettingThreadCount(), 1U);
+   mEnabled = mChunkBytes > 0 && mCodec.setFilters(*creationProperties) && mCodec.hasFilters();
+#endif
+}
+
+Hdf5ChunkWriter::~Hdf5ChunkWriter()
+{
+   clear();
+}
+
+bool Hdf5ChunkWriter::isEnabled() const
+{
+   return mEnabled;
+}
+
+bool Hdf5ChunkWriter::writeChunk(const hsize_t offset[], const void* pData, size_t bytes)
+{
+   if (mEnabled == false || offset == NULL || pData == NULL || bytes > mChunkBytes)
+   {
+      return false;
+   }
+
+   Chunk* pChunk = new Chunk(mCodec);
+   pChunk->mOffset.assign(offset, offset + mRank);
+   pChunk->mData.resize(mChunkBytes, 0);
+   memcpy(&pChunk->mData[0], pData, bytes);
+   mPending.push_back(pChunk);
+
+   if (mPending.size() >= mBatchSize)
+   {
+      return flush();
+   }
+
+   return true;
+}
+
+bool Hdf5ChunkWriter::flush()
+{
+   if (mPending.empty())
+   {
+      return true;
+   }
+
+   vector<Hdf5ChunkCodec::Task*> tasks(mPending.begin(), mPending.end());
+   bool success = Hdf5ChunkCodec::executeTasks(tasks);
+
+#if H5_VERSION_GE(1, 10, 3)
+   for (vector<Chunk*>::const_iterator iter = mPending.begin(); success && iter != mPending.end(); ++iter)
+   {
+      const Chunk* pChunk = *iter;
+      success = H5Dwrite_chunk(mDataset, H5P_DEFAULT, 0, &pChunk->mOffset[0], pChunk->mData.size(),
+         &pChunk->mData[0]) >= 0;
+   }
+#else
+   success = false;
+#endif
+
+   clear();
+   return success;
+}
+
+void Hdf5ChunkWriter::clear()
+{
+   for (vector<Chunk*>::iterator iter = mPending.begin(); iter != mPending.end(); ++iter)
+   {
+      delete *iter;
+   }
+   mPending.clear();
+}
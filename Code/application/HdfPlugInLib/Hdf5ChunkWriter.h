@@ -0,0 +1,108 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef HDF5CHUNKWRITER_H
+#define HDF5CHUNKWRITER_H
+
+#include "Hdf5ChunkCodec.h"
+
+#include <hdf5.h>
+
+#include <vector>
+
+/**
+ * Writes whole chunks of a filtered HDF5 dataset, compressing them on worker threads.
+ *
+ * Chunks are queued by writeChunk() and compressed in batches using
+ * Hdf5ChunkCodec::executeTasks().  The compressed chunks are then written to the
+ * file in the order they were queued using HDF5 direct chunk writes, so only the
+ * calling thread ever calls into the HDF5 library.
+ *
+ * The writer is only enabled for chunked datasets whose filter pipeline is supported
+ * by Hdf5ChunkCodec and when the HDF5 library provides direct chunk writes.  If the
+ * writer is not enabled, data should be written with H5Dwrite() instead.
+ */
+class Hdf5ChunkWriter
+{
+public:
+   /**
+    * Creates a chunk writer for a dataset.
+    *
+    * @param  dataset
+    *         The dataset to write.  The handle must remain open for the lifetime of this object.
+    */
+   Hdf5ChunkWriter(hid_t dataset);
+
+   /**
+    * Destroys the chunk writer.  Chunks which have not been flushed are discarded.
+    */
+   ~Hdf5ChunkWriter();
+
+   /**
+    * Queries whether the dataset can be written with this object.
+    *
+    * @return True if writeChunk() can be used, false otherwise.
+    */
+   bool isEnabled() const;
+
+   /**
+    * Queues a chunk to be compressed and written.
+    *
+    * @param  offset
+    *         The logical position of the first element of the chunk in the dataset.  This must be a
+    *         multiple of the chunk dimensions.
+    * @param  pData
+    *         The chunk data, laid out as a full chunk.
+    * @param  bytes
+    *         The number of bytes of valid data.  If this is less than the chunk size, the remainder
+    *         of the chunk is filled with zeros as is required for partial edge chunks.
+    *
+    * @return True if the chunk was queued and any batch that was flushed as a result was written,
+    *         false otherwise.
+    */
+   bool writeChunk(const hsize_t offset[], const void* pData, size_t bytes);
+
+   /**
+    * Compresses and writes all queued chunks.
+    *
+    * @return True if every queued chunk was written, false otherwise.
+    */
+   bool flush();
+
+private:
+   Hdf5ChunkWriter(const Hdf5ChunkWriter& rhs);
+   Hdf5ChunkWriter& operator=(const Hdf5ChunkWriter& rhs);
+
+   class Chunk : public Hdf5ChunkCodec::Task
+   {
+   public:
+      Chunk(const Hdf5ChunkCodec& codec);
+      bool execute();
+
+      std::vector<char> mData;
+      std::vector<hsize_t> mOffset;
+
+   private:
+      Chunk& operator=(const Chunk& rhs);
+
+      const Hdf5ChunkCodec& mCodec;
+   };
+
+   void clear();
+
+   hid_t mDataset;
+   bool mEnabled;
+   int mRank;
+   size_t mChunkBytes;
+   size_t mBatchSize;
+   Hdf5ChunkCodec mCodec;
+   std::vector<Chunk*> mPending;
+};
+
+#endif
@@ -18,6 +18,8 @@
 #include "DataRequest.h"
 #include "DataVariant.h"
 #include "Endian.h"
+#include "Hdf5ChunkCodec.h"
+#include "Hdf5ChunkReader.h"
 #include "Hdf5Pager.h"
 #include "Hdf5Resource.h"
 #include "Hdf5Utilities.h"
@@ -26,14 +28,40 @@
 #include "RasterFileDescriptor.h"
 #include "Service.h"
 
+#include <algorithm>
+#include <math.h>
 #include <string.h>
 
 using namespace HdfUtilities;
 using namespace std;
 
+namespace
+{
+   bool isPrime(size_t value)
+   {
+      if (value < 2)
+      {
+         return false;
+      }
+
+      for (size_t divisor = 2; divisor * divisor <= value; ++divisor)
+      {
+         if (value % divisor == 0)
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+}
+
 Hdf5Pager::Hdf5Pager() :
-   mFileHandle(INVALID_HANDLE), mDataHandle(INVALID_HANDLE), mFileAccessProperties(H5P_DEFAULT)
+   mFileHandle(INVALID_HANDLE), mDataHandle(INVALID_HANDLE), mFileAccessProperties(H5P_DEFAULT),
+   mDataAccessProperties(H5P_DEFAULT), mChunkBytes(0)
 {
+   mChunkDims[0] = mChunkDims[1] = mChunkDims[2] = 0;
+
    setName("Hdf5Pager");
    setDescriptorId("{F3720154-8F3A-43e2-BF36-3A810B59218F}");
    setProductionStatus(APP_IS_PRODUCTION_RELEASE);
@@ -98,6 +126,9 @@ bool Hdf5Pager::openFile(const std::string& filename)
       }
    }
 
+   // make LZ4 compressed datasets readable even if the filter plug-in is not installed
+   Hdf5ChunkCodec::registerLz4Filter();
+
    mFileHandle = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, mFileAccessProperties);
    if (mFileHandle == INVALID_HANDLE)
    {
@@ -106,21 +137,42 @@ bool Hdf5Pager::openFile(const std::string& filename)
 
    const string& hdfFullPathAndName = getHdfDatasetName();
 
-   mDataHandle = H5Dopen1(mFileHandle, hdfFullPathAndName.c_str());
+   // the chunk cache is a dataset access property, so the layout is read before the dataset is opened for paging
+   {
+      Hdf5DataSetResource layoutDataset(H5Dopen1(mFileHandle, hdfFullPathAndName.c_str()));
+      if (*layoutDataset == INVALID_HANDLE)
+      {
+         return false;
+      }
+
+      readChunkLayout(*layoutDataset);
+   }
+
+   createDataAccessProperties();
+   mDataHandle = H5Dopen2(mFileHandle, hdfFullPathAndName.c_str(), mDataAccessProperties);
    if (mDataHandle == INVALID_HANDLE)
    {
       return false;
    }
+
+   mpChunkReader.reset(new Hdf5ChunkReader(mDataHandle));
    return true;
 }
 
 void Hdf5Pager::closeFile()
 {
+   mpChunkReader.reset();
+
    if (mFileAccessProperties != H5P_DEFAULT)
    {
       H5Pclose(mFileAccessProperties);
    }
 
+   if (mDataAccessProperties != H5P_DEFAULT)
+   {
+      H5Pclose(mDataAccessProperties);
+   }
+
    if (mDataHandle != INVALID_HANDLE)
    {
       H5Dclose(mDataHandle);
@@ -136,6 +188,193 @@ hid_t Hdf5Pager::getFileHandle()
    return mFileHandle;
 }
 
+void Hdf5Pager::readChunkLayout(hid_t dataset)
+{
+   mChunkDims[0] = mChunkDims[1] = mChunkDims[2] = 0;
+   mChunkBytes = 0;
+
+   Hdf5PropertyListResource creationProperties(H5Dget_create_plist(dataset));
+   if (*creationProperties < 0 || H5Pget_layout(*creationProperties) != H5D_CHUNKED)
+   {
+      return;
+   }
+
+   // two dimensional datasets have a single band
+   hsize_t chunkDims[3] = {1, 1, 1};
+   int rank = H5Pget_chunk(*creationProperties, 3, chunkDims);
+   if (rank == 2)
+   {
+      chunkDims[2] = 1;
+   }
+   else if (rank != 3)
+   {
+      return;
+   }
+
+   memcpy(mChunkDims, chunkDims, sizeof(mChunkDims));
+   mChunkBytes = static_cast<size_t>(mChunkDims[0] * mChunkDims[1] * mChunkDims[2]) * getBytesPerBand();
+}
+
+void Hdf5Pager::createDataAccessProperties()
+{
+   if (mChunkBytes == 0)
+   {
+      return;
+   }
+
+   const RasterElement* pRaster = getRasterElement();
+   VERIFYNRV(pRaster != NULL);
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+   const RasterFileDescriptor* pFileDescriptor =
+      dynamic_cast<const RasterFileDescriptor*>(pDescriptor->getFileDescriptor());
+   VERIFYNRV(pFileDescriptor != NULL);
+
+   // count the chunks in one row of chunks across the extent read for each cache unit
+   const hsize_t columns = static_cast<hsize_t>(getColumnCount());
+   const hsize_t bands = static_cast<hsize_t>(getBandCount());
+   hsize_t chunksAcross = 0;
+   switch (pFileDescriptor->getInterleaveFormat())
+   {
+   case BIP:
+      chunksAcross = ((columns + mChunkDims[1] - 1) / mChunkDims[1]) * ((bands + mChunkDims[2] - 1) / mChunkDims[2]);
+      break;
+   case BIL:
+      chunksAcross = ((bands + mChunkDims[1] - 1) / mChunkDims[1]) * ((columns + mChunkDims[2] - 1) / mChunkDims[2]);
+      break;
+   case BSQ:
+      chunksAcross = (columns + mChunkDims[2] - 1) / mChunkDims[2];
+      break;
+   default:
+      return;
+   }
+
+   size_t cacheBytes = static_cast<size_t>(chunksAcross) * mChunkBytes;
+   cacheBytes = max(cacheBytes, static_cast<size_t>(Hdf5Pager::getSettingCacheSize()));
+   cacheBytes = min(cacheBytes, static_cast<size_t>(Hdf5Pager::getSettingMaxChunkCacheSize()));
+
+   // HDF5 recommends about 100 times as many hash slots as chunks in the cache, using a prime number
+   size_t slotCount = max(static_cast<size_t>(521), 100 * max(cacheBytes / mChunkBytes, static_cast<size_t>(1)));
+   while (isPrime(slotCount) == false)
+   {
+      ++slotCount;
+   }
+
+   // Cache units cover whole chunks, so a chunk which has been read completely will not be needed again.
+   // Row and column subsets of read-only data read partial chunks which are kept longer.
+   double weight = 1.0;
+   if (pDescriptor->getProcessingLocation() == ON_DISK_READ_ONLY &&
+      (pDescriptor->getRowSkipFactor() > 0 || pDescriptor->getColumnSkipFactor() > 0 ||
+      pDescriptor->getColumnCount() != pFileDescriptor->getColumnCount()))
+   {
+      weight = 0.75;
+   }
+
+   mDataAccessProperties = H5Pcreate(H5P_DATASET_ACCESS);
+   if (mDataAccessProperties < 0)
+   {
+      mDataAccessProperties = H5P_DEFAULT;
+   }
+   else if (H5Pset_chunk_cache(mDataAccessProperties, slotCount, cacheBytes, weight) < 0)
+   {
+      H5Pclose(mDataAccessProperties);
+      mDataAccessProperties = H5P_DEFAULT;
+   }
+}
+
+unsigned int Hdf5Pager::getChunkRows() const
+{
+   const RasterElement* pRaster = getRasterElement();
+   if (mChunkBytes == 0 || pRaster == NULL)
+   {
+      return 0;
+   }
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   const RasterFileDescriptor* pFileDescriptor = (pDescriptor == NULL) ? NULL :
+      dynamic_cast<const RasterFileDescriptor*>(pDescriptor->getFileDescriptor());
+   if (pFileDescriptor == NULL)
+   {
+      return 0;
+   }
+
+   // rows are the first dimension of BIP and BIL datasets and the second dimension of BSQ datasets
+   return static_cast<unsigned int>(pFileDescriptor->getInterleaveFormat() == BSQ ? mChunkDims[1] : mChunkDims[0]);
+}
+
+double Hdf5Pager::getChunkSize() const
+{
+   double chunkSize = HdfPager::getChunkSize();
+   unsigned int chunkRows = getChunkRows();
+   if (chunkRows == 0)
+   {
+      return chunkSize;
+   }
+
+   // BSQ cache units hold a single band and the other interleaves hold all bands
+   double rowSize = static_cast<double>(getColumnCount()) * getBytesPerBand();
+   const RasterElement* pRaster = getRasterElement();
+   const RasterDataDescriptor* pDescriptor = (pRaster == NULL) ? NULL :
+      dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   if (pDescriptor != NULL && pDescriptor->getInterleaveFormat() != BSQ)
+   {
+      rowSize *= getBandCount();
+   }
+
+   // use a whole number of rows of chunks unless a single row of chunks is too large to cache
+   double stripSize = chunkRows * rowSize;
+   if (stripSize > Hdf5Pager::getSettingMaxChunkCacheSize())
+   {
+      return chunkSize;
+   }
+
+   return max(1.0, floor(chunkSize / stripSize)) * stripSize;
+}
+
+void Hdf5Pager::alignToChunks(unsigned int& startRow, unsigned int& stopRow,
+                              const RasterDataDescriptor* pDescriptor) const
+{
+   VERIFYNRV(pDescriptor != NULL);
+
+   // rows which are skipped cannot be read as whole chunks
+   unsigned int chunkRows = getChunkRows();
+   if (chunkRows == 0 || pDescriptor->getRowSkipFactor() > 0)
+   {
+      return;
+   }
+
+   const vector<DimensionDescriptor>& rows = pDescriptor->getRows();
+   VERIFYNRV(startRow <= stopRow && stopRow < rows.size());
+
+   unsigned int chunkStart = rows[startRow].getOnDiskNumber() / chunkRows * chunkRows;
+   unsigned int chunkStop = (rows[stopRow].getOnDiskNumber() / chunkRows + 1) * chunkRows;
+
+   unsigned int alignedStart = startRow;
+   while (alignedStart > 0 && rows[alignedStart - 1].getOnDiskNumber() >= chunkStart)
+   {
+      --alignedStart;
+   }
+
+   unsigned int alignedStop = stopRow;
+   while (alignedStop + 1 < rows.size() && rows[alignedStop + 1].getOnDiskNumber() < chunkStop)
+   {
+      ++alignedStop;
+   }
+
+   // datasets with very tall chunks are read in smaller pieces rather than holding entire chunks in the cache
+   double rowSize = static_cast<double>(getColumnCount()) * getBytesPerBand();
+   if (pDescriptor->getInterleaveFormat() != BSQ)
+   {
+      rowSize *= getBandCount();
+   }
+
+   if ((alignedStop - alignedStart + 1) * rowSize <= 2.0 * getChunkSize())
+   {
+      startRow = alignedStart;
+      stopRow = alignedStop;
+   }
+}
+
 CachedPage::UnitPtr Hdf5Pager::fetchUnit(DataRequest *pOriginalRequest)
 {
    CachedPage::UnitPtr pUnit;
@@ -207,6 +446,14 @@ CachedPage::UnitPtr Hdf5Pager::fetchUnit(DataRequest *pOriginalRequest)
    {
       concurrentBands = stopBand.getActiveNumber()-startBand.getActiveNumber()+1;
    }
+
+   // extend the rows to whole rows of chunks so that no chunk is decompressed for more than one cache unit
+   unsigned int firstRow = startRow.getActiveNumber();
+   unsigned int lastRow = firstRow + concurrentRows - 1;
+   alignToChunks(firstRow, lastRow, pDescriptor);
+   startRow = pDescriptor->getRows()[firstRow];
+   concurrentRows = lastRow - firstRow + 1;
+
    bool success = false;
 
    switch (fileInterleave)
@@ -339,10 +586,20 @@ CachedPage::UnitPtr Hdf5Pager::fetchUnit(DataRequest *pOriginalRequest)
       }
    }
 
-   success = 0 == H5Sselect_hyperslab(*dataSpace, H5S_SELECT_SET, offset, stride, counts, NULL);
-   if (success)
+   // decompress the chunks in parallel when the request can be read directly from the stored chunks
+   if (mpChunkReader.get() != NULL && mpChunkReader->isEnabled() && stride[0] == 1 && stride[1] == 1 &&
+      stride[2] == 1)
    {
-      success = 0 == H5Dread(mDataHandle, *loadedType, *memSpace, *dataSpace, H5P_DEFAULT, pData.get());
+      success = mpChunkReader->read(offset, counts, *loadedType, pData.get());
+   }
+
+   if (success == false)
+   {
+      success = 0 == H5Sselect_hyperslab(*dataSpace, H5S_SELECT_SET, offset, stride, counts, NULL);
+      if (success)
+      {
+         success = 0 == H5Dread(mDataHandle, *loadedType, *memSpace, *dataSpace, H5P_DEFAULT, pData.get());
+      }
    }
 
    if (success == false)
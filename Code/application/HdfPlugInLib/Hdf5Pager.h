@@ -14,6 +14,10 @@
 #include "Hdf5PagerFileHandle.h"
 
 #include <hdf5.h>
+#include <memory>
+
+class Hdf5ChunkReader;
+class RasterDataDescriptor;
 
 /**
  * This class is an on-disk accessor for HDF5 files.
@@ -25,12 +29,18 @@
  * or three dimensions.  If used with datasets having two
  * dimensions, the band count must be 1 and the interleave format
  * must be BIP.
+ *
+ * For chunked datasets, cache units are extended to whole rows of chunks
+ * and the raw data chunk cache of the dataset is sized to hold one row of
+ * chunks, so that each chunk is only decompressed once when the data is
+ * read sequentially.
  */
 class Hdf5Pager : public HdfPager, public Hdf5PagerFileHandle
 {
 public:
    SETTING(CacheSize, Hdf5Pager, unsigned int, 1024 * 1024)
    SETTING(ChunkBufferSize, Hdf5Pager, unsigned int, 64 * 1024)
+   SETTING(MaxChunkCacheSize, Hdf5Pager, unsigned int, 64 * 1024 * 1024)
 
    /**
     * Creates an RasterPager for HDF5 data.
@@ -53,12 +63,45 @@ public:
    hid_t getFileHandle();
 
 private:
+#ifdef CPPTESTS // allow testing of the chunk alignment
+   friend class Hdf5PagerChunkTestCase;
+#endif
+
    Hdf5Pager& operator=(const Hdf5Pager& rhs);
 
    // file and data handles.
    hid_t mFileHandle;
    hid_t mDataHandle;
    hid_t mFileAccessProperties;
+   hid_t mDataAccessProperties;
+   std::auto_ptr<Hdf5ChunkReader> mpChunkReader;
+
+   // chunk dimensions of the dataset, which are zero if the dataset is not chunked
+   hsize_t mChunkDims[3];
+   size_t mChunkBytes;
+
+   /**
+    * Reads the chunk dimensions of a dataset.
+    */
+   void readChunkLayout(hid_t dataset);
+
+   /**
+    * Creates the dataset access properties which size the raw data chunk cache to hold
+    * the chunks spanning one cache unit.
+    */
+   void createDataAccessProperties();
+
+   /**
+    * Gets the number of rows in each row of chunks.
+    *
+    * @return The chunk height in rows, or zero if the dataset is not chunked.
+    */
+   unsigned int getChunkRows() const;
+
+   /**
+    * Extends a range of active rows to whole rows of chunks.
+    */
+   void alignToChunks(unsigned int& startRow, unsigned int& stopRow, const RasterDataDescriptor* pDescriptor) const;
 
    /**
     * Opens the HDF5 file and dataset.
@@ -77,6 +120,11 @@ private:
     *  Fetches a cache unit from an HDF5 file.
     */
    CachedPage::UnitPtr fetchUnit(DataRequest *pOriginalRequest);
+
+   /**
+    *  Returns a whole number of rows of chunks for chunked datasets.
+    */
+   double getChunkSize() const;
 };
 
 #endif
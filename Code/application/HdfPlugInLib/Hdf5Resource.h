@@ -735,6 +735,115 @@ public:
 };
 
 
+/**
+ *  The Hdf5PropertyListObject is a trait object for use with the Resource template.
+ *
+ *  The Hdf5PropertyListObject is a trait object for use with the Resource template.
+ *  It provides capability for closing HDF5 property lists.
+ *
+ */
+class Hdf5PropertyListObject
+{
+public:
+   /**
+    * This is an implementation detail of the Hdf5PropertyListObject class. 
+    *
+    */
+   struct Args
+   {
+      /**
+       * Default constructor
+       */
+      Args()
+      {
+      }
+   };
+
+   /**
+    * Obtains an HDF5 property list.
+    *
+    * See Resource.h for details.
+    *
+    * @param  args
+    *         The arguments for obtaining the resource. Should be of type Hdf5PropertyListObject::Args.
+    *
+    * @return Returns NULL
+    */
+   hid_t* obtainResource(const Args &args) const
+   {
+      return NULL;
+   }
+
+   /**
+    * Releases an HDF5 property list.
+    *
+    * See Resource.h for details.
+    *
+    * @param  args
+    *         The arguments for releasing the resource. Should be of type Hdf5PropertyListObject::Args.
+    * @param  pHandle
+    *         A pointer to the handle to be freed.
+    */
+   void releaseResource(const Args &args, hid_t* pHandle) const
+   {
+      if ((pHandle != NULL) && (*pHandle != -1))
+      {
+         H5Pclose(*pHandle);
+         delete pHandle;
+      }
+   }
+};
+
+/**
+ *  This is a Resource class that closes HDF5 property lists. 
+ *
+ *  This is a Resource class that closes HDF5 property lists. It has a conversion
+ *  operator to allow a Hdf5PropertyListResource object to be used where ever a hid_t
+ *  that represents an open HDF5 property list handle may be used.
+ *
+ */
+class Hdf5PropertyListResource : public Resource<hid_t, Hdf5PropertyListObject>
+{
+public:
+   /**
+    * Construct a Resource object that wraps a hid_t HDF5 property list handle
+    *
+    * This will take ownership of an existing hid_t property list handle and 
+    * will ensure that it is closed.
+    *
+    * @param    propertyList
+    *           The HDF5 property list handle.
+    */
+   Hdf5PropertyListResource(hid_t propertyList) :
+      Resource<hid_t, Hdf5PropertyListObject>(new hid_t(propertyList), Args())
+   {
+   }
+
+   /**
+    * Default constructor.
+    */
+   Hdf5PropertyListResource() :
+      Resource<hid_t, Hdf5PropertyListObject>(NULL, Args())
+   {
+   }
+
+   /**
+    *  Returns a pointer to the underlying hid_t held by this Resource.
+    *
+    *  Returns a pointer to the underlying hid_t. This operator,
+    *  used in conjunction with the dereferencing operator,
+    *  allows the Hdf5PropertyListResource object to be used where ever
+    *  a hid_t would normally be used.
+    *
+    *  @return   A pointer to the underlying hid_t held by this Resource.
+    */
+   operator hid_t*()
+   {
+      return get();
+   }
+};
+
+
 /**
  *  The Hdf5GroupObject is a trait object for use with the Resource template.
  *
@@ -13,6 +13,7 @@
 #include "ConfigurationSettings.h"
 #include "Serializable.h"
 #include "Subject.h"
+#include "TypesFile.h"
 
 #include <string>
 #include <vector>
@@ -103,6 +104,31 @@ public:
     */
    virtual bool isBadValue(double value) const = 0;
 
+   /**
+    *  Queries which values in an array are valid data values.
+    *
+    *  This method gives the same result as calling isBadValue() for each value, but is much faster
+    *  when classifying a row or tile of data.  Values of 8 and 16 bit data types are classified
+    *  with a lookup table, and values of other data types with a sorted table of the bad value ranges.
+    *
+    *  @param   pValues
+    *           The values to classify.
+    *  @param   type
+    *           The data type of the values.  Complex data types are not supported.
+    *  @param   count
+    *           The number of values to classify.
+    *  @param   pValidMask
+    *           Receives one byte for each value, which is set to 1 if isBadValue() would return
+    *           \c false for the value and 0 if it would return \c true.
+    *
+    *  @return  Returns \c true if the values were classified; otherwise returns \c false if either
+    *           pointer is \c NULL or the data type is complex.
+    *
+    *  @see     isBadValue()
+    */
+   virtual bool getValidityMask(const void* pValues, EncodingType type, size_t count,
+      unsigned char* pValidMask) const = 0;
+
    /**
     *  Queries whether there is a single bad value range defined. This method can be called instead of calling
     *  isBadValue() repeatedly and is intended to be used when only a single bad value range exists. This allows
@@ -14,6 +14,7 @@
 #include "Filename.h"
 #include "Subject.h"
 #include "Service.h"
+#include "SettingCache.h"
 #include "TypesFile.h"
 
 #include <map>
@@ -23,20 +24,21 @@ class DynamicObject;
 class Filename;
 
 /**
- * This macro creates 4 static functions that
+ * This macro creates 5 static functions that
  * will provide get/set, has and getName functions for
  * a given setting in ConfigurationSettings.  These
  * methods should be used because they create type-safe
- * get/set functions for the given setting.  This macro
- * should be used for non-pointer types, the SETTING_PTR() macro
- * should be used for pointer types.
+ * get/set functions for the given setting.  The get
+ * function caches the value of the setting until a setting
+ * is modified.  This macro should be used for non-pointer
+ * types, the SETTING_PTR() macro should be used for pointer types.
  *
  * Please see \ref settingsmacros for more details
  *
  * @param settingname
- *        the name of the setting.  The three generated methods will
- *        be getSetting[settingname], setSetting[settingname] and
- *        hasSetting[settingname]
+ *        the name of the setting.  The generated methods will
+ *        be getSetting[settingname], getSetting[settingname]Uncached,
+ *        setSetting[settingname] and hasSetting[settingname]
  * @param classname
  *        this will be used to namespace the setting within
  *        ConfigurationSettings, ie. the key used to store
@@ -64,11 +66,32 @@ class Filename;
     * and potentially a verification error message box
     * will be displayed to the user.
     *
+    * The value is cached, so the setting is only looked up
+    * in ConfigurationSettings again after a setting has been
+    * modified.
+    *
     * Please see \ref settingsmacros for more details
     * 
     * \return the current value for this setting.
     */ \
    static type getSetting##settingname() \
+   { \
+      static SettingCache< type > sCache; \
+      return sCache.get(&getSetting##settingname##Uncached); \
+   } \
+   /**
+    * Returns the current value for this setting, looking it
+    * up in ConfigurationSettings instead of using the cached
+    * value.  If this setting does not exist in
+    * ConfigurationSettings, a verification error will be
+    * logged to the message log and potentially a verification
+    * error message box will be displayed to the user.
+    *
+    * Please see \ref settingsmacros for more details
+    *
+    * \return the current value for this setting.
+    */ \
+   static type getSetting##settingname##Uncached() \
    { \
       Service<ConfigurationSettings> pSettings; \
       return dv_cast_with_verification< type >(pSettings->getSetting(getSetting##settingname##Key()), errorDefault); \
@@ -682,6 +705,25 @@ public:
     */
    virtual std::string getPlugInPath() const = 0;
 
+   /**
+    * Gets the path of a file kept with the user's settings.
+    *
+    * Plug-ins can use this to persist data which changes too often to be
+    * stored as a setting, such as caches.  The file name includes the
+    * application version, operating system and architecture, so each
+    * installation uses its own file.  The file is not created.
+    *
+    * @param   filePrefix
+    *          The name of the file, without the version or extension.
+    * @param   fileExtension
+    *          The extension of the file, without the leading period.
+    *
+    * @return  The full path and name of the file, or an empty string if the
+    *          user configuration directory does not exist.
+    */
+   virtual std::string getUserStorageFilePath(const std::string& filePrefix,
+      const std::string& fileExtension) const = 0;
+
    /**
     * Sets the given setting.
     *
@@ -125,6 +125,15 @@ public:
     */
    virtual std::vector<MessageLog*> getLogs() const = 0;
 
+   /**
+    *  Writes all pending journal entries to the journal file.
+    *
+    *  Journal entries for every log are written to a common journal file on a
+    *  background thread.  This method blocks until all entries added before
+    *  the call have been written to the file.
+    */
+   virtual void flushJournal() = 0;
+
 protected:
    /**
     * This will be cleaned up during application close.  Plug-ins do not
@@ -723,6 +723,34 @@ public:
     */
    virtual void deleteMemoryBlock(char* memory) = 0; 
 
+   /**
+    *  Gets the memory budget shared by all raster elements which spill to disk.
+    *
+    *  Raster elements with a processing location of
+    *  \link ProcessingLocation::IN_MEMORY_SPILLABLE IN_MEMORY_SPILLABLE \endlink
+    *  write their least recently used blocks to temporary files when the
+    *  memory they hold together exceeds this budget.  The budget is taken
+    *  from the SpillingPager::MemoryBudget setting.  Blocks which are in use
+    *  are never spilled, so the resident size can temporarily exceed the
+    *  budget.
+    *
+    *  @return  The memory budget in bytes.
+    *
+    *  @see     getSpillableResidentSize()
+    */
+   virtual uint64_t getSpillableMemoryBudget() const = 0;
+
+   /**
+    *  Gets the memory currently held by all raster elements which spill to disk.
+    *
+    *  @return  The number of bytes of raster data held in memory by raster
+    *           elements with a processing location of
+    *           \link ProcessingLocation::IN_MEMORY_SPILLABLE IN_MEMORY_SPILLABLE \endlink.
+    *
+    *  @see     getSpillableMemoryBudget()
+    */
+   virtual uint64_t getSpillableResidentSize() const = 0;
+
    /**
     *  This static method retrieves an individual data value from a block of memory.
     *
@@ -47,6 +47,12 @@ class PointCloudElement;
  *  - ZoomOutMode
  *  - ZoomBoxMode
  *
+ *  Once a level of detail octree has been built for the point cloud, only the
+ *  parts of the octree within the view are drawn.  Coarse parts are refined
+ *  until the points are about one point size apart or the PointBudget setting
+ *  is reached.  The octree is saved next to the point cloud's file so it only
+ *  needs to be built the first time the file is displayed.
+ *
  *  This subclass of Subject will notify upon the following conditions:
  *  - Everything else documented in PerspectiveView.
  *  - set* methods are called
@@ -54,6 +60,8 @@ class PointCloudElement;
 class PointCloudView : public PerspectiveView
 {
 public:
+   SETTING(PointBudget, PointCloudView, unsigned int, 5000000)
+
    /**
     * Mutator to attach a point cloud to the view.
     *
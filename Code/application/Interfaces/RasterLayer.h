@@ -50,6 +50,8 @@ class Statistics;
 class RasterLayer : public Layer
 {
 public:
+   SETTING(AnimationPrefetchCacheSize, RasterLayer, unsigned int, 128)
+   SETTING(AnimationPrefetchFrames, RasterLayer, unsigned int, 4)
    SETTING(BackgroundTileGeneration, RasterLayer, bool, false)
    SETTING(ComplexComponent, RasterLayer, ComplexComponent, COMPLEX_MAGNITUDE)
    SETTING(GrayscaleStretchUnits, RasterLayer, RegionUnits, PERCENTILE)
@@ -10,6 +10,7 @@
 #ifndef SIGNATURE_LIBRARY_H
 #define SIGNATURE_LIBRARY_H
 
+#include "ConfigurationSettings.h"
 #include "SignatureSet.h"
 
 #include <map>
@@ -47,6 +48,14 @@ class RasterElement;
 class SignatureLibrary : public SignatureSet
 {
 public:
+   /**
+    *  The interpolation used by resample().
+    *
+    *  Valid values are "Linear", "Cubic Spline" and "Gaussian".  Any other
+    *  value is treated as "Linear".
+    */
+   SETTING(ResamplingMethod, SignatureLibrary, std::string, "Linear")
+
    /**
     *  Returns the values that the signature ordinate data is currently sampled
     *  to.
@@ -173,6 +182,12 @@ public:
     *  fails for any other reason, this method will fail and will leave the
     *  ordinate data unsampled.
     *
+    *  The ordinate data is interpolated to the abscissa with the method
+    *  given by getSettingResamplingMethod().  The data from the most recent
+    *  resamplings is kept, so resampling back to an abscissa which was
+    *  recently used does not read the raw ordinate data again.  The kept data
+    *  is discarded when the resampling method changes.
+    *
     *  @param   abscissa
     *           The abscissa values to resample the ordinate data to. If this 
     *           is empty, the ordinate data will not be resampled and 
@@ -189,7 +204,8 @@ public:
     *
     *  Frees up all resources associated with resampling the library. The 
     *  library is restored to the state it was in immediately after being
-    *  imported, but before being resampled.
+    *  imported, but before being resampled.  This includes the data kept
+    *  from earlier calls to resample().
     *
     *  @notify  This method will notify Subject::signalModified.
     */
@@ -184,8 +184,29 @@ private:
     */
    virtual void enableSignals(bool enabled) = 0;
 
+   /**
+    *  Starts coalescing the signals notified by this %Subject.
+    *
+    *  Calls may be nested.  Signals are held until endSignalBatch() has been
+    *  called once for each call to this method.  The default implementation
+    *  does not hold any signals.
+    *
+    *  @see     SignalBatcher
+    */
+   virtual void beginSignalBatch() {}
+
+   /**
+    *  Ends a batch started with beginSignalBatch(), delivering the held
+    *  signals when the outermost batch ends.  The default implementation
+    *  does nothing.
+    *
+    *  @see     SignalBatcher
+    */
+   virtual void endSignalBatch() {}
+
 friend class SignalEnabler;
 friend class SignalBlocker;
+friend class SignalBatcher;
 #ifdef CPPTESTS
 friend class SubjectObserverTest;
 #endif
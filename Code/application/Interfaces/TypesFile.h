@@ -647,9 +647,21 @@ enum ProcessingLocationEnum
                              entire time the cube is loaded into the application.\   It is up to the RasterPager
                              implementations to uphold this requirement.  Please see above for
                              information on how to determine if the data may be overwritten. */
-   IN_MEMORY_EXISTING   /**< The cube data is loaded entirely into memory, and the data can be accessed
+   IN_MEMORY_EXISTING,  /**< The cube data is loaded entirely into memory, and the data can be accessed
                              directly.\   The object creating the raster element must provide an existing memory
                              block to be used as the data for the element by calling RasterElement::setRawData().*/
+   IN_MEMORY_COMPRESSED, /**< The cube data is held in memory as independently compressed blocks of rows.\   Blocks
+                             are decompressed on demand into a small working set and recompressed when modified,
+                             so the data can be read and written while using far less memory than
+                             \link ProcessingLocation::IN_MEMORY IN_MEMORY \endlink for data which compresses
+                             well, such as classification maps, masks and sparse results.\   The cube data
+                             cannot be accessed directly through RasterElement::getRawData(). */
+   IN_MEMORY_SPILLABLE  /**< The cube data is held in memory as blocks of rows until the memory used by all
+                             spillable cubes exceeds the SpillingPager::MemoryBudget setting.\   The least recently
+                             used blocks are then written to a temporary file and read back when they are next
+                             accessed, so results which fit in the budget never touch the disk while larger
+                             results degrade gracefully instead of failing to allocate.\   The cube data cannot be
+                             accessed directly through RasterElement::getRawData(). */
 };
 
 /**
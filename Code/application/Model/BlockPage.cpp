@@ -0,0 +1,57 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "BlockPage.h"
+
+BlockPage::BlockPage(void* pUnit, void* pData, unsigned int numRows, bool writable) :
+   mpUnit(pUnit),
+   mpData(pData),
+   mNumRows(numRows),
+   mWritable(writable)
+{
+}
+
+BlockPage::~BlockPage()
+{
+}
+
+void* BlockPage::getRawData()
+{
+   return mpData;
+}
+
+unsigned int BlockPage::getNumRows()
+{
+   return mNumRows;
+}
+
+unsigned int BlockPage::getNumColumns()
+{
+   return 0;
+}
+
+unsigned int BlockPage::getNumBands()
+{
+   return 0;
+}
+
+unsigned int BlockPage::getInterlineBytes()
+{
+   return 0;
+}
+
+void* BlockPage::getUnit() const
+{
+   return mpUnit;
+}
+
+bool BlockPage::isWritable() const
+{
+   return mWritable;
+}
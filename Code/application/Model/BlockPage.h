@@ -0,0 +1,37 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef BLOCKPAGE_H
+#define BLOCKPAGE_H
+
+#include "RasterPage.h"
+
+class BlockPage : public RasterPage
+{
+public:
+   BlockPage(void* pUnit, void* pData, unsigned int numRows, bool writable);
+   ~BlockPage();
+
+   void* getRawData();
+   unsigned int getNumRows();
+   unsigned int getNumColumns();
+   unsigned int getNumBands();
+   unsigned int getInterlineBytes();
+
+   void* getUnit() const;
+   bool isWritable() const;
+
+private:
+   void* mpUnit;
+   void* mpData;
+   unsigned int mNumRows;
+   bool mWritable;
+};
+
+#endif
@@ -0,0 +1,400 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "BlockPage.h"
+#include "BlockPager.h"
+#include "DataRequest.h"
+#include "PlugInArgList.h"
+#include "PlugInManagerServices.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+
+#include <algorithm>
+
+using namespace std;
+
+BlockPager::BlockPager(unsigned int blockSize) :
+   mpRaster(NULL),
+   mInterleave(BIP),
+   mNumRows(0),
+   mNumColumns(0),
+   mNumBands(0),
+   mBytesPerElement(0),
+   mRowBytes(0),
+   mRowsPerBlock(0),
+   mBlocksPerPlane(0),
+   mBlockSize(blockSize),
+   mResidentBytes(0)
+{
+}
+
+BlockPager::~BlockPager()
+{
+}
+
+bool BlockPager::getInputSpecification(PlugInArgList*& pArgList)
+{
+   Service<PlugInManagerServices> pPlugInMgr;
+
+   pArgList = pPlugInMgr->getPlugInArgList();
+   VERIFY(pArgList != NULL);
+
+   VERIFY(pArgList->addArg<RasterElement>("Raster Element"));
+   VERIFY(pArgList->addArg<unsigned int>("Block Size", mBlockSize, "Target number of bytes in each block."));
+
+   return true;
+}
+
+bool BlockPager::execute(PlugInArgList* pInput, PlugInArgList* pOutput)
+{
+   VERIFY(mpRaster == NULL);
+   VERIFY(pInput != NULL);
+
+   mpRaster = pInput->getPlugInArgValue<RasterElement>("Raster Element");
+   VERIFY(mpRaster != NULL);
+
+   pInput->getPlugInArgValue("Block Size", mBlockSize);
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(mpRaster->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   mInterleave = pDescriptor->getInterleaveFormat();
+   mNumRows = pDescriptor->getRowCount();
+   mNumColumns = pDescriptor->getColumnCount();
+   mNumBands = pDescriptor->getBandCount();
+   mBytesPerElement = pDescriptor->getBytesPerElement();
+   VERIFY(mNumRows > 0 && mNumColumns > 0 && mNumBands > 0 && mBytesPerElement > 0);
+
+   // A row is the unit of storage which is contiguous in the native interleave.
+   // BSQ data is stored as one plane per band, the other interleaves as a single plane.
+   unsigned int numPlanes = 1;
+   mRowBytes = static_cast<size_t>(mNumColumns) * mNumBands * mBytesPerElement;
+   if (mInterleave == BSQ)
+   {
+      numPlanes = mNumBands;
+      mRowBytes = static_cast<size_t>(mNumColumns) * mBytesPerElement;
+   }
+
+   mRowsPerBlock = static_cast<unsigned int>(max(static_cast<size_t>(1), mBlockSize / mRowBytes));
+   mRowsPerBlock = min(mRowsPerBlock, mNumRows);
+   mBlocksPerPlane = (mNumRows + mRowsPerBlock - 1) / mRowsPerBlock;
+   mUnits.resize(static_cast<size_t>(numPlanes) * mBlocksPerPlane, NULL);
+
+   return true;
+}
+
+RasterPage* BlockPager::getPage(DataRequest* pOriginalRequest, DimensionDescriptor startRow,
+                                DimensionDescriptor startColumn, DimensionDescriptor startBand)
+{
+   VERIFYRV(mpRaster != NULL, NULL);
+   VERIFYRV(pOriginalRequest != NULL, NULL);
+
+   if (pOriginalRequest->getInterleaveFormat() != mInterleave)
+   {
+      return NULL;
+   }
+
+   unsigned int rowNumber = startRow.getActiveNumber();
+   unsigned int columnNumber = startColumn.getActiveNumber();
+   unsigned int bandNumber = startBand.getActiveNumber();
+   if (rowNumber >= mNumRows || columnNumber >= mNumColumns || bandNumber >= mNumBands)
+   {
+      return NULL;
+   }
+
+   unsigned int plane = (mInterleave == BSQ ? bandNumber : 0);
+   unsigned int blockIndex = plane * mBlocksPerPlane + rowNumber / mRowsPerBlock;
+
+   mta::DMutex& mutex = getMutex();
+   mta::MutexLock lock(mutex);
+
+   Unit* pUnit = mUnits[blockIndex];
+   if (pUnit == NULL)
+   {
+      // The unit starts at a block boundary, so include the rows in front of the requested row
+      unsigned int concurrentRows = max(pOriginalRequest->getConcurrentRows(), 1U) + rowNumber % mRowsPerBlock;
+      pUnit = createUnit(blockIndex, concurrentRows);
+
+      // The unit owns its blocks while it is busy, so they can be loaded without the lock
+      mutex.MutexUnlock();
+      bool success = loadUnit(pUnit);
+      mutex.MutexLock();
+
+      if (success == false)
+      {
+         releaseBlocks(pUnit);
+         pUnit->mFailed = true;
+      }
+
+      pUnit->mBusy = false;
+      getUnitReady().ThreadSignalBroadcast();
+   }
+   else
+   {
+      if (pUnit->mRefCount == 0 && pUnit->mBusy == false)
+      {
+         getIdleUnits().remove(pUnit);
+      }
+
+      ++pUnit->mRefCount;
+
+      // Wait for another thread to finish loading or storing the unit
+      while (pUnit->mBusy)
+      {
+         getUnitReady().ThreadSignalWait(&mutex);
+      }
+   }
+
+   if (pUnit->mFailed)
+   {
+      if (--pUnit->mRefCount == 0)
+      {
+         delete pUnit;
+      }
+
+      VERIFYRV_MSG(false, NULL, "Unable to load a raster block");
+   }
+
+   // Make room for the unit now that it can no longer be removed from memory
+   trimUnits();
+
+   size_t offset = static_cast<size_t>(rowNumber - pUnit->mStartRow) * mRowBytes;
+   switch (mInterleave)
+   {
+   case BIP:
+      offset += (static_cast<size_t>(columnNumber) * mNumBands + bandNumber) * mBytesPerElement;
+      break;
+   case BIL:
+      offset += (static_cast<size_t>(bandNumber) * mNumColumns + columnNumber) * mBytesPerElement;
+      break;
+   case BSQ:
+      offset += static_cast<size_t>(columnNumber) * mBytesPerElement;
+      break;
+   default:
+      break;
+   }
+
+   unsigned int numRows = pUnit->mStartRow + pUnit->mRowCount - rowNumber;
+   return new BlockPage(pUnit, &pUnit->mData[offset], numRows, pOriginalRequest->getWritable());
+}
+
+void BlockPager::releasePage(RasterPage* pPage)
+{
+   BlockPage* pBlockPage = dynamic_cast<BlockPage*>(pPage);
+   if (pBlockPage == NULL)
+   {
+      return;
+   }
+
+   {
+      mta::MutexLock lock(getMutex());
+
+      Unit* pUnit = reinterpret_cast<Unit*>(pBlockPage->getUnit());
+      if (pUnit != NULL)
+      {
+         if (pBlockPage->isWritable())
+         {
+            pUnit->mDirty = true;
+         }
+
+         if (--pUnit->mRefCount == 0 && pUnit->mDirty && isStoredOnRelease())
+         {
+            // Pages requested in the meantime wait until the unit is stored
+            flushUnit(pUnit);
+         }
+
+         if (pUnit->mRefCount == 0)
+         {
+            getIdleUnits().push_front(pUnit);
+            trimUnits();
+         }
+      }
+   }
+
+   delete pBlockPage;
+}
+
+int BlockPager::getSupportedRequestVersion() const
+{
+   return 1;
+}
+
+unsigned int BlockPager::getBlockCount() const
+{
+   return static_cast<unsigned int>(mUnits.size());
+}
+
+unsigned int BlockPager::getRowsPerBlock() const
+{
+   return mRowsPerBlock;
+}
+
+void BlockPager::residentSizeChanged(int64_t bytes)
+{
+}
+
+bool BlockPager::flushUnit(Unit* pUnit)
+{
+   VERIFY(pUnit != NULL && pUnit->mBusy == false);
+
+   mta::DMutex& mutex = getMutex();
+   pUnit->mBusy = true;
+   pUnit->mDirty = false;
+   mutex.MutexUnlock();
+   bool success = storeUnit(pUnit);
+   mutex.MutexLock();
+
+   if (success == false)
+   {
+      // Keep the unit in memory rather than losing its data
+      pUnit->mDirty = true;
+   }
+
+   pUnit->mBusy = false;
+   getUnitReady().ThreadSignalBroadcast();
+   return success;
+}
+
+void BlockPager::unloadUnit(Unit* pUnit)
+{
+   VERIFYNRV(pUnit != NULL && pUnit->mRefCount == 0 && pUnit->mBusy == false);
+
+   releaseBlocks(pUnit);
+   delete pUnit;
+}
+
+void BlockPager::deleteUnits()
+{
+   // Another pager can be storing a unit of this pager to make room for its own units,
+   // and returns the unit to the idle units if it cannot be stored
+   list<Unit*>& idleUnits = getIdleUnits();
+   bool busy = true;
+   while (busy)
+   {
+      for (list<Unit*>::iterator iter = idleUnits.begin(); iter != idleUnits.end();)
+      {
+         if ((*iter)->mpPager == this)
+         {
+            iter = idleUnits.erase(iter);
+         }
+         else
+         {
+            ++iter;
+         }
+      }
+
+      busy = false;
+      for (vector<Unit*>::iterator iter = mUnits.begin(); iter != mUnits.end() && busy == false; ++iter)
+      {
+         busy = (*iter != NULL && (*iter)->mBusy);
+      }
+
+      if (busy)
+      {
+         getUnitReady().ThreadSignalWait(&getMutex());
+      }
+   }
+
+   for (vector<Unit*>::iterator iter = mUnits.begin(); iter != mUnits.end(); ++iter)
+   {
+      Unit* pUnit = *iter;
+      if (pUnit != NULL)
+      {
+         // Clear every block owned by the unit before deleting it
+         releaseBlocks(pUnit);
+         delete pUnit;
+      }
+   }
+}
+
+uint64_t BlockPager::getResidentBytes() const
+{
+   return mResidentBytes;
+}
+
+uint64_t BlockPager::getDataSize() const
+{
+   return static_cast<uint64_t>(mUnits.size() / max(mBlocksPerPlane, 1U)) * mNumRows * mRowBytes;
+}
+
+unsigned int BlockPager::getBytesPerElement() const
+{
+   return mBytesPerElement;
+}
+
+int64_t BlockPager::getBlockOffset(unsigned int blockIndex) const
+{
+   unsigned int plane = blockIndex / mBlocksPerPlane;
+   unsigned int startRow = (blockIndex % mBlocksPerPlane) * mRowsPerBlock;
+   return (static_cast<int64_t>(plane) * mNumRows + startRow) * static_cast<int64_t>(mRowBytes);
+}
+
+size_t BlockPager::getBlockBytes(unsigned int blockIndex) const
+{
+   unsigned int startRow = (blockIndex % mBlocksPerPlane) * mRowsPerBlock;
+   unsigned int numRows = min(mRowsPerBlock, mNumRows - startRow);
+   return static_cast<size_t>(numRows) * mRowBytes;
+}
+
+BlockPager::Unit* BlockPager::createUnit(unsigned int blockIndex, unsigned int concurrentRows)
+{
+   unsigned int planeStart = (blockIndex / mBlocksPerPlane) * mBlocksPerPlane;
+   unsigned int planeEnd = planeStart + mBlocksPerPlane;
+   unsigned int startRow = (blockIndex - planeStart) * mRowsPerBlock;
+
+   // Span as many consecutive non-resident blocks as needed to satisfy the concurrent rows.
+   // A block is only ever owned by a single unit so that writes are never lost.
+   unsigned int blockCount = 0;
+   unsigned int rowCount = 0;
+   size_t dataSize = 0;
+   while (blockIndex + blockCount < planeEnd && (blockCount == 0 || rowCount < concurrentRows))
+   {
+      if (mUnits[blockIndex + blockCount] != NULL)
+      {
+         break;
+      }
+
+      dataSize += getBlockBytes(blockIndex + blockCount);
+      rowCount += static_cast<unsigned int>(getBlockBytes(blockIndex + blockCount) / mRowBytes);
+      ++blockCount;
+   }
+
+   Unit* pUnit = new Unit;
+   pUnit->mpPager = this;
+   pUnit->mFirstBlock = blockIndex;
+   pUnit->mBlockCount = blockCount;
+   pUnit->mStartRow = startRow;
+   pUnit->mRowCount = rowCount;
+   pUnit->mRefCount = 1;
+   pUnit->mDirty = false;
+   pUnit->mBusy = true;
+   pUnit->mFailed = false;
+   pUnit->mData.resize(dataSize);
+
+   for (unsigned int i = 0; i < blockCount; ++i)
+   {
+      mUnits[blockIndex + i] = pUnit;
+   }
+
+   mResidentBytes += dataSize;
+   residentSizeChanged(static_cast<int64_t>(dataSize));
+   return pUnit;
+}
+
+void BlockPager::releaseBlocks(Unit* pUnit)
+{
+   for (unsigned int i = 0; i < pUnit->mBlockCount; ++i)
+   {
+      mUnits[pUnit->mFirstBlock + i] = NULL;
+   }
+
+   mResidentBytes -= pUnit->mData.size();
+   residentSizeChanged(-static_cast<int64_t>(pUnit->mData.size()));
+}
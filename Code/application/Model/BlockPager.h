@@ -0,0 +1,151 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef BLOCKPAGER_H
+#define BLOCKPAGER_H
+
+#include "DMutex.h"
+#include "RasterPagerShell.h"
+#include "TypesFile.h"
+
+#include <list>
+#include <vector>
+
+class RasterElement;
+
+/**
+ *  Holds the cube in memory as blocks of rows which are stored elsewhere when
+ *  they are not in use.
+ *
+ *  A page is served from a unit, which holds one or more consecutive blocks
+ *  of a plane in memory.  Derived pagers decide how blocks are stored and
+ *  when idle units are removed from memory.  Units are loaded and stored
+ *  without holding the lock, so concurrent users of different blocks do not
+ *  wait on each other.
+ */
+class BlockPager : public RasterPagerShell
+{
+public:
+   ~BlockPager();
+
+   bool getInputSpecification(PlugInArgList*& pArgList);
+   bool execute(PlugInArgList* pInput, PlugInArgList* pOutput);
+
+   RasterPage* getPage(DataRequest* pOriginalRequest, DimensionDescriptor startRow, DimensionDescriptor startColumn,
+      DimensionDescriptor startBand);
+   void releasePage(RasterPage* pPage);
+
+   int getSupportedRequestVersion() const;
+
+   unsigned int getBlockCount() const;
+   unsigned int getRowsPerBlock() const;
+
+protected:
+   BlockPager(unsigned int blockSize);
+
+   struct Unit
+   {
+      BlockPager* mpPager;
+      unsigned int mFirstBlock;
+      unsigned int mBlockCount;
+      unsigned int mStartRow;
+      unsigned int mRowCount;
+      std::vector<char> mData;
+      int mRefCount;
+      bool mDirty;
+      bool mBusy;      // the unit is being loaded or stored
+      bool mFailed;    // the unit could not be loaded
+   };
+
+   /**
+    *  Gets the lock which protects the units and the idle units.
+    */
+   virtual mta::DMutex& getMutex() const = 0;
+
+   /**
+    *  Gets the signal which is broadcast when a unit is no longer busy.
+    */
+   virtual mta::DThreadSignal& getUnitReady() const = 0;
+
+   /**
+    *  Gets the units which are not in use, with the most recently used first.
+    */
+   virtual std::list<Unit*>& getIdleUnits() = 0;
+
+   /**
+    *  Removes idle units from memory.  Called with the lock held.
+    */
+   virtual void trimUnits() = 0;
+
+   /**
+    *  Reads the blocks of a new unit into its data.  Called without the lock while the unit is busy.
+    */
+   virtual bool loadUnit(Unit* pUnit) = 0;
+
+   /**
+    *  Writes the data of a modified unit to its blocks.  Called without the lock while the unit is busy.
+    */
+   virtual bool storeUnit(Unit* pUnit) = 0;
+
+   /**
+    *  Returns \c true if modified units are stored as soon as their last page is released,
+    *  or \c false if they are stored by trimUnits().
+    */
+   virtual bool isStoredOnRelease() const = 0;
+
+   /**
+    *  Called with the lock held when units are added to or removed from memory.
+    */
+   virtual void residentSizeChanged(int64_t bytes);
+
+   /**
+    *  Stores a modified unit without holding the lock.  Called with the lock held, which is held again on return.
+    */
+   bool flushUnit(Unit* pUnit);
+
+   /**
+    *  Removes an idle unit from memory and deletes it.  Called with the lock held.
+    */
+   void unloadUnit(Unit* pUnit);
+
+   /**
+    *  Waits until no unit is busy and deletes every unit.  Derived pagers call this with the lock
+    *  held from their destructor.
+    */
+   void deleteUnits();
+
+   uint64_t getResidentBytes() const;
+   uint64_t getDataSize() const;
+   unsigned int getBytesPerElement() const;
+   int64_t getBlockOffset(unsigned int blockIndex) const;
+   size_t getBlockBytes(unsigned int blockIndex) const;
+
+private:
+   BlockPager(const BlockPager& rhs);
+   BlockPager& operator=(const BlockPager& rhs);
+
+   Unit* createUnit(unsigned int blockIndex, unsigned int concurrentRows);
+   void releaseBlocks(Unit* pUnit);
+
+   RasterElement* mpRaster;
+   InterleaveFormatType mInterleave;
+   unsigned int mNumRows;
+   unsigned int mNumColumns;
+   unsigned int mNumBands;
+   unsigned int mBytesPerElement;
+   size_t mRowBytes;
+   unsigned int mRowsPerBlock;
+   unsigned int mBlocksPerPlane;
+   unsigned int mBlockSize;
+
+   std::vector<Unit*> mUnits;   // the unit which holds each block, or NULL
+   uint64_t mResidentBytes;
+};
+
+#endif
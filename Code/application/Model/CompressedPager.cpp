@@ -0,0 +1,214 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVersion.h"
+#include "AppVerify.h"
+#include "BlockCompression.h"
+#include "CompressedPager.h"
+#include "PlugInArgList.h"
+
+#include <string.h>
+
+using namespace std;
+
+CompressedPager::CompressedPager() :
+   BlockPager(256 * 1024),
+   mShuffle(true),
+   mMaxWorkingSetSize(64 * 1024 * 1024),
+   mCompressedSize(0)
+{
+   setName("Compressed Pager");
+   setCopyright("Copyright (2020) by Ball Aerospace & Technologies Corp.");
+   setCreator("Ball Aerospace & Technologies Corp.");
+   setDescription("Provides access to data held in memory as independently compressed blocks");
+   setDescriptorId("{0B7A2E5C-3F64-4B1E-9C2D-6A8E41D57F93}");
+   setVersion(APP_VERSION_NUMBER);
+   setProductionStatus(APP_IS_PRODUCTION_RELEASE);
+   setShortDescription("Provides a compressed RAM backing for data");
+}
+
+CompressedPager::~CompressedPager()
+{
+   mta::MutexLock lock(mMutex);
+   deleteUnits();
+}
+
+bool CompressedPager::getInputSpecification(PlugInArgList*& pArgList)
+{
+   VERIFY(BlockPager::getInputSpecification(pArgList));
+
+   unsigned int workingSetSize = getSettingWorkingSetSize();
+   VERIFY(pArgList->addArg<bool>("Shuffle", mShuffle, "Byte-shuffle multi-byte elements before compression."));
+   VERIFY(pArgList->addArg<unsigned int>("Working Set Size", workingSetSize,
+      "Maximum size in MB of the decompressed blocks which are retained for reuse."));
+
+   return true;
+}
+
+bool CompressedPager::execute(PlugInArgList* pInput, PlugInArgList* pOutput)
+{
+   VERIFY(BlockPager::execute(pInput, pOutput));
+
+   pInput->getPlugInArgValue("Shuffle", mShuffle);
+   unsigned int workingSetSize = getSettingWorkingSetSize();
+   pInput->getPlugInArgValue("Working Set Size", workingSetSize);
+   mMaxWorkingSetSize = static_cast<uint64_t>(workingSetSize) * 1024 * 1024;
+
+   // Blocks start out as zero which does not require any compressed storage
+   mBlocks.resize(getBlockCount());
+
+   return true;
+}
+
+uint64_t CompressedPager::getCompressedSize() const
+{
+   mta::MutexLock lock(mMutex);
+   return mCompressedSize;
+}
+
+uint64_t CompressedPager::getWorkingSetSize() const
+{
+   mta::MutexLock lock(mMutex);
+   return getResidentBytes();
+}
+
+mta::DMutex& CompressedPager::getMutex() const
+{
+   return mMutex;
+}
+
+mta::DThreadSignal& CompressedPager::getUnitReady() const
+{
+   return mUnitReady;
+}
+
+list<BlockPager::Unit*>& CompressedPager::getIdleUnits()
+{
+   return mIdleUnits;
+}
+
+void CompressedPager::trimUnits()
+{
+   list<Unit*>::iterator iter = mIdleUnits.end();
+   while (getResidentBytes() > mMaxWorkingSetSize && iter != mIdleUnits.begin())
+   {
+      --iter;
+      Unit* pUnit = *iter;
+
+      // Idle units were compressed when their last page was released, unless compression failed
+      if (pUnit->mDirty)
+      {
+         continue;
+      }
+
+      iter = mIdleUnits.erase(iter);
+      unloadUnit(pUnit);
+   }
+}
+
+bool CompressedPager::loadUnit(Unit* pUnit)
+{
+   VERIFY(pUnit != NULL);
+
+   unsigned int bytesPerElement = getBytesPerElement();
+   vector<char> shuffled;
+   size_t offset = 0;
+   for (unsigned int i = 0; i < pUnit->mBlockCount; ++i)
+   {
+      const Block& block = mBlocks[pUnit->mFirstBlock + i];
+      size_t blockBytes = getBlockBytes(pUnit->mFirstBlock + i);
+      char* pDest = &pUnit->mData[offset];
+      offset += blockBytes;
+
+      if (block.mZero)
+      {
+         memset(pDest, 0, blockBytes);
+      }
+      else if (mShuffle && bytesPerElement > 1)
+      {
+         shuffled.resize(blockBytes);
+         if (!BlockCompression::decompress(&block.mCompressed[0], block.mCompressed.size(), &shuffled[0], blockBytes))
+         {
+            return false;
+         }
+         BlockCompression::unshuffle(&shuffled[0], pDest, blockBytes / bytesPerElement, bytesPerElement);
+      }
+      else if (!BlockCompression::decompress(&block.mCompressed[0], block.mCompressed.size(), pDest, blockBytes))
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool CompressedPager::storeUnit(Unit* pUnit)
+{
+   VERIFY(pUnit != NULL);
+
+   // Compress every block before replacing any of them, so a failure leaves the stored blocks intact
+   vector<vector<char> > compressedBlocks(pUnit->mBlockCount);
+   unsigned int bytesPerElement = getBytesPerElement();
+   vector<char> shuffled;
+   size_t offset = 0;
+   for (unsigned int i = 0; i < pUnit->mBlockCount; ++i)
+   {
+      size_t blockBytes = getBlockBytes(pUnit->mFirstBlock + i);
+      const char* pSource = &pUnit->mData[offset];
+      offset += blockBytes;
+
+      // All zero blocks are common in sparse results and need no storage, so they are left empty
+      if (pSource[0] == 0 && memcmp(pSource, pSource + 1, blockBytes - 1) == 0)
+      {
+         continue;
+      }
+
+      if (mShuffle && bytesPerElement > 1)
+      {
+         shuffled.resize(blockBytes);
+         BlockCompression::shuffle(pSource, &shuffled[0], blockBytes / bytesPerElement, bytesPerElement);
+         pSource = &shuffled[0];
+      }
+
+      vector<char>& compressed = compressedBlocks[i];
+      compressed.resize(BlockCompression::getMaxCompressedSize(blockBytes));
+      size_t compressedSize = BlockCompression::compress(pSource, blockBytes, &compressed[0], compressed.size());
+      VERIFY(compressedSize > 0);
+      compressed.resize(compressedSize);
+   }
+
+   // The unit owns its blocks while it is busy, so only the total size needs the lock
+   int64_t sizeChange = 0;
+   for (unsigned int i = 0; i < pUnit->mBlockCount; ++i)
+   {
+      Block& block = mBlocks[pUnit->mFirstBlock + i];
+      sizeChange -= static_cast<int64_t>(block.mCompressed.size());
+      block.mZero = compressedBlocks[i].empty();
+      if (block.mZero)
+      {
+         vector<char>().swap(block.mCompressed);
+      }
+      else
+      {
+         // Release the excess capacity reserved for the worst case
+         vector<char>(compressedBlocks[i].begin(), compressedBlocks[i].end()).swap(block.mCompressed);
+      }
+
+      sizeChange += static_cast<int64_t>(block.mCompressed.size());
+   }
+
+   mta::MutexLock lock(mMutex);
+   mCompressedSize += sizeChange;
+   return true;
+}
+
+bool CompressedPager::isStoredOnRelease() const
+{
+   return true;
+}
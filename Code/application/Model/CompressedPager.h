@@ -0,0 +1,75 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef COMPRESSEDPAGER_H
+#define COMPRESSEDPAGER_H
+
+#include "BlockPager.h"
+#include "ConfigurationSettings.h"
+#include "DMutex.h"
+
+#include <list>
+#include <vector>
+
+/**
+ *  Holds the cube in memory as independently compressed blocks of rows.
+ *
+ *  Blocks are decompressed on demand into a bounded working set and
+ *  recompressed when the last writable page referencing them is released.
+ *  This allows data which compresses well, such as classification maps and
+ *  masks, to be processed in memory without requiring RAM for the full cube.
+ *  The size of the working set is taken from the WorkingSetSize setting, which
+ *  is in megabytes, unless the "Working Set Size" argument is given.
+ */
+class CompressedPager : public BlockPager
+{
+public:
+   SETTING(WorkingSetSize, CompressedPager, unsigned int, 64)
+
+   CompressedPager();
+   ~CompressedPager();
+
+   bool getInputSpecification(PlugInArgList*& pArgList);
+   bool execute(PlugInArgList* pInput, PlugInArgList* pOutput);
+
+   uint64_t getCompressedSize() const;
+   uint64_t getWorkingSetSize() const;
+
+protected:
+   mta::DMutex& getMutex() const;
+   mta::DThreadSignal& getUnitReady() const;
+   std::list<Unit*>& getIdleUnits();
+   void trimUnits();
+   bool loadUnit(Unit* pUnit);
+   bool storeUnit(Unit* pUnit);
+   bool isStoredOnRelease() const;
+
+private:
+   CompressedPager(const CompressedPager& rhs);
+   CompressedPager& operator=(const CompressedPager& rhs);
+
+   struct Block
+   {
+      Block() : mZero(true) {}
+
+      std::vector<char> mCompressed;
+      bool mZero;
+   };
+
+   bool mShuffle;
+   uint64_t mMaxWorkingSetSize;
+
+   std::vector<Block> mBlocks;
+   std::list<Unit*> mIdleUnits;
+   uint64_t mCompressedSize;
+   mutable mta::DMutex mMutex;
+   mutable mta::DThreadSignal mUnitReady;
+};
+
+#endif
@@ -7,20 +7,35 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include "AppVerify.h"
 #include "EndianSwapPage.h"
 #include "Endian.h"
-#include "switchOnEncoding.h"
 #include "RasterUtilities.h"
 
 #include <algorithm>
 #include <stdlib.h>
 #include <string.h>
-#include <algorithm>
 
 EndianSwapPage::EndianSwapPage(void* pSrcData, EncodingType encoding, unsigned int rows, unsigned int columns,
                                unsigned int bytesPerRow, unsigned int interlineBytes, unsigned char* pEndOfSegment) :
    mData(rows * bytesPerRow), mRows(rows), mColumns(columns)
 {
+   if (mData.empty())
+   {
+      return;
+   }
+
+   // complex values are swapped one component at a time
+   size_t elementSize = RasterUtilities::bytesInEncoding(encoding);
+   if (encoding == INT4SCOMPLEX || encoding == FLT8COMPLEX)
+   {
+      elementSize /= 2;
+   }
+
+   VERIFYNRV(elementSize > 0);
+
+   // the data is byte swapped while it is copied so that it is only traversed once
+   Endian endian;
    if (interlineBytes == 0)
    {
       // if there are no interline bytes, then we can do this more efficiently
@@ -29,7 +44,7 @@ EndianSwapPage::EndianSwapPage(void* pSrcData, EncodingType encoding, unsigned i
       {
          count = std::min(count, static_cast<unsigned int>(pEndOfSegment - static_cast<unsigned char*>(pSrcData)));
       }
-      memcpy(&mData.front(), pSrcData, count);
+      endian.copySwapBuffer(&mData.front(), pSrcData, elementSize, count / elementSize);
    }
    else
    {
@@ -47,7 +62,7 @@ EndianSwapPage::EndianSwapPage(void* pSrcData, EncodingType encoding, unsigned i
             }
             count = std::min(count, static_cast<unsigned int>(pEndOfSegment - pStart));
          }
-         memcpy(&mData[destOffset], pStart, count);
+         endian.copySwapBuffer(&mData[destOffset], pStart, elementSize, count / elementSize);
          if (count < bytesPerRow)
          {
             break;
@@ -56,10 +71,11 @@ EndianSwapPage::EndianSwapPage(void* pSrcData, EncodingType encoding, unsigned i
          srcOffset += count + interlineBytes;
       }
    }
+}
 
-   Endian endian;
-   switchOnComplexEncoding(encoding, endian.swapBuffer, &mData.front(),
-      mData.size() / RasterUtilities::bytesInEncoding(encoding));
+size_t EndianSwapPage::getSize() const
+{
+   return mData.size();
 }
 
 EndianSwapPage::~EndianSwapPage()
@@ -20,7 +20,7 @@ public:
    /**
     * Create a new EndianSwapPage.
     *
-    * This will make a copy of the source data, removing any interline bytes.
+    * This will make a byte swapped copy of the source data, removing any interline bytes.
     *
     * @param pSrcData
     *        Pointer to the source data. This should contain at least (rows * (bytesPerRow + interlineBytes)) bytes of data.
@@ -49,6 +49,13 @@ public:
    unsigned int getNumBands();
    unsigned int getInterlineBytes();
 
+   /**
+    * Gets the number of bytes of data held by the page.
+    *
+    * @return The size of the swapped copy of the data.
+    */
+   size_t getSize() const;
+
 private:
    std::vector<char> mData;
    unsigned int mRows;
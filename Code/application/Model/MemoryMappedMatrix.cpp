@@ -16,6 +16,7 @@
 #include <sys/stat.h>
 #include <stdexcept>
 #include <stdio.h>
+#include <algorithm>
 #include <limits>
 
 #if defined(WIN_API)
@@ -31,6 +32,15 @@
 
 using namespace std;
 
+namespace
+{
+   // New mappings span at least this many bytes so that later segments can reuse them
+   const size_t MAPPING_WINDOW_SIZE = 16 * 1024 * 1024;
+
+   // The number of released mappings which are kept for reuse
+   const unsigned int MAX_IDLE_MAPPINGS = 4;
+}
+
 MemoryMappedMatrix::MemoryMappedMatrix(const string& fileName, unsigned int headerOffset,
                                        InterleaveFormatType interleave, unsigned int bytesPerElement,
                                        unsigned int rowNum, unsigned int columnNum, unsigned int bandNum,
@@ -44,7 +54,12 @@ MemoryMappedMatrix::MemoryMappedMatrix(const string& fileName, unsigned int head
    mInterLineBytes(interLineBytes),
    mInterBandBytes(interBandBytes),
    mHeaderOffset(headerOffset),
-   mReadOnly(readOnly)
+   mReadOnly(readOnly),
+   mpLayout(NULL),
+   mPopulateSize(0),
+   mMappingCount(0),
+   mReuseCount(0),
+   mPrefetchCount(0)
 {
 #if defined(WIN_API)
    // All addresses must align on a page boundary.
@@ -105,10 +120,19 @@ MemoryMappedMatrix::MemoryMappedMatrix(const string& fileName, unsigned int head
       mGranularity = fileStats.st_blksize;
    }
 #endif
+
+   // The layout view is never mapped and is only used to locate elements in the file
+   mpLayout = createView(0);
 }
 
 MemoryMappedMatrix::~MemoryMappedMatrix()
 {
+   for (list<Mapping>::iterator iter = mMappings.begin(); iter != mMappings.end(); ++iter)
+   {
+      delete iter->mpView;
+   }
+   delete mpLayout;
+
 #if defined(WIN_API)
    CloseHandle(mHandle);
    CloseHandle(mFileHandle);
@@ -117,17 +141,143 @@ MemoryMappedMatrix::~MemoryMappedMatrix()
 #endif
 }
 
-MemoryMappedMatrixView* MemoryMappedMatrix::getView(size_t defaultSegmentSize)
+MemoryMappedMatrixView* MemoryMappedMatrix::getView(unsigned int row, unsigned int column, unsigned int band,
+   size_t segmentSize, MemoryMappedMatrixView::AccessHint hint, unsigned char*& pSegment)
 {
-   MemoryMappedMatrixView* pView = new MemoryMappedMatrixView(mHandle, mHeaderOffset, defaultSegmentSize,
-      mInterleave, mBytesPerElement, mRowNum, mColumnNum, mBandNum, mInterLineBytes, mInterBandBytes, mReadOnly,
-      mGranularity, mFileSize);
+   pSegment = NULL;
+   int64_t address = mpLayout->getOffset(row, column, band);
+
+   list<Mapping>::iterator iter;
+   for (iter = mMappings.begin(); iter != mMappings.end(); ++iter)
+   {
+      if (iter->mpView->contains(address, segmentSize))
+      {
+         break;
+      }
+   }
+
+   if (iter != mMappings.end())
+   {
+      ++mReuseCount;
+      mMappings.splice(mMappings.begin(), mMappings, iter);
+   }
+   else
+   {
+      Mapping mapping;
+      mapping.mpView = createView(max(segmentSize, MAPPING_WINDOW_SIZE));
+      mapping.mLeases = 0;
+      mapping.mpView->setPopulate(mFileSize <= mPopulateSize);
+      mapping.mpView->setAccessHint(hint);
+      if (mapping.mpView->getSegment(address) == NULL)
+      {
+         delete mapping.mpView;
+         return NULL;
+      }
 
-   mViews.insert(pView);
-   return pView;
+      ++mMappingCount;
+      mMappings.push_front(mapping);
+      trimMappings();
+   }
+
+   // Other leases of the mapping keep its hint, so only the leased segment is read differently
+   Mapping& mapping = mMappings.front();
+   if (mapping.mLeases == 0)
+   {
+      mapping.mpView->setAccessHint(hint);
+   }
+   else if (hint != mapping.mpView->getAccessHint())
+   {
+      mapping.mpView->setAccessHint(hint, address, static_cast<int64_t>(segmentSize));
+   }
+
+   ++mapping.mLeases;
+
+   pSegment = mapping.mpView->getPointer(address);
+   return mapping.mpView;
 }
 
 void MemoryMappedMatrix::release(MemoryMappedMatrixView* pView)
 {
-   mViews.erase(pView);
+   for (list<Mapping>::iterator iter = mMappings.begin(); iter != mMappings.end(); ++iter)
+   {
+      if (iter->mpView == pView)
+      {
+         if (iter->mLeases > 0)
+         {
+            --iter->mLeases;
+         }
+
+         trimMappings();
+         return;
+      }
+   }
+}
+
+void MemoryMappedMatrix::prefetch(unsigned int row, unsigned int column, unsigned int band, size_t segmentSize)
+{
+   int64_t address = mpLayout->getOffset(row, column, band);
+   if (address >= mFileSize)
+   {
+      return;
+   }
+
+   int64_t size = min(static_cast<int64_t>(segmentSize), mFileSize - address);
+   ++mPrefetchCount;
+
+   for (list<Mapping>::iterator iter = mMappings.begin(); iter != mMappings.end(); ++iter)
+   {
+      if (iter->mpView->contains(address, size))
+      {
+         iter->mpView->willNeed(address, size);
+         return;
+      }
+   }
+
+#if defined(POSIX_FADV_WILLNEED)
+   // The segment is not mapped yet, so start reading it into the page cache
+   posix_fadvise(mHandle, address, size, POSIX_FADV_WILLNEED);
+#endif
+}
+
+void MemoryMappedMatrix::setPopulateSize(int64_t populateSize)
+{
+   mPopulateSize = populateSize;
+}
+
+unsigned int MemoryMappedMatrix::getMappingCount() const
+{
+   return mMappingCount;
+}
+
+unsigned int MemoryMappedMatrix::getReuseCount() const
+{
+   return mReuseCount;
+}
+
+unsigned int MemoryMappedMatrix::getPrefetchCount() const
+{
+   return mPrefetchCount;
+}
+
+MemoryMappedMatrixView* MemoryMappedMatrix::createView(size_t segmentSize) const
+{
+   return new MemoryMappedMatrixView(mHandle, mHeaderOffset, segmentSize, mInterleave, mBytesPerElement, mRowNum,
+      mColumnNum, mBandNum, mInterLineBytes, mInterBandBytes, mReadOnly, mGranularity, mFileSize);
+}
+
+void MemoryMappedMatrix::trimMappings()
+{
+   unsigned int idleMappings = 0;
+   for (list<Mapping>::iterator iter = mMappings.begin(); iter != mMappings.end();)
+   {
+      if (iter->mLeases == 0 && ++idleMappings > MAX_IDLE_MAPPINGS)
+      {
+         delete iter->mpView;
+         iter = mMappings.erase(iter);
+      }
+      else
+      {
+         ++iter;
+      }
+   }
 }
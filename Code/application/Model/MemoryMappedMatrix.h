@@ -19,12 +19,11 @@ typedef struct _iobuf FILE;
 #endif
 
 #include "AppConfig.h"
+#include "MemoryMappedMatrixView.h"
 #include "TypesFile.h"
 
+#include <list>
 #include <string>
-#include <set>
-
-class MemoryMappedMatrixView;
 
 class MemoryMappedMatrix
 {
@@ -36,11 +35,66 @@ public:
 
    ~MemoryMappedMatrix();
 
-   MemoryMappedMatrixView* getView(size_t defaultSegmentSize);
-
+   /**
+    * Leases a mapping which contains a segment of the file.
+    *
+    * Mappings are kept after they are released and reused for any later
+    * segment which they contain, so new mappings are made much larger than
+    * a single segment.
+    *
+    * @param row
+    *        The row of the first element in the segment.
+    * @param column
+    *        The column of the first element in the segment.
+    * @param band
+    *        The band of the first element in the segment.
+    * @param segmentSize
+    *        The number of bytes in the segment.
+    * @param hint
+    *        How the caller will access the segment.
+    * @param pSegment
+    *        Receives a pointer to the first element in the segment.
+    *
+    * @return The leased mapping, which must be passed to release(), or \c NULL
+    *         if the segment could not be mapped.
+    */
+   MemoryMappedMatrixView* getView(unsigned int row, unsigned int column, unsigned int band, size_t segmentSize,
+      MemoryMappedMatrixView::AccessHint hint, unsigned char*& pSegment);
+
+   /**
+    * Returns a leased mapping to the pool of reusable mappings.
+    */
    void release(MemoryMappedMatrixView* pView);
 
+   /**
+    * Asks the operating system to start reading a segment of the file into
+    * memory so that it is resident before it is leased.
+    */
+   void prefetch(unsigned int row, unsigned int column, unsigned int band, size_t segmentSize);
+
+   /**
+    * Sets the size of the largest file whose mappings are read into memory
+    * when they are created.
+    */
+   void setPopulateSize(int64_t populateSize);
+
+   unsigned int getMappingCount() const;
+   unsigned int getReuseCount() const;
+   unsigned int getPrefetchCount() const;
+
 private:
+   MemoryMappedMatrix(const MemoryMappedMatrix& rhs);
+   MemoryMappedMatrix& operator=(const MemoryMappedMatrix& rhs);
+
+   struct Mapping
+   {
+      MemoryMappedMatrixView* mpView;
+      unsigned int mLeases;
+   };
+
+   MemoryMappedMatrixView* createView(size_t segmentSize) const;
+   void trimMappings();
+
    std::string mFileName;
 
    unsigned long mFileSizeLow;
@@ -54,7 +108,12 @@ private:
    int mHandle;
 #endif
 
-   std::set<MemoryMappedMatrixView*> mViews;
+   std::list<Mapping> mMappings;   // most recently used first
+   MemoryMappedMatrixView* mpLayout;
+   int64_t mPopulateSize;
+   unsigned int mMappingCount;
+   unsigned int mReuseCount;
+   unsigned int mPrefetchCount;
 
    InterleaveFormatType mInterleave;
    unsigned int mBytesPerElement;
@@ -27,6 +27,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <stdio.h>
+#include <algorithm>
 #include <limits>
 
 using namespace std;
@@ -53,7 +54,10 @@ MemoryMappedMatrixView::MemoryMappedMatrixView(HANDLE_TYPE handle, unsigned int
    mAddressOffset(0),
    mAddress(0),
    mHeaderOffset(headerOffset),
-   mFileSize(fileSize)
+   mFileSize(fileSize),
+   mPopulate(false),
+   mAccessHint(ACCESS_NORMAL),
+   mRangeHinted(false)
 {
    if (mInterleave == BIP)
    {
@@ -120,6 +124,11 @@ unsigned char* MemoryMappedMatrixView::firstSegment()
 }
 
 unsigned char* MemoryMappedMatrixView::getSegment(unsigned int row, unsigned int column, unsigned int band)
+{
+   return getSegment(getOffset(row, column, band));
+}
+
+int64_t MemoryMappedMatrixView::getOffset(unsigned int row, unsigned int column, unsigned int band) const
 {
    int64_t start = 0;
 
@@ -145,7 +154,7 @@ unsigned char* MemoryMappedMatrixView::getSegment(unsigned int row, unsigned int
       start += mHeaderOffset;
    }
 
-   return getSegment(start);
+   return start;
 }
 
 unsigned char* MemoryMappedMatrixView::getSegment(int64_t address)
@@ -186,8 +195,16 @@ unsigned char* MemoryMappedMatrixView::getSegment(int64_t address)
       return NULL;
    }
 #else
+   int flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+   if (mPopulate)
+   {
+      flags |= MAP_POPULATE;
+   }
+#endif
+
    mpBlock = reinterpret_cast<unsigned char*>(mmap(static_cast<caddr_t>(0), mBlockSize,
-                  mAccessPermissions, MAP_SHARED, mHandle, mAddress));
+                  mAccessPermissions, flags, mHandle, mAddress));
    if (mpBlock == reinterpret_cast<void*>(-1))
    {
       // FAILURE THROW AN EXCEPTION
@@ -199,9 +216,120 @@ unsigned char* MemoryMappedMatrixView::getSegment(int64_t address)
       return NULL;
    }
 #endif
+   applyAccessHint();
    return mpBlock + mAddressOffset;
 }
 
+bool MemoryMappedMatrixView::contains(int64_t address, int64_t size) const
+{
+   if (mpBlock == NULL || address < mAddress)
+   {
+      return false;
+   }
+
+   int64_t mappingEnd = mAddress + static_cast<int64_t>(mBlockSize);
+   return address + size <= mappingEnd || (mappingEnd >= mFileSize && address < mappingEnd);
+}
+
+unsigned char* MemoryMappedMatrixView::getPointer(int64_t address) const
+{
+   if (mpBlock == NULL)
+   {
+      return NULL;
+   }
+
+   return mpBlock + (address - mAddress);
+}
+
+size_t MemoryMappedMatrixView::getMappedSize() const
+{
+   return mBlockSize;
+}
+
+void MemoryMappedMatrixView::setPopulate(bool populate)
+{
+   mPopulate = populate;
+}
+
+void MemoryMappedMatrixView::setAccessHint(AccessHint hint)
+{
+   if (hint != mAccessHint || mRangeHinted)
+   {
+      mAccessHint = hint;
+      applyAccessHint();
+   }
+}
+
+MemoryMappedMatrixView::AccessHint MemoryMappedMatrixView::getAccessHint() const
+{
+   return mAccessHint;
+}
+
+void MemoryMappedMatrixView::setAccessHint(AccessHint hint, int64_t address, int64_t size)
+{
+   if (mpBlock == NULL || size <= 0)
+   {
+      return;
+   }
+
+   // madvise requires a page aligned address, and the mapping itself is aligned
+   int64_t start = max(ensureGranularityLower(address), mAddress);
+   int64_t stop = min(address + size, mAddress + static_cast<int64_t>(mBlockSize));
+   if (start < stop)
+   {
+      adviseRange(start, stop - start, hint);
+      mRangeHinted = true;
+   }
+}
+
+void MemoryMappedMatrixView::applyAccessHint()
+{
+   if (mpBlock == NULL)
+   {
+      return;
+   }
+
+   adviseRange(mAddress, static_cast<int64_t>(mBlockSize), mAccessHint);
+   mRangeHinted = false;
+}
+
+void MemoryMappedMatrixView::adviseRange(int64_t address, int64_t size, AccessHint hint)
+{
+#if !defined(WIN_API)
+   int advice = MADV_NORMAL;
+   if (hint == ACCESS_SEQUENTIAL)
+   {
+      advice = MADV_SEQUENTIAL;
+   }
+   else if (hint == ACCESS_RANDOM)
+   {
+      advice = MADV_RANDOM;
+   }
+
+   // Hints only tune read-ahead, so a failure is not an error
+   madvise(reinterpret_cast<caddr_t>(mpBlock + (address - mAddress)), static_cast<size_t>(size), advice);
+#endif
+}
+
+void MemoryMappedMatrixView::willNeed(int64_t address, int64_t size)
+{
+#if !defined(WIN_API)
+   if (mpBlock == NULL || size <= 0)
+   {
+      return;
+   }
+
+   // madvise requires a page aligned address, and the mapping itself is aligned
+   int64_t start = max(ensureGranularityLower(address), mAddress);
+   int64_t stop = min(address + size, mAddress + static_cast<int64_t>(mBlockSize));
+   if (start < stop)
+   {
+      madvise(reinterpret_cast<caddr_t>(mpBlock + (start - mAddress)), static_cast<size_t>(stop - start),
+         MADV_WILLNEED);
+   }
+#endif
+}
+
 unsigned char* MemoryMappedMatrixView::nextSegment()
 {
    return getSegment(mAddress + mRequestedSegmentSize + mAddressOffset);
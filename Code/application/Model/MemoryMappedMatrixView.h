@@ -33,6 +33,17 @@
 class MemoryMappedMatrixView
 {
 public:
+   /**
+    * Describes how the mapped data will be accessed so that the operating
+    * system can tune its read-ahead for the mapping.
+    */
+   enum AccessHint
+   {
+      ACCESS_NORMAL,
+      ACCESS_SEQUENTIAL,
+      ACCESS_RANDOM
+   };
+
    MemoryMappedMatrixView(HANDLE_TYPE handle, unsigned int headerOffset, size_t segmentSize,
                       InterleaveFormatType interleave, unsigned int bytesPerElement,
                       unsigned int rowNum, unsigned int columnNum, unsigned int bandNum,
@@ -50,6 +61,47 @@ public:
    unsigned char* getSegment(unsigned int row, unsigned int column, unsigned int band);
    unsigned char* getSegment(int64_t address);
 
+   /**
+    * Gets the file offset of an element, including the header bytes.
+    */
+   int64_t getOffset(unsigned int row, unsigned int column, unsigned int band) const;
+
+   /**
+    * Determines whether the current mapping contains a range of the file.
+    * A range which extends past the end of the file is contained if the
+    * mapping extends to the end of the file.
+    */
+   bool contains(int64_t address, int64_t size) const;
+
+   /**
+    * Gets a pointer to a file offset within the current mapping.
+    */
+   unsigned char* getPointer(int64_t address) const;
+
+   size_t getMappedSize() const;
+
+   /**
+    * Sets whether new mappings are read into memory when they are created.
+    * This is only supported on platforms which provide MAP_POPULATE.
+    */
+   void setPopulate(bool populate);
+
+   void setAccessHint(AccessHint hint);
+   AccessHint getAccessHint() const;
+
+   /**
+    * Applies an access hint to a range of the current mapping without
+    * changing the hint of the rest of the mapping.  The hint of the whole
+    * mapping is applied again by the next call to setAccessHint().
+    */
+   void setAccessHint(AccessHint hint, int64_t address, int64_t size);
+
+   /**
+    * Asks the operating system to start reading a range of the current
+    * mapping into memory.
+    */
+   void willNeed(int64_t address, int64_t size);
+
    unsigned char* nextSegment();
 
    int64_t ensureGranularity(int64_t suggestedValue);
@@ -61,6 +113,9 @@ public:
    unsigned char *getEndOfSegment() const;
 
 private:
+   void applyAccessHint();
+   void adviseRange(int64_t address, int64_t size, AccessHint hint);
+
    bool mReadOnly;
    int mAccessPermissions;
 
@@ -92,6 +147,10 @@ private:
 
    int64_t mHeaderOffset;
    int64_t mFileSize;
+
+   bool mPopulate;
+   AccessHint mAccessHint;
+   bool mRangeHinted;      // a range has a different hint than the whole mapping
 };
 
 #endif
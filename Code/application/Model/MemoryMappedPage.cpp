@@ -21,10 +21,7 @@ MemoryMappedPage::MemoryMappedPage() :
 
 MemoryMappedPage::~MemoryMappedPage()
 {
-   if (mpMatrixView != NULL)
-   {
-      delete mpMatrixView;
-   }
+   // The view is owned by the MemoryMappedMatrix which leased it
 }
 
 void* MemoryMappedPage::getRawData()
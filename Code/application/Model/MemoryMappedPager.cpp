@@ -33,6 +33,8 @@ MemoryMappedPager::MemoryMappedPager() :
    mbUseDataDescriptor(true),
    mpDataDescriptor(NULL),
    mSwapEndian(false),
+   mSwappedPageBytes(0),
+   mSwappedPageReuseCount(0),
    mWritable(false)
 {
    setName("MemoryMappedPager");
@@ -47,6 +49,12 @@ MemoryMappedPager::MemoryMappedPager() :
 
 namespace
 {
+   const size_t MAX_SWAPPED_PAGE_BYTES = 32 * 1024 * 1024;
+
+   // Reading one band of BIP data with pixels this large touches a small part of each
+   // page, so read-ahead would mostly fetch bands which are never used
+   const unsigned int RANDOM_ACCESS_PIXEL_SIZE = 4096;
+
    class MemoryMappedMatrixDeleter
    {
    public:
@@ -84,6 +92,15 @@ MemoryMappedPager::~MemoryMappedPager()
    }
    mCurrentlyLeasedPages.clear();
 
+   for (SwappedPageList::iterator iter = mSwappedPages.begin(); iter != mSwappedPages.end(); ++iter)
+   {
+      delete iter->mpPage;
+   }
+   mSwappedPages.clear();
+   mSwappedPagesByKey.clear();
+   mSwappedPagesByPage.clear();
+   mSwappedPageBytes = 0;
+
    for_each(mMatrices.begin(), mMatrices.end(), MemoryMappedMatrixDeleter());
 }
 
@@ -278,6 +295,11 @@ bool MemoryMappedPager::execute(PlugInArgList* pInputArgList, PlugInArgList* pOu
    }
    VERIFY(!mMatrices.empty());
 
+   for (vector<MemoryMappedMatrix*>::iterator iter = mMatrices.begin(); iter != mMatrices.end(); ++iter)
+   {
+      (*iter)->setPopulateSize(getSettingPopulateSize());
+   }
+
    return true;
 }
 
@@ -389,8 +411,21 @@ RasterPage* MemoryMappedPager::getPage(DataRequest* pOriginalRequest, DimensionD
    segmentSize = concurrentRows * rowSize;
    numRows = concurrentRows;
 
-   //get the MemoryMappedMatrixView of a let segmentSize large
-   MemoryMappedMatrixView* pView = NULL;
+   SwappedPage swappedPage = {{startRow.getActiveNumber(), startColumn.getActiveNumber(), bandIndex, numRows}, NULL, 1};
+   if (mSwapEndian)
+   {
+      map<SwappedPageKey, SwappedPageList::iterator>::iterator found = mSwappedPagesByKey.find(swappedPage.mKey);
+      if (found != mSwappedPagesByKey.end())
+      {
+         // swapped pages are read-only, so the same page can be leased more than once
+         SwappedPageList::iterator iter = found->second;
+         ++iter->mLeases;
+         ++mSwappedPageReuseCount;
+         mSwappedPages.splice(mSwappedPages.begin(), mSwappedPages, iter);
+         return iter->mpPage;
+      }
+   }
+
    MemoryMappedMatrix* pMatrix = mMatrices.front();
    if (mMatrices.size() > 1)
    {
@@ -398,21 +433,42 @@ RasterPage* MemoryMappedPager::getPage(DataRequest* pOriginalRequest, DimensionD
       pMatrix = mMatrices[bandIndex];
    }
    VERIFYRV(pMatrix != NULL, NULL);
-   pView = pMatrix->getView(segmentSize);
-   VERIFYRV(pView != NULL, NULL);
 
-   //ask the MemoryMappedMatrixView for a pointer starting
-   //at the given location
    if (mMatrices.size() > 1)
    {
       bandIndex = 0;
    }
-   char* pRawCubePointer = reinterpret_cast<char*>(pView->getSegment(startRow.getActiveNumber() + offsetRow,
-                                                   startColumn.getActiveNumber() + offsetCol, bandIndex));
-   if (pRawCubePointer == NULL)
+
+   // Tell the operating system how the accessor will read the data so that read-ahead helps rather than hurts
+   MemoryMappedMatrixView::AccessHint hint = MemoryMappedMatrixView::ACCESS_NORMAL;
+   DimensionDescriptor stopRow = pOriginalRequest->getStopRow();
+   bool singleBand = (pOriginalRequest->getStartBand() == pOriginalRequest->getStopBand());
+   if (interleave == BIP && numBands * bytesPerElement >= RANDOM_ACCESS_PIXEL_SIZE &&
+      (singleBand || pOriginalRequest->getInterleaveFormat() == BSQ))
+   {
+      hint = MemoryMappedMatrixView::ACCESS_RANDOM;
+   }
+   else if (stopRow.isActiveNumberValid() && stopRow.getActiveNumber() >= startRow.getActiveNumber() + numRows)
+   {
+      hint = MemoryMappedMatrixView::ACCESS_SEQUENTIAL;
+   }
+
+   //lease a mapping which contains the segment starting at the given location
+   unsigned char* pSegment = NULL;
+   MemoryMappedMatrixView* pView = pMatrix->getView(startRow.getActiveNumber() + offsetRow,
+      startColumn.getActiveNumber() + offsetCol, bandIndex, segmentSize, hint, pSegment);
+   if (pView == NULL)
    {
       return NULL;
    }
+   char* pRawCubePointer = reinterpret_cast<char*>(pSegment);
+
+   if (hint == MemoryMappedMatrixView::ACCESS_SEQUENTIAL)
+   {
+      // Start reading the rows which the accessor will request next
+      pMatrix->prefetch(startRow.getActiveNumber() + offsetRow + numRows, startColumn.getActiveNumber() + offsetCol,
+         bandIndex, segmentSize);
+   }
 
    //we know have a pointer in raw memory that has
    //been memory mapped, so now create a RasterPage
@@ -433,6 +489,13 @@ RasterPage* MemoryMappedPager::getPage(DataRequest* pOriginalRequest, DimensionD
       pMatrix->release(pView);
       delete pPage;
 
+      swappedPage.mpPage = pEndianPage;
+      mSwappedPages.push_front(swappedPage);
+      mSwappedPagesByKey[swappedPage.mKey] = mSwappedPages.begin();
+      mSwappedPagesByPage[pEndianPage] = mSwappedPages.begin();
+      mSwappedPageBytes += pEndianPage->getSize();
+      trimSwappedPages();
+
       return pEndianPage;
    }
 
@@ -450,6 +513,15 @@ void MemoryMappedPager::releasePage(RasterPage* pPage)
 
    if (mSwapEndian)
    {
+      map<RasterPage*, SwappedPageList::iterator>::iterator found = mSwappedPagesByPage.find(pPage);
+      if (found != mSwappedPagesByPage.end())
+      {
+         VERIFYNRV(found->second->mLeases > 0);
+         --found->second->mLeases;
+         trimSwappedPages();
+         return;
+      }
+
       delete static_cast<EndianSwapPage*>(pPage);
    }
    else
@@ -477,7 +549,114 @@ void MemoryMappedPager::releasePage(RasterPage* pPage)
    }
 }
 
+bool MemoryMappedPager::SwappedPageKey::operator<(const SwappedPageKey& rhs) const
+{
+   if (mStartRow != rhs.mStartRow)
+   {
+      return mStartRow < rhs.mStartRow;
+   }
+   if (mStartColumn != rhs.mStartColumn)
+   {
+      return mStartColumn < rhs.mStartColumn;
+   }
+   if (mBand != rhs.mBand)
+   {
+      return mBand < rhs.mBand;
+   }
+   return mRows < rhs.mRows;
+}
+
+void MemoryMappedPager::trimSwappedPages()
+{
+   // Only leased pages are skipped, so this usually removes pages from the end of the list
+   SwappedPageList::iterator iter = mSwappedPages.end();
+   while (mSwappedPageBytes > MAX_SWAPPED_PAGE_BYTES && iter != mSwappedPages.begin())
+   {
+      --iter;
+      if (iter->mLeases == 0)
+      {
+         mSwappedPageBytes -= iter->mpPage->getSize();
+         mSwappedPagesByKey.erase(iter->mKey);
+         mSwappedPagesByPage.erase(iter->mpPage);
+         delete iter->mpPage;
+         iter = mSwappedPages.erase(iter);
+      }
+   }
+}
+
 int MemoryMappedPager::getSupportedRequestVersion() const
 {
    return 1;
 }
+
+unsigned int MemoryMappedPager::getMappingCount() const
+{
+   mta::MutexLock mutex(mMutex);
+
+   unsigned int count = 0;
+   for (vector<MemoryMappedMatrix*>::const_iterator iter = mMatrices.begin(); iter != mMatrices.end(); ++iter)
+   {
+      count += (*iter)->getMappingCount();
+   }
+
+   return count;
+}
+
+unsigned int MemoryMappedPager::getReuseCount() const
+{
+   mta::MutexLock mutex(mMutex);
+
+   unsigned int count = 0;
+   for (vector<MemoryMappedMatrix*>::const_iterator iter = mMatrices.begin(); iter != mMatrices.end(); ++iter)
+   {
+      count += (*iter)->getReuseCount();
+   }
+
+   return count;
+}
+
+unsigned int MemoryMappedPager::getPrefetchCount() const
+{
+   mta::MutexLock mutex(mMutex);
+
+   unsigned int count = 0;
+   for (vector<MemoryMappedMatrix*>::const_iterator iter = mMatrices.begin(); iter != mMatrices.end(); ++iter)
+   {
+      count += (*iter)->getPrefetchCount();
+   }
+
+   return count;
+}
+
+unsigned int MemoryMappedPager::getSwappedPageCount(bool leasedOnly) const
+{
+   mta::MutexLock mutex(mMutex);
+
+   unsigned int count = 0;
+   for (SwappedPageList::const_iterator iter = mSwappedPages.begin(); iter != mSwappedPages.end(); ++iter)
+   {
+      if (leasedOnly == false || iter->mLeases > 0)
+      {
+         ++count;
+      }
+   }
+
+   return count;
+}
+
+size_t MemoryMappedPager::getSwappedPageBytes() const
+{
+   mta::MutexLock mutex(mMutex);
+   return mSwappedPageBytes;
+}
+
+unsigned int MemoryMappedPager::getSwappedPageReuseCount() const
+{
+   mta::MutexLock mutex(mMutex);
+   return mSwappedPageReuseCount;
+}
+
+size_t MemoryMappedPager::getMaxSwappedPageBytes()
+{
+   return MAX_SWAPPED_PAGE_BYTES;
+}
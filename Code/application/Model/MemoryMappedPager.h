@@ -12,19 +12,28 @@
 #ifndef MEMORYMAPPEDPAGER_H
 #define MEMORYMAPPEDPAGER_H
 
+#include "ConfigurationSettings.h"
 #include "RasterPagerShell.h"
 #include "DMutex.h"
 
+#include <list>
 #include <vector>
 #include <map>
 
+class EndianSwapPage;
 class RasterDataDescriptor;
 class MemoryMappedPage;
 class MemoryMappedMatrix;
 
 class MemoryMappedPager : public RasterPagerShell
 {
+#ifdef CPPTESTS // allow testing of the swapped page cache
+   friend class MemoryMappedPagerSwappedPagesTestCase;
+#endif
+
 public:
+   SETTING(PopulateSize, MemoryMappedPager, unsigned int, 16777216)
+
    MemoryMappedPager();
    ~MemoryMappedPager();
 
@@ -42,6 +51,21 @@ public:
    void releasePage(RasterPage *pPage);
    int getSupportedRequestVersion() const;
 
+   /**
+    * Gets the number of file mappings which have been created.
+    */
+   unsigned int getMappingCount() const;
+
+   /**
+    * Gets the number of pages which were served from an existing file mapping.
+    */
+   unsigned int getReuseCount() const;
+
+   /**
+    * Gets the number of segments which were requested from the operating
+    * system ahead of a sequential read.
+    */
+   unsigned int getPrefetchCount() const;
 
 private:
    bool mbUseDataDescriptor;
@@ -52,8 +76,43 @@ private:
    // Not all matrices will be represented here at any given time.
    std::map<MemoryMappedPage*, MemoryMappedMatrix*> mCurrentlyLeasedPages;
    std::vector<MemoryMappedMatrix*>      mMatrices;
+
+   // Byte swapped copies of the data are kept after they are released so that
+   // requesting the same page again does not copy and swap the data again.
+   struct SwappedPageKey
+   {
+      unsigned int mStartRow;
+      unsigned int mStartColumn;
+      unsigned int mBand;
+      unsigned int mRows;
+
+      bool operator<(const SwappedPageKey& rhs) const;
+   };
+   struct SwappedPage
+   {
+      SwappedPageKey mKey;
+      EndianSwapPage* mpPage;
+      unsigned int mLeases;
+   };
+   typedef std::list<SwappedPage> SwappedPageList;
+   SwappedPageList mSwappedPages;   // most recently used first
+   std::map<SwappedPageKey, SwappedPageList::iterator> mSwappedPagesByKey;
+   std::map<RasterPage*, SwappedPageList::iterator> mSwappedPagesByPage;
+   size_t mSwappedPageBytes;
+   unsigned int mSwappedPageReuseCount;
+
+   /**
+    * Deletes the least recently used swapped pages which are not leased
+    * until the swapped pages fit in the cache.
+    */
+   void trimSwappedPages();
+
+   unsigned int getSwappedPageCount(bool leasedOnly = false) const;
+   size_t getSwappedPageBytes() const;
+   unsigned int getSwappedPageReuseCount() const;
+   static size_t getMaxSwappedPageBytes();
    
-   mta::DMutex                           mMutex;
+   mutable mta::DMutex                   mMutex;
 
    bool mWritable;
 };
@@ -35,6 +35,7 @@
 #include "SignatureFileDescriptorAdapter.h"
 #include "SignatureLibraryAdapter.h"
 #include "SignatureSetAdapter.h"
+#include "SpillingPager.h"
 #include "switchOnEncoding.h"
 #include "TiePointListAdapter.h"
 #include "UtilityServicesImp.h"
@@ -362,7 +363,9 @@ DataElement* ModelServicesImp::createElement(const DataDescriptor* pDescriptor,
 
          if (pRaster != NULL)
          {
-            if (pDescriptorImp->getProcessingLocation() == IN_MEMORY)
+            if ((pDescriptorImp->getProcessingLocation() == IN_MEMORY) ||
+               (pDescriptorImp->getProcessingLocation() == IN_MEMORY_COMPRESSED) ||
+               (pDescriptorImp->getProcessingLocation() == IN_MEMORY_SPILLABLE))
             {
                if (!pRaster->createDefaultPager())
                {
@@ -821,6 +824,16 @@ void ModelServicesImp::deleteMemoryBlock(char* memory)
    delete [] memory;
 }
 
+uint64_t ModelServicesImp::getSpillableMemoryBudget() const
+{
+   return SpillingPager::getMemoryBudget();
+}
+
+uint64_t ModelServicesImp::getSpillableResidentSize() const
+{
+   return SpillingPager::getTotalResidentSize();
+}
+
 bool ModelServicesImp::isKindOfElement(const string& className, const string& elementName) const
 {
    bool bSuccess = false;
@@ -71,6 +71,8 @@ public:
 
    char* getMemoryBlock(size_t size);
    void deleteMemoryBlock(char* memory); 
+   uint64_t getSpillableMemoryBudget() const;
+   uint64_t getSpillableResidentSize() const;
 
    bool isKindOfElement(const std::string& className, const std::string& elementName) const;
    void getElementTypes(const std::string& className, std::vector<std::string>& classList) const;
@@ -1939,6 +1939,25 @@ bool RasterElementImp::createInMemoryPager(void* pData, bool bOwner)
    return true;
 }
 
+bool RasterElementImp::createBlockPager(const string& pagerName)
+{
+   ExecutableResource pPlugin(pagerName);
+   VERIFY(pPlugin->getPlugIn() != NULL);
+
+   RasterPager* pPager = dynamic_cast<RasterPager*>(pPlugin->getPlugIn());
+   VERIFY(pPager != NULL);
+
+   VERIFY(pPlugin->getInArgList().setPlugInArgValue("Raster Element", dynamic_cast<RasterElement*>(this)));
+
+   VERIFY(pPlugin->execute());
+
+   VERIFY(setPager(pPager));
+
+   pPlugin->releasePlugIn();
+
+   return true;
+}
+
 bool RasterElementImp::createDefaultPager()
 {
    if (mpPager != NULL)
@@ -1969,6 +1988,10 @@ bool RasterElementImp::createDefaultPager()
       break;
    case ON_DISK:
       return createTemporaryFile();
+   case IN_MEMORY_COMPRESSED:
+      return createBlockPager("Compressed Pager");
+   case IN_MEMORY_SPILLABLE:
+      return createBlockPager("Spilling Pager");
    case IN_MEMORY_EXISTING:
       // Fall through
    case ON_DISK_READ_ONLY: 
@@ -105,6 +105,7 @@ protected:
       bool copyRasterData = true) const;
 
    bool createMemoryMappedPager(bool bUseDataDescriptor);
+   bool createBlockPager(const std::string& pagerName);
 
    bool copyDataToChip(RasterElement *pRasterChip, 
       const std::vector<DimensionDescriptor> &selectedRows,
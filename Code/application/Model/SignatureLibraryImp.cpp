@@ -20,10 +20,10 @@
 #include "RasterDataDescriptor.h"
 #include "RasterDataDescriptorImp.h"
 #include "RasterUtilities.h"
-#include "Resampler.h"
 #include "SignatureLibrary.h"
 #include "SignatureLibraryImp.h"
 #include "SpecialMetadata.h"
+#include "SpectralResampler.h"
 #include "switchOnEncoding.h"
 
 #include <algorithm>
@@ -32,7 +32,8 @@ using namespace std;
 
 SignatureLibraryImp::SignatureLibraryImp(const DataDescriptorImp& descriptor, const string& id) : 
    SignatureSetImp(descriptor, id),
-   mNeedToResample(false)
+   mNeedToResample(false),
+   mResamplingMethod(SpectralResampler::LINEAR)
 {
    mpOdre.addSignal(SIGNAL_NAME(Subject, Deleted), Slot(this, &SignatureLibraryImp::ordinateDeleted));
    mpOdre.addSignal(SIGNAL_NAME(Subject, Modified), Slot(this, &SignatureLibraryImp::ordinateModified));
@@ -74,10 +75,32 @@ const double *SignatureLibraryImp::getOrdinateData() const
 
 namespace
 {
+   // The most recent resamplings are kept so that a library matched against
+   // several sensors in turn is only resampled once for each of them
+   const unsigned int sMaxCachedResamplings = 4;
+
+   // Signatures are read from the ordinate data and resampled this many at a time
+   const unsigned int sResampleBlockSize = 4096;
+
    template<typename T>
-   void getOriginalAsDouble(T *pSource, unsigned int count, vector<double> &dest)
+   void getOriginalAsDouble(T *pSource, unsigned int count, double* pDest)
    {
-      copy(pSource, &pSource[count], dest.begin());
+      copy(pSource, &pSource[count], pDest);
+   }
+
+   SpectralResampler::Method getResamplingMethod()
+   {
+      const string method = SignatureLibrary::getSettingResamplingMethod();
+      if (method == "Cubic Spline")
+      {
+         return SpectralResampler::CUBIC_SPLINE;
+      }
+      else if (method == "Gaussian")
+      {
+         return SpectralResampler::GAUSSIAN;
+      }
+
+      return SpectralResampler::LINEAR;
    }
 }
 
@@ -104,7 +127,7 @@ const double *SignatureLibraryImp::getOrdinateData(unsigned int index) const
                static vector<double> sOriginalOrdinateData;
                sOriginalOrdinateData.resize(mOriginalAbscissa.size());
                switchOnEncoding(pDesc->getDataType(), getOriginalAsDouble, da->getRow(), mOriginalAbscissa.size(),
-                  sOriginalOrdinateData);
+                  &sOriginalOrdinateData[0]);
                return &sOriginalOrdinateData[0];
             }
          }
@@ -177,25 +200,42 @@ bool SignatureLibraryImp::resample(const vector<double> &abscissa)
       return false;
    }
 
-   if (mResampledData.empty() == false && mNeedToResample == false && abscissa == mAbscissa)
+   SpectralResampler::Method method = getResamplingMethod();
+   if (mResampledData.empty() == false && mNeedToResample == false && method == mResamplingMethod &&
+      abscissa == mAbscissa)
    {
       return true;
    }
 
-   PlugInResource resampler("Resampler");
-   Resampler* pResampler = dynamic_cast<Resampler*>(resampler.get());
-   if (pResampler == NULL)
+   bool wasResampled = (!mAbscissa.empty()) || (!mResampledData.empty());
+   if (mNeedToResample || method != mResamplingMethod)
    {
-      return false;
+      // The ordinate data or the resampling method has changed, so none of the kept resamplings are valid
+      mResampledCache.clear();
+      mAbscissa.clear();
+      mResampledData.clear();
+      mNeedToResample = false;
+      mResamplingMethod = method;
    }
 
-   desample();
+   // Keep the current resampling so that switching back to it does not recompute it
+   cacheResampledData();
+   if (wasResampled)
+   {
+      notify(SIGNAL_NAME(Subject, Modified));
+   }
 
    if (abscissa.empty())
    {
       return true;
    }
 
+   if (restoreResampledData(abscissa))
+   {
+      notify(SIGNAL_NAME(Subject, Modified));
+      return true;
+   }
+
    RasterDataDescriptor* pDesc = dynamic_cast<RasterDataDescriptor*>(mpOdre->getDataDescriptor());
    VERIFY(pDesc != NULL);
 
@@ -205,43 +245,44 @@ bool SignatureLibraryImp::resample(const vector<double> &abscissa)
       return true;
    }
 
-   mResampledData.resize(numSigs * abscissa.size());
-
-   DataAccessor da = mpOdre->getDataAccessor();
-   if (da.isValid() == false)
+   // The interpolation weights are computed once and applied to a block of signatures at a time
+   SpectralResampler resampler;
+   if (resampler.initialize(mResamplingMethod, mOriginalAbscissa, abscissa) == false)
    {
-      desample();
       return false;
    }
 
-   vector<double> originalOrdinateData(mOriginalAbscissa.size());
-   vector<double> toData;
-   vector<double> toFwhm;
-   vector<int> toBands;
-   string errorMessage;
-   for (unsigned int i = 0; i < mSignatures.size(); ++i)
-   {
-      switchOnEncoding(pDesc->getDataType(), getOriginalAsDouble, da->getRow(), mOriginalAbscissa.size(),
-         originalOrdinateData);
-      toData.clear();
-      toData.reserve(mAbscissa.size());
-      toBands.clear();
-      toBands.reserve(mAbscissa.size());
-      bool success = pResampler->execute(originalOrdinateData, toData, 
-         mOriginalAbscissa, abscissa, toFwhm, toBands, errorMessage);
-      if (!success || toData.size() != abscissa.size())
+   FactoryResource<DataRequest> pRequest;
+   pRequest->setInterleaveFormat(BIP);
+   DataAccessor da = mpOdre->getDataAccessor(pRequest.release());
+
+   const unsigned int originalCount = static_cast<unsigned int>(mOriginalAbscissa.size());
+   vector<double> originalOrdinateData(min(numSigs, sResampleBlockSize) * originalCount);
+   vector<double> resampledData(numSigs * abscissa.size());
+   for (unsigned int first = 0; first < numSigs; first += sResampleBlockSize)
+   {
+      unsigned int count = min(sResampleBlockSize, numSigs - first);
+      for (unsigned int i = 0; i < count; ++i)
+      {
+         if (da.isValid() == false)
+         {
+            return false;
+         }
+
+         switchOnEncoding(pDesc->getDataType(), getOriginalAsDouble, da->getRow(), originalCount,
+            &originalOrdinateData[i * originalCount]);
+         da->nextRow();
+      }
+
+      if (resampler.resample(&originalOrdinateData[0], &resampledData[first * abscissa.size()], count) == false)
       {
-         desample();
          return false;
       }
-      std::copy(toData.begin(), toData.end(), &mResampledData[i*abscissa.size()]);
-      da->nextRow();
    }
 
+   mResampledData.swap(resampledData);
    mAbscissa = abscissa;
 
-   mNeedToResample = false;
-
    notify(SIGNAL_NAME(Subject, Modified));
 
    return true;
@@ -252,6 +293,7 @@ void SignatureLibraryImp::desample()
    bool needToSignal = (!mAbscissa.empty()) || (!mResampledData.empty());
    mAbscissa.clear();
    mResampledData.clear();
+   mResampledCache.clear();
    mNeedToResample = false;
    if (needToSignal)
    {
@@ -259,6 +301,40 @@ void SignatureLibraryImp::desample()
    }
 }
 
+void SignatureLibraryImp::cacheResampledData()
+{
+   if (mAbscissa.empty() == false && mResampledData.empty() == false)
+   {
+      mResampledCache.push_front(make_pair(vector<double>(), vector<double>()));
+      mResampledCache.front().first.swap(mAbscissa);
+      mResampledCache.front().second.swap(mResampledData);
+      if (mResampledCache.size() > sMaxCachedResamplings)
+      {
+         mResampledCache.pop_back();
+      }
+   }
+
+   mAbscissa.clear();
+   mResampledData.clear();
+}
+
+bool SignatureLibraryImp::restoreResampledData(const vector<double>& abscissa)
+{
+   for (list<pair<vector<double>, vector<double> > >::iterator iter = mResampledCache.begin();
+      iter != mResampledCache.end(); ++iter)
+   {
+      if (iter->first == abscissa)
+      {
+         mAbscissa.swap(iter->first);
+         mResampledData.swap(iter->second);
+         mResampledCache.erase(iter);
+         return true;
+      }
+   }
+
+   return false;
+}
+
 bool SignatureLibraryImp::import(const string &filename, const string &importerName, Progress* pProgress)
 {
    ImporterResource importer(importerName, filename, pProgress);
@@ -384,12 +460,9 @@ bool SignatureLibraryImp::insertSignatures(const vector<Signature*>& signatures)
       return false;
    }
 
-   PlugInResource resampler("Resampler");
-   Resampler* pResampler = dynamic_cast<Resampler*>(resampler.get());
-   if (pResampler == NULL)
-   {
-      return false;
-   }
+   // Signatures from the same sensor share their interpolation weights
+   map<vector<double>, SpectralResampler> resamplers;
+   SpectralResampler::Method method = getResamplingMethod();
 
    DataAccessor accessor = pRasterElement->getDataAccessor();
    vector<Signature*>::const_iterator ppSignature;
@@ -407,17 +480,17 @@ bool SignatureLibraryImp::insertSignatures(const vector<Signature*>& signatures)
       {
          return false;
       }
-      vector<double> toData;
-      vector<int> toBands;
-      vector<double> toFwhm;
-      string errorMessage;
-      bool success = pResampler->execute(*pFromData, toData, *pFromWavelengths, *pWavelengths, toFwhm,
-         toBands, errorMessage);
-      if (success == false || toBands.size() != pWavelengths->size())
+      map<vector<double>, SpectralResampler>::iterator pResampler = resamplers.find(*pFromWavelengths);
+      if (pResampler == resamplers.end())
+      {
+         pResampler = resamplers.insert(make_pair(*pFromWavelengths, SpectralResampler())).first;
+         pResampler->second.initialize(method, *pFromWavelengths, *pWavelengths);
+      }
+      if (pResampler->second.isValid() == false || pFromData->size() != pFromWavelengths->size() ||
+         pResampler->second.resample(&(*pFromData)[0], pRasterData) == false)
       {
          return false;
       }
-      std::copy(toData.begin(), toData.end(), pRasterData);
       accessor->nextRow();
       string name = (*ppSignature)->getName();
       DataDescriptor* pDataDesc = Service<ModelServices>()->createDataDescriptor(name, "DataElement", pInterface);
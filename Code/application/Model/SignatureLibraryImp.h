@@ -14,7 +14,9 @@
 #include "LibrarySignatureAdapter.h"
 #include "RasterElement.h"
 #include "SignatureSetImp.h"
+#include "SpectralResampler.h"
 
+#include <list>
 #include <map>
 #include <string>
 #include <vector>
@@ -65,14 +67,19 @@ private:
    SignatureLibraryImp& operator=(const SignatureLibraryImp& rhs);
    void ordinateDeleted(Subject &subject, const std::string &signal, const boost::any &data);
    void ordinateModified(Subject &subject, const std::string &signal, const boost::any &data);
+   void cacheResampledData();
+   bool restoreResampledData(const std::vector<double>& abscissa);
+
    std::vector<double> mAbscissa;
    std::vector<double> mOriginalAbscissa;
    std::map<std::string, Signature *> mSignatureNames;
    std::vector<LibrarySignatureAdapter*> mSignatures;
    std::vector<double> mResampledData;
+   std::list<std::pair<std::vector<double>, std::vector<double> > > mResampledCache;
    AttachmentPtr<RasterElement> mpOdre;
    std::string mAbscissaName;
    bool mNeedToResample;
+   SpectralResampler::Method mResamplingMethod;
 };
 
 #define SIGNATURELIBRARYADAPTEREXTENSION_CLASSES \
@@ -0,0 +1,245 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVersion.h"
+#include "AppVerify.h"
+#include "Filename.h"
+#include "PlugInArgList.h"
+#include "SpillingPager.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+uint64_t SpillingPager::msTotalResidentSize = 0;
+
+SpillingPager::SpillingPager() :
+   BlockPager(1024 * 1024),
+   mSpilledSize(0)
+{
+   setName("Spilling Pager");
+   setCopyright("Copyright (2020) by Ball Aerospace & Technologies Corp.");
+   setCreator("Ball Aerospace & Technologies Corp.");
+   setDescription("Provides access to data held in memory which is written to a temporary file "
+      "when the memory budget is exceeded");
+   setDescriptorId("{5C1D9E37-8A42-4F6B-B0D3-2E7F94A61C58}");
+   setVersion(APP_VERSION_NUMBER);
+   setProductionStatus(APP_IS_PRODUCTION_RELEASE);
+   setShortDescription("Provides a RAM backing for data which spills to disk");
+}
+
+SpillingPager::~SpillingPager()
+{
+   {
+      mta::MutexLock lock(getSharedMutex());
+      deleteUnits();
+   }
+
+   if (mSpillFilename.empty() == false)
+   {
+      mSpillFile.close();
+      remove(mSpillFilename.c_str());
+   }
+}
+
+bool SpillingPager::getInputSpecification(PlugInArgList*& pArgList)
+{
+   return BlockPager::getInputSpecification(pArgList);
+}
+
+bool SpillingPager::execute(PlugInArgList* pInput, PlugInArgList* pOutput)
+{
+   VERIFY(BlockPager::execute(pInput, pOutput));
+
+   // The temporary file is only created when a block first needs to be spilled
+   mBlocks.resize(getBlockCount());
+
+   return true;
+}
+
+uint64_t SpillingPager::getResidentSize() const
+{
+   mta::MutexLock lock(getSharedMutex());
+   return getResidentBytes();
+}
+
+uint64_t SpillingPager::getSpilledSize() const
+{
+   mta::MutexLock lock(getSharedMutex());
+   return mSpilledSize;
+}
+
+uint64_t SpillingPager::getTotalResidentSize()
+{
+   mta::MutexLock lock(getSharedMutex());
+   return msTotalResidentSize;
+}
+
+uint64_t SpillingPager::getMemoryBudget()
+{
+   return static_cast<uint64_t>(getSettingMemoryBudget()) * 1024 * 1024;
+}
+
+mta::DMutex& SpillingPager::getMutex() const
+{
+   return getSharedMutex();
+}
+
+mta::DThreadSignal& SpillingPager::getUnitReady() const
+{
+   static mta::DThreadSignal* spUnitReady = new mta::DThreadSignal();
+   return *spUnitReady;
+}
+
+list<BlockPager::Unit*>& SpillingPager::getIdleUnits()
+{
+   static list<Unit*>* spIdleUnits = new list<Unit*>();
+   return *spIdleUnits;
+}
+
+void SpillingPager::trimUnits()
+{
+   // The budget is shared by every spilling pager, so remove the least recently used idle unit of any pager
+   list<Unit*>& idleUnits = getIdleUnits();
+   uint64_t budget = getMemoryBudget();
+   while (msTotalResidentSize > budget && idleUnits.empty() == false)
+   {
+      Unit* pUnit = idleUnits.back();
+      idleUnits.pop_back();
+
+      // The unit is written without the lock, so pages requested in the meantime lease it again
+      SpillingPager* pPager = static_cast<SpillingPager*>(pUnit->mpPager);
+      if (pUnit->mDirty && pPager->flushUnit(pUnit) == false)
+      {
+         // Keep the unit in memory rather than losing its data
+         if (pUnit->mRefCount == 0)
+         {
+            idleUnits.push_back(pUnit);
+         }
+
+         break;
+      }
+
+      if (pUnit->mRefCount == 0)
+      {
+         pPager->unloadUnit(pUnit);
+      }
+   }
+}
+
+bool SpillingPager::loadUnit(Unit* pUnit)
+{
+   VERIFY(pUnit != NULL);
+
+   mta::MutexLock lock(mSpillFileMutex);
+
+   size_t offset = 0;
+   for (unsigned int i = 0; i < pUnit->mBlockCount; ++i)
+   {
+      unsigned int blockIndex = pUnit->mFirstBlock + i;
+      size_t blockBytes = getBlockBytes(blockIndex);
+      char* pDest = &pUnit->mData[offset];
+      if (mBlocks[blockIndex].mSpilled == false)
+      {
+         memset(pDest, 0, blockBytes);
+      }
+      else if (mSpillFile.seek(getBlockOffset(blockIndex), SEEK_SET) != getBlockOffset(blockIndex) ||
+         mSpillFile.read(pDest, blockBytes) != static_cast<int64_t>(blockBytes))
+      {
+         VERIFY_MSG(false, "Unable to read a raster block from the spill file");
+      }
+
+      offset += blockBytes;
+   }
+
+   return true;
+}
+
+bool SpillingPager::storeUnit(Unit* pUnit)
+{
+   VERIFY(pUnit != NULL);
+
+   mta::MutexLock lock(mSpillFileMutex);
+   if (mSpillFilename.empty() && !openSpillFile())
+   {
+      return false;
+   }
+
+   // Blocks have fixed locations in the file, so rewriting a block does not grow the file
+   uint64_t spilledBytes = 0;
+   size_t offset = 0;
+   for (unsigned int i = 0; i < pUnit->mBlockCount; ++i)
+   {
+      unsigned int blockIndex = pUnit->mFirstBlock + i;
+      size_t blockBytes = getBlockBytes(blockIndex);
+      if (mSpillFile.seek(getBlockOffset(blockIndex), SEEK_SET) != getBlockOffset(blockIndex) ||
+         mSpillFile.write(&pUnit->mData[offset], blockBytes) != static_cast<int64_t>(blockBytes))
+      {
+         return false;
+      }
+
+      offset += blockBytes;
+      if (mBlocks[blockIndex].mSpilled == false)
+      {
+         mBlocks[blockIndex].mSpilled = true;
+         spilledBytes += blockBytes;
+      }
+   }
+
+   mta::MutexLock sharedLock(getSharedMutex());
+   mSpilledSize += spilledBytes;
+   return true;
+}
+
+bool SpillingPager::isStoredOnRelease() const
+{
+   return false;
+}
+
+void SpillingPager::residentSizeChanged(int64_t bytes)
+{
+   msTotalResidentSize += bytes;
+}
+
+bool SpillingPager::openSpillFile()
+{
+   const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+   string tempPath;
+   if (pTempPath != NULL)
+   {
+      tempPath = pTempPath->getFullPathAndName();
+   }
+
+   char* pTempFilename = tempnam(tempPath.c_str(), "SP");
+   if (pTempFilename == NULL)
+   {
+      return false;
+   }
+   string filename = pTempFilename;
+   free(pTempFilename);
+
+   if (!mSpillFile.reserve(filename, static_cast<int64_t>(getDataSize())))
+   {
+      mSpillFile.close();
+      remove(filename.c_str());
+      return false;
+   }
+
+   mSpillFilename = filename;
+   return true;
+}
+
+mta::DMutex& SpillingPager::getSharedMutex()
+{
+   // Intentionally leaked so that pagers destroyed during shutdown can still lock it
+   static mta::DMutex* spMutex = new mta::DMutex();
+   return *spMutex;
+}
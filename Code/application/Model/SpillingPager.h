@@ -0,0 +1,105 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SPILLINGPAGER_H
+#define SPILLINGPAGER_H
+
+#include "BlockPager.h"
+#include "ConfigurationSettings.h"
+#include "DMutex.h"
+#include "FileResource.h"
+
+#include <list>
+#include <string>
+#include <vector>
+
+/**
+ *  Holds the cube in memory as blocks of rows, spilling blocks to a temporary
+ *  file when the memory used by all spilling pagers exceeds a shared budget.
+ *
+ *  Blocks are only written to the file when the least recently used blocks
+ *  must be removed from memory to stay within the budget, so results which fit
+ *  in the budget never touch the disk.  Spilled blocks are read back when they
+ *  are next requested, and blocks which have never been written read as zero.
+ *  The temporary file is read and written without holding the lock which is
+ *  shared by all spilling pagers.
+ */
+class SpillingPager : public BlockPager
+{
+public:
+   SETTING(MemoryBudget, SpillingPager, unsigned int, 1024)
+
+   SpillingPager();
+   ~SpillingPager();
+
+   bool getInputSpecification(PlugInArgList*& pArgList);
+   bool execute(PlugInArgList* pInput, PlugInArgList* pOutput);
+
+   /**
+    *  Gets the number of bytes held in memory by this pager.
+    */
+   uint64_t getResidentSize() const;
+
+   /**
+    *  Gets the number of bytes which this pager has written to its temporary file.
+    */
+   uint64_t getSpilledSize() const;
+
+   /**
+    *  Gets the number of bytes held in memory by all spilling pagers.
+    *
+    *  Plug-ins get this through ModelServices::getSpillableResidentSize().
+    */
+   static uint64_t getTotalResidentSize();
+
+   /**
+    *  Gets the memory budget in bytes shared by all spilling pagers.
+    *
+    *  The budget is taken from the MemoryBudget setting, which is in megabytes.
+    *  Blocks which are in use are never spilled, so the resident size can
+    *  temporarily exceed the budget.  Plug-ins get the budget through
+    *  ModelServices::getSpillableMemoryBudget().
+    */
+   static uint64_t getMemoryBudget();
+
+protected:
+   mta::DMutex& getMutex() const;
+   mta::DThreadSignal& getUnitReady() const;
+   std::list<Unit*>& getIdleUnits();
+   void trimUnits();
+   bool loadUnit(Unit* pUnit);
+   bool storeUnit(Unit* pUnit);
+   bool isStoredOnRelease() const;
+   void residentSizeChanged(int64_t bytes);
+
+private:
+   SpillingPager(const SpillingPager& rhs);
+   SpillingPager& operator=(const SpillingPager& rhs);
+
+   struct Block
+   {
+      Block() : mSpilled(false) {}
+
+      bool mSpilled;
+   };
+
+   bool openSpillFile();
+
+   static mta::DMutex& getSharedMutex();
+
+   std::vector<Block> mBlocks;
+   uint64_t mSpilledSize;
+   std::string mSpillFilename;
+   LargeFileResource mSpillFile;
+   mta::DMutex mSpillFileMutex;
+
+   static uint64_t msTotalResidentSize;
+};
+
+#endif
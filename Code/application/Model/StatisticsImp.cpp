@@ -742,8 +742,10 @@ void StatisticsImp::calculateStatistics(ComplexComponent component)
    phaseWeights.push_back(80);
    mta::MultiPhaseProgressReporter progressReporter(barReporter, phaseWeights);
 
+   // The cost of a row depends on the AOI, bad values and paging, so the rows are scheduled dynamically
    mta::MultiThreadedAlgorithm<StatisticsInput, StatisticsOutput, StatisticsThread> statisticsAlgorithm
-      (getNumRequiredThreads(pDescriptor->getRowCount()), statInput, statOutput, &progressReporter);
+      (getNumRequiredThreads(pDescriptor->getRowCount()), statInput, statOutput, &progressReporter,
+      mta::DYNAMIC_SCHEDULING);
    statisticsAlgorithm.run();
 
    bool bInteger = true;
@@ -763,7 +765,8 @@ void StatisticsImp::calculateStatistics(ComplexComponent component)
       HistogramOutput histOutput(bInteger, statOutput.mMaximum, statOutput.mMinimum);
 
       mta::MultiThreadedAlgorithm<HistogramInput, HistogramOutput, HistogramThread> histogramAlgorithm
-         (getNumRequiredThreads(pDescriptor->getRowCount()), histInput, histOutput, &progressReporter);
+         (getNumRequiredThreads(pDescriptor->getRowCount()), histInput, histOutput, &progressReporter,
+         mta::DYNAMIC_SCHEDULING);
 
       if (histogramAlgorithm.run() == mta::SUCCESS)
       {
@@ -792,8 +795,7 @@ StatisticsThread::StatisticsThread(const StatisticsInput& input, int threadCount
                                    ThreadReporter& reporter) :
    AlgorithmThread(threadIndex, reporter),
    mInput(input),
-   mRowRange(getThreadRange(threadCount, static_cast<const RasterDataDescriptor*>(
-                                 input.mpRasterElement->getDataDescriptor())->getRowCount())),
+   mThreadCount(threadCount),
    mMaxMinSet(false),
    mMaximum(-std::numeric_limits<double>::max()),
    mMinimum(std::numeric_limits<double>::max()),
@@ -808,13 +810,25 @@ void StatisticsThread::run()
       mInput.mpRasterElement->getDataDescriptor());
    VERIFYNRV(pDescriptor != NULL);
 
-   BitMaskIterator diter(mInput.mpAoi, 0, mRowRange.mFirst, pDescriptor->getColumnCount() - 1, mRowRange.mLast);
-
    mMaxMinSet = false;
    mSum = 0.0;
    mSumSquared = 0.0;
    mCount = 0;
 
+   while (getNextRange(mThreadCount, static_cast<int>(pDescriptor->getRowCount()), mRowRange))
+   {
+      processRows();
+   }
+}
+
+void StatisticsThread::processRows()
+{
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(
+      mInput.mpRasterElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+
+   BitMaskIterator diter(mInput.mpAoi, 0, mRowRange.mFirst, pDescriptor->getColumnCount() - 1, mRowRange.mLast);
+
    EncodingType encoding = pDescriptor->getDataType();
    ComplexComponent component = mInput.mComplexComponent;
 
@@ -1028,8 +1042,7 @@ HistogramThread::HistogramThread(const HistogramInput& input,
    AlgorithmThread(threadIndex, reporter),
    mInput(input),
    mCount(0),
-   mRowRange(getThreadRange(threadCount, static_cast<const RasterDataDescriptor*>(
-                                 input.mStatInput.mpRasterElement->getDataDescriptor())->getRowCount())),
+   mThreadCount(threadCount),
    mBinCounts(HISTOGRAM_SIZE)
 {}
 
@@ -1044,6 +1057,18 @@ void HistogramThread::run()
       toBin = 0.999999999 * (HISTOGRAM_SIZE)/range;
    }
 
+   const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(
+      mInput.mStatInput.mpRasterElement->getDataDescriptor());
+   VERIFYNRV(pDescriptor != NULL);
+
+   while (getNextRange(mThreadCount, static_cast<int>(pDescriptor->getRowCount()), mRowRange))
+   {
+      processRows(toBin);
+   }
+}
+
+void HistogramThread::processRows(double toBin)
+{
    std::vector<unsigned int>& binCounts = getBinCounts();
 
    const RasterDataDescriptor* pDescriptor = static_cast<const RasterDataDescriptor*>(
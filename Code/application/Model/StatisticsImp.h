@@ -169,8 +169,11 @@ public:
 private:
    StatisticsThread& operator=(const StatisticsThread& rhs);
 
+   void processRows();
+
    const StatisticsInput& mInput;
 
+   int mThreadCount;
    Range mRowRange;
    bool mMaxMinSet;
    double mMaximum;
@@ -232,9 +235,12 @@ public:
 private:
    HistogramThread& operator=(const HistogramThread& rhs);
 
+   void processRows(double toBin);
+
    const HistogramInput& mInput;
    unsigned int mCount;
 
+   int mThreadCount;
    Range mRowRange;
    std::vector<unsigned int> mBinCounts;
 };
@@ -260,7 +260,8 @@ bool RasterElementImporterShell::validate(const DataDescriptor* pDescriptor,
 
 bool RasterElementImporterShell::isProcessingLocationSupported(ProcessingLocation location) const
 {
-   if ((location == IN_MEMORY) || (location == ON_DISK_READ_ONLY) || (location == ON_DISK))
+   if ((location == IN_MEMORY) || (location == ON_DISK_READ_ONLY) || (location == ON_DISK) ||
+      (location == IN_MEMORY_COMPRESSED) || (location == IN_MEMORY_SPILLABLE))
    {
       return true;
    }
@@ -0,0 +1,316 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppConfig.h"
+#include "BlockCompression.h"
+
+#include <string.h>
+#include <vector>
+
+namespace
+{
+   const unsigned int HASH_LOG = 12;
+   const size_t MIN_MATCH = 4;
+   const size_t MAX_OFFSET = 65535;
+
+   // The LZ4 block format requires the last 5 bytes to be literals and the
+   // last match to start at least 12 bytes before the end of the block.
+   const size_t LAST_LITERALS = 5;
+   const size_t MATCH_FIND_LIMIT = 12;
+
+   inline unsigned int read32(const unsigned char* pData)
+   {
+      unsigned int value;
+      memcpy(&value, pData, sizeof(value));
+      return value;
+   }
+
+   inline unsigned int hashSequence(unsigned int sequence)
+   {
+      return (sequence * 2654435761U) >> (32 - HASH_LOG);
+   }
+
+   inline bool writeLength(size_t length, unsigned char*& pOut, const unsigned char* pOutEnd)
+   {
+      while (length >= 255)
+      {
+         if (pOut >= pOutEnd)
+         {
+            return false;
+         }
+         *pOut++ = 255;
+         length -= 255;
+      }
+      if (pOut >= pOutEnd)
+      {
+         return false;
+      }
+      *pOut++ = static_cast<unsigned char>(length);
+      return true;
+   }
+
+   inline bool readLength(size_t& length, const unsigned char*& pIn, const unsigned char* pInEnd)
+   {
+      unsigned char value = 255;
+      while (value == 255)
+      {
+         if (pIn >= pInEnd)
+         {
+            return false;
+         }
+         value = *pIn++;
+         length += value;
+      }
+      return true;
+   }
+
+   bool writeSequence(const unsigned char* pLiterals, size_t literalLength, size_t matchLength, size_t offset,
+      unsigned char*& pOut, const unsigned char* pOutEnd)
+   {
+      if (pOut >= pOutEnd)
+      {
+         return false;
+      }
+
+      unsigned char* pToken = pOut++;
+      *pToken = static_cast<unsigned char>((literalLength >= 15 ? 15 : literalLength) << 4);
+      if (literalLength >= 15 && !writeLength(literalLength - 15, pOut, pOutEnd))
+      {
+         return false;
+      }
+
+      if (static_cast<size_t>(pOutEnd - pOut) < literalLength)
+      {
+         return false;
+      }
+      if (literalLength > 0)
+      {
+         memcpy(pOut, pLiterals, literalLength);
+         pOut += literalLength;
+      }
+
+      if (matchLength == 0)
+      {
+         return true;
+      }
+
+      if (pOutEnd - pOut < 2)
+      {
+         return false;
+      }
+      *pOut++ = static_cast<unsigned char>(offset & 0xff);
+      *pOut++ = static_cast<unsigned char>((offset >> 8) & 0xff);
+
+      size_t matchCode = matchLength - MIN_MATCH;
+      *pToken |= static_cast<unsigned char>(matchCode >= 15 ? 15 : matchCode);
+      if (matchCode >= 15 && !writeLength(matchCode - 15, pOut, pOutEnd))
+      {
+         return false;
+      }
+
+      return true;
+   }
+}
+
+size_t BlockCompression::getMaxCompressedSize(size_t sourceSize)
+{
+   return sourceSize + (sourceSize / 255) + 16;
+}
+
+size_t BlockCompression::compress(const void* pSource, size_t sourceSize, void* pDest, size_t destCapacity)
+{
+   if ((pSource == NULL && sourceSize > 0) || pDest == NULL || destCapacity == 0)
+   {
+      return 0;
+   }
+
+   const unsigned char* const pBase = reinterpret_cast<const unsigned char*>(pSource);
+   const unsigned char* const pEnd = pBase + sourceSize;
+   const unsigned char* pAnchor = pBase;
+   unsigned char* pOut = reinterpret_cast<unsigned char*>(pDest);
+   const unsigned char* const pOutEnd = pOut + destCapacity;
+
+   if (sourceSize > MATCH_FIND_LIMIT)
+   {
+      const unsigned char* const pMatchFindLimit = pEnd - MATCH_FIND_LIMIT;
+      const unsigned char* const pMatchLimit = pEnd - LAST_LITERALS;
+
+      // Positions are stored relative to the start of the block, so a zeroed table refers to the first byte
+      std::vector<unsigned int> hashTable(1 << HASH_LOG, 0);
+
+      const unsigned char* pIn = pBase;
+      while (pIn < pMatchFindLimit)
+      {
+         unsigned int sequence = read32(pIn);
+         unsigned int& tableEntry = hashTable[hashSequence(sequence)];
+         const unsigned char* pRef = pBase + tableEntry;
+         tableEntry = static_cast<unsigned int>(pIn - pBase);
+
+         if (pRef >= pIn || static_cast<size_t>(pIn - pRef) > MAX_OFFSET || read32(pRef) != sequence)
+         {
+            ++pIn;
+            continue;
+         }
+
+         // Extend the match backwards over literals which also match
+         while (pIn > pAnchor && pRef > pBase && pIn[-1] == pRef[-1])
+         {
+            --pIn;
+            --pRef;
+         }
+
+         const unsigned char* pMatchStart = pIn;
+         size_t offset = static_cast<size_t>(pIn - pRef);
+         pIn += MIN_MATCH;
+         pRef += MIN_MATCH;
+         while (pIn < pMatchLimit && *pIn == *pRef)
+         {
+            ++pIn;
+            ++pRef;
+         }
+
+         if (!writeSequence(pAnchor, static_cast<size_t>(pMatchStart - pAnchor),
+            static_cast<size_t>(pIn - pMatchStart), offset, pOut, pOutEnd))
+         {
+            return 0;
+         }
+
+         pAnchor = pIn;
+      }
+   }
+
+   if (!writeSequence(pAnchor, static_cast<size_t>(pEnd - pAnchor), 0, 0, pOut, pOutEnd))
+   {
+      return 0;
+   }
+
+   return static_cast<size_t>(pOut - reinterpret_cast<unsigned char*>(pDest));
+}
+
+bool BlockCompression::decompress(const void* pSource, size_t sourceSize, void* pDest, size_t destSize)
+{
+   if (pSource == NULL || (pDest == NULL && destSize > 0))
+   {
+      return false;
+   }
+
+   const unsigned char* pIn = reinterpret_cast<const unsigned char*>(pSource);
+   const unsigned char* const pInEnd = pIn + sourceSize;
+   unsigned char* const pOutBase = reinterpret_cast<unsigned char*>(pDest);
+   unsigned char* pOut = pOutBase;
+   unsigned char* const pOutEnd = pOutBase + destSize;
+
+   while (pIn < pInEnd)
+   {
+      unsigned char token = *pIn++;
+
+      size_t literalLength = token >> 4;
+      if (literalLength == 15 && !readLength(literalLength, pIn, pInEnd))
+      {
+         return false;
+      }
+
+      if (literalLength > static_cast<size_t>(pInEnd - pIn) || literalLength > static_cast<size_t>(pOutEnd - pOut))
+      {
+         return false;
+      }
+      memcpy(pOut, pIn, literalLength);
+      pIn += literalLength;
+      pOut += literalLength;
+
+      // The last sequence in a block contains only literals
+      if (pIn == pInEnd)
+      {
+         break;
+      }
+
+      if (pInEnd - pIn < 2)
+      {
+         return false;
+      }
+      size_t offset = static_cast<size_t>(pIn[0]) | (static_cast<size_t>(pIn[1]) << 8);
+      pIn += 2;
+      if (offset == 0 || offset > static_cast<size_t>(pOut - pOutBase))
+      {
+         return false;
+      }
+
+      size_t matchLength = token & 0x0f;
+      if (matchLength == 15 && !readLength(matchLength, pIn, pInEnd))
+      {
+         return false;
+      }
+      matchLength += MIN_MATCH;
+      if (matchLength > static_cast<size_t>(pOutEnd - pOut))
+      {
+         return false;
+      }
+
+      const unsigned char* pMatch = pOut - offset;
+      if (offset >= matchLength)
+      {
+         memcpy(pOut, pMatch, matchLength);
+         pOut += matchLength;
+      }
+      else
+      {
+         // Overlapping copies replicate a short run, so they must be done a byte at a time
+         for (size_t i = 0; i < matchLength; ++i)
+         {
+            *pOut++ = *pMatch++;
+         }
+      }
+   }
+
+   return pOut == pOutEnd;
+}
+
+void BlockCompression::shuffle(const void* pSource, void* pDest, size_t elementCount, size_t elementSize)
+{
+   const unsigned char* pIn = reinterpret_cast<const unsigned char*>(pSource);
+   unsigned char* pOut = reinterpret_cast<unsigned char*>(pDest);
+   if (elementSize <= 1)
+   {
+      memcpy(pOut, pIn, elementCount * elementSize);
+      return;
+   }
+
+   for (size_t byte = 0; byte < elementSize; ++byte)
+   {
+      unsigned char* pPlane = pOut + byte * elementCount;
+      const unsigned char* pElement = pIn + byte;
+      for (size_t element = 0; element < elementCount; ++element)
+      {
+         pPlane[element] = *pElement;
+         pElement += elementSize;
+      }
+   }
+}
+
+void BlockCompression::unshuffle(const void* pSource, void* pDest, size_t elementCount, size_t elementSize)
+{
+   const unsigned char* pIn = reinterpret_cast<const unsigned char*>(pSource);
+   unsigned char* pOut = reinterpret_cast<unsigned char*>(pDest);
+   if (elementSize <= 1)
+   {
+      memcpy(pOut, pIn, elementCount * elementSize);
+      return;
+   }
+
+   for (size_t byte = 0; byte < elementSize; ++byte)
+   {
+      const unsigned char* pPlane = pIn + byte * elementCount;
+      unsigned char* pElement = pOut + byte;
+      for (size_t element = 0; element < elementCount; ++element)
+      {
+         *pElement = pPlane[element];
+         pElement += elementSize;
+      }
+   }
+}
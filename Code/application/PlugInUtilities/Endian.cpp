@@ -10,6 +10,212 @@
 #include "Endian.h"
 #include "AppConfig.h"
 
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ENDIAN_SWAP_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ENDIAN_SWAP_TARGET(isa)
+#else
+#include <cpuid.h>
+#define ENDIAN_SWAP_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace
+{
+   void swapScalar(unsigned char* pDestination, const unsigned char* pSource, size_t dataSize, size_t count)
+   {
+      switch (dataSize)
+      {
+      case 2:
+         for (size_t i = 0; i < count; ++i, pSource += 2, pDestination += 2)
+         {
+            uint16_t value;
+            memcpy(&value, pSource, 2);
+            value = static_cast<uint16_t>((value >> 8) | (value << 8));
+            memcpy(pDestination, &value, 2);
+         }
+         break;
+
+      case 4:
+         for (size_t i = 0; i < count; ++i, pSource += 4, pDestination += 4)
+         {
+            uint32_t value;
+            memcpy(&value, pSource, 4);
+            value = (value >> 24) | ((value >> 8) & 0x0000ff00) | ((value << 8) & 0x00ff0000) | (value << 24);
+            memcpy(pDestination, &value, 4);
+         }
+         break;
+
+      case 8:
+         for (size_t i = 0; i < count; ++i, pSource += 8, pDestination += 8)
+         {
+            uint32_t low;
+            uint32_t high;
+            memcpy(&low, pSource, 4);
+            memcpy(&high, pSource + 4, 4);
+            low = (low >> 24) | ((low >> 8) & 0x0000ff00) | ((low << 8) & 0x00ff0000) | (low << 24);
+            high = (high >> 24) | ((high >> 8) & 0x0000ff00) | ((high << 8) & 0x00ff0000) | (high << 24);
+            memcpy(pDestination, &high, 4);
+            memcpy(pDestination + 4, &low, 4);
+         }
+         break;
+
+      default:
+         for (size_t i = 0; i < count; ++i, pSource += dataSize, pDestination += dataSize)
+         {
+            for (size_t j = 0; j < (dataSize + 1) / 2; ++j)
+            {
+               size_t index = dataSize - j - 1;
+
+               unsigned char byteData = pSource[j];
+               pDestination[j] = pSource[index];
+               pDestination[index] = byteData;
+            }
+         }
+         break;
+      }
+   }
+
+#if defined(ENDIAN_SWAP_SIMD)
+   enum SimdLevel
+   {
+      SIMD_NONE,
+      SIMD_SSSE3,
+      SIMD_AVX2
+   };
+
+   SimdLevel detectSimdLevel()
+   {
+      unsigned int registers[4] = {0, 0, 0, 0};
+#if defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 0);
+      unsigned int maxLeaf = static_cast<unsigned int>(info[0]);
+      __cpuid(info, 1);
+      for (int i = 0; i < 4; ++i)
+      {
+         registers[i] = static_cast<unsigned int>(info[i]);
+      }
+#else
+      unsigned int maxLeaf = __get_cpuid_max(0, NULL);
+      if (maxLeaf < 1)
+      {
+         return SIMD_NONE;
+      }
+      __cpuid(1, registers[0], registers[1], registers[2], registers[3]);
+#endif
+
+      const unsigned int ssse3Bit = 1 << 9;
+      const unsigned int osxsaveBit = 1 << 27;
+      const unsigned int avxBit = 1 << 28;
+      if ((registers[2] & ssse3Bit) == 0)
+      {
+         return SIMD_NONE;
+      }
+
+      // AVX2 also requires the operating system to save the upper halves of the vector registers
+      if (maxLeaf < 7 || (registers[2] & osxsaveBit) == 0 || (registers[2] & avxBit) == 0)
+      {
+         return SIMD_SSSE3;
+      }
+
+#if defined(_MSC_VER)
+      unsigned long long xcr0 = _xgetbv(0);
+      __cpuidex(info, 7, 0);
+      unsigned int extendedFeatures = static_cast<unsigned int>(info[1]);
+#else
+      unsigned int xcrLow = 0;
+      unsigned int xcrHigh = 0;
+      __asm__ ("xgetbv" : "=a" (xcrLow), "=d" (xcrHigh) : "c" (0));
+      unsigned long long xcr0 = xcrLow;
+      __cpuid_count(7, 0, registers[0], registers[1], registers[2], registers[3]);
+      unsigned int extendedFeatures = registers[1];
+#endif
+
+      const unsigned int avx2Bit = 1 << 5;
+      if ((xcr0 & 0x6) != 0x6 || (extendedFeatures & avx2Bit) == 0)
+      {
+         return SIMD_SSSE3;
+      }
+
+      return SIMD_AVX2;
+   }
+
+   SimdLevel getSimdLevel()
+   {
+      // a race on the first call only computes the same value more than once
+      static SimdLevel level = detectSimdLevel();
+      return level;
+   }
+
+   // shuffle masks which reverse the bytes of each 2, 4 or 8 byte element in 16 bytes
+   const char sSwapMask2[16] = {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14};
+   const char sSwapMask4[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+   const char sSwapMask8[16] = {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8};
+
+   const char* getSwapMask(size_t dataSize)
+   {
+      switch (dataSize)
+      {
+      case 2:
+         return sSwapMask2;
+      case 4:
+         return sSwapMask4;
+      case 8:
+         return sSwapMask8;
+      default:
+         return NULL;
+      }
+   }
+
+   // returns the number of bytes which were swapped, which is a multiple of 16
+   ENDIAN_SWAP_TARGET("ssse3")
+   size_t swapSsse3(unsigned char* pDestination, const unsigned char* pSource, const char* pMask, size_t byteCount)
+   {
+      const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pMask));
+      size_t offset = 0;
+      for (; offset + 16 <= byteCount; offset += 16)
+      {
+         __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + offset));
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination + offset), _mm_shuffle_epi8(data, mask));
+      }
+
+      return offset;
+   }
+
+   // returns the number of bytes which were swapped, which is a multiple of 32
+   ENDIAN_SWAP_TARGET("avx2")
+   size_t swapAvx2(unsigned char* pDestination, const unsigned char* pSource, const char* pMask, size_t byteCount)
+   {
+      // the shuffle works within each 16 byte lane, so the same mask is used for both lanes
+      const __m128i laneMask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pMask));
+      const __m256i mask = _mm256_broadcastsi128_si256(laneMask);
+      size_t offset = 0;
+      for (; offset + 64 <= byteCount; offset += 64)
+      {
+         __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource + offset));
+         __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource + offset + 32));
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination + offset), _mm256_shuffle_epi8(first, mask));
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination + offset + 32),
+            _mm256_shuffle_epi8(second, mask));
+      }
+
+      for (; offset + 32 <= byteCount; offset += 32)
+      {
+         __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource + offset));
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination + offset), _mm256_shuffle_epi8(data, mask));
+      }
+
+      return offset;
+   }
+#endif
+}
+
 Endian::Endian(EndianType endian) :
    mType(endian),
    mSystemType(getSystemEndian())
@@ -41,6 +247,51 @@ bool Endian::isLittleEndian() const
    return (mType == LITTLE_ENDIAN_ORDER);
 }
 
+bool Endian::copySwapBuffer(void* pDestination, const void* pSource, size_t dataSize, size_t count) const
+{
+   if ((pDestination == NULL) || (pSource == NULL))
+   {
+      return false;
+   }
+
+   unsigned char* pDestinationBytes = reinterpret_cast<unsigned char*>(pDestination);
+   const unsigned char* pSourceBytes = reinterpret_cast<const unsigned char*>(pSource);
+   size_t byteCount = dataSize * count;
+   if ((mSystemType == mType) || (dataSize < 2))
+   {
+      if (pDestinationBytes != pSourceBytes)
+      {
+         memcpy(pDestinationBytes, pSourceBytes, byteCount);
+      }
+
+      return (mSystemType != mType);
+   }
+
+   size_t swappedBytes = 0;
+#if defined(ENDIAN_SWAP_SIMD)
+   const char* pMask = getSwapMask(dataSize);
+   if (pMask != NULL)
+   {
+      SimdLevel level = getSimdLevel();
+      if (level == SIMD_AVX2)
+      {
+         swappedBytes = swapAvx2(pDestinationBytes, pSourceBytes, pMask, byteCount);
+      }
+
+      if (level >= SIMD_SSSE3)
+      {
+         swappedBytes += swapSsse3(pDestinationBytes + swappedBytes, pSourceBytes + swappedBytes, pMask,
+            byteCount - swappedBytes);
+      }
+   }
+#endif
+
+   // the vector kernels process whole elements, so the remaining elements start on an element boundary
+   swapScalar(pDestinationBytes + swappedBytes, pSourceBytes + swappedBytes, dataSize,
+      (byteCount - swappedBytes) / dataSize);
+   return true;
+}
+
 EndianType Endian::getSystemEndian()
 {
    if (OPTICKS_BYTE_ORDER == LITTLE_ENDIAN_BYTE_ORDER)
@@ -0,0 +1,111 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef BLOCKCOMPRESSION_H
+#define BLOCKCOMPRESSION_H
+
+#include <stddef.h>
+
+/**
+ * This namespace contains a fast lossless block codec and the byte-shuffle
+ * filter used when storing raster data in compressed form.
+ *
+ * The codec produces streams in the LZ4 block format.  It favors speed
+ * over ratio, which makes it suitable for compressing raster blocks on
+ * demand while data is being processed.  Each compressed block is
+ * independent of every other block, so blocks can be compressed and
+ * decompressed concurrently.
+ */
+namespace BlockCompression
+{
+   /**
+    * Returns the worst case compressed size for a block.
+    *
+    * @param sourceSize
+    *        The number of uncompressed bytes.
+    *
+    * @return The number of bytes which must be available in the destination
+    *         buffer passed to compress() to guarantee success.
+    */
+   size_t getMaxCompressedSize(size_t sourceSize);
+
+   /**
+    * Compresses a block of memory.
+    *
+    * @param pSource
+    *        The data to compress.
+    * @param sourceSize
+    *        The number of bytes in \em pSource.
+    * @param pDest
+    *        The buffer which will receive the compressed stream.
+    * @param destCapacity
+    *        The number of bytes available in \em pDest.  Use
+    *        getMaxCompressedSize() to guarantee the block will fit.
+    *
+    * @return The number of bytes written to \em pDest or 0 if
+    *         \em pDest is too small or the arguments are invalid.
+    */
+   size_t compress(const void* pSource, size_t sourceSize, void* pDest, size_t destCapacity);
+
+   /**
+    * Decompresses a block of memory produced by compress().
+    *
+    * The stream is fully bounds checked so a corrupt stream will
+    * not read or write outside of the given buffers.
+    *
+    * @param pSource
+    *        The compressed stream.
+    * @param sourceSize
+    *        The number of bytes in \em pSource.
+    * @param pDest
+    *        The buffer which will receive the uncompressed data.
+    * @param destSize
+    *        The exact number of uncompressed bytes expected.
+    *
+    * @return \c true if exactly \em destSize bytes were decoded, \c false otherwise.
+    */
+   bool decompress(const void* pSource, size_t sourceSize, void* pDest, size_t destSize);
+
+   /**
+    * Groups the bytes of multi-byte elements by significance.
+    *
+    * All first bytes of each element are stored, followed by all second
+    * bytes, and so on.  Neighboring pixels in raster data usually share
+    * their high order bytes so this filter significantly improves the
+    * compression ratio for 16-bit, 32-bit and 64-bit data.
+    *
+    * @param pSource
+    *        The elements to shuffle.
+    * @param pDest
+    *        The buffer which will receive the shuffled bytes.
+    *        This must not overlap \em pSource.
+    * @param elementCount
+    *        The number of elements in \em pSource.
+    * @param elementSize
+    *        The number of bytes in each element.
+    */
+   void shuffle(const void* pSource, void* pDest, size_t elementCount, size_t elementSize);
+
+   /**
+    * Reverses shuffle().
+    *
+    * @param pSource
+    *        The shuffled bytes.
+    * @param pDest
+    *        The buffer which will receive the elements.
+    *        This must not overlap \em pSource.
+    * @param elementCount
+    *        The number of elements in \em pDest.
+    * @param elementSize
+    *        The number of bytes in each element.
+    */
+   void unshuffle(const void* pSource, void* pDest, size_t elementCount, size_t elementSize);
+}
+
+#endif
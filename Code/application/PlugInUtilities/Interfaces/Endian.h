@@ -217,22 +217,40 @@ public:
          return false;
       }
 
-      for (size_t i = 0; i < count; ++i)
-      {
-         unsigned char* pData = reinterpret_cast<unsigned char*>(pBuffer) + (i * dataSize);
-         for (size_t j = 0; j < dataSize / 2; ++j)
-         {
-            size_t index = dataSize - j - 1;
-
-            unsigned char byteData = pData[j];
-            pData[j] = pData[index];
-            pData[index] = byteData;
-         }
-      }
-
-      return true;
+      return copySwapBuffer(pBuffer, pBuffer, dataSize, count);
    }
 
+   /**
+    *  Copies an array of data elements, swapping the bytes of each element.
+    *
+    *  This method copies and byte swaps the data in a single pass, which is
+    *  faster than copying the data and then calling swapBuffer().  The bytes
+    *  are only swapped if the endian type of the system is different than the
+    *  endian type of <em>this</em>; otherwise the data is copied unchanged.
+    *  Elements of 2, 4 and 8 bytes are swapped with vector instructions when
+    *  the processor supports them.  Complex data should be copied by passing
+    *  the size of one component and twice the number of elements.
+    *
+    *  @param   pDestination
+    *           A pointer to the memory receiving the data.  This may be the
+    *           same as \em pSource to swap the data in place, but the two
+    *           buffers must not otherwise overlap.
+    *  @param   pSource
+    *           A pointer to the data to be copied.
+    *  @param   dataSize
+    *           The size of each element in the array.
+    *  @param   count
+    *           The number of items in the array to copy.
+    *
+    *  @return  Returns true if byte swapping was actually performed.  Returns
+    *           false if the data was copied without swapping because the endian
+    *           type is already the same as the system, or if either pointer is
+    *           \c NULL.
+    *
+    *  @see     swapBuffer(void *,size_t,size_t)
+    */
+   bool copySwapBuffer(void* pDestination, const void* pSource, size_t dataSize, size_t count) const;
+
    /**
     *  Returns the endian type of the system.
     *
@@ -54,6 +54,26 @@ enum ResultEnum { SUCCESS, FAILURE, ABORT };
  */
 typedef EnumWrapper<ResultEnum> Result;
 
+/**
+ * Specifies how the work of a MultiThreadedAlgorithm is divided between its threads.
+ */
+enum SchedulingEnum
+{
+   STATIC_SCHEDULING,   /**< Each thread processes a single contiguous range of items which is
+                             computed before the threads start. */
+   DYNAMIC_SCHEDULING   /**< The threads run in a persistent thread pool and repeatedly claim blocks of
+                             items which shrink as the remaining work runs out.  This balances the
+                             load when the cost of each item is uneven. */
+};
+
+/**
+ * @EnumWrapper mta::SchedulingEnum.
+ */
+typedef EnumWrapper<SchedulingEnum> Scheduling;
+
+class ChunkScheduler;
+class PooledThread;
+
 /**
  * An action that can be run.
  */
@@ -283,7 +303,10 @@ public:
       mpAlgorithmMutex(NULL),
       mReporter(reporter), 
       mThreadHandle(static_cast<void*>(this),  reinterpret_cast<void*>(AlgorithmThread::threadFunction)), 
-      mThreadIndex(threadIndex) {}
+      mThreadIndex(threadIndex),
+      mpScheduler(NULL),
+      mpPooledThread(NULL),
+      mStaticRangeIssued(false) {}
 
    /**
     * Destructor.
@@ -300,7 +323,10 @@ public:
       mpAlgorithmMutex(thread.mpAlgorithmMutex),
       mReporter(thread.mReporter), 
       mThreadHandle(static_cast<void*>(this),  reinterpret_cast<void*>(AlgorithmThread::threadFunction)),
-      mThreadIndex(thread.mThreadIndex) {}
+      mThreadIndex(thread.mThreadIndex),
+      mpScheduler(thread.mpScheduler),
+      mpPooledThread(NULL),
+      mStaticRangeIssued(false) {}
 
    /**
     * The function executed by the underlying threading system.
@@ -318,6 +344,9 @@ public:
    /**
     * Launch the thread.
     *
+    * If a ChunkScheduler has been set, the thread is run by an idle thread
+    * from a persistent pool instead of a newly created thread.
+    *
     * @return False if there was an error.
     */
    bool launch();
@@ -356,6 +385,21 @@ public:
     */
    void waitForAlgorithmLoop();
 
+   /**
+    * Set the object which hands out the items processed by the threads in an
+    * algorithm cluster.
+    *
+    * This should be the same object for all threads in the algorithm cluster.
+    * If this is never called, or is called with \c NULL, the thread uses static
+    * scheduling.
+    *
+    * @param pScheduler
+    *        The scheduler for dynamic scheduling.
+    *
+    * @see getNextRange()
+    */
+   void setScheduler(ChunkScheduler* pScheduler);
+
    /**
     * Represents a range in integers.
     */
@@ -404,6 +448,38 @@ protected:
     */
    Range getThreadRange(int threadCount, int dataSize) const;
 
+   /**
+    * Get the next range of values for this thread to process.
+    *
+    * With static scheduling, the first call returns the range computed by
+    * getThreadRange() and later calls return \c false.  With dynamic scheduling,
+    * each call claims the next unprocessed block of items, so a thread that
+    * finishes its blocks early takes on work that would otherwise have waited
+    * for a slower thread.  Progress reported through getReporter() while
+    * processing a range should be relative to that range, as computed by
+    * Range::computePercent().
+    *
+    * A thread which processes its work this way should call this function in a
+    * loop from run():
+    * @code
+    * while (getNextRange(mThreadCount, rowCount, mRowRange))
+    * {
+    *    processRows(); // uses mRowRange exactly as a static thread would
+    * }
+    * @endcode
+    *
+    * @param threadCount
+    *        The total number of threads in an algorithm cluster.
+    * @param dataSize
+    *        The total number of items which need to be processed.  This must be
+    *        the same for every thread in the algorithm cluster.
+    * @param range
+    *        Set to the range of items to process if the function returns \c true.
+    * @return True if \em range holds items to process, or false if there is no
+    *         work left for this thread or the algorithm has failed.
+    */
+   bool getNextRange(int threadCount, int dataSize, Range& range);
+
    /**
     * Get the id of this thread.
     *
@@ -423,6 +499,107 @@ private:
    ThreadReporter& mReporter;
    BThread mThreadHandle;
    int mThreadIndex;
+   ChunkScheduler* mpScheduler;
+   PooledThread* mpPooledThread;
+   bool mStaticRangeIssued;
+};
+
+/**
+ * Hands out blocks of items to the threads of an algorithm cluster using
+ * dynamic scheduling.
+ *
+ * Blocks are claimed in order from a shared counter.  The size of each block is
+ * a fraction of the items that have not yet been claimed, so the first blocks
+ * are large to keep the scheduling overhead low and the last blocks are small so
+ * that the threads finish at about the same time.
+ *
+ * The scheduler is also the ThreadReporter given to each thread.  Progress which
+ * a thread reports for its current block is converted into the thread's share of
+ * the overall progress before it is passed to the underlying reporter.  No
+ * further blocks are handed out once an error has been reported or the
+ * underlying reporter returns anything other than SUCCESS.
+ */
+class ChunkScheduler : public ThreadReporter
+{
+public:
+   /**
+    * Constructor.
+    *
+    * @param threadCount
+    *        The number of threads in the algorithm cluster.
+    * @param reporter
+    *        The reporter which receives the converted reports.
+    */
+   ChunkScheduler(int threadCount, ThreadReporter& reporter);
+
+   /**
+    * Destructor.
+    */
+   virtual ~ChunkScheduler() {};
+
+   /**
+    * Claim the next block of items.
+    *
+    * @param threadIndex
+    *        ID number for the calling thread.
+    * @param dataSize
+    *        The total number of items which need to be processed.
+    * @param range
+    *        Set to the claimed block if the function returns \c true.
+    * @return True if a block was claimed, false if there are no items left or
+    *         the algorithm has failed.
+    */
+   bool getNextRange(int threadIndex, int dataSize, AlgorithmThread::Range& range);
+
+   /**
+    * Indicate that a thread will not claim any more blocks.
+    *
+    * @param threadIndex
+    *        ID number for the thread.
+    */
+   void finishThread(int threadIndex);
+
+   /**
+    * @copydoc ThreadReporter::reportProgress()
+    */
+   Result reportProgress(int threadIndex, int percentDone);
+
+   /**
+    * @copydoc ThreadReporter::reportCompletion()
+    */
+   Result reportCompletion(int threadIndex);
+
+   /**
+    * @copydoc ThreadReporter::reportError()
+    */
+   Result reportError(std::string errorText);
+
+   /**
+    * @copydoc ThreadReporter::getErrorText()
+    */
+   std::string getErrorText() const;
+
+   /**
+    * @copydoc ThreadReporter::getProgress()
+    */
+   int getProgress(int threadIndex) const;
+
+   /**
+    * @copydoc ThreadReporter::runInMainThread()
+    */
+   void runInMainThread(ThreadCommand& command);
+
+private:
+   ChunkScheduler& operator=(const ChunkScheduler& rhs);
+
+   ThreadReporter& mReporter;
+   int mThreadCount;
+   int mDataSize;
+   int mNextItem;
+   bool mStopped;
+   std::vector<int> mCompletedItems;
+   std::vector<int> mCurrentItems;
+   mutable DMutex mMutex;
 };
 
 #if defined(WIN_API)
@@ -647,8 +824,13 @@ public:
     *        Algorithm output.
     * @param pProgress
     *        Used to report progress and errors.
+    * @param scheduling
+    *        How the work is divided between the threads.  The thread class must
+    *        claim its work with AlgorithmThread::getNextRange() to benefit from
+    *        DYNAMIC_SCHEDULING.
     */
-   MultiThreadedAlgorithm(int threadCount, const AlgInput& input, AlgOutput& output, ProgressReporter* pProgress);
+   MultiThreadedAlgorithm(int threadCount, const AlgInput& input, AlgOutput& output, ProgressReporter* pProgress,
+      Scheduling scheduling = STATIC_SCHEDULING);
 
    /**
     * Destructor.
@@ -688,6 +870,7 @@ private:
    AlgOutput& mOutput;
    std::vector<AlgThread*> mThreads;
    MultiThreadReporter* mpThreadReporter;
+   ChunkScheduler* mpScheduler;
    ProgressReporter* mpProgressReporter;
    DMutex mMutexA;
    DThreadSignal mSignalA;
@@ -698,14 +881,19 @@ private:
 
 template<class AlgInput, class AlgOutput, class AlgThread>
 MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::MultiThreadedAlgorithm(int threadCount,
-   const AlgInput& algInput, AlgOutput& algOutput, ProgressReporter* pReporter) :
+   const AlgInput& algInput, AlgOutput& algOutput, ProgressReporter* pReporter, Scheduling scheduling) :
    mCurrentStatus(SUCCESS),
    mInput(algInput),
    mOutput(algOutput),
    mpThreadReporter(NULL),
+   mpScheduler(NULL),
    mpProgressReporter(pReporter)
 {
    mpThreadReporter = new MultiThreadReporter(threadCount, &mCurrentStatus, mMutexA, mSignalA, mMutexB, mSignalB);
+   if (scheduling == DYNAMIC_SCHEDULING)
+   {
+      mpScheduler = new ChunkScheduler(threadCount, *mpThreadReporter);
+   }
    createThreads(threadCount);
 }
 
@@ -723,20 +911,28 @@ MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::~MultiThreadedAlgorithm(
    }
 
    mThreads.clear();
+   delete mpScheduler;
    delete mpThreadReporter;
 }
 
 template<class AlgInput, class AlgOutput, class AlgThread>
 Result MultiThreadedAlgorithm<AlgInput, AlgOutput, AlgThread>::createThreads(int threadCount)
 {
+   ThreadReporter* pReporter = mpThreadReporter;
+   if (mpScheduler != NULL)
+   {
+      pReporter = mpScheduler;
+   }
+
    int i;
    for (i = 0; i < threadCount; ++i)
    {
       AlgThread* pThread = NULL;
-      pThread = new AlgThread(mInput, threadCount, i, *mpThreadReporter);
+      pThread = new AlgThread(mInput, threadCount, i, *pReporter);
       if (pThread != NULL)
       {
          pThread->setAlgorithmMutex(&mMutexA);
+         pThread->setScheduler(mpScheduler);
          mThreads.push_back(pThread);
       }
    }
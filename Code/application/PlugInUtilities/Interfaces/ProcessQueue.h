@@ -0,0 +1,120 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef PROCESSQUEUE_H
+#define PROCESSQUEUE_H
+
+#include "TypesFile.h"
+
+#include <string>
+#include <vector>
+
+class QProcess;
+
+/**
+ *  Runs external processes concurrently and reports their results in the
+ *  order in which the processes were added.
+ *
+ *  A process is only started when fewer than the maximum number of processes
+ *  are running and the estimated memory of the running processes and the new
+ *  process fits in the memory budget.  One process is always allowed to run,
+ *  regardless of its estimated memory.  No new processes are started after a
+ *  process fails, and the running processes are killed when the queue is
+ *  aborted.
+ */
+class ProcessQueue
+{
+public:
+   /**
+    *  The command line and the results of a single process.
+    */
+   struct Run
+   {
+      std::string mProgram;
+      std::vector<std::string> mArguments;
+      uint64_t mEstimatedSize;
+      bool mFinished;
+      bool mSuccess;
+      int mExitCode;
+      std::string mMessage;
+      std::string mOutput;       // the end of the merged standard output and standard error
+   };
+
+   /**
+    *  Creates an empty queue.
+    *
+    *  @param   maxRunning
+    *           The maximum number of processes to run at once.
+    *  @param   memoryBudget
+    *           The maximum total estimated size in bytes of the running processes.
+    */
+   ProcessQueue(unsigned int maxRunning, uint64_t memoryBudget);
+   virtual ~ProcessQueue();
+
+   /**
+    *  Adds a process to the end of the queue.
+    *
+    *  @param   program
+    *           The full path and name of the executable.
+    *  @param   arguments
+    *           The command line arguments for the executable.
+    *  @param   estimatedSize
+    *           The estimated memory in bytes used by the process.
+    */
+   void addRun(const std::string& program, const std::vector<std::string>& arguments, uint64_t estimatedSize = 0);
+
+   size_t getRunCount() const;
+   const Run& getRun(size_t index) const;
+
+   /**
+    *  Runs the processes in the queue and waits for them to finish.
+    *
+    *  @return  Returns \c true if every process exited normally with an exit
+    *           code of zero, or \c false if a process failed or the queue was
+    *           aborted.
+    */
+   bool execute();
+
+protected:
+   /**
+    *  Called when a process and every process added before it have finished.
+    *
+    *  Processes which are not started because an earlier process failed are
+    *  not reported.  The default implementation does nothing.
+    *
+    *  @param   index
+    *           The position of the process in the queue.
+    *  @param   run
+    *           The command line and the results of the process.
+    */
+   virtual void runFinished(size_t index, const Run& run);
+
+   /**
+    *  Called while the processes run to check whether they should be killed.
+    *
+    *  @return  Returns \c true to kill the running processes and stop.  The
+    *           default implementation returns \c false.
+    */
+   virtual bool isAborted();
+
+private:
+   ProcessQueue(const ProcessQueue& rhs);
+   ProcessQueue& operator=(const ProcessQueue& rhs);
+
+   bool startRun(size_t index);
+   bool updateRun(size_t index);
+   void stopRuns();
+
+   unsigned int mMaxRunning;
+   uint64_t mMemoryBudget;
+   std::vector<Run> mRuns;
+   std::vector<QProcess*> mProcesses;
+};
+
+#endif
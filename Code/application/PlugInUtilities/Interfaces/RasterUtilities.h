@@ -674,6 +674,23 @@ namespace RasterUtilities
       unsigned int bands, EncodingType encoding, ProcessingLocation location, InterleaveFormatType interleave = BIP,
       DataElement* pParent = NULL, void* pData = NULL, bool bOwner = true);
 
+   /**
+    * Determines the processing location for an algorithm result which is
+    * derived from existing data.
+    *
+    * Results of \link ProcessingLocation::IN_MEMORY IN_MEMORY \endlink,
+    * \link ProcessingLocation::IN_MEMORY_COMPRESSED IN_MEMORY_COMPRESSED \endlink and
+    * \link ProcessingLocation::IN_MEMORY_SPILLABLE IN_MEMORY_SPILLABLE \endlink
+    * data are kept in the same processing location as the source data.  Results
+    * of all other data are created \link ProcessingLocation::ON_DISK ON_DISK \endlink.
+    *
+    * @param sourceLocation
+    *        The processing location of the data the algorithm is processing.
+    *
+    * @return The processing location to pass to createRasterElement() for the result.
+    */
+   ProcessingLocation getResultProcessingLocation(ProcessingLocation sourceLocation);
+
    /**
     * Determine the number of bytes in a single element of a
     * given EncodingType.
@@ -1055,7 +1072,8 @@ namespace RasterUtilities
     *         Pixels which do not map to anything in the original data set will be set to this value.
     *         This value will be added to the bad values list if it is not already there.
     *  @param interp
-    *         Interpolation type. Only ::INTERP_NEAREST_NEIGHBOR is currently supported.
+    *         Interpolation type. ::INTERP_NEAREST_NEIGHBOR, ::INTERP_BILINEAR and ::INTERP_BICUBIC
+    *         are supported. Complex data can only be rotated with ::INTERP_NEAREST_NEIGHBOR.
     *  @param pProgress
     *         Report progress.
     *  @param pAbort
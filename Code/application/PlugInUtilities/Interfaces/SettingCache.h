@@ -0,0 +1,264 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SETTINGCACHE_H
+#define SETTINGCACHE_H
+
+#include <boost/atomic.hpp>
+#include <stddef.h>
+
+namespace mta
+{
+   class DMutex;
+}
+
+/**
+ * The non-template portion of SettingCache.
+ *
+ * The settings generation is a counter which changes each time
+ * ConfigurationSettings notifies SIGNAL_NAME(Subject, Modified), which it
+ * does after every SIGNAL_NAME(ConfigurationSettings, SettingModified).
+ * Each module has its own counter, which is attached to ConfigurationSettings
+ * the first time it is requested.
+ */
+class SettingCacheBase
+{
+public:
+   /**
+    * Returns the current settings generation.
+    *
+    * @return The current generation, or 0 if ConfigurationSettings is not
+    *         available and values should not be cached.
+    */
+   static unsigned int getGeneration();
+
+protected:
+   SettingCacheBase();
+   ~SettingCacheBase();
+
+   void lock() const;
+   void unlock() const;
+
+private:
+   SettingCacheBase(const SettingCacheBase& rhs);
+   SettingCacheBase& operator=(const SettingCacheBase& rhs);
+
+   mta::DMutex* mpMutex;
+};
+
+/**
+ * Holds the most recent value of a single setting.
+ *
+ * This is used by the getSetting method generated by the SETTING() macro so
+ * the setting key does not need to be looked up in ConfigurationSettings and
+ * converted from a DataVariant each time the method is called.  The cached
+ * value is discarded whenever any setting is modified.
+ *
+ * A SettingCache may be used from any thread.  Reading a string or other
+ * non-scalar value takes a lock so it can be copied, while scalar settings
+ * use a ScalarSettingCache and do not lock.
+ *
+ * @warning  Changes made to ConfigurationSettings while its signals are
+ *           disabled are not seen until another setting is modified.
+ *
+ * @see \ref settingsmacros
+ */
+template<typename T>
+class SettingCache : public SettingCacheBase
+{
+public:
+   /**
+    * Creates an empty cache.
+    */
+   SettingCache() :
+      mpValue(NULL),
+      mGeneration(0)
+   {
+   }
+
+   /**
+    * Destroys the cache.
+    */
+   ~SettingCache()
+   {
+      delete mpValue;
+   }
+
+   /**
+    * Returns the cached value, loading it first if any setting has been
+    * modified since it was cached.
+    *
+    * @param pLoad
+    *        The function which returns the current value from
+    *        ConfigurationSettings.
+    *
+    * @return The current value of the setting.
+    */
+   T get(T (*pLoad)())
+   {
+      unsigned int generation = getGeneration();
+      if (generation != 0)
+      {
+         lock();
+         if (mpValue != NULL && mGeneration == generation)
+         {
+            T value(*mpValue);
+            unlock();
+            return value;
+         }
+         unlock();
+      }
+
+      // A modification after the generation was read will change the
+      // generation again, so the loaded value will not be used past it
+      T value(pLoad());
+      if (generation != 0)
+      {
+         lock();
+         if (mpValue == NULL)
+         {
+            mpValue = new T(value);
+         }
+         else
+         {
+            *mpValue = value;
+         }
+         mGeneration = generation;
+         unlock();
+      }
+
+      return value;
+   }
+
+private:
+   T* mpValue;
+   unsigned int mGeneration;
+};
+
+/**
+ * Holds the most recent value of a single scalar setting without locking.
+ *
+ * The value and its generation are published with a sequence counter which
+ * is odd while they are being stored.  A reader only uses the value if the
+ * counter is even and unchanged after the value and generation have been
+ * read, so it never sees a value from one store paired with the generation
+ * from another.  If two threads load the setting at the same time, only one
+ * of them stores it.
+ *
+ * @see SettingCache
+ */
+template<typename T>
+class ScalarSettingCache
+{
+public:
+   /**
+    * Creates an empty cache.
+    */
+   ScalarSettingCache() :
+      mSequence(0),
+      mGeneration(0),
+      mValue(T())
+   {
+   }
+
+   /**
+    * Returns the cached value, loading it first if any setting has been
+    * modified since it was cached.
+    *
+    * @param pLoad
+    *        The function which returns the current value from
+    *        ConfigurationSettings.
+    *
+    * @return The current value of the setting.
+    */
+   T get(T (*pLoad)())
+   {
+      unsigned int generation = SettingCacheBase::getGeneration();
+      if (generation != 0)
+      {
+         unsigned int sequence = mSequence.load(boost::memory_order_acquire);
+         if ((sequence & 1) == 0)
+         {
+            unsigned int cachedGeneration = mGeneration.load(boost::memory_order_relaxed);
+            T value = mValue.load(boost::memory_order_relaxed);
+            boost::atomic_thread_fence(boost::memory_order_acquire);
+            if (cachedGeneration == generation && mSequence.load(boost::memory_order_relaxed) == sequence)
+            {
+               return value;
+            }
+         }
+      }
+
+      T value(pLoad());
+      if (generation != 0)
+      {
+         unsigned int sequence = mSequence.load(boost::memory_order_relaxed);
+         if ((sequence & 1) == 0 &&
+            mSequence.compare_exchange_strong(sequence, sequence + 1, boost::memory_order_relaxed))
+         {
+            boost::atomic_thread_fence(boost::memory_order_release);
+            mGeneration.store(generation, boost::memory_order_relaxed);
+            mValue.store(value, boost::memory_order_relaxed);
+            mSequence.store(sequence + 2, boost::memory_order_release);
+         }
+      }
+
+      return value;
+   }
+
+private:
+   ScalarSettingCache(const ScalarSettingCache& rhs);
+   ScalarSettingCache& operator=(const ScalarSettingCache& rhs);
+
+   boost::atomic<unsigned int> mSequence;
+   boost::atomic<unsigned int> mGeneration;
+   boost::atomic<T> mValue;
+};
+
+/**
+ * Caches a bool setting without locking.
+ */
+template<>
+class SettingCache<bool> : public ScalarSettingCache<bool>
+{
+};
+
+/**
+ * Caches an int setting without locking.
+ */
+template<>
+class SettingCache<int> : public ScalarSettingCache<int>
+{
+};
+
+/**
+ * Caches an unsigned int setting without locking.
+ */
+template<>
+class SettingCache<unsigned int> : public ScalarSettingCache<unsigned int>
+{
+};
+
+/**
+ * Caches a float setting without locking.
+ */
+template<>
+class SettingCache<float> : public ScalarSettingCache<float>
+{
+};
+
+/**
+ * Caches a double setting without locking.
+ */
+template<>
+class SettingCache<double> : public ScalarSettingCache<double>
+{
+};
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SIGNALBATCHER_H
+#define SIGNALBATCHER_H
+
+#include "SafePtr.h"
+#include "Subject.h"
+
+/**
+ * SignalBatcher is an RAII class for coalescing the signals notified by a
+ * Subject during a bulk operation.
+ *
+ * While the SignalBatcher exists, each signal notified by the Subject is held
+ * instead of being delivered.  When the SignalBatcher goes out of scope, each
+ * held signal is delivered once, in the order in which it was first notified,
+ * followed by a single SIGNAL_NAME(Subject, Modified).  SignalBatchers on the
+ * same Subject may be nested, in which case the signals are delivered when the
+ * outermost SignalBatcher is destroyed.
+ *
+ * SIGNAL_NAME(Subject, Deleted) is never held.  Any held signals are delivered
+ * before it.
+ *
+ * @code
+ * {
+ *    SignalBatcher batcher(*pGcpList);
+ *    for (list<GcpPoint>::const_iterator iter = points.begin(); iter != points.end(); ++iter)
+ *    {
+ *       pGcpList->addPoint(*iter);
+ *    }
+ * } // GcpList::PointAdded and Subject::Modified are each notified once here
+ * @endcode
+ *
+ * @warning  Only the data from the most recent notification of each signal is
+ *           delivered.  A SignalBatcher should only be used when the attached
+ *           slots do not depend on receiving the data from every notification.
+ *
+ * @see Subject, SignalBlocker
+ */
+class SignalBatcher
+{
+public:
+   /**
+    * Creates the RAII object and starts holding the signals of the specified
+    * Subject.
+    *
+    * @param subject
+    *         The Subject whose signals should be coalesced.
+    */
+   explicit SignalBatcher(Subject& subject) :
+      mpSubject(&subject)
+   {
+      mpSubject->beginSignalBatch();
+   }
+
+   /**
+    * Destroys the SignalBatcher, delivering the held signals if this is the
+    * outermost SignalBatcher for the Subject.
+    */
+   ~SignalBatcher()
+   {
+      if (mpSubject.get() != NULL)
+      {
+         mpSubject->endSignalBatch();
+      }
+   }
+
+private:
+   SignalBatcher& operator=(const SignalBatcher&); // prevents assignment
+   SignalBatcher(const SignalBatcher&); // prevents copying
+
+   SafePtr<Subject> mpSubject;
+};
+
+#endif
@@ -0,0 +1,177 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SPECTRALMATCHER_H
+#define SPECTRALMATCHER_H
+
+#include "EnumWrapper.h"
+
+#include <string>
+#include <vector>
+
+class BitMask;
+class Progress;
+class RasterElement;
+
+/**
+ * Scores each pixel of a raster element against a set of signatures.
+ *
+ * All signatures are scored in a single streaming pass over the data, which is
+ * read through BIP data accessors so any interleave can be matched.  Each thread
+ * converts a block of pixels to a dense matrix and multiplies it by the
+ * signature (or filter) matrix, so the signatures are read from cache once per
+ * block instead of once per pixel.  The detectors which need background
+ * statistics make an additional pass to compute them first.
+ *
+ * Pixels outside the AOI and pixels with a bad value in any band are not
+ * scored and are excluded from the background statistics.  Their scores are
+ * set to NO_DATA_SCORE and their class is set to 0.
+ *
+ * The signatures must already be resampled to the bands of the raster element,
+ * e.g. with SignatureLibrary::resample().
+ */
+class SpectralMatcher
+{
+public:
+   /**
+    * The score computed for each signature.
+    */
+   enum MethodEnum
+   {
+      SAM,              /**< The spectral angle, in radians, between the pixel and the signature.
+                             Lower scores are better matches. */
+      CORRELATION,      /**< The correlation coefficient between the pixel and the signature. */
+      CEM,              /**< Constrained energy minimization using the second moment of the data. */
+      MATCHED_FILTER,   /**< The matched filter using the mean and covariance of the data. */
+      ACE               /**< The adaptive coherence estimator using the mean and covariance of the data. */
+   };
+
+   /**
+    * @EnumWrapper SpectralMatcher::MethodEnum.
+    */
+   typedef EnumWrapper<MethodEnum> Method;
+
+   /**
+    * The score given to pixels which are not scored.
+    *
+    * This is set as the bad value of the score element.
+    */
+   static const int NO_DATA_SCORE = -9999;
+
+   /**
+    * Creates a matcher.
+    *
+    * @param method
+    *        The score to compute.
+    * @param signatures
+    *        The signature values, one signature after another.  Each signature
+    *        must have one value for each active band of the raster element.
+    * @param signatureCount
+    *        The number of signatures in \em signatures.
+    */
+   SpectralMatcher(Method method, const std::vector<double>& signatures, unsigned int signatureCount);
+
+   /**
+    * Destroys the matcher.
+    */
+   ~SpectralMatcher();
+
+   /**
+    * Limits matching to the pixels selected in an AOI.
+    *
+    * @param pAoi
+    *        The selected pixels, or \c NULL to match every pixel.
+    */
+   void setAoi(const BitMask* pAoi);
+
+   /**
+    * Sets the score a pixel must reach to be assigned a class.
+    *
+    * For SAM a pixel is assigned the class of its best signature if its
+    * score is less than or equal to the threshold.  For the other methods
+    * the score must be greater than or equal to the threshold.  By default
+    * every scored pixel is assigned a class.
+    *
+    * @param threshold
+    *        The score threshold.
+    */
+   void setClassThreshold(double threshold);
+
+   /**
+    * Sets a flag which is checked between rows to stop matching.
+    *
+    * @param pAbort
+    *        The abort flag, or \c NULL.  The flag must remain valid until
+    *        match() returns.
+    */
+   void setAbortFlag(const bool* pAbort);
+
+   /**
+    * Sets the Progress which receives the progress of match().
+    *
+    * @param pProgress
+    *        The progress object, or \c NULL.
+    */
+   void setProgress(Progress* pProgress);
+
+   /**
+    * Scores the pixels of a raster element.
+    *
+    * @param pRaster
+    *        The raster element to match.  Complex data is not supported.
+    * @param pScores
+    *        A FLT4BYTES BIP raster element with the same rows and columns as
+    *        \em pRaster and one band per signature which receives the scores,
+    *        or \c NULL if the scores are not needed.
+    * @param pClasses
+    *        An INT2UBYTES raster element with the same rows and columns as
+    *        \em pRaster which receives the one-based index of the best matching
+    *        signature, or 0 if the pixel does not match, or \c NULL if the
+    *        classes are not needed.
+    *
+    * @return True if all pixels were matched, false if an error occurred or
+    *         matching was aborted.
+    *
+    * @see getErrorMessage()
+    */
+   bool match(const RasterElement* pRaster, RasterElement* pScores, RasterElement* pClasses);
+
+   /**
+    * Returns the reason the last call to match() failed.
+    *
+    * @return The error message, or an empty string if match() succeeded.
+    */
+   const std::string& getErrorMessage() const;
+
+   /**
+    * Queries whether lower scores are better matches.
+    *
+    * @param method
+    *        The method to query.
+    *
+    * @return True for SAM, false otherwise.
+    */
+   static bool isLowerScoreBetter(Method method);
+
+private:
+   SpectralMatcher(const SpectralMatcher& rhs);
+   SpectralMatcher& operator=(const SpectralMatcher& rhs);
+
+   Method mMethod;
+   std::vector<double> mSignatures;
+   unsigned int mSignatureCount;
+   const BitMask* mpAoi;
+   bool mUseThreshold;
+   double mThreshold;
+   const bool* mpAbort;
+   Progress* mpProgress;
+   std::string mErrorMessage;
+};
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SPECTRALRESAMPLER_H
+#define SPECTRALRESAMPLER_H
+
+#include "EnumWrapper.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Resamples spectra from one set of wavelengths to another.
+ *
+ * The interpolation weights depend only on the source and destination
+ * wavelengths, so they are computed once by initialize() and stored as a
+ * sparse matrix with one row per destination wavelength.  resample() then
+ * applies that matrix to any number of spectra, dividing large batches
+ * between multiple threads.
+ *
+ * Every destination wavelength must lie within the range of the source
+ * wavelengths.  The source wavelengths do not need to be sorted.
+ */
+class SpectralResampler
+{
+public:
+   /**
+    * The interpolation used to compute each destination value.
+    */
+   enum MethodEnum
+   {
+      LINEAR,        /**< Linear interpolation between the two nearest source wavelengths. */
+      CUBIC_SPLINE,  /**< A natural cubic spline through the source values. */
+      GAUSSIAN       /**< A Gaussian band response with the destination full width half max,
+                          integrated over the source wavelengths. */
+   };
+
+   /**
+    * @EnumWrapper SpectralResampler::MethodEnum.
+    */
+   typedef EnumWrapper<MethodEnum> Method;
+
+   /**
+    * Creates a resampler which must be initialized before it is used.
+    */
+   SpectralResampler();
+
+   /**
+    * Computes the interpolation weights.
+    *
+    * @param method
+    *        The interpolation to use.
+    * @param fromWavelengths
+    *        The wavelengths of the source spectra.  At least two distinct
+    *        wavelengths are required.
+    * @param toWavelengths
+    *        The wavelengths to resample to.
+    * @param toFwhm
+    *        The full width half max of each destination wavelength.  This is
+    *        only used by GAUSSIAN.  If it is empty, the width of each band is
+    *        taken from the spacing of the destination wavelengths.
+    *
+    * @return True if the weights were computed, false otherwise.
+    *
+    * @see getErrorMessage()
+    */
+   bool initialize(Method method, const std::vector<double>& fromWavelengths,
+      const std::vector<double>& toWavelengths, const std::vector<double>& toFwhm = std::vector<double>());
+
+   /**
+    * Queries whether initialize() succeeded.
+    *
+    * @return True if resample() may be called, false otherwise.
+    */
+   bool isValid() const;
+
+   /**
+    * Returns the reason initialize() failed.
+    *
+    * @return The error message, or an empty string if initialize() succeeded.
+    */
+   const std::string& getErrorMessage() const;
+
+   /**
+    * Returns the number of values in each source spectrum.
+    *
+    * @return The number of source wavelengths.
+    */
+   unsigned int getFromCount() const;
+
+   /**
+    * Returns the number of values in each resampled spectrum.
+    *
+    * @return The number of destination wavelengths.
+    */
+   unsigned int getToCount() const;
+
+   /**
+    * Resamples a batch of spectra.
+    *
+    * @param pFromData
+    *        The source spectra, one after another, each with getFromCount()
+    *        values.
+    * @param pToData
+    *        Receives the resampled spectra, one after another, each with
+    *        getToCount() values.
+    * @param count
+    *        The number of spectra to resample.
+    *
+    * @return True if the spectra were resampled, false if the resampler is
+    *         not valid.
+    */
+   bool resample(const double* pFromData, double* pToData, unsigned int count = 1) const;
+
+private:
+   Method mMethod;
+   unsigned int mFromCount;
+   std::vector<unsigned int> mOffsets;
+   std::vector<unsigned int> mIndices;
+   std::vector<double> mWeights;
+   std::string mErrorMessage;
+};
+
+#endif
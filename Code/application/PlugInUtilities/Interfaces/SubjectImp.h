@@ -86,6 +86,24 @@ protected:
     */
    void enableSignals(bool enabled);
 
+   /**
+    *  Starts coalescing the signals notified by the Subject.
+    *
+    *  While a batch is active, each signal other than SIGNAL_NAME(Subject, Deleted)
+    *  is held instead of being delivered.  Repeated notifications of the same
+    *  signal are combined into a single notification carrying the data from the
+    *  most recent one.
+    */
+   void beginSignalBatch();
+
+   /**
+    *  Ends a batch started with beginSignalBatch().
+    *
+    *  When the outermost batch ends, each held signal is delivered once in the
+    *  order it was first notified, followed by a single SIGNAL_NAME(Subject, Modified).
+    */
+   void endSignalBatch();
+
    SubjectImpPrivate* mpImpPrivate;
 };
 
@@ -105,6 +123,14 @@ protected:
    { \
       impClass::enableSignals(enabled); \
    } \
+   void beginSignalBatch() \
+   { \
+      impClass::beginSignalBatch(); \
+   } \
+   void endSignalBatch() \
+   { \
+      impClass::endSignalBatch(); \
+   } \
    public: \
    bool signalsEnabled() const \
    { \
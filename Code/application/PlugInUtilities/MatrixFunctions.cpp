@@ -118,7 +118,7 @@ bool MatrixFunctions::invertSquareMatrix1D(double* pDestination, const double* p
    }
 
    EigenRowMatrixType sourceMatrix(numRows, numRows);
-   memcpy(sourceMatrix.data(), pSource, numRows * sizeof(double));
+   memcpy(sourceMatrix.data(), pSource, numRows * numRows * sizeof(double));
 
    auto pivlu = sourceMatrix.fullPivLu();
    if (!pivlu.isInvertible())
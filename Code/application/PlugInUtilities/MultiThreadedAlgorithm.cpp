@@ -84,22 +84,22 @@ struct CompletionFunctor : public ProgressFunctor
    CompletionFunctor(int *pProgressValue) : ProgressFunctor(pProgressValue, 100) {}
    virtual ~CompletionFunctor() {};
 };
+// The result is set to FAILURE by the main thread when it processes the error.  Setting it
+// here would let the main thread stop waiting for reports before it receives this one.
 struct ErrorFunctor : public ThreadCommand
 {
-   ErrorFunctor(std::string errorText, std::string& errorMessage, Result *pResult) : 
-      mErrorText(errorText), mMessage(errorMessage), mpResult(pResult) {}
+   ErrorFunctor(std::string errorText, std::string& errorMessage) : 
+      mErrorText(errorText), mMessage(errorMessage) {}
    virtual ~ErrorFunctor() {};
    virtual void run()
    {
       mMessage = mErrorText;
-      *mpResult = FAILURE;
    }
 private:
    ErrorFunctor& operator=(const ErrorFunctor& rhs);
 
    std::string mErrorText;
    std::string& mMessage;
-   Result* mpResult;
 };
 struct WorkFunctor : public ThreadCommand
 {
@@ -151,7 +151,7 @@ Result MultiThreadReporter::reportProgress(int threadIndex, int percentDone)
 
 Result MultiThreadReporter::reportError(std::string errorText)
 {
-   ErrorFunctor cmd(errorText, mErrorMessage, mpResult);
+   ErrorFunctor cmd(errorText, mErrorMessage);
    return signalMainThread(cmd, THREAD_ERROR);
 }
 
@@ -218,10 +218,6 @@ Result MultiThreadReporter::signalMainThread(ThreadCommand& reportStatus, Report
          reportStatus.run();
       }
       mReportType |= type;
-      if (mpResult != NULL)
-      {
-         currentResult = *mpResult;
-      }
 
       { // scope the lock
          // ensures that the main thread is in its ThreadSignalWait
@@ -241,17 +237,251 @@ Result MultiThreadReporter::signalMainThread(ThreadCommand& reportStatus, Report
       {
          mpThreadCommand = NULL;
       }
+
+      if (mpResult != NULL && type != THREAD_COMPLETE)
+      {
+         currentResult = *mpResult;
+      }
    }
 
    return currentResult;
 }
 
+//------------ PooledThread ---------------//
+
+namespace mta
+{
+/*
+   A persistent thread which runs AlgorithmThreads for dynamically scheduled
+   algorithms.  Idle threads are reused by later algorithms so that algorithms
+   which run many times, such as image tile generation, do not pay for thread
+   creation each time.  A new thread is created whenever no idle thread is
+   available, so algorithms started from within a pooled thread cannot deadlock
+   waiting for the pool.  The threads are never destroyed.
+*/
+class PooledThread
+{
+public:
+   static PooledThread* acquire()
+   {
+      PooledThread* pThread = NULL;
+      {
+         MutexLock lock(getPoolMutex());
+         std::vector<PooledThread*>& idleThreads = getIdleThreads();
+         if (idleThreads.empty() == false)
+         {
+            pThread = idleThreads.back();
+            idleThreads.pop_back();
+         }
+      }
+
+      if (pThread == NULL)
+      {
+         pThread = new PooledThread();
+      }
+
+      return pThread;
+   }
+
+   void execute(AlgorithmThread* pJob)
+   {
+      MutexLock lock(mMutex);
+      mpJob = pJob;
+      mJobReady.ThreadSignalActivate();
+   }
+
+   void wait()
+   {
+      {
+         MutexLock lock(mMutex);
+         while (mpJob != NULL)
+         {
+            mJobDone.ThreadSignalWait(&mMutex);
+         }
+      }
+
+      MutexLock lock(getPoolMutex());
+      getIdleThreads().push_back(this);
+   }
+
+private:
+   PooledThread() :
+      mThreadHandle(static_cast<void*>(this), reinterpret_cast<void*>(PooledThread::threadFunction)),
+      mpJob(NULL)
+   {
+      mThreadHandle.ThreadLaunch();
+      mThreadHandle.ThreadDetach();
+   }
+
+   static void threadFunction(PooledThread* pThread)
+   {
+      pThread->mMutex.MutexLock();
+      for (;;)
+      {
+         while (pThread->mpJob == NULL)
+         {
+            pThread->mJobReady.ThreadSignalWait(&pThread->mMutex);
+         }
+
+         AlgorithmThread* pJob = pThread->mpJob;
+         pThread->mMutex.MutexUnlock();
+         AlgorithmThread::threadFunction(pJob);
+         pThread->mMutex.MutexLock();
+
+         pThread->mpJob = NULL;
+         pThread->mJobDone.ThreadSignalActivate();
+      }
+   }
+
+   static DMutex& getPoolMutex()
+   {
+      static DMutex* spMutex = new DMutex();
+      return *spMutex;
+   }
+
+   static std::vector<PooledThread*>& getIdleThreads()
+   {
+      static std::vector<PooledThread*>* spIdleThreads = new std::vector<PooledThread*>();
+      return *spIdleThreads;
+   }
+
+   DMutex mMutex;
+   DThreadSignal mJobReady;
+   DThreadSignal mJobDone;
+   BThread mThreadHandle;
+   AlgorithmThread* mpJob;
+};
+}
+
+//------------ ChunkScheduler ---------------//
+
+ChunkScheduler::ChunkScheduler(int threadCount, ThreadReporter& reporter) :
+   mReporter(reporter),
+   mThreadCount(std::max(threadCount, 1)),
+   mDataSize(-1),
+   mNextItem(0),
+   mStopped(false),
+   mCompletedItems(mThreadCount, 0),
+   mCurrentItems(mThreadCount, 0)
+{}
+
+bool ChunkScheduler::getNextRange(int threadIndex, int dataSize, AlgorithmThread::Range& range)
+{
+   if (threadIndex < 0 || threadIndex >= mThreadCount)
+   {
+      return false;
+   }
+
+   bool stopped = getErrorText().empty() == false;
+
+   MutexLock lock(mMutex);
+   if (mCurrentItems[threadIndex] > 0)
+   {
+      mCompletedItems[threadIndex] += mCurrentItems[threadIndex];
+   }
+   mCurrentItems[threadIndex] = -1;
+
+   if (mDataSize < 0)
+   {
+      mDataSize = std::max(dataSize, 0);
+   }
+
+   mStopped = mStopped || stopped;
+   int remaining = mDataSize - mNextItem;
+   if (mStopped || remaining <= 0)
+   {
+      return false;
+   }
+
+   // Guided self-scheduling: claim a fraction of what is left, but never so little
+   // that the per-block overhead of the thread (e.g. creating a DataAccessor) dominates
+   int minimumSize = std::max(mDataSize / (mThreadCount * 32), 1);
+   int blockSize = std::min(std::max(remaining / (mThreadCount * 4), minimumSize), remaining);
+
+   range.mFirst = mNextItem;
+   range.mLast = mNextItem + blockSize - 1;
+   mNextItem += blockSize;
+   mCurrentItems[threadIndex] = blockSize;
+   return true;
+}
+
+void ChunkScheduler::finishThread(int threadIndex)
+{
+   if (threadIndex >= 0 && threadIndex < mThreadCount)
+   {
+      MutexLock lock(mMutex);
+      mCurrentItems[threadIndex] = -1;
+   }
+}
+
+Result ChunkScheduler::reportProgress(int threadIndex, int percentDone)
+{
+   if (threadIndex < 0 || threadIndex >= mThreadCount)
+   {
+      return FAILURE;
+   }
+
+   int progress = percentDone;
+   {
+      MutexLock lock(mMutex);
+      if (mCurrentItems[threadIndex] >= 0 && mDataSize > 0)
+      {
+         // The thread's share of the overall progress, which may never reach 100 before the
+         // thread is finished since the algorithm completes when every thread is at 100
+         double items = mCompletedItems[threadIndex] + (mCurrentItems[threadIndex] * percentDone) / 100.0;
+         progress = std::min(static_cast<int>(100.0 * items * mThreadCount / mDataSize), 99);
+      }
+   }
+
+   Result result = mReporter.reportProgress(threadIndex, progress);
+   if (result != SUCCESS)
+   {
+      MutexLock lock(mMutex);
+      mStopped = true;
+   }
+   return result;
+}
+
+Result ChunkScheduler::reportCompletion(int threadIndex)
+{
+   finishThread(threadIndex);
+   return mReporter.reportCompletion(threadIndex);
+}
+
+Result ChunkScheduler::reportError(std::string errorText)
+{
+   {
+      MutexLock lock(mMutex);
+      mStopped = true;
+   }
+   return mReporter.reportError(errorText);
+}
+
+std::string ChunkScheduler::getErrorText() const
+{
+   return mReporter.getErrorText();
+}
+
+int ChunkScheduler::getProgress(int threadIndex) const
+{
+   return mReporter.getProgress(threadIndex);
+}
+
+void ChunkScheduler::runInMainThread(ThreadCommand& command)
+{
+   mReporter.runInMainThread(command);
+}
+
 //------------ AlgorithmThread ---------------//
 
 void AlgorithmThread::threadFunction(AlgorithmThread *pThreadData)
 {
    pThreadData->waitForAlgorithmLoop();
    pThreadData->run();
+   if (pThreadData->mpScheduler != NULL)
+   {
+      pThreadData->mpScheduler->finishThread(pThreadData->getThreadIndex());
+   }
    if (pThreadData->getReporter().getErrorText() == "")
    {
       if (pThreadData->getReporter().getProgress(pThreadData->getThreadIndex()) != 100)
@@ -270,13 +500,29 @@ void AlgorithmThread::threadFunction(AlgorithmThread *pThreadData)
 
 bool AlgorithmThread::launch()
 {
-   mThreadHandle.ThreadLaunch();
+   if (mpScheduler != NULL)
+   {
+      mpPooledThread = PooledThread::acquire();
+      mpPooledThread->execute(this);
+   }
+   else
+   {
+      mThreadHandle.ThreadLaunch();
+   }
    return true;
 }
 
 bool AlgorithmThread::wait()
 {
-   mThreadHandle.ThreadWait();
+   if (mpPooledThread != NULL)
+   {
+      mpPooledThread->wait();
+      mpPooledThread = NULL;
+   }
+   else
+   {
+      mThreadHandle.ThreadWait();
+   }
    return true;
 }
 
@@ -309,6 +555,23 @@ AlgorithmThread::Range AlgorithmThread::getThreadRange(int threadCount, int data
    return range;
 }
 
+bool AlgorithmThread::getNextRange(int threadCount, int dataSize, Range& range)
+{
+   if (mpScheduler != NULL)
+   {
+      return mpScheduler->getNextRange(mThreadIndex, dataSize, range);
+   }
+
+   if (mStaticRangeIssued)
+   {
+      return false;
+   }
+
+   mStaticRangeIssued = true;
+   range = getThreadRange(threadCount, dataSize);
+   return range.mLast >= range.mFirst;
+}
+
 int AlgorithmThread::getThreadIndex() const
 {
    return mThreadIndex;
@@ -324,6 +587,11 @@ void AlgorithmThread::runInMainThread(ThreadCommand &command)
    getReporter().runInMainThread(command);
 }
 
+void AlgorithmThread::setScheduler(ChunkScheduler* pScheduler)
+{
+   mpScheduler = pScheduler;
+}
+
 void AlgorithmThread::setAlgorithmMutex(DMutex *pMutex)
 {
    mpAlgorithmMutex = pMutex;
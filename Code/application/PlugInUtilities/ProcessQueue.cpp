@@ -0,0 +1,207 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "ProcessQueue.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QProcess>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+   // The time in milliseconds to wait for each running process before checking the others
+   const int WAIT_INTERVAL = 50;
+
+   // Only the end of the output of each process is kept
+   const size_t MAX_OUTPUT = 64 * 1024;
+}
+
+ProcessQueue::ProcessQueue(unsigned int maxRunning, uint64_t memoryBudget) :
+   mMaxRunning(max(maxRunning, 1U)),
+   mMemoryBudget(memoryBudget)
+{
+}
+
+ProcessQueue::~ProcessQueue()
+{
+   stopRuns();
+}
+
+void ProcessQueue::addRun(const string& program, const vector<string>& arguments, uint64_t estimatedSize)
+{
+   Run run;
+   run.mProgram = program;
+   run.mArguments = arguments;
+   run.mEstimatedSize = estimatedSize;
+   run.mFinished = false;
+   run.mSuccess = false;
+   run.mExitCode = -1;
+   mRuns.push_back(run);
+}
+
+size_t ProcessQueue::getRunCount() const
+{
+   return mRuns.size();
+}
+
+const ProcessQueue::Run& ProcessQueue::getRun(size_t index) const
+{
+   return mRuns.at(index);
+}
+
+bool ProcessQueue::execute()
+{
+   stopRuns();
+   mProcesses.resize(mRuns.size(), NULL);
+
+   bool failed = false;
+   unsigned int numRunning = 0;
+   uint64_t memoryInUse = 0;
+   size_t nextRun = 0;
+   size_t nextReport = 0;
+   while (nextReport < mRuns.size())
+   {
+      if (isAborted())
+      {
+         stopRuns();
+         return false;
+      }
+
+      // Start as many processes as the limits allow, stopping after the first failure
+      while (failed == false && nextRun < mRuns.size() && numRunning < mMaxRunning &&
+         (numRunning == 0 || memoryInUse + mRuns[nextRun].mEstimatedSize <= mMemoryBudget))
+      {
+         size_t index = nextRun++;
+         if (startRun(index) == false)
+         {
+            failed = true;
+            break;
+         }
+
+         memoryInUse += mRuns[index].mEstimatedSize;
+         ++numRunning;
+      }
+
+      for (size_t i = nextReport; i < nextRun; ++i)
+      {
+         if (mRuns[i].mFinished == false && updateRun(i) == true)
+         {
+            if (mRuns[i].mSuccess == false)
+            {
+               failed = true;
+            }
+
+            memoryInUse -= mRuns[i].mEstimatedSize;
+            --numRunning;
+         }
+      }
+
+      // Report the results in the same order as the processes were added
+      while (nextReport < nextRun && mRuns[nextReport].mFinished == true)
+      {
+         runFinished(nextReport, mRuns[nextReport]);
+         ++nextReport;
+      }
+
+      if (failed == true && numRunning == 0)
+      {
+         break;
+      }
+   }
+
+   stopRuns();
+   return !failed;
+}
+
+void ProcessQueue::runFinished(size_t index, const Run& run)
+{
+}
+
+bool ProcessQueue::isAborted()
+{
+   return false;
+}
+
+bool ProcessQueue::startRun(size_t index)
+{
+   Run& run = mRuns[index];
+
+   QStringList arguments;
+   for (vector<string>::const_iterator iter = run.mArguments.begin(); iter != run.mArguments.end(); ++iter)
+   {
+      arguments << QString::fromStdString(*iter);
+   }
+
+   QProcess* pProcess = new QProcess();
+   mProcesses[index] = pProcess;
+   pProcess->setProcessChannelMode(QProcess::MergedChannels);
+   pProcess->start(QString::fromStdString(run.mProgram), arguments);
+   if (pProcess->waitForStarted() == false)
+   {
+      run.mFinished = true;
+      run.mMessage = "The process could not be started.";
+      return false;
+   }
+
+   return true;
+}
+
+bool ProcessQueue::updateRun(size_t index)
+{
+   Run& run = mRuns[index];
+   QProcess* pProcess = mProcesses[index];
+   VERIFY(pProcess != NULL);
+
+   bool done = pProcess->waitForFinished(WAIT_INTERVAL) || pProcess->state() == QProcess::NotRunning;
+
+   QByteArray output = pProcess->readAll();
+   run.mOutput.append(output.constData(), output.size());
+   if (run.mOutput.size() > MAX_OUTPUT)
+   {
+      run.mOutput.erase(0, run.mOutput.size() - MAX_OUTPUT);
+   }
+
+   if (done == true)
+   {
+      run.mFinished = true;
+      run.mExitCode = pProcess->exitCode();
+      run.mSuccess = (pProcess->exitStatus() == QProcess::NormalExit && run.mExitCode == 0);
+      if (run.mSuccess == false)
+      {
+         run.mMessage = "The process did not complete successfully.";
+      }
+   }
+
+   return done;
+}
+
+void ProcessQueue::stopRuns()
+{
+   for (vector<QProcess*>::iterator iter = mProcesses.begin(); iter != mProcesses.end(); ++iter)
+   {
+      QProcess* pProcess = *iter;
+      if (pProcess != NULL)
+      {
+         if (pProcess->state() != QProcess::NotRunning)
+         {
+            pProcess->kill();
+            pProcess->waitForFinished();
+         }
+
+         delete pProcess;
+         *iter = NULL;
+      }
+   }
+}
@@ -17,6 +17,7 @@
 #include "DynamicObject.h"
 #include "Endian.h"
 #include "Int64.h"
+#include "MultiThreadedAlgorithm.h"
 #include "ObjectResource.h"
 #include "Progress.h"
 #include "RasterDataDescriptor.h"
@@ -33,6 +34,8 @@
 
 #include <algorithm>
 #include <boost/bind.hpp>
+#include <limits>
+#include <math.h>
 #include <set>
 #include <sstream>
 
@@ -92,6 +95,385 @@ namespace
    {
       memset(pPixel, defaultValue, sizeof(FloatComplex) * numValues);
    }
+
+   // Destination rows are warped in strips of this many rows, and each strip is split into tiles of
+   // this many columns.  The source footprint of a tile is read once as a block.
+   const unsigned int ROTATE_STRIP_ROWS = 32;
+   const unsigned int ROTATE_TILE_COLUMNS = 128;
+
+   struct RotateInput
+   {
+      const RasterElement* mpSrc;
+      RasterElement* mpDst;
+      const RasterDataDescriptor* mpSrcDesc;
+      const RasterDataDescriptor* mpDstDesc;
+      InterpolationType mInterp;
+      EncodingType mEncoding;
+      int mDefaultValue;
+      unsigned int mRowCount;
+      unsigned int mColumnCount;
+      unsigned int mStripCount;
+      bool mIsBip;
+      unsigned int mPixelValues;    // values in each pixel of a single pass, which is all bands for BIP
+      unsigned int mPixelBytes;
+      int mX0;
+      int mY0;
+      double mCos;
+      double mSin;
+      std::vector<Opticks::PixelLocation> mRowStart;   // nearest neighbor only
+      std::vector<Opticks::PixelLocation> mRowEnd;     // nearest neighbor only
+      bool* mpAbort;
+   };
+
+   // The source pixels read for a tile.  Rows and columns are relative to the source data.
+   struct RotateBlock
+   {
+      const char* mpData;
+      int mFirstRow;
+      int mLastRow;
+      int mFirstColumn;
+      int mLastColumn;
+      unsigned int mPixelValues;
+   };
+
+   template<typename T>
+   T toRotatedValue(double value)
+   {
+      if (std::numeric_limits<T>::is_integer)
+      {
+         value = floor(value + 0.5);
+         value = std::max(value, static_cast<double>(std::numeric_limits<T>::min()));
+         value = std::min(value, static_cast<double>(std::numeric_limits<T>::max()));
+      }
+
+      return static_cast<T>(value);
+   }
+
+   // Computes Catmull-Rom weights for the samples at offsets -1, 0, 1 and 2 from the sample before t.
+   void getCubicWeights(double t, double* pWeights)
+   {
+      pWeights[0] = ((-0.5 * t + 1.0) * t - 0.5) * t;
+      pWeights[1] = (1.5 * t - 2.5) * t * t + 1.0;
+      pWeights[2] = ((-1.5 * t + 2.0) * t + 0.5) * t;
+      pWeights[3] = (0.5 * t - 0.5) * t * t;
+   }
+
+   // Interpolates the valid pixels of a destination row segment from a source block.
+   // Sample positions outside the block are clamped to its edges, which are the edges of the source data.
+   template<typename T>
+   void interpolateRow(const T* pBlock, const RotateBlock& block, const double* pX, const double* pY,
+      const unsigned char* pValid, unsigned int count, InterpolationType interp, void* pDstRow)
+   {
+      T* pDst = reinterpret_cast<T*>(pDstRow);
+      const unsigned int values = block.mPixelValues;
+      const int blockColumns = block.mLastColumn - block.mFirstColumn + 1;
+      for (unsigned int i = 0; i < count; ++i, pDst += values)
+      {
+         if (pValid[i] == 0)
+         {
+            continue;
+         }
+
+         const int baseX = static_cast<int>(floor(pX[i]));
+         const int baseY = static_cast<int>(floor(pY[i]));
+         const double tx = pX[i] - baseX;
+         const double ty = pY[i] - baseY;
+         const int taps = (interp == INTERP_BICUBIC) ? 4 : 2;
+         const int firstTap = (interp == INTERP_BICUBIC) ? -1 : 0;
+         double weightsX[4];
+         double weightsY[4];
+         if (interp == INTERP_BICUBIC)
+         {
+            getCubicWeights(tx, weightsX);
+            getCubicWeights(ty, weightsY);
+         }
+         else
+         {
+            weightsX[0] = 1.0 - tx;
+            weightsX[1] = tx;
+            weightsY[0] = 1.0 - ty;
+            weightsY[1] = ty;
+         }
+
+         int offsets[4];
+         for (int tap = 0; tap < taps; ++tap)
+         {
+            int column = std::min(std::max(baseX + firstTap + tap, block.mFirstColumn), block.mLastColumn);
+            offsets[tap] = (column - block.mFirstColumn) * values;
+         }
+
+         for (unsigned int value = 0; value < values; ++value)
+         {
+            double sum = 0.0;
+            for (int tapY = 0; tapY < taps; ++tapY)
+            {
+               int row = std::min(std::max(baseY + firstTap + tapY, block.mFirstRow), block.mLastRow);
+               const T* pRow = pBlock + static_cast<size_t>(row - block.mFirstRow) * blockColumns * values + value;
+               double rowSum = 0.0;
+               for (int tapX = 0; tapX < taps; ++tapX)
+               {
+                  rowSum += weightsX[tapX] * pRow[offsets[tapX]];
+               }
+
+               sum += weightsY[tapY] * rowSum;
+            }
+
+            pDst[value] = toRotatedValue<T>(sum);
+         }
+      }
+   }
+
+   /**
+    * Warps strips of destination rows.  Each work item is one strip of one pass, where a pass
+    * is a single band for BSQ and BIL data and all bands for BIP data.
+    */
+   class RotateThread : public mta::AlgorithmThread
+   {
+   public:
+      RotateThread(const RotateInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mThreadCount(threadCount)
+      {}
+
+      void run()
+      {
+         const unsigned int passCount = mInput.mIsBip ? 1 : mInput.mpSrcDesc->getBandCount();
+         const int itemCount = static_cast<int>(passCount * mInput.mStripCount);
+         mta::AlgorithmThread::Range range;
+         while (getNextRange(mThreadCount, itemCount, range))
+         {
+            int oldPercentDone = -1;
+            for (int item = range.mFirst; item <= range.mLast; ++item)
+            {
+               if (mInput.mpAbort != NULL && *mInput.mpAbort)
+               {
+                  return;
+               }
+
+               if (processStrip(item / mInput.mStripCount, item % mInput.mStripCount) == false)
+               {
+                  return;
+               }
+
+               int percentDone = range.computePercent(item);
+               if (percentDone > oldPercentDone)
+               {
+                  oldPercentDone = percentDone;
+                  getReporter().reportProgress(getThreadIndex(), percentDone);
+               }
+            }
+         }
+      }
+
+   private:
+      RotateThread& operator=(const RotateThread& rhs);
+
+      FactoryResource<DataRequest> createRequest(const RasterDataDescriptor* pDescriptor, unsigned int pass,
+         int firstRow, int lastRow, int firstColumn, int lastColumn) const
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setRows(pDescriptor->getActiveRow(firstRow), pDescriptor->getActiveRow(lastRow),
+            lastRow - firstRow + 1);
+         pRequest->setColumns(pDescriptor->getActiveColumn(firstColumn), pDescriptor->getActiveColumn(lastColumn),
+            lastColumn - firstColumn + 1);
+         if (mInput.mIsBip == false)
+         {
+            pRequest->setBands(pDescriptor->getActiveBand(pass), pDescriptor->getActiveBand(pass), 1);
+         }
+
+         return pRequest;
+      }
+
+      // Computes the source position of every pixel in the strip.  Nearest neighbor uses the Bresenham
+      // lines between the rotated row end points so the output does not change.  The interpolated methods
+      // step along the exact inverse rotation, which adds the cosine and sine of the angle for each column.
+      void computeSourcePositions(unsigned int firstRow, unsigned int rowCount)
+      {
+         const unsigned int numCols = mInput.mColumnCount;
+         mSourceX.resize(rowCount * numCols);
+         mSourceY.resize(rowCount * numCols);
+         for (unsigned int i = 0; i < rowCount; ++i)
+         {
+            const unsigned int row = firstRow + i;
+            double* pX = &mSourceX[i * numCols];
+            double* pY = &mSourceY[i * numCols];
+            if (mInput.mInterp == INTERP_NEAREST_NEIGHBOR)
+            {
+               calculateNewPoints(mInput.mRowStart[row], mInput.mRowEnd[row], mLinePoints);
+               double mult = mLinePoints.size() / static_cast<double>(numCols);
+               for (unsigned int col = 0; col < numCols; ++col)
+               {
+                  const Opticks::PixelLocation& point = mLinePoints[static_cast<int>(mult * col + 0.5)];
+                  pX[col] = point.mX - mInput.mX0;
+                  pY[col] = point.mY - mInput.mY0;
+               }
+            }
+            else
+            {
+               double x = mInput.mCos * mInput.mX0 - mInput.mSin * (static_cast<double>(row) + mInput.mY0) -
+                  mInput.mX0;
+               double y = mInput.mSin * mInput.mX0 + mInput.mCos * (static_cast<double>(row) + mInput.mY0) -
+                  mInput.mY0;
+               for (unsigned int col = 0; col < numCols; ++col)
+               {
+                  pX[col] = x;
+                  pY[col] = y;
+                  x += mInput.mCos;
+                  y += mInput.mSin;
+               }
+            }
+         }
+      }
+
+      bool processStrip(unsigned int pass, unsigned int strip)
+      {
+         const unsigned int firstRow = strip * ROTATE_STRIP_ROWS;
+         const unsigned int rowCount = std::min(ROTATE_STRIP_ROWS, mInput.mRowCount - firstRow);
+         const unsigned int numCols = mInput.mColumnCount;
+         const int numRows = static_cast<int>(mInput.mRowCount);
+         computeSourcePositions(firstRow, rowCount);
+
+         // the source samples used by each pixel are [base + firstTap, base + lastTap] in each direction
+         const InterpolationType interp = mInput.mInterp;
+         const int firstTap = (interp == INTERP_BICUBIC) ? -1 : 0;
+         const int lastTap = (interp == INTERP_BICUBIC) ? 2 : (interp == INTERP_BILINEAR ? 1 : 0);
+         mValid.resize(rowCount * numCols);
+         FactoryResource<DataRequest> pDstRequest = createRequest(mInput.mpDstDesc, pass,
+            firstRow, firstRow + rowCount - 1, 0, numCols - 1);
+         pDstRequest->setWritable(true);
+         DataAccessor dstAcc = mInput.mpDst->getDataAccessor(pDstRequest.release());
+         for (unsigned int firstCol = 0; firstCol < numCols; firstCol += ROTATE_TILE_COLUMNS)
+         {
+            const unsigned int tileCols = std::min(ROTATE_TILE_COLUMNS, numCols - firstCol);
+
+            // find the source footprint of the tile
+            RotateBlock block;
+            block.mpData = NULL;
+            block.mFirstColumn = static_cast<int>(numCols);
+            block.mLastColumn = -1;
+            block.mFirstRow = numRows;
+            block.mLastRow = -1;
+            block.mPixelValues = mInput.mPixelValues;
+            for (unsigned int i = 0; i < rowCount; ++i)
+            {
+               const size_t offset = i * numCols + firstCol;
+               for (unsigned int col = 0; col < tileCols; ++col)
+               {
+                  const double x = mSourceX[offset + col];
+                  const double y = mSourceY[offset + col];
+                  const int nearestX = static_cast<int>(floor(x + 0.5));
+                  const int nearestY = static_cast<int>(floor(y + 0.5));
+                  const bool valid = nearestX >= 0 && nearestX < static_cast<int>(numCols) &&
+                     nearestY >= 0 && nearestY < numRows;
+                  mValid[offset + col] = valid ? 1 : 0;
+                  if (valid)
+                  {
+                     const int baseX = (interp == INTERP_NEAREST_NEIGHBOR) ? nearestX : static_cast<int>(floor(x));
+                     const int baseY = (interp == INTERP_NEAREST_NEIGHBOR) ? nearestY : static_cast<int>(floor(y));
+                     block.mFirstColumn = std::min(block.mFirstColumn, baseX + firstTap);
+                     block.mLastColumn = std::max(block.mLastColumn, baseX + lastTap);
+                     block.mFirstRow = std::min(block.mFirstRow, baseY + firstTap);
+                     block.mLastRow = std::max(block.mLastRow, baseY + lastTap);
+                  }
+               }
+            }
+
+            block.mFirstColumn = std::max(block.mFirstColumn, 0);
+            block.mLastColumn = std::min(block.mLastColumn, static_cast<int>(numCols) - 1);
+            block.mFirstRow = std::max(block.mFirstRow, 0);
+            block.mLastRow = std::min(block.mLastRow, numRows - 1);
+            const bool hasSource = block.mFirstColumn <= block.mLastColumn && block.mFirstRow <= block.mLastRow;
+            if (hasSource && readBlock(pass, block) == false)
+            {
+               getReporter().reportError("Error reading source cube.");
+               return false;
+            }
+
+            const size_t blockRowBytes =
+               static_cast<size_t>(block.mLastColumn - block.mFirstColumn + 1) * mInput.mPixelBytes;
+            for (unsigned int i = 0; i < rowCount; ++i)
+            {
+               dstAcc->toPixel(firstRow + i, firstCol);
+               if (dstAcc.isValid() == false)
+               {
+                  getReporter().reportError("Error copying data.");
+                  return false;
+               }
+
+               // initialize the row segment...this is faster than setting the default value at each invalid pixel
+               char* pDstRow = reinterpret_cast<char*>(dstAcc->getColumn());
+               switchOnComplexEncoding(mInput.mEncoding, setPixel, pDstRow, mInput.mDefaultValue,
+                  mInput.mPixelValues * tileCols);
+               if (hasSource == false)
+               {
+                  continue;
+               }
+
+               const size_t offset = i * numCols + firstCol;
+               if (interp == INTERP_NEAREST_NEIGHBOR)
+               {
+                  for (unsigned int col = 0; col < tileCols; ++col)
+                  {
+                     if (mValid[offset + col] != 0)
+                     {
+                        const int x = static_cast<int>(mSourceX[offset + col]) - block.mFirstColumn;
+                        const int y = static_cast<int>(mSourceY[offset + col]) - block.mFirstRow;
+                        memcpy(pDstRow + col * mInput.mPixelBytes, block.mpData + y * blockRowBytes +
+                           x * mInput.mPixelBytes, mInput.mPixelBytes);
+                     }
+                  }
+               }
+               else
+               {
+                  switchOnEncoding(mInput.mEncoding, interpolateRow, block.mpData, block, &mSourceX[offset],
+                     &mSourceY[offset], &mValid[offset], tileCols, interp, pDstRow);
+               }
+            }
+         }
+
+         return true;
+      }
+
+      // Reads the source pixels of a block into contiguous memory with a single request
+      bool readBlock(unsigned int pass, RotateBlock& block)
+      {
+         FactoryResource<DataRequest> pRequest = createRequest(mInput.mpSrcDesc, pass,
+            block.mFirstRow, block.mLastRow, block.mFirstColumn, block.mLastColumn);
+         DataAccessor srcAcc = mInput.mpSrc->getDataAccessor(pRequest.release());
+         const size_t rowBytes = static_cast<size_t>(block.mLastColumn - block.mFirstColumn + 1) * mInput.mPixelBytes;
+         mBlock.resize(rowBytes * (block.mLastRow - block.mFirstRow + 1));
+         for (int row = block.mFirstRow; row <= block.mLastRow; ++row)
+         {
+            if (srcAcc.isValid() == false)
+            {
+               return false;
+            }
+
+            memcpy(&mBlock[(row - block.mFirstRow) * rowBytes], srcAcc->getRow(), rowBytes);
+            srcAcc->nextRow();
+         }
+
+         block.mpData = &mBlock[0];
+         return true;
+      }
+
+      const RotateInput& mInput;
+      int mThreadCount;
+      std::vector<Opticks::PixelLocation> mLinePoints;
+      std::vector<double> mSourceX;
+      std::vector<double> mSourceY;
+      std::vector<unsigned char> mValid;
+      std::vector<char> mBlock;
+   };
+
+   struct RotateOutput
+   {
+      bool compileOverallResults(const std::vector<RotateThread*>& threads)
+      {
+         return true;
+      }
+   };
 }
 
 std::vector<DimensionDescriptor> RasterUtilities::generateDimensionVector(unsigned int count,
@@ -681,6 +1063,17 @@ RasterElement* RasterUtilities::createRasterElement(const std::string& name, uns
    return pRasterElement.release();
 }
 
+ProcessingLocation RasterUtilities::getResultProcessingLocation(ProcessingLocation sourceLocation)
+{
+   if ((sourceLocation == IN_MEMORY) || (sourceLocation == IN_MEMORY_COMPRESSED) ||
+      (sourceLocation == IN_MEMORY_SPILLABLE))
+   {
+      return sourceLocation;
+   }
+
+   return ON_DISK;
+}
+
 RasterElement* RasterUtilities::createRasterElement(const std::string& name, unsigned int rows, unsigned int columns,
    EncodingType encoding, bool inMemory, DataElement* pParent)
 {
@@ -1425,178 +1818,126 @@ bool RasterUtilities::rotate(RasterElement* pDst, const RasterElement* pSrc, dou
       return false;
    }
 
+   if (interp != INTERP_NEAREST_NEIGHBOR && interp != INTERP_BILINEAR && interp != INTERP_BICUBIC)
+   {
+      if (pProgress != NULL)
+      {
+         pProgress->updateProgress("Invalid or unsupported interpolation method.", 0, ERRORS);
+      }
+      return false;
+   }
+
+   EncodingType encoding = pDstDesc->getDataType();
+   if (interp != INTERP_NEAREST_NEIGHBOR && (encoding == INT4SCOMPLEX || encoding == FLT8COMPLEX))
+   {
+      if (pProgress != NULL)
+      {
+         pProgress->updateProgress("Complex data can only be rotated with nearest neighbor interpolation.", 0, ERRORS);
+      }
+      return false;
+   }
+
    // calculate the rotation of the four corners
    int x1 = numCols / 2;
    int y1 = numRows / 2;
    int x0 = -(static_cast<int>(numCols) - x1 - 1);
    int y0 = -(static_cast<int>(numRows) - y1 - 1);
-   Opticks::PixelLocation ul(x0, y0);
-   Opticks::PixelLocation ur(x1, y0);
-   Opticks::PixelLocation ll(x0, y1);
-   Opticks::PixelLocation lr(x1, y1);
    double cosA = cos(angle);
    double sinA = sin(angle);
-   Opticks::PixelLocation ulPrime(static_cast<int>(ul.mX * cosA - ul.mY * sinA + 0.5),
-      static_cast<int>(ul.mX * sinA + ul.mY * cosA + 0.5));
-   Opticks::PixelLocation urPrime(static_cast<int>(ur.mX * cosA - ur.mY * sinA + 0.5),
-      static_cast<int>(ur.mX * sinA + ur.mY * cosA + 0.5));
-   Opticks::PixelLocation llPrime(static_cast<int>(ll.mX * cosA - ll.mY * sinA + 0.5),
-      static_cast<int>(ll.mX * sinA + ll.mY * cosA + 0.5));
-   Opticks::PixelLocation lrPrime(static_cast<int>(lr.mX * cosA - lr.mY * sinA + 0.5),
-      static_cast<int>(lr.mX * sinA + lr.mY * cosA + 0.5));
-
-   // use Bresenham's to calculate the start and end coordinates of each row
-   std::vector<Opticks::PixelLocation> newRowStartPre;
-   calculateNewPoints(ulPrime, llPrime, newRowStartPre);
-   std::vector<Opticks::PixelLocation> newRowEndPre;
-   calculateNewPoints(urPrime, lrPrime, newRowEndPre);
-
-   // interpolate so we have the proper number of points
-   std::vector<Opticks::PixelLocation> newRowStart;
-   std::vector<Opticks::PixelLocation> newRowEnd;
-   newRowStart.reserve(numRows);
-   newRowEnd.reserve(numRows);
-   double startMult = newRowStartPre.size() / static_cast<double>(numRows);
-   double endMult = newRowEndPre.size() / static_cast<double>(numRows);
-   for (unsigned int row = 0; row < numRows; ++row)
-   {
-      if (pProgress != NULL)
+
+   RotateInput input;
+   input.mpSrc = pSrc;
+   input.mpDst = pDst;
+   input.mpSrcDesc = pSrcDesc;
+   input.mpDstDesc = pDstDesc;
+   input.mInterp = interp;
+   input.mEncoding = encoding;
+   input.mDefaultValue = defaultValue;
+   input.mRowCount = numRows;
+   input.mColumnCount = numCols;
+   input.mStripCount = (numRows + ROTATE_STRIP_ROWS - 1) / ROTATE_STRIP_ROWS;
+   input.mIsBip = isBip;
+   input.mPixelValues = isBip ? numBands : 1;
+   input.mPixelBytes = pDstDesc->getBytesPerElement() * input.mPixelValues;
+   input.mX0 = x0;
+   input.mY0 = y0;
+   input.mCos = cosA;
+   input.mSin = sinA;
+   input.mpAbort = pAbort;
+
+   if (interp == INTERP_NEAREST_NEIGHBOR)
+   {
+      Opticks::PixelLocation ul(x0, y0);
+      Opticks::PixelLocation ur(x1, y0);
+      Opticks::PixelLocation ll(x0, y1);
+      Opticks::PixelLocation lr(x1, y1);
+      Opticks::PixelLocation ulPrime(static_cast<int>(ul.mX * cosA - ul.mY * sinA + 0.5),
+         static_cast<int>(ul.mX * sinA + ul.mY * cosA + 0.5));
+      Opticks::PixelLocation urPrime(static_cast<int>(ur.mX * cosA - ur.mY * sinA + 0.5),
+         static_cast<int>(ur.mX * sinA + ur.mY * cosA + 0.5));
+      Opticks::PixelLocation llPrime(static_cast<int>(ll.mX * cosA - ll.mY * sinA + 0.5),
+         static_cast<int>(ll.mX * sinA + ll.mY * cosA + 0.5));
+      Opticks::PixelLocation lrPrime(static_cast<int>(lr.mX * cosA - lr.mY * sinA + 0.5),
+         static_cast<int>(lr.mX * sinA + lr.mY * cosA + 0.5));
+
+      // use Bresenham's to calculate the start and end coordinates of each row
+      std::vector<Opticks::PixelLocation> newRowStartPre;
+      calculateNewPoints(ulPrime, llPrime, newRowStartPre);
+      std::vector<Opticks::PixelLocation> newRowEndPre;
+      calculateNewPoints(urPrime, lrPrime, newRowEndPre);
+
+      // interpolate so we have the proper number of points
+      input.mRowStart.reserve(numRows);
+      input.mRowEnd.reserve(numRows);
+      double startMult = newRowStartPre.size() / static_cast<double>(numRows);
+      double endMult = newRowEndPre.size() / static_cast<double>(numRows);
+      for (unsigned int row = 0; row < numRows; ++row)
       {
-         pProgress->updateProgress("Calculating row shifts.", row * 100 / numRows, NORMAL);
+         unsigned int preStartRow = static_cast<int>(startMult * row + 0.5);
+         unsigned int preEndRow = static_cast<int>(endMult * row + 0.5);
+         input.mRowStart.push_back(newRowStartPre[preStartRow]);
+         input.mRowEnd.push_back(newRowEndPre[preEndRow]);
       }
-      switch(interp)
+      if (input.mRowStart.size() != numRows || input.mRowEnd.size() != numRows)
       {
-      case INTERP_NEAREST_NEIGHBOR:
-         {
-            unsigned int preStartRow = static_cast<int>(startMult * row + 0.5);
-            unsigned int preEndRow = static_cast<int>(endMult * row + 0.5);
-            newRowStart.push_back(newRowStartPre[preStartRow]);
-            newRowEnd.push_back(newRowEndPre[preEndRow]);
-            break;
-         }
-      case INTERP_BILINEAR:
-      case INTERP_BICUBIC:
-      case INTERP_AREA:
-      case INTERP_LANCZOS4:
-      default:
          if (pProgress != NULL)
          {
-            pProgress->updateProgress("Invalid or unsupported interpolation method.", 0, ERRORS);
+            pProgress->updateProgress("Error calculating new row positions.", 0, ERRORS);
          }
          return false;
       }
    }
-   if (newRowStart.size() != numRows || newRowEnd.size() != numRows)
+
+   // warp strips of rows in parallel
+   unsigned int itemCount = input.mStripCount * (isBip ? 1 : numBands);
+   if (itemCount == 0 || numCols == 0)
+   {
+      return true;
+   }
+
+   mta::ProgressObjectReporter reporter("Warping rows", pProgress);
+   RotateOutput output;
+   mta::MultiThreadedAlgorithm<RotateInput, RotateOutput, RotateThread>
+      alg(mta::getNumRequiredThreads(itemCount), input, output, &reporter, mta::DYNAMIC_SCHEDULING);
+   mta::Result result = alg.run();
+   if (pAbort != NULL && *pAbort)
    {
       if (pProgress != NULL)
       {
-         pProgress->updateProgress("Error calculating new row positions.", 0, ERRORS);
+         pProgress->updateProgress("Aborted by user.", 0, ABORT);
       }
       return false;
    }
-
-   unsigned int outBandLoop = isBip ? 1 : numBands;
-   unsigned int inBandLoop = isBip ? numBands : 1;
-   for (unsigned int outBand = 0; outBand < outBandLoop; ++outBand)
+   if (result != mta::SUCCESS)
    {
-      FactoryResource<DataRequest> pSrcRequest;
-      FactoryResource<DataRequest> pDstRequest;
-      VERIFY(pSrcRequest.get() && pDstRequest.get());
-      pSrcRequest->setRows(DimensionDescriptor(), DimensionDescriptor(), 1);
-      pDstRequest->setRows(DimensionDescriptor(), DimensionDescriptor(), 1);
-      pSrcRequest->setColumns(DimensionDescriptor(), DimensionDescriptor(), numCols);
-      pDstRequest->setColumns(DimensionDescriptor(), DimensionDescriptor(), numCols);
-      if (!isBip)
+      if (pProgress != NULL)
       {
-         pSrcRequest->setBands(pSrcDesc->getActiveBand(outBand), pSrcDesc->getActiveBand(outBand), 1);
-         pDstRequest->setBands(pDstDesc->getActiveBand(outBand), pDstDesc->getActiveBand(outBand), 1);
-      }
-      pDstRequest->setWritable(true);
-
-      DataAccessor pSrcAcc = pSrc->getDataAccessor(pSrcRequest.release());
-      DataAccessor pDstAcc = pDst->getDataAccessor(pDstRequest.release());
-      for (unsigned int row = 0; row < numRows; ++row)
-      {
-         if (pProgress != NULL)
-         {
-            pProgress->updateProgress("Warping rows.", row * 100 / numRows, NORMAL);
-         }
-         if (pAbort != NULL && *pAbort)
-         {
-            if (pProgress != NULL)
-            {
-               pProgress->updateProgress("Aborted by user.", 0, ABORT);
-            }
-            return false;
-         }
-         if (!pDstAcc.isValid())
-         {
-            if (pProgress != NULL)
-            {
-               pProgress->updateProgress("Error copying data.", 0, ERRORS);
-            }
-            return false;
-         }
-         // initialize the row...this is faster than checking validity at each
-         // pixel and setting the default value at that pixel
-         switchOnComplexEncoding(pDstDesc->getDataType(), setPixel,
-            pDstAcc->getRow(), defaultValue, inBandLoop*numCols);
-
-         // use Bresenham's to calculate the column coordinates
-         std::vector<Opticks::PixelLocation> newColPre;
-         calculateNewPoints(newRowStart[row], newRowEnd[row], newColPre);
-         // interpolate so we have the proper number of points
-         double mult = newColPre.size() / static_cast<double>(numCols);
-         for (unsigned int col = 0; col < numCols; ++col)
-         {
-            if (!pDstAcc.isValid())
-            {
-               if (pProgress != NULL)
-               {
-                  pProgress->updateProgress("Error copying data.", 0, ERRORS);
-               }
-               return false;
-            }
-            Opticks::PixelLocation sourcePixel;
-            switch(interp)
-            {
-            case INTERP_NEAREST_NEIGHBOR:
-               {
-                  unsigned int preCol = static_cast<int>(mult * col + 0.5);
-                  sourcePixel = newColPre[preCol];
-                  break;
-               }
-            case INTERP_BILINEAR:
-            case INTERP_BICUBIC:
-            case INTERP_AREA:
-            case INTERP_LANCZOS4:
-            default:
-               if (pProgress != NULL)
-               {
-                  pProgress->updateProgress("Invalid or unsupported interpolation method.", 0, ERRORS);
-               }
-               return false;
-            }
-            sourcePixel -= Opticks::PixelLocation(x0, y0);
-            if (sourcePixel.mX >= 0 && sourcePixel.mX < static_cast<int>(numCols) &&
-                sourcePixel.mY >= 0 && sourcePixel.mY < static_cast<int>(numRows))
-            {
-               pSrcAcc->toPixel(sourcePixel.mY, sourcePixel.mX);
-               if (!pSrcAcc.isValid())
-               {
-                  if (pProgress != NULL)
-                  {
-                     pProgress->updateProgress("Error reading source cube.", 0, ERRORS);
-                  }
-                  return false;
-               }
-               memcpy(pDstAcc->getColumn(), pSrcAcc->getColumn(), pDstDesc->getBytesPerElement() * inBandLoop);
-            }
-            pDstAcc->nextColumn();
-         }
-         pDstAcc->nextRow();
+         std::string errorText = alg.getErrorText();
+         pProgress->updateProgress(errorText.empty() ? "Error copying data." : errorText, 0, ERRORS);
       }
+      return false;
    }
+
    pDst->updateData();
 
    return true;
@@ -0,0 +1,84 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AttachmentPtr.h"
+#include "ConfigurationSettings.h"
+#include "DMutex.h"
+#include "SettingCache.h"
+
+namespace
+{
+   class SettingsWatcher
+   {
+   public:
+      SettingsWatcher() :
+         mGeneration(1)
+      {
+         mpSettings.addSignal(SIGNAL_NAME(Subject, Modified), Slot(this, &SettingsWatcher::settingsModified));
+         mpSettings.reset(Service<ConfigurationSettings>().get());
+      }
+
+      virtual ~SettingsWatcher()
+      {
+      }
+
+      unsigned int getGeneration() const
+      {
+         if (mpSettings.get() == NULL)
+         {
+            return 0;
+         }
+
+         return mGeneration;
+      }
+
+      void settingsModified(Subject& subject, const std::string& signal, const boost::any& data)
+      {
+         // Skip 0 on wrap around since it means that values are not cached
+         if (++mGeneration == 0)
+         {
+            ++mGeneration;
+         }
+      }
+
+   private:
+      AttachmentPtr<ConfigurationSettings> mpSettings;
+
+      // Only written by the thread which notifies ConfigurationSettings.  Readers on other threads
+      // may briefly see the previous generation, which is no different from reading the setting
+      // just before it was modified.
+      volatile unsigned int mGeneration;
+   };
+}
+
+unsigned int SettingCacheBase::getGeneration()
+{
+   static SettingsWatcher sWatcher;
+   return sWatcher.getGeneration();
+}
+
+SettingCacheBase::SettingCacheBase() :
+   mpMutex(new mta::DMutex)
+{
+}
+
+SettingCacheBase::~SettingCacheBase()
+{
+   delete mpMutex;
+}
+
+void SettingCacheBase::lock() const
+{
+   mpMutex->MutexLock();
+}
+
+void SettingCacheBase::unlock() const
+{
+   mpMutex->MutexUnlock();
+}
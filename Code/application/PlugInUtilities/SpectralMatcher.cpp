@@ -0,0 +1,796 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "BadValues.h"
+#include "BitMaskIterator.h"
+#include "DataAccessor.h"
+#include "DataAccessorImpl.h"
+#include "DataRequest.h"
+#include "MatrixFunctions.h"
+#include "MultiThreadedAlgorithm.h"
+#include "ObjectResource.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "SpectralMatcher.h"
+#include "Statistics.h"
+#include "switchOnEncoding.h"
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <sstream>
+#include <eigen3/Eigen/Dense>
+
+using namespace std;
+
+namespace
+{
+   typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrix;
+   typedef Eigen::Map<RowMatrix> RowMatrixMap;
+   typedef Eigen::Map<const RowMatrix> ConstRowMatrixMap;
+
+   // Pixels are converted to doubles and scored this many at a time.  A block of pixels and the
+   // signature matrix it is multiplied by both stay in cache for typical band and signature counts.
+   const unsigned int sPixelBlockSize = 128;
+
+   // Data shared by every thread of both passes
+   struct MatchInput
+   {
+      MatchInput() :
+         mpRaster(NULL),
+         mpDescriptor(NULL),
+         mBandCount(0),
+         mpAoi(NULL),
+         mpAbort(NULL),
+         mMethod(SpectralMatcher::SAM),
+         mSignatureCount(0),
+         mUseThreshold(false),
+         mThreshold(0.0),
+         mpScores(NULL),
+         mpClasses(NULL)
+      {}
+
+      const RasterElement* mpRaster;
+      const RasterDataDescriptor* mpDescriptor;
+      unsigned int mBandCount;
+      const BitMaskIterator* mpAoi;
+      vector<pair<unsigned int, const BadValues*> > mBadValues;
+      const bool* mpAbort;
+
+      SpectralMatcher::Method mMethod;
+      unsigned int mSignatureCount;
+      vector<double> mFilters;       // mSignatureCount x mBandCount
+      vector<double> mConstants;     // per signature values used to normalize the scores
+      vector<double> mMean;          // subtracted from each pixel by MATCHED_FILTER and ACE
+      vector<double> mInverse;       // the inverse covariance used by ACE
+      bool mUseThreshold;
+      double mThreshold;
+      RasterElement* mpScores;
+      RasterElement* mpClasses;
+   };
+
+   bool isAborted(const MatchInput& input)
+   {
+      return input.mpAbort != NULL && *input.mpAbort;
+   }
+
+   DataAccessor getRowAccessor(const RasterElement* pElement, int firstRow, int lastRow, bool writable)
+   {
+      if (pElement == NULL)
+      {
+         return DataAccessor(NULL, NULL);
+      }
+
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      VERIFYRV(pDescriptor != NULL, DataAccessor(NULL, NULL));
+
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setRows(pDescriptor->getActiveRow(firstRow), pDescriptor->getActiveRow(lastRow));
+      pRequest->setInterleaveFormat(BIP);
+      pRequest->setWritable(writable);
+      return pElement->getDataAccessor(pRequest.release());
+   }
+
+   // Converts the pixels in [firstColumn, endColumn) of a BIP row which are in the AOI and
+   // have no bad values.  The columns of the converted pixels are returned in pColumns.
+   template<typename T>
+   void packPixels(const T* pRow, const MatchInput& input, int row, unsigned int firstColumn,
+      unsigned int endColumn, double* pPixels, unsigned int* pColumns, unsigned int& count)
+   {
+      const unsigned int bandCount = input.mBandCount;
+      count = 0;
+      for (unsigned int column = firstColumn; column < endColumn; ++column)
+      {
+         if (input.mpAoi->getPixel(static_cast<int>(column), row) == false)
+         {
+            continue;
+         }
+
+         const T* pPixel = pRow + column * bandCount;
+         bool badValue = false;
+         for (vector<pair<unsigned int, const BadValues*> >::const_iterator iter = input.mBadValues.begin();
+            iter != input.mBadValues.end(); ++iter)
+         {
+            if (iter->second->isBadValue(static_cast<double>(pPixel[iter->first])))
+            {
+               badValue = true;
+               break;
+            }
+         }
+
+         if (badValue)
+         {
+            continue;
+         }
+
+         double* pPixelValues = pPixels + count * bandCount;
+         for (unsigned int band = 0; band < bandCount; ++band)
+         {
+            pPixelValues[band] = static_cast<double>(pPixel[band]);
+         }
+
+         pColumns[count++] = column;
+      }
+   }
+
+   // Calls packPixels() for each block of a row, then calls processBlock(count) on the thread
+   template<class Thread>
+   void processRow(Thread& thread, const MatchInput& input, const void* pRow, int row, double* pPixels,
+      unsigned int* pColumns)
+   {
+      const unsigned int columnCount = input.mpDescriptor->getColumnCount();
+      for (unsigned int column = 0; column < columnCount; column += sPixelBlockSize)
+      {
+         unsigned int count = 0;
+         switchOnEncoding(input.mpDescriptor->getDataType(), packPixels, pRow, input, row, column,
+            min(column + sPixelBlockSize, columnCount), pPixels, pColumns, count);
+         if (count > 0)
+         {
+            thread.processBlock(count);
+         }
+      }
+   }
+
+   /**
+    * Accumulates the sum and second moment of the valid pixels in the rows claimed by the thread.
+    */
+   class BackgroundThread : public mta::AlgorithmThread
+   {
+   public:
+      BackgroundThread(const MatchInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mSum(Eigen::VectorXd::Zero(input.mBandCount)),
+         mSecondMoment(Eigen::MatrixXd::Zero(input.mBandCount, input.mBandCount)),
+         mPixelCount(0),
+         mInput(input),
+         mThreadCount(threadCount),
+         mPixels(sPixelBlockSize * input.mBandCount),
+         mColumns(sPixelBlockSize)
+      {}
+
+      void run()
+      {
+         const int rowCount = static_cast<int>(mInput.mpDescriptor->getRowCount());
+         mta::AlgorithmThread::Range rowRange;
+         while (getNextRange(mThreadCount, rowCount, rowRange))
+         {
+            DataAccessor accessor = getRowAccessor(mInput.mpRaster, rowRange.mFirst, rowRange.mLast, false);
+            int oldPercentDone = -1;
+            for (int row = rowRange.mFirst; row <= rowRange.mLast; ++row)
+            {
+               if (isAborted(mInput))
+               {
+                  return;
+               }
+
+               if (accessor.isValid() == false)
+               {
+                  getReporter().reportError("Unable to access the data.");
+                  return;
+               }
+
+               processRow(*this, mInput, accessor->getRow(), row, &mPixels[0], &mColumns[0]);
+               accessor->nextRow();
+
+               int percentDone = rowRange.computePercent(row);
+               if (percentDone > oldPercentDone)
+               {
+                  oldPercentDone = percentDone;
+                  getReporter().reportProgress(getThreadIndex(), percentDone);
+               }
+            }
+         }
+      }
+
+      void processBlock(unsigned int count)
+      {
+         ConstRowMatrixMap pixels(&mPixels[0], count, mInput.mBandCount);
+         mSum += pixels.colwise().sum().transpose();
+         mSecondMoment.selfadjointView<Eigen::Lower>().rankUpdate(pixels.transpose());
+         mPixelCount += count;
+      }
+
+      Eigen::VectorXd mSum;
+      Eigen::MatrixXd mSecondMoment;   // only the lower triangle is accumulated
+      unsigned int mPixelCount;
+
+   private:
+      BackgroundThread& operator=(const BackgroundThread& rhs);
+
+      const MatchInput& mInput;
+      int mThreadCount;
+      vector<double> mPixels;
+      vector<unsigned int> mColumns;
+   };
+
+   struct BackgroundOutput
+   {
+      BackgroundOutput() :
+         mPixelCount(0)
+      {}
+
+      bool compileOverallResults(const vector<BackgroundThread*>& threads)
+      {
+         for (vector<BackgroundThread*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+         {
+            const BackgroundThread* pThread = *iter;
+            VERIFY(pThread != NULL);
+            if (mSum.size() == 0)
+            {
+               mSum = pThread->mSum;
+               mSecondMoment = pThread->mSecondMoment;
+            }
+            else
+            {
+               mSum += pThread->mSum;
+               mSecondMoment += pThread->mSecondMoment;
+            }
+            mPixelCount += pThread->mPixelCount;
+         }
+
+         if (mPixelCount > 0)
+         {
+            mSum /= mPixelCount;
+            mSecondMoment /= mPixelCount;
+            mSecondMoment.triangularView<Eigen::StrictlyUpper>() = mSecondMoment.transpose();
+         }
+
+         return true;
+      }
+
+      Eigen::VectorXd mSum;            // the mean once the results are compiled
+      Eigen::MatrixXd mSecondMoment;   // E[x x'] once the results are compiled
+      unsigned int mPixelCount;
+   };
+
+   /**
+    * Scores the valid pixels in the rows claimed by the thread and writes the scores and classes.
+    */
+   class MatchThread : public mta::AlgorithmThread
+   {
+   public:
+      MatchThread(const MatchInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mThreadCount(threadCount),
+         mPixels(sPixelBlockSize * input.mBandCount),
+         mColumns(sPixelBlockSize),
+         mScores(sPixelBlockSize, input.mSignatureCount),
+         mpScoreRow(NULL),
+         mpClassRow(NULL)
+      {
+         if (input.mMethod == SpectralMatcher::ACE)
+         {
+            mWhitened.resize(sPixelBlockSize, input.mBandCount);
+         }
+      }
+
+      void run()
+      {
+         const int rowCount = static_cast<int>(mInput.mpDescriptor->getRowCount());
+         const unsigned int columnCount = mInput.mpDescriptor->getColumnCount();
+         const unsigned int signatureCount = mInput.mSignatureCount;
+         mta::AlgorithmThread::Range rowRange;
+         while (getNextRange(mThreadCount, rowCount, rowRange))
+         {
+            DataAccessor accessor = getRowAccessor(mInput.mpRaster, rowRange.mFirst, rowRange.mLast, false);
+            DataAccessor scoreAccessor = getRowAccessor(mInput.mpScores, rowRange.mFirst, rowRange.mLast, true);
+            DataAccessor classAccessor = getRowAccessor(mInput.mpClasses, rowRange.mFirst, rowRange.mLast, true);
+            int oldPercentDone = -1;
+            for (int row = rowRange.mFirst; row <= rowRange.mLast; ++row)
+            {
+               if (isAborted(mInput))
+               {
+                  return;
+               }
+
+               if (accessor.isValid() == false ||
+                  (mInput.mpScores != NULL && scoreAccessor.isValid() == false) ||
+                  (mInput.mpClasses != NULL && classAccessor.isValid() == false))
+               {
+                  getReporter().reportError("Unable to access the data.");
+                  return;
+               }
+
+               // Pixels which are not scored keep these values
+               if (mInput.mpScores != NULL)
+               {
+                  mpScoreRow = reinterpret_cast<float*>(scoreAccessor->getRow());
+                  fill(mpScoreRow, mpScoreRow + columnCount * signatureCount,
+                     static_cast<float>(SpectralMatcher::NO_DATA_SCORE));
+               }
+               if (mInput.mpClasses != NULL)
+               {
+                  mpClassRow = reinterpret_cast<unsigned short*>(classAccessor->getRow());
+                  fill(mpClassRow, mpClassRow + columnCount, static_cast<unsigned short>(0));
+               }
+
+               processRow(*this, mInput, accessor->getRow(), row, &mPixels[0], &mColumns[0]);
+
+               accessor->nextRow();
+               if (mInput.mpScores != NULL)
+               {
+                  scoreAccessor->nextRow();
+               }
+               if (mInput.mpClasses != NULL)
+               {
+                  classAccessor->nextRow();
+               }
+
+               int percentDone = rowRange.computePercent(row);
+               if (percentDone > oldPercentDone)
+               {
+                  oldPercentDone = percentDone;
+                  getReporter().reportProgress(getThreadIndex(), percentDone);
+               }
+            }
+         }
+      }
+
+      void processBlock(unsigned int count)
+      {
+         computeScores(count);
+
+         const unsigned int signatureCount = mInput.mSignatureCount;
+         const bool lowerIsBetter = SpectralMatcher::isLowerScoreBetter(mInput.mMethod);
+         for (unsigned int i = 0; i < count; ++i)
+         {
+            const unsigned int column = mColumns[i];
+            if (mpScoreRow != NULL)
+            {
+               float* pScores = mpScoreRow + column * signatureCount;
+               for (unsigned int signature = 0; signature < signatureCount; ++signature)
+               {
+                  pScores[signature] = static_cast<float>(mScores(i, signature));
+               }
+            }
+
+            if (mpClassRow != NULL)
+            {
+               unsigned short bestClass = 0;
+               double bestScore = 0.0;
+               for (unsigned int signature = 0; signature < signatureCount; ++signature)
+               {
+                  double score = mScores(i, signature);
+                  if (score == SpectralMatcher::NO_DATA_SCORE)
+                  {
+                     continue;
+                  }
+
+                  if (bestClass == 0 || (lowerIsBetter ? score < bestScore : score > bestScore))
+                  {
+                     bestClass = static_cast<unsigned short>(signature + 1);
+                     bestScore = score;
+                  }
+               }
+
+               if (bestClass != 0 && mInput.mUseThreshold &&
+                  (lowerIsBetter ? bestScore > mInput.mThreshold : bestScore < mInput.mThreshold))
+               {
+                  bestClass = 0;
+               }
+
+               mpClassRow[column] = bestClass;
+            }
+         }
+      }
+
+   private:
+      MatchThread& operator=(const MatchThread& rhs);
+
+      void computeScores(unsigned int count)
+      {
+         const unsigned int bandCount = mInput.mBandCount;
+         const unsigned int signatureCount = mInput.mSignatureCount;
+         RowMatrixMap pixels(&mPixels[0], count, bandCount);
+         ConstRowMatrixMap filters(&mInput.mFilters[0], signatureCount, bandCount);
+         RowMatrix::RowsBlockXpr scores = mScores.topRows(count);
+         const double* pConstants = mInput.mConstants.empty() ? NULL : &mInput.mConstants[0];
+
+         if (mInput.mMethod == SpectralMatcher::MATCHED_FILTER || mInput.mMethod == SpectralMatcher::ACE)
+         {
+            pixels.rowwise() -= Eigen::Map<const Eigen::RowVectorXd>(&mInput.mMean[0], bandCount);
+         }
+
+         switch (mInput.mMethod)
+         {
+         case SpectralMatcher::SAM:
+            scores.noalias() = pixels * filters.transpose();
+            for (unsigned int i = 0; i < count; ++i)
+            {
+               double pixelNorm = pixels.row(i).norm();
+               for (unsigned int signature = 0; signature < signatureCount; ++signature)
+               {
+                  double denominator = pixelNorm * pConstants[signature];
+                  scores(i, signature) = (denominator > 0.0) ?
+                     acos(max(-1.0, min(1.0, scores(i, signature) / denominator))) : SpectralMatcher::NO_DATA_SCORE;
+               }
+            }
+            break;
+
+         case SpectralMatcher::CORRELATION:
+            scores.noalias() = pixels * filters.transpose();
+            for (unsigned int i = 0; i < count; ++i)
+            {
+               double pixelSum = pixels.row(i).sum();
+               double pixelVariance = pixels.row(i).squaredNorm() - pixelSum * pixelSum / bandCount;
+               for (unsigned int signature = 0; signature < signatureCount; ++signature)
+               {
+                  double denominator = pixelVariance * pConstants[signatureCount + signature];
+                  scores(i, signature) = (denominator > 0.0) ?
+                     (scores(i, signature) - pixelSum * pConstants[signature] / bandCount) / sqrt(denominator) :
+                     SpectralMatcher::NO_DATA_SCORE;
+               }
+            }
+            break;
+
+         case SpectralMatcher::CEM:
+         case SpectralMatcher::MATCHED_FILTER:
+            // The filters are already normalized, so the scores are the products
+            scores.noalias() = pixels * filters.transpose();
+            break;
+
+         case SpectralMatcher::ACE:
+         {
+            RowMatrix::RowsBlockXpr whitened = mWhitened.topRows(count);
+            whitened.noalias() = pixels * ConstRowMatrixMap(&mInput.mInverse[0], bandCount, bandCount);
+            scores.noalias() = whitened * filters.transpose();
+            for (unsigned int i = 0; i < count; ++i)
+            {
+               double pixelDistance = whitened.row(i).dot(pixels.row(i));
+               for (unsigned int signature = 0; signature < signatureCount; ++signature)
+               {
+                  double denominator = pixelDistance * pConstants[signature];
+                  double score = scores(i, signature);
+                  scores(i, signature) = (denominator > 0.0) ?
+                     score * score / denominator : SpectralMatcher::NO_DATA_SCORE;
+               }
+            }
+            break;
+         }
+
+         default:
+            scores.setConstant(SpectralMatcher::NO_DATA_SCORE);
+            break;
+         }
+      }
+
+      const MatchInput& mInput;
+      int mThreadCount;
+      vector<double> mPixels;
+      vector<unsigned int> mColumns;
+      RowMatrix mScores;
+      RowMatrix mWhitened;
+      float* mpScoreRow;
+      unsigned short* mpClassRow;
+   };
+
+   struct MatchOutput
+   {
+      bool compileOverallResults(const vector<MatchThread*>& threads)
+      {
+         return true;
+      }
+   };
+
+   // Computes the filters applied to each pixel from the signatures and background statistics.
+   bool computeFilters(MatchInput& input, const vector<double>& signatures, const BackgroundOutput* pBackground,
+      string& errorMessage)
+   {
+      const unsigned int bandCount = input.mBandCount;
+      const unsigned int signatureCount = input.mSignatureCount;
+      ConstRowMatrixMap targets(&signatures[0], signatureCount, bandCount);
+      input.mFilters.assign(signatures.begin(), signatures.end());
+      input.mConstants.clear();
+
+      switch (input.mMethod)
+      {
+      case SpectralMatcher::SAM:
+         for (unsigned int signature = 0; signature < signatureCount; ++signature)
+         {
+            input.mConstants.push_back(targets.row(signature).norm());
+         }
+         return true;
+
+      case SpectralMatcher::CORRELATION:
+         input.mConstants.resize(2 * signatureCount);
+         for (unsigned int signature = 0; signature < signatureCount; ++signature)
+         {
+            double sum = targets.row(signature).sum();
+            input.mConstants[signature] = sum;
+            input.mConstants[signatureCount + signature] =
+               targets.row(signature).squaredNorm() - sum * sum / bandCount;
+         }
+         return true;
+
+      default:
+         break;
+      }
+
+      VERIFY(pBackground != NULL);
+      if (pBackground->mPixelCount <= bandCount)
+      {
+         errorMessage = "There are not enough valid pixels to compute the background statistics.";
+         return false;
+      }
+
+      // CEM uses the correlation matrix; the other detectors use the mean and covariance
+      RowMatrix background = pBackground->mSecondMoment;
+      RowMatrix differences = targets;
+      if (input.mMethod != SpectralMatcher::CEM)
+      {
+         background -= pBackground->mSum * pBackground->mSum.transpose();
+         differences.rowwise() -= pBackground->mSum.transpose();
+         input.mMean.assign(pBackground->mSum.data(), pBackground->mSum.data() + bandCount);
+      }
+
+      input.mInverse.resize(bandCount * bandCount);
+      if (MatrixFunctions::invertSquareMatrix1D(&input.mInverse[0], background.data(),
+         static_cast<int>(bandCount)) == false)
+      {
+         errorMessage = "The background covariance of the data is singular.";
+         return false;
+      }
+
+      ConstRowMatrixMap inverse(&input.mInverse[0], bandCount, bandCount);
+      RowMatrix filters = differences * inverse;
+      for (unsigned int signature = 0; signature < signatureCount; ++signature)
+      {
+         double energy = filters.row(signature).dot(differences.row(signature));
+         if (energy <= 0.0)
+         {
+            stringstream message;
+            message << "Signature " << signature + 1 << " cannot be distinguished from the background.";
+            errorMessage = message.str();
+            return false;
+         }
+
+         if (input.mMethod == SpectralMatcher::ACE)
+         {
+            input.mConstants.push_back(energy);
+         }
+         else
+         {
+            filters.row(signature) /= energy;
+         }
+      }
+
+      if (input.mMethod == SpectralMatcher::ACE)
+      {
+         // ACE projects the whitened pixel onto the difference between each signature and the mean
+         filters = differences;
+      }
+      else
+      {
+         input.mInverse.clear();
+      }
+
+      input.mFilters.assign(filters.data(), filters.data() + filters.size());
+      return true;
+   }
+}
+
+SpectralMatcher::SpectralMatcher(Method method, const vector<double>& signatures, unsigned int signatureCount) :
+   mMethod(method),
+   mSignatures(signatures),
+   mSignatureCount(signatureCount),
+   mpAoi(NULL),
+   mUseThreshold(false),
+   mThreshold(0.0),
+   mpAbort(NULL),
+   mpProgress(NULL)
+{
+}
+
+SpectralMatcher::~SpectralMatcher()
+{
+}
+
+void SpectralMatcher::setAoi(const BitMask* pAoi)
+{
+   mpAoi = pAoi;
+}
+
+void SpectralMatcher::setClassThreshold(double threshold)
+{
+   mUseThreshold = true;
+   mThreshold = threshold;
+}
+
+void SpectralMatcher::setAbortFlag(const bool* pAbort)
+{
+   mpAbort = pAbort;
+}
+
+void SpectralMatcher::setProgress(Progress* pProgress)
+{
+   mpProgress = pProgress;
+}
+
+const string& SpectralMatcher::getErrorMessage() const
+{
+   return mErrorMessage;
+}
+
+bool SpectralMatcher::isLowerScoreBetter(Method method)
+{
+   return method == SAM;
+}
+
+bool SpectralMatcher::match(const RasterElement* pRaster, RasterElement* pScores, RasterElement* pClasses)
+{
+   mErrorMessage.clear();
+   if (pRaster == NULL)
+   {
+      mErrorMessage = "No raster element was provided.";
+      return false;
+   }
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+   if (pDescriptor->getDataType() == INT4SCOMPLEX || pDescriptor->getDataType() == FLT8COMPLEX)
+   {
+      mErrorMessage = "Complex data is not supported.";
+      return false;
+   }
+
+   const unsigned int bandCount = pDescriptor->getBandCount();
+   if (mSignatureCount == 0 || bandCount == 0 || mSignatures.size() != mSignatureCount * bandCount)
+   {
+      mErrorMessage = "The signatures do not have one value for each band of the data.";
+      return false;
+   }
+
+   if (pClasses != NULL && mSignatureCount >= numeric_limits<unsigned short>::max())
+   {
+      mErrorMessage = "There are too many signatures to create a class map.";
+      return false;
+   }
+
+   const RasterDataDescriptor* pScoreDescriptor = (pScores == NULL) ? NULL :
+      dynamic_cast<const RasterDataDescriptor*>(pScores->getDataDescriptor());
+   if (pScores != NULL && (pScoreDescriptor == NULL || pScoreDescriptor->getDataType() != FLT4BYTES ||
+      pScoreDescriptor->getInterleaveFormat() != BIP || pScoreDescriptor->getBandCount() != mSignatureCount ||
+      pScoreDescriptor->getRowCount() != pDescriptor->getRowCount() ||
+      pScoreDescriptor->getColumnCount() != pDescriptor->getColumnCount()))
+   {
+      mErrorMessage = "The score element does not match the data.";
+      return false;
+   }
+
+   const RasterDataDescriptor* pClassDescriptor = (pClasses == NULL) ? NULL :
+      dynamic_cast<const RasterDataDescriptor*>(pClasses->getDataDescriptor());
+   if (pClasses != NULL && (pClassDescriptor == NULL || pClassDescriptor->getDataType() != INT2UBYTES ||
+      pClassDescriptor->getBandCount() != 1 || pClassDescriptor->getRowCount() != pDescriptor->getRowCount() ||
+      pClassDescriptor->getColumnCount() != pDescriptor->getColumnCount()))
+   {
+      mErrorMessage = "The class element does not match the data.";
+      return false;
+   }
+
+   BitMaskIterator aoi(mpAoi, pRaster);
+   if (aoi.getCount() == 0)
+   {
+      mErrorMessage = "The AOI does not contain any pixels in the data.";
+      return false;
+   }
+
+   MatchInput input;
+   input.mpRaster = pRaster;
+   input.mpDescriptor = pDescriptor;
+   input.mBandCount = bandCount;
+   input.mpAoi = &aoi;
+   input.mpAbort = mpAbort;
+   input.mMethod = mMethod;
+   input.mSignatureCount = mSignatureCount;
+   input.mUseThreshold = mUseThreshold;
+   input.mThreshold = mThreshold;
+   input.mpScores = pScores;
+   input.mpClasses = pClasses;
+
+   // Statistics are created on demand, so look up the bad values before the threads start
+   for (unsigned int band = 0; band < bandCount; ++band)
+   {
+      Statistics* pStatistics = pRaster->getStatistics(pDescriptor->getActiveBand(band));
+      const BadValues* pBadValues = (pStatistics == NULL) ? NULL : pStatistics->getBadValues();
+      if (pBadValues != NULL && pBadValues->empty() == false)
+      {
+         input.mBadValues.push_back(make_pair(band, pBadValues));
+      }
+   }
+
+   const bool needsBackground = (mMethod == CEM || mMethod == MATCHED_FILTER || mMethod == ACE);
+   vector<int> phaseWeights;
+   phaseWeights.push_back(needsBackground ? 30 : 0);
+   phaseWeights.push_back(needsBackground ? 70 : 100);
+   mta::ProgressObjectReporter reporter("Matching signatures", mpProgress);
+   mta::MultiPhaseProgressReporter phaseReporter(reporter, phaseWeights);
+   const int threadCount = mta::getNumRequiredThreads(pDescriptor->getRowCount());
+
+   BackgroundOutput background;
+   if (needsBackground)
+   {
+      phaseReporter.setCurrentPhase(0);
+      mta::MultiThreadedAlgorithm<MatchInput, BackgroundOutput, BackgroundThread>
+         backgroundAlgorithm(threadCount, input, background, &phaseReporter, mta::DYNAMIC_SCHEDULING);
+      if (backgroundAlgorithm.run() != mta::SUCCESS)
+      {
+         mErrorMessage = backgroundAlgorithm.getErrorText();
+         if (mErrorMessage.empty())
+         {
+            mErrorMessage = "Unable to compute the background statistics.";
+         }
+         return false;
+      }
+   }
+
+   if (isAborted(input))
+   {
+      mErrorMessage = "Spectral matching was aborted.";
+      return false;
+   }
+
+   if (computeFilters(input, mSignatures, needsBackground ? &background : NULL, mErrorMessage) == false)
+   {
+      return false;
+   }
+
+   phaseReporter.setCurrentPhase(1);
+   MatchOutput output;
+   mta::MultiThreadedAlgorithm<MatchInput, MatchOutput, MatchThread>
+      matchAlgorithm(threadCount, input, output, &phaseReporter, mta::DYNAMIC_SCHEDULING);
+   if (matchAlgorithm.run() != mta::SUCCESS)
+   {
+      mErrorMessage = matchAlgorithm.getErrorText();
+      if (mErrorMessage.empty())
+      {
+         mErrorMessage = "Unable to match the signatures.";
+      }
+      return false;
+   }
+
+   if (isAborted(input))
+   {
+      mErrorMessage = "Spectral matching was aborted.";
+      return false;
+   }
+
+   if (pScores != NULL)
+   {
+      pScores->updateData();
+   }
+   if (pClasses != NULL)
+   {
+      pClasses->updateData();
+   }
+
+   return true;
+}
@@ -0,0 +1,440 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "MultiThreadedAlgorithm.h"
+#include "SpectralResampler.h"
+
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <sstream>
+
+using namespace std;
+
+namespace
+{
+   typedef vector<pair<unsigned int, double> > SparseRow;
+
+   // Spline weights smaller than this are dropped.  The influence of a source value on the spline
+   // decays by roughly a factor of four per sample, so this keeps about twenty samples per band.
+   const double sMinimumSplineWeight = 1e-12;
+
+   // Batches with fewer multiply-adds than this are resampled on the calling thread.
+   const unsigned int sMinimumThreadedWork = 1 << 18;
+
+   void addLinearWeights(const vector<double>& wavelengths, double wavelength, SparseRow& row)
+   {
+      unsigned int upper = static_cast<unsigned int>(
+         upper_bound(wavelengths.begin(), wavelengths.end(), wavelength) - wavelengths.begin());
+      unsigned int lower = min(max(upper, 1U), static_cast<unsigned int>(wavelengths.size() - 1)) - 1;
+      double t = (wavelength - wavelengths[lower]) / (wavelengths[lower + 1] - wavelengths[lower]);
+      if (t < 1.0)
+      {
+         row.push_back(make_pair(lower, 1.0 - t));
+      }
+      if (t > 0.0)
+      {
+         row.push_back(make_pair(lower + 1, t));
+      }
+   }
+
+   /**
+    * Computes the second derivatives of a natural cubic spline as linear combinations of the source values.
+    *
+    * The interior second derivatives solve a symmetric tridiagonal system A m = B y.  Since A is symmetric,
+    * row k of inverse(A) B is found by solving A r = e_k once, so only the rows used by a destination
+    * wavelength are computed.
+    */
+   class SplineSecondDerivatives
+   {
+   public:
+      SplineSecondDerivatives(const vector<double>& wavelengths) :
+         mWavelengths(wavelengths)
+      {
+         const unsigned int interiorCount = static_cast<unsigned int>(wavelengths.size() - 2);
+         mDiagonal.resize(interiorCount);
+         mOffDiagonal.resize(interiorCount);
+         for (unsigned int i = 0; i < interiorCount; ++i)
+         {
+            mDiagonal[i] = (width(i) + width(i + 1)) / 3.0;
+            mOffDiagonal[i] = width(i + 1) / 6.0;
+         }
+
+         // Factor the matrix once so each solve is a forward and back substitution
+         mUpper.resize(interiorCount);
+         mPivot.resize(interiorCount);
+         for (unsigned int i = 0; i < interiorCount; ++i)
+         {
+            mPivot[i] = mDiagonal[i] - (i == 0 ? 0.0 : mOffDiagonal[i - 1] * mUpper[i - 1]);
+            mUpper[i] = mOffDiagonal[i] / mPivot[i];
+         }
+      }
+
+      const SparseRow& getRow(unsigned int sample)
+      {
+         map<unsigned int, SparseRow>::const_iterator iter = mRows.find(sample);
+         if (iter != mRows.end())
+         {
+            return iter->second;
+         }
+
+         SparseRow& row = mRows[sample];
+         if (sample == 0 || sample + 1 >= mWavelengths.size())
+         {
+            // The second derivative of a natural spline is zero at the ends
+            return row;
+         }
+
+         const unsigned int interiorCount = static_cast<unsigned int>(mDiagonal.size());
+         vector<double> solution(interiorCount, 0.0);
+         for (unsigned int i = 0; i < interiorCount; ++i)
+         {
+            double rhs = (i + 1 == sample ? 1.0 : 0.0);
+            solution[i] = (rhs - (i == 0 ? 0.0 : mOffDiagonal[i - 1] * solution[i - 1])) / mPivot[i];
+         }
+         for (unsigned int i = interiorCount - 1; i > 0; --i)
+         {
+            solution[i - 1] -= mUpper[i - 1] * solution[i];
+         }
+
+         // Interior equation i relates source values i, i + 1 and i + 2
+         vector<double> weights(mWavelengths.size(), 0.0);
+         for (unsigned int i = 0; i < interiorCount; ++i)
+         {
+            weights[i] += solution[i] / width(i);
+            weights[i + 1] -= solution[i] * (1.0 / width(i) + 1.0 / width(i + 1));
+            weights[i + 2] += solution[i] / width(i + 1);
+         }
+         for (unsigned int i = 0; i < weights.size(); ++i)
+         {
+            if (fabs(weights[i]) >= sMinimumSplineWeight)
+            {
+               row.push_back(make_pair(i, weights[i]));
+            }
+         }
+
+         return row;
+      }
+
+   private:
+      SplineSecondDerivatives& operator=(const SplineSecondDerivatives& rhs);
+
+      double width(unsigned int interval) const
+      {
+         return mWavelengths[interval + 1] - mWavelengths[interval];
+      }
+
+      const vector<double>& mWavelengths;
+      vector<double> mDiagonal;
+      vector<double> mOffDiagonal;
+      vector<double> mUpper;
+      vector<double> mPivot;
+      map<unsigned int, SparseRow> mRows;
+   };
+
+   void addSplineWeights(const vector<double>& wavelengths, double wavelength,
+      SplineSecondDerivatives& secondDerivatives, SparseRow& row)
+   {
+      SparseRow linear;
+      addLinearWeights(wavelengths, wavelength, linear);
+      unsigned int lower = linear.front().first;
+      if (linear.size() == 1)
+      {
+         // The destination wavelength is a source wavelength
+         row = linear;
+         return;
+      }
+
+      double width = wavelengths[lower + 1] - wavelengths[lower];
+      double a = (wavelengths[lower + 1] - wavelength) / width;
+      double b = 1.0 - a;
+      double lowerScale = (a * a * a - a) * width * width / 6.0;
+      double upperScale = (b * b * b - b) * width * width / 6.0;
+
+      map<unsigned int, double> weights;
+      weights[lower] += a;
+      weights[lower + 1] += b;
+
+      const SparseRow& lowerRow = secondDerivatives.getRow(lower);
+      for (SparseRow::const_iterator iter = lowerRow.begin(); iter != lowerRow.end(); ++iter)
+      {
+         weights[iter->first] += lowerScale * iter->second;
+      }
+
+      const SparseRow& upperRow = secondDerivatives.getRow(lower + 1);
+      for (SparseRow::const_iterator iter = upperRow.begin(); iter != upperRow.end(); ++iter)
+      {
+         weights[iter->first] += upperScale * iter->second;
+      }
+
+      row.assign(weights.begin(), weights.end());
+   }
+
+   void addGaussianWeights(const vector<double>& wavelengths, double wavelength, double fwhm, SparseRow& row)
+   {
+      // Bands narrower than the source sampling are interpolated
+      const double sigma = fwhm / (2.0 * sqrt(2.0 * log(2.0)));
+      const unsigned int sampleCount = static_cast<unsigned int>(wavelengths.size());
+      unsigned int first = static_cast<unsigned int>(
+         lower_bound(wavelengths.begin(), wavelengths.end(), wavelength - 3.0 * sigma) - wavelengths.begin());
+      unsigned int last = static_cast<unsigned int>(
+         upper_bound(wavelengths.begin(), wavelengths.end(), wavelength + 3.0 * sigma) - wavelengths.begin());
+      if (sigma <= 0.0 || last < first + 2)
+      {
+         addLinearWeights(wavelengths, wavelength, row);
+         return;
+      }
+
+      // Integrate the band response with the trapezoid rule over the source samples
+      double total = 0.0;
+      for (unsigned int i = first; i < last; ++i)
+      {
+         double spacing = (wavelengths[min(i + 1, sampleCount - 1)] - wavelengths[i == 0 ? 0 : i - 1]) / 2.0;
+         double distance = (wavelengths[i] - wavelength) / sigma;
+         double weight = exp(-0.5 * distance * distance) * spacing;
+         row.push_back(make_pair(i, weight));
+         total += weight;
+      }
+
+      for (SparseRow::iterator iter = row.begin(); iter != row.end(); ++iter)
+      {
+         iter->second /= total;
+      }
+   }
+
+   struct ResampleInput
+   {
+      const unsigned int* mpOffsets;
+      const unsigned int* mpIndices;
+      const double* mpWeights;
+      unsigned int mFromCount;
+      unsigned int mToCount;
+      const double* mpFromData;
+      double* mpToData;
+      unsigned int mCount;
+   };
+
+   void resampleSpectra(const ResampleInput& input, unsigned int first, unsigned int last)
+   {
+      for (unsigned int spectrum = first; spectrum <= last; ++spectrum)
+      {
+         const double* pFrom = input.mpFromData + static_cast<size_t>(spectrum) * input.mFromCount;
+         double* pTo = input.mpToData + static_cast<size_t>(spectrum) * input.mToCount;
+         for (unsigned int band = 0; band < input.mToCount; ++band)
+         {
+            double value = 0.0;
+            for (unsigned int i = input.mpOffsets[band]; i < input.mpOffsets[band + 1]; ++i)
+            {
+               value += input.mpWeights[i] * pFrom[input.mpIndices[i]];
+            }
+            pTo[band] = value;
+         }
+      }
+   }
+
+   class ResampleThread : public mta::AlgorithmThread
+   {
+   public:
+      ResampleThread(const ResampleInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mThreadCount(threadCount)
+      {}
+
+      void run()
+      {
+         mta::AlgorithmThread::Range range;
+         while (getNextRange(mThreadCount, static_cast<int>(mInput.mCount), range))
+         {
+            resampleSpectra(mInput, range.mFirst, range.mLast);
+         }
+      }
+
+   private:
+      ResampleThread& operator=(const ResampleThread& rhs);
+
+      const ResampleInput& mInput;
+      int mThreadCount;
+   };
+
+   struct ResampleOutput
+   {
+      bool compileOverallResults(const vector<ResampleThread*>& threads)
+      {
+         return true;
+      }
+   };
+}
+
+SpectralResampler::SpectralResampler() :
+   mFromCount(0)
+{}
+
+bool SpectralResampler::initialize(Method method, const vector<double>& fromWavelengths,
+   const vector<double>& toWavelengths, const vector<double>& toFwhm)
+{
+   mMethod = method;
+   mFromCount = 0;
+   mOffsets.clear();
+   mIndices.clear();
+   mWeights.clear();
+   mErrorMessage.clear();
+
+   if (method.isValid() == false)
+   {
+      mErrorMessage = "The resampling method is not valid.";
+      return false;
+   }
+
+   if (method == GAUSSIAN && toFwhm.empty() == false && toFwhm.size() != toWavelengths.size())
+   {
+      mErrorMessage = "The number of FWHM values does not match the number of wavelengths.";
+      return false;
+   }
+
+   // Sort the source wavelengths, keeping the first of any duplicates
+   vector<pair<double, unsigned int> > sorted;
+   sorted.reserve(fromWavelengths.size());
+   for (unsigned int i = 0; i < fromWavelengths.size(); ++i)
+   {
+      sorted.push_back(make_pair(fromWavelengths[i], i));
+   }
+   sort(sorted.begin(), sorted.end());
+
+   vector<double> wavelengths;
+   vector<unsigned int> sourceIndices;
+   for (vector<pair<double, unsigned int> >::const_iterator iter = sorted.begin(); iter != sorted.end(); ++iter)
+   {
+      if (wavelengths.empty() || iter->first > wavelengths.back())
+      {
+         wavelengths.push_back(iter->first);
+         sourceIndices.push_back(iter->second);
+      }
+   }
+
+   if (wavelengths.size() < 2)
+   {
+      mErrorMessage = "At least two distinct source wavelengths are required.";
+      return false;
+   }
+
+   // Without an explicit FWHM, each band extends halfway to its neighbors
+   vector<double> fwhm(toFwhm);
+   if (method == GAUSSIAN && fwhm.empty())
+   {
+      vector<double> sortedTo(toWavelengths);
+      sort(sortedTo.begin(), sortedTo.end());
+      for (unsigned int i = 0; i < toWavelengths.size(); ++i)
+      {
+         vector<double>::const_iterator pos = lower_bound(sortedTo.begin(), sortedTo.end(), toWavelengths[i]);
+         double lower = (pos == sortedTo.begin() ? *pos : *(pos - 1));
+         double upper = (pos + 1 == sortedTo.end() ? *pos : *(pos + 1));
+         bool interior = (pos != sortedTo.begin() && pos + 1 != sortedTo.end());
+         fwhm.push_back(interior ? (upper - lower) / 2.0 : upper - lower);
+      }
+   }
+
+   SplineSecondDerivatives secondDerivatives(wavelengths);
+   mOffsets.reserve(toWavelengths.size() + 1);
+   mOffsets.push_back(0);
+   for (unsigned int band = 0; band < toWavelengths.size(); ++band)
+   {
+      double wavelength = toWavelengths[band];
+      if (!(wavelength >= wavelengths.front() && wavelength <= wavelengths.back()))
+      {
+         stringstream message;
+         message << "The wavelength " << wavelength << " is outside the range of the source wavelengths.";
+         mErrorMessage = message.str();
+         mOffsets.clear();
+         mIndices.clear();
+         mWeights.clear();
+         return false;
+      }
+
+      SparseRow row;
+      switch (method)
+      {
+      case LINEAR:
+         addLinearWeights(wavelengths, wavelength, row);
+         break;
+      case CUBIC_SPLINE:
+         addSplineWeights(wavelengths, wavelength, secondDerivatives, row);
+         break;
+      case GAUSSIAN:
+         addGaussianWeights(wavelengths, wavelength, fwhm[band], row);
+         break;
+      default:
+         break;
+      }
+
+      for (SparseRow::const_iterator iter = row.begin(); iter != row.end(); ++iter)
+      {
+         mIndices.push_back(sourceIndices[iter->first]);
+         mWeights.push_back(iter->second);
+      }
+      mOffsets.push_back(static_cast<unsigned int>(mIndices.size()));
+   }
+
+   mFromCount = static_cast<unsigned int>(fromWavelengths.size());
+   return true;
+}
+
+bool SpectralResampler::isValid() const
+{
+   return mOffsets.empty() == false;
+}
+
+const string& SpectralResampler::getErrorMessage() const
+{
+   return mErrorMessage;
+}
+
+unsigned int SpectralResampler::getFromCount() const
+{
+   return mFromCount;
+}
+
+unsigned int SpectralResampler::getToCount() const
+{
+   return mOffsets.empty() ? 0 : static_cast<unsigned int>(mOffsets.size() - 1);
+}
+
+bool SpectralResampler::resample(const double* pFromData, double* pToData, unsigned int count) const
+{
+   if (isValid() == false || pFromData == NULL || pToData == NULL)
+   {
+      return false;
+   }
+
+   if (count == 0 || getToCount() == 0)
+   {
+      return true;
+   }
+
+   ResampleInput input;
+   input.mpOffsets = &mOffsets[0];
+   input.mpIndices = mIndices.empty() ? NULL : &mIndices[0];
+   input.mpWeights = mWeights.empty() ? NULL : &mWeights[0];
+   input.mFromCount = mFromCount;
+   input.mToCount = getToCount();
+   input.mpFromData = pFromData;
+   input.mpToData = pToData;
+   input.mCount = count;
+
+   if (static_cast<double>(count) * mWeights.size() < sMinimumThreadedWork)
+   {
+      resampleSpectra(input, 0, count - 1);
+      return true;
+   }
+
+   ResampleOutput output;
+   mta::MultiThreadedAlgorithm<ResampleInput, ResampleOutput, ResampleThread>
+      algorithm(mta::getNumRequiredThreads(count), input, output, NULL, mta::DYNAMIC_SCHEDULING);
+   return algorithm.run() == mta::SUCCESS;
+}
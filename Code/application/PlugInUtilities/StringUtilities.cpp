@@ -748,6 +748,8 @@ BEGIN_ENUM_MAPPING(ProcessingLocation)
 ADD_ENUM_MAPPING(IN_MEMORY, "In Memory", "inMemory")
 ADD_ENUM_MAPPING(ON_DISK_READ_ONLY, "On Disk (Read-Only)", "onDiskReadOnly")
 ADD_ENUM_MAPPING(ON_DISK, "On Disk", "onDisk")
+ADD_ENUM_MAPPING(IN_MEMORY_COMPRESSED, "In Memory (Compressed)", "inMemoryCompressed")
+ADD_ENUM_MAPPING(IN_MEMORY_SPILLABLE, "In Memory (Spill to Disk)", "inMemorySpillable")
 END_ENUM_MAPPING()
 
 BEGIN_ENUM_MAPPING(RasterChannelType)
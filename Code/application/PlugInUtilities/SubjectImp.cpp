@@ -120,6 +120,22 @@ void SubjectImp::enableSignals(bool enabled)
    mpImpPrivate->enableSignals(enabled);
 }
 
+void SubjectImp::beginSignalBatch()
+{
+   mpImpPrivate->beginSignalBatch();
+}
+
+void SubjectImp::endSignalBatch()
+{
+   Subject* pSubject = dynamic_cast<Subject*>(this);
+   if (pSubject == NULL)
+   {
+      return;
+   }
+
+   mpImpPrivate->endSignalBatch(*pSubject);
+}
+
 bool SubjectImp::signalsEnabled() const
 {
    const Subject* pSubject = dynamic_cast<const Subject*>(this);
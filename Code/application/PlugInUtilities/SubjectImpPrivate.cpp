@@ -18,7 +18,11 @@
 
 using namespace std;
 
-SubjectImpPrivate::SubjectImpPrivate() : mpSubject(NULL), mSignalsEnabled(true)
+SubjectImpPrivate::SubjectImpPrivate() :
+   mpSubject(NULL),
+   mSignalsEnabled(true),
+   mBatchDepth(0),
+   mLastPendingSignal(0)
 {
 }
 
@@ -38,22 +42,18 @@ bool SubjectImpPrivate::attach(Subject& subject, const string& signal, const Slo
       mpSubject = &subject;
    }
 
-   MapType::iterator pSlotVec = mSlots.find(signal);
-   if (pSlotVec != mSlots.end())
+   list<SafeSlot>& slotVec = mSlots[getSignalId(signal, true)];
+   list<SafeSlot>::iterator pSlot;
+   for (pSlot = slotVec.begin(); pSlot != slotVec.end(); ++pSlot)
    {
-      list<SafeSlot>& slotVec = pSlotVec->second;
-      list<SafeSlot>::iterator pSlot;
-      for (pSlot = slotVec.begin(); pSlot != slotVec.end(); ++pSlot)
+      if (*pSlot == slot)
       {
-         if (*pSlot == slot)
-         {
-            return false;
-         }
+         return false;
       }
    }
 
-   mSlots[signal].push_back(slot);
-   SafeSlot& mappedSlot(mSlots[signal].back());
+   slotVec.push_back(slot);
+   SafeSlot& mappedSlot(slotVec.back());
    SlotInvalidator* pInvalidator = mappedSlot.getInvalidator();
    if (pInvalidator)
    {
@@ -76,7 +76,8 @@ bool SubjectImpPrivate::attach(Subject& subject, const string& signal, const Slo
 bool SubjectImpPrivate::detach(Subject& subject, const string& signal, const Slot& slot)
 {
    bool success = true;
-   MapType::iterator pSlotVec = mSlots.find(signal);
+   const unsigned int signalId = getSignalId(signal, false);
+   MapType::iterator pSlotVec = mSlots.find(signalId);
    if (pSlotVec != mSlots.end())
    {
       list<SafeSlot>& slotVec = pSlotVec->second;
@@ -138,7 +139,7 @@ bool SubjectImpPrivate::detach(Subject& subject, const string& signal, const Slo
          }
       }
 
-      removeEmptySlots(signal, slotVec);
+      removeEmptySlots(signalId, slotVec);
    }
 
    return success;
@@ -147,7 +148,7 @@ bool SubjectImpPrivate::detach(Subject& subject, const string& signal, const Slo
 class PopRecursion
 {
 public:
-   PopRecursion(vector<string>& recursions, const string& recursion) : mRecursions(recursions) 
+   PopRecursion(vector<unsigned int>& recursions, unsigned int recursion) : mRecursions(recursions)
    {
       mRecursions.push_back(recursion);
    }
@@ -158,7 +159,7 @@ public:
 private:
    PopRecursion& operator=(const PopRecursion& rhs);
 
-   vector<string>& mRecursions;
+   vector<unsigned int>& mRecursions;
 };
 
 void SubjectImpPrivate::notify(Subject& subject, const string& signal, const string& originalSignal,
@@ -169,27 +170,57 @@ void SubjectImpPrivate::notify(Subject& subject, const string& signal, const str
       return;
    }
 
-   bool signalIsDeleted = false;
-   bool deletedFlagSet = false; // only want to do the signal name check if necessary
-   if (!mSignalsEnabled)
+   notify(subject, getSignalId(signal, false), signal, originalSignal, data);
+}
+
+void SubjectImpPrivate::notify(Subject& subject, unsigned int signalId, const string& signal,
+                               const string& originalSignal, const boost::any& data)
+{
+   if (!mSignalsEnabled && signalId != DELETED_ID)
+   {
+      return;
+   }
+
+   if (signalId == DELETED_ID)
+   {
+      // Deliver the batched signals first so that Deleted is always the last signal received
+      flushSignals(subject);
+   }
+   else if (mBatchDepth > 0)
    {
-      signalIsDeleted = (signal == SIGNAL_NAME(Subject, Deleted));
-      if (!signalIsDeleted)
+      if (signalId == INVALID_ID)
       {
-         return;
+         signalId = getSignalId(signal, true);
       }
-      deletedFlagSet = true;
+
+      queueSignal(signalId, signal, originalSignal, data);
+      return;
+   }
+
+   if (updateSlots(subject, signalId, signal, originalSignal, data) == false)
+   {
+      return;
    }
 
+   if (signalId != MODIFIED_ID && signalId != DELETED_ID)
+   {
+      const string& modifiedSignal = SIGNAL_NAME(Subject, Modified);
+      notify(subject, MODIFIED_ID, modifiedSignal, originalSignal + " as " + modifiedSignal, data);
+   }
+}
+
+bool SubjectImpPrivate::updateSlots(Subject& subject, unsigned int signalId, const string& signal,
+                                    const string& originalSignal, const boost::any& data)
+{
    // notify slots attached to signal
-   MapType::iterator pSlotVec = mSlots.find(signal);
+   MapType::iterator pSlotVec = mSlots.find(signalId);
    if (pSlotVec != mSlots.end())
    {
       list<SafeSlot>& slotVec = pSlotVec->second;
 
       if (!slotVec.empty())
       {
-         PopRecursion popper(mRecursions, signal);
+         PopRecursion popper(mRecursions, signalId);
 
          // Keep a (unique) vector of Slots which have been notified to ensure that no Slot is notified more than once
          // For efficiency, only check the vector when Slots have been added during notification
@@ -213,19 +244,71 @@ void SubjectImpPrivate::notify(Subject& subject, const string& signal, const str
             catch (boost::bad_any_cast &exc)
             {
                string msg = "Bad cast while calling processing signal " + originalSignal + "\n" + exc.what();
-               VERIFYNRV_MSG(false, msg.c_str());
+               VERIFY_MSG(false, msg.c_str());
             }
          }
       }
 
-      removeEmptySlots(signal, slotVec);
+      removeEmptySlots(signalId, slotVec);
+   }
+
+   return true;
+}
+
+void SubjectImpPrivate::queueSignal(unsigned int signalId, const string& signal, const string& originalSignal,
+                                    const boost::any& data)
+{
+   // Coalesce repeated signals into the position of the first notification, keeping the most recent data
+   for (size_t i = 0; i < mPendingSignals.size(); ++i)
+   {
+      PendingSignal& pending = mPendingSignals[i];
+      if (pending.mId == signalId)
+      {
+         pending.mOriginalSignal = originalSignal;
+         pending.mData = data;
+         mLastPendingSignal = i;
+         return;
+      }
+   }
+
+   PendingSignal pending;
+   pending.mId = signalId;
+   pending.mSignal = signal;
+   pending.mOriginalSignal = originalSignal;
+   pending.mData = data;
+   mPendingSignals.push_back(pending);
+   mLastPendingSignal = mPendingSignals.size() - 1;
+}
+
+void SubjectImpPrivate::flushSignals(Subject& subject)
+{
+   if (mPendingSignals.empty())
+   {
+      return;
+   }
+
+   // Slots may notify or start another batch while the pending signals are delivered
+   vector<PendingSignal> pendingSignals;
+   pendingSignals.swap(mPendingSignals);
+   const PendingSignal& lastSignal = pendingSignals[mLastPendingSignal];
+
+   const string& modifiedSignal = SIGNAL_NAME(Subject, Modified);
+   for (vector<PendingSignal>::const_iterator iter = pendingSignals.begin(); iter != pendingSignals.end(); ++iter)
+   {
+      if (iter->mId != MODIFIED_ID)
+      {
+         updateSlots(subject, iter->mId, iter->mSignal, iter->mOriginalSignal, iter->mData);
+      }
    }
 
-   if (signal != SIGNAL_NAME(Subject, Modified) && signal != SIGNAL_NAME(Subject, Deleted))
+   // Every batched signal implies Modified, so it is delivered exactly once after the other signals
+   string effectiveSignal = lastSignal.mOriginalSignal;
+   if (lastSignal.mId != MODIFIED_ID)
    {
-      string effectiveSignal = originalSignal + " as " + SIGNAL_NAME(Subject, Modified);
-      notify(subject, SIGNAL_NAME(Subject, Modified), effectiveSignal, data);
+      effectiveSignal += " as " + modifiedSignal;
    }
+
+   updateSlots(subject, MODIFIED_ID, modifiedSignal, effectiveSignal, lastSignal.mData);
 }
 
 const list<SafeSlot>& SubjectImpPrivate::getSlots(const string& signal)
@@ -237,11 +320,11 @@ const list<SafeSlot>& SubjectImpPrivate::getSlots(const string& signal)
       return emptyList;
    }
 
-   MapType::iterator pSlotVec = mSlots.find(signal);
+   MapType::iterator pSlotVec = mSlots.find(getSignalId(signal, false));
    if (pSlotVec != mSlots.end())
    {
       list<SafeSlot>& slotVec = pSlotVec->second;
-      removeEmptySlots(signal, slotVec);
+      removeEmptySlots(pSlotVec->first, slotVec);
       return slotVec;
    }
    else
@@ -250,9 +333,10 @@ const list<SafeSlot>& SubjectImpPrivate::getSlots(const string& signal)
    }
 }
 
-void SubjectImpPrivate::removeEmptySlots(const string& recursion, list<SafeSlot>& slotVec)
+void SubjectImpPrivate::removeEmptySlots(unsigned int recursion, list<SafeSlot>& slotVec)
 {
-   if (count(mRecursions.begin(), mRecursions.end(), recursion) == 0)
+   // Slots are only removed when the list is not being iterated by a notification
+   if (find(mRecursions.begin(), mRecursions.end(), recursion) == mRecursions.end())
    {
       for (list<SafeSlot>::iterator pSlot = slotVec.begin(); pSlot != slotVec.end(); )
       {
@@ -277,3 +361,61 @@ bool SubjectImpPrivate::signalsEnabled() const
 {
    return mSignalsEnabled;
 }
+
+void SubjectImpPrivate::beginSignalBatch()
+{
+   ++mBatchDepth;
+}
+
+void SubjectImpPrivate::endSignalBatch(Subject& subject)
+{
+   if (mBatchDepth == 0)
+   {
+      return;
+   }
+
+   if (--mBatchDepth == 0)
+   {
+      flushSignals(subject);
+   }
+}
+
+unsigned int SubjectImpPrivate::getSignalId(const string& signal, bool create)
+{
+   // The IDs belong to this Subject, so no lock is needed.  Modified and Deleted are usually
+   // notified with the names returned by SIGNAL_NAME, which can be recognized by address.
+   const string& modifiedSignal = SIGNAL_NAME(Subject, Modified);
+   const string& deletedSignal = SIGNAL_NAME(Subject, Deleted);
+   if (&signal == &modifiedSignal)
+   {
+      return MODIFIED_ID;
+   }
+   if (&signal == &deletedSignal)
+   {
+      return DELETED_ID;
+   }
+
+   map<string, unsigned int>::const_iterator iter = mSignalIds.find(signal);
+   if (iter != mSignalIds.end())
+   {
+      return iter->second;
+   }
+
+   if (signal == modifiedSignal)
+   {
+      return MODIFIED_ID;
+   }
+   if (signal == deletedSignal)
+   {
+      return DELETED_ID;
+   }
+
+   if (create == false)
+   {
+      return INVALID_ID;
+   }
+
+   unsigned int signalId = FIRST_SIGNAL_ID + static_cast<unsigned int>(mSignalIds.size());
+   mSignalIds[signal] = signalId;
+   return signalId;
+}
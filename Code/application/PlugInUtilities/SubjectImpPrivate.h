@@ -24,7 +24,7 @@ class Subject;
 
 class SubjectImpPrivate
 {
-   typedef std::map<std::string,std::list<SafeSlot> > MapType;
+   typedef std::map<unsigned int,std::list<SafeSlot> > MapType;
 
 public:
    SubjectImpPrivate();
@@ -34,15 +34,52 @@ public:
    void notify(Subject& subject, const std::string& signal, const std::string& originalSignal,
       const boost::any& data = boost::any());
    const std::list<SafeSlot>& getSlots(const std::string& signal);
-   void removeEmptySlots(const std::string& recursion, std::list<SafeSlot>& slotVec);
+   void removeEmptySlots(unsigned int recursion, std::list<SafeSlot>& slotVec);
    void enableSignals(bool enabled);
    bool signalsEnabled() const;
+   void beginSignalBatch();
+   void endSignalBatch(Subject& subject);
 
 private:
+   // Subject::Modified and Subject::Deleted have fixed IDs so they never need to be looked up
+   enum
+   {
+      MODIFIED_ID = 0,
+      DELETED_ID = 1,
+      FIRST_SIGNAL_ID = 2,
+      INVALID_ID = 0xffffffff
+   };
+
+   struct PendingSignal
+   {
+      unsigned int mId;
+      std::string mSignal;
+      std::string mOriginalSignal;
+      boost::any mData;
+   };
+
+   /**
+    *  Returns the integer ID used to dispatch a signal.  Names are only compared when
+    *  a signal enters the Subject, and every later step of the dispatch uses the ID.
+    *  Returns INVALID_ID if the signal has not been seen and \em create is \c false.
+    */
+   unsigned int getSignalId(const std::string& signal, bool create);
+   void notify(Subject& subject, unsigned int signalId, const std::string& signal,
+      const std::string& originalSignal, const boost::any& data);
+   bool updateSlots(Subject& subject, unsigned int signalId, const std::string& signal,
+      const std::string& originalSignal, const boost::any& data);
+   void queueSignal(unsigned int signalId, const std::string& signal, const std::string& originalSignal,
+      const boost::any& data);
+   void flushSignals(Subject& subject);
+
+   std::map<std::string, unsigned int> mSignalIds;
    MapType mSlots;
-   std::vector<std::string> mRecursions;
+   std::vector<unsigned int> mRecursions;
    Subject* mpSubject;
    bool mSignalsEnabled;
+   unsigned int mBatchDepth;
+   std::vector<PendingSignal> mPendingSignals;
+   size_t mLastPendingSignal;
 };
 
 #endif
@@ -10,6 +10,12 @@
 
 
 #include <assert.h>
+#include <errno.h>
+#if defined(WIN_API)
+#include <sys/timeb.h>
+#else
+#include <sys/time.h>
+#endif
 #include "bthread_signal.h"
 
 BThreadSignal::BThreadSignal()
@@ -61,6 +67,13 @@ bool BThreadSignal::ThreadSignalActivate()
    return true;
 }
 
+bool BThreadSignal::ThreadSignalBroadcast()
+{
+   assert (mThreadSignalID != NULL);
+   pthread_cond_broadcast(mThreadSignalID);
+   return true;
+}
+
 bool BThreadSignal::ThreadSignalWait(void *mutexData)
 {
    assert (mThreadSignalID != NULL);
@@ -72,3 +85,28 @@ bool BThreadSignal::ThreadSignalWait(void *mutexData)
 
    return true;
 }
+
+bool BThreadSignal::ThreadSignalTimedWait(void *mutexData, unsigned int milliseconds)
+{
+   assert (mThreadSignalID != NULL);
+   assert (mutexData != NULL);
+   BMutex *data = (BMutex *) mutexData;
+
+   struct timespec timeout;
+#if defined(WIN_API)
+   struct _timeb now;
+   _ftime(&now);
+   timeout.tv_sec = static_cast<long>(now.time);
+   long nanoseconds = static_cast<long>(now.millitm) * 1000000L;
+#else
+   struct timeval now;
+   gettimeofday(&now, NULL);
+   timeout.tv_sec = now.tv_sec;
+   long nanoseconds = static_cast<long>(now.tv_usec) * 1000L;
+#endif
+   nanoseconds += static_cast<long>(milliseconds % 1000) * 1000000L;
+   timeout.tv_sec += milliseconds / 1000 + nanoseconds / 1000000000L;
+   timeout.tv_nsec = nanoseconds % 1000000000L;
+
+   return pthread_cond_timedwait(mThreadSignalID, data->GetMutexID(), &timeout) != ETIMEDOUT;
+}
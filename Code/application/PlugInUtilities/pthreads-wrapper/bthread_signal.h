@@ -22,6 +22,23 @@ class BThreadSignal : public ThreadSignal
       virtual bool ThreadSignalInit();
       virtual bool ThreadSignalDestroy();
       virtual bool ThreadSignalWait(void *mutexData);
+      /**
+       * Wait for the signal or for a time limit to pass, whichever is first.
+       *
+       * @param mutexData
+       *          the locked BMutex which is released while waiting
+       * @param milliseconds
+       *          the longest time to wait
+       *
+       * @return true if the signal was activated, false if the time limit passed
+       */
+      bool ThreadSignalTimedWait(void *mutexData, unsigned int milliseconds);
+      /**
+       * Wake every thread waiting for the signal.
+       *
+       * @return true if successful, false otherwise
+       */
+      bool ThreadSignalBroadcast();
       virtual bool ThreadSignalActivate();
 
    private:
@@ -7,7 +7,10 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
+#include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QStringList>
 
@@ -29,6 +32,7 @@
 
 #include <algorithm>
 #include <list>
+#include <sstream>
 #include <utility>
 using namespace std;
 
@@ -79,6 +83,214 @@ public:
    string mName;
 };
 
+namespace
+{
+   // The number of leading bytes read from a file to identify its contents
+   const qint64 SNIFF_SIZE = 4096;
+
+   // FNV-1a hash
+   unsigned int hashBytes(const char* pData, size_t size, unsigned int hash = 2166136261U)
+   {
+      for (size_t i = 0; i < size; ++i)
+      {
+         hash ^= static_cast<unsigned char>(pData[i]);
+         hash *= 16777619U;
+      }
+
+      return hash;
+   }
+
+   // The detection cache is kept in its own file rather than in a setting, since modifying a
+   // setting invalidates the cached values of every other setting
+   string getCacheFilePath()
+   {
+      return Service<ConfigurationSettings>()->getUserStorageFilePath("AutoImporterDetectionCache", "txt");
+   }
+
+   vector<string> readCacheEntries()
+   {
+      vector<string> entries;
+
+      QFile cacheFile(QString::fromStdString(getCacheFilePath()));
+      if (cacheFile.open(QIODevice::ReadOnly) == true)
+      {
+         while (cacheFile.atEnd() == false)
+         {
+            QByteArray line = cacheFile.readLine().trimmed();
+            if (line.isEmpty() == false)
+            {
+               entries.push_back(string(line.constData(), line.size()));
+            }
+         }
+      }
+
+      return entries;
+   }
+
+   void writeCacheEntries(const vector<string>& entries)
+   {
+      string cacheFilePath = getCacheFilePath();
+      if (cacheFilePath.empty() == true)
+      {
+         return;
+      }
+
+      QFile cacheFile(QString::fromStdString(cacheFilePath));
+      if (cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate) == true)
+      {
+         for (vector<string>::const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
+         {
+            cacheFile.write(iter->c_str(), iter->size());
+            cacheFile.write("\n", 1);
+         }
+      }
+   }
+
+   /**
+    * Identifies a file in the detection cache.
+    *
+    * A cache entry is only used when the file and the files next to it which share its base name,
+    * such as an ENVI header, have the same sizes and modification times as when the entry was
+    * stored.  The leading bytes of the file and the available importers must also be the same.
+    */
+   class DetectionKey
+   {
+   public:
+      DetectionKey(const string& filename, const vector<PlugInDescriptor*>& importers)
+      {
+         if (AutoImporter::getSettingDetectionCacheSize() == 0)
+         {
+            return;
+         }
+
+         QFileInfo fileInfo(QString::fromStdString(filename));
+         if (fileInfo.isFile() == false)
+         {
+            return;
+         }
+
+         // The leading bytes are read once for all importers, so the header reads
+         // made by the importers are served from the file system cache
+         QFile file(fileInfo.absoluteFilePath());
+         if (file.open(QIODevice::ReadOnly) == false)
+         {
+            return;
+         }
+
+         QByteArray sniffBuffer = file.read(SNIFF_SIZE);
+         file.close();
+
+         // Importers may read companion files, such as a header next to a raw data file
+         QStringList nameFilters;
+         nameFilters << fileInfo.baseName() << fileInfo.baseName() + ".*";
+         QFileInfoList companions = fileInfo.absoluteDir().entryInfoList(nameFilters, QDir::Files, QDir::Name);
+
+         unsigned int companionHash = hashBytes(NULL, 0);
+         for (QFileInfoList::const_iterator iter = companions.begin(); iter != companions.end(); ++iter)
+         {
+            if (iter->fileName() != fileInfo.fileName())
+            {
+               stringstream companion;
+               companion << iter->fileName().toStdString() << "\n" << iter->size() << "\n" <<
+                  iter->lastModified().toTime_t() << "\n";
+               companionHash = hashBytes(companion.str().c_str(), companion.str().size(), companionHash);
+            }
+         }
+
+         vector<string> importerVersions;
+         for (vector<PlugInDescriptor*>::const_iterator iter = importers.begin(); iter != importers.end(); ++iter)
+         {
+            if (*iter != NULL)
+            {
+               importerVersions.push_back((*iter)->getName() + "\n" + (*iter)->getVersion() + "\n");
+            }
+         }
+
+         sort(importerVersions.begin(), importerVersions.end());
+         unsigned int importerHash = hashBytes(NULL, 0);
+         for (vector<string>::const_iterator iter = importerVersions.begin(); iter != importerVersions.end(); ++iter)
+         {
+            importerHash = hashBytes(iter->c_str(), iter->size(), importerHash);
+         }
+
+         mPath = fileInfo.absoluteFilePath().toStdString() + "\t";
+
+         stringstream prefix;
+         prefix << mPath << fileInfo.size() << "\t" << fileInfo.lastModified().toTime_t() << "\t" << hex <<
+            hashBytes(sniffBuffer.constData(), sniffBuffer.size()) << "\t" << companionHash << "\t" <<
+            importerHash << "\t";
+         mPrefix = prefix.str();
+      }
+
+      bool lookup(string& importerName, unsigned char& affinity) const
+      {
+         if (mPrefix.empty() == true)
+         {
+            return false;
+         }
+
+         const vector<string> entries = readCacheEntries();
+         for (vector<string>::const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
+         {
+            if (iter->compare(0, mPrefix.size(), mPrefix) == 0)
+            {
+               stringstream entry(iter->substr(mPrefix.size()));
+               unsigned int entryAffinity = 0;
+               entry >> entryAffinity;
+               if (entry.get() != '\t' || entryAffinity == Importer::CAN_NOT_LOAD || entryAffinity > 255)
+               {
+                  return false;
+               }
+
+               getline(entry, importerName);
+               affinity = static_cast<unsigned char>(entryAffinity);
+               return importerName.empty() == false;
+            }
+         }
+
+         return false;
+      }
+
+      void store(const string& importerName, unsigned char affinity) const
+      {
+         if (mPrefix.empty() == true)
+         {
+            return;
+         }
+
+         // Remove any entries for a previous version of the file
+         vector<string> entries = readCacheEntries();
+         for (vector<string>::iterator iter = entries.begin(); iter != entries.end();)
+         {
+            if (iter->compare(0, mPath.size(), mPath) == 0)
+            {
+               iter = entries.erase(iter);
+            }
+            else
+            {
+               ++iter;
+            }
+         }
+
+         stringstream entry;
+         entry << mPrefix << static_cast<unsigned int>(affinity) << "\t" << importerName;
+         entries.insert(entries.begin(), entry.str());
+
+         unsigned int cacheSize = AutoImporter::getSettingDetectionCacheSize();
+         if (entries.size() > cacheSize)
+         {
+            entries.resize(cacheSize);
+         }
+
+         writeCacheEntries(entries);
+      }
+
+   private:
+      string mPath;
+      string mPrefix;
+   };
+}
+
 string AutoImporter::getDefaultExtensions() const
 {
    static string sDefaultExtensions = "";
@@ -619,6 +831,21 @@ Importer* AutoImporter::findImporter(const string& filename)
       remove_if(importers.begin(), importers.end(), FindDescriptor(getName()));
    importers.erase(newEnd, importers.end());
 
+   // Use the importer found when the file was last opened if neither the file nor the importers have changed
+   DetectionKey key(filename, importers);
+   string cachedName;
+   unsigned char cachedAffinity = Importer::CAN_NOT_LOAD;
+   if (key.lookup(cachedName, cachedAffinity) == true)
+   {
+      PlugIn* pCachedPlugIn = getPlugIn(cachedName);
+      if (dynamic_cast<Importer*>(pCachedPlugIn) != NULL)
+      {
+         mpPlugIn = pCachedPlugIn;
+         mFilenames[filename] = make_pair(cachedName, cachedAffinity);
+         return dynamic_cast<Importer*>(mpPlugIn);
+      }
+   }
+
    // Check importers first based on file extension
    list<PlugInDescriptor*> remainingImporters;
    PlugIn* pPlugIn = NULL;
@@ -634,24 +861,7 @@ Importer* AutoImporter::findImporter(const string& filename)
 
       if (checkExtension(pDescriptor, filename))
       {
-         PlugIn* pCurrentPlugIn = NULL;
-         const string& plugInName = pDescriptor->getName();
-
-         map<string, PlugIn*>::iterator plugInIter = mPlugIns.find(plugInName);
-         if (plugInIter != mPlugIns.end())
-         {
-            pCurrentPlugIn = plugInIter->second;
-         }
-         else
-         {
-            PlugInResource pImporterRes(plugInName);
-            pCurrentPlugIn = pImporterRes.release();
-            if (pCurrentPlugIn != NULL)
-            {
-               mPlugIns[plugInName] = pCurrentPlugIn;
-            }
-         }
-
+         PlugIn* pCurrentPlugIn = getPlugIn(pDescriptor->getName());
          Importer* pImporter = dynamic_cast<Importer*>(pCurrentPlugIn);
          if (pImporter != NULL)
          {
@@ -673,6 +883,7 @@ Importer* AutoImporter::findImporter(const string& filename)
    {
       mpPlugIn = pPlugIn;
       mFilenames[filename] = make_pair(mpPlugIn->getName(), maxFileAffinity);
+      key.store(mpPlugIn->getName(), maxFileAffinity);
       return dynamic_cast<Importer*>(mpPlugIn);
    }
 
@@ -685,24 +896,7 @@ Importer* AutoImporter::findImporter(const string& filename)
          continue;
       }
 
-      PlugIn* pCurrentPlugIn = NULL;
-      const string& plugInName = pDescriptor->getName();
-
-      map<string, PlugIn*>::iterator plugInIter = mPlugIns.find(plugInName);
-      if (plugInIter != mPlugIns.end())
-      {
-         pCurrentPlugIn = plugInIter->second;
-      }
-      else
-      {
-         PlugInResource pImporterRes(plugInName);
-         pCurrentPlugIn = pImporterRes.release();
-         if (pCurrentPlugIn != NULL)
-         {
-            mPlugIns[plugInName] = pCurrentPlugIn;
-         }
-      }
-
+      PlugIn* pCurrentPlugIn = getPlugIn(pDescriptor->getName());
       Importer* pImporter = dynamic_cast<Importer*>(pCurrentPlugIn);
       if (pImporter != NULL)
       {
@@ -720,8 +914,27 @@ Importer* AutoImporter::findImporter(const string& filename)
    {
       mpPlugIn = pPlugIn;
       mFilenames[filename] = make_pair(mpPlugIn->getName(), maxFileAffinity);
+      key.store(mpPlugIn->getName(), maxFileAffinity);
       return dynamic_cast<Importer*>(mpPlugIn);
    }
 
    return NULL;
 }
+
+PlugIn* AutoImporter::getPlugIn(const string& plugInName)
+{
+   map<string, PlugIn*>::iterator plugInIter = mPlugIns.find(plugInName);
+   if (plugInIter != mPlugIns.end())
+   {
+      return plugInIter->second;
+   }
+
+   PlugInResource pImporterRes(plugInName);
+   PlugIn* pPlugIn = pImporterRes.release();
+   if (pPlugIn != NULL)
+   {
+      mPlugIns[plugInName] = pPlugIn;
+   }
+
+   return pPlugIn;
+}
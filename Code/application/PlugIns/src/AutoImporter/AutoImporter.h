@@ -10,6 +10,7 @@
 #ifndef AUTOIMPORTER_H
 #define AUTOIMPORTER_H
 
+#include "ConfigurationSettings.h"
 #include "ImporterShell.h"
 #include "PlugInManagerServices.h"
 
@@ -25,6 +26,8 @@ class Progress;
 class AutoImporter : public ImporterShell
 {
 public:
+   SETTING(DetectionCacheSize, AutoImporter, unsigned int, 100)
+
    AutoImporter();
    ~AutoImporter();
 
@@ -51,6 +54,7 @@ protected:
    bool checkExtension(const PlugInDescriptor* pDescriptor, const std::string& filename) const;
    Importer* findImporter(const DataDescriptor* pDescriptor);
    Importer* findImporter(const std::string& filename);
+   PlugIn* getPlugIn(const std::string& plugInName);
 
 private:
    bool mbInteractive;
@@ -709,7 +709,8 @@ bool BandMath::createReturnValue(string partialResultsName)
       pParent = mpCube;
    }
    RasterElement* pRaster = RasterUtilities::createRasterElement(mResultsName, origRows.size(),
-      origColumns.size(), bandCount, FLT4BYTES, BIP, pOrigDescriptor->getProcessingLocation() == IN_MEMORY, pParent);
+      origColumns.size(), bandCount, FLT4BYTES,
+      RasterUtilities::getResultProcessingLocation(pOrigDescriptor->getProcessingLocation()), BIP, pParent);
 
    if (pRaster == NULL)
    {
@@ -128,8 +128,9 @@ bool ConvolutionFilterShell::execute(PlugInArgList* pInArgList, PlugInArgList* p
 
    ModelResource<RasterElement> pResult(RasterUtilities::createRasterElement(
       mResultName, iterChecker.getNumSelectedRows(), iterChecker.getNumSelectedColumns(),
-      mInput.mBands.size(), resultType, mInput.mpDescriptor->getInterleaveFormat(),
-      mInput.mpDescriptor->getProcessingLocation() == IN_MEMORY));
+      mInput.mBands.size(), resultType,
+      RasterUtilities::getResultProcessingLocation(mInput.mpDescriptor->getProcessingLocation()),
+      mInput.mpDescriptor->getInterleaveFormat()));
    pResult->copyClassification(mInput.mpRaster);
    pResult->getMetadata()->merge(mInput.mpDescriptor->getMetadata()); //copy original metadata
    //chip metadata by bands
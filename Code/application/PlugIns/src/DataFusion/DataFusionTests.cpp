@@ -27,8 +27,10 @@
 #include "RasterElement.h"
 #include "TestUtilities.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <math.h>
 #include <string>
 #if defined(UNIX_API)
 #include <unistd.h>
@@ -417,6 +419,7 @@ Poly2DTests::Poly2DTests(ostream& output, ProgressTracker& tracker) : Test(outpu
    mStages.push_back(ProgressTracker::Stage("Positive Scale Test", "app", "E1758988-7DB9-4efe-AA73-A98F3DA35A01", 20));
    mStages.push_back(ProgressTracker::Stage("Positive Shift And Scale Test", "app",
                                             "C4D0A1F5-4040-4bb4-AE14-0FCC3DA4E081", 20));
+   mStages.push_back(ProgressTracker::Stage("Block Warp Test", "app", "6F1D2B84-9C3E-4A57-B0D8-2E7C5A91F346", 20));
 }
 
 bool Poly2DTests::run(double pause)
@@ -440,6 +443,11 @@ bool Poly2DTests::run(double pause)
       sleep(pause);
       bSuccess = positiveShiftAndScaleTest();
    }
+   if (bSuccess)
+   {
+      sleep(pause);
+      bSuccess = blockWarpTest();
+   }
    sleep(pause);
    return bSuccess;
 }
@@ -940,6 +948,105 @@ bool Poly2DTests::positiveShiftAndScaleTest()
    return bSuccess;
 }
 
+bool Poly2DTests::blockWarpTest()
+{
+   Vector<double> kX(4);
+   Vector<double> kY(4);
+
+   //POLY2D TEST 5 - Rotation, scale and shear over several blocks, compared to the exact per-pixel mapping
+   kX[0] = 4.3;
+   kX[1] = 0.12;
+   kX[2] = 0.93;
+   kX[3] = 0.0007;
+
+   kY[0] = 2.6;
+   kY[1] = 0.95;
+   kY[2] = -0.08;
+   kY[3] = 0.0004;
+
+   const unsigned int newx = 200;
+   const unsigned int newy = 150;
+   const unsigned int nx = 230;
+   const unsigned int ny = 190;
+
+   ModelResource<RasterElement> pInput(RasterUtilities::createRasterElement("BlockWarpInput", ny, nx, FLT8BYTES));
+   ModelResource<RasterElement> pExpected(RasterUtilities::createRasterElement("BlockWarpExpected",
+      newy, newx, FLT8BYTES));
+   VERIFY(pInput.get() != NULL && pExpected.get() != NULL);
+
+   double* pInputData = static_cast<double*>(pInput->getRawData());
+   VERIFY(pInputData != NULL);
+   for (unsigned int row = 0; row < ny; ++row)
+   {
+      for (unsigned int col = 0; col < nx; ++col)
+      {
+         pInputData[row * nx + col] = 50.0 * sin(col / 7.0) + 30.0 * cos(row / 11.0) + row;
+      }
+   }
+
+   double* pExpectedData = static_cast<double*>(pExpected->getRawData());
+   VERIFY(pExpectedData != NULL);
+   for (unsigned int y = 0; y < newy; ++y)
+   {
+      for (unsigned int x = 0; x < newx; ++x)
+      {
+         const double xPrime = kX[0] + kX[1]*y + kX[2]*x + kX[3]*x*y;
+         const double yPrime = kY[0] + kY[1]*y + kY[2]*x + kY[3]*x*y;
+         const double x1 = floor(xPrime);
+         const double y1 = floor(yPrime);
+         double& value = pExpectedData[y * newx + x];
+         if (x1 < 0 || y1 < 0 || x1 > nx - 1 || y1 > ny - 1)
+         {
+            value = 0.0;
+            continue;
+         }
+
+         const unsigned int col1 = static_cast<unsigned int>(x1);
+         const unsigned int row1 = static_cast<unsigned int>(y1);
+         const unsigned int col2 = min(col1 + 1, nx - 1);
+         const unsigned int row2 = min(row1 + 1, ny - 1);
+         const double u = xPrime - x1;
+         const double v = yPrime - y1;
+         value = pInputData[row1 * nx + col1] * (1.0 - u) * (1.0 - v) + pInputData[row1 * nx + col2] * u * (1.0 - v) +
+            pInputData[row2 * nx + col1] * (1.0 - u) * v + pInputData[row2 * nx + col2] * u * v;
+      }
+   }
+
+   // Check both the interpolated mapping and the exact mapping of each row
+   bool bSuccess = true;
+   const double mappingErrors[] = { POLY2D_DEFAULT_MAPPING_ERROR, 0.0 };
+   for (int i = 0; i < 2 && bSuccess; ++i)
+   {
+      string msg = "Poly2d-5: Poly2d failed!";
+      ModelResource<RasterElement> pOutput(reinterpret_cast<RasterElement*>(NULL));
+      try
+      {
+         pOutput = ModelResource<RasterElement>(poly_2D<double>(
+            NULL, pInput.get(), kX, kY, newx, newy, 0, 0, 1, mProgressTracker, true, mappingErrors[i]));
+      }
+      catch (AssertException& exc)
+      {
+         msg = msg + " Cause: " + exc.getText();
+      }
+      catch (FusionException& exc)
+      {
+         msg = msg + " Cause: " + exc.toString();
+      }
+
+      if (pOutput.get() == NULL)
+      {
+         mOutputStream << msg << endl;
+         mProgressTracker.report(msg, 100, WARNING);
+         return false;
+      }
+
+      bSuccess = verifyMatrix(myStage.getActiveStage(), pOutput.get(), pExpected.get(), "Poly2d-5");
+   }
+
+   mProgressTracker.nextStage();
+   return bSuccess;
+}
+
 bool DataFusion::runOperationalTests(Progress* progress, ostream& failure)
 {
    return true;
@@ -85,6 +85,7 @@ public:
    bool positiveShiftTest();
    bool positiveScaleTest();
    bool positiveShiftAndScaleTest();
+   bool blockWarpTest();
 
    bool runTest(std::string inputFile, std::string outputFile, std::string testName,
                 const Vector<double>& kX, const Vector<double>& kY,
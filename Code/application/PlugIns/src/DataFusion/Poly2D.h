@@ -13,9 +13,13 @@
 #include "AppAssert.h"
 #include "DataAccessor.h"
 #include "DataAccessorImpl.h"
+#include "DataFusionTools.h"
+#include "DataRequest.h"
 #include "FusionException.h"
 #include "DimensionDescriptor.h"
 #include "ModelServices.h"
+#include "MultiThreadedAlgorithm.h"
+#include "ObjectResource.h"
 #include "ProgressTracker.h"
 #include "RasterDataDescriptor.h"
 #include "RasterElement.h"
@@ -23,8 +27,420 @@
 #include "Statistics.h"
 #include "Vector.h"
 
+#include <algorithm>
 #include <math.h>
 #include <string>
+#include <vector>
+
+/**
+ * The warp is computed in square blocks of this many output pixels, which are processed in parallel.
+ */
+const unsigned int POLY2D_BLOCK_SIZE = 64;
+
+/**
+ * The default largest difference, in secondary image pixels, between the exact polynomial mapping
+ * and the mapping interpolated from the corners of a block.
+ */
+const double POLY2D_DEFAULT_MAPPING_ERROR = 0.01;
+
+struct Poly2DInput
+{
+   RasterElement* mpSource;
+   RasterElement* mpResult;
+   const Vector<double>* mpKX;
+   const Vector<double>* mpKY;
+   unsigned int mSourceColumns;
+   unsigned int mSourceRows;
+   unsigned int mColumns;
+   unsigned int mRows;
+   unsigned int mBlockColumns;
+   unsigned int mBlockCount;
+   int mColumnOffset;
+   int mRowOffset;
+   double mMaxMappingError;
+};
+
+/**
+ * Maps output pixels into the secondary image.
+ *
+ * The mapping of a block is bilinearly interpolated from the exact mapping at its corners when the
+ * interpolation is within the error bound at the center and edge midpoints of the block. Otherwise, the
+ * exact mapping is evaluated at the start of each row. Either way, the mapping is advanced along a row by
+ * forward differencing.
+ */
+class Poly2DMapping
+{
+public:
+   Poly2DMapping(const Poly2DInput& input) :
+      mInput(input),
+      mInterpolate(false)
+   {}
+
+   double mapX(double column, double row) const
+   {
+      const Vector<double>& KX = *mInput.mpKX;
+      const double XNEW = column + mInput.mColumnOffset;
+      const double YNEW = row + mInput.mRowOffset;
+      return KX[0] + KX[1]*YNEW + KX[2]*XNEW + KX[3]*XNEW*YNEW;
+   }
+
+   double mapY(double column, double row) const
+   {
+      const Vector<double>& KY = *mInput.mpKY;
+      const double XNEW = column + mInput.mColumnOffset;
+      const double YNEW = row + mInput.mRowOffset;
+      return KY[0] + KY[1]*YNEW + KY[2]*XNEW + KY[3]*XNEW*YNEW;
+   }
+
+   void setBlock(int firstColumn, int lastColumn, int firstRow, int lastRow)
+   {
+      mFirstColumn = firstColumn;
+      mFirstRow = firstRow;
+      mWidth = std::max(lastColumn - firstColumn, 1);
+      mHeight = std::max(lastRow - firstRow, 1);
+      const int columns[] = { firstColumn, lastColumn, firstColumn, lastColumn };
+      const int rows[] = { firstRow, firstRow, lastRow, lastRow };
+      for (int i = 0; i < 4; ++i)
+      {
+         mCornerX[i] = mapX(columns[i], rows[i]);
+         mCornerY[i] = mapY(columns[i], rows[i]);
+      }
+
+      mInterpolate = true;
+      const double midColumn = (firstColumn + lastColumn) / 2.0;
+      const double midRow = (firstRow + lastRow) / 2.0;
+      const double testColumns[] = { midColumn, midColumn, midColumn, firstColumn, lastColumn };
+      const double testRows[] = { midRow, firstRow, lastRow, midRow, midRow };
+      for (int i = 0; i < 5 && mInterpolate; ++i)
+      {
+         double x = 0.0;
+         double y = 0.0;
+         interpolate(testColumns[i], testRows[i], x, y);
+         mInterpolate = fabs(x - mapX(testColumns[i], testRows[i])) <= mInput.mMaxMappingError &&
+            fabs(y - mapY(testColumns[i], testRows[i])) <= mInput.mMaxMappingError;
+      }
+   }
+
+   /**
+    * Gets the mapping of the first pixel of a row of the block and the change in the mapping
+    * from each pixel to the next.
+    */
+   void getRow(int row, double& x, double& y, double& stepX, double& stepY) const
+   {
+      if (mInterpolate)
+      {
+         double endX = 0.0;
+         double endY = 0.0;
+         interpolate(mFirstColumn, row, x, y);
+         interpolate(mFirstColumn + mWidth, row, endX, endY);
+         stepX = (endX - x) / mWidth;
+         stepY = (endY - y) / mWidth;
+      }
+      else
+      {
+         x = mapX(mFirstColumn, row);
+         y = mapY(mFirstColumn, row);
+         stepX = (*mInput.mpKX)[2] + (*mInput.mpKX)[3] * (row + mInput.mRowOffset);
+         stepY = (*mInput.mpKY)[2] + (*mInput.mpKY)[3] * (row + mInput.mRowOffset);
+      }
+   }
+
+private:
+   Poly2DMapping& operator=(const Poly2DMapping& rhs);
+
+   void interpolate(double column, double row, double& x, double& y) const
+   {
+      const double u = (column - mFirstColumn) / mWidth;
+      const double v = (row - mFirstRow) / mHeight;
+      x = (mCornerX[0] * (1.0 - u) + mCornerX[1] * u) * (1.0 - v) + (mCornerX[2] * (1.0 - u) + mCornerX[3] * u) * v;
+      y = (mCornerY[0] * (1.0 - u) + mCornerY[1] * u) * (1.0 - v) + (mCornerY[2] * (1.0 - u) + mCornerY[3] * u) * v;
+   }
+
+   const Poly2DInput& mInput;
+   bool mInterpolate;
+   int mFirstColumn;
+   int mFirstRow;
+   int mWidth;
+   int mHeight;
+   double mCornerX[4];
+   double mCornerY[4];
+};
+
+/**
+ * Warps blocks of the output.  The window of the secondary image which a block maps into
+ * is read once and the pixels are interpolated from it.
+ */
+template<class T>
+class Poly2DThread : public mta::AlgorithmThread
+{
+public:
+   Poly2DThread(const Poly2DInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+      mta::AlgorithmThread(threadIndex, reporter),
+      mBadValues(0.0),
+      mInput(input),
+      mThreadCount(threadCount),
+      mMapping(input)
+   {}
+
+   void run()
+   {
+      mta::AlgorithmThread::Range range;
+      while (getNextRange(mThreadCount, static_cast<int>(mInput.mBlockCount), range))
+      {
+         int oldPercentDone = -1;
+         for (int block = range.mFirst; block <= range.mLast; ++block)
+         {
+            if (DataFusionTools::getAbortFlag())
+            {
+               return;
+            }
+
+            if (processBlock(block) == false)
+            {
+               return;
+            }
+
+            int percentDone = range.computePercent(block);
+            if (percentDone > oldPercentDone)
+            {
+               oldPercentDone = percentDone;
+               getReporter().reportProgress(getThreadIndex(), percentDone);
+            }
+         }
+      }
+   }
+
+   double mBadValues;
+
+private:
+   Poly2DThread& operator=(const Poly2DThread& rhs);
+
+   static DataAccessor getAccessor(RasterElement* pElement, int firstRow, int lastRow,
+      int firstColumn, int lastColumn, bool writable)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      VERIFYRV(pDescriptor != NULL, DataAccessor(NULL, NULL));
+
+      FactoryResource<DataRequest> pRequest;
+      pRequest->setInterleaveFormat(BSQ);
+      pRequest->setRows(pDescriptor->getActiveRow(firstRow), pDescriptor->getActiveRow(lastRow),
+         lastRow - firstRow + 1);
+      pRequest->setColumns(pDescriptor->getActiveColumn(firstColumn), pDescriptor->getActiveColumn(lastColumn),
+         lastColumn - firstColumn + 1);
+      pRequest->setBands(pDescriptor->getActiveBand(0), pDescriptor->getActiveBand(0), 1);
+      pRequest->setWritable(writable);
+      return pElement->getDataAccessor(pRequest.release());
+   }
+
+   // Reads the window of the secondary image used by the block, which is empty if the block maps
+   // outside of the secondary image.  Returns false if the secondary image cannot be read.
+   bool readWindow(int firstColumn, int lastColumn, int firstRow, int lastRow, bool& hasWindow)
+   {
+      hasWindow = false;
+      // bilinear mappings take their extremes at the corners of the block
+      double minX = mMapping.mapX(firstColumn, firstRow);
+      double maxX = minX;
+      double minY = mMapping.mapY(firstColumn, firstRow);
+      double maxY = minY;
+      for (int row = firstRow; row <= lastRow; ++row)
+      {
+         double x = 0.0;
+         double y = 0.0;
+         double stepX = 0.0;
+         double stepY = 0.0;
+         mMapping.getRow(row, x, y, stepX, stepY);
+         const double endX = x + stepX * (lastColumn - firstColumn);
+         const double endY = y + stepY * (lastColumn - firstColumn);
+         minX = std::min(minX, std::min(x, endX));
+         maxX = std::max(maxX, std::max(x, endX));
+         minY = std::min(minY, std::min(y, endY));
+         maxY = std::max(maxY, std::max(y, endY));
+      }
+
+      const int sourceColumns = static_cast<int>(mInput.mSourceColumns);
+      const int sourceRows = static_cast<int>(mInput.mSourceRows);
+      if (maxX < 0.0 || maxY < 0.0 || minX >= sourceColumns || minY >= sourceRows)
+      {
+         return true;
+      }
+
+      // allow a pixel for rounding in the forward differences in addition to the interpolation neighbor
+      mWindowFirstColumn = std::max(static_cast<int>(floor(std::max(minX, 0.0))) - 1, 0);
+      mWindowLastColumn = std::min(static_cast<int>(floor(std::min(maxX, sourceColumns - 1.0))) + 2, sourceColumns - 1);
+      mWindowFirstRow = std::max(static_cast<int>(floor(std::max(minY, 0.0))) - 1, 0);
+      mWindowLastRow = std::min(static_cast<int>(floor(std::min(maxY, sourceRows - 1.0))) + 2, sourceRows - 1);
+      mWindowColumns = mWindowLastColumn - mWindowFirstColumn + 1;
+
+      DataAccessor sourceAccessor = getAccessor(mInput.mpSource, mWindowFirstRow, mWindowLastRow,
+         mWindowFirstColumn, mWindowLastColumn, false);
+      mWindow.resize(static_cast<size_t>(mWindowColumns) * (mWindowLastRow - mWindowFirstRow + 1));
+      for (int row = mWindowFirstRow; row <= mWindowLastRow; ++row)
+      {
+         if (sourceAccessor.isValid() == false)
+         {
+            return false;
+         }
+
+         memcpy(&mWindow[(row - mWindowFirstRow) * mWindowColumns], sourceAccessor->getRow(),
+            mWindowColumns * sizeof(T));
+         sourceAccessor->nextRow();
+      }
+
+      hasWindow = true;
+      return true;
+   }
+
+   // Gets a pixel of the secondary image, reading it directly if it is outside of the window
+   T getPixel(int row, int column, DataAccessor& sourceAccessor)
+   {
+      if (row >= mWindowFirstRow && row <= mWindowLastRow && column >= mWindowFirstColumn &&
+         column <= mWindowLastColumn)
+      {
+         return mWindow[(row - mWindowFirstRow) * mWindowColumns + column - mWindowFirstColumn];
+      }
+
+      if (sourceAccessor.isValid() == false)
+      {
+         sourceAccessor = getAccessor(mInput.mpSource, 0, mInput.mSourceRows - 1, 0, mInput.mSourceColumns - 1,
+            false);
+      }
+
+      sourceAccessor->toPixel(row, column);
+      VERIFYRV(sourceAccessor.isValid(), 0);
+      return *reinterpret_cast<T*>(sourceAccessor->getColumn());
+   }
+
+   bool processBlock(int block)
+   {
+      const T BAD_VALUE = 0;
+      const int firstRow = (block / mInput.mBlockColumns) * POLY2D_BLOCK_SIZE;
+      const int firstColumn = (block % mInput.mBlockColumns) * POLY2D_BLOCK_SIZE;
+      const int lastRow = static_cast<int>(std::min(firstRow + POLY2D_BLOCK_SIZE, mInput.mRows)) - 1;
+      const int lastColumn = static_cast<int>(std::min(firstColumn + POLY2D_BLOCK_SIZE, mInput.mColumns)) - 1;
+      const unsigned int nx = mInput.mSourceColumns;
+      const unsigned int ny = mInput.mSourceRows;
+
+      mMapping.setBlock(firstColumn, lastColumn, firstRow, lastRow);
+      bool hasWindow = false;
+      if (readWindow(firstColumn, lastColumn, firstRow, lastRow, hasWindow) == false)
+      {
+         getReporter().reportError("Cannot read the secondary image!");
+         return false;
+      }
+
+      DataAccessor sourceAccessor(NULL, NULL);
+      DataAccessor resultAccessor = getAccessor(mInput.mpResult, firstRow, lastRow, firstColumn, lastColumn, true);
+      for (int y = firstRow; y <= lastRow; ++y)
+      {
+         resultAccessor->toPixel(y, firstColumn);
+         if (resultAccessor.isValid() == false)
+         {
+            getReporter().reportError("Cannot access the warped image!");
+            return false;
+         }
+
+         T* results = reinterpret_cast<T*>(resultAccessor->getColumn());
+         double x_prime = 0.0;
+         double y_prime = 0.0;
+         double stepX = 0.0;
+         double stepY = 0.0;
+         mMapping.getRow(y, x_prime, y_prime, stepX, stepY);
+         for (int x = 0; x <= lastColumn - firstColumn; ++x, x_prime += stepX, y_prime += stepY)
+         {
+            const double x1 = floor(x_prime);
+            const double y1 = floor(y_prime);
+
+            // Handle out of bounds case
+            if (hasWindow == false || (x1 > (nx-1)) || (y1 > (ny-1)) || (x1 < 0) || (y1 < 0))
+            {
+               mBadValues++;
+               results[x] = BAD_VALUE;
+               continue;
+            }
+
+            // bilinear interpolation
+            const int column1 = static_cast<int>(x1);
+            const int row1 = static_cast<int>(y1);
+            const int column2 = std::min(column1 + 1, static_cast<int>(nx) - 1);
+            const int row2 = std::min(row1 + 1, static_cast<int>(ny) - 1);
+            const double u = x_prime - x1;
+            const double v = y_prime - y1;
+
+            const T minXminY = getPixel(row1, column1, sourceAccessor);
+            const T maxXminY = getPixel(row1, column2, sourceAccessor);
+            const T minXmaxY = getPixel(row2, column1, sourceAccessor);
+            const T maxXmaxY = getPixel(row2, column2, sourceAccessor);
+
+            results[x] = static_cast<T>((minXminY * ((1.0 - u) * (1.0 - v))
+                                       + maxXminY * (u * (1.0 - v))
+                                       + minXmaxY * ((1.0 - u) * v)
+                                       + maxXmaxY * (u * v)));
+         }
+      }
+
+      return true;
+   }
+
+   const Poly2DInput& mInput;
+   int mThreadCount;
+   Poly2DMapping mMapping;
+   std::vector<T> mWindow;
+   int mWindowFirstColumn;
+   int mWindowLastColumn;
+   int mWindowFirstRow;
+   int mWindowLastRow;
+   int mWindowColumns;
+};
+
+template<class T>
+struct Poly2DOutput
+{
+   Poly2DOutput() :
+      mBadValues(0.0)
+   {}
+
+   bool compileOverallResults(const std::vector<Poly2DThread<T>*>& threads)
+   {
+      mBadValues = 0.0;
+      for (typename std::vector<Poly2DThread<T>*>::const_iterator iter = threads.begin(); iter != threads.end(); ++iter)
+      {
+         mBadValues += (*iter)->mBadValues;
+      }
+
+      return true;
+   }
+
+   double mBadValues;
+};
+
+/**
+ * Reports the progress of the warp threads to a ProgressTracker.
+ */
+class Poly2DProgressReporter : public mta::ProgressReporter
+{
+public:
+   Poly2DProgressReporter(const std::string& message, ProgressTracker& progressTracker) :
+      mMessage(message),
+      mProgressTracker(progressTracker)
+   {}
+
+   void reportProgress(int percent)
+   {
+      mProgressTracker.report(mMessage, percent, NORMAL);
+   }
+
+   void reportError(const std::string& text)
+   {
+      mProgressTracker.report(text, 0, ERRORS);
+   }
+
+private:
+   Poly2DProgressReporter& operator=(const Poly2DProgressReporter& rhs);
+
+   std::string mMessage;
+   ProgressTracker& mProgressTracker;
+};
 
 /**
  * Poly2D
@@ -36,6 +452,11 @@
  * how many times greater the resolution of the secondary image is than the
  * primary image.
  *
+ * The output is warped in blocks on multiple threads. Each block reads the
+ * window of the secondary image it maps into once, and its mapping is
+ * interpolated from the mapping at its corners when that is within
+ * maxMappingError of the exact mapping.
+ *
  * @throw FusionException
  *        A FusionException is thrown when an unrecoverable error occurs.
  * @throw AssertException
@@ -50,9 +471,6 @@
  *         Dummy parameter to allow for using switchOnEncoding.
  * @param  pRasterElement
  *         The secondary image
- * @param  pAssocDs
- *         The name of the dataset with which to associate the results.
- *         If NULL, becomes the Dataset Name of pRasterElement.
  * @param  KX
  *         The X warp vector output taken from the Polywarp call.
  * @param  KY
@@ -79,6 +497,9 @@
  * @param  inMemory
  *         Whether the resulting RasterElement is created in memory or on-disk. Defaults
  *         to TRUE.
+ * @param  maxMappingError
+ *         The largest error, in secondary image pixels, allowed when interpolating the
+ *         mapping inside a block. Zero evaluates the exact mapping at the start of every row.
  * @return The warped image S' that corresponds to the data contained in the
  *         primary image chip.
  */
@@ -87,18 +508,14 @@ RasterElement* poly_2D(T* pDummy, RasterElement* pRasterElement,
                      const Vector<double>& KX, const Vector<double>& KY, 
                      unsigned int dimX, unsigned int dimY,
                      unsigned int xoff, unsigned int yoff, int zoomFactor,
-                     ProgressTracker& progressTracker, bool inMemory = true)
+                     ProgressTracker& progressTracker, bool inMemory = true,
+                     double maxMappingError = POLY2D_DEFAULT_MAPPING_ERROR)
 {
-   double x1 = 0, y1 = 0;
-   double x_prime = 0, y_prime = 0;
-   double u = 0, v = 0;
-
    const T BAD_VALUE = 0;
    const double THRESHOLD = 0.10; // if 10% of pixels are 'bad', throw up a warning later
 
-   double badValues = 0;
-
    REQUIRE(pRasterElement != NULL);
+   REQUIRE(KX.size() >= 4 && KY.size() >= 4);
 
    const RasterDataDescriptor* pOrigDescriptor =
       dynamic_cast<RasterDataDescriptor*>(pRasterElement->getDataDescriptor());
@@ -135,97 +552,46 @@ RasterElement* poly_2D(T* pDummy, RasterElement* pRasterElement,
 
    pNewDescriptor = NULL; // ModelResource deletes it
 
-   FactoryResource<DataRequest> pNewRequest;
-   pNewRequest->setWritable(true);
-   DataAccessor rmda = pNewRaster->getDataAccessor(pNewRequest.release());
-   REQUIRE(rmda.isValid() == true);
-
-   DataAccessor originalData = pRasterElement->getDataAccessor();
-   REQUIRE(originalData.isValid() == true);
-
-   unsigned int x2 = 0, y2 = 0;
-   float rowProgress = 100.0f/dimY;
-   for (unsigned int y = 0; y < dimY; y++)
+   /* Let xoff = offset of ROI in primary image
+      x2=x+xoff;
+      Let yoff = offset of ROI in primary
+      y2=y+yoff
+      x_prime = KX[0] + KX[1]*y2 + KX[2]*x2 + KX[3]*x2*y2
+      y_prime = KY[0] + KY[1]*y2 + KY[2]*x2 + KY[3]*x2*y2
+    */
+   Poly2DInput input;
+   input.mpSource = pRasterElement;
+   input.mpResult = pNewRaster.get();
+   input.mpKX = &KX;
+   input.mpKY = &KY;
+   input.mSourceColumns = nx;
+   input.mSourceRows = ny;
+   input.mColumns = dimX;
+   input.mRows = dimY;
+   input.mBlockColumns = (dimX + POLY2D_BLOCK_SIZE - 1) / POLY2D_BLOCK_SIZE;
+   input.mBlockCount = input.mBlockColumns * ((dimY + POLY2D_BLOCK_SIZE - 1) / POLY2D_BLOCK_SIZE);
+   input.mColumnOffset = zoomFactor * static_cast<int>(xoff);
+   input.mRowOffset = zoomFactor * static_cast<int>(yoff);
+   input.mMaxMappingError = std::max(maxMappingError, 0.0);
+
+   Poly2DProgressReporter reporter(msg, progressTracker);
+   Poly2DOutput<T> output;
+   mta::MultiThreadedAlgorithm<Poly2DInput, Poly2DOutput<T>, Poly2DThread<T> >
+      alg(mta::getNumRequiredThreads(input.mBlockCount), input, output, &reporter, mta::DYNAMIC_SCHEDULING);
+   mta::Result result = alg.run();
+   if (DataFusionTools::getAbortFlag())
    {
-      if (DataFusionTools::getAbortFlag())
-      {
-         return NULL;
-      }
-
-      T* results = (T*) rmda->getRow();
-      for (unsigned int x = 0; x < dimX; ++x) // for every column in s'
-      {
-         /* Let xoff = offset of ROI in primary image
-            x2=x+xoff;
-            Let yoff = offset of ROI in primary
-            y2=y+yoff
-            x_prime = KX[0] + KX[1]*y2 + KX[2]*x2 + KX[3]*x2*y2
-            y_prime = KY[0] + KY[1]*y2 + KY[2]*x2 + KY[3]*x2*y2
-          */
-
-         const int XNEW = x+(zoomFactor*xoff), YNEW = y+(zoomFactor*yoff);
-
-         x_prime = KX[0] + KX[1]*YNEW + KX[2]*XNEW + KX[3]*XNEW*YNEW;
-         y_prime = KY[0] + KY[1]*YNEW + KY[2]*XNEW + KY[3]*XNEW*YNEW;
-
-         x1 = floor(x_prime);
-         y1 = floor(y_prime);
-
-         // Handle out of bounds case
-         if ((x1 > (nx-1)) || (y1 > (ny-1)) || (x1 < 0) || (y1 < 0))
-         {
-            badValues++;
-            results[x] = BAD_VALUE;
-         }
-         else
-         {
-            // bilinear interpolation 
-            if ((x1+1) > (double(nx)-1))
-            {
-               x2 = nx-1;
-            }
-            else
-            {
-               x2 = static_cast<unsigned int>(x1+1);
-            }
-            if ((y1+1) > (double(ny)-1))
-            {
-               y2 = ny-1;
-            }
-            else
-            {
-               y2 = static_cast<unsigned int>(y1+1);
-            }
-            u = x_prime - x1;
-            v = y_prime - y1;
-
-            // the "out of bounds case" above guarnatees that the toPixel() operations will succeed
-
-            originalData->toPixel(static_cast<int>(y1), static_cast<int>(x1));
-            const T minXminY = *reinterpret_cast<T*>(originalData->getColumn());
-
-            originalData->toPixel(static_cast<int>(y1), static_cast<int>(x2));
-            const T maxXminY = *reinterpret_cast<T*>(originalData->getColumn());
-
-            originalData->toPixel(static_cast<int>(y2), static_cast<int>(x1));
-            const T minXmaxY = *reinterpret_cast<T*>(originalData->getColumn());
-            
-            originalData->toPixel(static_cast<int>(y2), static_cast<int>(x2));
-            const T maxXmaxY = *reinterpret_cast<T*>(originalData->getColumn());
+      return NULL;
+   }
 
-            results[x] = static_cast<T>((minXminY * ((1.0 - u) * (1.0 - v))
-                                       + maxXminY * (u * (1.0 - v))
-                                       + minXmaxY * ((1.0 - u) * v)
-                                       + maxXmaxY * (u * v)));
-         }
-      }
-      rmda->nextRow();
-      // report 1 row's worth of progress
-      int workDone = static_cast<int>(rowProgress * (y + 1));
-      progressTracker.report(msg.c_str(), workDone, NORMAL);
+   if (result != mta::SUCCESS)
+   {
+      std::string errorText = alg.getErrorText();
+      throw FusionException(errorText.empty() ? "Unable to warp the secondary image!" : errorText,
+         __LINE__, __FILE__);
    }
 
-   if ((badValues / (dimX * dimY)) > THRESHOLD) 
+   if ((output.mBadValues / (static_cast<double>(dimX) * dimY)) > THRESHOLD)
    {
       std::string txt = "Warning: Too many values in the primary data set are not in the secondary data set! "
          "Possible causes: you selected a region in the primary image that is not in the secondary image, "
@@ -17,6 +17,7 @@
 #include "LayerList.h"
 #include "Layer.h"
 #include "MessageLogResource.h"
+#include "MultiThreadedAlgorithm.h"
 #include "PlugInArgList.h"
 #include "PlugInManagerServices.h"
 #include "PlugInRegistration.h"
@@ -26,9 +27,12 @@
 #include "RasterUtilities.h"
 #include "SpatialDataWindow.h"
 #include "StringUtilities.h"
+#include "switchOnEncoding.h"
 #include "UtilityServices.h"
 
+#include <algorithm>
 #include <limits>
+#include <math.h>
 #include <vector>
 #include <QtCore/QStringList>
 #include <QtWidgets/QInputDialog>
@@ -38,50 +42,400 @@ REGISTER_PLUGIN_BASIC(OpticksGeoMosaic, GeoMosaicChip);
 
 namespace
 {
+   // The mosaic is built in square tiles of this many pixels which are processed in parallel
+   const unsigned int MOSAIC_TILE_SIZE = 256;
+
+   enum BlendingType
+   {
+      BLEND_FIRST,   // the first displayed chip which covers a pixel is used
+      BLEND_LAST,    // the last displayed chip which covers a pixel is used
+      BLEND_MEAN,    // the chips which cover a pixel are averaged
+      BLEND_FEATHER  // the chips are averaged with weights which fall off toward the edges of each chip
+   };
+
+   bool parseBlending(const std::string& name, BlendingType& blending)
+   {
+      if (name == "First")
+      {
+         blending = BLEND_FIRST;
+      }
+      else if (name == "Last")
+      {
+         blending = BLEND_LAST;
+      }
+      else if (name == "Mean")
+      {
+         blending = BLEND_MEAN;
+      }
+      else if (name == "Feather")
+      {
+         blending = BLEND_FEATHER;
+      }
+      else
+      {
+         return false;
+      }
+
+      return true;
+   }
+
+   inline bool orderedIsBetween(double x, double x1, double x2)
+   {
+      double e = 0.0001;
+      return (x1 - e <= x) && (x <= x2 + e);
+   }
+
+   /**
+    * A chip and its footprint in the mosaic.  Footprint rows and columns are relative to the mosaic,
+    * and the maps give the chip row and column used for each mosaic row and column in the footprint.
+    */
    class ChipStruct
    {
    public:
-      ChipStruct() : mAccessor(NULL, NULL), mStartX(0), mStartY(0), mEndX(0), mEndY(0) {}
+      ChipStruct() :
+         mpElement(NULL),
+         mpDescriptor(NULL),
+         mStartX(0),
+         mStartY(0),
+         mEndX(0),
+         mEndY(0),
+         mFirstRow(0),
+         mLastRow(-1),
+         mFirstColumn(0),
+         mLastColumn(-1)
+      {}
 
-      ChipStruct(const ChipStruct& rhs) : mAccessor(NULL, NULL)
+      // Finds the mosaic pixels which the chip covers.  Returns false if it does not cover any.
+      bool computeFootprint(int aoiStartX, int aoiStartY, unsigned int numColumns, unsigned int numRows)
       {
-         mAccessor = rhs.mAccessor;
-         mStartX = rhs.mStartX;
-         mStartY = rhs.mStartY;
-         mEndX = rhs.mEndX;
-         mEndY = rhs.mEndY;
+         computeMap(aoiStartX, numColumns, mStartX, mEndX, mFirstColumn, mLastColumn, mColumns);
+         computeMap(aoiStartY, numRows, mStartY, mEndY, mFirstRow, mLastRow, mRows);
+         return mColumns.empty() == false && mRows.empty() == false;
       }
 
-      ChipStruct& operator=(const ChipStruct& rhs)
+      bool intersects(int firstRow, int lastRow, int firstColumn, int lastColumn) const
       {
-         if (this != &rhs)
-         {
-            mAccessor = rhs.mAccessor;
-            mStartX = rhs.mStartX;
-            mStartY = rhs.mStartY;
-            mEndX = rhs.mEndX;
-            mEndY = rhs.mEndY;
-         }
-         return *this;
+         return mFirstRow <= lastRow && firstRow <= mLastRow && mFirstColumn <= lastColumn &&
+            firstColumn <= mLastColumn;
       }
 
-      DataAccessor mAccessor;
+      RasterElement* mpElement;
+      const RasterDataDescriptor* mpDescriptor;
       double mStartX;
       double mStartY;
       double mEndX;
       double mEndY;
+      int mFirstRow;
+      int mLastRow;
+      int mFirstColumn;
+      int mLastColumn;
+      std::vector<int> mRows;
+      std::vector<int> mColumns;
+
+   private:
+      // The chip pixel is truncated from the offset into the chip, which is how a pixel was
+      // located when each mosaic pixel was tested against each chip
+      static void computeMap(int aoiStart, unsigned int count, double start, double end, int& first, int& last,
+         std::vector<int>& chipMap)
+      {
+         chipMap.clear();
+         first = 0;
+         last = -1;
+         for (unsigned int i = 0; i < count; ++i)
+         {
+            int position = aoiStart + static_cast<int>(i);
+            if (orderedIsBetween(position, start, end))
+            {
+               if (chipMap.empty())
+               {
+                  first = static_cast<int>(i);
+               }
+
+               last = static_cast<int>(i);
+               chipMap.push_back(static_cast<int>(position - start));
+            }
+         }
+      }
    };
 
-   inline bool orderedIsBetween(double x, double x1, double x2)
+   template<typename T>
+   T toMosaicValue(double value)
    {
-      double e = 0.0001;
-      return (x1 - e <= x) && (x <= x2 + e);
+      if (std::numeric_limits<T>::is_integer)
+      {
+         value = floor(value + 0.5);
+         value = std::max(value, static_cast<double>(std::numeric_limits<T>::min()));
+         value = std::min(value, static_cast<double>(std::numeric_limits<T>::max()));
+      }
+
+      return static_cast<T>(value);
    }
 
-   inline bool isContainedIn(double x, double y, double x1, double y1, double x2, double y2)
+   template<typename T>
+   void accumulatePixels(const T* pSource, unsigned int count, unsigned int numBands, const double* pWeights,
+      double* pSums)
    {
-      return orderedIsBetween(x, x1, x2) && orderedIsBetween(y, y1, y2);
+      for (unsigned int i = 0; i < count; ++i)
+      {
+         for (unsigned int band = 0; band < numBands; ++band)
+         {
+            *pSums++ += pWeights[i] * *pSource++;
+         }
+      }
+   }
+
+   template<typename T>
+   void writeBlendedPixels(T* pDestination, unsigned int count, unsigned int numBands, const double* pWeights,
+      const double* pSums)
+   {
+      for (unsigned int i = 0; i < count; ++i, pDestination += numBands, pSums += numBands)
+      {
+         if (pWeights[i] > 0.0)
+         {
+            for (unsigned int band = 0; band < numBands; ++band)
+            {
+               pDestination[band] = toMosaicValue<T>(pSums[band] / pWeights[i]);
+            }
+         }
+      }
    }
+
+   struct MosaicInput
+   {
+      const GeoMosaicChip* mpPlugIn;
+      const std::vector<ChipStruct>* mpChips;
+      std::vector<std::vector<unsigned int> > mTileChips;   // the chips which overlap each tile, in order
+      RasterElement* mpMosaic;
+      unsigned int mNumRows;
+      unsigned int mNumColumns;
+      unsigned int mNumBands;
+      unsigned int mTileColumns;
+      EncodingType mEncoding;
+      unsigned int mPixelBytes;
+      BlendingType mBlending;
+   };
+
+   /**
+    * Builds mosaic tiles.  Each chip which overlaps a tile is read once with a request
+    * for only the overlapping rows and columns.
+    */
+   class MosaicThread : public mta::AlgorithmThread
+   {
+   public:
+      MosaicThread(const MosaicInput& input, int threadCount, int threadIndex, mta::ThreadReporter& reporter) :
+         mta::AlgorithmThread(threadIndex, reporter),
+         mInput(input),
+         mThreadCount(threadCount)
+      {}
+
+      void run()
+      {
+         const int tileCount = static_cast<int>(mInput.mTileChips.size());
+         mta::AlgorithmThread::Range range;
+         while (getNextRange(mThreadCount, tileCount, range))
+         {
+            int oldPercentDone = -1;
+            for (int tile = range.mFirst; tile <= range.mLast; ++tile)
+            {
+               if (mInput.mpPlugIn->isAborted())
+               {
+                  return;
+               }
+
+               if (processTile(tile) == false)
+               {
+                  return;
+               }
+
+               int percentDone = range.computePercent(tile);
+               if (percentDone > oldPercentDone)
+               {
+                  oldPercentDone = percentDone;
+                  getReporter().reportProgress(getThreadIndex(), percentDone);
+               }
+            }
+         }
+      }
+
+   private:
+      MosaicThread& operator=(const MosaicThread& rhs);
+
+      static DataAccessor getAccessor(RasterElement* pElement, const RasterDataDescriptor* pDescriptor,
+         int firstRow, int lastRow, int firstColumn, int lastColumn, bool writable)
+      {
+         FactoryResource<DataRequest> pRequest;
+         pRequest->setInterleaveFormat(BIP);
+         pRequest->setRows(pDescriptor->getActiveRow(firstRow), pDescriptor->getActiveRow(lastRow),
+            lastRow - firstRow + 1);
+         pRequest->setColumns(pDescriptor->getActiveColumn(firstColumn), pDescriptor->getActiveColumn(lastColumn),
+            lastColumn - firstColumn + 1);
+         pRequest->setWritable(writable);
+         return pElement->getDataAccessor(pRequest.release());
+      }
+
+      bool processTile(int tile)
+      {
+         const std::vector<unsigned int>& tileChips = mInput.mTileChips[tile];
+         if (tileChips.empty())
+         {
+            return true;
+         }
+
+         const int firstRow = (tile / mInput.mTileColumns) * MOSAIC_TILE_SIZE;
+         const int firstColumn = (tile % mInput.mTileColumns) * MOSAIC_TILE_SIZE;
+         const int lastRow = static_cast<int>(std::min(firstRow + MOSAIC_TILE_SIZE, mInput.mNumRows)) - 1;
+         const int lastColumn = static_cast<int>(std::min(firstColumn + MOSAIC_TILE_SIZE, mInput.mNumColumns)) - 1;
+         const RasterDataDescriptor* pMosaicDesc =
+            dynamic_cast<const RasterDataDescriptor*>(mInput.mpMosaic->getDataDescriptor());
+         VERIFY(pMosaicDesc != NULL);
+         DataAccessor mosaicAccessor = getAccessor(mInput.mpMosaic, pMosaicDesc, firstRow, lastRow,
+            firstColumn, lastColumn, true);
+
+         const bool blend = (mInput.mBlending == BLEND_MEAN || mInput.mBlending == BLEND_FEATHER);
+         const unsigned int tileColumns = lastColumn - firstColumn + 1;
+         if (blend)
+         {
+            mWeights.assign((lastRow - firstRow + 1) * tileColumns, 0.0);
+            mSums.assign(mWeights.size() * mInput.mNumBands, 0.0);
+         }
+
+         // Later chips overwrite earlier chips, so the chips are copied in reverse order when the first chip wins
+         const std::vector<ChipStruct>& chips = *mInput.mpChips;
+         for (unsigned int i = 0; i < tileChips.size(); ++i)
+         {
+            unsigned int index = (mInput.mBlending == BLEND_FIRST) ? tileChips[tileChips.size() - 1 - i] : tileChips[i];
+            if (processChip(chips[index], mosaicAccessor, firstRow, lastRow, firstColumn, lastColumn) == false)
+            {
+               return false;
+            }
+         }
+
+         if (blend)
+         {
+            for (int row = firstRow; row <= lastRow; ++row)
+            {
+               mosaicAccessor->toPixel(row, firstColumn);
+               if (mosaicAccessor.isValid() == false)
+               {
+                  getReporter().reportError("Could not access required data.");
+                  return false;
+               }
+
+               const size_t offset = (row - firstRow) * tileColumns;
+               switchOnEncoding(mInput.mEncoding, writeBlendedPixels, mosaicAccessor->getColumn(), tileColumns,
+                  mInput.mNumBands, &mWeights[offset], &mSums[offset * mInput.mNumBands]);
+            }
+         }
+
+         return true;
+      }
+
+      bool processChip(const ChipStruct& chip, DataAccessor& mosaicAccessor, int firstRow, int lastRow,
+         int firstColumn, int lastColumn)
+      {
+         const int startRow = std::max(firstRow, chip.mFirstRow);
+         const int endRow = std::min(lastRow, chip.mLastRow);
+         const int startColumn = std::max(firstColumn, chip.mFirstColumn);
+         const int endColumn = std::min(lastColumn, chip.mLastColumn);
+         if (startRow > endRow || startColumn > endColumn)
+         {
+            return true;
+         }
+
+         // The maps are non-decreasing, so their values at the ends of the overlap bound the chip data
+         const int* pChipRows = &chip.mRows[startRow - chip.mFirstRow];
+         const int* pChipColumns = &chip.mColumns[startColumn - chip.mFirstColumn];
+         const int rowCount = endRow - startRow + 1;
+         const int columnCount = endColumn - startColumn + 1;
+         const int chipFirstColumn = pChipColumns[0];
+         DataAccessor chipAccessor = getAccessor(chip.mpElement, chip.mpDescriptor, pChipRows[0],
+            pChipRows[rowCount - 1], chipFirstColumn, pChipColumns[columnCount - 1], false);
+
+         const unsigned int pixelBytes = mInput.mPixelBytes;
+         const unsigned int tileColumns = lastColumn - firstColumn + 1;
+         const int chipRowCount = static_cast<int>(chip.mpDescriptor->getRowCount());
+         const int chipColumnCount = static_cast<int>(chip.mpDescriptor->getColumnCount());
+         for (int i = 0; i < rowCount; ++i)
+         {
+            const int row = startRow + i;
+            chipAccessor->toPixel(pChipRows[i], chipFirstColumn);
+            if (chipAccessor.isValid() == false)
+            {
+               getReporter().reportError("Could not access required data.");
+               return false;
+            }
+
+            const char* pSource = reinterpret_cast<const char*>(chipAccessor->getColumn());
+            if (mInput.mBlending == BLEND_FIRST || mInput.mBlending == BLEND_LAST)
+            {
+               mosaicAccessor->toPixel(row, startColumn);
+               if (mosaicAccessor.isValid() == false)
+               {
+                  getReporter().reportError("Could not access required data.");
+                  return false;
+               }
+
+               // copy each run of consecutive chip columns at once, which is normally the whole span
+               char* pDestination = reinterpret_cast<char*>(mosaicAccessor->getColumn());
+               int runStart = 0;
+               for (int column = 1; column <= columnCount; ++column)
+               {
+                  if (column == columnCount || pChipColumns[column] != pChipColumns[column - 1] + 1)
+                  {
+                     memcpy(pDestination + runStart * pixelBytes,
+                        pSource + (pChipColumns[runStart] - chipFirstColumn) * pixelBytes,
+                        (column - runStart) * pixelBytes);
+                     runStart = column;
+                  }
+               }
+
+               continue;
+            }
+
+            // weight the pixels and accumulate them in the tile sums
+            const size_t offset = (row - firstRow) * tileColumns + (startColumn - firstColumn);
+            mPixelWeights.resize(columnCount);
+            mPixels.resize(columnCount * pixelBytes);
+            for (int column = 0; column < columnCount; ++column)
+            {
+               const int chipColumn = pChipColumns[column];
+               memcpy(&mPixels[column * pixelBytes], pSource + (chipColumn - chipFirstColumn) * pixelBytes,
+                  pixelBytes);
+
+               double weight = 1.0;
+               if (mInput.mBlending == BLEND_FEATHER)
+               {
+                  int edgeDistance = std::min(std::min(chipColumn, chipColumnCount - 1 - chipColumn),
+                     std::min(pChipRows[i], chipRowCount - 1 - pChipRows[i]));
+                  weight = edgeDistance + 1.0;
+               }
+
+               mPixelWeights[column] = weight;
+               mWeights[offset + column] += weight;
+            }
+
+            switchOnEncoding(mInput.mEncoding, accumulatePixels, &mPixels[0], columnCount, mInput.mNumBands,
+               &mPixelWeights[0], &mSums[offset * mInput.mNumBands]);
+         }
+
+         return true;
+      }
+
+      const MosaicInput& mInput;
+      int mThreadCount;
+      std::vector<double> mWeights;
+      std::vector<double> mSums;
+      std::vector<double> mPixelWeights;
+      std::vector<char> mPixels;
+   };
+
+   struct MosaicOutput
+   {
+      bool compileOverallResults(const std::vector<MosaicThread*>& threads)
+      {
+         return true;
+      }
+   };
 }
 
 GeoMosaicChip::GeoMosaicChip()
@@ -106,6 +460,10 @@ bool GeoMosaicChip::getInputSpecification(PlugInArgList*& pInArgList)
    VERIFY(pInArgList = Service<PlugInManagerServices>()->getPlugInArgList());
    pInArgList->addArg<Progress>(Executable::ProgressArg(), Executable::ProgressArgDescription());
    pInArgList->addArg<SpatialDataView>(Executable::ViewArg(), "View from which to chip.");
+   pInArgList->addArg<AoiElement>("AOI", NULL, "AOI of the primary raster element whose bounding box is chipped.  "
+      "If no AOI is provided, the user is asked to select one.");
+   pInArgList->addArg<std::string>("Overlap Blending", std::string("First"), "How pixels covered by more than one "
+      "displayed layer are combined: \"First\", \"Last\", \"Mean\" or \"Feather\".  Default is \"First\".");
    return true;
 }
 
@@ -136,50 +494,67 @@ bool GeoMosaicChip::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
       return false;
    }
 
-   Service<ModelServices> pModel;
-   Service<DesktopServices> pDesktop;
-   RasterElement* pPrimaryRaster = pView->getLayerList()->getPrimaryRasterElement();
-   // This is the cube from which the AOIs will be selected
-   std::vector<DataElement*> pAois = pModel->getElements(pPrimaryRaster, TypeConverter::toString<AoiElement>());
-   if (pAois.empty())
+   std::string blendingName = "First";
+   pInArgList->getPlugInArgValue("Overlap Blending", blendingName);
+   BlendingType blending = BLEND_FIRST;
+   if (parseBlending(blendingName, blending) == false)
    {
-      std::string msg = "Raster Element does not contain an AOI.";
+      std::string msg = "\"" + blendingName + "\" is not a valid overlap blending.";
       pStep->finalize(Message::Failure, msg);
       if (pProgress != NULL)
       {
          pProgress->updateProgress(msg, 0, ERRORS);
       }
-
       return false;
    }
-   QStringList aoiNames;
-   for (std::vector<DataElement*>::iterator it = pAois.begin(); it != pAois.end(); ++it)
-   {
-      aoiNames << QString::fromStdString((*it)->getName());
-   }
-   bool ok;
-   QString aoi = QInputDialog::getItem(Service<DesktopServices>()->getMainWidget(),
-      "Select an AOI", "Select an AOI for processing", aoiNames, 0, true, &ok);
-   // select AOI
-   if (!ok)
+
+   Service<ModelServices> pModel;
+   Service<DesktopServices> pDesktop;
+   RasterElement* pPrimaryRaster = pView->getLayerList()->getPrimaryRasterElement();
+   AoiElement* pAoi = pInArgList->getPlugInArgValue<AoiElement>("AOI");
+   if (pAoi == NULL)
    {
-      std::string msg = getName() + " has been aborted.";
-      pStep->finalize(Message::Abort, msg);
-      if (pProgress != NULL)
+      // This is the cube from which the AOIs will be selected
+      std::vector<DataElement*> pAois = pModel->getElements(pPrimaryRaster, TypeConverter::toString<AoiElement>());
+      if (pAois.empty())
+      {
+         std::string msg = "Raster Element does not contain an AOI.";
+         pStep->finalize(Message::Failure, msg);
+         if (pProgress != NULL)
+         {
+            pProgress->updateProgress(msg, 0, ERRORS);
+         }
+
+         return false;
+      }
+      QStringList aoiNames;
+      for (std::vector<DataElement*>::iterator it = pAois.begin(); it != pAois.end(); ++it)
       {
-         pProgress->updateProgress(msg, 0, ABORT);
+         aoiNames << QString::fromStdString((*it)->getName());
+      }
+      bool ok;
+      QString aoi = QInputDialog::getItem(Service<DesktopServices>()->getMainWidget(),
+         "Select an AOI", "Select an AOI for processing", aoiNames, 0, true, &ok);
+      // select AOI
+      if (!ok)
+      {
+         std::string msg = getName() + " has been aborted.";
+         pStep->finalize(Message::Abort, msg);
+         if (pProgress != NULL)
+         {
+            pProgress->updateProgress(msg, 0, ABORT);
+         }
+         return false;
       }
-      return false;
-   }
 
-   AoiElement* pAoi = NULL;
-   std::string strAoi = aoi.toStdString();
-   for (std::vector<DataElement*>::iterator it = pAois.begin(); it != pAois.end(); ++it)
-   {
-      if ((*it)->getName() == strAoi)
+      std::string strAoi = aoi.toStdString();
+      for (std::vector<DataElement*>::iterator it = pAois.begin(); it != pAois.end(); ++it)
       {
-         pAoi = static_cast<AoiElement*>(*it);
-         break;
+         if ((*it)->getName() == strAoi)
+         {
+            pAoi = static_cast<AoiElement*>(*it);
+            break;
+         }
       }
    }
    if (pAoi == NULL)
@@ -198,12 +573,11 @@ bool GeoMosaicChip::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
    GraphicGroup* pGroup = pAoi->getGroup();
    LocationType Ll = pGroup->getLlCorner();
    LocationType Ur = pGroup->getUrCorner();
-   // These values represent the bounding box of the rectangle and the pixel count
+   // These values represent the bounding box of the rectangle
    int aoiStartX = floor(Ll.mX);
    int aoiStartY = floor(Ll.mY);
    int aoiEndX = floor(Ur.mX);
    int aoiEndY = floor(Ur.mY);
-   int count = (aoiEndX - aoiStartX + 1) * (aoiEndY - aoiStartY + 1);
    LayerList* pLayerList = pView->getLayerList();
    if (pLayerList == NULL)
    {
@@ -240,6 +614,18 @@ bool GeoMosaicChip::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
       }
    }
 
+   if ((blending == BLEND_MEAN || blending == BLEND_FEATHER) &&
+      (outputDataType == INT4SCOMPLEX || outputDataType == FLT8COMPLEX))
+   {
+      std::string msg = "Complex data can only be mosaicked with \"First\" or \"Last\" overlap blending.";
+      pStep->finalize(Message::Failure, msg);
+      if (pProgress != NULL)
+      {
+         pProgress->updateProgress(msg, 0, ERRORS);
+      }
+      return false;
+   }
+
    bool invalidData = false;
    std::vector<ChipStruct> chips;
    std::vector<Layer*> layers;
@@ -267,7 +653,6 @@ bool GeoMosaicChip::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
       }
       if (pDesc->getBandCount() != numBands)
       {
-         chips.clear(); //required to free resources held by DataAccessors
          std::string msg = pElement->getName() + " has " +
             StringUtilities::toDisplayString(pDesc->getBandCount()) + " bands when it "
             "must match the primary raster element which has " + StringUtilities::toDisplayString(numBands) +
@@ -282,7 +667,6 @@ bool GeoMosaicChip::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
       }
       if (pDesc->getDataType() != outputDataType)
       {
-         chips.clear(); //required to free resources held by DataAccessors
          std::string msg = pElement->getName() + " has an encoding type of " +
             StringUtilities::toDisplayString(pDesc->getDataType()) + " it "
             "must match the primary raster element which has an encoding type of " +
@@ -296,86 +680,81 @@ bool GeoMosaicChip::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
          invalidData = true;
          break;
       }
-      FactoryResource<DataRequest> pRequest;
-      pRequest->setInterleaveFormat(BIP);
-      DataAccessor origAccessor = pElement->getDataAccessor(pRequest.release());
-      if (!origAccessor.isValid())
-      {
-         chips.clear(); //required to free resources held by DataAccessors
-         std::string msg = "Could not access required data.";
-         pStep->finalize(Message::Failure, msg);
-         if (pProgress != NULL)
-         {
-            pProgress->updateProgress(msg, 0, ERRORS);
-         }
-         break;
-      }
-      item.mAccessor = origAccessor;
+      item.mpElement = pElement;
+      item.mpDescriptor = pDesc;
       item.mStartX = layers[idx]->getXOffset();
       item.mStartY = layers[idx]->getYOffset();
       item.mEndX = pDesc->getColumnCount() - 1 + item.mStartX;
       item.mEndY = pDesc->getRowCount() - 1 + item.mStartY;
-      chips.push_back(item);
+
+      // chips which are outside of the AOI are not needed
+      if (item.computeFootprint(aoiStartX, aoiStartY, numColumns, numRows))
+      {
+         chips.push_back(item);
+      }
    }
    if (invalidData || chips.empty())
    {
-      chips.clear(); //required to free resources held by DataAccessors
       return false;
    }
 
-   FactoryResource<DataRequest> pRequest;
-   pRequest->setInterleaveFormat(BIP);
-   pRequest->setWritable(true);
-   DataAccessor pSubAccessor = pSubCubeRaster->getDataAccessor(pRequest.release());
-
-   void* pSourceData = NULL;
-   void* pValue = NULL;
-   int currentCount = 0;
-   int currentPercent = 0;
-   int savePercent = 0;
-   unsigned int bytesToCopy = numBands * RasterUtilities::bytesInEncoding(outputDataType);
-   for (int row = aoiStartY; row <= aoiEndY; ++row)
+   // list the chips which overlap each tile of the mosaic
+   MosaicInput input;
+   input.mpPlugIn = this;
+   input.mpChips = &chips;
+   input.mpMosaic = pSubCubeRaster.get();
+   input.mNumRows = numRows;
+   input.mNumColumns = numColumns;
+   input.mNumBands = numBands;
+   input.mTileColumns = (numColumns + MOSAIC_TILE_SIZE - 1) / MOSAIC_TILE_SIZE;
+   input.mEncoding = outputDataType;
+   input.mPixelBytes = numBands * RasterUtilities::bytesInEncoding(outputDataType);
+   input.mBlending = blending;
+   const unsigned int tileRows = (numRows + MOSAIC_TILE_SIZE - 1) / MOSAIC_TILE_SIZE;
+   input.mTileChips.resize(tileRows * input.mTileColumns);
+   for (unsigned int tile = 0; tile < input.mTileChips.size(); ++tile)
    {
-      for (int col = aoiStartX; col <= aoiEndX; ++col)
+      const int firstRow = (tile / input.mTileColumns) * MOSAIC_TILE_SIZE;
+      const int firstColumn = (tile % input.mTileColumns) * MOSAIC_TILE_SIZE;
+      for (unsigned int idx = 0; idx < chips.size(); ++idx)
       {
-         for (unsigned int idx = 0; idx < chips.size(); ++idx)
-         {            
-            if (isContainedIn(col, row, chips[idx].mStartX, chips[idx].mStartY, chips[idx].mEndX, chips[idx].mEndY))
-            {
-               if (!pSubAccessor.isValid())
-               {
-                  chips.clear(); //required to free resources held by DataAccessors
-                  return false;
-               }
-               if (!chips[idx].mAccessor.isValid())
-               {
-                  chips.clear(); //required to free resources held by DataAccessors
-                  return false;
-               }
-               chips[idx].mAccessor->toPixel(row - chips[idx].mStartY, col - chips[idx].mStartX);
-               pSubAccessor->toPixel(row - aoiStartY, col - aoiStartX);
-               pSourceData = chips[idx].mAccessor->getColumn();
-               pValue = pSubAccessor->getColumn();
-               memcpy(pValue, pSourceData, bytesToCopy);
-               break;
-            }
-         }
-         ++currentCount;
-         currentPercent = 100.0 * currentCount / count;
-         if (currentPercent != savePercent)
+         if (chips[idx].intersects(firstRow, firstRow + MOSAIC_TILE_SIZE - 1, firstColumn,
+            firstColumn + MOSAIC_TILE_SIZE - 1))
          {
-            if (isAborted())
-            {
-               pProgress->updateProgress("User aborted", 0, ABORT); 
-               chips.clear(); //required to free resources held by DataAccessors
-               return false;
-            }
-            savePercent = currentPercent;
-            pProgress->updateProgress("Chipping...", currentPercent, NORMAL);
+            input.mTileChips[tile].push_back(idx);
          }
       }
    }
-   chips.clear(); //required to free resources held by DataAccessors
+
+   mta::ProgressObjectReporter reporter("Chipping", pProgress);
+   MosaicOutput output;
+   mta::MultiThreadedAlgorithm<MosaicInput, MosaicOutput, MosaicThread>
+      alg(mta::getNumRequiredThreads(input.mTileChips.size()), input, output, &reporter, mta::DYNAMIC_SCHEDULING);
+   mta::Result result = alg.run();
+   if (isAborted())
+   {
+      if (pProgress != NULL)
+      {
+         pProgress->updateProgress("User aborted", 0, ABORT);
+      }
+      pStep->finalize(Message::Abort);
+      return false;
+   }
+   if (result != mta::SUCCESS)
+   {
+      std::string msg = alg.getErrorText();
+      if (msg.empty())
+      {
+         msg = "Could not access required data.";
+      }
+      pStep->finalize(Message::Failure, msg);
+      if (pProgress != NULL)
+      {
+         pProgress->updateProgress(msg, 0, ERRORS);
+      }
+      return false;
+   }
+   pSubCubeRaster->updateData();
 
    // Create the SpatialDataView for the results
    SpatialDataWindow* mpWindow = static_cast<SpatialDataWindow*>(pDesktop->createWindow(chipName, SPATIAL_DATA_WINDOW));
@@ -405,6 +784,9 @@ bool GeoMosaicChip::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgLis
 
    pOutArgList->setPlugInArgValue("Result", pSubCubeRaster.release());
 
-   pProgress->updateProgress("Done", 100, NORMAL);
+   if (pProgress != NULL)
+   {
+      pProgress->updateProgress("Done", 100, NORMAL);
+   }
    return true;
 }
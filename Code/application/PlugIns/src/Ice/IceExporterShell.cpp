@@ -83,7 +83,7 @@ bool IceExporterShell::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArg
          writer.setGzipCompressionLevel(mpOptionsWidget->getGzipCompressionLevel());
       }
       if ((pRasterDescriptor->getDataType() == INT4SCOMPLEX || pRasterDescriptor->getDataType() == FLT8COMPLEX)
-       && (writer.getCompressionType() == GZIP || writer.getCompressionType() == SHUFFLE_AND_GZIP))
+       && writer.getCompressionType() != NONE)
       {
          std::string msgtxt = "Compression not supported with complex data types, data will not be compressed.";
          MessageResource msg(msgtxt, "app", "{7B050EE4-D025-43b2-AD8F-DF8E28FA8551}");
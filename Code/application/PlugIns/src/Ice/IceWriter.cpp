@@ -16,6 +16,8 @@
 #include "DataRequest.h"
 #include "DimensionDescriptor.h"
 #include "DynamicObject.h"
+#include "Hdf5ChunkCodec.h"
+#include "Hdf5ChunkWriter.h"
 #include "Hdf5IncrementalWriter.h"
 #include "Hdf5Utilities.h"
 #include "IceWriter.h"
@@ -76,6 +78,8 @@ BEGIN_ENUM_MAPPING(IceCompressionType)
 ADD_ENUM_MAPPING(NONE, "None", "none")
 ADD_ENUM_MAPPING(GZIP, "GZIP", "gzip")
 ADD_ENUM_MAPPING(SHUFFLE_AND_GZIP, "Shuffle+GZIP", "shuffle_gzip")
+ADD_ENUM_MAPPING(LZ4, "LZ4", "lz4")
+ADD_ENUM_MAPPING(SHUFFLE_AND_LZ4, "Shuffle+LZ4", "shuffle_lz4")
 END_ENUM_MAPPING()
 }
 
@@ -620,6 +624,7 @@ void IceWriter::writeBilCubeData(const std::string& hdfPath,
    createDatasetForCube(dimSpace, compSpace, pDescriptor->getDataType(), mFileHandle, hdfPath, dataId);
    Hdf5DataSpaceResource dspaceId(H5Dget_space(*dataId));
    ICEVERIFY(*dspaceId >= 0);
+   Hdf5ChunkWriter chunkWriter(*dataId);
    Hdf5TypeResource hdfEncoding(H5Dget_type(*dataId));
    ICEVERIFY(*hdfEncoding >= 0);
 
@@ -689,11 +694,18 @@ void IceWriter::writeBilCubeData(const std::string& hdfPath,
             ICEVERIFY(*mspaceId >= 0);
          }
 
-         herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
-         ICEVERIFY(status >= 0);
+         if (chunkWriter.isEnabled())
+         {
+            ICEVERIFY(chunkWriter.writeChunk(offset, pWriteBuffer, (endChunkRow - startChunkRow) * rowSize));
+         }
+         else
+         {
+            herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
+            ICEVERIFY(status >= 0);
 
-         status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
-         ICEVERIFY(status >= 0);
+            status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
+            ICEVERIFY(status >= 0);
+         }
       }
    }
    else
@@ -745,13 +757,23 @@ void IceWriter::writeBilCubeData(const std::string& hdfPath,
             ICEVERIFY(*mspaceId >= 0);
          }
 
-         herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
-         ICEVERIFY(status >= 0);
+         if (chunkWriter.isEnabled())
+         {
+            ICEVERIFY(chunkWriter.writeChunk(offset, pWriteBuffer, (endChunkRow - startChunkRow) * rowSize));
+         }
+         else
+         {
+            herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
+            ICEVERIFY(status >= 0);
 
-         status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
-         ICEVERIFY(status >= 0);
+            status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
+            ICEVERIFY(status >= 0);
+         }
       }
    }
+
+   // write any chunks still queued for compression
+   ICEVERIFY(!chunkWriter.isEnabled() || chunkWriter.flush());
 }
 
 void IceWriter::writeBipCubeData(const string& hdfPath,
@@ -800,6 +822,7 @@ void IceWriter::writeBipCubeData(const string& hdfPath,
    createDatasetForCube(dimSpace, compSpace, pDescriptor->getDataType(), mFileHandle, hdfPath, dataId );
    Hdf5DataSpaceResource dspaceId(H5Dget_space(*dataId));
    ICEVERIFY(*dspaceId >= 0);
+   Hdf5ChunkWriter chunkWriter(*dataId);
    Hdf5TypeResource hdfEncoding(H5Dget_type(*dataId));
    ICEVERIFY(*hdfEncoding >= 0);
 
@@ -870,11 +893,18 @@ void IceWriter::writeBipCubeData(const string& hdfPath,
             ICEVERIFY(*mspaceId >= 0);
          }
 
-         herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
-         ICEVERIFY(status >= 0);
+         if (chunkWriter.isEnabled())
+         {
+            ICEVERIFY(chunkWriter.writeChunk(offset, pWriteBuffer, (endChunkRow - startChunkRow) * rowSize));
+         }
+         else
+         {
+            herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
+            ICEVERIFY(status >= 0);
 
-         status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
-         ICEVERIFY(status >= 0);
+            status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
+            ICEVERIFY(status >= 0);
+         }
 
 
       }
@@ -927,13 +957,23 @@ void IceWriter::writeBipCubeData(const string& hdfPath,
             ICEVERIFY(*mspaceId >= 0);
          }
 
-         herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
-         ICEVERIFY(status >= 0);
+         if (chunkWriter.isEnabled())
+         {
+            ICEVERIFY(chunkWriter.writeChunk(offset, pWriteBuffer, (endChunkRow - startChunkRow) * rowSize));
+         }
+         else
+         {
+            herr_t status = H5Sselect_hyperslab(*dspaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
+            ICEVERIFY(status >= 0);
 
-         status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
-         ICEVERIFY(status >= 0);
+            status = H5Dwrite(*dataId, *hdfEncoding, *mspaceId, *dspaceId, H5P_DEFAULT, pWriteBuffer);
+            ICEVERIFY(status >= 0);
+         }
       }
    }
+
+   // write any chunks still queued for compression
+   ICEVERIFY(!chunkWriter.isEnabled() || chunkWriter.flush());
 }
 
 void IceWriter::writeBsqCubeData(const string& hdfPath,
@@ -985,6 +1025,7 @@ void IceWriter::writeBsqCubeData(const string& hdfPath,
    createDatasetForCube(dimSpace, compSpace, pDescriptor->getDataType(), mFileHandle, hdfPath, dataId);
    Hdf5DataSpaceResource dSpaceId(H5Dget_space(*dataId));
    ICEVERIFY(*dSpaceId >= 0);
+   Hdf5ChunkWriter chunkWriter(*dataId);
    Hdf5TypeResource hdfEncoding(H5Dget_type(*dataId));
    ICEVERIFY(*hdfEncoding >= 0);
 
@@ -1058,13 +1099,23 @@ void IceWriter::writeBsqCubeData(const string& hdfPath,
             memorySpace = *lastChunkWriteId;
          }
 
-         herr_t status = H5Sselect_hyperslab(*dSpaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
-         ICEVERIFY(status >= 0);
+         if (chunkWriter.isEnabled())
+         {
+            ICEVERIFY(chunkWriter.writeChunk(offset, pWriteBuffer, (endChunkRow - startChunkRow) * rowSize));
+         }
+         else
+         {
+            herr_t status = H5Sselect_hyperslab(*dSpaceId, H5S_SELECT_SET, offset, NULL, counts, NULL);
+            ICEVERIFY(status >= 0);
 
-         status = H5Dwrite(*dataId, *hdfEncoding, memorySpace, *dSpaceId, H5P_DEFAULT, pWriteBuffer);
-         ICEVERIFY(status >= 0);
+            status = H5Dwrite(*dataId, *hdfEncoding, memorySpace, *dSpaceId, H5P_DEFAULT, pWriteBuffer);
+            ICEVERIFY(status >= 0);
+         }
       }
    }
+
+   // write any chunks still queued for compression
+   ICEVERIFY(!chunkWriter.isEnabled() || chunkWriter.flush());
 }
 
 void IceWriter::createDatasetForCube(hsize_t dimSpace[3],
@@ -1140,6 +1191,15 @@ void IceWriter::createDatasetForCube(hsize_t dimSpace[3],
          status = H5Pset_deflate(plist, mGzipCompressionLevel);
          ICEVERIFY(status >= 0);
          break;
+      case SHUFFLE_AND_LZ4:
+         status = H5Pset_shuffle(plist);
+         ICEVERIFY(status >= 0);
+         // fall through
+      case LZ4:
+         ICEVERIFY_MSG(Hdf5ChunkCodec::registerLz4Filter(), "Unable to register the LZ4 filter.");
+         status = H5Pset_filter(plist, Hdf5ChunkCodec::LZ4_FILTER, H5Z_FLAG_MANDATORY, 0, NULL);
+         ICEVERIFY(status >= 0);
+         break;
       case NONE:
       default:
          break;
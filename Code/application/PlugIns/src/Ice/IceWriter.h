@@ -32,7 +32,9 @@ enum IceCompressionTypeEnum
 {
    NONE,
    GZIP,
-   SHUFFLE_AND_GZIP
+   SHUFFLE_AND_GZIP,
+   LZ4,
+   SHUFFLE_AND_LZ4
 };
 
 typedef EnumWrapper<IceCompressionTypeEnum> IceCompressionType;
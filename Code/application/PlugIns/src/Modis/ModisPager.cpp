@@ -464,13 +464,24 @@ CachedPage::UnitPtr ModisPager::loadBand(int bandIndex, EncodingType inputDataTy
 }
 
 template <typename In, typename Out>
-bool ModisPager::populateBandData(In* pInData, Out* pOutData, unsigned int numPixels, int bandIndex) const
+const ModisPager::BandConversion& ModisPager::getBandConversion(int bandIndex) const
 {
-   if ((pInData == NULL) || (pOutData == NULL))
+   std::pair<std::string, int> key(mDatasetName, bandIndex);
+   std::map<std::pair<std::string, int>, BandConversion>::iterator iter = mBandConversions.find(key);
+   if (iter != mBandConversions.end())
    {
-      return false;
+      return iter->second;
    }
 
+   BandConversion& conversion = mBandConversions[key];
+   conversion.mValid = false;
+   conversion.mRangeMin = 0.0;
+   conversion.mRangeMax = 0.0;
+   conversion.mFillValue = 0.0;
+   conversion.mScale = 1.0;
+   conversion.mOffset = 0.0;
+   conversion.mScaleFactor = 1.0;
+
    // Get the valid data range and fill value
    DataVariant rangeVariant = getMetadataValue(VALID_RANGE);
    DataVariant fillValueVariant = getMetadataValue(FILL_VALUE);
@@ -481,69 +492,42 @@ bool ModisPager::populateBandData(In* pInData, Out* pOutData, unsigned int numPi
 
    if ((range.size() != 2) || (fillValueVariant.getValue(fillValue) == false))
    {
-      return false;
+      return conversion;
    }
 
-   In rangeMin = range[0];
-   In rangeMax = range[1];
-
-   // Get the radiance scales and offsets
-   Out radianceScale = static_cast<Out>(1.0);
-   Out radianceOffset = static_cast<Out>(0.0);
+   conversion.mRangeMin = static_cast<double>(range[0]);
+   conversion.mRangeMax = static_cast<double>(range[1]);
+   conversion.mFillValue = static_cast<double>(fillValue);
 
-   if (mRasterConversion == ModisUtilities::CONVERT_TO_RADIANCE)
+   // Get the radiance or reflectance scales and offsets
+   if ((mRasterConversion == ModisUtilities::CONVERT_TO_RADIANCE) ||
+      (mRasterConversion == ModisUtilities::CONVERT_TO_REFLECTANCE))
    {
       if ((mDatasetName.empty() == true) || (bandIndex < 0))
       {
-         return false;
+         return conversion;
       }
 
-      std::vector<Out> scales;
-      DataVariant scalesVariant = getMetadataValue(RADIANCE_SCALES);
-      scalesVariant.getValue(scales);
-
-      std::vector<Out> offsets;
-      DataVariant offsetsVariant = getMetadataValue(RADIANCE_OFFSETS);
-      offsetsVariant.getValue(offsets);
-
-      if ((bandIndex >= static_cast<int>(scales.size())) || (bandIndex >= static_cast<int>(offsets.size())))
-      {
-         return false;
-      }
-
-      radianceScale = scales[bandIndex];
-      radianceOffset = offsets[bandIndex];
-   }
-
-   // Get the reflectance scales and offsets
-   Out reflectanceScale = static_cast<Out>(1.0);
-   Out reflectanceOffset = static_cast<Out>(0.0);
-
-   if (mRasterConversion == ModisUtilities::CONVERT_TO_REFLECTANCE)
-   {
-      if ((mDatasetName.empty() == true) || (bandIndex < 0))
-      {
-         return false;
-      }
+      bool radiance = (mRasterConversion == ModisUtilities::CONVERT_TO_RADIANCE);
 
       std::vector<Out> scales;
-      DataVariant scalesVariant = getMetadataValue(REFLECTANCE_SCALES);
+      DataVariant scalesVariant = getMetadataValue(radiance ? RADIANCE_SCALES : REFLECTANCE_SCALES);
       scalesVariant.getValue(scales);
 
       std::vector<Out> offsets;
-      DataVariant offsetsVariant = getMetadataValue(REFLECTANCE_OFFSETS);
+      DataVariant offsetsVariant = getMetadataValue(radiance ? RADIANCE_OFFSETS : REFLECTANCE_OFFSETS);
       offsetsVariant.getValue(offsets);
 
-      if ((scales.empty() == false) && (offsets.empty() == false))   // The emissive datasets will not have
-                                                                     // reflectance conversion factors
+      // The emissive datasets will not have reflectance conversion factors
+      if ((radiance == true) || ((scales.empty() == false) && (offsets.empty() == false)))
       {
          if ((bandIndex >= static_cast<int>(scales.size())) || (bandIndex >= static_cast<int>(offsets.size())))
          {
-            return false;
+            return conversion;
          }
 
-         reflectanceScale = scales[bandIndex];
-         reflectanceOffset = offsets[bandIndex];
+         conversion.mScale = static_cast<double>(scales[bandIndex]);
+         conversion.mOffset = static_cast<double>(offsets[bandIndex]);
       }
    }
 
@@ -552,37 +536,47 @@ bool ModisPager::populateBandData(In* pInData, Out* pOutData, unsigned int numPi
                                  // 1B Products Data Dictionary, Table 2.4.3, Page 106 (dated February 27, 2009)
    DataVariant scaleFactorVariant = getMetadataValue(SCALE_FACTOR);
    scaleFactorVariant.getValue(scaleFactor);
+   conversion.mScaleFactor = scaleFactor;
+
+   conversion.mValid = true;
+   return conversion;
+}
 
-   // Iterate over each pixel populating the output data with the input pixel value, adjusted appropriately
-   for (unsigned int i = 0; i < numPixels; ++i, ++pInData, ++pOutData)
+template <typename In, typename Out>
+bool ModisPager::populateBandData(In* pInData, Out* pOutData, unsigned int numPixels, int bandIndex) const
+{
+   if ((pInData == NULL) || (pOutData == NULL))
    {
-      In inValue = *pInData;
-      Out outValue = static_cast<Out>(inValue);
+      return false;
+   }
 
-      // Check if the pixel value is outside the valid range
-      if ((inValue < rangeMin) || (inValue > rangeMax))
-      {
-         // Convert the value to the fill value
-         outValue = static_cast<Out>(fillValue);
-      }
-      else
-      {
-         // Convert to radiance or reflectance by applying the scale and offset - The conversion equations are obtained
-         // from the MODIS Level 1B Products Data Dictionary, Section 2.2.1, Pages 90 and 92 (dated February 27, 2009)
-         if (mRasterConversion == ModisUtilities::CONVERT_TO_RADIANCE)
-         {
-            outValue = radianceScale * (outValue - radianceOffset);
-         }
-         else if (mRasterConversion == ModisUtilities::CONVERT_TO_REFLECTANCE)
-         {
-            outValue = reflectanceScale * (outValue - reflectanceOffset);
-         }
+   const BandConversion& conversion = getBandConversion<In, Out>(bandIndex);
+   if (conversion.mValid == false)
+   {
+      return false;
+   }
 
-         // Apply the scale factor
-         outValue *= static_cast<Out>(scaleFactor);
-      }
+   // The values are converted back to the types in which they were stored, so the results are the same as
+   // applying the values directly from the metadata.  No conversion is an identity scale and offset.
+   const In rangeMin = static_cast<In>(conversion.mRangeMin);
+   const In rangeMax = static_cast<In>(conversion.mRangeMax);
+   const Out fillValue = static_cast<Out>(static_cast<In>(conversion.mFillValue));
+   const Out scale = static_cast<Out>(conversion.mScale);
+   const Out offset = static_cast<Out>(conversion.mOffset);
+   const Out scaleFactor = static_cast<Out>(conversion.mScaleFactor);
+
+   // Convert all rows of the page in a single pass.  The loop has no branches so that the compiler can
+   // vectorize the range check, the conversion to radiance or reflectance and the selection of the fill
+   // value.  The conversion equations are obtained from the MODIS Level 1B Products Data Dictionary,
+   // Section 2.2.1, Pages 90 and 92 (dated February 27, 2009).
+   for (unsigned int i = 0; i < numPixels; ++i)
+   {
+      const In inValue = pInData[i];
+      Out outValue = scale * (static_cast<Out>(inValue) - offset);
+      outValue *= scaleFactor;
 
-      *pOutData = outValue;
+      const bool invalid = (inValue < rangeMin) | (inValue > rangeMax);
+      pOutData[i] = invalid ? fillValue : outValue;
    }
 
    return true;
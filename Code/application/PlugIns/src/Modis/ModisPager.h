@@ -18,7 +18,9 @@
 #include "TypesFile.h"
 
 #include <hdfi.h>
+#include <map>
 #include <string>
+#include <utility>
 
 class DimensionDescriptor;
 
@@ -48,6 +50,24 @@ protected:
 
    DataVariant getMetadataValue(const std::string& attributeName) const;
 
+   /**
+    *  The values needed to convert the stored values of one band, which are
+    *  stored in double precision regardless of the data type of the band.
+    */
+   struct BandConversion
+   {
+      bool mValid;
+      double mRangeMin;
+      double mRangeMax;
+      double mFillValue;
+      double mScale;
+      double mOffset;
+      double mScaleFactor;
+   };
+
+   template <typename In, typename Out>
+   const BandConversion& getBandConversion(int bandIndex) const;
+
 private:
    int32 mFileHandle;
    int32 mDatasetHandle;
@@ -55,6 +75,10 @@ private:
 
    FactoryResource<DynamicObject> mpMetadata;
    ModisUtilities::RasterConversionType mRasterConversion;
+
+   // The conversion of each band is read from the metadata the first time the band is loaded,
+   // keyed on the HDF dataset name and the band index within the dataset
+   mutable std::map<std::pair<std::string, int>, BandConversion> mBandConversions;
 };
 
 #endif
@@ -1181,7 +1181,7 @@ bool PCA::createPCACube()
    ProcessingLocation outLocation = pDescriptor->getProcessingLocation();
 
    mpPCARaster = RasterUtilities::createRasterElement(outputName, mNumRows, mNumColumns,
-      mNumComponentsToUse, mOutputDataType, BIP, outLocation == IN_MEMORY, NULL);
+      mNumComponentsToUse, mOutputDataType, RasterUtilities::getResultProcessingLocation(outLocation), BIP, NULL);
 
    if (mpPCARaster == NULL)
    {
@@ -22,6 +22,7 @@
 #include "DynamicObject.h"
 #include "GeoTIFFExporter.h"
 #include "GeoTiffExportOptionsWidget.h"
+#include "GeoTiffImageWriter.h"
 #include "MessageLogResource.h"
 #include "OptionsTiffExporter.h"
 #include "PlugInArgList.h"
@@ -35,31 +36,6 @@
 
 using namespace std;
 
-namespace
-{
-   int getTiffSampleFormat(EncodingType type)
-   {
-      switch (type)
-      {
-      case INT1UBYTE:
-      case INT2UBYTES:
-      case INT4UBYTES:
-         return SAMPLEFORMAT_UINT;
-      case INT1SBYTE:
-      case INT2SBYTES:
-      case INT4SBYTES:
-         return SAMPLEFORMAT_INT;
-      case FLT4BYTES:
-      case FLT8BYTES:
-         return SAMPLEFORMAT_IEEEFP;
-      default:
-         break;
-      }
-      return SAMPLEFORMAT_VOID;
-   }
-
-};
-
 REGISTER_PLUGIN_BASIC(OpticksPictures, GeoTIFFExporter);
 
 GeoTIFFExporter::GeoTIFFExporter() :
@@ -68,7 +44,12 @@ GeoTIFFExporter::GeoTIFFExporter() :
    mpRaster(NULL),
    mpFileDescriptor(NULL),
    mAbortFlag(false),
-   mRowsPerStrip(OptionsTiffExporter::getSettingRowsPerStrip())
+   mRowsPerStrip(OptionsTiffExporter::getSettingRowsPerStrip()),
+   mCompression(OptionsTiffExporter::getGeoTiffCompressionType()),
+   mPredictor(StringUtilities::fromXmlString<OptionsTiffExporter::Predictor>(
+      OptionsTiffExporter::getSettingGeoTiffPredictor())),
+   mTileSize(OptionsTiffExporter::getSettingGeoTiffTileSize()),
+   mGenerateOverviews(OptionsTiffExporter::getSettingGeoTiffOverviews())
 {
    setName("GeoTIFF Exporter");
    setCreator("Ball Aerospace & Technologies Corp.");
@@ -110,10 +91,29 @@ bool GeoTIFFExporter::execute(PlugInArgList* pInParam, PlugInArgList* pOutParam)
    if (isBatch() == true)
    {
       pInParam->getPlugInArgValue("Rows Per Strip", mRowsPerStrip);
+
+      string compression;
+      if (pInParam->getPlugInArgValue("Compression", compression) == true)
+      {
+         mCompression = StringUtilities::fromXmlString<OptionsTiffExporter::CompressionType>(compression);
+      }
+
+      string predictor;
+      if (pInParam->getPlugInArgValue("Predictor", predictor) == true)
+      {
+         mPredictor = StringUtilities::fromXmlString<OptionsTiffExporter::Predictor>(predictor);
+      }
+
+      pInParam->getPlugInArgValue("Tile Size", mTileSize);
+      pInParam->getPlugInArgValue("Generate Overviews", mGenerateOverviews);
    }
    else if (mpOptionWidget.get() != NULL)
    {
       mRowsPerStrip = mpOptionWidget->getRowsPerStrip();
+      mCompression = mpOptionWidget->getCompressionType();
+      mPredictor = mpOptionWidget->getPredictor();
+      mTileSize = mpOptionWidget->getTileSize();
+      mGenerateOverviews = mpOptionWidget->getGenerateOverviews();
    }
 
    // Check for complex data
@@ -229,6 +229,16 @@ bool GeoTIFFExporter::getInputSpecification(PlugInArgList*& pArgList)
    if (isBatch() == true)
    {
       VERIFY(pArgList->addArg<unsigned int>("Rows Per Strip", mRowsPerStrip, "Rows per strip for the TIFF file."));
+      VERIFY(pArgList->addArg<string>("Compression",
+         StringUtilities::toXmlString<OptionsTiffExporter::CompressionType>(mCompression),
+         "Compression for the TIFF file: None, PackBits, Deflate, LZW or ZSTD."));
+      VERIFY(pArgList->addArg<string>("Predictor",
+         StringUtilities::toXmlString<OptionsTiffExporter::Predictor>(mPredictor),
+         "Predictor used with Deflate, LZW and ZSTD compression: None, Horizontal or FloatingPoint."));
+      VERIFY(pArgList->addArg<unsigned int>("Tile Size", mTileSize,
+         "Width and height of each tile in pixels, or 0 to write strips."));
+      VERIFY(pArgList->addArg<bool>("Generate Overviews", mGenerateOverviews,
+         "Whether to write internal reduced resolution overviews."));
    }
 
    return true;
@@ -322,27 +332,30 @@ bool GeoTIFFExporter::writeCube(TIFF* pOut)
    unsigned int bytesPerElement(pDescriptor->getBytesPerElement());
    size = scols * sbands * bytesPerElement;
 
-   TIFFSetField(pOut, TIFFTAG_IMAGEWIDTH, scols);
-   TIFFSetField(pOut, TIFFTAG_IMAGELENGTH, srows);
-   TIFFSetField(pOut, TIFFTAG_SAMPLESPERPIXEL, sbands);
-
-   //for this tag, must multiply by # of bytes per data type
-   TIFFSetField(pOut, TIFFTAG_BITSPERSAMPLE, static_cast<unsigned short>(bytesPerElement * 8));
-   TIFFSetField(pOut, TIFFTAG_SAMPLEFORMAT, static_cast<unsigned short>(
-                           getTiffSampleFormat(pDescriptor->getDataType())));
+   EncodingType dataType = pDescriptor->getDataType();
+   unsigned short compression = COMPRESSION_NONE;
+   unsigned short predictor = PREDICTOR_NONE;
+   unsigned int tileSize = 0;
+   getLayout(dataType, compression, predictor, tileSize);
 
-   bool packBits = OptionsTiffExporter::getSettingPackBitsCompression();
-   if (mpOptionWidget.get() != NULL)
+   GeoTiffImageWriter writer(pOut, dataType, scols, srows, sbands);
+   if (writer.initialize(compression, predictor, tileSize, mRowsPerStrip, false) == false)
    {
-      packBits = mpOptionWidget->getPackBitsCompression();
+      mMessage = "Unable to set the GeoTIFF image structure.";
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress(mMessage, 0, ERRORS);
+      }
+
+      return false;
    }
-   ttag_t compOpt = (packBits ? COMPRESSION_PACKBITS : COMPRESSION_NONE);
 
-   TIFFSetField(pOut, TIFFTAG_COMPRESSION, compOpt);
-   TIFFSetField(pOut, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
-   TIFFSetField(pOut, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-   TIFFSetField(pOut, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);      //????
-   TIFFSetField(pOut, TIFFTAG_ROWSPERSTRIP, mRowsPerStrip);
+   // The overviews are built from the exported rows as they are written
+   auto_ptr<GeoTiffOverview> pOverview;
+   if (mGenerateOverviews == true)
+   {
+      pOverview.reset(new GeoTiffOverview(dataType, scols, srows, sbands, tileSize > 0 ? tileSize : 256));
+   }
 
    //ready to test write
    mMessage = "Writing out GeoTIFF file...";
@@ -370,7 +383,12 @@ bool GeoTIFFExporter::writeCube(TIFF* pOut)
          pBuffer = reinterpret_cast<unsigned char*>(accessor->getRow());
          if (pBuffer != NULL)
          {
-            if (TIFFWriteScanline(pOut, pBuffer, row, size) < 0)
+            if (pOverview.get() != NULL)
+            {
+               pOverview->addRow(pBuffer);
+            }
+
+            if (writer.writeRow(pBuffer) == false)
             {
                mMessage = "Unable to save GeoTIFF file, check folder permissions.";
                if (mpProgress)
@@ -473,8 +491,13 @@ bool GeoTIFFExporter::writeCube(TIFF* pOut)
 
             if (rowSize > 0)
             {
+               if (pOverview.get() != NULL)
+               {
+                  pOverview->addRow(&rowData[0]);
+               }
+
                // write here
-               if (TIFFWriteScanline(pOut, &rowData[0], outRow, size) < 0)
+               if (writer.writeRow(&rowData[0]) == false)
                {
                   mMessage = "Error GeoTIFFExporter006: Unable to save GeoTIFF file, check folder permissions.";
                   if (mpProgress)
@@ -495,6 +518,18 @@ bool GeoTIFFExporter::writeCube(TIFF* pOut)
       }
    }
 
+   // Write any buffered tiles
+   if (writer.finish() == false)
+   {
+      mMessage = "Unable to save GeoTIFF file, check folder permissions.";
+      if (mpProgress)
+      {
+         mpProgress->updateProgress(mMessage, 0, ERRORS);
+      }
+
+      return false;
+   }
+
    //assumed everything has been done correctly up to now
    //copy over Geo ref info if there are any, else
    //try to look for world file in same directory and apply
@@ -512,6 +547,116 @@ bool GeoTIFFExporter::writeCube(TIFF* pOut)
       }
    }
 
+   // The overviews follow the full resolution image in their own directories
+   if (pOverview.get() != NULL)
+   {
+      pOverview->finish();
+      if (writeOverviews(pOut, *pOverview, dataType, sbands, compression, predictor, tileSize) == false)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+void GeoTIFFExporter::getLayout(EncodingType dataType, unsigned short& compression, unsigned short& predictor,
+                                unsigned int& tileSize)
+{
+   compression = COMPRESSION_NONE;
+   if (mCompression.isValid() == true && mCompression != OptionsTiffExporter::NO_COMPRESSION)
+   {
+      if (OptionsTiffExporter::isCompressionAvailable(mCompression) == true)
+      {
+         compression = OptionsTiffExporter::getTiffCompression(mCompression);
+      }
+      else
+      {
+         mMessage = StringUtilities::toDisplayString<OptionsTiffExporter::CompressionType>(mCompression) +
+            " compression is not available.  The GeoTIFF file will not be compressed.";
+         if (mpProgress != NULL)
+         {
+            mpProgress->updateProgress(mMessage, 0, WARNING);
+         }
+
+         if (mpStep != NULL)
+         {
+            mpStep->addMessage(mMessage, "app", "4F0B7E62-1C3A-4E5B-9D0C-8A3E5F7B2D14", true);
+         }
+      }
+   }
+
+   // Use the predictor which libtiff supports for the data type
+   predictor = PREDICTOR_NONE;
+   if (GeoTiffImageWriter::supportsPredictor(compression) == true && mPredictor.isValid() == true)
+   {
+      bool floatingPoint = (dataType == FLT4BYTES || dataType == FLT8BYTES);
+      if (mPredictor == OptionsTiffExporter::HORIZONTAL)
+      {
+         predictor = (dataType == FLT8BYTES ? PREDICTOR_FLOATINGPOINT : PREDICTOR_HORIZONTAL);
+      }
+      else if (mPredictor == OptionsTiffExporter::FLOATING_POINT)
+      {
+         predictor = (floatingPoint ? PREDICTOR_FLOATINGPOINT : PREDICTOR_HORIZONTAL);
+      }
+   }
+
+   // Tile dimensions must be multiples of 16
+   tileSize = (mTileSize + 15) / 16 * 16;
+}
+
+bool GeoTIFFExporter::writeOverviews(TIFF* pOut, const GeoTiffOverview& overview, EncodingType dataType,
+                                     unsigned int bands, unsigned short compression, unsigned short predictor,
+                                     unsigned int tileSize)
+{
+   mMessage = "Writing GeoTIFF overviews...";
+   for (unsigned int level = 0; level < overview.getLevelCount(); ++level)
+   {
+      // The previous image is complete, so start the directory for this overview
+      if (TIFFWriteDirectory(pOut) == 0)
+      {
+         mMessage = "Unable to save GeoTIFF file, check folder permissions.";
+         if (mpProgress != NULL)
+         {
+            mpProgress->updateProgress(mMessage, 0, ERRORS);
+         }
+
+         return false;
+      }
+
+      const unsigned int rows = overview.getRowCount(level);
+      GeoTiffImageWriter writer(pOut, dataType, overview.getColumnCount(level), rows, bands);
+      bool success = writer.initialize(compression, predictor, tileSize, mRowsPerStrip, true);
+      for (unsigned int row = 0; success && row < rows; ++row)
+      {
+         if (mAbortFlag)
+         {
+            mMessage = "GeoTIFF export aborted!";
+            if (mpProgress != NULL)
+            {
+               mpProgress->updateProgress(mMessage, 0, ERRORS);
+            }
+
+            return false;
+         }
+
+         success = writer.writeRow(overview.getRow(level, row));
+      }
+
+      if (success == false || writer.finish() == false)
+      {
+         mMessage = "Unable to save the GeoTIFF overviews.";
+         if (mpProgress != NULL)
+         {
+            mpProgress->updateProgress(mMessage, 0, ERRORS);
+         }
+
+         return false;
+      }
+
+      updateProgress(level + 1, overview.getLevelCount(), mMessage, NORMAL);
+   }
+
    return true;
 }
 
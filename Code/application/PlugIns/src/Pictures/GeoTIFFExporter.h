@@ -14,9 +14,11 @@
 #include <memory>
 
 #include "ExporterShell.h"
+#include "OptionsTiffExporter.h"
 #include "Progress.h"
 
 class GeoTiffExportOptionsWidget;
+class GeoTiffOverview;
 class RasterElement;
 class RasterFileDescriptor;
 class Step;
@@ -40,6 +42,10 @@ private:
    bool applyWorldFile(TIFF* pOut);
    void updateProgress(int current, int total, const std::string& progressString, ReportingLevel level = NORMAL);
    bool writeCube(TIFF* pOut);
+   void getLayout(EncodingType dataType, unsigned short& compression, unsigned short& predictor,
+      unsigned int& tileSize);
+   bool writeOverviews(TIFF* pOut, const GeoTiffOverview& overview, EncodingType dataType, unsigned int bands,
+      unsigned short compression, unsigned short predictor, unsigned int tileSize);
 
    Step* mpStep;
    std::auto_ptr<GeoTiffExportOptionsWidget> mpOptionWidget;
@@ -51,6 +57,10 @@ private:
    bool mAbortFlag;
    std::string mMessage;
    unsigned int mRowsPerStrip;
+   OptionsTiffExporter::CompressionType mCompression;
+   OptionsTiffExporter::Predictor mPredictor;
+   unsigned int mTileSize;
+   bool mGenerateOverviews;
 };
 
 #endif
@@ -7,11 +7,13 @@
  * http://www.gnu.org/licenses/lgpl.html
  */
 
+#include "AppVerify.h"
 #include "GeoTiffExportOptionsWidget.h"
 #include "LabeledSection.h"
 #include "StringUtilities.h"
 
 #include <QtWidgets/QCheckBox>
+#include <QtWidgets/QComboBox>
 #include <QtWidgets/QGridLayout>
 #include <QtWidgets/QGroupBox>
 #include <QtWidgets/QLabel>
@@ -53,23 +55,64 @@ GeoTiffExportOptionsWidget::GeoTiffExportOptionsWidget() :
    mpRowsPerStrip = new QSpinBox(pCompressionWidget);
    mpRowsPerStrip->setRange(1, std::numeric_limits<int>::max());
 
-   mpPackBits = new QCheckBox("Pack Bits", pCompressionWidget);
+   mpTiledCheck = new QCheckBox("Tile Size: ", pCompressionWidget);
+   mpTileSize = new QSpinBox(pCompressionWidget);
+   mpTileSize->setRange(16, 4096);
+   mpTileSize->setSingleStep(16);
+   mpTileSize->setValue(256);
+
+   QLabel* pCompressionLabel = new QLabel("Compression: ", pCompressionWidget);
+   mpCompressionCombo = new QComboBox(pCompressionWidget);
+
+   QLabel* pPredictorLabel = new QLabel("Predictor: ", pCompressionWidget);
+   mpPredictorCombo = new QComboBox(pCompressionWidget);
+   mpPredictorCombo->setToolTip("Used with Deflate, LZW and Zstandard compression");
+
+   mpOverviewsCheck = new QCheckBox("Internal overviews", pCompressionWidget);
 
    QGridLayout* pCompressionLayout = new QGridLayout(pCompressionWidget);
    pCompressionLayout->setMargin(0);
    pCompressionLayout->setSpacing(5);
    pCompressionLayout->addWidget(pRowsPerStripLabel, 0, 0);
    pCompressionLayout->addWidget(mpRowsPerStrip, 0, 1);
-   pCompressionLayout->addWidget(mpPackBits, 1, 1);
+   pCompressionLayout->addWidget(mpTiledCheck, 1, 0);
+   pCompressionLayout->addWidget(mpTileSize, 1, 1);
+   pCompressionLayout->addWidget(pCompressionLabel, 2, 0);
+   pCompressionLayout->addWidget(mpCompressionCombo, 2, 1);
+   pCompressionLayout->addWidget(pPredictorLabel, 3, 0);
+   pCompressionLayout->addWidget(mpPredictorCombo, 3, 1);
+   pCompressionLayout->addWidget(mpOverviewsCheck, 4, 0, 1, 2);
    pCompressionLayout->setColumnStretch(2, 10);
 
+   std::vector<std::string> compressionTypes =
+      StringUtilities::getAllEnumValuesAsDisplayString<OptionsTiffExporter::CompressionType>();
+   for (std::vector<std::string>::const_iterator iter = compressionTypes.begin(); iter != compressionTypes.end(); ++iter)
+   {
+      if (OptionsTiffExporter::isCompressionAvailable(
+         StringUtilities::fromDisplayString<OptionsTiffExporter::CompressionType>(*iter)) == true)
+      {
+         mpCompressionCombo->addItem(QString::fromStdString(*iter));
+      }
+   }
+
+   std::vector<std::string> predictors =
+      StringUtilities::getAllEnumValuesAsDisplayString<OptionsTiffExporter::Predictor>();
+   for (std::vector<std::string>::const_iterator iter = predictors.begin(); iter != predictors.end(); ++iter)
+   {
+      mpPredictorCombo->addItem(QString::fromStdString(*iter));
+   }
+
+   // Strips are only used when the file is not tiled
+   VERIFYNR(connect(mpTiledCheck, SIGNAL(toggled(bool)), mpTileSize, SLOT(setEnabled(bool))));
+   VERIFYNR(connect(mpTiledCheck, SIGNAL(toggled(bool)), mpRowsPerStrip, SLOT(setDisabled(bool))));
+
    LabeledSection* pCompressionSection = new LabeledSection(pCompressionWidget, "Compression Options", this);
 
    // Initialization
    addSection(pTransformationSection);
    addSection(pCompressionSection);
    addStretch(10);
-   setSizeHint(350, 250);
+   setSizeHint(350, 300);
 
    // Initialization from settings
    OptionsTiffExporter::TransformationMethod transformationMethod =
@@ -85,7 +128,26 @@ GeoTiffExportOptionsWidget::GeoTiffExportOptionsWidget() :
    }
 
    mpRowsPerStrip->setValue(static_cast<int>(OptionsTiffExporter::getSettingRowsPerStrip()));
-   mpPackBits->setChecked(OptionsTiffExporter::getSettingPackBitsCompression());
+
+   unsigned int tileSize = OptionsTiffExporter::getSettingGeoTiffTileSize();
+   if (tileSize > 0)
+   {
+      mpTileSize->setValue(static_cast<int>(tileSize));
+   }
+   mpTiledCheck->setChecked(tileSize > 0);
+   mpTileSize->setEnabled(tileSize > 0);
+   mpRowsPerStrip->setEnabled(tileSize == 0);
+
+   int compressionIndex = mpCompressionCombo->findText(QString::fromStdString(
+      StringUtilities::toDisplayString(OptionsTiffExporter::getGeoTiffCompressionType())));
+   mpCompressionCombo->setCurrentIndex(compressionIndex < 0 ? 0 : compressionIndex);
+
+   OptionsTiffExporter::Predictor predictor = StringUtilities::fromXmlString<OptionsTiffExporter::Predictor>(
+      OptionsTiffExporter::getSettingGeoTiffPredictor());
+   int predictorIndex = mpPredictorCombo->findText(QString::fromStdString(StringUtilities::toDisplayString(predictor)));
+   mpPredictorCombo->setCurrentIndex(predictorIndex < 0 ? 0 : predictorIndex);
+
+   mpOverviewsCheck->setChecked(OptionsTiffExporter::getSettingGeoTiffOverviews());
 }
 
 GeoTiffExportOptionsWidget::~GeoTiffExportOptionsWidget()
@@ -110,7 +172,29 @@ int GeoTiffExportOptionsWidget::getRowsPerStrip() const
    return mpRowsPerStrip->value();
 }
 
-bool GeoTiffExportOptionsWidget::getPackBitsCompression() const
+OptionsTiffExporter::CompressionType GeoTiffExportOptionsWidget::getCompressionType() const
+{
+   return StringUtilities::fromDisplayString<OptionsTiffExporter::CompressionType>(
+      mpCompressionCombo->currentText().toStdString());
+}
+
+OptionsTiffExporter::Predictor GeoTiffExportOptionsWidget::getPredictor() const
+{
+   return StringUtilities::fromDisplayString<OptionsTiffExporter::Predictor>(
+      mpPredictorCombo->currentText().toStdString());
+}
+
+unsigned int GeoTiffExportOptionsWidget::getTileSize() const
+{
+   if (mpTiledCheck->isChecked() == false)
+   {
+      return 0;
+   }
+
+   return static_cast<unsigned int>(mpTileSize->value());
+}
+
+bool GeoTiffExportOptionsWidget::getGenerateOverviews() const
 {
-   return mpPackBits->isChecked();
+   return mpOverviewsCheck->isChecked();
 }
@@ -14,6 +14,7 @@
 #include "OptionsTiffExporter.h"
 
 class QCheckBox;
+class QComboBox;
 class QRadioButton;
 class QSpinBox;
 
@@ -27,13 +28,20 @@ public:
 
    OptionsTiffExporter::TransformationMethod getTransformationMethod() const;
    int getRowsPerStrip() const;
-   bool getPackBitsCompression() const;
+   OptionsTiffExporter::CompressionType getCompressionType() const;
+   OptionsTiffExporter::Predictor getPredictor() const;
+   unsigned int getTileSize() const;
+   bool getGenerateOverviews() const;
 
 private:
    QRadioButton* mpTiePointRadio;
    QRadioButton* mpMatrixRadio;
    QSpinBox* mpRowsPerStrip;
-   QCheckBox* mpPackBits;
+   QComboBox* mpCompressionCombo;
+   QComboBox* mpPredictorCombo;
+   QCheckBox* mpTiledCheck;
+   QSpinBox* mpTileSize;
+   QCheckBox* mpOverviewsCheck;
 };
 
 #endif
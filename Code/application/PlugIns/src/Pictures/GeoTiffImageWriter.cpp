@@ -0,0 +1,575 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AppVerify.h"
+#include "bthread.h"
+#include "ConfigurationSettings.h"
+#include "DMutex.h"
+#include "Endian.h"
+#include "GeoTiffImageWriter.h"
+#include "RasterUtilities.h"
+#include "switchOnEncoding.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <string.h>
+
+using namespace std;
+
+namespace
+{
+   uint16 getTiffSampleFormat(EncodingType type)
+   {
+      switch (type)
+      {
+      case INT1UBYTE:
+      case INT2UBYTES:
+      case INT4UBYTES:
+         return SAMPLEFORMAT_UINT;
+      case INT1SBYTE:
+      case INT2SBYTES:
+      case INT4SBYTES:
+         return SAMPLEFORMAT_INT;
+      case FLT4BYTES:
+      case FLT8BYTES:
+         return SAMPLEFORMAT_IEEEFP;
+      default:
+         break;
+      }
+      return SAMPLEFORMAT_VOID;
+   }
+
+   // Matches the horizontal differencing predictor in libtiff
+   template<typename T>
+   void horizontalDifference(T* pData, unsigned int rowCount, unsigned int rowElements, unsigned int stride)
+   {
+      for (unsigned int row = 0; row < rowCount; ++row)
+      {
+         T* pRow = pData + static_cast<size_t>(row) * rowElements;
+         for (unsigned int i = rowElements; i > stride; --i)
+         {
+            pRow[i - 1] = static_cast<T>(pRow[i - 1] - pRow[i - 1 - stride]);
+         }
+      }
+   }
+
+   // Matches the floating point predictor in libtiff, which splits each row into byte planes with the
+   // most significant bytes first and then differences the bytes
+   void floatingPointDifference(char* pData, unsigned int rowCount, unsigned int rowElements, unsigned int stride,
+      unsigned int bytesPerElement)
+   {
+      const bool bigEndian = (Endian::getSystemEndian() == BIG_ENDIAN_ORDER);
+      const size_t rowBytes = static_cast<size_t>(rowElements) * bytesPerElement;
+      vector<unsigned char> original(rowBytes);
+      for (unsigned int row = 0; row < rowCount; ++row)
+      {
+         unsigned char* pRow = reinterpret_cast<unsigned char*>(pData) + row * rowBytes;
+         memcpy(&original[0], pRow, rowBytes);
+         for (size_t element = 0; element < rowElements; ++element)
+         {
+            for (unsigned int byte = 0; byte < bytesPerElement; ++byte)
+            {
+               unsigned int plane = (bigEndian ? byte : bytesPerElement - byte - 1);
+               pRow[plane * rowElements + element] = original[element * bytesPerElement + byte];
+            }
+         }
+
+         for (size_t i = rowBytes; i > stride; --i)
+         {
+            pRow[i - 1] = static_cast<unsigned char>(pRow[i - 1] - pRow[i - 1 - stride]);
+         }
+      }
+   }
+
+   struct TileQueue
+   {
+      const vector<GeoTiffImageWriter::Tile*>* mpTiles;
+      size_t mNextTile;
+      bool mSuccess;
+      mta::DMutex mMutex;
+   };
+
+   void* compressTileQueue(void* pData)
+   {
+      TileQueue* pQueue = reinterpret_cast<TileQueue*>(pData);
+      for (;;)
+      {
+         GeoTiffImageWriter::Tile* pTile = NULL;
+         {
+            mta::MutexLock lock(pQueue->mMutex);
+            if (pQueue->mSuccess == false || pQueue->mNextTile >= pQueue->mpTiles->size())
+            {
+               break;
+            }
+            pTile = (*pQueue->mpTiles)[pQueue->mNextTile++];
+         }
+
+         if (pTile == NULL || pTile->compress() == false)
+         {
+            mta::MutexLock lock(pQueue->mMutex);
+            pQueue->mSuccess = false;
+         }
+      }
+
+      return NULL;
+   }
+
+   bool compressTiles(const vector<GeoTiffImageWriter::Tile*>& tiles)
+   {
+      TileQueue queue;
+      queue.mpTiles = &tiles;
+      queue.mNextTile = 0;
+      queue.mSuccess = true;
+
+      size_t threadCount = min<size_t>(max(ConfigurationSettings::getSettingThreadCount(), 1U), tiles.size());
+
+      // The calling thread works through the queue as well
+      vector<BThread*> threads;
+      for (size_t i = 1; i < threadCount; ++i)
+      {
+         BThread* pThread = new BThread(&queue, reinterpret_cast<void*>(compressTileQueue));
+         if (pThread->ThreadLaunch() == false)
+         {
+            delete pThread;
+            break;
+         }
+         threads.push_back(pThread);
+      }
+
+      compressTileQueue(&queue);
+
+      for (vector<BThread*>::iterator iter = threads.begin(); iter != threads.end(); ++iter)
+      {
+         (*iter)->ThreadWait();
+         delete *iter;
+      }
+
+      return queue.mSuccess;
+   }
+
+   template<typename T>
+   void averageRows(T* pDest, const char* pRow1, const char* pRow2, unsigned int sourceColumns,
+      unsigned int destColumns, unsigned int bands)
+   {
+      const T* pSource1 = reinterpret_cast<const T*>(pRow1);
+      const T* pSource2 = reinterpret_cast<const T*>(pRow2);
+      for (unsigned int column = 0; column < destColumns; ++column)
+      {
+         // The last column and row of an odd sized image are averaged with themselves only
+         const unsigned int firstColumn = 2 * column;
+         const unsigned int columnCount = (firstColumn + 1 < sourceColumns ? 2 : 1);
+         for (unsigned int band = 0; band < bands; ++band)
+         {
+            double sum = 0.0;
+            unsigned int count = 0;
+            for (unsigned int i = 0; i < columnCount; ++i)
+            {
+               const size_t index = static_cast<size_t>(firstColumn + i) * bands + band;
+               sum += pSource1[index];
+               ++count;
+               if (pSource2 != NULL)
+               {
+                  sum += pSource2[index];
+                  ++count;
+               }
+            }
+
+            double value = sum / count;
+            if (numeric_limits<T>::is_integer)
+            {
+               value = floor(value + 0.5);
+            }
+
+            pDest[column * bands + band] = static_cast<T>(value);
+         }
+      }
+   }
+}
+
+GeoTiffImageWriter::Tile::Tile(const GeoTiffImageWriter& writer, size_t bytes) :
+   mIndex(0),
+   mData(bytes, 0),
+   mWriter(writer)
+{
+}
+
+bool GeoTiffImageWriter::Tile::compress()
+{
+   if (mData.empty() == true)
+   {
+      return false;
+   }
+
+   mWriter.applyPredictor(&mData[0]);
+
+   uLongf compressedSize = compressBound(static_cast<uLong>(mData.size()));
+   vector<char> compressed(compressedSize);
+   if (compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressedSize,
+      reinterpret_cast<const Bytef*>(&mData[0]), static_cast<uLong>(mData.size()), Z_DEFAULT_COMPRESSION) != Z_OK)
+   {
+      return false;
+   }
+
+   compressed.resize(compressedSize);
+   mData.swap(compressed);
+   return true;
+}
+
+GeoTiffImageWriter::GeoTiffImageWriter(TIFF* pTiff, EncodingType dataType, unsigned int columns, unsigned int rows,
+                                       unsigned int bands) :
+   mpTiff(pTiff),
+   mDataType(dataType),
+   mColumns(columns),
+   mRows(rows),
+   mBands(bands),
+   mBytesPerElement(static_cast<unsigned int>(RasterUtilities::bytesInEncoding(dataType))),
+   mCompression(COMPRESSION_NONE),
+   mPredictor(PREDICTOR_NONE),
+   mTileSize(0),
+   mParallel(false),
+   mCurrentRow(0),
+   mBufferedRows(0),
+   mBufferCapacity(0)
+{
+}
+
+GeoTiffImageWriter::~GeoTiffImageWriter()
+{
+}
+
+bool GeoTiffImageWriter::initialize(uint16 compression, uint16 predictor, unsigned int tileSize,
+                                    unsigned int rowsPerStrip, bool reducedImage)
+{
+   VERIFY(mpTiff != NULL);
+   if (mColumns == 0 || mRows == 0 || mBands == 0 || mBytesPerElement == 0 || (tileSize % 16) != 0)
+   {
+      return false;
+   }
+
+   mCompression = compression;
+   mPredictor = (supportsPredictor(compression) ? predictor : static_cast<uint16>(PREDICTOR_NONE));
+   mTileSize = tileSize;
+
+   bool success = true;
+   if (reducedImage == true)
+   {
+      success = success && TIFFSetField(mpTiff, TIFFTAG_SUBFILETYPE, FILETYPE_REDUCEDIMAGE) != 0;
+   }
+
+   success = success && TIFFSetField(mpTiff, TIFFTAG_IMAGEWIDTH, mColumns) != 0;
+   success = success && TIFFSetField(mpTiff, TIFFTAG_IMAGELENGTH, mRows) != 0;
+   success = success && TIFFSetField(mpTiff, TIFFTAG_SAMPLESPERPIXEL, static_cast<uint16>(mBands)) != 0;
+
+   //for this tag, must multiply by # of bytes per data type
+   success = success && TIFFSetField(mpTiff, TIFFTAG_BITSPERSAMPLE, static_cast<uint16>(mBytesPerElement * 8)) != 0;
+   success = success && TIFFSetField(mpTiff, TIFFTAG_SAMPLEFORMAT, getTiffSampleFormat(mDataType)) != 0;
+   success = success && TIFFSetField(mpTiff, TIFFTAG_COMPRESSION, mCompression) != 0;
+   success = success && TIFFSetField(mpTiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB) != 0;
+   success = success && TIFFSetField(mpTiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG) != 0;
+   success = success && TIFFSetField(mpTiff, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT) != 0;
+   if (mPredictor != PREDICTOR_NONE)
+   {
+      success = success && TIFFSetField(mpTiff, TIFFTAG_PREDICTOR, mPredictor) != 0;
+   }
+
+   const size_t rowBytes = static_cast<size_t>(mColumns) * mBands * mBytesPerElement;
+   if (mTileSize == 0)
+   {
+      success = success && TIFFSetField(mpTiff, TIFFTAG_ROWSPERSTRIP, max(rowsPerStrip, 1U)) != 0;
+
+      // libtiff applies the predictor in place, so rows are copied before they are written
+      if (mPredictor != PREDICTOR_NONE)
+      {
+         mBuffer.resize(rowBytes);
+      }
+   }
+   else
+   {
+      success = success && TIFFSetField(mpTiff, TIFFTAG_TILEWIDTH, mTileSize) != 0;
+      success = success && TIFFSetField(mpTiff, TIFFTAG_TILELENGTH, mTileSize) != 0;
+
+      // Buffer enough rows of tiles to keep every worker thread busy
+      unsigned int tileRows = 1;
+      mParallel = (mCompression == COMPRESSION_ADOBE_DEFLATE);
+      if (mParallel == true)
+      {
+         const unsigned int tilesAcross = (mColumns + mTileSize - 1) / mTileSize;
+         const unsigned int threadCount = max(ConfigurationSettings::getSettingThreadCount(), 1U);
+         tileRows = max((2 * threadCount + tilesAcross - 1) / tilesAcross, 1U);
+      }
+
+      mBufferCapacity = min(tileRows * mTileSize, mRows);
+      mBuffer.resize(mBufferCapacity * rowBytes);
+   }
+
+   return success;
+}
+
+bool GeoTiffImageWriter::writeRow(const void* pRow)
+{
+   if (pRow == NULL || mCurrentRow >= mRows)
+   {
+      return false;
+   }
+
+   const size_t rowBytes = static_cast<size_t>(mColumns) * mBands * mBytesPerElement;
+   if (mTileSize == 0)
+   {
+      void* pData = const_cast<void*>(pRow);
+      if (mBuffer.empty() == false)
+      {
+         memcpy(&mBuffer[0], pRow, rowBytes);
+         pData = &mBuffer[0];
+      }
+
+      if (TIFFWriteScanline(mpTiff, pData, mCurrentRow, 0) < 0)
+      {
+         return false;
+      }
+
+      ++mCurrentRow;
+      return true;
+   }
+
+   memcpy(&mBuffer[mBufferedRows * rowBytes], pRow, rowBytes);
+   ++mBufferedRows;
+   ++mCurrentRow;
+   if (mBufferedRows == mBufferCapacity || mCurrentRow == mRows)
+   {
+      return writeTiles();
+   }
+
+   return true;
+}
+
+bool GeoTiffImageWriter::finish()
+{
+   if (mTileSize > 0 && mBufferedRows > 0 && writeTiles() == false)
+   {
+      return false;
+   }
+
+   return mCurrentRow == mRows;
+}
+
+bool GeoTiffImageWriter::supportsPredictor(uint16 compression)
+{
+   switch (compression)
+   {
+   case COMPRESSION_LZW:
+   case COMPRESSION_ADOBE_DEFLATE:
+   case COMPRESSION_DEFLATE:
+#ifdef COMPRESSION_ZSTD
+   case COMPRESSION_ZSTD:
+#endif
+      return true;
+   default:
+      break;
+   }
+
+   return false;
+}
+
+bool GeoTiffImageWriter::writeTiles()
+{
+   const size_t pixelBytes = static_cast<size_t>(mBands) * mBytesPerElement;
+   const size_t rowBytes = mColumns * pixelBytes;
+   const size_t tileRowBytes = mTileSize * pixelBytes;
+   const size_t tileBytes = mTileSize * tileRowBytes;
+   const unsigned int firstRow = mCurrentRow - mBufferedRows;
+
+   // Partial tiles at the right and bottom edges are padded with zeros
+   vector<Tile*> tiles;
+   for (unsigned int tileRow = 0; tileRow < mBufferedRows; tileRow += mTileSize)
+   {
+      const unsigned int rowCount = min(mTileSize, mBufferedRows - tileRow);
+      for (unsigned int column = 0; column < mColumns; column += mTileSize)
+      {
+         Tile* pTile = new Tile(*this, tileBytes);
+         pTile->mIndex = TIFFComputeTile(mpTiff, column, firstRow + tileRow, 0, 0);
+
+         const size_t copyBytes = min(mTileSize, mColumns - column) * pixelBytes;
+         for (unsigned int row = 0; row < rowCount; ++row)
+         {
+            memcpy(&pTile->mData[row * tileRowBytes], &mBuffer[(tileRow + row) * rowBytes + column * pixelBytes],
+               copyBytes);
+         }
+
+         tiles.push_back(pTile);
+      }
+   }
+
+   bool success = true;
+   if (mParallel == true)
+   {
+      success = compressTiles(tiles);
+      for (vector<Tile*>::iterator iter = tiles.begin(); success && iter != tiles.end(); ++iter)
+      {
+         Tile* pTile = *iter;
+         success = TIFFWriteRawTile(mpTiff, pTile->mIndex, &pTile->mData[0],
+            static_cast<tsize_t>(pTile->mData.size())) >= 0;
+      }
+   }
+   else
+   {
+      for (vector<Tile*>::iterator iter = tiles.begin(); success && iter != tiles.end(); ++iter)
+      {
+         Tile* pTile = *iter;
+         success = TIFFWriteEncodedTile(mpTiff, pTile->mIndex, &pTile->mData[0],
+            static_cast<tsize_t>(pTile->mData.size())) >= 0;
+      }
+   }
+
+   for (vector<Tile*>::iterator iter = tiles.begin(); iter != tiles.end(); ++iter)
+   {
+      delete *iter;
+   }
+
+   mBufferedRows = 0;
+   return success;
+}
+
+void GeoTiffImageWriter::applyPredictor(char* pTile) const
+{
+   const unsigned int rowElements = mTileSize * mBands;
+   if (mPredictor == PREDICTOR_HORIZONTAL)
+   {
+      switch (mBytesPerElement)
+      {
+      case 1:
+         horizontalDifference(reinterpret_cast<unsigned char*>(pTile), mTileSize, rowElements, mBands);
+         break;
+      case 2:
+         horizontalDifference(reinterpret_cast<unsigned short*>(pTile), mTileSize, rowElements, mBands);
+         break;
+      case 4:
+         horizontalDifference(reinterpret_cast<unsigned int*>(pTile), mTileSize, rowElements, mBands);
+         break;
+      default:
+         break;
+      }
+   }
+   else if (mPredictor == PREDICTOR_FLOATINGPOINT)
+   {
+      floatingPointDifference(pTile, mTileSize, rowElements, mBands, mBytesPerElement);
+   }
+}
+
+GeoTiffOverview::GeoTiffOverview(EncodingType dataType, unsigned int columns, unsigned int rows, unsigned int bands,
+                                 unsigned int minimumSize) :
+   mDataType(dataType),
+   mColumns(columns),
+   mBands(bands),
+   mBytesPerElement(static_cast<unsigned int>(RasterUtilities::bytesInEncoding(dataType)))
+{
+   const size_t pixelBytes = static_cast<size_t>(mBands) * mBytesPerElement;
+   minimumSize = max(minimumSize, 1U);
+   while (columns > minimumSize || rows > minimumSize)
+   {
+      Level level;
+      level.mColumns = (columns + 1) / 2;
+      level.mRows = (rows + 1) / 2;
+      level.mRowsAdded = 0;
+      level.mHasPendingRow = false;
+      mLevels.push_back(level);
+
+      mLevels.back().mData.resize(static_cast<size_t>(level.mColumns) * level.mRows * pixelBytes);
+      mLevels.back().mPendingRow.resize(columns * pixelBytes);
+
+      columns = level.mColumns;
+      rows = level.mRows;
+   }
+}
+
+void GeoTiffOverview::addRow(const void* pRow)
+{
+   if (pRow != NULL)
+   {
+      addLevelRow(0, reinterpret_cast<const char*>(pRow));
+   }
+}
+
+void GeoTiffOverview::finish()
+{
+   // Flushing a level can leave a pending row in the next level, which is flushed in turn
+   for (unsigned int level = 0; level < mLevels.size(); ++level)
+   {
+      Level& current = mLevels[level];
+      if (current.mHasPendingRow == true)
+      {
+         current.mHasPendingRow = false;
+         reduceRows(level, &current.mPendingRow[0], NULL);
+      }
+   }
+}
+
+unsigned int GeoTiffOverview::getLevelCount() const
+{
+   return static_cast<unsigned int>(mLevels.size());
+}
+
+unsigned int GeoTiffOverview::getColumnCount(unsigned int level) const
+{
+   return (level < mLevels.size() ? mLevels[level].mColumns : 0);
+}
+
+unsigned int GeoTiffOverview::getRowCount(unsigned int level) const
+{
+   return (level < mLevels.size() ? mLevels[level].mRows : 0);
+}
+
+const void* GeoTiffOverview::getRow(unsigned int level, unsigned int row) const
+{
+   if (level >= mLevels.size() || row >= mLevels[level].mRowsAdded)
+   {
+      return NULL;
+   }
+
+   const Level& current = mLevels[level];
+   return &current.mData[static_cast<size_t>(row) * current.mColumns * mBands * mBytesPerElement];
+}
+
+void GeoTiffOverview::addLevelRow(unsigned int level, const char* pRow)
+{
+   if (level >= mLevels.size())
+   {
+      return;
+   }
+
+   Level& current = mLevels[level];
+   if (current.mHasPendingRow == false)
+   {
+      memcpy(&current.mPendingRow[0], pRow, current.mPendingRow.size());
+      current.mHasPendingRow = true;
+      return;
+   }
+
+   current.mHasPendingRow = false;
+   reduceRows(level, &current.mPendingRow[0], pRow);
+}
+
+void GeoTiffOverview::reduceRows(unsigned int level, const char* pRow1, const char* pRow2)
+{
+   Level& current = mLevels[level];
+   if (current.mRowsAdded >= current.mRows)
+   {
+      return;
+   }
+
+   const unsigned int sourceColumns = (level == 0 ? mColumns : mLevels[level - 1].mColumns);
+   char* pDest = &current.mData[static_cast<size_t>(current.mRowsAdded) * current.mColumns * mBands *
+      mBytesPerElement];
+   switchOnEncoding(mDataType, averageRows, pDest, pRow1, pRow2, sourceColumns, current.mColumns, mBands);
+   ++current.mRowsAdded;
+
+   addLevelRow(level + 1, pDest);
+}
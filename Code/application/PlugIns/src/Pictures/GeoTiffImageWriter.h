@@ -0,0 +1,201 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef GEOTIFFIMAGEWRITER_H
+#define GEOTIFFIMAGEWRITER_H
+
+#include "TypesFile.h"
+
+#include <tiffio.h>
+
+#include <vector>
+
+/**
+ * Writes the pixel data of the current TIFF directory one row at a time.
+ *
+ * Rows are written as strips with TIFFWriteScanline() unless a tile size is given, in
+ * which case they are buffered until complete rows of tiles are available.  Deflate
+ * compressed tiles are run through the predictor and compressed on worker threads, then
+ * written in order with TIFFWriteRawTile() so that only the calling thread ever calls
+ * into libtiff.  Tiles using other compression schemes are encoded by libtiff on the
+ * calling thread.
+ */
+class GeoTiffImageWriter
+{
+public:
+   /**
+    * Creates a writer for the current directory of a TIFF file.
+    *
+    * @param  pTiff
+    *         The file to write.
+    * @param  dataType
+    *         The data type of each sample.
+    * @param  columns
+    *         The image width.
+    * @param  rows
+    *         The image height.
+    * @param  bands
+    *         The number of samples in each pixel.
+    */
+   GeoTiffImageWriter(TIFF* pTiff, EncodingType dataType, unsigned int columns, unsigned int rows,
+      unsigned int bands);
+   ~GeoTiffImageWriter();
+
+   /**
+    * Sets the tags describing the image structure in the current directory.
+    *
+    * @param  compression
+    *         The libtiff compression scheme.
+    * @param  predictor
+    *         The libtiff predictor.  This is ignored unless the compression scheme supports predictors.
+    * @param  tileSize
+    *         The width and height of each tile, which must be a multiple of 16, or 0 to write strips.
+    * @param  rowsPerStrip
+    *         The number of rows in each strip when \em tileSize is 0.
+    * @param  reducedImage
+    *         True if the directory holds a reduced resolution copy of the previous image.
+    *
+    * @return True if the tags were set, false otherwise.
+    */
+   bool initialize(uint16 compression, uint16 predictor, unsigned int tileSize, unsigned int rowsPerStrip,
+      bool reducedImage);
+
+   /**
+    * Writes the next row of the image.
+    *
+    * @param  pRow
+    *         The row data in BIP order.  The data is not modified.
+    *
+    * @return True if the row was written or buffered successfully, false otherwise.
+    */
+   bool writeRow(const void* pRow);
+
+   /**
+    * Writes any buffered rows.  This must be called after the last row is written.
+    *
+    * @return True if every row of the image has been written, false otherwise.
+    */
+   bool finish();
+
+   /**
+    * Queries whether a compression scheme supports the predictor tag.
+    *
+    * @param  compression
+    *         The libtiff compression scheme.
+    *
+    * @return True if TIFFTAG_PREDICTOR can be used with the compression scheme, false otherwise.
+    */
+   static bool supportsPredictor(uint16 compression);
+
+   class Tile
+   {
+   public:
+      Tile(const GeoTiffImageWriter& writer, size_t bytes);
+      bool compress();
+
+      ttile_t mIndex;
+      std::vector<char> mData;
+
+   private:
+      Tile& operator=(const Tile& rhs);
+
+      const GeoTiffImageWriter& mWriter;
+   };
+
+private:
+   GeoTiffImageWriter(const GeoTiffImageWriter& rhs);
+   GeoTiffImageWriter& operator=(const GeoTiffImageWriter& rhs);
+
+   bool writeTiles();
+   void applyPredictor(char* pTile) const;
+
+   TIFF* mpTiff;
+   EncodingType mDataType;
+   unsigned int mColumns;
+   unsigned int mRows;
+   unsigned int mBands;
+   unsigned int mBytesPerElement;
+   uint16 mCompression;
+   uint16 mPredictor;
+   unsigned int mTileSize;
+   bool mParallel;
+   unsigned int mCurrentRow;
+   unsigned int mBufferedRows;
+   unsigned int mBufferCapacity;
+   std::vector<char> mBuffer;
+};
+
+/**
+ * Builds reduced resolution overviews of an image in a single pass over its rows.
+ *
+ * Each level halves the width and height of the previous level by averaging blocks of
+ * two by two pixels.  Levels are added until both dimensions are no larger than the
+ * minimum size.  Every level is held in memory, which requires about a third of the
+ * memory of the full resolution image.
+ */
+class GeoTiffOverview
+{
+public:
+   /**
+    * Creates the overview levels for an image.
+    *
+    * @param  dataType
+    *         The data type of each sample.
+    * @param  columns
+    *         The full resolution image width.
+    * @param  rows
+    *         The full resolution image height.
+    * @param  bands
+    *         The number of samples in each pixel.
+    * @param  minimumSize
+    *         The size at which no further levels are created.
+    */
+   GeoTiffOverview(EncodingType dataType, unsigned int columns, unsigned int rows, unsigned int bands,
+      unsigned int minimumSize);
+
+   /**
+    * Adds the next full resolution row.
+    *
+    * @param  pRow
+    *         The row data in BIP order.
+    */
+   void addRow(const void* pRow);
+
+   /**
+    * Completes the levels after the last full resolution row has been added.
+    */
+   void finish();
+
+   unsigned int getLevelCount() const;
+   unsigned int getColumnCount(unsigned int level) const;
+   unsigned int getRowCount(unsigned int level) const;
+   const void* getRow(unsigned int level, unsigned int row) const;
+
+private:
+   struct Level
+   {
+      unsigned int mColumns;
+      unsigned int mRows;
+      unsigned int mRowsAdded;
+      std::vector<char> mData;
+      std::vector<char> mPendingRow;
+      bool mHasPendingRow;
+   };
+
+   void addLevelRow(unsigned int level, const char* pRow);
+   void reduceRows(unsigned int level, const char* pRow1, const char* pRow2);
+
+   EncodingType mDataType;
+   unsigned int mColumns;
+   unsigned int mBands;
+   unsigned int mBytesPerElement;
+   std::vector<Level> mLevels;
+};
+
+#endif
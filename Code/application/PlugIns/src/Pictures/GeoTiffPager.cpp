@@ -529,11 +529,11 @@ RasterPage* GeoTiffPager::getPage(DataRequest *pOriginalRequest,
          const unsigned int columnSkip(mColumnCount);
 
          // The offset of the first requested data within pPage
-         const size_t offset(mBytesPerElement *
-            ((rowNumber % tileLength) * columnSkip * bandSkip + (mInterleave == BSQ ? 0 : bandNumber)));
+         const size_t offset(mBytesPerElement * ((rowNumber % tileLength) * columnSkip * bandSkip +
+            colNumber * bandSkip + (mInterleave == BSQ ? 0 : bandNumber)));
 
-         // The number of rows in pPage
-         const unsigned int rowSkip(tileLength * ((endTile - startTile + 1) / tilesAcross));
+         // The number of rows in pPage starting with the first requested row
+         const unsigned int rowSkip(tileLength * ((endTile - startTile + 1) / tilesAcross) - rowNumber % tileLength);
 
          // Create a GeoTiffPage based on the computed values
          pPage = new GeoTiffPage(pCacheUnit, offset, rowSkip, columnSkip, bandSkip);
@@ -552,7 +552,8 @@ RasterPage* GeoTiffPager::getPage(DataRequest *pOriginalRequest,
                char* pBlockPos(pCacheUnit->data());
 
                // Increment by one or more rows of tiles
-               pBlockPos += tileSize * tilesAcross * bandSkip * mBytesPerElement * (tileNum / tilesAcross);
+               pBlockPos += static_cast<size_t>(tileLength) * mColumnCount * bandSkip * mBytesPerElement *
+                  (tileNum / tilesAcross);
 
                // Increment by one or more tiles within a row
                pBlockPos += tileWidth * bandSkip * mBytesPerElement * (tileNum % tilesAcross);
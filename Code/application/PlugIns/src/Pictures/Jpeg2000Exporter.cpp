@@ -53,6 +53,18 @@ Jpeg2000Exporter::Jpeg2000Exporter()
 Jpeg2000Exporter::~Jpeg2000Exporter()
 {}
 
+std::string Jpeg2000Exporter::tileSizeArg()
+{
+   static std::string sArgName = "Tile Size";
+   return sArgName;
+}
+
+std::string Jpeg2000Exporter::resolutionLevelsArg()
+{
+   static std::string sArgName = "Resolution Levels";
+   return sArgName;
+}
+
 bool Jpeg2000Exporter::getInputSpecification(PlugInArgList*& pArgList)
 {
    Service<PlugInManagerServices> pPlugInManager;
@@ -66,6 +78,14 @@ bool Jpeg2000Exporter::getInputSpecification(PlugInArgList*& pArgList)
    VERIFY(pArgList->addArg<RasterFileDescriptor>(Exporter::ExportDescriptorArg(), NULL, "File descriptor for the "
       "output file."));
    VERIFY(pArgList->addArg<View>(Executable::ViewArg(), "View to be exported."));
+
+   unsigned int tileSize = 0;
+   VERIFY(pArgList->addArg<unsigned int>(Jpeg2000Exporter::tileSizeArg(), &tileSize, "The width and height in pixels "
+      "of the square tiles in the codestream.  If no value is provided or the value is zero, the image is "
+      "written as a single tile."));
+   unsigned int resolutionLevels = 1;
+   VERIFY(pArgList->addArg<unsigned int>(Jpeg2000Exporter::resolutionLevelsArg(), &resolutionLevels, "The number of "
+      "resolution levels in the codestream.  If no value is provided, only the full resolution is written."));
    return true;
 }
 
@@ -161,6 +181,25 @@ bool Jpeg2000Exporter::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArg
    parameters.tcp_rates[0] = 0;
    parameters.tcp_numlayers = 1;
    parameters.cp_disto_alloc = 1;
+
+   // Optionally write a tiled codestream with reduced resolution levels, which the pager can decode selectively.
+   unsigned int resolutionLevels = 1;
+   if (pInArgList->getPlugInArgValue<unsigned int>(Jpeg2000Exporter::resolutionLevelsArg(), resolutionLevels) &&
+      resolutionLevels > 1)
+   {
+      parameters.numresolution = static_cast<int>(resolutionLevels);
+   }
+
+   unsigned int tileSize = 0;
+   if (pInArgList->getPlugInArgValue<unsigned int>(Jpeg2000Exporter::tileSizeArg(), tileSize) && tileSize > 0)
+   {
+      parameters.tile_size_on = OPJ_TRUE;
+      parameters.cp_tx0 = 0;
+      parameters.cp_ty0 = 0;
+      parameters.cp_tdx = static_cast<int>(tileSize);
+      parameters.cp_tdy = static_cast<int>(tileSize);
+   }
+
    strncpy(parameters.outfile, filename.absoluteFilePath().toStdString().c_str(), sizeof(parameters.outfile) - 1);
 
    OPJ_COLOR_SPACE colorSpace = bandCount >= 3 ? OPJ_CLRSPC_SRGB : OPJ_CLRSPC_GRAY;
@@ -18,6 +18,9 @@ public:
    Jpeg2000Exporter();
    virtual ~Jpeg2000Exporter();
 
+   static std::string tileSizeArg();
+   static std::string resolutionLevelsArg();
+
    virtual bool getInputSpecification(PlugInArgList*& pArgList);
    virtual bool execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList);
 };
@@ -9,6 +9,7 @@
 
 #include "AppVerify.h"
 #include "AppVersion.h"
+#include "ConfigurationSettings.h"
 #include "DataRequest.h"
 #include "DimensionDescriptor.h"
 #include "Jpeg2000Pager.h"
@@ -24,10 +25,57 @@
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 
+#include <algorithm>
 #include <limits>
 
+// Decoding with several threads is available in OpenJPEG 2.2, and decoding several areas
+// with one codec is available for images with a single tile in OpenJPEG 2.3
+#if defined(OPJ_VERSION_MAJOR) && (OPJ_VERSION_MAJOR > 2 || (OPJ_VERSION_MAJOR == 2 && OPJ_VERSION_MINOR >= 2))
+#define OPJ_HAS_THREADS
+#endif
+#if defined(OPJ_VERSION_MAJOR) && (OPJ_VERSION_MAJOR > 2 || (OPJ_VERSION_MAJOR == 2 && OPJ_VERSION_MINOR >= 3))
+#define OPJ_HAS_REPEATED_DECODE
+#endif
+
 REGISTER_PLUGIN_BASIC(OpticksPictures, Jpeg2000Pager);
 
+namespace
+{
+   // The number of trailing zero bits which every on-disk number, offset by the image origin, has in common
+   unsigned int getCommonPowerOfTwo(const std::vector<DimensionDescriptor>& dims, unsigned int origin)
+   {
+      if (dims.size() < 2)
+      {
+         return 0;
+      }
+
+      unsigned int bits = 0;
+      for (std::vector<DimensionDescriptor>::const_iterator iter = dims.begin(); iter != dims.end(); ++iter)
+      {
+         bits |= origin + iter->getOnDiskNumber();
+      }
+
+      unsigned int power = 0;
+      while (bits != 0 && (bits & 1) == 0)
+      {
+         bits >>= 1;
+         ++power;
+      }
+
+      return power;
+   }
+
+   // Copies the low bytes of each decoded sample into every stride bytes of the destination
+   template <typename T>
+   void copySamples(const OPJ_INT32* pSource, const std::vector<int>& sourceColumns, char* pDest, size_t stride)
+   {
+      for (std::vector<int>::size_type c = 0; c < sourceColumns.size(); ++c, pDest += stride)
+      {
+         *reinterpret_cast<T*>(pDest) = static_cast<T>(pSource[sourceColumns[c]]);
+      }
+   }
+}
+
 size_t Jpeg2000Pager::msMaxCacheSize = 1024 * 1024 * 50; // Specify a cache size (50MB) larger than the default
                                                          // to minimize the number of calls to decode the image
 
@@ -35,7 +83,23 @@ Jpeg2000Pager::Jpeg2000Pager() :
    CachedPager(msMaxCacheSize),
    mpFile(NULL),
    mOffset(0),
-   mSize(0)
+   mSize(0),
+   mReducedResolution(false),
+   mInitialized(false),
+   mDecoderType(Jpeg2000Utilities::J2K_CFMT),
+   mStreamLength(0),
+   mImageX0(0),
+   mImageY0(0),
+   mTileY0(0),
+   mTileHeight(0),
+   mNumTiles(0),
+   mNumResolutions(1),
+   mBandFactor(1),
+   mReduce(0),
+   mKeepDecoder(false),
+   mpStream(NULL),
+   mpCodec(NULL),
+   mpImage(NULL)
 {
    setName("JPEG2000 Pager");
    setCopyright(APP_COPYRIGHT);
@@ -49,6 +113,8 @@ Jpeg2000Pager::Jpeg2000Pager() :
 
 Jpeg2000Pager::~Jpeg2000Pager()
 {
+   closeDecoder();
+
    if (mpFile != NULL)
    {
       fclose(mpFile);
@@ -68,6 +134,12 @@ std::string Jpeg2000Pager::sizeArg()
    return sArgName;
 }
 
+std::string Jpeg2000Pager::reducedResolutionArg()
+{
+   static std::string sArgName = "Use Reduced Resolutions";
+   return sArgName;
+}
+
 bool Jpeg2000Pager::getInputSpecification(PlugInArgList*& pArgList)
 {
    if (CachedPager::getInputSpecification(pArgList) == false)
@@ -82,6 +154,10 @@ bool Jpeg2000Pager::getInputSpecification(PlugInArgList*& pArgList)
    VERIFY(pArgList->addArg<uint64_t>(Jpeg2000Pager::sizeArg(), &mSize, "The size in bytes of the JPEG2000 data "
       "contained in the file.  If no value is provided, the data is presumed to continue from the offset to "
       "the end of the file."));
+   VERIFY(pArgList->addArg<bool>(Jpeg2000Pager::reducedResolutionArg(), &mReducedResolution, "Whether data imported with "
+      "the same power of two skip factor for rows and columns is read from the matching reduced resolution "
+      "level of the codestream.  The reduced levels are filtered rather than sampled, so the values can differ "
+      "from the full resolution values.  If no value is provided, the full resolution is always read."));
 
    return true;
 }
@@ -96,6 +172,7 @@ bool Jpeg2000Pager::parseInputArgs(PlugInArgList* pArgList)
    VERIFY(pArgList != NULL);
    VERIFY(pArgList->getPlugInArgValue<uint64_t>(Jpeg2000Pager::offsetArg(), mOffset));
    VERIFY(pArgList->getPlugInArgValue<uint64_t>(Jpeg2000Pager::sizeArg(), mSize));
+   VERIFY(pArgList->getPlugInArgValue<bool>(Jpeg2000Pager::reducedResolutionArg(), mReducedResolution));
 
    return true;
 }
@@ -107,7 +184,7 @@ bool Jpeg2000Pager::openFile(const std::string& filename)
       return false;
    }
 
-   mpFilename = const_cast<char *>(filename.c_str());
+   mFilename = filename;
    mpFile = fopen(filename.c_str(), "rb");
    return (mpFile != NULL);
 }
@@ -149,7 +226,6 @@ CachedPage::UnitPtr Jpeg2000Pager::fetchUnit(DataRequest* pOriginalRequest)
 
    DimensionDescriptor startColumn = pOriginalRequest->getStartColumn();
    DimensionDescriptor stopColumn = pOriginalRequest->getStopColumn();
-   unsigned int concurrentColumns = pOriginalRequest->getConcurrentColumns();
 
    DimensionDescriptor startBand = pOriginalRequest->getStartBand();
    DimensionDescriptor stopBand = pOriginalRequest->getStopBand();
@@ -173,38 +249,43 @@ CachedPage::UnitPtr Jpeg2000Pager::fetchUnit(DataRequest* pOriginalRequest)
       concurrentRows = stopRow.getActiveNumber() - startRow.getActiveNumber() + 1;
    }
 
-   if ((startColumn.getActiveNumber() + concurrentColumns - 1) > stopColumn.getActiveNumber())
+   if (mInitialized == false && initialize(pDescriptor) == false)
    {
-      concurrentColumns = stopColumn.getActiveNumber() - startColumn.getActiveNumber() + 1;
+      return CachedPage::UnitPtr();
    }
 
+   // Extend the rows to whole rows of tiles so that no tile is partially decoded more than once
+   unsigned int firstRow = startRow.getActiveNumber();
+   unsigned int lastRow = firstRow + concurrentRows - 1;
+   alignToTiles(firstRow, lastRow, pDescriptor);
+
    // Populate the image data based on the output data type
    EncodingType outputDataType = pDescriptor->getDataType();
    switch (outputDataType)
    {
    case INT1UBYTE:
-      return populateImageData<unsigned char>(startRow, startColumn, concurrentRows, concurrentColumns);
+      return populateImageData<unsigned char>(pDescriptor, firstRow, lastRow);
 
    case INT1SBYTE:
-      return populateImageData<signed char>(startRow, startColumn, concurrentRows, concurrentColumns);
+      return populateImageData<signed char>(pDescriptor, firstRow, lastRow);
 
    case INT2UBYTES:
-      return populateImageData<unsigned short>(startRow, startColumn, concurrentRows, concurrentColumns);
+      return populateImageData<unsigned short>(pDescriptor, firstRow, lastRow);
 
    case INT2SBYTES:
-      return populateImageData<signed short>(startRow, startColumn, concurrentRows, concurrentColumns);
+      return populateImageData<signed short>(pDescriptor, firstRow, lastRow);
 
    case INT4UBYTES:
-      return populateImageData<unsigned int>(startRow, startColumn, concurrentRows, concurrentColumns);
+      return populateImageData<unsigned int>(pDescriptor, firstRow, lastRow);
 
    case INT4SBYTES:
-      return populateImageData<signed int>(startRow, startColumn, concurrentRows, concurrentColumns);
+      return populateImageData<signed int>(pDescriptor, firstRow, lastRow);
 
    case FLT4BYTES:
-      return populateImageData<float>(startRow, startColumn, concurrentRows, concurrentColumns);
+      return populateImageData<float>(pDescriptor, firstRow, lastRow);
 
    case FLT8BYTES:
-      return populateImageData<double>(startRow, startColumn, concurrentRows, concurrentColumns);
+      return populateImageData<double>(pDescriptor, firstRow, lastRow);
 
    default:
       break;
@@ -219,27 +300,160 @@ double Jpeg2000Pager::getChunkSize() const
    return msMaxCacheSize;
 }
 
-template <typename Out>
-CachedPage::UnitPtr Jpeg2000Pager::populateImageData(const DimensionDescriptor& startRow,
-                                                     const DimensionDescriptor& startColumn,
-                                                     unsigned int concurrentRows, unsigned int concurrentColumns) const
+bool Jpeg2000Pager::initialize(const RasterDataDescriptor* pDescriptor)
 {
-   VERIFYRV(startRow.isOnDiskNumberValid() == true, CachedPage::UnitPtr());
-   VERIFYRV(startColumn.isOnDiskNumberValid() == true, CachedPage::UnitPtr());
-   VERIFYRV(concurrentRows > 0, CachedPage::UnitPtr());
-   VERIFYRV(concurrentColumns > 0, CachedPage::UnitPtr());
+   VERIFY(pDescriptor != NULL);
+   VERIFY(mpFile != NULL);
 
-   // Get the rows, colums, and bands to load
-   unsigned int onDiskStartRow = startRow.getOnDiskNumber();
-   unsigned int onDiskStopRow = onDiskStartRow + concurrentRows;
-   unsigned int onDiskStartColumn = startColumn.getOnDiskNumber();
-   unsigned int onDiskStopColumn = onDiskStartColumn + concurrentColumns;
+   // Get the length of the codestream
+   if (mSize > 0)
+   {
+      mStreamLength = static_cast<size_t>(mSize);
+   }
+   else
+   {
+      fseek(mpFile, 0, SEEK_END);
+
+      size_t fileSize = static_cast<size_t>(ftell(mpFile));
+      if (fileSize <= mOffset)
+      {
+         return false;
+      }
+
+      mStreamLength = fileSize - static_cast<size_t>(mOffset);
+   }
+
+   // Read the header once, first trying the codestream format then the file format
+   opj_stream_t* pStream = NULL;
+   opj_codec_t* pCodec = NULL;
+   opj_image_t* pImage = NULL;
+   mDecoderType = Jpeg2000Utilities::J2K_CFMT;
+   if (openDecoder(mDecoderType, 0, pStream, pCodec, pImage) == false)
+   {
+      mDecoderType = Jpeg2000Utilities::JP2_CFMT;
+      if (openDecoder(mDecoderType, 0, pStream, pCodec, pImage) == false)
+      {
+         return false;
+      }
+   }
+
+   mImageX0 = pImage->x0;
+   mImageY0 = pImage->y0;
+
+   opj_codestream_info_v2_t* pInfo = opj_get_cstr_info(pCodec);
+   if (pInfo != NULL)
+   {
+      mTileY0 = pInfo->ty0;
+      mTileHeight = pInfo->tdy;
+      mNumTiles = pInfo->tw * pInfo->th;
+      if (pInfo->m_default_tile_info.tccp_info != NULL)
+      {
+         mNumResolutions = std::max(pInfo->m_default_tile_info.tccp_info[0].numresolutions, 1U);
+      }
+
+      opj_destroy_cstr_info(&pInfo);
+   }
 
+   opj_image_destroy(pImage);
+   opj_destroy_codec(pCodec);
+   opj_stream_destroy(pStream);
+
+   // Get the number of 16-bit components used for each band from the data type in the filename
    const RasterElement* pRaster = getRasterElement();
-   VERIFYRV(pRaster != NULL, CachedPage::UnitPtr());
+   VERIFY(pRaster != NULL);
 
-   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(pRaster->getDataDescriptor());
+   std::string filename = pRaster->getFilename();
+   if (filename.empty() == false)
+   {
+      QStringList parts = QString::fromStdString(filename).split('.');
+      foreach (QString part, parts)
+      {
+         bool error;
+         EncodingType dataType = StringUtilities::fromXmlString<EncodingType>(part.toStdString(), &error);
+         if (dataType.isValid() == true && error == false)
+         {
+            int currentBandFactor = Jpeg2000Utilities::get_num_bands(dataType);
+            if (currentBandFactor > 0)
+            {
+               mBandFactor = currentBandFactor;
+               break;
+            }
+         }
+      }
+   }
+
+   // When rows and columns were imported with the same power of two skip factor, decode the matching
+   // reduced resolution level instead of the full resolution.  Values split into several components
+   // cannot be filtered, so they are always read at full resolution.
+   mReduce = 0;
+   if (mReducedResolution == true && mBandFactor == 1)
+   {
+      mReduce = std::min(getCommonPowerOfTwo(pDescriptor->getRows(), mImageY0),
+         getCommonPowerOfTwo(pDescriptor->getColumns(), mImageX0));
+      mReduce = std::min(mReduce, mNumResolutions - 1);
+   }
+
+#if defined(OPJ_HAS_REPEATED_DECODE)
+   mKeepDecoder = (mNumTiles == 1);
+#endif
+
+   mInitialized = true;
+   return true;
+}
+
+void Jpeg2000Pager::alignToTiles(unsigned int& startRow, unsigned int& stopRow,
+                                 const RasterDataDescriptor* pDescriptor) const
+{
+   VERIFYNRV(pDescriptor != NULL);
+   if (mTileHeight == 0)
+   {
+      return;
+   }
+
+   const std::vector<DimensionDescriptor>& rows = pDescriptor->getRows();
+   VERIFYNRV(stopRow < rows.size());
+
+   unsigned int tileStart = rows[startRow].getOnDiskNumber() + mImageY0;
+   tileStart = mTileY0 + (tileStart - std::min(tileStart, mTileY0)) / mTileHeight * mTileHeight;
+   unsigned int tileStop = rows[stopRow].getOnDiskNumber() + mImageY0;
+   tileStop = mTileY0 + ((tileStop - std::min(tileStop, mTileY0)) / mTileHeight + 1) * mTileHeight;
+
+   unsigned int alignedStart = startRow;
+   while (alignedStart > 0 && rows[alignedStart - 1].getOnDiskNumber() + mImageY0 >= tileStart)
+   {
+      --alignedStart;
+   }
+
+   unsigned int alignedStop = stopRow;
+   while (alignedStop + 1 < rows.size() && rows[alignedStop + 1].getOnDiskNumber() + mImageY0 < tileStop)
+   {
+      ++alignedStop;
+   }
+
+   // Images with very tall tiles are decoded in smaller pieces rather than holding entire tiles in the cache
+   double rowSize = static_cast<double>(pDescriptor->getColumnCount()) * pDescriptor->getBandCount() *
+      pDescriptor->getBytesPerElement();
+   if ((alignedStop - alignedStart + 1) * rowSize <= 2.0 * getChunkSize())
+   {
+      startRow = alignedStart;
+      stopRow = alignedStop;
+   }
+}
+
+template <typename Out>
+CachedPage::UnitPtr Jpeg2000Pager::populateImageData(const RasterDataDescriptor* pDescriptor, unsigned int startRow,
+                                                     unsigned int stopRow)
+{
    VERIFYRV(pDescriptor != NULL, CachedPage::UnitPtr());
+   VERIFYRV(startRow <= stopRow, CachedPage::UnitPtr());
+
+   const std::vector<DimensionDescriptor>& rows = pDescriptor->getRows();
+   const std::vector<DimensionDescriptor>& columns = pDescriptor->getColumns();
+   VERIFYRV(stopRow < rows.size(), CachedPage::UnitPtr());
+   if (columns.empty() == true)
+   {
+      return CachedPage::UnitPtr();
+   }
 
    const RasterFileDescriptor* pFileDescriptor =
       dynamic_cast<const RasterFileDescriptor*>(pDescriptor->getFileDescriptor());
@@ -252,6 +466,8 @@ CachedPage::UnitPtr Jpeg2000Pager::populateImageData(const DimensionDescriptor&
    }
 
    // Create the output data
+   unsigned int concurrentRows = stopRow - startRow + 1;
+   unsigned int concurrentColumns = columns.size();
    unsigned int numPixels = concurrentRows * concurrentColumns * allBands.size();
    unsigned int numBytes = numPixels * getBytesPerBand();
 
@@ -268,131 +484,167 @@ CachedPage::UnitPtr Jpeg2000Pager::populateImageData(const DimensionDescriptor&
       return CachedPage::UnitPtr();
    }
 
-   memset(pDest, 0, numPixels);
+   memset(pDest, 0, numBytes);
 
-   // Decode the image from the file, first trying the codestream format then the file format
-   opj_image_t* pImage = decodeImage(onDiskStartRow, onDiskStartColumn, onDiskStopRow, onDiskStopColumn,
-      Jpeg2000Utilities::J2K_CFMT);
-   if (pImage == NULL)
-   {
-      pImage = decodeImage(onDiskStartRow, onDiskStartColumn, onDiskStopRow, onDiskStopColumn,
-         Jpeg2000Utilities::JP2_CFMT);
-   }
+   // Decode the image from the file
+   unsigned int onDiskStartRow = rows[startRow].getOnDiskNumber();
+   unsigned int onDiskStopRow = rows[stopRow].getOnDiskNumber() + 1;
+   unsigned int onDiskStartColumn = columns.front().getOnDiskNumber();
+   unsigned int onDiskStopColumn = columns.back().getOnDiskNumber() + 1;
 
+   bool ownsImage = false;
+   opj_image_t* pImage = decodeImage(onDiskStartRow, onDiskStartColumn, onDiskStopRow, onDiskStopColumn, ownsImage);
    if (pImage == NULL)
    {
       return CachedPage::UnitPtr();
    }
 
-   // Populate the output image data
-   int bandFactor = 1;
+   // Copy each component into the interleaved output data one row at a time
+   const unsigned int numComponents = allBands.size() * mBandFactor;
+   const size_t copySize = pDescriptor->getBytesPerElement() / mBandFactor;
+   const size_t pixelSize = numComponents * copySize;
+   const size_t rowSize = concurrentColumns * pixelSize;
 
-   std::string filename = pRaster->getFilename();
-   if (filename.empty() == false)
+   std::vector<int> sourceColumns(concurrentColumns);
+   for (unsigned int componentIndex = 0; componentIndex < numComponents && componentIndex < pImage->numcomps;
+      ++componentIndex)
    {
-      QStringList parts = QString::fromStdString(filename).split('.');
-      foreach (QString part, parts)
+      const opj_image_comp_t& component = pImage->comps[componentIndex];
+      if (component.data == NULL || component.w == 0 || component.h == 0 || component.dx == 0 || component.dy == 0)
       {
-         bool error;
-         EncodingType dataType = StringUtilities::fromXmlString<EncodingType>(part.toStdString(), &error);
-         if (dataType.isValid() == true && error == false)
-         {
-            int currentBandFactor = Jpeg2000Utilities::get_num_bands(dataType);
-            if (currentBandFactor > 0)
-            {
-               bandFactor = currentBandFactor;
-               break;
-            }
-         }
+         continue;
       }
-   }
 
-   const size_t copySize = pDescriptor->getBytesPerElement() / bandFactor;
-
-   for (unsigned int r = 0; r < concurrentRows; ++r)
-   {
+      // The position of each on-disk column in the decoded component, which may be subsampled and reduced
       for (unsigned int c = 0; c < concurrentColumns; ++c)
       {
-         for (std::vector<DimensionDescriptor>::size_type b = 0; b < allBands.size(); ++b)
+         int column = static_cast<int>(((columns[c].getOnDiskNumber() + mImageX0) / component.dx) >> mReduce) -
+            static_cast<int>(component.x0);
+         sourceColumns[c] = std::min(std::max(column, 0), static_cast<int>(component.w) - 1);
+      }
+
+      for (unsigned int r = 0; r < concurrentRows; ++r)
+      {
+         int row = static_cast<int>(((rows[startRow + r].getOnDiskNumber() + mImageY0) / component.dy) >> mReduce) -
+            static_cast<int>(component.y0);
+         row = std::min(std::max(row, 0), static_cast<int>(component.h) - 1);
+
+         const OPJ_INT32* pSource = component.data + static_cast<size_t>(row) * component.w;
+         char* pRowDest = pDest + r * rowSize + componentIndex * copySize;
+         switch (copySize)
          {
-            for (int f = 0; f < bandFactor; ++f)
+         case 1:
+            copySamples<unsigned char>(pSource, sourceColumns, pRowDest, pixelSize);
+            break;
+
+         case 2:
+            copySamples<unsigned short>(pSource, sourceColumns, pRowDest, pixelSize);
+            break;
+
+         case 4:
+            copySamples<unsigned int>(pSource, sourceColumns, pRowDest, pixelSize);
+            break;
+
+         default:
+            for (unsigned int c = 0; c < concurrentColumns; ++c)
             {
-               unsigned int componentIndex = b * bandFactor + f;
-               int imageWidth = pImage->comps[componentIndex].w;
-               int imageHeight = pImage->comps[componentIndex].h;
-
-               int columnSpan = 1;
-               if (imageWidth != static_cast<int>(concurrentColumns))
-               {
-                  columnSpan = pImage->comps[componentIndex].dx;
-               }
-
-               int rowSpan = 1;
-               if (imageHeight != static_cast<int>(concurrentRows))
-               {
-                  rowSpan = pImage->comps[componentIndex].dy;
-               }
-
-               VERIFYRV(columnSpan > 0, CachedPage::UnitPtr());
-               VERIFYRV(rowSpan > 0, CachedPage::UnitPtr());
-
-               if ((r < static_cast<unsigned int>(imageHeight) * rowSpan) &&
-                  (c < static_cast<unsigned int>(imageWidth) * columnSpan))
-               {
-                  int dataIndex = ((r / rowSpan) * imageWidth) + (c / columnSpan);
-                  memcpy(pDest, &pImage->comps[componentIndex].data[dataIndex], copySize);
-               }
-
-               pDest += copySize; // Increment by up to 16 bits (2 bytes).
+               memcpy(pRowDest + c * pixelSize, &pSource[sourceColumns[c]], copySize);
             }
+            break;
          }
       }
    }
 
    // Destroy the decoded image data
-   opj_image_destroy(pImage);
+   if (ownsImage == true)
+   {
+      opj_image_destroy(pImage);
+   }
 
    // Transfer ownership of the resulting data into a new page which will be owned by the caller of this method
-   return CachedPage::UnitPtr(new CachedPage::CacheUnit(reinterpret_cast<char*>(pDestination.release()), startRow,
-      static_cast<int>(concurrentRows), numBytes));
+   return CachedPage::UnitPtr(new CachedPage::CacheUnit(reinterpret_cast<char*>(pDestination.release()),
+      rows[startRow], static_cast<int>(concurrentRows), numBytes));
 }
 
-opj_image_t* Jpeg2000Pager::decodeImage(unsigned int originalStartRow, unsigned int originalStartColumn,
-                                        unsigned int originalStopRow, unsigned int originalStopColumn,
-                                        int decoderType) const
+opj_image_t* Jpeg2000Pager::decodeImage(unsigned int startRow, unsigned int startColumn, unsigned int stopRow,
+                                        unsigned int stopColumn, bool& ownsImage)
 {
-   // Open a byte stream of the required size
-   size_t fileLength = 0;
-   if (mSize > 0)
+   ownsImage = false;
+
+   // Use the open decoder if there is one, otherwise open a decoder for this area
+   opj_stream_t* pStream = mpStream;
+   opj_codec_t* pCodec = mpCodec;
+   opj_image_t* pImage = mpImage;
+   if (pCodec == NULL)
    {
-      fileLength = static_cast<size_t>(mSize);
+      if (openDecoder(mDecoderType, mReduce, pStream, pCodec, pImage) == false)
+      {
+         return NULL;
+      }
+
+      if (mKeepDecoder == true)
+      {
+         mpStream = pStream;
+         mpCodec = pCodec;
+         mpImage = pImage;
+      }
    }
-   else
+
+   // Set the portion of the image to decode
+   bool success = opj_set_decode_area(pCodec, pImage, startColumn + mImageX0, startRow + mImageY0,
+      stopColumn + mImageX0, stopRow + mImageY0) != OPJ_FALSE;
+
+   // Decode the image
+   if (success == true)
    {
-      fseek(mpFile, 0, SEEK_END);
+      success = opj_decode(pCodec, pStream, pImage) != OPJ_FALSE;
+   }
 
-      size_t fileSize = static_cast<size_t>(ftell(mpFile));
-      if (fileSize <= mOffset)
+   if (mKeepDecoder == true)
+   {
+      // A decoder which fails cannot be used again
+      if (success == false)
       {
-         return NULL;
+         closeDecoder();
       }
 
-      fileLength = fileSize - static_cast<size_t>(mOffset);
+      return success ? pImage : NULL;
    }
-   opj_stream_t* pStream = opj_stream_create_file_stream(mpFilename, fileLength, true);
-   if (pStream == NULL)
+
+   // Cleanup
+   opj_stream_destroy(pStream);
+   opj_destroy_codec(pCodec);
+
+   if (success == false)
    {
+      opj_image_destroy(pImage);
       return NULL;
    }
 
-   opj_stream_set_user_data_length(pStream, fileLength);
+   ownsImage = true;
+   return pImage;
+}
+
+bool Jpeg2000Pager::openDecoder(int decoderType, unsigned int reduce, opj_stream_t*& pStream, opj_codec_t*& pCodec,
+                                opj_image_t*& pImage) const
+{
+   pStream = NULL;
+   pCodec = NULL;
+   pImage = NULL;
+
+   // Open a byte stream of the required size
+   pStream = opj_stream_create_file_stream(mFilename.c_str(), mStreamLength, true);
+   if (pStream == NULL)
+   {
+      return false;
+   }
+
+   opj_stream_set_user_data_length(pStream, mStreamLength);
 
    // Seek to the required position in the file
    opj_stream_seek_stream(pStream, mOffset);
 
-
    // Create the appropriate codec
-   opj_codec_t* pCodec = NULL;
    switch (decoderType)
    {
    case Jpeg2000Utilities::J2K_CFMT:
@@ -404,56 +656,73 @@ opj_image_t* Jpeg2000Pager::decodeImage(unsigned int originalStartRow, unsigned
       break;
 
    default:
-      opj_stream_destroy(pStream);
-      return NULL;
+      break;
    }
 
    if (pCodec == NULL)
    {
       opj_stream_destroy(pStream);
-      return NULL;
+      pStream = NULL;
+      return false;
    }
 
    // Setup the decoding parameters
    opj_dparameters_t parameters;
    opj_set_default_decoder_parameters(&parameters);
-   if (opj_setup_decoder(pCodec, &parameters) == OPJ_FALSE)
+   parameters.cp_reduce = reduce;
+
+   bool success = opj_setup_decoder(pCodec, &parameters) != OPJ_FALSE;
+
+#if defined(OPJ_HAS_THREADS)
+   // Decode the code blocks of the tiles in parallel
+   if (success == true)
    {
-      opj_stream_destroy(pStream);
-      opj_destroy_codec(pCodec);
-      return NULL;
+      int threadCount = static_cast<int>(std::max(ConfigurationSettings::getSettingThreadCount(), 1U));
+      opj_codec_set_threads(pCodec, threadCount);
    }
+#endif
 
    // Read the header info from the stream and fill the image structure
-   opj_image_t* pImage = NULL;
-   if (opj_read_header(pStream, pCodec, &pImage) == OPJ_FALSE)
+   if (success == true)
    {
-      opj_stream_destroy(pStream);
-      opj_destroy_codec(pCodec);
-      return NULL;
+      success = opj_read_header(pStream, pCodec, &pImage) != OPJ_FALSE;
    }
 
-   // Set the portion of the image to decode
-   if (opj_set_decode_area(pCodec, pImage, originalStartColumn, originalStartRow, originalStopColumn,
-      originalStopRow) == OPJ_FALSE)
+   if (success == false)
    {
-      opj_stream_destroy(pStream);
+      if (pImage != NULL)
+      {
+         opj_image_destroy(pImage);
+         pImage = NULL;
+      }
+
       opj_destroy_codec(pCodec);
-      return NULL;
+      pCodec = NULL;
+      opj_stream_destroy(pStream);
+      pStream = NULL;
+      return false;
    }
 
-   // Decode the image
-   int success = opj_decode(pCodec, pStream, pImage);
+   return true;
+}
 
-   // Cleanup
-   opj_stream_destroy(pStream);
-   opj_destroy_codec(pCodec);
+void Jpeg2000Pager::closeDecoder()
+{
+   if (mpImage != NULL)
+   {
+      opj_image_destroy(mpImage);
+      mpImage = NULL;
+   }
 
-   if (success == OPJ_FALSE)
+   if (mpCodec != NULL)
    {
-      opj_image_destroy(pImage);
-      return NULL;
+      opj_destroy_codec(mpCodec);
+      mpCodec = NULL;
    }
 
-   return pImage;
+   if (mpStream != NULL)
+   {
+      opj_stream_destroy(mpStream);
+      mpStream = NULL;
+   }
 }
@@ -15,6 +15,9 @@
 #include <openjpeg.h>
 #include <stdio.h>
 #include <string>
+#include <vector>
+
+class RasterDataDescriptor;
 
 class Jpeg2000Pager : public CachedPager
 {
@@ -24,6 +27,7 @@ public:
 
    static std::string offsetArg();
    static std::string sizeArg();
+   static std::string reducedResolutionArg();
 
    virtual bool getInputSpecification(PlugInArgList*& pArgList);
    virtual bool parseInputArgs(PlugInArgList* pArgList);
@@ -34,20 +38,66 @@ public:
 protected:
    virtual double getChunkSize() const;
 
+   bool initialize(const RasterDataDescriptor* pDescriptor);
+   void alignToTiles(unsigned int& startRow, unsigned int& stopRow, const RasterDataDescriptor* pDescriptor) const;
+
    template <typename Out>
-   CachedPage::UnitPtr populateImageData(const DimensionDescriptor& startRow, const DimensionDescriptor& startColumn,
-      unsigned int concurrentRows, unsigned int concurrentColumns) const;
+   CachedPage::UnitPtr populateImageData(const RasterDataDescriptor* pDescriptor, unsigned int startRow,
+      unsigned int stopRow);
 
-   opj_image_t* decodeImage(unsigned int originalStartRow, unsigned int originalStartColumn,
-      unsigned int originalStopRow, unsigned int originalStopColumn, int decoderType) const;
+   /**
+    * Decodes an area of the image at the reduced resolution level.
+    *
+    * @param startRow
+    *        The first on-disk row to decode.
+    * @param startColumn
+    *        The first on-disk column to decode.
+    * @param stopRow
+    *        The on-disk row after the last row to decode.
+    * @param stopColumn
+    *        The on-disk column after the last column to decode.
+    * @param ownsImage
+    *        Set to \c true if the caller must destroy the returned image, or \c false if the
+    *        image belongs to the open decoder.
+    *
+    * @return The decoded image, or \c NULL if the area could not be decoded.
+    */
+   opj_image_t* decodeImage(unsigned int startRow, unsigned int startColumn, unsigned int stopRow,
+      unsigned int stopColumn, bool& ownsImage);
 
 private:
+   bool openDecoder(int decoderType, unsigned int reduce, opj_stream_t*& pStream, opj_codec_t*& pCodec,
+      opj_image_t*& pImage) const;
+   void closeDecoder();
+
    static size_t msMaxCacheSize;
 
-   char *mpFilename;
+   std::string mFilename;
    FILE* mpFile;
    uint64_t mOffset;
    uint64_t mSize;
+   bool mReducedResolution;
+
+   // Codestream information which is read once from the header
+   bool mInitialized;
+   int mDecoderType;
+   size_t mStreamLength;
+   unsigned int mImageX0;
+   unsigned int mImageY0;
+   unsigned int mTileY0;
+   unsigned int mTileHeight;
+   unsigned int mNumTiles;
+   unsigned int mNumResolutions;
+   int mBandFactor;
+
+   // The resolution level which is decoded, where each level halves the number of rows and columns
+   unsigned int mReduce;
+
+   // A decoder which is kept open between fetches when the codestream and OpenJPEG allow it
+   bool mKeepDecoder;
+   opj_stream_t* mpStream;
+   opj_codec_t* mpCodec;
+   opj_image_t* mpImage;
 };
 
 #endif
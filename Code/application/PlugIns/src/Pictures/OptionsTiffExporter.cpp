@@ -8,6 +8,7 @@
  */
 
 #include <QtWidgets/QCheckBox>
+#include <QtWidgets/QComboBox>
 #include <QtWidgets/QGridLayout>
 #include <QtWidgets/QGroupBox>
 #include <QtWidgets/QLabel>
@@ -15,6 +16,7 @@
 #include <QtWidgets/QSpinBox>
 #include <QtWidgets/QVBoxLayout>
 
+#include "AppVerify.h"
 #include "LabeledSection.h"
 #include "OptionQWidgetWrapper.h"
 #include "OptionsTiffExporter.h"
@@ -23,6 +25,8 @@
 #include "StringUtilities.h"
 #include "StringUtilitiesMacros.h"
 
+#include <tiffio.h>
+
 #include <limits>
 
 REGISTER_PLUGIN(OpticksPictures, OptionsTiffExporter, OptionQWidgetWrapper<OptionsTiffExporter>());
@@ -33,6 +37,20 @@ namespace StringUtilities
    ADD_ENUM_MAPPING(OptionsTiffExporter::TIE_POINT_PIXEL_SCALE, "Tie Point/Pixel Scale", "TiePointPixelScale")
    ADD_ENUM_MAPPING(OptionsTiffExporter::TRANSFORMATION_MATRIX, "Transformation Matrix", "TransformationMatrix")
    END_ENUM_MAPPING()
+
+   BEGIN_ENUM_MAPPING_ALIAS(OptionsTiffExporter::CompressionType, CompressionType)
+   ADD_ENUM_MAPPING(OptionsTiffExporter::NO_COMPRESSION, "None", "None")
+   ADD_ENUM_MAPPING(OptionsTiffExporter::PACKBITS, "Pack Bits", "PackBits")
+   ADD_ENUM_MAPPING(OptionsTiffExporter::DEFLATE, "Deflate", "Deflate")
+   ADD_ENUM_MAPPING(OptionsTiffExporter::LZW, "LZW", "LZW")
+   ADD_ENUM_MAPPING(OptionsTiffExporter::ZSTD, "Zstandard", "ZSTD")
+   END_ENUM_MAPPING()
+
+   BEGIN_ENUM_MAPPING_ALIAS(OptionsTiffExporter::Predictor, Predictor)
+   ADD_ENUM_MAPPING(OptionsTiffExporter::NO_PREDICTOR, "None", "None")
+   ADD_ENUM_MAPPING(OptionsTiffExporter::HORIZONTAL, "Horizontal", "Horizontal")
+   ADD_ENUM_MAPPING(OptionsTiffExporter::FLOATING_POINT, "Floating Point", "FloatingPoint")
+   END_ENUM_MAPPING()
 }
 
 OptionsTiffExporter::OptionsTiffExporter() :
@@ -84,10 +102,61 @@ OptionsTiffExporter::OptionsTiffExporter() :
    LabeledSection* pTransformationSection = new LabeledSection(pTransformationWidget,
       "Coordinate Transformation (GeoTIFF only)", this);
 
+   // GeoTIFF layout
+   QWidget* pLayoutWidget = new QWidget(this);
+
+   QLabel* pCompressionLabel = new QLabel("Compression: ", pLayoutWidget);
+   mpCompressionCombo = new QComboBox(pLayoutWidget);
+   mpCompressionCombo->setToolTip("Overrides the Pack Bits option when set to a value other than None");
+
+   QLabel* pPredictorLabel = new QLabel("Predictor: ", pLayoutWidget);
+   mpPredictorCombo = new QComboBox(pLayoutWidget);
+   mpPredictorCombo->setToolTip("Used with Deflate, LZW and Zstandard compression");
+
+   mpTiledCheck = new QCheckBox("Tile Size: ", pLayoutWidget);
+   mpTileSize = new QSpinBox(pLayoutWidget);
+   mpTileSize->setRange(16, 4096);
+   mpTileSize->setSingleStep(16);
+   mpTileSize->setValue(256);
+
+   mpOverviewsCheck = new QCheckBox("Internal overviews", pLayoutWidget);
+
+   QGridLayout* pLayoutGrid = new QGridLayout(pLayoutWidget);
+   pLayoutGrid->setMargin(0);
+   pLayoutGrid->setSpacing(5);
+   pLayoutGrid->addWidget(pCompressionLabel, 0, 0);
+   pLayoutGrid->addWidget(mpCompressionCombo, 0, 1);
+   pLayoutGrid->addWidget(pPredictorLabel, 1, 0);
+   pLayoutGrid->addWidget(mpPredictorCombo, 1, 1);
+   pLayoutGrid->addWidget(mpTiledCheck, 2, 0);
+   pLayoutGrid->addWidget(mpTileSize, 2, 1);
+   pLayoutGrid->addWidget(mpOverviewsCheck, 3, 0, 1, 2);
+   pLayoutGrid->setColumnStretch(2, 10);
+
+   LabeledSection* pLayoutSection = new LabeledSection(pLayoutWidget, "File Layout (GeoTIFF only)", this);
+
+   std::vector<std::string> compressionTypes = StringUtilities::getAllEnumValuesAsDisplayString<CompressionType>();
+   for (std::vector<std::string>::const_iterator iter = compressionTypes.begin(); iter != compressionTypes.end(); ++iter)
+   {
+      if (isCompressionAvailable(StringUtilities::fromDisplayString<CompressionType>(*iter)) == true)
+      {
+         mpCompressionCombo->addItem(QString::fromStdString(*iter));
+      }
+   }
+
+   std::vector<std::string> predictors = StringUtilities::getAllEnumValuesAsDisplayString<Predictor>();
+   for (std::vector<std::string>::const_iterator iter = predictors.begin(); iter != predictors.end(); ++iter)
+   {
+      mpPredictorCombo->addItem(QString::fromStdString(*iter));
+   }
+
+   VERIFYNR(connect(mpTiledCheck, SIGNAL(toggled(bool)), mpTileSize, SLOT(setEnabled(bool))));
+
    // Initialization
    addSection(pCompressionSection);
    addSection(pResolutionSection);
    addSection(pTransformationSection);
+   addSection(pLayoutSection);
    addStretch(10);
    setSizeHint(350, 250);
 
@@ -109,6 +178,26 @@ OptionsTiffExporter::OptionsTiffExporter() :
    {
       mpMatrixRadio->setChecked(true);
    }
+
+   CompressionType compression =
+      StringUtilities::fromXmlString<CompressionType>(OptionsTiffExporter::getSettingGeoTiffCompression());
+   int compressionIndex = mpCompressionCombo->findText(QString::fromStdString(
+      StringUtilities::toDisplayString<CompressionType>(compression)));
+   mpCompressionCombo->setCurrentIndex(compressionIndex < 0 ? 0 : compressionIndex);
+
+   Predictor predictor = StringUtilities::fromXmlString<Predictor>(OptionsTiffExporter::getSettingGeoTiffPredictor());
+   int predictorIndex = mpPredictorCombo->findText(QString::fromStdString(
+      StringUtilities::toDisplayString<Predictor>(predictor)));
+   mpPredictorCombo->setCurrentIndex(predictorIndex < 0 ? 0 : predictorIndex);
+
+   unsigned int tileSize = OptionsTiffExporter::getSettingGeoTiffTileSize();
+   if (tileSize > 0)
+   {
+      mpTileSize->setValue(static_cast<int>(tileSize));
+   }
+   mpTiledCheck->setChecked(tileSize > 0);
+   mpTileSize->setEnabled(tileSize > 0);
+   mpOverviewsCheck->setChecked(OptionsTiffExporter::getSettingGeoTiffOverviews());
 }
 
 OptionsTiffExporter::~OptionsTiffExporter()
@@ -143,4 +232,66 @@ void OptionsTiffExporter::applyChanges()
 
    OptionsTiffExporter::setSettingTransformationMethod(StringUtilities::toXmlString<TransformationMethod>(
       transformationMethod));
+
+   // GeoTIFF layout
+   CompressionType compression =
+      StringUtilities::fromDisplayString<CompressionType>(mpCompressionCombo->currentText().toStdString());
+   OptionsTiffExporter::setSettingGeoTiffCompression(StringUtilities::toXmlString<CompressionType>(compression));
+
+   Predictor predictor =
+      StringUtilities::fromDisplayString<Predictor>(mpPredictorCombo->currentText().toStdString());
+   OptionsTiffExporter::setSettingGeoTiffPredictor(StringUtilities::toXmlString<Predictor>(predictor));
+
+   OptionsTiffExporter::setSettingGeoTiffTileSize(mpTiledCheck->isChecked() ?
+      static_cast<unsigned int>(mpTileSize->value()) : 0);
+   OptionsTiffExporter::setSettingGeoTiffOverviews(mpOverviewsCheck->isChecked());
+}
+
+OptionsTiffExporter::CompressionType OptionsTiffExporter::getGeoTiffCompressionType()
+{
+   CompressionType compression =
+      StringUtilities::fromXmlString<CompressionType>(OptionsTiffExporter::getSettingGeoTiffCompression());
+   if (compression.isValid() == false || compression == NO_COMPRESSION)
+   {
+      compression = (OptionsTiffExporter::getSettingPackBitsCompression() ? PACKBITS : NO_COMPRESSION);
+   }
+
+   return compression;
+}
+
+unsigned short OptionsTiffExporter::getTiffCompression(CompressionType compression)
+{
+   switch (compression)
+   {
+   case PACKBITS:
+      return COMPRESSION_PACKBITS;
+   case DEFLATE:
+      return COMPRESSION_ADOBE_DEFLATE;
+   case LZW:
+      return COMPRESSION_LZW;
+#ifdef COMPRESSION_ZSTD
+   case ZSTD:
+      return COMPRESSION_ZSTD;
+#endif
+   default:
+      break;
+   }
+
+   return COMPRESSION_NONE;
+}
+
+bool OptionsTiffExporter::isCompressionAvailable(CompressionType compression)
+{
+   if (compression.isValid() == false)
+   {
+      return false;
+   }
+
+   if (compression == NO_COMPRESSION)
+   {
+      return true;
+   }
+
+   unsigned short tiffCompression = getTiffCompression(compression);
+   return tiffCompression != COMPRESSION_NONE && TIFFIsCODECConfigured(tiffCompression) != 0;
 }
@@ -16,6 +16,7 @@
 #include "LabeledSectionGroup.h"
 
 class QCheckBox;
+class QComboBox;
 class QRadioButton;
 class QSpinBox;
 class ResolutionWidget;
@@ -36,6 +37,10 @@ public:
    SETTING(OutputHeight, TiffExporter, unsigned int, 0);
    SETTING(TransformationMethod, TiffExporter, std::string, "TiePointPixelScale");
    SETTING(SetBackgroundColorTransparent, TiffExporter, bool, false)
+   SETTING(GeoTiffCompression, TiffExporter, std::string, "None");
+   SETTING(GeoTiffPredictor, TiffExporter, std::string, "None");
+   SETTING(GeoTiffTileSize, TiffExporter, unsigned int, 0);
+   SETTING(GeoTiffOverviews, TiffExporter, bool, false);
 
    enum TransformationMethodEnum
    {
@@ -44,6 +49,54 @@ public:
    };
    typedef EnumWrapper<TransformationMethodEnum> TransformationMethod;
 
+   enum CompressionTypeEnum
+   {
+      NO_COMPRESSION,
+      PACKBITS,
+      DEFLATE,
+      LZW,
+      ZSTD
+   };
+   typedef EnumWrapper<CompressionTypeEnum> CompressionType;
+
+   enum PredictorEnum
+   {
+      NO_PREDICTOR,
+      HORIZONTAL,
+      FLOATING_POINT
+   };
+   typedef EnumWrapper<PredictorEnum> Predictor;
+
+   /**
+    * Gets the GeoTIFF compression type from the settings.
+    *
+    * The GeoTiffCompression setting takes precedence.  If it does not specify
+    * any compression, the PackBitsCompression setting is honored.
+    *
+    * @return The compression type to use for GeoTIFF files.
+    */
+   static CompressionType getGeoTiffCompressionType();
+
+   /**
+    * Converts a compression type to the libtiff compression scheme.
+    *
+    * @param  compression
+    *         The compression type to convert.
+    *
+    * @return The value of the TIFFTAG_COMPRESSION tag for the compression type.
+    */
+   static unsigned short getTiffCompression(CompressionType compression);
+
+   /**
+    * Queries whether libtiff was built with a compression scheme.
+    *
+    * @param  compression
+    *         The compression type to query.
+    *
+    * @return True if files can be written with the compression type, false otherwise.
+    */
+   static bool isCompressionAvailable(CompressionType compression);
+
    void applyChanges();
 
    static const std::string& getName()
@@ -107,6 +160,11 @@ private:
    ResolutionWidget* mpResolutionWidget;
    QRadioButton* mpTiePointRadio;
    QRadioButton* mpMatrixRadio;
+   QComboBox* mpCompressionCombo;
+   QComboBox* mpPredictorCombo;
+   QCheckBox* mpTiledCheck;
+   QSpinBox* mpTileSize;
+   QCheckBox* mpOverviewsCheck;
 };
 
 #endif
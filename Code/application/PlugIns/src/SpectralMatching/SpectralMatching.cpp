@@ -0,0 +1,320 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "AoiElement.h"
+#include "AppVerify.h"
+#include "AppVersion.h"
+#include "DynamicObject.h"
+#include "ModelServices.h"
+#include "ObjectResource.h"
+#include "PlugInArgList.h"
+#include "PlugInManagerServices.h"
+#include "PlugInRegistration.h"
+#include "ProgressTracker.h"
+#include "RasterDataDescriptor.h"
+#include "RasterElement.h"
+#include "RasterUtilities.h"
+#include "SignatureLibrary.h"
+#include "SpatialDataView.h"
+#include "SpecialMetadata.h"
+#include "SpectralMatcher.h"
+#include "SpectralMatching.h"
+#include "Statistics.h"
+#include "Wavelengths.h"
+
+#include <string>
+#include <vector>
+
+REGISTER_PLUGIN_BASIC(OpticksSpectralMatching, SpectralMatching);
+
+namespace
+{
+   const char* const sMethodNames[] = { "SAM", "Correlation", "CEM", "Matched Filter", "ACE" };
+   const SpectralMatcher::MethodEnum sMethods[] =
+   {
+      SpectralMatcher::SAM,
+      SpectralMatcher::CORRELATION,
+      SpectralMatcher::CEM,
+      SpectralMatcher::MATCHED_FILTER,
+      SpectralMatcher::ACE
+   };
+   const unsigned int sMethodCount = sizeof(sMethods) / sizeof(sMethods[0]);
+
+   // Returns the result element, replacing any result with the same name from a previous run.
+   RasterElement* createOutputElement(const std::string& name, const RasterDataDescriptor* pDescriptor,
+      unsigned int bandCount, EncodingType dataType, RasterElement* pParent)
+   {
+      Service<ModelServices> pModel;
+      DataElement* pExisting = pModel->getElement(name, TypeConverter::toString<RasterElement>(), pParent);
+      if (pExisting != NULL)
+      {
+         pModel->destroyElement(pExisting);
+      }
+
+      // Try in-memory first since it is faster to access.
+      RasterElement* pOutputElement = RasterUtilities::createRasterElement(name, pDescriptor->getRowCount(),
+         pDescriptor->getColumnCount(), bandCount, dataType, BIP, true, pParent);
+      if (pOutputElement == NULL)
+      {
+         pOutputElement = RasterUtilities::createRasterElement(name, pDescriptor->getRowCount(),
+            pDescriptor->getColumnCount(), bandCount, dataType, BIP, false, pParent);
+      }
+
+      return pOutputElement;
+   }
+
+   void setOutputBadValue(RasterElement* pElement, int badValue)
+   {
+      const RasterDataDescriptor* pDescriptor =
+         dynamic_cast<const RasterDataDescriptor*>(pElement->getDataDescriptor());
+      VERIFYNRV(pDescriptor != NULL);
+
+      const std::vector<int> badValues(1, badValue);
+      const std::vector<DimensionDescriptor>& bands = pDescriptor->getBands();
+      for (std::vector<DimensionDescriptor>::const_iterator iter = bands.begin(); iter != bands.end(); ++iter)
+      {
+         Statistics* pStatistics = pElement->getStatistics(*iter);
+         if (pStatistics != NULL)
+         {
+            pStatistics->setBadValues(badValues);
+         }
+      }
+   }
+}
+
+SpectralMatching::SpectralMatching()
+{
+   setName("Spectral Matching");
+   setVersion(APP_VERSION_NUMBER);
+   setCreator("Ball Aerospace & Technologies Corp.");
+   setCopyright(APP_COPYRIGHT);
+   setShortDescription("Match a data set against a signature library");
+   setDescription("Scores each pixel of a data set against every signature in a signature library using "
+      "the spectral angle (SAM), spectral correlation, constrained energy minimization (CEM), the matched "
+      "filter, or the adaptive coherence estimator (ACE).  The scores and a map of the best matching "
+      "signature are created as children of the data set.");
+   setDescriptorId("{75F78B9F-AE83-4353-B83C-8A579B9B8AB2}");
+   allowMultipleInstances(true);
+   setProductionStatus(APP_IS_PRODUCTION_RELEASE);
+   setAbortSupported(true);
+}
+
+SpectralMatching::~SpectralMatching()
+{}
+
+bool SpectralMatching::getInputSpecification(PlugInArgList*& pArgList)
+{
+   pArgList = Service<PlugInManagerServices>()->getPlugInArgList();
+   VERIFY(pArgList != NULL);
+   VERIFY(pArgList->addArg<Progress>(Executable::ProgressArg(), Executable::ProgressArgDescription()));
+   VERIFY(pArgList->addArg<RasterElement>(Executable::DataElementArg(), "Element which will be matched."));
+   VERIFY(pArgList->addArg<SpatialDataView>(Executable::ViewArg(), NULL,
+      "View to which the result is added in interactive mode."));
+   VERIFY(pArgList->addArg<SignatureLibrary>("Signature Library", NULL,
+      "Signatures to match.  The library is resampled to the wavelengths of the element.  If the element "
+      "has no wavelengths, the library must have one value for each band of the element."));
+   VERIFY(pArgList->addArg<std::string>("Method", std::string(sMethodNames[0]),
+      "The score to compute: \"SAM\", \"Correlation\", \"CEM\", \"Matched Filter\" or \"ACE\".  "
+      "SAM scores are spectral angles in radians, so lower scores are better matches."));
+   VERIFY(pArgList->addArg<AoiElement>("AOI", NULL, "Only pixels selected in this AOI are matched.  "
+      "If not specified, the entire element is matched."));
+   VERIFY(pArgList->addArg<bool>("Create Scores", true, "Whether an element containing the score of each "
+      "signature is created."));
+   VERIFY(pArgList->addArg<bool>("Create Class Map", true, "Whether an element containing the one-based "
+      "index of the best matching signature of each pixel is created."));
+   VERIFY(pArgList->addArg<double>("Class Threshold", NULL, "Pixels whose best score does not reach this "
+      "value are not assigned a class.  If not specified, every matched pixel is assigned a class."));
+   return true;
+}
+
+bool SpectralMatching::getOutputSpecification(PlugInArgList*& pArgList)
+{
+   pArgList = Service<PlugInManagerServices>()->getPlugInArgList();
+   VERIFY(pArgList != NULL);
+   VERIFY(pArgList->addArg<RasterElement>("Scores", NULL,
+      "Score of each signature, in the order of the signatures in the library."));
+   VERIFY(pArgList->addArg<RasterElement>("Class Map", NULL,
+      "One-based index of the best matching signature, or 0 if the pixel did not match."));
+   return true;
+}
+
+bool SpectralMatching::execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList)
+{
+   VERIFY(pInArgList != NULL);
+
+   ProgressTracker progress(pInArgList->getPlugInArgValue<Progress>(Executable::ProgressArg()),
+      "Execute " + getName(), "app", "{F5204467-B9CA-4D7F-BE85-BE5234555415}");
+   progress.report("Executing " + getName(), 0, NORMAL);
+
+   RasterElement* pElement = pInArgList->getPlugInArgValue<RasterElement>(Executable::DataElementArg());
+   if (pElement == NULL)
+   {
+      progress.report("No raster element provided.", 0, ERRORS, true);
+      return false;
+   }
+
+   const RasterDataDescriptor* pDescriptor = dynamic_cast<const RasterDataDescriptor*>(
+      pElement->getDataDescriptor());
+   VERIFY(pDescriptor != NULL);
+
+   SignatureLibrary* pLibrary = pInArgList->getPlugInArgValue<SignatureLibrary>("Signature Library");
+   if (pLibrary == NULL || pLibrary->getNumSignatures() == 0)
+   {
+      progress.report("No signatures provided.", 0, ERRORS, true);
+      return false;
+   }
+
+   std::string methodName;
+   pInArgList->getPlugInArgValue("Method", methodName);
+   SpectralMatcher::Method method;
+   for (unsigned int i = 0; i < sMethodCount; ++i)
+   {
+      if (methodName == sMethodNames[i])
+      {
+         method = sMethods[i];
+         break;
+      }
+   }
+   if (method.isValid() == false)
+   {
+      progress.report("Unknown matching method \"" + methodName + "\".", 0, ERRORS, true);
+      return false;
+   }
+
+   bool createScores = true;
+   bool createClasses = true;
+   pInArgList->getPlugInArgValue("Create Scores", createScores);
+   pInArgList->getPlugInArgValue("Create Class Map", createClasses);
+   if (createScores == false && createClasses == false)
+   {
+      progress.report("No output was requested.", 0, ERRORS, true);
+      return false;
+   }
+
+   // Resample the library to the bands of the element
+   const unsigned int bandCount = pDescriptor->getBandCount();
+   FactoryResource<Wavelengths> pWavelengths;
+   pWavelengths->initializeFromDynamicObject(pDescriptor->getMetadata(), false);
+   if (pWavelengths->hasCenterValues())
+   {
+      if (pLibrary->resample(pWavelengths->getCenterValues()) == false)
+      {
+         progress.report("Unable to resample the signature library to the wavelengths of the data.",
+            0, ERRORS, true);
+         return false;
+      }
+   }
+   else
+   {
+      pLibrary->desample();
+   }
+
+   if (pLibrary->getAbscissa().empty() && pLibrary->getOriginalAbscissa().size() != bandCount)
+   {
+      progress.report("The data has no wavelengths and the signature library does not have one value "
+         "for each band.", 0, ERRORS, true);
+      return false;
+   }
+
+   const unsigned int signatureCount = pLibrary->getNumSignatures();
+   std::vector<double> signatures;
+   signatures.reserve(signatureCount * bandCount);
+   std::vector<std::string> signatureNames;
+   for (unsigned int i = 0; i < signatureCount; ++i)
+   {
+      // The original data is returned in a shared buffer, so copy it before the next signature is requested
+      const double* pValues = pLibrary->getOrdinateData(i);
+      if (pValues == NULL)
+      {
+         progress.report("Unable to access the signature library.", 0, ERRORS, true);
+         return false;
+      }
+
+      signatures.insert(signatures.end(), pValues, pValues + bandCount);
+      signatureNames.push_back(pLibrary->getSignatureName(i));
+   }
+
+   AoiElement* pAoi = pInArgList->getPlugInArgValue<AoiElement>("AOI");
+
+   ModelResource<RasterElement> pScores(createScores ?
+      createOutputElement(methodName + " Scores", pDescriptor, signatureCount, FLT4BYTES, pElement) : NULL);
+   if (createScores)
+   {
+      if (pScores.get() == NULL)
+      {
+         progress.report("Unable to create the score element.", 0, ERRORS, true);
+         return false;
+      }
+
+      pScores->copyClassification(pElement);
+      pScores->getMetadata()->setAttributeByPath(BAND_NAMES_METADATA_PATH, signatureNames);
+      setOutputBadValue(pScores.get(), SpectralMatcher::NO_DATA_SCORE);
+   }
+
+   ModelResource<RasterElement> pClasses(createClasses ?
+      createOutputElement(methodName + " Class Map", pDescriptor, 1, INT2UBYTES, pElement) : NULL);
+   if (createClasses)
+   {
+      if (pClasses.get() == NULL)
+      {
+         progress.report("Unable to create the class map element.", 0, ERRORS, true);
+         return false;
+      }
+
+      pClasses->copyClassification(pElement);
+      setOutputBadValue(pClasses.get(), 0);
+   }
+
+   SpectralMatcher matcher(method, signatures, signatureCount);
+   matcher.setAoi(pAoi == NULL ? NULL : pAoi->getSelectedPoints());
+   matcher.setAbortFlag(&mAborted);
+   matcher.setProgress(progress.getCurrentProgress());
+
+   double* pThreshold = pInArgList->getPlugInArgValue<double>("Class Threshold");
+   if (pThreshold != NULL)
+   {
+      matcher.setClassThreshold(*pThreshold);
+   }
+
+   if (matcher.match(pElement, pScores.get(), pClasses.get()) == false)
+   {
+      if (isAborted())
+      {
+         progress.report("Cancelled", 0, ABORT, true);
+      }
+      else
+      {
+         progress.report(matcher.getErrorMessage(), 0, ERRORS, true);
+      }
+      return false;
+   }
+
+   // Display the class map, or the scores if there is no class map, in the view of the element
+   SpatialDataView* pView = pInArgList->getPlugInArgValue<SpatialDataView>(Executable::ViewArg());
+   if (isBatch() == false && pView != NULL)
+   {
+      RasterElement* pDisplayed = (pClasses.get() != NULL) ? pClasses.get() : pScores.get();
+      if (pView->createLayer(RASTER, pDisplayed) == NULL)
+      {
+         progress.report("Unable to display the result.", 0, WARNING);
+      }
+   }
+
+   if (pOutArgList != NULL)
+   {
+      pOutArgList->setPlugInArgValue<RasterElement>("Scores", pScores.get());
+      pOutArgList->setPlugInArgValue<RasterElement>("Class Map", pClasses.get());
+   }
+
+   pScores.release();
+   pClasses.release();
+   progress.report(getName() + " complete.", 100, NORMAL);
+   progress.upALevel();
+   return true;
+}
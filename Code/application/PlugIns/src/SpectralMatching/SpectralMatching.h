@@ -0,0 +1,26 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from   
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef SPECTRALMATCHING_H
+#define SPECTRALMATCHING_H
+
+#include "AlgorithmShell.h"
+
+class SpectralMatching : public AlgorithmShell
+{
+public:
+   SpectralMatching();
+   virtual ~SpectralMatching();
+
+   virtual bool getInputSpecification(PlugInArgList*& pArgList);
+   virtual bool getOutputSpecification(PlugInArgList*& pArgList);
+   virtual bool execute(PlugInArgList* pInArgList, PlugInArgList* pOutArgList);
+};
+
+#endif
@@ -13,6 +13,7 @@
 #include "BatchWizardExecutor.h"
 #include "AppAssert.h"
 #include "AppVerify.h"
+#include "ConfigurationSettings.h"
 #include "DateTime.h"
 #include "Filename.h"
 #include "MessageLogResource.h"
@@ -23,17 +24,113 @@
 #include "PlugInArgList.h"
 #include "PlugInManagerServices.h"
 #include "PlugInRegistration.h"
+#include "ProcessQueue.h"
 #include "StringUtilities.h"
 #include "UtilityServices.h"
+#include "Value.h"
 #include "WizardExecutor.h"
 #include "WizardItem.h"
 #include "WizardObject.h"
+#include "WizardUtilities.h"
 #include "xmlreader.h"
 
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
 using namespace std;
 
 REGISTER_PLUGIN_BASIC(OpticksWizardExecutor, BatchWizardExecutor);
 
+// The name of the batch application is configured by the build since it differs between platforms and configurations
+#if !defined(BATCH_APPLICATION_NAME)
+#define BATCH_APPLICATION_NAME "OpticksBatch"
+#endif
+
+namespace
+{
+   // Runs the files of a repeating batch wizard in separate batch processes and
+   // reports each file as a step in the same order as the files in the fileset
+   class BatchRunQueue : public ProcessQueue
+   {
+   public:
+      BatchRunQueue(unsigned int maxRunning, uint64_t memoryBudget, const string& wizardFilename,
+         Progress* pProgress, const bool& abort) :
+         ProcessQueue(maxRunning, memoryBudget),
+         mWizardFilename(wizardFilename),
+         mpProgress(pProgress),
+         mAbort(abort)
+      {}
+
+      ~BatchRunQueue()
+      {
+         for (vector<string>::const_iterator iter = mBatchFilenames.begin(); iter != mBatchFilenames.end(); ++iter)
+         {
+            remove(iter->c_str());
+         }
+      }
+
+      void addFile(const string& inputFile, const string& batchFilename, const string& program,
+         const vector<string>& arguments, uint64_t estimatedSize)
+      {
+         mInputFiles.push_back(inputFile);
+         mBatchFilenames.push_back(batchFilename);
+         addRun(program, arguments, estimatedSize);
+      }
+
+   protected:
+      void runFinished(size_t index, const Run& run)
+      {
+         const string& inputFile = mInputFiles[index];
+
+         StepResource pRunStep("Run Batch Wizard File", "app", "7E3A9C41-5B2D-4f86-A0C3-1D9E6F2B8A57");
+         pRunStep->addProperty("wizard", mWizardFilename);
+         pRunStep->addProperty("inputFile", inputFile);
+         pRunStep->addProperty("exitCode", run.mExitCode);
+         pRunStep->addProperty("output", run.mOutput);
+
+         if (run.mSuccess == true)
+         {
+            if (mpProgress != NULL)
+            {
+               string message = "Processed " + inputFile;
+               mpProgress->updateProgress(message, static_cast<int>((index + 1) * 100 / getRunCount()), NORMAL);
+            }
+
+            pRunStep->finalize(Message::Success);
+         }
+         else
+         {
+            string message = "Could not process " + inputFile + ": " + run.mMessage;
+            if (mpProgress != NULL)
+            {
+               mpProgress->updateProgress(message, 0, ERRORS);
+            }
+
+            pRunStep->finalize(Message::Failure, message);
+         }
+      }
+
+      bool isAborted()
+      {
+         return mAbort;
+      }
+
+   private:
+      BatchRunQueue& operator=(const BatchRunQueue& rhs);
+
+      string mWizardFilename;
+      Progress* mpProgress;
+      const bool& mAbort;
+      vector<string> mInputFiles;
+      vector<string> mBatchFilenames;
+   };
+}
+
 BatchWizardExecutor::BatchWizardExecutor() :
    mbAbort(false),
    mpProgress(NULL),
@@ -128,6 +225,40 @@ bool BatchWizardExecutor::execute(PlugInArgList* pInArgList, PlugInArgList* pOut
       string tmp;
       bool bRepeatWizard = pBatchWizard->isRepeating(tmp);
 
+      // Process the repeat files in separate batch processes when requested
+      unsigned int parallelRuns = pBatchWizard->getParallelRuns();
+      if (parallelRuns == 0)
+      {
+         parallelRuns = Service<UtilityServices>()->getNumProcessors();
+      }
+
+      if (bRepeatWizard && parallelRuns > 1)
+      {
+         bool bParallelSuccess = executeParallel(pBatchWizard, parallelRuns);
+         delete pBatchWizard;
+
+         if (mbAbort)
+         {
+            string message = "Batch Wizard Exector Aborted!";
+            if (mpProgress != NULL)
+            {
+               mpProgress->updateProgress(message, 0, ABORT);
+            }
+
+            pStep->finalize(Message::Abort, message);
+            return false;
+         }
+
+         if (!bParallelSuccess)
+         {
+            pStep->finalize(Message::Failure);
+            return false;
+         }
+
+         pBatchWizard = fileParser.read();
+         continue;
+      }
+
       bool bExecutedOnce = false;
       while ((!bRepeatWizard && !bExecutedOnce) || !pBatchWizard->isComplete())
       {
@@ -438,3 +569,131 @@ bool BatchWizardExecutor::runWizard(WizardObject* pWizard)
 
    return bSuccess;
 }
+
+bool BatchWizardExecutor::executeParallel(BatchWizard* pBatchWizard, unsigned int parallelRuns)
+{
+   VERIFY(pBatchWizard != NULL);
+
+   Service<UtilityServices> pUtilities;
+   VERIFY(pUtilities.get() != NULL);
+
+   // The batch application is installed in the same directory as this application
+   QString executable = QCoreApplication::applicationDirPath() + "/" + BATCH_APPLICATION_NAME;
+#if defined(WIN_API)
+   executable += ".exe";
+   const string delimiter = "/";
+#else
+   const string delimiter = "-";
+#endif
+
+   if (QFileInfo(executable).isFile() == false)
+   {
+      string message = "Cannot find the batch application: " + executable.toStdString();
+      if (mpProgress != NULL)
+      {
+         mpProgress->updateProgress(message, 0, ERRORS);
+      }
+
+      return false;
+   }
+
+   string tempPath;
+   const Filename* pTempPath = ConfigurationSettings::getSettingTempPath();
+   if (pTempPath != NULL)
+   {
+      tempPath = pTempPath->getFullPathAndName();
+   }
+
+   // Limit the number of threads each run uses so that the runs share the processors,
+   // and admit a run only when the estimated data of all running files fits in memory
+   unsigned int numProcessors = pUtilities->getNumProcessors();
+   unsigned int threadCount = max(1U, numProcessors / parallelRuns);
+   uint64_t memoryBudget = pUtilities->getTotalPhysicalMemory() / 2;
+
+   vector<string> commonArguments;
+   commonArguments.push_back(delimiter + "brief");
+   commonArguments.push_back(delimiter + "processors:" + QString::number(threadCount).toStdString());
+
+   QStringList appArguments = QCoreApplication::arguments();
+   for (int i = 1; i < appArguments.size(); ++i)
+   {
+      string argument = appArguments[i].toStdString();
+      if (argument.find(delimiter + "deployment:") == 0 || argument.find(delimiter + "debugDeployment:") == 0)
+      {
+         commonArguments.push_back(argument);
+      }
+   }
+
+   BatchRunQueue runs(parallelRuns, memoryBudget, pBatchWizard->getWizardFilename(), mpProgress, mbAbort);
+
+   // Write a batch file for each file in the repeat fileset which runs the wizard once
+   const vector<Value*>& inputValues = pBatchWizard->getInputValues();
+   while (pBatchWizard->isComplete() == false)
+   {
+      string inputFile;
+      pBatchWizard->getCurrentRepeatFile(inputFile);
+
+      BatchWizard runWizard;
+      runWizard.setWizardFilename(pBatchWizard->getWizardFilename());
+      runWizard.setCleanup(pBatchWizard->doesCleanup());
+
+      uint64_t estimatedSize = 0;
+      for (vector<Value*>::const_iterator iter = inputValues.begin(); iter != inputValues.end(); ++iter)
+      {
+         Value* pValue = *iter;
+         if (pValue == NULL)
+         {
+            continue;
+         }
+
+         string nodeType = pValue->getNodeType();
+         DataVariant value = pValue->getValue();
+         if (nodeType == "File set")
+         {
+            string filesetName;
+            value.getValue<string>(filesetName);
+
+            string currentFilename;
+            pBatchWizard->getCurrentFilesetFile(filesetName, currentFilename);
+            estimatedSize += QFileInfo(QString::fromStdString(currentFilename)).size();
+
+            FactoryResource<Filename> pFilename;
+            pFilename->setFullPathAndName(currentFilename);
+
+            nodeType = "Filename";
+            value = DataVariant(*(pFilename.get()));
+         }
+
+         runWizard.setInputValue(pValue->getItemName(), pValue->getNodeName(), nodeType, value);
+      }
+
+      string batchFilename;
+      char* pTempFilename = tempnam(tempPath.c_str(), "BW");
+      if (pTempFilename != NULL)
+      {
+         batchFilename = string(pTempFilename) + ".batchwiz";
+         free(pTempFilename);
+      }
+
+      if (batchFilename.empty() == true ||
+         WizardUtilities::writeBatchWizard(vector<BatchWizard*>(1, &runWizard), batchFilename) == false)
+      {
+         string message = "Cannot write the batch file to process " + inputFile + ".";
+         if (mpProgress != NULL)
+         {
+            mpProgress->updateProgress(message, 0, ERRORS);
+         }
+
+         remove(batchFilename.c_str());
+         return false;
+      }
+
+      vector<string> arguments(1, delimiter + "input:" + batchFilename);
+      arguments.insert(arguments.end(), commonArguments.begin(), commonArguments.end());
+      runs.addFile(inputFile, batchFilename, executable.toStdString(), arguments, estimatedSize);
+
+      pBatchWizard->updateFilesets();
+   }
+
+   return runs.execute();
+}
@@ -42,6 +42,18 @@ protected:
       const std::string& nodeName, const std::string& nodeType) const;
    bool runWizard(WizardObject* pWizard);
 
+   /**
+    * Runs each file of a repeating batch wizard in a separate batch process.
+    *
+    * @param pBatchWizard
+    *        The batch wizard to run.  The filesets must be initialized.
+    * @param parallelRuns
+    *        The maximum number of processes to run at once.
+    *
+    * @return Returns true if every file was processed successfully.
+    */
+   bool executeParallel(BatchWizard* pBatchWizard, unsigned int parallelRuns);
+
 private:
    bool mbAbort;
    Progress* mpProgress;
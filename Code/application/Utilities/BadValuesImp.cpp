@@ -17,11 +17,24 @@
 
 #include <QtCore/QString>
 
+#include <algorithm>
 #include <limits>
 #include <map>
+#include <string.h>
 
 XERCES_CPP_NAMESPACE_USE
 
+namespace
+{
+   // Up to this many ranges are tested against a whole array at once, more are found with a binary search
+   const std::vector<std::pair<double, double> >::size_type MAX_ROW_TEST_RANGES = 4;
+
+   bool rangeStartsBelow(const std::pair<double, double>& range, double value)
+   {
+      return range.first < value;
+   }
+}
+
 BadValuesImp::BadValuesImp() :
    mToleranceStr(BadValues::getSettingTolerance()),
    mBadValuesBeingUpdated(false),
@@ -109,15 +122,186 @@ bool BadValuesImp::isBadValue(double value) const
    }
 
    // check adjusted ranges which include individual values as range from value - tolerance to value + tolerance
-   for (std::vector<std::pair<double, double> >::const_iterator it = mAdjustedRanges.begin();
-      it != mAdjustedRanges.end(); ++it)
+   return isInBadRange(value);
+}
+
+bool BadValuesImp::isInBadRange(double value) const
+{
+   // The merged ranges do not overlap, so only the last range starting below the value can contain it
+   std::vector<std::pair<double, double> >::const_iterator it =
+      std::lower_bound(mMergedRanges.begin(), mMergedRanges.end(), value, rangeStartsBelow);
+   if (it == mMergedRanges.begin())
+   {
+      return false;
+   }
+
+   --it;
+   return value < it->second;
+}
+
+bool BadValuesImp::getValidityMask(const void* pValues, EncodingType type, size_t count,
+   unsigned char* pValidMask) const
+{
+   if (pValues == NULL || pValidMask == NULL)
+   {
+      return false;
+   }
+
+   switch (type)
+   {
+   case INT1SBYTE:
    {
-      if (value > it->first && value < it->second)
+      const signed char* pData = static_cast<const signed char*>(pValues);
+      const unsigned char* pLookup = getValidLookup(type) - std::numeric_limits<signed char>::min();
+      for (size_t i = 0; i < count; ++i)
       {
-         return true;
+         pValidMask[i] = pLookup[pData[i]];
+      }
+      break;
+   }
+   case INT1UBYTE:
+   {
+      const unsigned char* pData = static_cast<const unsigned char*>(pValues);
+      const unsigned char* pLookup = getValidLookup(type);
+      for (size_t i = 0; i < count; ++i)
+      {
+         pValidMask[i] = pLookup[pData[i]];
+      }
+      break;
+   }
+   case INT2SBYTES:
+   {
+      const short* pData = static_cast<const short*>(pValues);
+      const unsigned char* pLookup = getValidLookup(type) - std::numeric_limits<short>::min();
+      for (size_t i = 0; i < count; ++i)
+      {
+         pValidMask[i] = pLookup[pData[i]];
+      }
+      break;
+   }
+   case INT2UBYTES:
+   {
+      const unsigned short* pData = static_cast<const unsigned short*>(pValues);
+      const unsigned char* pLookup = getValidLookup(type);
+      for (size_t i = 0; i < count; ++i)
+      {
+         pValidMask[i] = pLookup[pData[i]];
+      }
+      break;
+   }
+   case INT4SBYTES:
+      classifyValues(static_cast<const int*>(pValues), count, pValidMask);
+      break;
+   case INT4UBYTES:
+      classifyValues(static_cast<const unsigned int*>(pValues), count, pValidMask);
+      break;
+   case FLT4BYTES:
+      classifyValues(static_cast<const float*>(pValues), count, pValidMask);
+      break;
+   case FLT8BYTES:
+      classifyValues(static_cast<const double*>(pValues), count, pValidMask);
+      break;
+   default:
+      return false;
+   }
+
+   return true;
+}
+
+const unsigned char* BadValuesImp::getValidLookup(EncodingType type) const
+{
+   int minValue = 0;
+   int numValues = 0;
+   switch (type)
+   {
+   case INT1SBYTE:
+      minValue = std::numeric_limits<signed char>::min();
+      numValues = 256;
+      break;
+   case INT1UBYTE:
+      numValues = 256;
+      break;
+   case INT2SBYTES:
+      minValue = std::numeric_limits<short>::min();
+      numValues = 65536;
+      break;
+   case INT2UBYTES:
+      numValues = 65536;
+      break;
+   default:
+      return NULL;
+   }
+
+   mta::MutexLock lock(mLookupMutex);
+   std::vector<unsigned char>& lookup = mValidLookups[type];
+   if (lookup.empty())
+   {
+      lookup.resize(numValues);
+      for (int i = 0; i < numValues; ++i)
+      {
+         lookup[i] = isBadValue(minValue + i) ? 0 : 1;
+      }
+   }
+
+   return &lookup.front();
+}
+
+template<typename T>
+void BadValuesImp::classifyValues(const T* pValues, size_t count, unsigned char* pValidMask) const
+{
+   // The comparisons are written without branches so that the loops can be vectorized.  As in
+   // isBadValue(), a value which is not a number is never a bad value.
+   if (mAdjustedSingleRangeValid == true)
+   {
+      const double lower = mAdjustedSingleRangeLower;
+      const double upper = mAdjustedSingleRangeUpper;
+      for (size_t i = 0; i < count; ++i)
+      {
+         const double value = static_cast<double>(pValues[i]);
+         pValidMask[i] = static_cast<unsigned char>(!((value > lower) & (value < upper)));
+      }
+      return;
+   }
+
+   if (empty())
+   {
+      memset(pValidMask, 1, count);
+      return;
+   }
+
+   // A disabled threshold is replaced by an infinite one which no value is beyond
+   const double lower = mLowerThresholdStr.empty() ? -std::numeric_limits<double>::infinity() : mAdjustedLower;
+   const double upper = mUpperThresholdStr.empty() ? std::numeric_limits<double>::infinity() : mAdjustedUpper;
+   for (size_t i = 0; i < count; ++i)
+   {
+      const double value = static_cast<double>(pValues[i]);
+      pValidMask[i] = static_cast<unsigned char>(!((value < lower) | (value > upper)));
+   }
+
+   if (mMergedRanges.size() <= MAX_ROW_TEST_RANGES)
+   {
+      for (std::vector<std::pair<double, double> >::const_iterator it = mMergedRanges.begin();
+         it != mMergedRanges.end(); ++it)
+      {
+         const double rangeLower = it->first;
+         const double rangeUpper = it->second;
+         for (size_t i = 0; i < count; ++i)
+         {
+            const double value = static_cast<double>(pValues[i]);
+            pValidMask[i] &= static_cast<unsigned char>(!((value > rangeLower) & (value < rangeUpper)));
+         }
+      }
+   }
+   else
+   {
+      for (size_t i = 0; i < count; ++i)
+      {
+         if (pValidMask[i] != 0 && isInBadRange(static_cast<double>(pValues[i])))
+         {
+            pValidMask[i] = 0;
+         }
       }
    }
-   return false;
 }
 
 bool BadValuesImp::getSingleBadValueRange(double& lower, double& upper) const
@@ -459,6 +643,7 @@ void BadValuesImp::clear()
    mAdjustedSingleRangeValid = false;
    mAdjustedSingleRangeLower = std::numeric_limits<double>::max();
    mAdjustedSingleRangeUpper = std::numeric_limits<double>::max();
+   compileRanges();
 
    if (!mBadValuesBeingUpdated)
    {
@@ -625,7 +810,7 @@ void BadValuesImp::generateAdjustedValues()
 
          // check if value is in a range
          bool valueInRange(false);
-         for (std::map<double,double>::const_iterator iti = tempRanges.begin(); iti != tempRanges.end(); ++it)
+         for (std::map<double,double>::const_iterator iti = tempRanges.begin(); iti != tempRanges.end(); ++iti)
          {
             if (value > iti->first && value < iti->second)
             {
@@ -666,10 +851,38 @@ void BadValuesImp::generateAdjustedValues()
       mAdjustedSingleRangeUpper = std::numeric_limits<double>::max();
    }
 
+   compileRanges();
    generateBadValuesString();
    notify(SIGNAL_NAME(Subject, Modified));
 }
 
+void BadValuesImp::compileRanges()
+{
+   // Merge the ranges which overlap.  Ranges which only touch are kept separate since the shared end
+   // value is not a bad value.
+   mMergedRanges.clear();
+   for (std::vector<std::pair<double, double> >::const_iterator it = mAdjustedRanges.begin();
+      it != mAdjustedRanges.end(); ++it)
+   {
+      if ((it->first < it->second) == false)      // no value is within the range
+      {
+         continue;
+      }
+
+      if (mMergedRanges.empty() == false && it->first < mMergedRanges.back().second)
+      {
+         mMergedRanges.back().second = std::max(mMergedRanges.back().second, it->second);
+      }
+      else
+      {
+         mMergedRanges.push_back(*it);
+      }
+   }
+
+   mta::MutexLock lock(mLookupMutex);
+   mValidLookups.clear();
+}
+
 const std::string& BadValuesImp::getObjectType() const
 {
    static std::string sType("BadValuesImp");
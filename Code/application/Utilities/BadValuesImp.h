@@ -11,9 +11,12 @@
 #define BADVALUESIMP_H
 
 #include "ConfigurationSettings.h"
+#include "DMutex.h"
 #include "SerializableImp.h"
 #include "SubjectImp.h"
+#include "TypesFile.h"
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -30,6 +33,8 @@ public:
    BadValues* getBadValues();
    virtual double getDefaultBadValue() const;
    virtual bool isBadValue(double value) const;
+   virtual bool getValidityMask(const void* pValues, EncodingType type, size_t count,
+      unsigned char* pValidMask) const;
    virtual bool getSingleBadValueRange(double& lower, double& upper) const;
 
    virtual std::string getLowerBadValueThreshold() const;
@@ -66,6 +71,12 @@ protected:
    void generateBadValuesString();
    bool isValidValueString(const std::string& valueStr) const;
 
+   void compileRanges();
+   bool isInBadRange(double value) const;
+   const unsigned char* getValidLookup(EncodingType type) const;
+   template<typename T>
+   void classifyValues(const T* pValues, size_t count, unsigned char* pValidMask) const;
+
 private:
    std::string mBadValuesAsString;
    std::string mLowerThresholdStr;
@@ -82,6 +93,13 @@ private:
    double mAdjustedSingleRangeUpper;
    bool mBadValuesBeingUpdated;
    std::string mErrorMsg;
+
+   // The adjusted ranges with overlapping ranges merged, used for a binary search in isBadValue()
+   std::vector<std::pair<double, double> > mMergedRanges;
+
+   // Tables of isBadValue() == false for every value of the 8 and 16 bit data types, created when first used
+   mutable mta::DMutex mLookupMutex;
+   mutable std::map<EncodingType, std::vector<unsigned char> > mValidLookups;
 };
 
 #define BADVALUESADAPTEREXTENSION_CLASSES \
@@ -107,6 +125,10 @@ private:
    { \
       return impClass::isBadValue(value); \
    } \
+   bool getValidityMask(const void* pValues, EncodingType type, size_t count, unsigned char* pValidMask) const \
+   { \
+      return impClass::getValidityMask(pValues, type, count, pValidMask); \
+   } \
    bool getSingleBadValueRange(double& lower, double& upper) const \
    { \
       return impClass::getSingleBadValueRange(lower, upper); \
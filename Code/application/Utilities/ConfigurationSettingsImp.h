@@ -63,6 +63,7 @@ public:
 
    std::string getHome() const;
    std::string getPlugInPath() const;
+   std::string getUserStorageFilePath(const std::string& filePrefix, const std::string& fileExtension) const;
    std::string getUserDocs() const;
    std::string getCreator() const;
    std::string getProduct() const;
@@ -98,7 +99,6 @@ public:
    bool serializeAsDefaults(const Filename* pFilename, const DynamicObject* pObject) const;
    DynamicObject* deserialize(const Filename* pFilename) const;
    bool loadSettings(std::string& errorMessage);
-   std::string getUserStorageFilePath(const std::string& filePrefix, const std::string& fileExtension) const;
    std::string getUserStorageFileName(const std::string& filePrefix, const std::string& fileExtension) const;
 
    void updateProductionStatus();
@@ -11,8 +11,8 @@
 
 using namespace std;
 
-MessageLogAdapter::MessageLogAdapter(const char* name, const char* path, QFILE *journal) :
-   MessageLogImp(name, path, journal)
+MessageLogAdapter::MessageLogAdapter(const char* name, const char* path, MessageLogJournal* pJournal) :
+   MessageLogImp(name, path, pJournal)
 {}
 
 MessageLogAdapter::~MessageLogAdapter()
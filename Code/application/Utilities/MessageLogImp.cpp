@@ -30,10 +30,10 @@
 using namespace std;
 XERCES_CPP_NAMESPACE_USE
 
-MessageLogImp::MessageLogImp(const char* name, const char* path, QFILE* journal) :
+MessageLogImp::MessageLogImp(const char* name, const char* path, MessageLogJournal* pJournal) :
          mpLogName(name),
          mpCurrentStep(NULL),
-         mpJournal(journal),
+         mpJournal(pJournal),
          mpWriter(NULL)
 {
    mpFilename = new FilenameImp(path);
@@ -70,14 +70,18 @@ MessageLogImp::MessageLogImp(const char* name, const char* path, QFILE* journal)
    {
       fname = string(path) + fname + extension;
    }
-   mpJournalWriter = new QTextStream(mpJournal);
-
    // fname is already unique. For consistency, just append the mpJournal file's unique extension:
    QString tmpFilename;
+   QString journalFilename;
+   if (mpJournal != NULL)
+   {
+      journalFilename = mpJournal->getFileName();
+   }
+
    int jourIdx;
-   if((jourIdx=mpJournal->fileName().lastIndexOf("/jour.")) > -1)
+   if((jourIdx=journalFilename.lastIndexOf("/jour.")) > -1)
    {
-       tmpFilename = QString::fromStdString(fname) + mpJournal->fileName().mid(jourIdx+5);
+       tmpFilename = QString::fromStdString(fname) + journalFilename.mid(jourIdx+5);
    }
    else
    {
@@ -167,12 +171,6 @@ MessageLogImp::~MessageLogImp()
       mpWriter = NULL;
    }
 
-   if (mpJournalWriter != NULL)
-   {
-      delete mpJournalWriter;
-      mpJournalWriter = NULL;
-   }
-
    if (mpFilename != NULL)
    {
       delete dynamic_cast<FilenameImp*>(mpFilename);
@@ -198,15 +196,8 @@ MessageLogImp::~MessageLogImp()
 
    notify(SIGNAL_NAME(Subject, Deleted));
 
-   if (mpJournal != NULL)
-   {
-#if HAVE_QSAVEFILE
-      mpJournal->commit(); // QSaveFile is commit(), QFile is close()
-#else
-      mpJournal->close();
-#endif
-   }
-
+   // The journal file is shared by all logs and is closed by MessageLogMgrImp
+   flushJournal();
 }
 
 Message* MessageLogImp::createMessage(const string& action, const string& component, const string& key,
@@ -333,76 +324,86 @@ const string& MessageLogImp::getLogName() const
    return mpLogName;
 }
 
-void MessageLogImp::messageAdded(Subject& subject, const string& signal, const boost::any& v)
+void MessageLogImp::flushJournal()
 {
-   Message* pMsg(boost::any_cast<Message*>(v));
-   if (mpJournalWriter == NULL || pMsg == NULL)
+   if (mpJournal != NULL)
    {
-      return;
+      mpJournal->flush();
    }
-
-   Step* pStp(dynamic_cast<Step*>(pMsg));
-   StepImp* pStpImp(dynamic_cast<StepImp*>(pStp));
-   MessageImp* pMsgImp(dynamic_cast<MessageImp*>(pMsg));
-   *mpJournalWriter << mpLogName.c_str() << " - ADDED "
-      << ((pStpImp != NULL) ? "Step" : "Message")
-      << "[" << ((pStpImp != NULL) ? pStpImp : pMsgImp)->getStringId().c_str() << "] "
-      << pMsg->getAction().c_str() << endl;
-   notify(SIGNAL_NAME(MessageLog, MessageAdded), v);
 }
 
-void MessageLogImp::messageModified(Subject& subject, const string& signal, const boost::any& v)
+bool MessageLogImp::appendJournalRecord(const boost::any& v, MessageLogJournal::RecordType type)
 {
    Message* pMsg(boost::any_cast<Message*>(v));
-   if (mpJournalWriter == NULL || pMsg == NULL)
+   if (pMsg == NULL)
    {
-      return;
+      return false;
    }
 
+   if (mpJournal == NULL)
+   {
+      return true;
+   }
+
+   // Copy everything the journal needs now, since the message may be destroyed before the record is written
    Step* pStp(dynamic_cast<Step*>(pMsg));
    StepImp* pStpImp(dynamic_cast<StepImp*>(pStp));
    MessageImp* pMsgImp(dynamic_cast<MessageImp*>(pMsg));
-   *mpJournalWriter << mpLogName.c_str() << " - PROPERTY ADDED "
-      << ((pStpImp != NULL) ? "Step" : "Message")
-      << "[" << ((pStpImp != NULL) ? pStpImp : pMsgImp)->getStringId().c_str() << "."
-      << pMsg->getProperties()->getNumAttributes() << "] "
-      << endl;
-   notify(SIGNAL_NAME(MessageLog, MessageModified), v);
+
+   MessageLogJournal::Record record;
+   record.mType = type;
+   record.mLogName = mpLogName;
+   record.mIsStep = pStpImp != NULL;
+   record.mId = ((pStpImp != NULL) ? pStpImp : pMsgImp)->getStringId();
+   switch (type)
+   {
+   case MessageLogJournal::ADDED:
+      record.mAction = pMsg->getAction();
+      break;
+   case MessageLogJournal::PROPERTY_ADDED:
+      record.mPropertyCount = pMsg->getProperties()->getNumAttributes();
+      break;
+   case MessageLogJournal::FINALIZED:
+      if (pStp != NULL)
+      {
+         record.mHasResult = true;
+         record.mResult = pStp->getResult();
+         if (record.mResult == Message::Failure)
+         {
+            record.mFailureMessage = pStp->getFailureMessage();
+         }
+      }
+      break;
+   default:
+      break;
+   }
+
+   mpJournal->append(record);
+   return true;
 }
 
-void MessageLogImp::messageHidden(Subject& subject, const string& signal, const boost::any& v)
+void MessageLogImp::messageAdded(Subject& subject, const string& signal, const boost::any& v)
 {
-   Message* pMsg(boost::any_cast<Message*>(v));
-   if (mpJournalWriter == NULL || pMsg == NULL)
+   if (appendJournalRecord(v, MessageLogJournal::ADDED))
    {
-      return;
+      notify(SIGNAL_NAME(MessageLog, MessageAdded), v);
    }
+}
 
-   Step* pStp(dynamic_cast<Step*>(pMsg));
-   StepImp* pStpImp(dynamic_cast<StepImp*>(pStp));
-   MessageImp* pMsgImp(dynamic_cast<MessageImp*>(pMsg));
-   *mpJournalWriter << mpLogName.c_str() << " - FINALIZED "
-      << ((pStpImp != NULL) ? "Step" : "Message")
-      << "[" << ((pStpImp != NULL) ? pStpImp : pMsgImp)->getStringId().c_str() << "] ";
-   if (pStp != NULL)
+void MessageLogImp::messageModified(Subject& subject, const string& signal, const boost::any& v)
+{
+   if (appendJournalRecord(v, MessageLogJournal::PROPERTY_ADDED))
    {
-      switch (pStp->getResult())
-      {
-      case Message::Success:
-         *mpJournalWriter << "Success";
-         break;
-      case Message::Failure:
-         *mpJournalWriter << "Failure[" << pStp->getFailureMessage().c_str() << "]";
-         break;
-      case Message::Abort:
-         *mpJournalWriter << "Abort";
-         break;
-      default:
-         break;
-      }
+      notify(SIGNAL_NAME(MessageLog, MessageModified), v);
+   }
+}
+
+void MessageLogImp::messageHidden(Subject& subject, const string& signal, const boost::any& v)
+{
+   if (appendJournalRecord(v, MessageLogJournal::FINALIZED))
+   {
+      notify(SIGNAL_NAME(MessageLog, MessageHidden), v);
    }
-   *mpJournalWriter << endl;
-   notify(SIGNAL_NAME(MessageLog, MessageHidden), v);
 }
 
 void MessageLogImp::messageDetached(Subject& subject, const string& signal, const boost::any& v)
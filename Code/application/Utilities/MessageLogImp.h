@@ -21,6 +21,7 @@ typedef QFile QFILE;
 #endif
 
 #include "MessageLog.h"
+#include "MessageLogJournal.h"
 #include "SerializableImp.h"
 #include "SubjectImp.h"
 #include "SubjectAdapter.h"
@@ -108,7 +109,7 @@ public:
    /**
     *  Construct a new message log
     */
-   MessageLogImp(const char* name, const char* path, QFILE *journal);
+   MessageLogImp(const char* name, const char* path, MessageLogJournal* pJournal);
    virtual ~MessageLogImp();
 
    virtual Message *createMessage(const std::string &action,
@@ -139,6 +140,7 @@ public: // serialize functionality
 
 public:
    const std::string& getLogName() const;
+   void flushJournal();
    QFILE* mpLogFile;
 
 protected: // Observer
@@ -148,12 +150,13 @@ protected: // Observer
    void messageAdded(Subject &subject, const std::string &signal, const boost::any &v);
 
 private:
+   bool appendJournalRecord(const boost::any& v, MessageLogJournal::RecordType type);
+
    std::string mpLogName;
    Filename* mpFilename;
    std::vector<Message*> mMessageList;
    Step* mpCurrentStep;
-   QFILE* mpJournal;
-   QTextStream* mpJournalWriter;
+   MessageLogJournal* mpJournal;
    XMLWriter* mpWriter;
 };
 
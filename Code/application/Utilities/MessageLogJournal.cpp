@@ -0,0 +1,217 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#include "MessageLogJournal.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileDevice>
+#include <QtCore/QTextStream>
+
+using namespace std;
+
+namespace
+{
+   // Appending blocks when this many records are waiting to be written
+   const size_t sMaxQueuedRecords = 8192;
+
+   // Text is flushed to the file once this much has been written since the last flush...
+   const unsigned int sFlushBytes = 64 * 1024;
+
+   // ...or once the oldest text which has not been flushed is this old
+   const unsigned int sFlushMilliseconds = 1000;
+}
+
+MessageLogJournal::MessageLogJournal(QFileDevice* pFile) :
+   mpFile(pFile),
+   mThreadHandle(static_cast<void*>(this), reinterpret_cast<void*>(MessageLogJournal::threadFunction)),
+   mAppendedCount(0),
+   mWrittenCount(0),
+   mFlushRequestCount(0),
+   mFlushedCount(0),
+   mCheckpoint(false),
+   mStop(false)
+{
+   mThreadHandle.ThreadLaunch();
+}
+
+MessageLogJournal::~MessageLogJournal()
+{
+   {
+      mta::MutexLock lock(mMutex);
+      mStop = true;
+      mRecordsQueued.ThreadSignalActivate();
+   }
+
+   mThreadHandle.ThreadWait();
+}
+
+void MessageLogJournal::append(const Record& record)
+{
+   mta::MutexLock lock(mMutex);
+   while (mQueue.size() >= sMaxQueuedRecords && mStop == false)
+   {
+      mRecordsWritten.ThreadSignalWait(&mMutex);
+   }
+
+   mQueue.push_back(record);
+   ++mAppendedCount;
+
+   // Make sure a failure is on disk in case it is followed by a crash
+   if (record.mType == FINALIZED && record.mHasResult && record.mResult != Message::Success)
+   {
+      mCheckpoint = true;
+   }
+
+   mRecordsQueued.ThreadSignalActivate();
+}
+
+void MessageLogJournal::flush()
+{
+   mta::MutexLock lock(mMutex);
+   unsigned int target = mAppendedCount;
+   mFlushRequestCount = target;
+   mRecordsQueued.ThreadSignalActivate();
+   while (mFlushedCount < target && mStop == false)
+   {
+      mRecordsWritten.ThreadSignalWait(&mMutex);
+   }
+}
+
+QString MessageLogJournal::getFileName() const
+{
+   if (mpFile == NULL)
+   {
+      return QString();
+   }
+
+   return mpFile->fileName();
+}
+
+void MessageLogJournal::threadFunction(MessageLogJournal* pJournal)
+{
+   if (pJournal != NULL)
+   {
+      pJournal->writeRecords();
+   }
+}
+
+void MessageLogJournal::writeRecords()
+{
+   QTextStream stream(mpFile);
+   QElapsedTimer unflushedTimer;
+   unsigned int unflushedBytes = 0;
+   vector<Record> records;
+
+   mMutex.MutexLock();
+   for (;;)
+   {
+      bool timedOut = false;
+      while (mQueue.empty() && mStop == false && mCheckpoint == false && mFlushRequestCount <= mFlushedCount &&
+         timedOut == false)
+      {
+         if (unflushedTimer.isValid())
+         {
+            qint64 elapsed = unflushedTimer.elapsed();
+            unsigned int remaining = elapsed < sFlushMilliseconds ?
+               sFlushMilliseconds - static_cast<unsigned int>(elapsed) : 0;
+            timedOut = remaining == 0 || mRecordsQueued.ThreadSignalTimedWait(&mMutex, remaining) == false;
+         }
+         else
+         {
+            mRecordsQueued.ThreadSignalWait(&mMutex);
+         }
+      }
+
+      records.swap(mQueue);
+      bool flushRequested = mCheckpoint || mFlushRequestCount > mFlushedCount || mStop;
+      bool stop = mStop;
+      mCheckpoint = false;
+      mRecordsWritten.ThreadSignalBroadcast(); // the queue has room again
+      mMutex.MutexUnlock();
+
+      // Format the batch exactly as each record was previously written on the calling thread
+      for (vector<Record>::const_iterator iter = records.begin(); iter != records.end() && mpFile != NULL; ++iter)
+      {
+         const Record& record = *iter;
+         stream << record.mLogName.c_str();
+         switch (record.mType)
+         {
+         case ADDED:
+            stream << " - ADDED " << (record.mIsStep ? "Step" : "Message") << "[" << record.mId.c_str() << "] "
+               << record.mAction.c_str();
+            break;
+         case PROPERTY_ADDED:
+            stream << " - PROPERTY ADDED " << (record.mIsStep ? "Step" : "Message") << "[" << record.mId.c_str()
+               << "." << record.mPropertyCount << "] ";
+            break;
+         case FINALIZED:
+            stream << " - FINALIZED " << (record.mIsStep ? "Step" : "Message") << "[" << record.mId.c_str() << "] ";
+            if (record.mHasResult)
+            {
+               switch (record.mResult)
+               {
+               case Message::Success:
+                  stream << "Success";
+                  break;
+               case Message::Failure:
+                  stream << "Failure[" << record.mFailureMessage.c_str() << "]";
+                  break;
+               case Message::Abort:
+                  stream << "Abort";
+                  break;
+               default:
+                  break;
+               }
+            }
+            break;
+         default:
+            break;
+         }
+         stream << '\n';
+
+         // An estimate is sufficient for deciding when to flush
+         unflushedBytes += static_cast<unsigned int>(record.mLogName.size() + record.mId.size() +
+            record.mAction.size() + record.mFailureMessage.size()) + 32;
+      }
+
+      if (records.empty() == false && unflushedTimer.isValid() == false)
+      {
+         unflushedTimer.start();
+      }
+
+      bool flushed = false;
+      if (flushRequested || unflushedBytes >= sFlushBytes ||
+         (unflushedTimer.isValid() && unflushedTimer.elapsed() >= sFlushMilliseconds))
+      {
+         stream.flush();
+         if (mpFile != NULL)
+         {
+            mpFile->flush();
+         }
+         unflushedBytes = 0;
+         unflushedTimer.invalidate();
+         flushed = true;
+      }
+
+      mMutex.MutexLock();
+      mWrittenCount += static_cast<unsigned int>(records.size());
+      if (flushed)
+      {
+         mFlushedCount = mWrittenCount;
+      }
+      mRecordsWritten.ThreadSignalBroadcast();
+      records.clear();
+
+      if (stop && mQueue.empty())
+      {
+         break;
+      }
+   }
+   mMutex.MutexUnlock();
+}
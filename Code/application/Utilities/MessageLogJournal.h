@@ -0,0 +1,129 @@
+/*
+ * The information in this file is
+ * Copyright(c) 2020 Ball Aerospace & Technologies Corporation
+ * and is subject to the terms and conditions of the
+ * GNU Lesser General Public License Version 2.1
+ * The license text is available from
+ * http://www.gnu.org/licenses/lgpl.html
+ */
+
+#ifndef MESSAGELOGJOURNAL_H
+#define MESSAGELOGJOURNAL_H
+
+#include "bthread.h"
+#include "DMutex.h"
+#include "MessageLog.h"
+
+#include <QtCore/QString>
+
+#include <string>
+#include <vector>
+
+class QFileDevice;
+
+/**
+ * Writes the message log journal on a background thread.
+ *
+ * Message logs append a record for each journal entry.  The records are queued and
+ * formatted and written by the journal thread in batches, so the calling thread does
+ * not block on formatting or file I/O unless the queue is full.  The journal is flushed
+ * to the file when enough text has been written since the last flush, when records
+ * have been waiting too long, after a step is finalized with a failure or abort, and
+ * whenever flush() is called.  Records are written in the order in which they are
+ * appended and the text is identical to writing each record directly.
+ */
+class MessageLogJournal
+{
+public:
+   /**
+    * The kind of journal entry.
+    */
+   enum RecordType
+   {
+      ADDED,            /**< A message or step was added to a log. */
+      PROPERTY_ADDED,   /**< A property was added to a message or step. */
+      FINALIZED         /**< A message or step was finalized. */
+   };
+
+   /**
+    * A journal entry.  All values are copied from the message when the record is
+    * created since the message may be destroyed before the record is written.
+    */
+   struct Record
+   {
+      Record() :
+         mType(ADDED),
+         mIsStep(false),
+         mPropertyCount(0),
+         mHasResult(false),
+         mResult(Message::Success)
+      {}
+
+      RecordType mType;
+      std::string mLogName;
+      bool mIsStep;
+      std::string mId;
+      std::string mAction;
+      unsigned int mPropertyCount;
+      bool mHasResult;
+      Message::Result mResult;
+      std::string mFailureMessage;
+   };
+
+   /**
+    * Starts the journal thread.
+    *
+    * @param  pFile
+    *         The open journal file.  The file is not owned by the journal and
+    *         must not be written by anything else until the journal is destroyed.
+    */
+   MessageLogJournal(QFileDevice* pFile);
+
+   /**
+    * Writes all queued records and stops the journal thread.
+    */
+   ~MessageLogJournal();
+
+   /**
+    * Queues a record to be written.  This blocks only if the queue is full.
+    *
+    * @param  record
+    *         The journal entry.
+    */
+   void append(const Record& record);
+
+   /**
+    * Writes all records appended before the call and flushes the file.  This blocks
+    * until the records have been handed to the operating system.
+    */
+   void flush();
+
+   /**
+    * Returns the name of the journal file.
+    *
+    * @return The journal file name or an empty string if there is no file.
+    */
+   QString getFileName() const;
+
+private:
+   MessageLogJournal(const MessageLogJournal& rhs);
+   MessageLogJournal& operator=(const MessageLogJournal& rhs);
+
+   static void threadFunction(MessageLogJournal* pJournal);
+   void writeRecords();
+
+   QFileDevice* mpFile;
+   BThread mThreadHandle;
+   mta::DMutex mMutex;
+   mta::DThreadSignal mRecordsQueued;
+   mta::DThreadSignal mRecordsWritten;
+   std::vector<Record> mQueue;
+   unsigned int mAppendedCount;
+   unsigned int mWrittenCount;
+   unsigned int mFlushRequestCount;
+   unsigned int mFlushedCount;
+   bool mCheckpoint;
+   bool mStop;
+};
+
+#endif
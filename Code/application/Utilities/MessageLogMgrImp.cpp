@@ -10,6 +10,7 @@
 #include "ConfigurationSettings.h"
 #include "Filename.h"
 #include "MessageLogAdapter.h"
+#include "MessageLogJournal.h"
 #include "MessageLogMgrImp.h"
 #include "SessionManager.h"
 
@@ -21,7 +22,8 @@ MessageLogMgrImp* MessageLogMgrImp::spInstance = NULL;
 bool MessageLogMgrImp::mDestroyed = false;
 
 MessageLogMgrImp::MessageLogMgrImp() :
-   mpJournal(NULL)
+   mpJournal(NULL),
+   mpJournalWriter(NULL)
 {
    const Filename* pMessageLogPath = ConfigurationSettings::getSettingMessageLogPath();
    if (pMessageLogPath != NULL)
@@ -71,6 +73,10 @@ MessageLogMgrImp::MessageLogMgrImp() :
    {
        mpJournal->setPermissions(QFileDevice::ReadUser | QFileDevice::WriteUser);
    }
+
+   // Journal entries are formatted and written on a background thread
+   mpJournalWriter = new MessageLogJournal(mpJournal);
+
    // Create a default session log
    createLog(Service<SessionManager>()->getName());
 }
@@ -102,6 +108,10 @@ MessageLogMgrImp::~MessageLogMgrImp()
    notify(SIGNAL_NAME(Subject, Deleted));
    clear();
 
+   // Stop the journal thread after it has written every entry
+   delete mpJournalWriter;
+   mpJournalWriter = NULL;
+
 #if HAVE_QSAVEFILE
    mpJournal->commit();
    // If you really want to treat the journal file as a temporary,
@@ -161,13 +171,20 @@ MessageLog* MessageLogMgrImp::createLog(const string& logName)
       return NULL;
    }
 
-   MessageLog* pLog = new MessageLogAdapter(logName.c_str(), mLogPath.c_str(), mpJournal);
+   MessageLog* pLog = new MessageLogAdapter(logName.c_str(), mLogPath.c_str(), mpJournalWriter);
    mLogMap.insert(pair<string, MessageLog*>(logName, pLog));
    notify(SIGNAL_NAME(MessageLogMgr, LogAdded), pLog);
 
    return pLog;
 }
 
+void MessageLogMgrImp::flushJournal()
+{
+   if (mpJournalWriter != NULL)
+   {
+      mpJournalWriter->flush();
+   }
+}
 MessageLog* MessageLogMgrImp::getLog(const string& logName) const
 {
    if (logName.empty() == true)
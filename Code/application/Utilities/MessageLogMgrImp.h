@@ -18,6 +18,7 @@
 #include <vector>
 
 class MessageLog;
+class MessageLogJournal;
 
 #if HAVE_QSAVEFILE
 class QSaveFile;
@@ -36,6 +37,7 @@ public:
    virtual MessageLog* getLog(const std::string& logName) const;
    virtual MessageLog* getLog() const;
    virtual std::vector<MessageLog*> getLogs() const;
+   virtual void flushJournal();
 
    void clear();
 
@@ -61,6 +63,7 @@ private:
 #else
    QFile* mpJournal;
 #endif
+   MessageLogJournal* mpJournalWriter;
 };
 
 #endif
@@ -135,6 +135,21 @@ BatchWizard* BatchFileParser::read()
       pBatchWizard->setCleanup(cleanup);
    }
 
+   // Parallel - not required
+   if (attrs.namedItem("parallel").isNull() == false)
+   {
+      bool bValid = false;
+      unsigned int runs = attrs.namedItem("parallel").nodeValue().toUInt(&bValid);
+      if (bValid == false)
+      {
+         mErrorMessage = "The number of parallel runs in the XML batch file is invalid!";
+         delete pBatchWizard;
+         return NULL;
+      }
+
+      pBatchWizard->setParallelRuns(runs);
+   }
+
    // Repeat - not required
    if (attrs.namedItem("repeat").isNull() == false)
    {
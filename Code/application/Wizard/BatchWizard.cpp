@@ -10,6 +10,7 @@
 #include "BatchFileset.h"
 #include "BatchWizard.h"
 #include "ObjectFactory.h"
+#include "StringUtilities.h"
 #include "Value.h"
 #include "xmlwriter.h"
 
@@ -17,6 +18,7 @@ using namespace std;
 
 BatchWizard::BatchWizard() :
    mbClean(false),
+   mParallelRuns(1),
    mpRepeatFileset(NULL)
 {
 }
@@ -67,6 +69,16 @@ bool BatchWizard::doesCleanup() const
    return mbClean;
 }
 
+void BatchWizard::setParallelRuns(unsigned int runs)
+{
+   mParallelRuns = runs;
+}
+
+unsigned int BatchWizard::getParallelRuns() const
+{
+   return mParallelRuns;
+}
+
 void BatchWizard::addFileset(BatchFileset* pFileset)
 {
    if (pFileset != NULL)
@@ -295,6 +307,11 @@ bool BatchWizard::toXml(XMLWriter* pXml) const
       writer.addAttr("cleanup", "true");
    }
 
+   if (mParallelRuns != 1)
+   {
+      writer.addAttr("parallel", StringUtilities::toXmlString(mParallelRuns));
+   }
+
    //Filesets
    for (vector<BatchFileset*>::const_iterator filesetIter = mFilesets.begin();
         filesetIter != mFilesets.end(); ++filesetIter)
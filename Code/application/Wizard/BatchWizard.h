@@ -33,6 +33,10 @@ public:
    void setCleanup(bool bCleanup = true);
    bool doesCleanup() const;
 
+   // The number of repeat fileset files to process at once, or zero to use one per processor
+   void setParallelRuns(unsigned int runs);
+   unsigned int getParallelRuns() const;
+
    // File sets
    void addFileset(BatchFileset* pFileset);
    BatchFileset* getFileset(const std::string& filesetName) const;
@@ -60,6 +64,7 @@ public:
 private:
    std::string mWizardFilename;
    bool mbClean;
+   unsigned int mParallelRuns;
 
    std::vector<BatchFileset*> mFilesets;
    BatchFileset* mpRepeatFileset;
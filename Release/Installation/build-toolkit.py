@@ -351,8 +351,8 @@ def create_toolkit_zip(opticks_code_dir, opticks_dependencies_dir,
         "CoreIo", "Covariance", "DataFusion", "Dted", "ENVI", "Fits", "GdalImporter", "Generic",
         "GeographicFeatures", "GeoMosaic", "Georeference", "Hdf", "Ice", "ImageComparison", "Kml",
         "Modis", "MovieExporter", "Nitf", "NitfCommonTre", "ObjectFinding", "Pca", "Pictures", "Results",
-        "Scripts", "SecondMoment", "ShapeFileExporter", "Sio", "SpatialResampler", "Wavelength",
-        "WizardExecutor", "WizardItems" ]
+        "Scripts", "SecondMoment", "ShapeFileExporter", "Sio", "SpatialResampler", "SpectralMatching",
+        "Wavelength", "WizardExecutor", "WizardItems" ]
     sample_plugins = ["PlugInSampler", "PlugInSamplerQt",
         "PlugInSamplerHdf", "Tutorial" ]
     if is_windows():